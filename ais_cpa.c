@@ -0,0 +1,224 @@
+/*
+ * ais_cpa.c - closest point of approach for every AIS target
+ *
+ * Own ship and the targets are placed on a plane tangent to the earth
+ * near own ship, x east and y north in meters, with velocities from
+ * course and speed over ground.  Over the few tens of kilometers where
+ * collision warnings matter the flat-earth error is far below what AIS
+ * positions are good for, and it turns CPA into a handful of multiplies
+ * per target.  The plane is re-centered when own ship has moved
+ * AIS_CPA_REANCHOR meters from its tangent point.
+ *
+ * Each entry remembers where the target was and when, and is dead
+ * reckoned to the time of the screening, so a full pass after an own
+ * ship fix needs nothing from the target table.  The screening loop runs
+ * over the parallel arrays with no branches; targets updated between
+ * fixes are screened one at a time by the same loop.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+#ifdef AIVDM_ENABLE
+
+#define METERS_PER_DEGREE	111195.0	/* on a sphere of mean radius */
+
+static void cpa_project(const struct ais_cpa_t *c, double lat, double lon,
+			/*@out@*/double *x, /*@out@*/double *y)
+{
+    double dlon = lon - c->lon0;
+
+    if (dlon > 180)
+	dlon -= 360;
+    else if (dlon < -180)
+	dlon += 360;
+    *x = dlon * c->coslat0 * METERS_PER_DEGREE;
+    *y = (lat - c->lat0) * METERS_PER_DEGREE;
+}
+
+static void cpa_velocity(double course, double speed,
+			 /*@out@*/double *vx, /*@out@*/double *vy)
+/* course in degrees true and speed in m/s; unknown means stopped */
+{
+    if (isnan(course) != 0 || isnan(speed) != 0) {
+	*vx = *vy = 0;
+	return;
+    }
+    *vx = speed * sin(DEG_2_RAD * course);
+    *vy = speed * cos(DEG_2_RAD * course);
+}
+
+static void cpa_screen(struct ais_cpa_t *c, int from, int to, timestamp_t now)
+/* the kernel: CPA, TCPA and alarm flags for slots [from, to) */
+{
+    const double *restrict x = c->x, *restrict y = c->y;
+    const double *restrict vx = c->vx, *restrict vy = c->vy;
+    const double *restrict t = c->t;
+    double *restrict cpa2 = c->cpa2, *restrict tcpa = c->tcpa;
+    unsigned char *restrict danger = c->danger, *restrict clear = c->clear;
+    double ox = c->ox + c->ovx * (now - c->ot);
+    double oy = c->oy + c->ovy * (now - c->ot);
+    double ovx = c->ovx, ovy = c->ovy;
+    double lim2 = c->cpa_limit * c->cpa_limit, tlim = c->tcpa_limit;
+    double rel2 = lim2 * AIS_CPA_RELEASE * AIS_CPA_RELEASE;
+    double reltlim = tlim * AIS_CPA_RELEASE;
+    int i;
+
+    for (i = from; i < to; i++) {
+	double dt = now - t[i];
+	double dx = x[i] + vx[i] * dt - ox;
+	double dy = y[i] + vy[i] * dt - oy;
+	double dvx = vx[i] - ovx, dvy = vy[i] - ovy;
+	double range2 = dx * dx + dy * dy;
+	/* the epsilon keeps ships in company at a finite, harmless TCPA */
+	double tc = -(dx * dvx + dy * dvy) / (dvx * dvx + dvy * dvy + 1e-9);
+	double cx = dx + dvx * tc, cy = dy + dvy * tc;
+	double c2 = cx * cx + cy * cy;
+
+	tcpa[i] = tc;
+	cpa2[i] = c2;
+	/* NaN entries fail every comparison: never dangerous, always clear */
+	danger[i] = (unsigned char)((range2 <= lim2)
+				    | ((c2 <= lim2) & (tc >= 0) & (tc <= tlim)));
+	clear[i] = (unsigned char)!((range2 <= rel2)
+				    | ((c2 <= rel2) & (tc >= 0)
+				       & (tc <= reltlim)));
+    }
+}
+
+static void cpa_place(struct ais_cpa_t *c, const struct ais_targets_t *t,
+		      int slot)
+/* copy a target's position and motion onto the plane */
+{
+    const struct ais_target_t *tp = &t->target[slot];
+
+    /* base stations don't move and aren't afloat */
+    if (!c->own_valid || tp->mmsi == 0 || tp->own || tp->mmsi == c->own_mmsi
+	|| tp->type == 4 || isnan(tp->lat) != 0) {
+	c->x[slot] = c->y[slot] = NAN;
+	c->vx[slot] = c->vy[slot] = 0;
+	c->t[slot] = 0;
+	return;
+    }
+    cpa_project(c, tp->lat, tp->lon, &c->x[slot], &c->y[slot]);
+    cpa_velocity(tp->course, tp->speed * KNOTS_TO_MPS,
+		 &c->vx[slot], &c->vy[slot]);
+    c->t[slot] = tp->fixed;
+}
+
+void ais_cpa_init(/*@out@*/struct ais_cpa_t *c)
+{
+    int i;
+
+    (void)memset(c, '\0', sizeof(*c));
+    for (i = 0; i < AIS_TARGET_MAX; i++) {
+	c->x[i] = c->y[i] = NAN;
+	c->cpa2[i] = c->tcpa[i] = NAN;
+	c->clear[i] = 1;
+    }
+    c->cpa_limit = AIS_CPA_LIMIT;
+    c->tcpa_limit = AIS_TCPA_LIMIT;
+}
+
+void ais_cpa_own(struct ais_cpa_t *c, const struct ais_targets_t *t,
+		 double lat, double lon, double course, double speed,
+		 timestamp_t now)
+/* take an own ship fix; course in degrees true, speed in m/s */
+{
+    double x = 0, y = 0;
+
+    if (c->own_valid)
+	cpa_project(c, lat, lon, &x, &y);
+    if (!c->own_valid || x * x + y * y > AIS_CPA_REANCHOR * AIS_CPA_REANCHOR) {
+	int i;
+
+	c->lat0 = lat;
+	c->lon0 = lon;
+	c->coslat0 = cos(DEG_2_RAD * lat);
+	c->own_valid = true;
+	for (i = 0; i < AIS_TARGET_MAX; i++)
+	    cpa_place(c, t, i);
+	x = y = 0;
+    }
+    c->ox = x;
+    c->oy = y;
+    cpa_velocity(course, speed, &c->ovx, &c->ovy);
+    c->ot = now;
+}
+
+void ais_cpa_target(struct ais_cpa_t *c, const struct ais_targets_t *t,
+		    int slot, timestamp_t now)
+/* a target was updated; place and screen it alone */
+{
+    cpa_place(c, t, slot);
+    cpa_screen(c, slot, slot + 1, now);
+}
+
+void ais_cpa_batch(struct ais_cpa_t *c, timestamp_t now)
+/* screen the whole table, as after an own ship fix */
+{
+    cpa_screen(c, 0, AIS_TARGET_MAX, now);
+}
+
+void ais_cpa_event(const struct ais_cpa_t *c, int slot, unsigned int mmsi,
+		   timestamp_t now, /*@out@*/struct ais_cpa_event_t *ev)
+/* describe a slot's standing as of the last screening */
+{
+    double dt = now - c->t[slot];
+    double dx = c->x[slot] + c->vx[slot] * dt
+	- (c->ox + c->ovx * (now - c->ot));
+    double dy = c->y[slot] + c->vy[slot] * dt
+	- (c->oy + c->ovy * (now - c->ot));
+
+    ev->slot = slot;
+    ev->mmsi = mmsi;
+    ev->alarm = c->alarm[slot] != 0;
+    ev->time = now;
+    ev->tcpa = c->tcpa[slot];
+    ev->range = sqrt(dx * dx + dy * dy);
+    /* once the closest point is past, it is where the target is now */
+    ev->cpa = ev->tcpa < 0 ? ev->range : sqrt(c->cpa2[slot]);
+    ev->bearing = RAD_2_DEG * atan2(dx, dy);
+    if (ev->bearing < 0)
+	ev->bearing += 360;
+}
+
+int ais_cpa_changes(struct ais_cpa_t *c, const struct ais_targets_t *t,
+		    int slot, timestamp_t now,
+		    /*@out@*/struct ais_cpa_event_t *ev, int max)
+/*
+ * Raise and clear alarms after screening, for one slot or all of them
+ * if slot is negative.  Returns how many events were written.
+ */
+{
+    int i, n = 0, from = 0, to = AIS_TARGET_MAX;
+
+    if (slot >= 0) {
+	from = slot;
+	to = slot + 1;
+    }
+    for (i = from; i < to && n < max; i++) {
+	unsigned int mmsi = t->target[i].mmsi;
+
+	/* a slot handed to another vessel clears the old one's alarm */
+	if (c->alarm[i] != 0 && (c->clear[i] != 0 || c->alarm[i] != mmsi)) {
+	    unsigned int was = c->alarm[i];
+
+	    c->alarm[i] = 0;
+	    ais_cpa_event(c, i, was, now, &ev[n++]);
+	}
+	if (c->alarm[i] == 0 && c->danger[i] != 0 && mmsi != 0 && n < max) {
+	    c->alarm[i] = mmsi;
+	    ais_cpa_event(c, i, mmsi, now, &ev[n++]);
+	}
+    }
+    return n;
+}
+
+#endif /* AIVDM_ENABLE */
+
+/* ais_cpa.c ends here */
@@ -0,0 +1,463 @@
+/*
+ * ais_targets.c - the daemon's table of AIS targets
+ *
+ * Every AIS report, whether it came from AIVDM or an NMEA 2000 PGN, is
+ * folded into a per-MMSI record holding the latest position, motion and
+ * static data, with type 24 parts and type 5 voyage data merged as they
+ * arrive.  Lookup by MMSI goes through an open-addressed hash with
+ * backward-shift deletion; lookup by area through a grid of
+ * AIS_TARGET_CELL-degree cells, hashed into a fixed set of buckets so
+ * the index costs the same whatever the coverage area.  All storage is
+ * static; when the table fills, the target heard from least recently is
+ * dropped to make room.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+#ifdef AIVDM_ENABLE
+
+#define GRID_LAT_CELLS	((long)(180 / AIS_TARGET_CELL) + 1)
+#define GRID_LON_CELLS	((long)(360 / AIS_TARGET_CELL))
+
+static unsigned int mmsi_home(unsigned int mmsi)
+{
+    return (unsigned int)((mmsi * 2654435761u) >> 16) & (AIS_TARGET_HASH - 1);
+}
+
+static unsigned int cell_bucket(long cell)
+{
+    return (unsigned int)(((unsigned long)cell * 2654435761u) >> 8)
+	& (AIS_TARGET_BUCKETS - 1);
+}
+
+static long grid_lat(double lat)
+{
+    long i = (long)floor((lat + 90) / AIS_TARGET_CELL);
+
+    return i < 0 ? 0 : i >= GRID_LAT_CELLS ? GRID_LAT_CELLS - 1 : i;
+}
+
+static long grid_lon(double lon)
+{
+    long i = (long)floor((lon + 180) / AIS_TARGET_CELL);
+
+    return ((i % GRID_LON_CELLS) + GRID_LON_CELLS) % GRID_LON_CELLS;
+}
+
+static int target_find(const struct ais_targets_t *t, unsigned int mmsi)
+/* slot holding mmsi, or -1 */
+{
+    unsigned int h;
+
+    for (h = mmsi_home(mmsi); t->hash[h] != 0; h = (h + 1) & (AIS_TARGET_HASH - 1))
+	if (t->target[t->hash[h] - 1].mmsi == mmsi)
+	    return t->hash[h] - 1;
+    return -1;
+}
+
+static void hash_remove(struct ais_targets_t *t, unsigned int mmsi)
+/* delete from the hash, shifting later probes back over the hole */
+{
+    unsigned int i, j;
+
+    for (i = mmsi_home(mmsi); t->hash[i] != 0; i = (i + 1) & (AIS_TARGET_HASH - 1))
+	if (t->target[t->hash[i] - 1].mmsi == mmsi)
+	    break;
+    if (t->hash[i] == 0)
+	return;
+    for (j = i;;) {
+	unsigned int k;
+
+	j = (j + 1) & (AIS_TARGET_HASH - 1);
+	if (t->hash[j] == 0)
+	    break;
+	k = mmsi_home(t->target[t->hash[j] - 1].mmsi);
+	/* move j into the hole unless its home lies cyclically in (i, j] */
+	if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+	    continue;
+	t->hash[i] = t->hash[j];
+	i = j;
+    }
+    t->hash[i] = 0;
+}
+
+static void grid_unlink(struct ais_targets_t *t, int slot)
+{
+    int *link;
+
+    if (t->target[slot].cell < 0)
+	return;
+    for (link = &t->bucket[cell_bucket(t->target[slot].cell)];
+	 *link != -1; link = &t->target[*link].next)
+	if (*link == slot) {
+	    *link = t->target[slot].next;
+	    break;
+	}
+    t->target[slot].cell = -1;
+    t->target[slot].next = -1;
+}
+
+static void grid_link(struct ais_targets_t *t, int slot, long cell)
+{
+    struct ais_target_t *tp = &t->target[slot];
+    unsigned int b = cell_bucket(cell);
+
+    tp->cell = cell;
+    tp->next = t->bucket[b];
+    t->bucket[b] = slot;
+}
+
+static void target_evict(struct ais_targets_t *t, int slot, timestamp_t now)
+{
+    struct ais_target_t *tp = &t->target[slot];
+
+    t->gone[t->gone_next].mmsi = tp->mmsi;
+    t->gone[t->gone_next].when = now;
+    t->gone_next = (t->gone_next + 1) % AIS_TARGET_MAX;
+    grid_unlink(t, slot);
+    hash_remove(t, tp->mmsi);
+    tp->mmsi = 0;
+    tp->next = t->free;
+    t->free = slot;
+    t->count--;
+}
+
+static int target_new(struct ais_targets_t *t, unsigned int mmsi,
+		      timestamp_t now)
+/* take a free slot for mmsi, evicting the stalest target if need be */
+{
+    struct ais_target_t *tp;
+    unsigned int h;
+    int slot;
+
+    if (t->free == -1) {
+	int i, oldest = 0;
+
+	for (i = 1; i < AIS_TARGET_MAX; i++)
+	    if (t->target[i].seen < t->target[oldest].seen)
+		oldest = i;
+	target_evict(t, oldest, now);
+    }
+    slot = t->free;
+    tp = &t->target[slot];
+    t->free = tp->next;
+    (void)memset(tp, '\0', sizeof(*tp));
+    tp->mmsi = mmsi;
+    tp->lat = tp->lon = tp->speed = tp->course = NAN;
+    tp->heading = tp->status = -1;
+    tp->turn = AIS_TURN_NOT_AVAILABLE;
+    tp->cell = -1;
+    tp->next = -1;
+    for (h = mmsi_home(mmsi); t->hash[h] != 0; h = (h + 1) & (AIS_TARGET_HASH - 1))
+	continue;
+    t->hash[h] = slot + 1;
+    t->count++;
+    return slot;
+}
+
+static void target_position(struct ais_targets_t *t, int slot,
+			    int lat, int lon, int lat_na, int lon_na,
+			    double div, timestamp_t now)
+/* record a position in the message's units and keep the grid current */
+{
+    struct ais_target_t *tp = &t->target[slot];
+    long cell;
+
+    if (lat == lat_na || lon == lon_na)
+	return;
+    tp->fixed = now;
+    tp->lat = lat / div;
+    tp->lon = lon / div;
+    cell = grid_lat(tp->lat) * GRID_LON_CELLS + grid_lon(tp->lon);
+    if (cell != tp->cell) {
+	grid_unlink(t, slot);
+	grid_link(t, slot, cell);
+    }
+}
+
+static void target_motion(struct ais_target_t *tp, unsigned int speed,
+			  unsigned int course, unsigned int heading)
+/* deciknots and decidegrees, as types 1-3, 9, 18 and 19 carry them */
+{
+    if (speed != AIS_SPEED_NOT_AVAILABLE)
+	tp->speed = speed / 10.0;
+    if (course != AIS_COURSE_NOT_AVAILABLE)
+	tp->course = course / 10.0;
+    if (heading != AIS_HEADING_NOT_AVAILABLE)
+	tp->heading = (int)heading;
+}
+
+static void target_dimensions(struct ais_target_t *tp,
+			      unsigned int to_bow, unsigned int to_stern,
+			      unsigned int to_port, unsigned int to_starboard)
+{
+    tp->to_bow = to_bow;
+    tp->to_stern = to_stern;
+    tp->to_port = to_port;
+    tp->to_starboard = to_starboard;
+}
+
+void ais_targets_init(/*@out@*/struct ais_targets_t *t)
+{
+    int i;
+
+    (void)memset(t, '\0', sizeof(*t));
+    for (i = 0; i < AIS_TARGET_BUCKETS; i++)
+	t->bucket[i] = -1;
+    for (i = 0; i < AIS_TARGET_MAX; i++)
+	t->target[i].next = i + 1 < AIS_TARGET_MAX ? i + 1 : -1;
+    t->free = 0;
+}
+
+bool ais_targets_update(struct ais_targets_t *t, const struct ais_t *ais,
+			timestamp_t now)
+/* fold one AIS report into the table; true if anything reported changed */
+{
+    struct ais_target_t *tp, old;
+    bool fresh = false;
+    int slot;
+
+    switch (ais->type) {
+    case 1: case 2: case 3: case 4: case 5: case 9:
+    case 18: case 19: case 21: case 24: case 27:
+	break;
+    default:
+	/* binary, safety and link-management traffic isn't about a vessel */
+	return false;
+    }
+    if (ais->mmsi == 0)
+	return false;
+    if ((slot = target_find(t, ais->mmsi)) == -1) {
+	slot = target_new(t, ais->mmsi, now);
+	fresh = true;
+    }
+    tp = &t->target[slot];
+    old = *tp;
+
+    tp->own = ais->own_mmsi != 0;
+    switch (ais->type) {
+    case 1:
+    case 2:
+    case 3:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type1.lat, ais->type1.lon,
+			AIS_LAT_NOT_AVAILABLE, AIS_LON_NOT_AVAILABLE,
+			AIS_LATLON_DIV, now);
+	target_motion(tp, ais->type1.speed, ais->type1.course,
+		      ais->type1.heading);
+	tp->status = (int)ais->type1.status;
+	/* the decoder leaves "not available" as the raw signed -128 */
+	tp->turn = ais->type1.turn == -AIS_TURN_NOT_AVAILABLE
+	    ? AIS_TURN_NOT_AVAILABLE : ais->type1.turn;
+	break;
+    case 4:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type4.lat, ais->type4.lon,
+			AIS_LAT_NOT_AVAILABLE, AIS_LON_NOT_AVAILABLE,
+			AIS_LATLON_DIV, now);
+	break;
+    case 5:
+	tp->imo = ais->type5.imo;
+	(void)strlcpy(tp->callsign, ais->type5.callsign, sizeof(tp->callsign));
+	(void)strlcpy(tp->shipname, ais->type5.shipname, sizeof(tp->shipname));
+	(void)strlcpy(tp->destination, ais->type5.destination,
+		      sizeof(tp->destination));
+	tp->shiptype = ais->type5.shiptype;
+	target_dimensions(tp, ais->type5.to_bow, ais->type5.to_stern,
+			  ais->type5.to_port, ais->type5.to_starboard);
+	tp->draught = ais->type5.draught;
+	break;
+    case 9:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type9.lat, ais->type9.lon,
+			AIS_LAT_NOT_AVAILABLE, AIS_LON_NOT_AVAILABLE,
+			AIS_LATLON_DIV, now);
+	target_motion(tp, ais->type9.speed, ais->type9.course,
+		      AIS_HEADING_NOT_AVAILABLE);
+	break;
+    case 18:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type18.lat, ais->type18.lon,
+			AIS_LAT_NOT_AVAILABLE, AIS_LON_NOT_AVAILABLE,
+			AIS_LATLON_DIV, now);
+	target_motion(tp, ais->type18.speed, ais->type18.course,
+		      ais->type18.heading);
+	break;
+    case 19:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type19.lat, ais->type19.lon,
+			AIS_LAT_NOT_AVAILABLE, AIS_LON_NOT_AVAILABLE,
+			AIS_LATLON_DIV, now);
+	target_motion(tp, ais->type19.speed, ais->type19.course,
+		      ais->type19.heading);
+	(void)strlcpy(tp->shipname, ais->type19.shipname, sizeof(tp->shipname));
+	tp->shiptype = ais->type19.shiptype;
+	target_dimensions(tp, ais->type19.to_bow, ais->type19.to_stern,
+			  ais->type19.to_port, ais->type19.to_starboard);
+	break;
+    case 21:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type21.lat, ais->type21.lon,
+			AIS_LAT_NOT_AVAILABLE, AIS_LON_NOT_AVAILABLE,
+			AIS_LATLON_DIV, now);
+	(void)strlcpy(tp->shipname, ais->type21.name, sizeof(tp->shipname));
+	target_dimensions(tp, ais->type21.to_bow, ais->type21.to_stern,
+			  ais->type21.to_port, ais->type21.to_starboard);
+	break;
+    case 24:
+	/* the parts arrive separately; take whatever this one carries */
+	if (ais->type24.part != part_b)
+	    (void)strlcpy(tp->shipname, ais->type24.shipname,
+			  sizeof(tp->shipname));
+	if (ais->type24.part != part_a) {
+	    tp->shiptype = ais->type24.shiptype;
+	    (void)strlcpy(tp->callsign, ais->type24.callsign,
+			  sizeof(tp->callsign));
+	    if (!AIS_AUXILIARY_MMSI(ais->mmsi))
+		target_dimensions(tp, ais->type24.dim.to_bow,
+				  ais->type24.dim.to_stern,
+				  ais->type24.dim.to_port,
+				  ais->type24.dim.to_starboard);
+	}
+	break;
+    case 27:
+	tp->type = ais->type;
+	target_position(t, slot, ais->type27.lat, ais->type27.lon,
+			AIS_LONGRANGE_LAT_NOT_AVAILABLE,
+			AIS_LONGRANGE_LON_NOT_AVAILABLE,
+			AIS_LONGRANGE_LATLON_DIV, now);
+	if (ais->type27.speed != AIS_LONGRANGE_SPEED_NOT_AVAILABLE)
+	    tp->speed = (double)ais->type27.speed;
+	if (ais->type27.course != AIS_LONGRANGE_COURSE_NOT_AVAILABLE)
+	    tp->course = (double)ais->type27.course;
+	tp->status = (int)ais->type27.status;
+	break;
+    }
+
+    /* being heard again, even at the same spot, isn't news */
+    old.seen = tp->seen = now;
+    old.fixed = tp->fixed;
+    if (fresh || memcmp(&old, tp, sizeof(old)) != 0) {
+	tp->changed = now;
+	return true;
+    }
+    return false;
+}
+
+int ais_targets_lookup(const struct ais_targets_t *t, unsigned int mmsi)
+/* slot of the target with this MMSI, or -1 */
+{
+    return target_find(t, mmsi);
+}
+
+void ais_targets_expire(struct ais_targets_t *t, timestamp_t now)
+/* drop targets that have gone quiet */
+{
+    int i;
+
+    for (i = 0; i < AIS_TARGET_MAX; i++)
+	if (t->target[i].mmsi != 0
+	    && now - t->target[i].seen > AIS_TARGET_TTL)
+	    target_evict(t, i, now);
+}
+
+static bool query_match(const struct ais_target_t *tp,
+			const struct ais_target_query_t *q,
+			bool boxed, bool circled)
+{
+    if (tp->changed <= q->since)
+	return false;
+    if (!boxed && !circled)
+	return true;
+    if (isnan(tp->lat) != 0)
+	return false;
+    if (boxed) {
+	if (tp->lat < q->minlat || tp->lat > q->maxlat)
+	    return false;
+	/* a box with minlon > maxlon straddles the antimeridian */
+	if (q->minlon <= q->maxlon
+	    ? (tp->lon < q->minlon || tp->lon > q->maxlon)
+	    : (tp->lon < q->minlon && tp->lon > q->maxlon))
+	    return false;
+    }
+    return !circled
+	|| earth_distance(q->lat, q->lon, tp->lat, tp->lon) <= q->radius;
+}
+
+int ais_targets_select(const struct ais_targets_t *t,
+		       const struct ais_target_query_t *q,
+		       /*@out@*/int *out, int max)
+/* slots of the targets matching q, at most max of them */
+{
+    bool boxed = isnan(q->minlat) == 0 && isnan(q->maxlat) == 0
+	&& isnan(q->minlon) == 0 && isnan(q->maxlon) == 0;
+    bool circled = isnan(q->lat) == 0 && isnan(q->lon) == 0
+	&& isnan(q->radius) == 0;
+    double minlat, maxlat, minlon, maxlon;
+    long ilat, ilat0, ilat1, ilon0, nlon, k;
+    int i, n = 0;
+
+    /* the cells to visit: the box, or the circle's bounding box */
+    if (circled) {
+	/* a degree of latitude is at least 110.5km; pad for the ellipsoid */
+	double dlat = q->radius / 110500.0;
+
+	minlat = q->lat - dlat;
+	maxlat = q->lat + dlat;
+	if (fabs(q->lat) + dlat >= 89) {
+	    /* the circle reaches over or near a pole */
+	    minlon = -180;
+	    maxlon = 180;
+	} else {
+	    double dlon = RAD_2_DEG * asin(sin(DEG_2_RAD * dlat)
+					  / cos(DEG_2_RAD * q->lat)) * 1.01;
+
+	    minlon = q->lon - dlon;
+	    maxlon = q->lon + dlon;
+	}
+    } else if (boxed) {
+	minlat = q->minlat;
+	maxlat = q->maxlat;
+	minlon = q->minlon;
+	maxlon = q->maxlon;
+    } else
+	minlat = maxlat = minlon = maxlon = 0;
+
+    ilat0 = grid_lat(minlat);
+    ilat1 = grid_lat(maxlat);
+    ilon0 = grid_lon(minlon);
+    if (maxlon - minlon >= 360)
+	nlon = GRID_LON_CELLS;
+    else
+	nlon = ((grid_lon(maxlon) - ilon0 + GRID_LON_CELLS) % GRID_LON_CELLS) + 1;
+
+    if ((!boxed && !circled) || ilat1 < ilat0
+	|| (ilat1 - ilat0 + 1) * nlon > AIS_TARGET_BUCKETS) {
+	/* cheaper to look at every target than at every cell */
+	for (i = 0; i < AIS_TARGET_MAX && n < max; i++)
+	    if (t->target[i].mmsi != 0
+		&& query_match(&t->target[i], q, boxed, circled))
+		out[n++] = i;
+	return n;
+    }
+
+    for (ilat = ilat0; ilat <= ilat1; ilat++)
+	for (k = 0; k < nlon; k++) {
+	    long cell = ilat * GRID_LON_CELLS + (ilon0 + k) % GRID_LON_CELLS;
+
+	    for (i = t->bucket[cell_bucket(cell)]; i != -1; i = t->target[i].next)
+		if (t->target[i].cell == cell && n < max
+		    && query_match(&t->target[i], q, boxed, circled))
+		    out[n++] = i;
+	}
+    return n;
+}
+
+#endif /* AIVDM_ENABLE */
+
+/* ais_targets.c ends here */
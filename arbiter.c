@@ -0,0 +1,290 @@
+/*
+ * arbiter.c - pick one source for each navigation data item
+ *
+ * With several devices on one boat, say a GPS on the NMEA 2000 bus, a
+ * compass on a serial port and a SeaTalk speed log, every device's
+ * report used to be written out as it came, so whichever device spoke
+ * last won the heading, speed or position downstream, and two sources
+ * of one item showed up as jitter between them.
+ *
+ * The arbiter sits in front of the outputs.  Every report that carries
+ * an item offers it; the item keeps the device it selected until a
+ * device it prefers offers the item, or until the selected one has not
+ * been heard for the item's timeout, when the next device to offer it
+ * takes over.  The report of a device that lost is passed on with that
+ * item masked out, and arbiter_restore() puts the device's own data
+ * back for the JSON clients, which watch devices rather than items.
+ *
+ * Two items can be smoothed over the updates of the selected source.
+ * Heading is run through a complementary filter: the estimate is moved
+ * on by the rate of turn, which is quick but drifts, and pulled towards
+ * the compass, which is steady but noisy, with the item's time
+ * constant.  Without a live rate of turn the compass passes straight
+ * through.  SOG and COG are smoothed together as a velocity vector, so
+ * the course does not swing through north the long way round.
+ *
+ * Each update costs a few comparisons per item and is done as the
+ * report goes out, on the main thread.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+/* what of a report is part of the fix */
+#define FIX_MASK	(TIME_SET | TIMERR_SET | LATLON_SET | ALTITUDE_SET \
+			 | CLIMB_SET | STATUS_SET | MODE_SET | DOP_SET \
+			 | HERR_SET | VERR_SET | CLIMBERR_SET | REPORT_IS)
+
+static const struct {
+    const char *name;
+    gps_mask_t offered;			/* in the change mask */
+    gps_mask_t navset;			/* in navigation.set, if any */
+    double timeout;
+} items[arbiter_items] = {
+    [arbiter_position] = {"position", LATLON_SET, 0, 3.0},
+    [arbiter_course] = {"course", NAVIGATION_SET,
+			NAV_SOG_PSET | NAV_COG_TRUE_PSET | NAV_COG_MAGN_PSET,
+			3.0},
+    [arbiter_heading] = {"heading", NAVIGATION_SET,
+			 NAV_HDG_TRUE_PSET | NAV_HDG_MAGN_PSET, 2.0},
+    [arbiter_stw] = {"speed", NAVIGATION_SET, NAV_STW_PSET, 3.0},
+    [arbiter_depth] = {"depth", NAVIGATION_SET,
+		       NAV_DPT_PSET | NAV_DPT_OFF_PSET, 5.0},
+    [arbiter_rot] = {"rot", NAVIGATION_SET, NAV_ROT_PSET, 2.0},
+};
+
+void arbiter_init(/*@out@*/struct arbiter_t *arb)
+{
+    int i;
+
+    memset(arb, 0, sizeof(*arb));
+    for (i = 0; i < arbiter_items; i++) {
+	arb->item[i].timeout = items[i].timeout;
+	arb->item[i].device = -1;
+    }
+    arb->heading[compass_true] = arb->heading[compass_magnetic] = NAN;
+    arb->rot = NAN;
+    arb->course_ref = -1;
+}
+
+int arbiter_item(const char *name)
+/* the item of a name in the configuration, or -1 */
+{
+    int i;
+
+    for (i = 0; i < arbiter_items; i++)
+	if (strcmp(items[i].name, name) == 0)
+	    return i;
+    return -1;
+}
+
+const char *arbiter_item_name(int item)
+{
+    return item >= 0 && item < arbiter_items ? items[item].name : "?";
+}
+
+bool arbiter_prefer(struct arbiter_t *arb, int item, int device)
+/* add a device to the end of an item's list */
+{
+    struct arbiter_source_t *s;
+
+    if (item < 0 || item >= arbiter_items || device < 0)
+	return false;
+    s = &arb->item[item];
+    if (s->npriority >= ARBITER_PRIORITIES)
+	return false;
+    s->priority[s->npriority++] = device;
+    return true;
+}
+
+bool arbiter_set(struct arbiter_t *arb, int item, double timeout,
+		 double smooth)
+/* change the timeout and smoothing of an item */
+{
+    if (item < 0 || item >= arbiter_items || !(timeout > 0) || !(smooth >= 0))
+	return false;
+    arb->item[item].timeout = timeout;
+    arb->item[item].smooth = smooth;
+    return true;
+}
+
+static int arbiter_rank(const struct arbiter_source_t *s, int device)
+{
+    int i;
+
+    for (i = 0; i < s->npriority; i++)
+	if (s->priority[i] == device)
+	    return i;
+    return s->npriority;
+}
+
+static bool arbiter_select(struct arbiter_source_t *s, int device,
+			   timestamp_t now)
+/* does the device that offers the item get to publish it? */
+{
+    if (s->device != device) {
+	if (s->device >= 0) {
+	    if (now - s->last <= s->timeout
+		&& arbiter_rank(s, device) >= arbiter_rank(s, s->device))
+		return false;
+	    s->switches++;
+	}
+	s->device = device;
+    }
+    s->last = now;
+    s->updates++;
+    return true;
+}
+
+static double wrap180(double angle)
+{
+    angle = fmod(angle + 180.0, 360.0);
+    return angle < 0 ? angle + 180.0 : angle - 180.0;
+}
+
+static double wrap360(double angle)
+{
+    angle = fmod(angle, 360.0);
+    return angle < 0 ? angle + 360.0 : angle;
+}
+
+static double fuse_heading(struct arbiter_t *arb, int ref, double z,
+			   timestamp_t now)
+/* complementary filter of a compass heading with the rate of turn */
+{
+    const struct arbiter_source_t *s = &arb->item[arbiter_heading];
+    double dt = now - arb->heading_time[ref], h = arb->heading[ref];
+
+    if (isnan(h) || dt > s->timeout || dt < 0
+	|| isnan(arb->rot)
+	|| now - arb->rot_time > arb->item[arbiter_rot].timeout)
+	h = z;
+    else {
+	h += arb->rot * dt;
+	h += dt / (s->smooth + dt) * wrap180(z - h);
+    }
+    arb->heading[ref] = wrap360(h);
+    arb->heading_time[ref] = now;
+    return arb->heading[ref];
+}
+
+static void smooth_course(struct arbiter_t *arb, struct navigation_t *nav,
+			  timestamp_t now)
+/* smooth SOG and COG as a velocity */
+{
+    const struct arbiter_source_t *s = &arb->item[arbiter_course];
+    int ref = (nav->set & NAV_COG_TRUE_PSET) != 0 ? compass_true
+	: compass_magnetic;
+    double cog = nav->course_over_ground[ref], sog = nav->speed_over_ground;
+    double east, north, dt = now - arb->course_time, a;
+
+    if ((nav->set & NAV_SOG_PSET) == 0 || isnan(sog) || isnan(cog))
+	return;
+    east = sog * sin(cog * DEG_2_RAD);
+    north = sog * cos(cog * DEG_2_RAD);
+    if (arb->course_ref != ref || dt > s->timeout || dt < 0) {
+	arb->east = east;
+	arb->north = north;
+	arb->course_ref = ref;
+    } else {
+	a = dt / (s->smooth + dt);
+	arb->east += a * (east - arb->east);
+	arb->north += a * (north - arb->north);
+    }
+    arb->course_time = now;
+
+    nav->speed_over_ground = hypot(arb->east, arb->north);
+    nav->course_over_ground[ref] =
+	wrap360(atan2(arb->east, arb->north) * RAD_2_DEG);
+    /* the other reference keeps its offset from this one */
+    if (ref == compass_true && (nav->set & NAV_COG_MAGN_PSET) != 0)
+	nav->course_over_ground[compass_magnetic] =
+	    wrap360(nav->course_over_ground[compass_true] + wrap180(
+			nav->course_over_ground[compass_magnetic] - cog));
+}
+
+gps_mask_t arbiter_update(struct arbiter_t *arb, int device,
+			  struct gps_data_t *gpsdata, gps_mask_t changed,
+			  timestamp_t now,
+			  /*@out@*/struct arbiter_saved_t *saved)
+/*
+ * Offer a device's report for every item it carries and mask out the
+ * ones it lost; returns the change mask to publish.  The data is
+ * changed until arbiter_restore().
+ */
+{
+    struct navigation_t *nav = &gpsdata->navigation;
+    gps_mask_t lost = 0, navlost = 0;
+    int i, ref;
+
+    saved->set = gpsdata->set;
+    saved->navset = nav->set;
+    saved->heading[compass_true] = nav->heading[compass_true];
+    saved->heading[compass_magnetic] = nav->heading[compass_magnetic];
+    saved->speed_over_ground = nav->speed_over_ground;
+    saved->course_over_ground[compass_true] =
+	nav->course_over_ground[compass_true];
+    saved->course_over_ground[compass_magnetic] =
+	nav->course_over_ground[compass_magnetic];
+    if (device < 0)
+	return changed;
+
+    for (i = 0; i < arbiter_items; i++) {
+	if ((changed & items[i].offered) == 0
+	    || (items[i].navset != 0 && (nav->set & items[i].navset) == 0))
+	    continue;
+	if (!arbiter_select(&arb->item[i], device, now)) {
+	    if (items[i].navset == 0)
+		lost |= FIX_MASK;
+	    navlost |= items[i].navset;
+	    continue;
+	}
+	switch (i) {
+	case arbiter_rot:
+	    arb->rot = nav->rate_of_turn;
+	    arb->rot_time = now;
+	    break;
+	case arbiter_heading:
+	    if (arb->item[i].smooth > 0)
+		for (ref = compass_true; ref <= compass_magnetic; ref++)
+		    if ((nav->set & (ref == compass_true ? NAV_HDG_TRUE_PSET
+				     : NAV_HDG_MAGN_PSET)) != 0
+			&& !isnan(nav->heading[ref]))
+			nav->heading[ref] =
+			    fuse_heading(arb, ref, nav->heading[ref], now);
+	    break;
+	case arbiter_course:
+	    if (arb->item[i].smooth > 0)
+		smooth_course(arb, nav, now);
+	    break;
+	}
+    }
+
+    nav->set &= ~navlost;
+    if ((changed & NAVIGATION_SET) != 0 && nav->set == 0)
+	lost |= NAVIGATION_SET;
+    gpsdata->set &= ~lost;
+    return changed & ~lost;
+}
+
+void arbiter_restore(struct gps_data_t *gpsdata,
+		     const struct arbiter_saved_t *saved)
+/* put back what arbiter_update() masked and smoothed */
+{
+    struct navigation_t *nav = &gpsdata->navigation;
+
+    gpsdata->set = saved->set;
+    nav->set = saved->navset;
+    nav->heading[compass_true] = saved->heading[compass_true];
+    nav->heading[compass_magnetic] = saved->heading[compass_magnetic];
+    nav->speed_over_ground = saved->speed_over_ground;
+    nav->course_over_ground[compass_true] =
+	saved->course_over_ground[compass_true];
+    nav->course_over_ground[compass_magnetic] =
+	saved->course_over_ground[compass_magnetic];
+}
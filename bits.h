@@ -24,7 +24,7 @@
 /* little-endian access */
 #define getles16(buf, off)	((int16_t)(((uint16_t)getub((buf),   (off)+1) << 8) | (uint16_t)getub((buf), (off))))
 #define getleu16(buf, off)	((uint16_t)(((uint16_t)getub((buf), (off)+1) << 8) | (uint16_t)getub((buf), (off))))
-#define getleu24(buf, off)	((uint16_t)(((uint16_t)getub((buf), (off)+2) << 16) | (uint16_t)getleu16((buf), (off))))
+#define getleu24(buf, off)	((uint32_t)(((uint32_t)getub((buf), (off)+2) << 16) | (uint32_t)getleu16((buf), (off))))
 #define getles32(buf, off)	((int32_t)(((uint16_t)getleu16((buf),  (off)+2) << 16) | (uint16_t)getleu16((buf), (off))))
 #define getleu32(buf, off)	((uint32_t)(((uint16_t)getleu16((buf),(off)+2) << 16) | (uint16_t)getleu16((buf), (off))))
 #define getles64(buf, off)	((int64_t)(((uint64_t)getleu32(buf, (off)+4) << 32) | getleu32(buf, (off))))
@@ -33,7 +33,9 @@ extern float getlef32(const char *, int);
 extern double getled64(const char *, int);
 
 #define putle16(buf, off, w) do {putbyte(buf, (off)+1, (uint)(w) >> 8); putbyte(buf, (off), (w));} while (0)
+#define putle24(buf, off, l) do {putbyte(buf, (off)+2, (uint)(l) >> 16); putle16(buf, (off), (l));} while (0)
 #define putle32(buf, off, l) do {putle16(buf, (off)+2, (uint)(l) >> 16); putle16(buf, (off), (l));} while (0)
+#define putle64(buf, off, q) do {putle32(buf, (off)+4, (uint64_t)(q) >> 32); putle32(buf, (off), (q));} while (0)
 
 /* big-endian access */
 #define getbes16(buf, off)	((int16_t)(((uint16_t)getub(buf, (off)) << 8) | (uint16_t)getub(buf, (off)+1)))
@@ -31,6 +31,175 @@ struct uci_context * config_init(void);
 
 struct interface_t * 
 config_next_free_interface(struct interface_t *);
+/*
+ * transform sections hold sentence rewriting rules, see nmea_xform.c;
+ * a section named like a built-in rule changes that rule
+ */
+static void
+config_parse_transform(struct nmea_xform_t *xform, struct uci_section *s,
+                       const char *name) {
+
+	struct xform_rule_t *rule = nmea_xform_rule(xform, name);
+	struct uci_element *e, *l;
+
+	if (!rule) {
+		gpsd_report(uci_debuglevel, LOG_WARN,
+					"too many transform rules, %s ignored\n", name);
+		return;
+	}
+
+	uci_foreach_element(&s->options, e) {
+
+		struct uci_option *o = uci_to_option(e);
+
+		if (o->type == UCI_TYPE_LIST) {
+			uci_foreach_element(&o->v.list, l) {
+				if (!nmea_xform_option(xform, rule, e->name, l->name))
+					gpsd_report(uci_debuglevel, LOG_WARN,
+								"transform %s: bad %s %s\n",
+								name, e->name, l->name);
+			}
+		} else if (o->type == UCI_TYPE_STRING) {
+			if (!nmea_xform_option(xform, rule, e->name, o->v.string))
+				gpsd_report(uci_debuglevel, LOG_WARN,
+							"transform %s: bad %s %s\n",
+							name, e->name, o->v.string);
+		}
+	}
+
+	gpsd_report(uci_debuglevel, LOG_INF,
+				"transform %s on %s%s%s\n", name,
+				rule->talker, rule->id, rule->enabled ? "" : " (disabled)");
+}
+
+static struct gps_device_t *
+config_device_by_portname(struct gps_device_t * devices, const char * portname);
+
+/*
+ * rate sections set how often a PGN or sentence type goes out, see
+ * outrate.c; without a port the rate applies to every output
+ */
+static void
+config_parse_rate(struct outrate_rules_t *rules,
+                  struct gps_device_t *devices,
+                  struct uci_section *s, const char *name) {
+
+	const char *match = uci_lookup_option_string(uci_ctx, s, "match");
+	const char *min = uci_lookup_option_string(uci_ctx, s, "min");
+	const char *max = uci_lookup_option_string(uci_ctx, s, "max");
+	const char *port = uci_lookup_option_string(uci_ctx, s, "port");
+	struct gps_device_t *devp = NULL;
+	int device = -1;
+
+	if (port) {
+		if (!(devp = config_device_by_portname(devices, port))) {
+			gpsd_report(uci_debuglevel, LOG_WARN,
+						"rate %s: no port %s\n", name, port);
+			return;
+		}
+		device = (int)(devp - devices);
+	}
+
+	if (!match || !outrate_set(rules, match, device,
+							   min ? (unsigned int)atoi(min) : 0,
+							   max ? (unsigned int)atoi(max) : 0)) {
+		gpsd_report(uci_debuglevel, LOG_WARN,
+					"rate %s: bad rule for %s\n", name, match ? match : "-");
+		return;
+	}
+
+	gpsd_report(uci_debuglevel, LOG_INF,
+				"rate %s: %s every %s..%s ms on %s\n", name, match,
+				min ? min : "0", max ? max : "-", port ? port : "all ports");
+}
+
+/*
+ * source sections say which devices an item is taken from, best first,
+ * see arbiter.c; devices not listed are only used when none of these
+ * has been heard for the timeout
+ */
+static void
+config_parse_source(struct arbiter_t *arbiter,
+                    struct gps_device_t *devices,
+                    struct uci_section *s, const char *name) {
+
+	const char *timeout = uci_lookup_option_string(uci_ctx, s, "timeout");
+	const char *smooth = uci_lookup_option_string(uci_ctx, s, "smooth");
+	struct uci_option *o = uci_lookup_option(uci_ctx, s, "port");
+	struct uci_element *l;
+	struct gps_device_t *devp;
+	int item = arbiter_item(name);
+
+	if (item < 0) {
+		gpsd_report(uci_debuglevel, LOG_WARN,
+					"source %s: no such data item\n", name);
+		return;
+	}
+
+	if (o && o->type == UCI_TYPE_LIST) {
+		uci_foreach_element(&o->v.list, l) {
+			if (!(devp = config_device_by_portname(devices, l->name)))
+				gpsd_report(uci_debuglevel, LOG_WARN,
+							"source %s: no port %s\n", name, l->name);
+			else if (!arbiter_prefer(arbiter, item, (int)(devp - devices)))
+				gpsd_report(uci_debuglevel, LOG_WARN,
+							"source %s: too many ports, %s ignored\n",
+							name, l->name);
+		}
+	} else if (o && o->type == UCI_TYPE_STRING) {
+		if (!(devp = config_device_by_portname(devices, o->v.string)))
+			gpsd_report(uci_debuglevel, LOG_WARN,
+						"source %s: no port %s\n", name, o->v.string);
+		else
+			(void)arbiter_prefer(arbiter, item, (int)(devp - devices));
+	}
+
+	if (!arbiter_set(arbiter, item,
+					 timeout ? atof(timeout) : arbiter->item[item].timeout,
+					 smooth ? atof(smooth) : 0)) {
+		gpsd_report(uci_debuglevel, LOG_WARN,
+					"source %s: bad timeout %s or smooth %s\n", name,
+					timeout ? timeout : "-", smooth ? smooth : "-");
+		return;
+	}
+
+	gpsd_report(uci_debuglevel, LOG_INF,
+				"source %s: %d ports, timeout %.1f s, smooth %.1f s\n",
+				name, arbiter->item[item].npriority,
+				arbiter->item[item].timeout, arbiter->item[item].smooth);
+}
+
+/*
+ * the derive section tunes the derived data, see derive.c: how long an
+ * input is used without being heard again, and the leeway coefficient,
+ * degrees of leeway per degree of heel at one knot
+ */
+static void
+config_parse_derive(struct derive_t *derive, struct uci_section *s) {
+
+	const char *timeout = uci_lookup_option_string(uci_ctx, s, "timeout");
+	const char *leeway = uci_lookup_option_string(uci_ctx, s, "leeway");
+
+	if (timeout) {
+		if (atof(timeout) > 0)
+			derive->timeout = atof(timeout);
+		else
+			gpsd_report(uci_debuglevel, LOG_WARN,
+						"derive: bad timeout %s\n", timeout);
+	}
+	if (leeway) {
+		if (atof(leeway) >= 0)
+			derive->leeway_k = atof(leeway);
+		else
+			gpsd_report(uci_debuglevel, LOG_WARN,
+						"derive: bad leeway %s\n", leeway);
+	}
+
+	gpsd_report(uci_debuglevel, LOG_INF,
+				"derive: timeout %.1f s, leeway %.1f\n",
+				derive->timeout, derive->leeway_k);
+}
+
 void
 config_add_boat_section(struct uci_package * pkg, 
                         struct uci_ptr * ptr,
@@ -884,11 +1053,42 @@ config forward
 config forward
 	option src port2
 	option dest port1
+
+config transform 'mast_wind'
+	option port 'port2'
+
+config transform 'depth_offset'
+	option match 'SDDBT'
+	list derive '$3=$3+0.4'
+
+config rate 'heading'
+	option match '127250'
+	option min '250'
+
+config rate 'slow_depth'
+	option match 'DPT'
+	option port 'port1'
+	option min '2000'
+	option max '10000'
+
+config source 'heading'
+	list port 'port2'
+	list port 'port1'
+	option timeout '2'
+	option smooth '1.5'
+
+config derive
+	option timeout '5'
+	option leeway '9'
  */
 
 int config_parse(struct interface_t * interfaces, 
                  struct vessel_t * vessel,
-                 struct gps_device_t *devices) {
+                 struct gps_device_t *devices,
+                 struct nmea_xform_t *xform,
+                 struct outrate_rules_t *rates,
+                 struct arbiter_t *arbiter,
+                 struct derive_t *derive) {
 	
 	struct uci_package *uci_network;
 	struct uci_element *e;
@@ -927,6 +1127,47 @@ int config_parse(struct interface_t * interfaces,
 		}
 	}
 
+	// and the sentence transformation rules
+	uci_foreach_element(&uci_network->sections, e) {
+
+		struct uci_section *s = uci_to_section(e);
+
+		if (!strcmp(s->type, "transform")) {
+			config_parse_transform(xform, s, e->name);
+		}
+	}
+	nmea_xform_compile(xform);
+
+	// and how often things go out
+	uci_foreach_element(&uci_network->sections, e) {
+
+		struct uci_section *s = uci_to_section(e);
+
+		if (!strcmp(s->type, "rate")) {
+			config_parse_rate(rates, devices, s, e->name);
+		}
+	}
+
+	// and which device each data item is taken from
+	uci_foreach_element(&uci_network->sections, e) {
+
+		struct uci_section *s = uci_to_section(e);
+
+		if (!strcmp(s->type, "source")) {
+			config_parse_source(arbiter, devices, s, e->name);
+		}
+	}
+
+	// and what is derived from the data
+	uci_foreach_element(&uci_network->sections, e) {
+
+		struct uci_section *s = uci_to_section(e);
+
+		if (!strcmp(s->type, "derive")) {
+			config_parse_derive(derive, s);
+		}
+	}
+
     uci_unload(uci_ctx, uci_network);
 
     config_handle_boat_section(vessel);
@@ -0,0 +1,123 @@
+#!/usr/bin/env python
+# encoding: utf-8
+#
+# This file is Copyright (c) 2010 by the GPSD project
+# BSD terms apply: see the file COPYING in the distribution root for details.
+"""ingestbench.py
+
+Compare report latency of gpsd with and without per-device reader
+threads (-r).  Runs a private gpsd against three simulated devices, a
+pty carrying NMEA 0183, a virtual CAN interface carrying NMEA 2000
+position frames and a UDP port carrying NMEA 0183, streams data at them
+for a while with a watcher attached, then prints the ?STATS reply.
+
+Usage:
+    ./ingestbench.py [-g gpsd] [-c vcan] [-s seconds] [-- gpsd-options]
+
+For example, to compare the two modes:
+    ./ingestbench.py -- -r -A 1,2,3
+    ./ingestbench.py
+
+The CAN device is skipped unless the interface exists; create one with
+    ip link add dev vcan0 type vcan && ip link set up vcan0
+"""
+
+from __future__ import print_function
+
+import getopt
+import os
+import pty
+import socket
+import struct
+import subprocess
+import sys
+import time
+
+GPSD_PORT = 12947
+UDP_PORT = 12948
+NMEA = [b"$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A",
+        b"$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47",
+        b"$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48"]
+CAN_EFF_FLAG = 0x80000000
+
+
+def can_frame(pgn, src, data):
+    "build a struct can_frame carrying a single-frame PGN"
+    can_id = CAN_EFF_FLAG | (2 << 26) | (pgn << 8) | src
+    return struct.pack("=IB3x8s", can_id, len(data), data)
+
+
+def open_can(name):
+    "raw socket on a CAN interface, or None when there is none"
+    if not hasattr(socket, "AF_CAN"):
+        return None
+    try:
+        s = socket.socket(socket.AF_CAN, socket.SOCK_RAW, socket.CAN_RAW)
+        s.bind((name,))
+        return s
+    except (OSError, socket.error):
+        return None
+
+
+def main():
+    gpsd = "gpsd"
+    canif = "vcan0"
+    seconds = 10
+    (options, extra) = getopt.getopt(sys.argv[1:], "g:c:s:h")
+    for (opt, val) in options:
+        if opt == "-g":
+            gpsd = val
+        elif opt == "-c":
+            canif = val
+        elif opt == "-s":
+            seconds = int(val)
+        else:
+            print(__doc__)
+            sys.exit(0)
+
+    (master, slave) = pty.openpty()
+    sources = [os.ttyname(slave), "udp://127.0.0.1:%d" % UDP_PORT]
+    can = open_can(canif)
+    if can is not None:
+        sources.append("nmea2000://" + canif)
+    else:
+        print("ingestbench: no %s, running without CAN" % canif)
+
+    daemon = subprocess.Popen([gpsd, "-N", "-n", "-S", str(GPSD_PORT)]
+                              + extra + sources)
+    time.sleep(1)
+    watcher = socket.create_connection(("127.0.0.1", GPSD_PORT))
+    watcher.sendall(b'?WATCH={"enable":true,"json":true};\n')
+    watcher.setblocking(False)
+    udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    end = time.time() + seconds
+    n = 0
+    while time.time() < end:
+        sentence = NMEA[n % len(NMEA)] + b"\r\n"
+        os.write(master, sentence)
+        udp.sendto(sentence, ("127.0.0.1", UDP_PORT))
+        if can is not None:
+            can.send(can_frame(129025, 1, struct.pack("<ii", 481172999,
+                                                      115166666)))
+        n += 1
+        try:
+            while watcher.recv(65536):
+                pass
+        except (OSError, socket.error):
+            pass
+        time.sleep(0.005)
+
+    query = socket.create_connection(("127.0.0.1", GPSD_PORT))
+    query.sendall(b"?STATS;\n")
+    time.sleep(0.5)
+    for line in query.recv(65536).decode("ascii").splitlines():
+        if '"class":"STATS"' in line:
+            print(line)
+    print("ingestbench: %d rounds in %d seconds" % (n, seconds))
+    daemon.terminate()
+    daemon.wait()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,209 @@
+/*
+ * ringbench - compare the shared-memory event ring against JSON over a
+ * socket as a way of following a high-rate gpsd.
+ *
+ * Feeds GPRMC sentences to a gpsd UDP source at a fixed rate from a
+ * child process, follows the daemon with one of the two transports for
+ * a while and reports what arrived and what it cost the reader:
+ *
+ *      gpsd -N -n udp://127.0.0.1:5002 &
+ *      ringbench -r 1000 ring
+ *      ringbench -r 1000 json
+ *
+ * For the ring it also reports the delay between gpsd reporting an
+ * update and the reader seeing it.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "../gps.h"
+
+#define MAXLAT	1000000		/* latency samples kept */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage ru;
+
+    (void)getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+	+ (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static void feed(int port, int rate)
+/* send one GPRMC per tick until killed */
+{
+    struct sockaddr_in to;
+    uint64_t next = now_ns(), period = 1000000000ULL / rate;
+    unsigned long n = 0;
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons((unsigned short)port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (;;) {
+	char body[80], line[96];
+	unsigned char sum = 0;
+	struct timespec ts;
+	char *p;
+
+	(void)snprintf(body, sizeof(body),
+		       "GPRMC,%02lu%02lu%02lu.%03lu,A,4807.038,N,01131.000,E,"
+		       "022.4,084.4,230394,003.1,W",
+		       (n / 3600000) % 24, (n / 60000) % 60, (n / 1000) % 60,
+		       n % 1000);
+	for (p = body; *p != '\0'; p++)
+	    sum ^= (unsigned char)*p;
+	(void)snprintf(line, sizeof(line), "$%s*%02X\r\n", body, sum);
+	(void)sendto(s, line, strlen(line), 0,
+		     (struct sockaddr *)&to, sizeof(to));
+	n++;
+	next += period;
+	ts.tv_sec = (time_t)(next / 1000000000ULL);
+	ts.tv_nsec = (long)(next % 1000000000ULL);
+	(void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static unsigned long follow_ring(int seconds, uint64_t *lat, size_t *nlat,
+				 unsigned long *lost)
+{
+    struct gps_ring_t *ring = gps_ring_open();
+    struct gps_ring_record_t rec;
+    uint64_t end = now_ns() + (uint64_t)seconds * 1000000000ULL;
+    unsigned long n = 0;
+
+    if (ring == NULL) {
+	(void)fprintf(stderr, "ringbench: no event ring (is gpsd running?)\n");
+	exit(EXIT_FAILURE);
+    }
+    while (now_ns() < end) {
+	int st = gps_ring_next(ring, &rec, 100);
+
+	if (st <= 0)
+	    continue;
+	if (rec.kind != GPS_RING_FIX)
+	    continue;
+	n++;
+	if (*nlat < MAXLAT)
+	    lat[(*nlat)++] = now_ns() - rec.ts;
+    }
+    *lost = gps_ring_lost(ring);
+    gps_ring_close(ring);
+    return n;
+}
+
+static unsigned long follow_json(int seconds)
+{
+    struct gps_data_t gpsdata;
+    uint64_t end = now_ns() + (uint64_t)seconds * 1000000000ULL;
+    unsigned long n = 0;
+
+    if (gps_open("localhost", DEFAULT_GPSD_PORT, &gpsdata) != 0) {
+	(void)fprintf(stderr, "ringbench: no gpsd socket\n");
+	exit(EXIT_FAILURE);
+    }
+    (void)gps_stream(&gpsdata, WATCH_ENABLE | WATCH_JSON, NULL);
+    while (now_ns() < end) {
+	if (!gps_waiting(&gpsdata, 100000))
+	    continue;
+	if (gps_read(&gpsdata) == -1)
+	    break;
+	if (strstr(gps_data(&gpsdata), "\"class\":\"TPV\"") != NULL)
+	    n++;
+    }
+    (void)gps_close(&gpsdata);
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    int port = 5002, rate = 1000, seconds = 10, option;
+    uint64_t *lat = NULL;
+    size_t nlat = 0;
+    unsigned long n, lost = 0;
+    double cpu;
+    pid_t feeder;
+    bool ring;
+
+    while ((option = getopt(argc, argv, "p:r:s:")) != -1) {
+	switch (option) {
+	case 'p':
+	    port = atoi(optarg);
+	    break;
+	case 'r':
+	    rate = atoi(optarg);
+	    break;
+	case 's':
+	    seconds = atoi(optarg);
+	    break;
+	default:
+	    (void)fprintf(stderr,
+			  "usage: ringbench [-p udpport] [-r rate] [-s seconds] ring|json\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+    if (optind >= argc || rate <= 0
+	|| (strcmp(argv[optind], "ring") != 0
+	    && strcmp(argv[optind], "json") != 0)) {
+	(void)fprintf(stderr, "ringbench: say ring or json\n");
+	exit(EXIT_FAILURE);
+    }
+    ring = strcmp(argv[optind], "ring") == 0;
+
+    if ((feeder = fork()) == 0)
+	feed(port, rate);
+    if (ring && (lat = malloc(sizeof(uint64_t) * MAXLAT)) == NULL)
+	exit(EXIT_FAILURE);
+
+    cpu = cpu_seconds();
+    n = ring ? follow_ring(seconds, lat, &nlat, &lost) : follow_json(seconds);
+    cpu = cpu_seconds() - cpu;
+    (void)kill(feeder, SIGTERM);
+    (void)waitpid(feeder, NULL, 0);
+
+    (void)printf("%s: %lu fixes in %ds (%d/s sent), %.1f%% delivered\n",
+		 argv[optind], n, seconds, rate,
+		 100.0 * n / ((double)rate * seconds));
+    (void)printf("%s: reader cpu %.3fs, %.2fus per fix\n",
+		 argv[optind], cpu, n ? cpu * 1e6 / n : 0.0);
+    if (ring) {
+	(void)printf("ring: %lu records lost to overruns\n", lost);
+	if (nlat > 0) {
+	    qsort(lat, nlat, sizeof(uint64_t), cmp_u64);
+	    (void)printf("ring: report->reader p50 %.1fus p99 %.1fus max %.1fus\n",
+			 lat[nlat / 2] / 1e3, lat[nlat * 99 / 100] / 1e3,
+			 lat[nlat - 1] / 1e3);
+	}
+	free(lat);
+    }
+    exit(EXIT_SUCCESS);
+}
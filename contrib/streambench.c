@@ -0,0 +1,168 @@
+/*
+ * streambench - compare JSON and binary ?WATCH streams for following a
+ * busy AIS feed.
+ *
+ * Feeds single-fragment AIVDM sentences to a gpsd UDP source at a fixed
+ * rate from a child process, follows the daemon through libgps with
+ * either encoding for a while and reports what arrived and what it cost
+ * the reader:
+ *
+ *      gpsd -N -n udp://127.0.0.1:5003 &
+ *      streambench -r 2000 json
+ *      streambench -r 2000 binary
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "../gps.h"
+
+/* a class A/B position-heavy mix, as a coastal receiver sees it */
+static const char *sentences[] = {
+    "!AIVDM,1,1,,A,15RTgt0PAso;90TKcjM8h6g208CQ,0*4A\r\n",
+    "!AIVDM,1,1,,A,16SteH0P00Jt63hHaa6SagvJ087r,0*42\r\n",
+    "!AIVDM,1,1,,B,25Cjtd0Oj;Jp7ilG7=UkKBoB0<06,0*60\r\n",
+    "!AIVDM,1,1,,A,38Id705000rRVJhE7cl9n;160000,0*40\r\n",
+    "!AIVDM,1,1,,A,B52K>;h00Fc>jpUlNV@ikwpUoP06,0*4C\r\n",
+    "!AIVDM,1,1,,A,B52KB8h006fu`Q6:g1McCwb5oP06,0*00\r\n",
+    "!AIVDM,1,1,,A,403OviQuMGCqWrRO9>E6fE700@GO,0*4D\r\n",
+    "!AIVDM,1,1,,A,H42O55i18tMET00000000000000,2*6D\r\n",
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage ru;
+
+    (void)getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+	+ (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static void feed(int port, int rate)
+/* send one AIVDM sentence per tick until killed */
+{
+    struct sockaddr_in to;
+    uint64_t next = now_ns(), period = 1000000000ULL / rate;
+    unsigned long n = 0;
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons((unsigned short)port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (;;) {
+	const char *line = sentences[n++ % (sizeof(sentences) / sizeof(sentences[0]))];
+	struct timespec ts;
+
+	(void)sendto(s, line, strlen(line), 0,
+		     (struct sockaddr *)&to, sizeof(to));
+	next += period;
+	ts.tv_sec = (time_t)(next / 1000000000ULL);
+	ts.tv_nsec = (long)(next % 1000000000ULL);
+	(void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+}
+
+static unsigned long follow(int seconds, unsigned int flags,
+			    unsigned long long *bytes)
+{
+    struct gps_data_t gpsdata;
+    uint64_t end = now_ns() + (uint64_t)seconds * 1000000000ULL;
+    unsigned long n = 0;
+
+    if (gps_open("localhost", DEFAULT_GPSD_PORT, &gpsdata) != 0) {
+	(void)fprintf(stderr, "streambench: no gpsd socket\n");
+	exit(EXIT_FAILURE);
+    }
+    (void)gps_stream(&gpsdata, WATCH_ENABLE | WATCH_JSON | flags, NULL);
+    while (now_ns() < end) {
+	int len;
+
+	if (!gps_waiting(&gpsdata, 100000))
+	    continue;
+	gpsdata.set = 0;
+	if ((len = gps_read(&gpsdata)) == -1)
+	    break;
+	*bytes += (unsigned long long)len;
+	if ((gpsdata.set & AIS_SET) != 0)
+	    n++;
+	if ((gpsdata.set & ERROR_SET) != 0) {
+	    (void)fprintf(stderr, "streambench: %s\n", gpsdata.error);
+	    break;
+	}
+    }
+    (void)gps_close(&gpsdata);
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    int port = 5003, rate = 2000, seconds = 10, option;
+    unsigned long long bytes = 0;
+    unsigned long n;
+    double cpu;
+    pid_t feeder;
+    bool binary;
+
+    while ((option = getopt(argc, argv, "p:r:s:")) != -1) {
+	switch (option) {
+	case 'p':
+	    port = atoi(optarg);
+	    break;
+	case 'r':
+	    rate = atoi(optarg);
+	    break;
+	case 's':
+	    seconds = atoi(optarg);
+	    break;
+	default:
+	    (void)fprintf(stderr,
+			  "usage: streambench [-p udpport] [-r rate] [-s seconds] json|binary\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+    if (optind >= argc || rate <= 0
+	|| (strcmp(argv[optind], "json") != 0
+	    && strcmp(argv[optind], "binary") != 0)) {
+	(void)fprintf(stderr, "streambench: say json or binary\n");
+	exit(EXIT_FAILURE);
+    }
+    binary = strcmp(argv[optind], "binary") == 0;
+
+    if ((feeder = fork()) == 0)
+	feed(port, rate);
+
+    cpu = cpu_seconds();
+    n = follow(seconds, binary ? WATCH_BINARY : 0, &bytes);
+    cpu = cpu_seconds() - cpu;
+    (void)kill(feeder, SIGTERM);
+    (void)waitpid(feeder, NULL, 0);
+
+    (void)printf("%s: %lu AIS reports in %ds (%d/s sent), %.1f%% delivered\n",
+		 argv[optind], n, seconds, rate,
+		 100.0 * n / ((double)rate * seconds));
+    (void)printf("%s: reader cpu %.3fs, %.2fus per report, %.0f bytes per report\n",
+		 argv[optind], cpu, n ? cpu * 1e6 / n : 0.0,
+		 n ? (double)bytes / n : 0.0);
+    exit(EXIT_SUCCESS);
+}
@@ -12,7 +12,7 @@
 #include "gps.h"
 #include "gpsd.h"
 
-void gpsd_throttled_report(const int errlevel UNUSED, const char * buf UNUSED) {}
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED, const char * buf UNUSED) {}
 void gpsd_report(const int debuglevel, const int errlevel, const char *fmt, ...)
 /* our version of the logger */
 {
@@ -65,7 +65,7 @@ uint32_t n2k_fixed_fast_list[] = {
     0
 };
 
-void gpsd_throttled_report(const int errlevel UNUSED, const char * buf UNUSED) {}
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED, const char * buf UNUSED) {}
 void gpsd_report(const int debuglevel, const int errlevel, const char *fmt, ...)
 /* our version of the logger */
 {
@@ -0,0 +1,365 @@
+/*
+ * derive.c - quantities computed from what the sensors report
+ *
+ * A wind sensor gives the apparent wind, a speed log the speed through
+ * the water, a compass the heading and a GPS the course and speed over
+ * the ground, each in its own reports and often from its own device.
+ * The engine keeps the last value of each of these inputs and derives
+ * from them:
+ *
+ *   true wind angle and speed to the bow, through the water
+ *   true wind direction through the water, to true north
+ *   ground wind direction and speed, true and magnetic, which stand
+ *   for the true wind direction when the course over ground is known
+ *   VMG, the boat speed made good towards the true wind
+ *   leeway from the heel, and the course through the water
+ *   set and drift of the current
+ *
+ * The rules form a small dependency graph, kept in the table below in
+ * an order where every rule comes after the rules it takes values
+ * from.  A report marks the inputs it carries; one pass over the table
+ * runs only the rules with a marked input whose required inputs are
+ * all younger than the timeout, and marks what they derive for the
+ * rules after them.  A report of the depth runs nothing.
+ *
+ * What a report led to is written into it with its PSET bits, so the
+ * pseudo-N2K, pseudo-NMEA and Signal K outputs send it along, unless
+ * the report carries the quantity itself.  derive_restore() takes it
+ * out again before the JSON clients see the device's data.
+ *
+ * Angles are kept in degrees and speeds in knots; the wind in struct
+ * environment_t is in m/s.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+#define DERIVE_TIMEOUT	5.0	/* seconds */
+#define MIN_STW		1.0	/* knots, slower gives no leeway */
+#define MAX_LEEWAY	45.0	/* degrees */
+
+#define B(q)		DERIVE_BIT(derive_##q)
+
+struct derive_rule_t {
+    uint32_t needs;			/* inputs that must be good */
+    uint32_t uses;			/* optional, also rerun the rule */
+    /* derive into d->value[], returning the quantities set */
+    uint32_t (*run)(struct derive_t *, timestamp_t);
+};
+
+static bool fresh(const struct derive_t *d, int q, timestamp_t now)
+{
+    return d->time[q] > 0 && now - d->time[q] <= d->timeout;
+}
+
+static double wrap360(double angle)
+{
+    angle = fmod(angle, 360.0);
+    return angle < 0 ? angle + 360.0 : angle;
+}
+
+static uint32_t rule_heading(struct derive_t *d, timestamp_t now)
+/* a true heading, from the magnetic one if need be */
+{
+    double *v = d->value;
+
+    if (fresh(d, derive_hdg_true, now))
+	v[derive_heading] = v[derive_hdg_true];
+    else if (fresh(d, derive_hdg_magn, now) && fresh(d, derive_variation, now))
+	v[derive_heading] = wrap360(v[derive_hdg_magn] + v[derive_variation]);
+    else
+	return 0;
+    return B(heading);
+}
+
+static uint32_t rule_leeway(struct derive_t *d, timestamp_t now UNUSED)
+/* leeway grows with the heel and falls with the square of the speed */
+{
+    double *v = d->value;
+    double leeway;
+
+    if (d->leeway_k <= 0 || v[derive_stw] < MIN_STW)
+	return 0;
+    leeway = d->leeway_k * v[derive_heel] / (v[derive_stw] * v[derive_stw]);
+    if (leeway > MAX_LEEWAY)
+	leeway = MAX_LEEWAY;
+    else if (leeway < -MAX_LEEWAY)
+	leeway = -MAX_LEEWAY;
+    v[derive_leeway] = leeway;
+    return B(leeway);
+}
+
+static uint32_t rule_true_wind(struct derive_t *d, timestamp_t now)
+/* the apparent wind less the wind of the boat's own way through water */
+{
+    double *v = d->value;
+    double a = v[derive_awa] * DEG_2_RAD, l = 0, x, y;
+
+    if (fresh(d, derive_leeway, now))
+	l = v[derive_leeway] * DEG_2_RAD;
+    x = v[derive_aws] * cos(a) - v[derive_stw] * cos(l);
+    y = v[derive_aws] * sin(a) - v[derive_stw] * sin(l);
+    v[derive_twa] = wrap360(atan2(y, x) * RAD_2_DEG);
+    v[derive_tws] = hypot(x, y);
+    return B(twa) | B(tws);
+}
+
+static uint32_t rule_twd(struct derive_t *d, timestamp_t now UNUSED)
+{
+    d->value[derive_twd] =
+	wrap360(d->value[derive_heading] + d->value[derive_twa]);
+    return B(twd);
+}
+
+static uint32_t rule_ground_wind(struct derive_t *d, timestamp_t now UNUSED)
+/* the apparent wind less the wind of the boat's way over the ground */
+{
+    double *v = d->value;
+    double a = (v[derive_heading] + v[derive_awa]) * DEG_2_RAD;
+    double c = v[derive_cog] * DEG_2_RAD, east, north;
+
+    east = v[derive_aws] * sin(a) - v[derive_sog] * sin(c);
+    north = v[derive_aws] * cos(a) - v[derive_sog] * cos(c);
+    v[derive_gwd] = wrap360(atan2(east, north) * RAD_2_DEG);
+    v[derive_gws] = hypot(east, north);
+    return B(gwd) | B(gws);
+}
+
+static uint32_t rule_mwd(struct derive_t *d, timestamp_t now UNUSED)
+{
+    d->value[derive_mwd] =
+	wrap360(d->value[derive_gwd] - d->value[derive_variation]);
+    return B(mwd);
+}
+
+static uint32_t rule_vmg(struct derive_t *d, timestamp_t now UNUSED)
+{
+    d->value[derive_vmg] =
+	d->value[derive_stw] * cos(d->value[derive_twa] * DEG_2_RAD);
+    return B(vmg);
+}
+
+static uint32_t rule_ctw(struct derive_t *d, timestamp_t now UNUSED)
+{
+    d->value[derive_ctw] =
+	wrap360(d->value[derive_heading] + d->value[derive_leeway]);
+    return B(ctw);
+}
+
+static uint32_t rule_current(struct derive_t *d, timestamp_t now)
+/* the way over the ground less the way through the water */
+{
+    double *v = d->value;
+    double c = v[derive_cog] * DEG_2_RAD, w = v[derive_heading], east, north;
+
+    if (fresh(d, derive_leeway, now))
+	w += v[derive_leeway];
+    w *= DEG_2_RAD;
+    east = v[derive_sog] * sin(c) - v[derive_stw] * sin(w);
+    north = v[derive_sog] * cos(c) - v[derive_stw] * cos(w);
+    v[derive_set] = wrap360(atan2(east, north) * RAD_2_DEG);
+    v[derive_drift] = hypot(east, north);
+    return B(set) | B(drift);
+}
+
+/* in dependency order */
+static const struct derive_rule_t rules[] = {
+    {0, B(hdg_true) | B(hdg_magn) | B(variation), rule_heading},
+    {B(heel) | B(stw), 0, rule_leeway},
+    {B(awa) | B(aws) | B(stw), B(leeway), rule_true_wind},
+    {B(twa) | B(tws) | B(heading), 0, rule_twd},
+    {B(awa) | B(aws) | B(heading) | B(sog) | B(cog), 0, rule_ground_wind},
+    {B(gwd) | B(variation), 0, rule_mwd},
+    {B(stw) | B(twa), 0, rule_vmg},
+    {B(heading) | B(leeway), 0, rule_ctw},
+    {B(sog) | B(cog) | B(stw) | B(heading), B(leeway), rule_current},
+};
+
+void derive_init(/*@out@*/struct derive_t *d)
+{
+    memset(d, 0, sizeof(*d));
+    d->timeout = DERIVE_TIMEOUT;
+}
+
+static void input(struct derive_t *d, int q, double value, timestamp_t now,
+		  uint32_t *dirty)
+{
+    if (isnan(value))
+	return;
+    d->value[q] = value;
+    d->time[q] = now;
+    *dirty |= DERIVE_BIT(q);
+}
+
+static uint32_t derive_inputs(struct derive_t *d,
+			      const struct gps_data_t *gpsdata,
+			      gps_mask_t changed, timestamp_t now)
+/* take the inputs a report carries */
+{
+    const struct navigation_t *nav = &gpsdata->navigation;
+    const struct environment_t *env = &gpsdata->environment;
+    uint32_t dirty = 0;
+
+    if ((changed & ENVIRONMENT_SET) != 0) {
+	if ((env->set & ENV_WIND_APPARENT_ANGLE_PSET) != 0)
+	    input(d, derive_awa, env->wind[wind_apparent].angle, now, &dirty);
+	if ((env->set & ENV_WIND_APPARENT_SPEED_PSET) != 0)
+	    input(d, derive_aws, env->wind[wind_apparent].speed
+		  * MPS_TO_KNOTS, now, &dirty);
+	if ((env->set & ENV_VARIATION_PSET) != 0)
+	    input(d, derive_variation, env->variation, now, &dirty);
+    }
+    if ((changed & NAVIGATION_SET) != 0) {
+	if ((nav->set & NAV_STW_PSET) != 0)
+	    input(d, derive_stw, nav->speed_thru_water, now, &dirty);
+	if ((nav->set & NAV_SOG_PSET) != 0)
+	    input(d, derive_sog, nav->speed_over_ground, now, &dirty);
+	if ((nav->set & NAV_COG_TRUE_PSET) != 0)
+	    input(d, derive_cog, nav->course_over_ground[compass_true], now,
+		  &dirty);
+	if ((nav->set & NAV_HDG_TRUE_PSET) != 0)
+	    input(d, derive_hdg_true, nav->heading[compass_true], now, &dirty);
+	if ((nav->set & NAV_HDG_MAGN_PSET) != 0)
+	    input(d, derive_hdg_magn, nav->heading[compass_magnetic], now,
+		  &dirty);
+    }
+    if ((changed & ATTITUDE_SET) != 0)
+	input(d, derive_heel, gpsdata->attitude.roll, now, &dirty);
+    return dirty;
+}
+
+static void wind(struct environment_t *env, enum wind_reference_t ref,
+		 gps_mask_t anglebit, gps_mask_t speedbit, double angle,
+		 double speed)
+/* write a derived wind unless the report has it */
+{
+    if ((env->set & (anglebit | speedbit)) != 0)
+	return;
+    env->wind[ref].angle = angle;
+    env->wind[ref].speed = speed * KNOTS_TO_MPS;
+    env->set |= anglebit | speedbit;
+}
+
+gps_mask_t derive_update(struct derive_t *d, struct gps_data_t *gpsdata,
+			 gps_mask_t changed, timestamp_t now,
+			 /*@out@*/struct derive_saved_t *saved)
+/*
+ * Take a report's inputs, rerun the rules they feed and write what
+ * they derived into the report; returns its change mask with that.
+ * The data is changed until derive_restore().
+ */
+{
+    struct navigation_t *nav = &gpsdata->navigation;
+    struct environment_t *env = &gpsdata->environment;
+    const double *v = d->value;
+    uint32_t dirty, written = 0, bits;
+    gps_mask_t navbits = 0;
+    size_t i;
+
+    saved->set = gpsdata->set;
+    saved->navset = nav->set;
+    saved->vmg = nav->vmg;
+    saved->leeway = nav->leeway;
+    saved->course_thru_water = nav->course_thru_water;
+    saved->current_set = nav->current_set;
+    saved->current_drift = nav->current_drift;
+    saved->environment = *env;
+
+    d->updates++;
+    if ((dirty = derive_inputs(d, gpsdata, changed, now)) == 0)
+	return changed;
+
+    for (i = 0; i < sizeof(rules) / sizeof(rules[0]); i++) {
+	const struct derive_rule_t *r = &rules[i];
+	uint32_t needs = r->needs;
+	int q;
+
+	if ((dirty & (r->needs | r->uses)) == 0)
+	    continue;
+	while (needs != 0) {
+	    q = __builtin_ctz(needs);
+	    if (!fresh(d, q, now))
+		break;
+	    needs &= needs - 1;
+	}
+	if (needs != 0)
+	    continue;
+	bits = r->run(d, now);
+	d->runs++;
+	for (needs = bits; needs != 0; needs &= needs - 1)
+	    d->time[__builtin_ctz(needs)] = now;
+	dirty |= bits;
+	written |= bits;
+    }
+
+    if ((written & (B(twa) | B(twd) | B(gwd) | B(mwd))) != 0) {
+	/* a report without the environment must not send an old one */
+	if ((changed & ENVIRONMENT_SET) == 0)
+	    env->set = 0;
+	if ((written & B(twa)) != 0)
+	    wind(env, wind_true_to_boat, ENV_WIND_TRUE_TO_BOAT_ANGLE_PSET,
+		 ENV_WIND_TRUE_TO_BOAT_SPEED_PSET, v[derive_twa],
+		 v[derive_tws]);
+	/* the direction to north is over the ground where it can be */
+	if ((written & B(gwd)) != 0)
+	    wind(env, wind_true_north, ENV_WIND_TRUE_NORTH_ANGLE_PSET,
+		 ENV_WIND_TRUE_NORTH_SPEED_PSET, v[derive_gwd],
+		 v[derive_gws]);
+	else if ((written & B(twd)) != 0)
+	    wind(env, wind_true_north, ENV_WIND_TRUE_NORTH_ANGLE_PSET,
+		 ENV_WIND_TRUE_NORTH_SPEED_PSET, v[derive_twd],
+		 v[derive_tws]);
+	if ((written & B(mwd)) != 0)
+	    wind(env, wind_magnetic_north, ENV_WIND_MAGN_ANGLE_PSET,
+		 ENV_WIND_MAGN_SPEED_PSET, v[derive_mwd], v[derive_gws]);
+	changed |= ENVIRONMENT_SET;
+    }
+
+    if ((written & B(vmg)) != 0) {
+	nav->vmg = v[derive_vmg];
+	navbits |= NAV_VMG_PSET;
+    }
+    if ((written & B(leeway)) != 0) {
+	nav->leeway = v[derive_leeway];
+	navbits |= NAV_LEEWAY_PSET;
+    }
+    if ((written & B(ctw)) != 0) {
+	nav->course_thru_water = v[derive_ctw];
+	navbits |= NAV_CTW_PSET;
+    }
+    if ((written & B(set)) != 0) {
+	nav->current_set = v[derive_set];
+	nav->current_drift = v[derive_drift];
+	navbits |= NAV_CURRENT_PSET;
+    }
+    if (navbits != 0) {
+	if ((changed & NAVIGATION_SET) == 0)
+	    nav->set = 0;
+	nav->set |= navbits;
+	changed |= NAVIGATION_SET;
+    }
+
+    gpsdata->set |= changed & (ENVIRONMENT_SET | NAVIGATION_SET);
+    return changed;
+}
+
+void derive_restore(struct gps_data_t *gpsdata,
+		    const struct derive_saved_t *saved)
+/* take out what derive_update() wrote */
+{
+    struct navigation_t *nav = &gpsdata->navigation;
+
+    gpsdata->set = saved->set;
+    nav->set = saved->navset;
+    nav->vmg = saved->vmg;
+    nav->leeway = saved->leeway;
+    nav->course_thru_water = saved->course_thru_water;
+    nav->current_set = saved->current_set;
+    nav->current_drift = saved->current_drift;
+    gpsdata->environment = saved->environment;
+}
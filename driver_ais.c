@@ -1115,4 +1115,126 @@ bool ais_binary_decode(const int debug,
 }
 /*@ -charint @*/
 
+static bool aivdm_dearmor(const char *data, size_t len,
+			  unsigned char *bits, size_t bitsize, size_t *bitlen)
+/* append six-bit armored characters to a bit vector */
+{
+    size_t i;
+
+    /*@ +charint -shiftnegative @*/
+    for (i = 0; i < len; i++) {
+	unsigned char ch = (unsigned char)data[i] - 48;
+	int j;
+
+	/* wacky 6-bit encoding, shades of FIELDATA */
+	if (ch >= 40)
+	    ch -= 8;
+	if (*bitlen + 6 > bitsize * 8)
+	    return false;
+	for (j = 5; j >= 0; j--) {
+	    if ((ch >> j) & 0x01)
+		bits[*bitlen / 8] |= (1 << (7 - *bitlen % 8));
+	    (*bitlen)++;
+	}
+    }
+    /*@ -charint +shiftnegative @*/
+    return true;
+}
+
+static void aivdm_drop(struct aivdm_reassembly_t *r, struct aivdm_frag_t *fp,
+		       const char *why, const int debug)
+{
+    gpsd_report(debug, LOG_INF,
+		"AIVDM: dropping %s message %d on channel %c, "
+		"%d fragments, mask %x.\n",
+		why, fp->seqid, fp->channel, fp->nfrags, fp->have);
+    fp->source = 0;
+    r->dropped++;
+}
+
+int aivdm_reassemble(struct aivdm_reassembly_t *r,
+		     unsigned int source, char channel, int seqid,
+		     int nfrags, int ifrag, const char *data, unsigned int pad,
+		     timestamp_t now,
+		     /*@out@*/unsigned char *bits, size_t bitsize,
+		     size_t *bitlen, const int debug)
+/*
+ * File one fragment of an armored AIS payload.  Returns 1 when bits holds
+ * a complete message, 0 while more fragments are awaited, -1 if the
+ * fragment is unusable.  source is any nonzero token distinguishing
+ * senders that may reuse each other's sequential message IDs.
+ */
+{
+    struct aivdm_frag_t *fp = NULL, *freep = NULL, *oldest = NULL;
+    size_t len = strlen(data);
+    bool ok = true;
+    int i;
+
+    (void)memset(bits, '\0', bitsize);
+    *bitlen = 0;
+    if (nfrags < 1 || nfrags > AIVDM_FRAG_MAX || ifrag < 1 || ifrag > nfrags
+	|| len >= NMEA_MAX || pad > 5) {
+	gpsd_report(debug, LOG_ERROR,
+		    "AIVDM: invalid fragment #%d of %d.\n", ifrag, nfrags);
+	return -1;
+    }
+
+    if (nfrags > 1) {
+	for (i = 0; i < AIVDM_FRAG_SLOTS; i++) {
+	    struct aivdm_frag_t *sp = &r->slot[i];
+
+	    if (sp->source != 0 && now - sp->started > AIVDM_FRAG_TTL)
+		aivdm_drop(r, sp, "stale", debug);
+	    if (sp->source == 0) {
+		if (freep == NULL)
+		    freep = sp;
+	    } else if (sp->source == source && sp->channel == channel
+		       && sp->seqid == seqid)
+		fp = sp;
+	    else if (oldest == NULL || sp->started < oldest->started)
+		oldest = sp;
+	}
+	if (fp != NULL && (fp->nfrags != nfrags
+			   || (fp->have & (1u << (ifrag - 1))) != 0)) {
+	    /* the ID has been reused before the last message completed */
+	    aivdm_drop(r, fp, "incomplete", debug);
+	} else if (fp == NULL) {
+	    if ((fp = freep) == NULL) {
+		fp = oldest;
+		aivdm_drop(r, fp, "crowded-out", debug);
+	    }
+	}
+	if (fp->source == 0) {
+	    fp->source = source;
+	    fp->channel = channel;
+	    fp->seqid = seqid;
+	    fp->nfrags = nfrags;
+	    fp->have = 0;
+	    fp->started = now;
+	}
+	(void)memcpy(fp->data[ifrag - 1], data, len);
+	fp->len[ifrag - 1] = (unsigned char)len;
+	fp->have |= 1u << (ifrag - 1);
+	if (ifrag == nfrags)
+	    fp->pad = (unsigned char)pad;
+	if (fp->have != (1u << nfrags) - 1)
+	    return 0;
+
+	/* all here; the slot is free again whatever the payload holds */
+	fp->source = 0;
+	r->completed++;
+	for (i = 0; ok && i < nfrags; i++)
+	    ok = aivdm_dearmor(fp->data[i], fp->len[i], bits, bitsize, bitlen);
+	pad = fp->pad;
+    } else
+	ok = aivdm_dearmor(data, len, bits, bitsize, bitlen);
+
+    if (!ok) {
+	gpsd_report(debug, LOG_INF, "overlong AIVDM payload truncated.\n");
+	return -1;
+    }
+    *bitlen -= pad < *bitlen ? pad : *bitlen;
+    return 1;
+}
+
 /* driver_ais.c ends here */
@@ -868,8 +868,6 @@ static gps_mask_t processGPZDA(int c UNUSED, char *field[],
     return mask;
 }
 
-extern float HDGboat;
-
 static gps_mask_t processHDG(int c UNUSED, char *field[],
     struct gps_device_t *session)
 {
@@ -896,7 +894,10 @@ static gps_mask_t processHDG(int c UNUSED, char *field[],
 
     session->gpsdata.navigation.set        |= NAV_HDG_MAGN_PSET;
     session->gpsdata.navigation.heading[compass_magnetic] = safe_atof(field[1]);
-    HDGboat = session->gpsdata.navigation.heading[compass_magnetic];
+    /* with an arbiter the daemon notes the heading it chose */
+    if (session->context->arbiter == NULL)
+	nmea_xform_note(session->context->xform, XFORM_VAR_HEADING,
+			session->gpsdata.navigation.heading[compass_magnetic]);
 
     session->gpsdata.environment.set       |= ENV_DEVIATION_PSET;
     session->gpsdata.environment.deviation = safe_atof(field[2]);
@@ -1954,93 +1955,183 @@ static gps_mask_t processMTK3301(int c UNUSED, char *field[],
  *
  **************************************************************************/
 
-gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session) {
-
-    return nmea_parse_len(sentence, strlen(sentence), session);
-}
-
-/*@ -mayaliasunique @*/
-gps_mask_t nmea_parse_len(char *sentence, size_t sentence_len, struct gps_device_t * session)
-/* parse an NMEA sentence, unpack it into a session structure */
+/*
+ * Sentence dispatch.  Phrases are numbered in table order, and the
+ * numbers are what the cycle-end detector keeps in its bitmasks, so new
+ * entries go at the end.
+ */
+enum nmea_tag {
+    NMEA_TAG_NONE,
+    NMEA_TAG_PGRMC, NMEA_TAG_PGRME, NMEA_TAG_PGRMI, NMEA_TAG_PGRMO,
+    NMEA_TAG_APA, NMEA_TAG_APB, NMEA_TAG_DBT, NMEA_TAG_DPT,
+    NMEA_TAG_GGA, NMEA_TAG_GLL, NMEA_TAG_GST, NMEA_TAG_GSA,
+    NMEA_TAG_GSV, NMEA_TAG_GBS, NMEA_TAG_HDG, NMEA_TAG_HDM,
+    NMEA_TAG_HDT, NMEA_TAG_MDA, NMEA_TAG_MTW, NMEA_TAG_MWD,
+    NMEA_TAG_MWV, NMEA_TAG_RMC, NMEA_TAG_RMB, NMEA_TAG_ROT,
+    NMEA_TAG_RSA, NMEA_TAG_VHW, NMEA_TAG_VLW, NMEA_TAG_VTG,
+    NMEA_TAG_VWR, NMEA_TAG_XTE, NMEA_TAG_ZDA,
+    NMEA_TAG_PTNTHTM, NMEA_TAG_PASHR, NMEA_TAG_OHPR, NMEA_TAG_PMTK,
+    NMEA_TAG_COUNT,
+};
+
+typedef gps_mask_t(*nmea_decoder) (int count, char *f[],
+				   struct gps_device_t * session);
+
+static const struct
 {
-    typedef gps_mask_t(*nmea_decoder) (int count, char *f[],
-				       struct gps_device_t * session);
-    static struct
-    {
-	char *name;
-	int nf;			/* minimum number of fields required to parse */
-	bool cycle_continue;	/* cycle continuer? */
-	nmea_decoder decoder;
-    } nmea_phrase[] = {
-	/*@ -nullassign @*/
-	{"PGRMC", 0, false, NULL},	/* ignore Garmin Sensor Config */
-	{"PGRME", 7, false, processPGRME},
-	{"PGRMI", 0, false, NULL},	/* ignore Garmin Sensor Init */
-	{"PGRMO", 0, false, NULL},	/* ignore Garmin Sentence Enable */
-	    /*
-	     * Basic sentences must come after the PG* ones, otherwise
-	     * Garmins can get stuck in a loop that looks like this:
-	     *
-	     * 1. A Garmin GPS in NMEA mode is detected.
-	     *
-	     * 2. PGRMC is sent to reconfigure to Garmin binary mode.
-	     *    If successful, the GPS echoes the phrase.
-	     *
-	     * 3. nmea_parse() sees the echo as RMC because the talker
-	     *    ID is ignored, and fails to recognize the echo as
-	     *    PGRMC and ignore it.
-	     *
-	     * 4. The mode is changed back to NMEA, resulting in an
-	     *    infinite loop.
-	     */
+    char *name;
+    int nf;			/* minimum number of fields required to parse */
+    bool cycle_continue;	/* cycle continuer? */
+    nmea_decoder decoder;
+} nmea_phrase[NMEA_TAG_COUNT] = {
+    /*@ -nullassign @*/
+    [NMEA_TAG_PGRMC] = {"PGRMC", 0, false, NULL},	/* ignore Garmin Sensor Config */
+    [NMEA_TAG_PGRME] = {"PGRME", 7, false, processPGRME},
+    [NMEA_TAG_PGRMI] = {"PGRMI", 0, false, NULL},	/* ignore Garmin Sensor Init */
+    [NMEA_TAG_PGRMO] = {"PGRMO", 0, false, NULL},	/* ignore Garmin Sentence Enable */
+    /*
+     * A Garmin in NMEA mode echoes the PGRMC that switches it to
+     * binary.  Were the echo taken for RMC (the talker ID is ignored),
+     * the mode would be switched back to NMEA, and so on forever;
+     * nmea_parse_len() looks for the whole tag before the talker-less
+     * one for that reason.
+     */
     // HSC, MDA, MWD, RPM, VBW, VDR,
-    {"APA", 10, false, processAPA},
-    {"APB", 14, false, processAPB},
-    {"DBT", 7,  false, processDBT},
-    {"DPT", 2,  false, processDPT},
-	{"GGA", 13, false, processGPGGA},
-    {"GLL", 7,  false, processGPGLL},
-	{"GST", 8,  false, processGPGST},
-	{"GSA", 17, false, processGPGSA},
-	{"GSV", 0,  false, processGPGSV},
-	{"GBS", 7,  false, processGPGBS},
-    {"HDG", 3,  false, processHDG},
-    {"HDM", 1,  false, processHDM},
-    {"HDT", 1,  false, processHDT},
-    {"MDA", 20, false, processMDA},
-    {"MTW", 1,  false, processMTW},
-    {"MWD", 8,  false, processMWD},
-    {"MWV", 4,  false, processMWV},
-    {"RMC", 8,  false, processGPRMC},
-    {"RMB", 13, false, processRMB},
-	{"ROT", 1,  false, processROT},
-	{"RSA", 3,  false, processRSA},
-	{"VHW", 8,  false, processVHW},
-	{"VLW", 4,  false, processVLW},
-	{"VTG", 8,  false, processVTG},
-	{"VWR", 8,  false, processVWR},
-	{"XTE", 5,  false, processXTE},
-    {"ZDA", 4,  false, processGPZDA},
+    [NMEA_TAG_APA] = {"APA", 10, false, processAPA},
+    [NMEA_TAG_APB] = {"APB", 14, false, processAPB},
+    [NMEA_TAG_DBT] = {"DBT", 7,  false, processDBT},
+    [NMEA_TAG_DPT] = {"DPT", 2,  false, processDPT},
+    [NMEA_TAG_GGA] = {"GGA", 13, false, processGPGGA},
+    [NMEA_TAG_GLL] = {"GLL", 7,  false, processGPGLL},
+    [NMEA_TAG_GST] = {"GST", 8,  false, processGPGST},
+    [NMEA_TAG_GSA] = {"GSA", 17, false, processGPGSA},
+    [NMEA_TAG_GSV] = {"GSV", 0,  false, processGPGSV},
+    [NMEA_TAG_GBS] = {"GBS", 7,  false, processGPGBS},
+    [NMEA_TAG_HDG] = {"HDG", 3,  false, processHDG},
+    [NMEA_TAG_HDM] = {"HDM", 1,  false, processHDM},
+    [NMEA_TAG_HDT] = {"HDT", 1,  false, processHDT},
+    [NMEA_TAG_MDA] = {"MDA", 20, false, processMDA},
+    [NMEA_TAG_MTW] = {"MTW", 1,  false, processMTW},
+    [NMEA_TAG_MWD] = {"MWD", 8,  false, processMWD},
+    [NMEA_TAG_MWV] = {"MWV", 4,  false, processMWV},
+    [NMEA_TAG_RMC] = {"RMC", 8,  false, processGPRMC},
+    [NMEA_TAG_RMB] = {"RMB", 13, false, processRMB},
+    [NMEA_TAG_ROT] = {"ROT", 1,  false, processROT},
+    [NMEA_TAG_RSA] = {"RSA", 3,  false, processRSA},
+    [NMEA_TAG_VHW] = {"VHW", 8,  false, processVHW},
+    [NMEA_TAG_VLW] = {"VLW", 4,  false, processVLW},
+    [NMEA_TAG_VTG] = {"VTG", 8,  false, processVTG},
+    [NMEA_TAG_VWR] = {"VWR", 8,  false, processVWR},
+    [NMEA_TAG_XTE] = {"XTE", 5,  false, processXTE},
+    [NMEA_TAG_ZDA] = {"ZDA", 4,  false, processGPZDA},
 #ifdef TNT_ENABLE
-	{"PTNTHTM", 9, false, processTNTHTM},
+    [NMEA_TAG_PTNTHTM] = {"PTNTHTM", 9, false, processTNTHTM},
 #endif /* TNT_ENABLE */
 #ifdef ASHTECH_ENABLE
-	{"PASHR", 3, false, processPASHR},	/* general handler for Ashtech */
+    [NMEA_TAG_PASHR] = {"PASHR", 3, false, processPASHR},	/* general handler for Ashtech */
 #endif /* ASHTECH_ENABLE */
 #ifdef OCEANSERVER_ENABLE
-	{"OHPR", 18, false, processOHPR},
+    [NMEA_TAG_OHPR] = {"OHPR", 18, false, processOHPR},
 #endif /* OCEANSERVER_ENABLE */
-	    /*@ +nullassign @*/
 #ifdef MTK3301_ENABLE
-	{"PMTK", 3,  false, processMTK3301},
+    [NMEA_TAG_PMTK] = {"PMTK", 3,  false, processMTK3301},
 #endif /* MTK3301_ENABLE */
-    };
+    /*@ +nullassign @*/
+};
+
+/*
+ * The whole tag and the talker-less one end in the same three letters,
+ * so the hash is taken over those and the length.  The multipliers make
+ * it collision-free over the table; a new phrase that collides will show
+ * up as an empty slot in test_nmea.
+ */
+#define NMEA_HASH_SIZE	64
+#define NMEA_HASH(len, a, b, c) \
+    ((unsigned)((a) * 13 + (b) * 3 + (c) + (len) * 3) & (NMEA_HASH_SIZE - 1))
+#define NMEA_HASH3(a, b, c)	NMEA_HASH(3, a, b, c)
+
+static const unsigned char nmea_hash[NMEA_HASH_SIZE] = {
+    [NMEA_HASH(5, 'R', 'M', 'C')] = NMEA_TAG_PGRMC,
+    [NMEA_HASH(5, 'R', 'M', 'E')] = NMEA_TAG_PGRME,
+    [NMEA_HASH(5, 'R', 'M', 'I')] = NMEA_TAG_PGRMI,
+    [NMEA_HASH(5, 'R', 'M', 'O')] = NMEA_TAG_PGRMO,
+    [NMEA_HASH3('A', 'P', 'A')] = NMEA_TAG_APA,
+    [NMEA_HASH3('A', 'P', 'B')] = NMEA_TAG_APB,
+    [NMEA_HASH3('D', 'B', 'T')] = NMEA_TAG_DBT,
+    [NMEA_HASH3('D', 'P', 'T')] = NMEA_TAG_DPT,
+    [NMEA_HASH3('G', 'G', 'A')] = NMEA_TAG_GGA,
+    [NMEA_HASH3('G', 'L', 'L')] = NMEA_TAG_GLL,
+    [NMEA_HASH3('G', 'S', 'T')] = NMEA_TAG_GST,
+    [NMEA_HASH3('G', 'S', 'A')] = NMEA_TAG_GSA,
+    [NMEA_HASH3('G', 'S', 'V')] = NMEA_TAG_GSV,
+    [NMEA_HASH3('G', 'B', 'S')] = NMEA_TAG_GBS,
+    [NMEA_HASH3('H', 'D', 'G')] = NMEA_TAG_HDG,
+    [NMEA_HASH3('H', 'D', 'M')] = NMEA_TAG_HDM,
+    [NMEA_HASH3('H', 'D', 'T')] = NMEA_TAG_HDT,
+    [NMEA_HASH3('M', 'D', 'A')] = NMEA_TAG_MDA,
+    [NMEA_HASH3('M', 'T', 'W')] = NMEA_TAG_MTW,
+    [NMEA_HASH3('M', 'W', 'D')] = NMEA_TAG_MWD,
+    [NMEA_HASH3('M', 'W', 'V')] = NMEA_TAG_MWV,
+    [NMEA_HASH3('R', 'M', 'C')] = NMEA_TAG_RMC,
+    [NMEA_HASH3('R', 'M', 'B')] = NMEA_TAG_RMB,
+    [NMEA_HASH3('R', 'O', 'T')] = NMEA_TAG_ROT,
+    [NMEA_HASH3('R', 'S', 'A')] = NMEA_TAG_RSA,
+    [NMEA_HASH3('V', 'H', 'W')] = NMEA_TAG_VHW,
+    [NMEA_HASH3('V', 'L', 'W')] = NMEA_TAG_VLW,
+    [NMEA_HASH3('V', 'T', 'G')] = NMEA_TAG_VTG,
+    [NMEA_HASH3('V', 'W', 'R')] = NMEA_TAG_VWR,
+    [NMEA_HASH3('X', 'T', 'E')] = NMEA_TAG_XTE,
+    [NMEA_HASH3('Z', 'D', 'A')] = NMEA_TAG_ZDA,
+#ifdef TNT_ENABLE
+    [NMEA_HASH(7, 'H', 'T', 'M')] = NMEA_TAG_PTNTHTM,
+#endif /* TNT_ENABLE */
+#ifdef ASHTECH_ENABLE
+    [NMEA_HASH(5, 'S', 'H', 'R')] = NMEA_TAG_PASHR,
+#endif /* ASHTECH_ENABLE */
+#ifdef OCEANSERVER_ENABLE
+    [NMEA_HASH(4, 'H', 'P', 'R')] = NMEA_TAG_OHPR,
+#endif /* OCEANSERVER_ENABLE */
+#ifdef MTK3301_ENABLE
+    [NMEA_HASH(4, 'M', 'T', 'K')] = NMEA_TAG_PMTK,
+#endif /* MTK3301_ENABLE */
+};
+
+static unsigned int nmea_lookup(const char *tag, size_t len)
+/* phrase number of a sentence tag, talker ID and all; 0 if unknown */
+{
+    const char *end = tag + len;
+    unsigned int i;
+
+    /* a bare three-letter tag has no talker ID and matches nothing */
+    if (len <= 3)
+	return NMEA_TAG_NONE;
+    /* proprietary sentences first, so that PGRMC isn't taken for RMC */
+    i = nmea_hash[NMEA_HASH(len, end[-3], end[-2], end[-1])];
+    if (i != NMEA_TAG_NONE && strcmp(nmea_phrase[i].name, tag) == 0)
+	return i;
+    if (len == 5) {
+	i = nmea_hash[NMEA_HASH3(end[-3], end[-2], end[-1])];
+	if (i != NMEA_TAG_NONE && strcmp(nmea_phrase[i].name, tag + 2) == 0)
+	    return i;
+    }
+    return NMEA_TAG_NONE;
+}
+
+gps_mask_t nmea_parse(char *sentence, struct gps_device_t * session) {
+
+    return nmea_parse_len(sentence, strlen(sentence), session);
+}
 
+/*@ -mayaliasunique @*/
+gps_mask_t nmea_parse_len(char *sentence, size_t sentence_len, struct gps_device_t * session)
+/* parse an NMEA sentence, unpack it into a session structure */
+{
     int count;
     gps_mask_t retval = 0;
     unsigned int i, thistag;
-    char *p, *s, *e;
-    volatile char *t;
+    unsigned char sum = 0;
+    const char *s, *limit;
+    char *d, *e, c;
 
     /*
      * We've had reports that on the Garmin GPS-10 the device sometimes
@@ -2053,36 +2144,50 @@ gps_mask_t nmea_parse_len(char *sentence, size_t sentence_len, struct gps_device
     if (sentence_len > NMEA_MAX) {
 	gpsd_report(session->context->debug, LOG_WARN,
 		    "Overlong packet of %zd chars rejected.\n",
-		    strlen(sentence));
+		    sentence_len);
 	return ONLINE_SET;
     }
 
+    /*
+     * One pass over the sentence makes the editable copy, splits it on
+     * commas into the field array and sums it for the checksum.  The
+     * copy stops at the '*' or at the first control character; a '*'
+     * ends the last field as a comma would, while without one the last
+     * field is dropped, as it always has been.
+     */
     /*@ -usedef @*//* splint 3.1.1 seems to have a bug here */
-    /* make an editable copy of the sentence */
-    (void)strlcpy((char *)session->driver.nmea.fieldcopy, sentence, NMEA_MAX);
-    /* discard the checksum part */
-    for (p = (char *)session->driver.nmea.fieldcopy;
-	 (*p != '*') && (*p >= ' ');)
-	++p;
-    if (*p == '*')
-	*p++ = ',';		/* otherwise we drop the last field */
-    *p = '\0';
-    e = p;
-
-    /* split sentence copy on commas, filling the field array */
+    d = (char *)session->driver.nmea.fieldcopy;
+    limit = sentence + (sentence_len < NMEA_MAX ? sentence_len : NMEA_MAX - 1);
     count = 0;
-    t = p;			/* end of sentence */
-    p = (char *)session->driver.nmea.fieldcopy + 1;	/* beginning of tag, 'G' not '$' */
-    /* while there is a search string and we haven't run off the buffer... */
-    while ((p != NULL) && (p <= t)) {
-	session->driver.nmea.field[count] = p;	/* we have a field. record it */
-	/*@ -compdef @*/
-	if ((p = strchr(p, ',')) != NULL) {	/* search for the next delimiter */
-	    *p = '\0';		/* replace it with a NUL */
-	    count++;		/* bump the counters and continue */
-	    p++;
+    s = sentence;
+    if (s < limit && *s != '\0')
+	*d++ = *s++;		/* the '$' or '!' */
+    session->driver.nmea.field[0] = d;	/* beginning of tag, 'G' not '$' */
+    for (; s < limit && (c = *s) >= ' ' && c != '*'; s++) {
+	sum ^= (unsigned char)c;
+	if (c == ',') {
+	    *d++ = '\0';
+	    session->driver.nmea.field[++count] = d;
+	} else
+	    *d++ = c;
+    }
+    *d = '\0';
+    e = d;
+    if (s < limit && *s == '*') {
+	/* the packet lexer checks this too, but not every caller uses it */
+	static const char hex[] = "0123456789ABCDEF";
+	const char *hi, *lo;
+
+	if (s + 2 < limit && s[1] != '\0' && s[2] != '\0'
+	    && (hi = strchr(hex, s[1])) != NULL
+	    && (lo = strchr(hex, s[2])) != NULL
+	    && (unsigned)((hi - hex) << 4 | (lo - hex)) != sum) {
+	    gpsd_report(session->context->debug, LOG_WARN,
+			"bad checksum in NMEA sentence %s; expected %02X.\n",
+			session->driver.nmea.field[0], sum);
+	    return ONLINE_SET;
 	}
-	/*@ +compdef @*/
+	count++;
     }
 
     /* point remaining fields at empty string, just in case */
@@ -2096,32 +2201,28 @@ gps_mask_t nmea_parse_len(char *sentence, size_t sentence_len, struct gps_device
     session->driver.nmea.latch_frac_time = false;
 
     /* dispatch on field zero, the sentence tag */
-    for (thistag = i = 0;
-	 i < (unsigned)(sizeof(nmea_phrase) / sizeof(nmea_phrase[0])); ++i) {
-	s = session->driver.nmea.field[0];
-	if (strlen(nmea_phrase[i].name) == 3)
-	    s += 2;		/* skip talker ID */
-	if (strcmp(nmea_phrase[i].name, s) == 0) {
-	    if (nmea_phrase[i].decoder != NULL
-            && (count >= nmea_phrase[i].nf)) {
-            retval =
-                (nmea_phrase[i].decoder) (count,
-                                          session->driver.nmea.field,
-                                          session);
-            (void)strlcpy(session->gpsdata.tag,
-                          nmea_phrase[i].name,
-                          MAXTAGLEN);
-            if (nmea_phrase[i].cycle_continue)
-                session->driver.nmea.cycle_continue = true;
-            /*
-             * Must force this to be nz, as we're going to rely on a zero
-             * value to mean "no previous tag" later.
-             */
-            thistag = i + 1;
-	    } else
-            retval = ONLINE_SET;	/* unknown sentence */
-	    break;
-	}
+    thistag = 0;
+    i = nmea_lookup(session->driver.nmea.field[0],
+		    strlen(session->driver.nmea.field[0]));
+    if (i != NMEA_TAG_NONE) {
+	if (nmea_phrase[i].decoder != NULL
+	    && (count >= nmea_phrase[i].nf)) {
+	    retval =
+		(nmea_phrase[i].decoder) (count,
+					  session->driver.nmea.field,
+					  session);
+	    (void)strlcpy(session->gpsdata.tag,
+			  nmea_phrase[i].name,
+			  MAXTAGLEN);
+	    if (nmea_phrase[i].cycle_continue)
+		session->driver.nmea.cycle_continue = true;
+	    /*
+	     * Phrase numbers start at 1, as we're going to rely on a
+	     * zero value to mean "no previous tag" later.
+	     */
+	    thistag = i;
+	} else
+	    retval = ONLINE_SET;	/* unknown sentence */
     }
 
     /* timestamp recording for fixes happens here */
@@ -2187,7 +2288,7 @@ gps_mask_t nmea_parse_len(char *sentence, size_t sentence_len, struct gps_device
 		session->driver.nmea.cycle_enders |= (1 << lasttag);
 		gpsd_report(session->context->debug, LOG_PROG,
 			    "tagged %s as a cycle ender.\n",
-			    nmea_phrase[lasttag - 1].name);
+			    nmea_phrase[lasttag].name);
 	    }
 	}
     } else {
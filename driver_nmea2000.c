@@ -73,7 +73,7 @@ static void print_data(struct gps_context_t *context,
 	ptr += l2;
         for (l1=0;l1<len;l1++) {
             if (((l1 % 20) == 0) && (l1 != 0)) {
-	        gpsd_report(context->debug, LOG_IO,"%s\n", bu);
+	        GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, context->debug,"%s\n", bu);
 		ptr = 0;
                 l2 = sprintf(&bu[ptr], "                   : ");
 		ptr += l2;
@@ -81,7 +81,7 @@ static void print_data(struct gps_context_t *context,
             l2 = sprintf(&bu[ptr], "%02ux ", (unsigned int)buffer[l1]);
 	    ptr += l2;
         }
-        gpsd_report(context->debug, LOG_IO,"%s\n", bu);
+        GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, context->debug,"%s\n", bu);
     }
     /*@+bufferoverflowhigh@*/
 #endif
@@ -111,7 +111,7 @@ static int decode_ais_header(struct gps_context_t *context,
 	ais->repeat = (unsigned int) ((bu[0] >> 6) & 0x03);
 	ais->mmsi   = (unsigned int)  getleu32(bu, 1);
 	ais->mmsi  &= mask;
-	gpsd_report(context->debug, LOG_INF,
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, context->debug,
 		    "NMEA2000 AIS message type %u, MMSI %09d:\n",
 		    ais->type, ais->mmsi);
 	return(1);
@@ -119,7 +119,7 @@ static int decode_ais_header(struct gps_context_t *context,
         ais->type   =  0;
 	ais->repeat =  0;
 	ais->mmsi   =  0;
-	gpsd_report(context->debug, LOG_ERROR,
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, context->debug,
 		    "NMEA2000 AIS message type %u, too short message.\n",
 		    ais->type);
     }
@@ -180,7 +180,7 @@ static double ais_direction(unsigned int val, double scale)
 static gps_mask_t hnd_059392(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -191,8 +191,12 @@ static gps_mask_t hnd_059392(unsigned char *bu, int len, PGN *pgn, struct gps_de
  */
 static gps_mask_t hnd_060928(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
+    if (session->context->n2kbus != NULL)
+	n2k_bus_claim(session->context->n2kbus,
+		      (uint8_t)session->driver.nmea2000.unit,
+		      bu, (size_t)len, timestamp());
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -204,7 +208,7 @@ static gps_mask_t hnd_060928(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_126208(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -216,7 +220,7 @@ static gps_mask_t hnd_126208(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_126464(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -227,22 +231,40 @@ static gps_mask_t hnd_126464(unsigned char *bu, int len, PGN *pgn, struct gps_de
  */
 static gps_mask_t hnd_126996(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
+    if (session->context->n2kbus != NULL)
+	n2k_bus_product(session->context->n2kbus,
+			(uint8_t)session->driver.nmea2000.unit,
+			bu, (size_t)len);
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
 
 
 /*
- *   PGN 127258: GNSS Magnetic Variation
+ *   PGNs described in n2kgen.py, decoded from their schema tables
  */
-static gps_mask_t hnd_127258(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
+static gps_mask_t hnd_schema(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
+    const struct n2k_pgn_t *schema = n2k_schema_find(pgn->pgn);
+    gps_mask_t mask;
+    char fields[256];
+
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
+    if (schema == NULL)
+	return 0;
+
+    mask = n2k_decode(schema, bu, len, session);
+
+    if (LOG_SUBACTIVE(LOG_SUB_N2K, LOG_IO, session->context->debug)) {
+	(void)n2k_describe(schema, bu, len, fields, sizeof(fields));
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, session->context->debug,
+		    "                   %s\n", fields);
+    }
+    return mask;
 }
 
 
@@ -252,7 +274,7 @@ static gps_mask_t hnd_127258(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_129025(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     /*@-type@*//* splint has a bug here */
@@ -273,7 +295,7 @@ static gps_mask_t hnd_129025(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_129026(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     session->driver.nmea2000.sid[0]  =  bu[0];
@@ -307,7 +329,7 @@ static gps_mask_t hnd_126992(unsigned char *bu, int len, PGN *pgn, struct gps_de
     //uint8_t        source;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     //sid        = bu[0];
@@ -336,7 +358,7 @@ static gps_mask_t hnd_129539(unsigned char *bu, int len, PGN *pgn, struct gps_de
     unsigned int act_mode;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     mask                             = 0;
@@ -361,7 +383,7 @@ static gps_mask_t hnd_129539(unsigned char *bu, int len, PGN *pgn, struct gps_de
     /*@+type@*/
     mask                            |= DOP_SET;
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d): sid:%02x hdop:%5.2f vdop:%5.2f tdop:%5.2f\n",
 		pgn->pgn,
 		session->driver.nmea2000.unit,
@@ -384,7 +406,7 @@ static gps_mask_t hnd_129540(unsigned char *bu, int len, PGN *pgn, struct gps_de
     int         l1, l2;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     session->driver.nmea2000.sid[2]           = bu[0];
@@ -428,7 +450,7 @@ static gps_mask_t hnd_129029(unsigned char *bu, int len, PGN *pgn, struct gps_de
     gps_mask_t mask;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     mask                             = 0;
@@ -500,7 +522,7 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -533,7 +555,7 @@ static gps_mask_t hnd_129039(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -572,7 +594,7 @@ static gps_mask_t hnd_129040(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -630,7 +652,7 @@ static gps_mask_t hnd_129794(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -727,7 +749,7 @@ static gps_mask_t hnd_129798(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -762,7 +784,7 @@ static gps_mask_t hnd_129802(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0x3fffffff) != 0) {
@@ -790,7 +812,7 @@ static gps_mask_t hnd_129809(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -798,7 +820,7 @@ static gps_mask_t hnd_129809(unsigned char *bu, int len, PGN *pgn, struct gps_de
 	int                   index   = session->driver.aivdm.context[0].type24_queue.index;
 	struct ais_type24a_t *saveptr = &session->driver.aivdm.context[0].type24_queue.ships[index];
 
-	gpsd_report(session->context->debug, LOG_PROG,
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_PROG, session->context->debug,
 		    "NMEA2000: AIS message 24A from %09u stashed.\n",
 		    ais->mmsi);
 
@@ -833,7 +855,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, PGN *pgn, struct gps_de
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (decode_ais_header(session->context, bu, len, ais, 0xffffffffU) != 0) {
@@ -881,7 +903,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, PGN *pgn, struct gps_de
 		}
 		ais->type24.shipname[AIS_SHIPNAME_MAXLEN] = (char) 0;
 
-		gpsd_report(session->context->debug, LOG_PROG,
+		GPSD_SUBLOG(LOG_SUB_N2K, LOG_PROG, session->context->debug,
 			    "NMEA2000: AIS 24B from %09u matches a 24A.\n",
 			    ais->mmsi);
 		/* prevent false match if a 24B is repeated */
@@ -927,7 +949,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_127506(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -939,7 +961,7 @@ static gps_mask_t hnd_127506(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_127508(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -951,161 +973,7 @@ static gps_mask_t hnd_127508(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_127513(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-
-/*
- *   PGN 127245: NAV Rudder
- */
-static gps_mask_t hnd_127245(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-/*
- *   PGN 127250: NAV Vessel Heading
- */
-static gps_mask_t hnd_127250(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-  /*
-    1 SID
-    2 Heading Sensor Reading
-    3 Deviation
-    4 Variation
-    5 Heading Sensor Reference
-    6 Reserved Bits
-    */
-
-    uint8_t sid;
-    uint16_t hdg;
-    int16_t dev;
-    int16_t var;
-    double heading = 0.0;
-    uint8_t ref = 0; // Heading Sensor Reference (M&T?)
-    const size_t buflen = 255;
-    // [3] says ref = 1 for magnetic north (how many bits?)
-
-    print_data(session->context, bu, len, pgn);
-
-    sid = getub(bu, 0);
-
-    /*@-type@*/
-    hdg = getleu16(bu, 1);
-    if (hdg != 0xffff) {
-        heading = hdg * RAD_2_DEG * 0.0001;
-    }
-
-    dev = getles16(bu, 3);
-    if (dev != 0x7fff) {
-        heading += dev * RAD_2_DEG * 0.0001;
-        session->gpsdata.environment.set       = ENV_DEVIATION_PSET;
-        session->gpsdata.environment.deviation = dev * RAD_2_DEG * 0.0001;
-    }
-
-    var = getles16(bu, 5);
-    if (var != 0x7fff) {
-        heading += var * RAD_2_DEG * 0.0001;
-        session->gpsdata.environment.set       |= ENV_VARIATION_PSET;
-        session->gpsdata.environment.variation = var * RAD_2_DEG * 0.0001;
-    }
-
-    // observed b0000 0001, 1 = magnetic (see also [3]), 0 = true
-    ref = getub(bu, 7) & 0x01; // ??? len, only a couple of bits
-
-    /*@+type@*/
-    if (hdg != 0xffff) {
-      if(ref == 1) {
-	session->gpsdata.navigation.set |= NAV_HDG_MAGN_PSET;
-	session->gpsdata.navigation.heading[compass_magnetic] = heading;
-      } else {
-	session->gpsdata.navigation.set |= NAV_HDG_TRUE_PSET;
-	session->gpsdata.navigation.heading[compass_true] = heading;
-      }
-    } else {
-	session->gpsdata.navigation.heading[compass_magnetic] = NAN;
-	session->gpsdata.navigation.heading[compass_true] = NAN;
-    }
-
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    char bufp[buflen];
-    memset(bufp, 0, buflen);
-
-    if (hdg == 0xffff) {
-      (void)sprintf(bufp, "Heading= %s, ", "-");
-      (void)sprintf(bufp + strlen(bufp), "Sensor= %s, ", "-");
-    } else {
-      (void)snprintf(bufp, buflen, "Heading= %.2f, ", heading);
-      (void)snprintf(bufp + strlen(bufp), buflen - strlen(bufp), "Sensor= %.2f, ", 
-		     hdg  * RAD_2_DEG * 0.0001);
-    }
-    if (dev == 0x7fff) {
-      (void)sprintf(bufp + strlen(bufp), "Deviation= %s, ", "-");
-    } else {
-      (void)snprintf(bufp + strlen(bufp), buflen - strlen(bufp), 
-		     "Deviation= %.2f, ", 
-		     dev * RAD_2_DEG * 0.0001);
-    }
-    if (var == 0x7fff) {
-      (void)sprintf(bufp + strlen(bufp), "Variation= %s", "-");
-    } else {
-      (void)snprintf(bufp + strlen(bufp), buflen - strlen(bufp), "Variation= %.2f", var * RAD_2_DEG * 0.0001);
-    }
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   SID = %d, %s, Heading Sensor Reference= %s (%u), Reserved = %u\n", 
-		sid, 
-		bufp,
-		ref == 1? "Magnetic":"True",
-		ref,
-		0);
-
-    return (ONLINE_SET | NAVIGATION_SET);
-}
-
-
-/*
- *   PGN 128259: NAV Speed
- */
-static gps_mask_t hnd_128259(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-
-/*
- *   PGN 128267: NAV Water Depth
- */
-static gps_mask_t hnd_128267(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-
-    /*@i@*/session->gpsdata.navigation.depth = getleu32(bu, 1) *.01;
-    session->gpsdata.navigation.set = NAV_DPT_PSET;
-
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(ONLINE_SET | NAVIGATION_SET);
-}
-
-
-/*
- *   PGN 128275: NAV Distance Log
- */
-static gps_mask_t hnd_128275(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -1117,7 +985,7 @@ static gps_mask_t hnd_128275(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_129283(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -1129,7 +997,7 @@ static gps_mask_t hnd_129283(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_129284(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -1141,43 +1009,7 @@ static gps_mask_t hnd_129284(unsigned char *bu, int len, PGN *pgn, struct gps_de
 static gps_mask_t hnd_129285(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-
-/*
- *   PGN 130306: NAV Wind Data
- */
-static gps_mask_t hnd_130306(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-
-/*
- *   PGN 130310: NAV Water Temp., Outside Air Temp., Atmospheric Pressure
- */
-static gps_mask_t hnd_130310(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-
-/*
- *   PGN 130311: NAV Environmental Parameters
- */
-static gps_mask_t hnd_130311(unsigned char *bu, int len, PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -1194,6 +1026,8 @@ static const char msg_126996[] = {"ISO  Product Information"};
 static const char msg_127506[] = {"PWR DC Detailed Status"};
 static const char msg_127508[] = {"PWR Battery Status"};
 static const char msg_127513[] = {"PWR Battery Configuration Status"};
+static const char msg_127488[] = {"Engine Parameters, Rapid"};
+static const char msg_127489[] = {"Engine Parameters, Dynamic"};
 
 static const char msg_127258[] = {"GNSS Magnetic Variation"};
 static const char msg_129025[] = {"GNSS Position Rapid Update"};
@@ -1213,6 +1047,8 @@ static const char msg_129810[] = {"AIS  Class B CS Static Data Report, Part B"};
 
 static const char msg_127245[] = {"NAV Rudder"};
 static const char msg_127250[] = {"NAV Vessel Heading"};
+static const char msg_127251[] = {"Rate of Turn"};
+static const char msg_127257[] = {"Attitude"};
 static const char msg_128259[] = {"NAV Speed"};
 static const char msg_128267[] = {"NAV Water Depth"};
 static const char msg_128275[] = {"NAV Distance Log"};
@@ -1233,7 +1069,7 @@ static PGN gpspgn[] = {{ 59392, 0, 0, hnd_059392, &msg_059392[0]},
 		       {126464, 1, 0, hnd_126464, &msg_126464[0]},
 		       {126992, 0, 0, hnd_126992, &msg_126992[0]},
 		       {126996, 1, 0, hnd_126996, &msg_126996[0]},
-		       {127258, 0, 0, hnd_127258, &msg_127258[0]},
+		       {127258, 0, 0, hnd_schema, &msg_127258[0]},
 		       {129025, 0, 1, hnd_129025, &msg_129025[0]},
 		       {129026, 0, 1, hnd_129026, &msg_129026[0]},
 		       {129029, 1, 1, hnd_129029, &msg_129029[0]},
@@ -1269,6 +1105,8 @@ static PGN pwrpgn[] = {{ 59392, 0, 0, hnd_059392, &msg_059392[0]},
 		       {127506, 1, 3, hnd_127506, &msg_127506[0]},
 		       {127508, 1, 3, hnd_127508, &msg_127508[0]},
 		       {127513, 1, 3, hnd_127513, &msg_127513[0]},
+		       {127488, 0, 3, hnd_schema, &msg_127488[0]},
+		       {127489, 1, 3, hnd_schema, &msg_127489[0]},
 		       {0     , 0, 0, NULL,       &msg_error [0]}};
 
 static PGN navpgn[] = {{ 59392, 0, 0, hnd_059392, &msg_059392[0]},
@@ -1277,18 +1115,20 @@ static PGN navpgn[] = {{ 59392, 0, 0, hnd_059392, &msg_059392[0]},
 		       {126464, 1, 0, hnd_126464, &msg_126464[0]},
 		       {126992, 0, 0, hnd_126992, &msg_126992[0]},
 		       {126996, 1, 0, hnd_126996, &msg_126996[0]},
-		       {127245, 0, 4, hnd_127245, &msg_127245[0]},
-		       {127250, 0, 4, hnd_127250, &msg_127250[0]},
-		       {127258, 0, 0, hnd_127258, &msg_127258[0]},
-		       {128259, 0, 4, hnd_128259, &msg_128259[0]},
-		       {128267, 0, 4, hnd_128267, &msg_128267[0]},
-		       {128275, 1, 4, hnd_128275, &msg_128275[0]},
+		       {127245, 0, 4, hnd_schema, &msg_127245[0]},
+		       {127250, 0, 4, hnd_schema, &msg_127250[0]},
+		       {127251, 0, 4, hnd_schema, &msg_127251[0]},
+		       {127257, 0, 4, hnd_schema, &msg_127257[0]},
+		       {127258, 0, 0, hnd_schema, &msg_127258[0]},
+		       {128259, 0, 4, hnd_schema, &msg_128259[0]},
+		       {128267, 0, 4, hnd_schema, &msg_128267[0]},
+		       {128275, 1, 4, hnd_schema, &msg_128275[0]},
 		       {129283, 0, 0, hnd_129283, &msg_129283[0]},
 		       {129284, 1, 0, hnd_129284, &msg_129284[0]},
 		       {129285, 1, 0, hnd_129285, &msg_129285[0]},
-		       {130306, 0, 4, hnd_130306, &msg_130306[0]},
-		       {130310, 0, 4, hnd_130310, &msg_130310[0]},
-		       {130311, 0, 4, hnd_130311, &msg_130311[0]},
+		       {130306, 0, 4, hnd_schema, &msg_130306[0]},
+		       {130310, 0, 4, hnd_schema, &msg_130310[0]},
+		       {130311, 0, 4, hnd_schema, &msg_130311[0]},
 		       {0     , 0, 0, NULL,       &msg_error [0]}};
 
 
@@ -1322,7 +1162,7 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
     session->driver.nmea2000.workpgn = NULL;
     can_net = session->driver.nmea2000.can_net;
     if (can_net > (NMEA2000_NETS-1)) {
-        gpsd_report(session->context->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 		    "NMEA2000 find_pgn: Invalid can network %d.\n", can_net);
         return;
     }
@@ -1400,6 +1240,7 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 	}
 
 	if (source_unit == session->driver.nmea2000.unit) {
+	    struct n2k_bus_t *bus = session->context->n2kbus;
 	    PGN *work;
 	    if (session->driver.nmea2000.pgnlist != NULL) {
 	        work = search_pgnlist(source_pgn, session->driver.nmea2000.pgnlist);
@@ -1428,21 +1269,27 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 	        if (work->fast == 0) {
 		    size_t l2;
 
-		    gpsd_report(session->context->debug, LOG_DATA,
+		    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 				"pgn %6d:%s \n", work->pgn, work->name);
 		    session->driver.nmea2000.workpgn = (void *) work;
 		    /*@i1@*/session->packet.outbuflen =  frame->can_dlc & 0x0f;
 		    for (l2=0;l2<session->packet.outbuflen;l2++) {
 		        /*@i3@*/session->packet.outbuffer[l2]= frame->data[l2];
 		    }
+		    if (bus != NULL)
+		        n2k_bus_packet(bus, source_pgn, (uint8_t)source_unit,
+				       session->packet.outbuflen, timestamp());
 		}
 		/*@i2@*/else if ((frame->data[0] & 0x1f) == 0) {
 		    unsigned int l2;
 
+		    /* the last one never finished */
+		    if (bus != NULL && session->driver.nmea2000.fast_packet_len != 0)
+		        n2k_bus_fast_error(bus, (uint8_t)source_unit, true);
 		    /*@i2@*/session->driver.nmea2000.fast_packet_len = frame->data[1];
 		    /*@i2@*/session->driver.nmea2000.idx = frame->data[0];
 #if NMEA2000_FAST_DEBUG
-		    gpsd_report(session->context->debug, LOG_ERROR,
+		    GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 				"Set idx    %2x    %2x %2x %6d\n",
 				frame->data[0],
 				session->driver.nmea2000.unit,
@@ -1454,7 +1301,7 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 		    for (l2=2;l2<8;l2++) {
 		        /*@i3@*/session->packet.inbuffer[session->packet.inbuflen++] = frame->data[l2];
 		    }
-		    gpsd_report(session->context->debug, LOG_DATA,
+		    GPSD_SUBLOG(LOG_SUB_N2K, LOG_DATA, session->context->debug,
 				"pgn %6d:%s \n", work->pgn, work->name);
 		}
 		/*@i2@*/else if (frame->data[0] == session->driver.nmea2000.idx) {
@@ -1467,7 +1314,7 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 		    }
 		    if (session->packet.inbuflen == session->driver.nmea2000.fast_packet_len) {
 #if NMEA2000_FAST_DEBUG
-		        gpsd_report(session->context->debug, LOG_ERROR,
+		        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 				    "Fast done  %2x %2x %2x %2x %6d\n",
 				    session->driver.nmea2000.idx,
 				    /*@i1@*/frame->data[0],
@@ -1480,12 +1327,19 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 			for(l2=0;l2 < (unsigned int)session->packet.outbuflen; l2++) {
 			    session->packet.outbuffer[l2] = session->packet.inbuffer[l2];
 			}
+			if (bus != NULL)
+			    n2k_bus_packet(bus, source_pgn, (uint8_t)source_unit,
+					   session->packet.outbuflen, timestamp());
 			session->driver.nmea2000.fast_packet_len = 0;
 		    } else {
 		        session->driver.nmea2000.idx += 1;
 		    }
 		} else {
-		    gpsd_report(session->context->debug, LOG_ERROR,
+		    /* count a broken packet once, not each frame after the gap */
+		    if (bus != NULL && session->driver.nmea2000.fast_packet_len != 0)
+		        n2k_bus_fast_error(bus, (uint8_t)source_unit, false);
+		    session->driver.nmea2000.fast_packet_len = 0;
+		    GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 				"Fast error %2x %2x %2x %2x %6d\n",
 				session->driver.nmea2000.idx,
 				/*@i2@*/frame->data[0],
@@ -1494,7 +1348,11 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 				                                               source_pgn);
 		}
 	    } else {
-	        gpsd_report(session->context->debug, LOG_WARN,
+	        /* no handler, but it still loads the bus */
+	        if (bus != NULL)
+		    n2k_bus_packet(bus, source_pgn, (uint8_t)source_unit,
+				   frame->can_dlc & 0x0f, timestamp());
+	        GPSD_SUBLOG(LOG_SUB_N2K, LOG_WARN, session->context->debug,
 			    "PGN not found %08d %08x \n",
 			    source_pgn, source_pgn);
 	    }
@@ -1520,14 +1378,54 @@ static void find_pgn(struct can_frame *frame, struct gps_device_t *session)
 /*@+nullstate +branchstate +globstate +mustfreeonly@*/
 
 
+static uint64_t nmea2000_rx_time(struct msghdr *msg)
+/* monotonic time of reception, backdated by the kernel RX timestamp */
+{
+    uint64_t now = monotonic_ns();
+#ifdef SCM_TIMESTAMPNS
+    struct cmsghdr *cmsg;
+
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+	 cmsg = CMSG_NXTHDR(msg, cmsg)) {
+	if (cmsg->cmsg_level == SOL_SOCKET
+	    && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+	    struct timespec kts, rts;
+	    int64_t age;
+
+	    memcpy(&kts, CMSG_DATA(cmsg), sizeof(kts));
+	    (void)clock_gettime(CLOCK_REALTIME, &rts);
+	    age = (int64_t)(rts.tv_sec - kts.tv_sec) * 1000000000LL
+		+ (rts.tv_nsec - kts.tv_nsec);
+	    /* ignore stamps from a clock that was stepped meanwhile */
+	    if (age > 0 && (uint64_t)age < now && age < 1000000000LL)
+		now -= (uint64_t)age;
+	    break;
+	}
+    }
+#endif /* SCM_TIMESTAMPNS */
+    return now;
+}
+
 static ssize_t nmea2000_get(struct gps_device_t *session)
 {
     struct can_frame frame;
     ssize_t          status;
+    struct iovec iov;
+    struct msghdr msg;
+    char ctrl[CMSG_SPACE(sizeof(struct timespec))];
 
     session->packet.outbuflen = 0;
-    status = read(session->gpsdata.gps_fd, &frame, sizeof(frame));
+    iov.iov_base = &frame;
+    iov.iov_len = sizeof(frame);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    status = recvmsg(session->gpsdata.gps_fd, &msg, 0);
+    TRACE_EVENT(TRACE_READ, session->gpsdata.gps_fd, status, 0);
     if (status == (ssize_t)sizeof(frame)) {
+        session->packet.rx_ns = nmea2000_rx_time(&msg);
         session->packet.type = NMEA2000_PACKET;
 	find_pgn(&frame, session);
 
@@ -1548,6 +1446,8 @@ static gps_mask_t nmea2000_parse_input(struct gps_device_t *session)
 
     if (work != NULL) {
         mask = (work->func)(&session->packet.outbuffer[0], (int)session->packet.outbuflen, work, session);
+        TRACE_EVENT(TRACE_PGN, session->gpsdata.gps_fd, work->pgn,
+                    session->packet.outbuflen);
         session->driver.nmea2000.workpgn = NULL;
     }
     //    session->packet.outbuflen = 0;
@@ -1589,7 +1489,7 @@ int nmea2000_open(struct gps_device_t *session)
 	}
 	if (unit_ptr != NULL) {
 	    if (isdigit(interface_name[l]) == 0) {
-	        gpsd_report(session->context->debug, LOG_ERROR,
+	        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 			    "NMEA2000 open: Invalid character in unit number.\n");
 	        return -1;
 	    }
@@ -1599,7 +1499,7 @@ int nmea2000_open(struct gps_device_t *session)
     if (unit_ptr != NULL) {
         unit_number = atoi(unit_ptr);
 	if ((unit_number < 0) || (unit_number > (NMEA2000_UNITS-1))) {
-	    gpsd_report(session->context->debug, LOG_ERROR,
+	    GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 			"NMEA2000 open: Unit number out of range.\n");
 	    return -1;
 	}
@@ -1612,7 +1512,7 @@ int nmea2000_open(struct gps_device_t *session)
 	    }
 	}
 	if (can_net < 0) {
-	    gpsd_report(session->context->debug, LOG_ERROR,
+	    GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 			"NMEA2000 open: CAN device not open: %s .\n", interface_name);
 	    return -1;
 	}
@@ -1621,7 +1521,7 @@ int nmea2000_open(struct gps_device_t *session)
 	    if (strncmp(can_interface_name[l], 
 			interface_name,
 			MIN(sizeof(interface_name), sizeof(can_interface_name[l]))) == 0) {
-	        gpsd_report(session->context->debug, LOG_ERROR, "NMEA2000 open: CAN device duplicate open: %s .\n", interface_name);
+	        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug, "NMEA2000 open: CAN device duplicate open: %s .\n", interface_name);
 		return -1;
 	    }
 	}
@@ -1632,7 +1532,7 @@ int nmea2000_open(struct gps_device_t *session)
 	    }
 	}
 	if (can_net < 0) {
-	    gpsd_report(session->context->debug, LOG_ERROR,
+	    GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 			"NMEA2000 open: Too many CAN networks open.\n");
 	    return -1;
 	}
@@ -1642,14 +1542,14 @@ int nmea2000_open(struct gps_device_t *session)
     sock = socket(PF_CAN, SOCK_RAW, CAN_RAW);
  
     if (BAD_SOCKET(sock)) {
-        gpsd_report(session->context->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 		    "NMEA2000 open: can not get socket.\n");
 	return -1;
     }
 
     status = fcntl(sock, F_SETFL, O_NONBLOCK);
     if (status != 0) {
-        gpsd_report(session->context->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 		    "NMEA2000 open: can not set socket to O_NONBLOCK.\n");
 	close(sock);
 	return -1;
@@ -1661,18 +1561,28 @@ int nmea2000_open(struct gps_device_t *session)
 					       * with that device's index */
 
     if (status != 0) {
-        gpsd_report(session->context->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug,
 		    "NMEA2000 open: can not find CAN device.\n");
 	close(sock);
 	return -1;
     }
 
+#ifdef SO_TIMESTAMPNS
+    {
+	/* kernel RX timestamps sharpen the read-to-send latency figures */
+	int on = 1;
+	if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0)
+	    GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, session->context->debug,
+			"NMEA2000 open: no kernel RX timestamps.\n");
+    }
+#endif /* SO_TIMESTAMPNS */
+
     /* Select that CAN interface, and bind the socket to it. */
     addr.can_family = AF_CAN;
     addr.can_ifindex = ifr.ifr_ifindex;
     status = bind(sock, (struct sockaddr*)&addr, sizeof(addr) );
     if (status != 0) {
-        gpsd_report(session->context->debug, LOG_ERROR, "NMEA2000 open: bind failed.\n");
+        GPSD_SUBLOG(LOG_SUB_N2K, LOG_ERROR, session->context->debug, "NMEA2000 open: bind failed.\n");
 	close(sock);
 	return -1;
     }
@@ -1706,7 +1616,7 @@ int nmea2000_open(struct gps_device_t *session)
 void nmea2000_close(struct gps_device_t *session)
 {
     if (!BAD_SOCKET(session->gpsdata.gps_fd)) {
-	gpsd_report(session->context->debug, LOG_SPIN,
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_SPIN, session->context->debug,
 		    "close(%d) in nmea2000_close(%s)\n",
 		    session->gpsdata.gps_fd, session->gpsdata.dev.path);
 	(void)close(session->gpsdata.gps_fd);
@@ -39,9 +39,6 @@ typedef struct st_phrase {
   const char * name;
 } st_phrase;
 
-/* fixed length array - position is number of seatalk sentence */
-uint8_t st_fixed_lengths[255];
-
 gps_mask_t seatalk_parse_input(struct gps_device_t *session);
 
 void character_skip(struct gps_packet_t *lexer);
@@ -59,7 +56,7 @@ void character_skip(struct gps_packet_t *lexer)
     size_t remaining = packet_buffered_input(lexer);
 
     lexer->inbufptr--;
-    gpsd_report(lexer->debug, LOG_RAW + 3,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 3, lexer->debug,
 		"pre inbuflen = %lu with %lu remaining, %p, %p\n",
 		lexer->inbuflen, remaining, lexer->inbuffer, lexer->inbufptr);
 
@@ -68,13 +65,13 @@ void character_skip(struct gps_packet_t *lexer)
     memmove(lexer->inbufptr, lexer->inbufptr+1, remaining);
     lexer->inbuflen--;
 
-    gpsd_report(lexer->debug, LOG_RAW + 3,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 3, lexer->debug,
 		"post inbuflen = %lu, %p, %p\n",
 		lexer->inbuflen, lexer->inbuffer, lexer->inbufptr);
 
-    if (lexer->debug >= LOG_RAW+1) {
+    if (LOG_SUBACTIVE(LOG_SUB_SEATALK, LOG_RAW+1, lexer->debug)) {
 	char scratchbuf[MAX_PACKET_LENGTH*2+1];
-	gpsd_report(lexer->debug, LOG_RAW + 2,
+	GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
 		    "Character %c [%02X] @ %p skipped, buffer %zu, %p = %s\n",
 		    (isprint(c) ? c : '.'), c,
 		    lexer->inbufptr, lexer->inbuflen, lexer->inbuffer,
@@ -89,13 +86,7 @@ void character_skip(struct gps_packet_t *lexer)
    parity */
 static int getParity(unsigned int n) {
 
-    int parity = 0;
-    while (n)
-    {
-        parity = !parity;
-        n      = n & (n - 1);
-    }
-    return parity;
+    return __builtin_parity(n);
 }
 
 static void seatalk_merge_yymmdd(uint8_t yy, uint8_t mon, uint8_t mday, struct gps_device_t *session)
@@ -109,15 +100,15 @@ static void seatalk_merge_yymmdd(uint8_t yy, uint8_t mon, uint8_t mday, struct g
     year = (session->context->century + yy);
 
     if ( (1 > mon ) || (12 < mon ) ) {
-	gpsd_report(session->context->debug, LOG_WARN,
+	GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_WARN, session->context->debug,
 		    "seatalk_merge_yymmdd(%d, %d, %d), malformed month\n",
 		    yy, mon, mday);
     } else if ( (1 > mday ) || (31 < mday ) ) {
-	gpsd_report(session->context->debug, LOG_WARN,
+	GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_WARN, session->context->debug,
 		    "seatalk_merge_yymmdd(%d, %d, %d), malformed day\n",
 		    yy, mon, mday);
     } else {
-	gpsd_report(session->context->debug, LOG_DATA,
+	GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 		    "seatalk_merge_yymmdd(%d, %d, %d) sets year %d\n",
 		    yy, mon, mday, year);
 	session->driver.seatalk.date.tm_year = year - 1900;
@@ -148,12 +139,16 @@ static gps_mask_t seatalk_print_command(uint8_t * cmdBuffer, uint8_t size,
   char     bu[128];
   uint8_t  m = 128 - 1;
 
+  // nearly every decoder calls this, don't format what nobody reads
+  if (!LOG_SUBACTIVE(LOG_SUB_SEATALK, LOG_IO, session->context->debug))
+    return 0;
+
   ptr = sprintf(&bu[0], "                   : ");
   for (l1=1; (l1 < size) && (ptr < m - 5); l1++) {
     l2 = sprintf(&bu[ptr], "0x%02x ", (unsigned int)cmdBuffer[l1]);
     ptr += l2;
   }
-  gpsd_report(session->context->debug, LOG_IO, "0x%02X: %s\n", cmdBuffer[0], bu);
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_IO, session->context->debug, "0x%02X: %s\n", cmdBuffer[0], bu);
 
   return 0;
 }
@@ -202,17 +197,17 @@ static gps_mask_t seatalk_process_depth(uint8_t * cmdBuffer, uint8_t size,
 
     session->gpsdata.navigation.set = NAV_DPT_PSET;
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "command %02X: Depth = %f m\n", cmdBuffer[0],
 	      session->gpsdata.navigation.depth);
 
     if(cmdBuffer[2] & 0x80) {
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 		  "            Anchor alarm active\n");
     }
 
     if(cmdBuffer[2] & 0x40) {
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 		  "            Metric units for depth\n");
     }
 
@@ -233,7 +228,7 @@ static gps_mask_t seatalk_process_wind_angle(uint8_t * cmdBuffer, uint8_t size U
   session->gpsdata.environment.wind[wind_apparent].angle =
     getbes16(cmdBuffer, 2) / 2.0;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "command %02X: Apparent Wind Angle = %f deg right of bow\n", cmdBuffer[0],
 	      session->gpsdata.environment.wind[wind_apparent].angle);
 
@@ -253,7 +248,7 @@ static gps_mask_t seatalk_process_wind_speed(uint8_t * cmdBuffer, uint8_t size U
   session->gpsdata.environment.wind[wind_apparent].speed =
     (double)(cmdBuffer[2] & 0x7F) + (double)(cmdBuffer[3] & 0x0F) / 10.0;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "command %02X: Apparent Wind Speed = %d + %d/10 knts = %f knots\n", cmdBuffer[0],
 	      cmdBuffer[2] & 0x7F, cmdBuffer[3] & 0x0F,
 	      session->gpsdata.environment.wind[wind_apparent].speed);
@@ -283,7 +278,7 @@ static gps_mask_t seatalk_process_speed(uint8_t * cmdBuffer, uint8_t size,
 
     nav_set_speed_through_water_in_knots(getleu16(cmdBuffer, 2) / 10.0, session);
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 		"command %02X: Speed = %f knots\n", cmdBuffer[0],
 		session->gpsdata.navigation.speed_thru_water);
 
@@ -297,12 +292,12 @@ static gps_mask_t seatalk_process_speed(uint8_t * cmdBuffer, uint8_t size,
           // means sensor 2 delivers speed as well, we ignore it as we don't know if its really valid
           nav_set_speed_through_water_in_knots(s1 / 100.0, session);
           if((cmdBuffer[6] & 0x80) == 0x80) {
-              gpsd_report(session->context->debug, LOG_DATA,
+              GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                           "command %02X: Speed = %f knots from sensor 1 (sensor 2 ignored)\n", cmdBuffer[0],
                           session->gpsdata.navigation.speed_thru_water);
           } else {
               // no speed from sensor 2, maybe average, skip
-              gpsd_report(session->context->debug, LOG_DATA,
+              GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                           "command %02X: Speed = %f knots from sensor 1\n", cmdBuffer[0],
                           session->gpsdata.navigation.speed_thru_water);
           }
@@ -311,7 +306,7 @@ static gps_mask_t seatalk_process_speed(uint8_t * cmdBuffer, uint8_t size,
               // means sensor 2 delivers speed but not s1
               nav_set_speed_through_water_in_knots(s2 / 100.0, session);
 
-              gpsd_report(session->context->debug, LOG_DATA,
+              GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                           "command %02X: Speed = %f knots from sensor 2\n", cmdBuffer[0],
                           session->gpsdata.navigation.speed_thru_water);
           }
@@ -340,7 +335,7 @@ static gps_mask_t seatalk_process_milage(uint8_t * cmdBuffer, uint8_t size UNUSE
     session->gpsdata.navigation.set = NAV_DIST_TOT_PSET;
   }
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "command %02X: Trip/Total log = %.2fnm / %.2fnm\n", cmdBuffer[0],
 	      session->gpsdata.navigation.distance_trip,
               session->gpsdata.navigation.distance_total);
@@ -363,7 +358,7 @@ static gps_mask_t seatalk_process_distlog(uint8_t * cmdBuffer, uint8_t size UNUS
     (cmdBuffer[2] + cmdBuffer[3]*256 + ((cmdBuffer[2] & 0xF0) >> 4) * 4096)/10.0;
   session->gpsdata.navigation.set = NAV_DIST_TOT_PSET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "command %02X: Trip/Total log = %.2fnm / %.2fnm\n", cmdBuffer[0],
 	      session->gpsdata.navigation.distance_trip,
               session->gpsdata.navigation.distance_total);
@@ -392,7 +387,7 @@ static gps_mask_t seatalk_process_watertemp(uint8_t * cmdBuffer, uint8_t size UN
     session->gpsdata.environment.set = ENV_TEMP_WATER_PSET;
   }
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "command %02X: Water temperature %.2f\n", cmdBuffer[0],
               session->gpsdata.environment.temp[temp_water]);
 
@@ -406,7 +401,7 @@ static gps_mask_t seatalk_process_MOB_cancel(uint8_t * bu, uint8_t size,
 
 */
   gps_mask_t mask = 0;
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk MOD cancel: \n");
   seatalk_print_command(bu, size, session);
   return mask;
@@ -443,7 +438,7 @@ static gps_mask_t seatalk_process_lat(uint8_t * bu, uint8_t size,
 
   mask |= seatalk_update_time(session);
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk latitude: %0.4f (%c)\n",
 	      session->driver.seatalk.lat, (mm & 0x8000)?'S':'N');
   seatalk_print_command(bu, size, session);
@@ -482,7 +477,7 @@ static gps_mask_t seatalk_process_lon(uint8_t * bu, uint8_t size,
 
   mask |= seatalk_update_time(session);
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk longitude: %0.4f (%c)\n",
 	      session->driver.seatalk.lon, (mm & 0x8000)?'E':'W');
   seatalk_print_command(bu, size, session);
@@ -500,7 +495,7 @@ static gps_mask_t seatalk_process_sog(uint8_t * bu, uint8_t size,
   session->gpsdata.navigation.speed_over_ground = getleu16(bu, 2) / 10.0;
   session->gpsdata.navigation.set = NAV_SOG_PSET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk SOG: %0.2fknots\n", session->gpsdata.navigation.speed_over_ground);
   seatalk_print_command(bu, size, session);
 
@@ -522,7 +517,7 @@ static gps_mask_t seatalk_process_cog(uint8_t * bu, uint8_t size,
     ((bu[1] & 0x30) >> 4) * 90.0 + (bu[2] & 0x3F) * 2.0 + ((bu[1] & 0xC0) >> 6) / 2.0;
   session->gpsdata.navigation.set = NAV_COG_TRUE_PSET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk cog: %0.2f\n", session->gpsdata.navigation.course_over_ground[compass_true]);
   seatalk_print_command(bu, size, session);
 
@@ -580,7 +575,7 @@ static gps_mask_t seatalk_process_date(uint8_t * bu, uint8_t size,
   // makes no sense to set time / date without timestamp
   // mask = TIME_SET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk date: %02d-%02d-%02d\n", bu[3], bu[1] >> 4, bu[2]);
   seatalk_print_command(bu, size, session);
 
@@ -594,7 +589,7 @@ static gps_mask_t seatalk_process_noofsats(uint8_t * bu, uint8_t size,
                  Corresponding NMEA sentences: GGA, GSA
 
 */
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk number of sats: %d, dill = %d\n", bu[1] >> 4, bu[2]);
   seatalk_print_command(bu, size, session);
   return 0;
@@ -635,7 +630,7 @@ static gps_mask_t seatalk_process_lat_lon_raw(uint8_t * bu, uint8_t size,
 
   mask |= seatalk_update_time(session);
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
               "seatalk raw lat/lon = %0.2f (%c) / %0.2f (%c) (%s)\n",
               session->driver.seatalk.lat , (session->driver.seatalk.lat > 0) ? 'N' : 'S',
               session->driver.seatalk.lon, (session->driver.seatalk.lon > 0) ? 'E' : 'W',
@@ -659,7 +654,7 @@ static gps_mask_t seatalk_process_count_down(uint8_t * bu, uint8_t size,
                    ( Example 59 22 3B 3B 49 -> Set Countdown Timer to 9.59:59 )
  59  22  0A 00 80  Sent by ST60 in countdown mode when counted down to 10 Seconds.
 */
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk count_down: \n");
   seatalk_print_command(bu, size, session);
   return 0;
@@ -671,7 +666,7 @@ static gps_mask_t seatalk_process_MOB(uint8_t * bu, uint8_t size,
  6E  07  00  00 00 00 00 00 00 00 MOB (Man Over Board), (ST80), preceded
                  by a Waypoint 999 command: 82 A5 40 BF 92 6D 24 DB
 */
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk MOB: \n");
   seatalk_print_command(bu, size, session);
   return 0;
@@ -698,7 +693,7 @@ static gps_mask_t seatalk_process_target_wp(uint8_t * bu, uint8_t size,
   c[2] = 0x30 + ( ((bu[6] & 0x03) << 4) | ((bu[4] & 0xF0) >> 4) );
   c[3] = 0x30 +   ((bu[6] & 0xFC) >> 2);
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk target waypoint name: %s\n", c);
   seatalk_print_command(bu, size, session);
   return 0;
@@ -746,7 +741,7 @@ static gps_mask_t seatalk_process_compass_hdg(uint8_t * bu, uint8_t size,
 
   mask = NAVIGATION_SET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk compass heading: hdg = %0.2f\n",
 	      session->gpsdata.navigation.heading[compass_magnetic]);
 
@@ -794,7 +789,7 @@ static gps_mask_t seatalk_process_nav_to_wp(uint8_t * bu, uint8_t size,
 
   int mode = bu[6] & 0x0F;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk navigation to waypoint: xte = %0.2fnm, bearing = %0.2f, distance = %0.2f, steer = %c, mode = %d\n",
 	      xte, bearing, distance, (bu[6] & 0x40) ? 'R' : 'L', mode);
   seatalk_print_command(bu, size, session);
@@ -826,7 +821,7 @@ static gps_mask_t seatalk_process_compass_hdg_st40(uint8_t * bu, uint8_t size,
 
   mask = NAVIGATION_SET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk compass heading ST40: hdg = %0.2f\n",
 	      session->gpsdata.navigation.heading[compass_magnetic]);
 
@@ -849,7 +844,7 @@ static gps_mask_t seatalk_process_compass_variation_st40(uint8_t * bu, uint8_t s
   session->gpsdata.environment.variation = -1.0*(int8_t)bu[2];
   session->gpsdata.environment.set = ENV_VARIATION_PSET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk compass variation ST40: %f (%c)\n",
 	      session->gpsdata.environment.variation,
 	      bu[2] <= 0 ? 'E' : 'W');
@@ -886,7 +881,7 @@ static gps_mask_t seatalk_process_hdg_rudder_pos(uint8_t * bu, uint8_t size,
 
   mask = NAVIGATION_SET;
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk compass heading and rudder pos: hdg = %0.2f, rsa= %0.2f\n",
 	      session->gpsdata.navigation.heading[compass_magnetic],
 	      session->gpsdata.navigation.rudder_angle);
@@ -904,7 +899,7 @@ static gps_mask_t seatalk_process_wp_definition(uint8_t * bu, uint8_t size,
                    min&sec LON= OO+(PP&ßx1F)*256, PP&0x80 = 0: West,  PP&0x80 = 0x80: East
                    GG HH II JJ: Last four characters of waypoint name
 */
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk waypoint definition: \n");
   seatalk_print_command(bu, size, session);
   return 0;
@@ -924,7 +919,7 @@ static gps_mask_t seatalk_process_dest_wp(uint8_t * bu, uint8_t size,
 */
   char wp[13]; memset(wp, 0, 13);
   memcpy(wp, &bu[4], 12);
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk destination waypoint info: %s\n", wp);
   seatalk_print_command(bu, size, session);
   return 0;
@@ -943,7 +938,7 @@ static gps_mask_t seatalk_process_arrival(uint8_t * bu, uint8_t size,
   char wp[5]; memset(wp, 0, 5);
   for(i = 0; i < 4; i++)
     wp[i] = bu[3 + i];
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "%02X: seatalk arrival info: perpendicular = %s, circle = %s, wp = %s \n",
 	      bu[0],
 	      bu[1] & 0x20 ? "passed" : "not passed",
@@ -1015,7 +1010,7 @@ static gps_mask_t seatalk_process_gps_dgps(uint8_t * bu, uint8_t size,
 	session->gpsdata.satellites_used = ((bu[2] & 0xE0) >> 4) | ((bu[3] & 0x01));
     }
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 		"seatalk gps_dgps: sats= %d, signal quality= %d, hdop= %.2f, antenna height= %.2f, diff age = %d, diff id = %d\n",
 		session->gpsdata.satellites_used,
 		session->newdata.mode,
@@ -1026,7 +1021,7 @@ static gps_mask_t seatalk_process_gps_dgps(uint8_t * bu, uint8_t size,
     break;
 
   case 0x0C: {
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                   "seatalk data: sat numbers= %u, %u\n"
                   "              sat signal = %u, %u\n",
                   ((bu[2]&0xFE) >> 1), ((bu[6]&0x70) >> 1) + (bu[7]&0x07),
@@ -1052,7 +1047,7 @@ static gps_mask_t seatalk_process_gps_dgps(uint8_t * bu, uint8_t size,
       if(((bu[1]&0xF0) == 0) && (bu[2] & 0x01)) no = 2;
       else if(((bu[1]&0xF0) == 2) && (bu[2] & 0x01)) no = 4;
       else if(((bu[1]&0xF0) == 7) && (bu[2] & 0x01)) no = 5;
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                   "seatalk data %u: sat numbers= %u, %u, %u\n"
                   "                 sat azi    = %u, %u, %u\n"
                   "                 sat elev   = %u, %u, %u\n"
@@ -1074,7 +1069,7 @@ static gps_mask_t seatalk_process_gps_dgps(uint8_t * bu, uint8_t size,
              Satellite signal:   [1] (SS&0xFE)/2, [2] (GG&0x80)/2+OO&0x3F, [3] (YY&0xFC)/2+ZZ&0x1
       */
       uint8_t no = 6;
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                   "seatalk data %u: sat numbers= %u, %u, %u\n"
                   "                 sat signal = %u, %u, %u\n",
                   no,
@@ -1084,7 +1079,7 @@ static gps_mask_t seatalk_process_gps_dgps(uint8_t * bu, uint8_t size,
 
     break;
   case 0x74: {
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
                   "seatalk satellite ids: %u, %u, %u, %u, %u\n", bu[2], bu[3], bu[4], bu[5], bu[6]);
   }
     break;
@@ -1101,13 +1096,14 @@ static gps_mask_t seatalk_process_gps_dgps(uint8_t * bu, uint8_t size,
 static gps_mask_t seatalk_process_unkown(uint8_t * bu, uint8_t size,
 					struct gps_device_t *session) {
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_DATA, session->context->debug,
 	      "seatalk unknown: \n");
   seatalk_print_command(bu, size, session);
   return 0;
 }
 
-static int seatalk_is_command(struct gps_packet_t *lexer, uint8_t c, int parerr) {
+static int seatalk_is_command(struct gps_packet_t *lexer, uint8_t c, int parerr,
+                              bool trace) {
 
   /* generally per definition:
      - even parity bit set (1, high) if count of 1s is odd
@@ -1147,8 +1143,9 @@ static int seatalk_is_command(struct gps_packet_t *lexer, uint8_t c, int parerr)
     }
   }
 
-  gpsd_report(lexer->debug, LOG_RAW+2,
-	      "%02X %s %s\n", c, cmdFlag?"(C)":"", parity?"O":"E");
+  if (trace)
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW+2, lexer->debug,
+		"%02X %s %s\n", c, cmdFlag?"(C)":"", parity?"O":"E");
 
   return cmdFlag;
 
@@ -1194,66 +1191,69 @@ static const char msg_FF[] = {"Unkown sentence"};
 
 static const char msg_error [] = {"**error**"};
 
-static struct st_phrase st_process[] = {
-  {0x00,  0x02, seatalk_process_depth,        &msg_00[0]},
-  {0x10,  0x01, seatalk_process_wind_angle,   &msg_10[0]},
-  {0x11,  0x01, seatalk_process_wind_speed,   &msg_11[0]},
-  {0x20,  0x01, seatalk_process_speed,        &msg_20[0]},
-  {0x21,  0x02, seatalk_process_milage,       &msg_21[0]},
-  {0x22,  0x02, seatalk_process_milage,       &msg_22[0]},
-  {0x23,  0x01, seatalk_process_watertemp,    &msg_23[0]},
-  {0x25,  0x04, seatalk_process_distlog,      &msg_25[0]},
-  {0x26,  0x04, seatalk_process_speed,        &msg_20[0]},
-  {0x27,  0x01, seatalk_process_watertemp,    &msg_23[0]},
-  {0x36,  0x00, seatalk_process_MOB_cancel,   &msg_36[0]},
-  {0x50,  0x02, seatalk_process_lat,          &msg_50[0]},
-  {0x51,  0x02, seatalk_process_lon,          &msg_51[0]},
-  {0x52,  0x01, seatalk_process_sog,          &msg_52[0]},
-  {0x53,  0x00, seatalk_process_cog,          &msg_53[0]},
-  {0x54,  0x01, seatalk_process_time,         &msg_54[0]},
-  {0x56,  0x01, seatalk_process_date,         &msg_56[0]},
-  {0x57,  0x00, seatalk_process_noofsats,     &msg_57[0]},
-  {0x58,  0x05, seatalk_process_lat_lon_raw,  &msg_58[0]},
-  {0x59,  0x02, seatalk_process_count_down,   &msg_59[0]},
-  {0x6E,  0x07, seatalk_process_MOB,          &msg_6E[0]},
-  {0x82,  0x05, seatalk_process_target_wp,    &msg_82[0]},
-  {0x84,  0x06, seatalk_process_compass_hdg,  &msg_84[0]},
-  {0x85,  0x06, seatalk_process_nav_to_wp,                   &msg_85[0]},
-  {0x89,  0x02, seatalk_process_compass_hdg_st40,            &msg_89[0]},
-  {0x99,  0x00, seatalk_process_compass_variation_st40,      &msg_99[0]},
-  {0x9c,  0x01, seatalk_process_hdg_rudder_pos,              &msg_9C[0]},
-  {0x9e,  0x0C, seatalk_process_wp_definition,               &msg_9E[0]},
-  {0xa1,  0x0D, seatalk_process_dest_wp,                     &msg_A1[0]},
-  {0xa2,  0x04, seatalk_process_arrival,                     &msg_A2[0]},
-  {0xa5,  0x80, seatalk_process_gps_dgps,                    &msg_A5[0]}
+/*
+ * indexed by command ID, so a datagram finds its decoder in one step;
+ * commands without a decoder are not known
+ */
+static const struct st_phrase st_process[256] = {
+  [0x00] = {0x00,  0x02, seatalk_process_depth,        &msg_00[0]},
+  [0x10] = {0x10,  0x01, seatalk_process_wind_angle,   &msg_10[0]},
+  [0x11] = {0x11,  0x01, seatalk_process_wind_speed,   &msg_11[0]},
+  [0x20] = {0x20,  0x01, seatalk_process_speed,        &msg_20[0]},
+  [0x21] = {0x21,  0x02, seatalk_process_milage,       &msg_21[0]},
+  [0x22] = {0x22,  0x02, seatalk_process_milage,       &msg_22[0]},
+  [0x23] = {0x23,  0x01, seatalk_process_watertemp,    &msg_23[0]},
+  [0x25] = {0x25,  0x04, seatalk_process_distlog,      &msg_25[0]},
+  [0x26] = {0x26,  0x04, seatalk_process_speed,        &msg_20[0]},
+  [0x27] = {0x27,  0x01, seatalk_process_watertemp,    &msg_23[0]},
+  [0x36] = {0x36,  0x00, seatalk_process_MOB_cancel,   &msg_36[0]},
+  [0x50] = {0x50,  0x02, seatalk_process_lat,          &msg_50[0]},
+  [0x51] = {0x51,  0x02, seatalk_process_lon,          &msg_51[0]},
+  [0x52] = {0x52,  0x01, seatalk_process_sog,          &msg_52[0]},
+  [0x53] = {0x53,  0x00, seatalk_process_cog,          &msg_53[0]},
+  [0x54] = {0x54,  0x01, seatalk_process_time,         &msg_54[0]},
+  [0x56] = {0x56,  0x01, seatalk_process_date,         &msg_56[0]},
+  [0x57] = {0x57,  0x00, seatalk_process_noofsats,     &msg_57[0]},
+  [0x58] = {0x58,  0x05, seatalk_process_lat_lon_raw,  &msg_58[0]},
+  [0x59] = {0x59,  0x02, seatalk_process_count_down,   &msg_59[0]},
+  [0x6E] = {0x6E,  0x07, seatalk_process_MOB,          &msg_6E[0]},
+  [0x82] = {0x82,  0x05, seatalk_process_target_wp,    &msg_82[0]},
+  [0x84] = {0x84,  0x06, seatalk_process_compass_hdg,  &msg_84[0]},
+  [0x85] = {0x85,  0x06, seatalk_process_nav_to_wp,                   &msg_85[0]},
+  [0x89] = {0x89,  0x02, seatalk_process_compass_hdg_st40,            &msg_89[0]},
+  [0x99] = {0x99,  0x00, seatalk_process_compass_variation_st40,      &msg_99[0]},
+  [0x9c] = {0x9c,  0x01, seatalk_process_hdg_rudder_pos,              &msg_9C[0]},
+  [0x9e] = {0x9e,  0x0C, seatalk_process_wp_definition,               &msg_9E[0]},
+  [0xa1] = {0xa1,  0x0D, seatalk_process_dest_wp,                     &msg_A1[0]},
+  [0xa2] = {0xa2,  0x04, seatalk_process_arrival,                     &msg_A2[0]},
+  [0xa5] = {0xa5,  0x80, seatalk_process_gps_dgps,                    &msg_A5[0]}
 };
 
+static inline uint8_t st_fixed_length(uint8_t cmd)
+/* the length field a command must have, 0x80 if not known */
+{
+  return st_process[cmd].decoder != NULL ? st_process[cmd].fixed_length : 0x80;
+}
+
 /*@+usereleased@*/
 
 gps_mask_t process_seatalk(uint8_t * cmdBuffer, uint8_t size,
 					struct gps_device_t *session) {
   gps_mask_t mask = 0;
+  const struct st_phrase *phrase;
 
-  uint8_t i = 0;
-  uint8_t decoded = 0;
-
-  while(i < (uint8_t)(sizeof(st_process) / sizeof(st_process[0]))) {
-    if(st_process[i].cmdId == cmdBuffer[0]) {
-        decoded = 1;
-        if((st_process[i].fixed_length == 0x80) || (st_process[i].fixed_length + 3 <= size)) {
-            mask = st_process[i].decoder(cmdBuffer, size, session);
-        } else {
-            gpsd_external_report(session->context->debug, LOG_ERROR,
-                                 "Rejecting wrong size %u for sentence %02x\n",
-                                 size, cmdBuffer[0]);
-        }
-        break;
-    }
-    i++;
-  }
+  if (size == 0)
+    return 0;
 
-  if (!decoded) {
+  phrase = &st_process[cmdBuffer[0]];
+  if (phrase->decoder == NULL) {
       seatalk_process_unkown(cmdBuffer, size, session);
+  } else if((phrase->fixed_length == 0x80) || (phrase->fixed_length + 3 <= size)) {
+      mask = phrase->decoder(cmdBuffer, size, session);
+  } else {
+      gpsd_external_report(session->context->debug, LOG_ERROR,
+                           "Rejecting wrong size %u for sentence %02x\n",
+                           size, cmdBuffer[0]);
   }
 
   if ((mask & TIME_SET) != 0) {
@@ -1319,9 +1319,9 @@ static char * seatalk_state_table[] = {
   "SEATALK_RECOGNIZED",
 };
 
-static void seatalk_nextstate(struct gps_packet_t *lexer, unsigned char c)
+static inline void seatalk_nextstate(struct gps_packet_t *lexer,
+                                     unsigned char c, bool trace)
 {
-    static int n = 0;
     int parity   = 0;
     int cmd      = 0;
 
@@ -1365,10 +1365,10 @@ static void seatalk_nextstate(struct gps_packet_t *lexer, unsigned char c)
 
     if((lexer->state & PARITY_SET) == 0) {
 
-      n++;
-
-      if((!cmd) && seatalk_is_command(lexer, c, parity)) {
-	gpsd_report(lexer->debug, LOG_RAW + 2, "command flag\n");
+      if((!cmd) && seatalk_is_command(lexer, c, parity, trace)) {
+	if (trace)
+	  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+		      "command flag\n");
 	cmd = 1;
       }
 
@@ -1381,11 +1381,12 @@ static void seatalk_nextstate(struct gps_packet_t *lexer, unsigned char c)
 	if(cmd) {
 	  lexer->state = SEATALK_COMMAND;
 	  lexer->length = 0x80;
-	  if((st_fixed_lengths[c] & 0x80) == 0) {
-	    lexer->length = st_fixed_lengths[c];
-	    gpsd_report(lexer->debug, LOG_RAW + 2,
-			"%08ld: fixed length assigned based on table: %lu\n",
-			lexer->char_counter, lexer->length);
+	  if((st_fixed_length(c) & 0x80) == 0) {
+	    lexer->length = st_fixed_length(c);
+	    if (trace)
+	      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+			  "%08ld: fixed length assigned based on table: %lu\n",
+			  lexer->char_counter, lexer->length);
 	  }
 	} else {
 	  lexer->state = GROUND_STATE;
@@ -1400,17 +1401,19 @@ static void seatalk_nextstate(struct gps_packet_t *lexer, unsigned char c)
 	  if((lexer->length & 0x80) == 0) {
 	    // fixed length based on lookup table
 	    if(lexer->length != (c & 0x0f)) {
-	      gpsd_report(lexer->debug, LOG_RAW + 2,
-			  "%08ld: wrong fixed length found: %lu != %u\n",
-                      lexer->char_counter, lexer->length, (c & 0x0f));
+	      if (trace)
+		GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+			    "%08ld: wrong fixed length found: %lu != %u\n",
+			    lexer->char_counter, lexer->length, (c & 0x0f));
 	      lexer->state = GROUND_STATE;
 	      break;
 	    }
 	  }
 	  lexer->length = c & 0x0f;
-	  gpsd_report(lexer->debug, LOG_RAW + 2,
-		      "%08ld: length found: %lu\n",
-		      lexer->char_counter, lexer->length);
+	  if (trace)
+	    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+			"%08ld: length found: %lu\n",
+			lexer->char_counter, lexer->length);
 	} else {
 	  lexer->state = GROUND_STATE | SEATALK_CMD_PENDING;
 	  character_pushback(lexer);
@@ -1430,16 +1433,18 @@ static void seatalk_nextstate(struct gps_packet_t *lexer, unsigned char c)
 	break;
 
       case SEATALK_PAY:
-	gpsd_report(lexer->debug, LOG_RAW + 2,
-		    "%08ld: length= %lu\n",
-		    lexer->char_counter, lexer->length);
+	if (trace)
+	  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+		      "%08ld: length= %lu\n",
+		      lexer->char_counter, lexer->length);
 	if(!cmd) {
 	  if (--lexer->length == 0)
 	    lexer->state = SEATALK_RECOGNIZED;
 	} else {
-	  gpsd_report(lexer->debug, LOG_RAW + 2,
-		      "%08ld: switching back to ground state with length= %lu\n",
-		      lexer->char_counter, lexer->length);
+	  if (trace)
+	    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+			"%08ld: switching back to ground state with length= %lu\n",
+			lexer->char_counter, lexer->length);
 	  lexer->state = GROUND_STATE | SEATALK_CMD_PENDING;
 	  character_pushback(lexer);
 	}
@@ -1452,21 +1457,30 @@ static void seatalk_nextstate(struct gps_packet_t *lexer, unsigned char c)
 }
 
 static void seatalk_packet_parse(struct gps_packet_t * lexer)
-/* grab a packet from the input buffer */
+/*
+ * grab a packet from the input buffer; the scan goes on from where the
+ * last call stopped, so a buffer holding several datagrams is read
+ * once and handed out a datagram per call
+ */
 {
+    /* whether to trace the characters is decided once per call */
+    const bool trace = LOG_SUBACTIVE(LOG_SUB_SEATALK, LOG_RAW + 2,
+				     lexer->debug);
+
     lexer->outbuflen = 0;
     while (packet_buffered_input(lexer) > 0) {
 	/*@ -modobserver @*/
 	unsigned char c = *lexer->inbufptr++;
 	/*@ +modobserver @*/
-	seatalk_nextstate(lexer, c);
-	gpsd_report(lexer->debug, LOG_RAW + 2,
-		    "%08ld: character '%c' [%02x] @ %p, new state: %s, %c%c\n",
-		    lexer->char_counter, (isprint(c) ? c : '.'), c,
-		    lexer->inbufptr - 1,
-		    seatalk_state_table[(lexer->state & 0xF0) >> 4],
-		    (lexer->state & PARITY_WARN)?'?':'-',
-		    (lexer->state & PARITY_ERROR)?'!':'-');
+	seatalk_nextstate(lexer, c, trace);
+	if (trace)
+	    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
+			"%08ld: character '%c' [%02x] @ %p, new state: %s, %c%c\n",
+			lexer->char_counter, (isprint(c) ? c : '.'), c,
+			lexer->inbufptr - 1,
+			seatalk_state_table[(lexer->state & 0xF0) >> 4],
+			(lexer->state & PARITY_WARN)?'?':'-',
+			(lexer->state & PARITY_ERROR)?'!':'-');
 	lexer->char_counter++;
 
 	if ((lexer->state & 0xF0) == GROUND_STATE) {
@@ -1481,7 +1495,8 @@ static void seatalk_packet_parse(struct gps_packet_t * lexer)
 
 		packet_accept(lexer, SEATALK_PACKET);
 		packet_discard(lexer);
-		gpsd_report(lexer->debug, LOG_RAW + 2,
+		if (trace)
+		    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
 		    "%08ld: ptr= %p, s= %p, %lu\n",
 			    lexer->char_counter,
 			    lexer->inbufptr,
@@ -1502,6 +1517,17 @@ ssize_t seatalk_packet_get(struct gps_device_t *session)
 
     struct gps_packet_t *lexer = &session->packet;;
 
+    /*
+     * A read() brings in many datagrams.  Hand out the ones already
+     * buffered before reading again, which would cost a system call
+     * per datagram and block a tty that has nothing more to say.
+     */
+    if (packet_buffered_input(lexer) > 0) {
+	seatalk_packet_parse(lexer);
+	if (lexer->outbuflen > 0)
+	    return (ssize_t) lexer->outbuflen;
+    }
+
     /*@ -modobserver @*/
     errno = 0;
 
@@ -1510,16 +1536,16 @@ ssize_t seatalk_packet_get(struct gps_device_t *session)
     /*@ +modobserver @*/
     if (recvd == -1) {
 	if ((errno == EAGAIN) || (errno == EINTR)) {
-	    gpsd_report(lexer->debug, LOG_RAW + 2, "no bytes ready\n");
+	    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug, "no bytes ready\n");
 	    recvd = 0;
 	    /* fall through, input buffer may be nonempty */
 	} else {
-	    gpsd_report(lexer->debug, LOG_RAW + 2,
+	    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_RAW + 2, lexer->debug,
 			"errno: %s\n", strerror(errno));
 	    return -1;
 	}
     } else {
-	if (lexer->debug >= LOG_IO) {
+	if (LOG_SUBACTIVE(LOG_SUB_CORE, LOG_IO, lexer->debug)) {
 	    char scratchbuf[MAX_PACKET_LENGTH*2+1];
 	    gpsd_external_report(lexer->debug, LOG_IO,
 				 "Read %zd chars to buffer offset %zd (total %zd): %s\n",
@@ -1529,7 +1555,7 @@ ssize_t seatalk_packet_get(struct gps_device_t *session)
 	}
 	lexer->inbuflen += recvd;
     }
-    gpsd_report(lexer->debug, LOG_SPIN,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_SPIN, lexer->debug,
 		"seatalk_packet_get() fd %d -> %zd (%d)\n",
 		session->gpsdata.gps_fd, recvd, errno);
 
@@ -1539,7 +1565,7 @@ ssize_t seatalk_packet_get(struct gps_device_t *session)
      * packet input buffer.
      */
     if (recvd <= 0 && packet_buffered_input(lexer) <= 0) {
-        gpsd_report(lexer->debug, LOG_SPIN,
+        GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_SPIN, lexer->debug,
 		    "Seatalk: bailing out with no more input\n");
 	return recvd;
     }
@@ -1553,7 +1579,7 @@ ssize_t seatalk_packet_get(struct gps_device_t *session)
 	/* coverity[tainted_data] */
 	packet_discard(lexer);
 	lexer->state = GROUND_STATE;
-        gpsd_report(lexer->debug, LOG_SPIN,
+        GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_SPIN, lexer->debug,
 		    "Seatalk: input buffer full, discard\n");
     }
 
@@ -1601,7 +1627,7 @@ static void seatalk_set_serial(struct gps_device_t *session) {
   memset (&tty, 0, sizeof tty);
 
   if (tcgetattr(session->gpsdata.gps_fd, &session->ttyset_old) != 0) {
-    gpsd_report(session->context->debug, LOG_ERROR,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_ERROR, session->context->debug,
 		"SEATALK tcgetattr error %d: %s\n", errno, strerror(errno));
     session->gpsdata.gps_fd = -1;
     return;
@@ -1663,7 +1689,7 @@ static void seatalk_set_serial(struct gps_device_t *session) {
   tcflush( session->gpsdata.gps_fd, TCIFLUSH );
 
   if ( tcsetattr ( session->gpsdata.gps_fd, TCSANOW, &session->ttyset ) != 0) {
-    gpsd_report(session->context->debug, LOG_ERROR,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_ERROR, session->context->debug,
 		"SEATALK tcsetattr error %d: %s\n", errno, strerror(errno));
     session->gpsdata.gps_fd = -1;
     return;
@@ -1673,9 +1699,6 @@ static void seatalk_set_serial(struct gps_device_t *session) {
 
 static void seatalk_driver_init(struct gps_device_t * session) {
 
-  uint8_t cmd;
-  uint8_t i = 0;
-
   session->driver.seatalk.lon = NAN;
   session->driver.seatalk.lat = NAN;
   session->driver.seatalk.lat_set = 0;
@@ -1683,15 +1706,6 @@ static void seatalk_driver_init(struct gps_device_t * session) {
 
   session->driver.seatalk.offset = 0;
   session->driver.seatalk.lastts = 0;
-
-  memset(st_fixed_lengths, 0x80, 255);
-
-  while(i < (uint8_t)(sizeof(st_process) / sizeof(st_process[0]))) {
-    cmd = st_process[i].cmdId;
-    st_fixed_lengths[cmd] = st_process[i].fixed_length;
-    i++;
-  }
-
 }
 
 #ifndef S_SPLINT_S
@@ -1703,7 +1717,7 @@ int seatalk_open(struct gps_device_t *session) {
   session->gpsdata.gps_fd = -1;
   port = strchr(path, ':');
 
-  gpsd_report(session->context->debug, LOG_INF,
+  GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_INF, session->context->debug,
 	      "SEATALK open: opening device: %s\n", path);
 
   if(port == NULL) {
@@ -1717,16 +1731,16 @@ int seatalk_open(struct gps_device_t *session) {
   } else {
 
     *port++ = '\0';
-    gpsd_report(session->context->debug, LOG_INF, "opening TCP SEATALK test feed at %s, port %s.\n", path,
+    GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_INF, session->context->debug, "opening TCP SEATALK test feed at %s, port %s.\n", path,
 		port);
 
     if ((session->gpsdata.gps_fd = netlib_connectsock(AF_UNSPEC, path, port, "tcp")) < 0) {
-      gpsd_report(session->context->debug, LOG_ERROR, "TCP device open error %s.\n",
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_ERROR, session->context->debug, "TCP device open error %s.\n",
 		  netlib_errstr(session->gpsdata.gps_fd));
 
     } else
 
-      gpsd_report(session->context->debug, LOG_SPIN, "TCP device opened on fd %d\n",
+      GPSD_SUBLOG(LOG_SUB_SEATALK, LOG_SPIN, session->context->debug, "TCP device opened on fd %d\n",
 		  session->gpsdata.gps_fd);
 
   }
@@ -51,8 +51,6 @@
 #define PKG_TYPE_NMEA2000 0x02
 #define PKG_TYPE_ST       0x04
 
-float HDGboat=0,HDGmast=0,AWAmast=0,AWAboat=0;
-
 uint32_t vy_port_speeds[] = {
   PORT_SPEED_4800,
   PORT_SPEED_38400,
@@ -70,6 +68,8 @@ uint32_t last_error_stats_report = 0;
 
 static gps_mask_t hnd_059392(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_059904(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
+static gps_mask_t hnd_060160(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
+static gps_mask_t hnd_060416(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_060928(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_126208(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_126464(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
@@ -94,41 +94,31 @@ static gps_mask_t hnd_130842(unsigned char *bu, int len, struct PGN *pgn, struct
 static gps_mask_t hnd_127506(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_127508(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_127513(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127488(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127489(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_127493(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_127505(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_127237(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127245(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127250(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127257(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127251(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_127258(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_128259(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_128267(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_128275(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_129033(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_129283(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_129284(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_129285(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_129291(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_130306(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_130310(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
-static gps_mask_t hnd_130311(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_130312(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_130824(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_130845(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_130850(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 
+static gps_mask_t hnd_schema(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 static gps_mask_t hnd_unknown(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session);
 
 static struct PGN pgnlist[] = {
-    { 59392, 0, 0, 0, 0, hnd_059392, "ISO Acknowledgment"},
+    { 59392, 0, 0, 0, 1, hnd_059392, "ISO Acknowledgment"},
     { 59904, 0, 0, 1, 1, hnd_059904, "ISO Request"},
+    { 60160, 0, 0, 1, 1, hnd_060160, "ISO Transport Protocol, Data Transfer"},
+    { 60416, 0, 0, 1, 1, hnd_060416, "ISO Transport Protocol, Connection Management"},
     { 60928, 0, 0, 1, 1, hnd_060928, "ISO  Address Claim"},
     {126208, 0, 0, 0, 0, hnd_126208, "NMEA Command/Request/Acknowledge"},
     {126464, 1, 0, 0, 1, hnd_126464, "ISO  Transmit/Receive PGN List"},
-    {126996, 1, 0, 0, 0, hnd_126996, "ISO  Product Information"},
+    {126996, 1, 0, 0, 1, hnd_126996, "ISO  Product Information"},
     {129025, 0, 1, 1, 1, hnd_129025, "GNSS Position Rapid Update"},
     {129026, 0, 1, 1, 1, hnd_129026, "GNSS COG and SOG Rapid Update"},
     {129029, 1, 1, 1, 0, hnd_129029, "GNSS Positition Data"},
@@ -149,27 +139,27 @@ static struct PGN pgnlist[] = {
     {127506, 1, 3, 0, 0, hnd_127506, "PWR DC Detailed Status"},
     {127508, 1, 3, 0, 0, hnd_127508, "PWR Battery Status"},
     {127513, 1, 3, 0, 0, hnd_127513, "PWR Battery Configuration Status"},
-    {127488, 0, 0, 1, 0, hnd_127488, "Engine Parameters, Rapid"},
-    {127489, 1, 3, 1, 0, hnd_127489, "Engine Parameters, Dynamic"},
+    {127488, 0, 0, 1, 0, hnd_schema, "Engine Parameters, Rapid"},
+    {127489, 1, 3, 1, 0, hnd_schema, "Engine Parameters, Dynamic"},
     {127493, 1, 3, 0, 0, hnd_127493, "Transmissions Parameters, Dynamic"},
     {127505, 1, 3, 0, 0, hnd_127505, "Fluid "},
     {127237, 0, 0, 0, 0, hnd_127237, "Heading/Track Control"},
-    {127245, 0, 4, 1, 0, hnd_127245, "NAV Rudder"},
-    {127250, 0, 4, 1, 1, hnd_127250, "NAV Vessel Heading"},
-    {127257, 0, 0, 1, 0, hnd_127257, "Attitude"},
-    {127251, 0, 0, 1, 0, hnd_127251, "Rate of Turn"},
-    {127258, 0, 0, 1, 0, hnd_127258, "GNSS Magnetic Variation"},
-    {128259, 0, 4, 1, 0, hnd_128259, "NAV Speed"},
-    {128267, 0, 4, 1, 0, hnd_128267, "NAV Water Depth"},
-    {128275, 1, 4, 1, 0, hnd_128275, "NAV Distance Log"},
+    {127245, 0, 4, 1, 0, hnd_schema, "NAV Rudder"},
+    {127250, 0, 4, 1, 1, hnd_schema, "NAV Vessel Heading"},
+    {127257, 0, 0, 1, 0, hnd_schema, "Attitude"},
+    {127251, 0, 0, 1, 0, hnd_schema, "Rate of Turn"},
+    {127258, 0, 0, 1, 0, hnd_schema, "GNSS Magnetic Variation"},
+    {128259, 0, 4, 1, 0, hnd_schema, "NAV Speed"},
+    {128267, 0, 4, 1, 0, hnd_schema, "NAV Water Depth"},
+    {128275, 1, 4, 1, 0, hnd_schema, "NAV Distance Log"},
     {129033, 1, 1, 0, 1, hnd_129033, "Time & Date"},
     {129283, 0, 0, 1, 0, hnd_129283, "NAV Cross Track Error"},
     {129284, 1, 0, 0, 0, hnd_129284, "NAV Navigation Data"},
     {129285, 1, 0, 0, 0, hnd_129285, "NAV Navigation - Route/WP Information"},
     {129291, 0, 0, 0, 0, hnd_129291, "NAV Set & Drift, Rapid Update"},
-    {130306, 0, 4, 1, 1, hnd_130306, "NAV Wind Data"},
-    {130310, 0, 4, 1, 0, hnd_130310, "NAV Water Temp., Outside Air Temp., Atmospheric Pressure"},
-    {130311, 0, 4, 1, 0, hnd_130311, "NAV Temperature"},
+    {130306, 0, 4, 1, 1, hnd_schema, "NAV Wind Data"},
+    {130310, 0, 4, 1, 0, hnd_schema, "NAV Water Temp., Outside Air Temp., Atmospheric Pressure"},
+    {130311, 0, 4, 1, 0, hnd_schema, "NAV Temperature"},
     {130312, 0, 4, 1, 0, hnd_130312, "NAV Temperature"},
     {130824, 0, 0, 0, 0, hnd_130824, "Maretron: Annunciator"},
     {130845, 0, 0, 0, 0, hnd_130845, "Simnet: Compass stuff"},
@@ -184,6 +174,9 @@ ssize_t vyspi_write_with_protocol(struct gps_device_t *session,
                                   const uint8_t *buf,
                                   const size_t len,
                                   const uint8_t protocol_version);
+static void vyspi_write_stats(struct gps_device_t *session,
+                              enum frm_type_t frm_type,
+                              size_t frmlen, size_t len);
 
 // some functions from packet.c we only use here
 extern void packet_accept(struct gps_packet_t *lexer, int packet_type);
@@ -209,12 +202,6 @@ extern void character_skip(struct gps_packet_t *lexer);
 int vy_port_list_read(struct gps_device_t *session, struct devconfig_t * dev);
 int vy_port2cmd(struct device_port_t * vy, uint8_t *cmd);
 
-static uint16_t crt_060928(uint8_t bufp[], size_t len,
-                           uint8_t prio, uint8_t src, uint8_t dest,
-                           struct gps_device_t *session);
-
-static void vyspi_claim_our_source_addr(struct gps_device_t *session);
-
 /*@-nullassign@*/
 static void print_data(struct gps_context_t *context,
 		       unsigned char *buffer, int len, struct PGN *pgn)
@@ -230,7 +217,7 @@ static void print_data(struct gps_context_t *context,
         ptr += l2;
         for (l1=0;l1<len;l1++) {
             if (((l1 % 20) == 0) && (l1 != 0)) {
-                gpsd_report(context->debug, LOG_IO,"%s\n", bu);
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, context->debug,"%s\n", bu);
                 ptr = 0;
                 l2 = sprintf(&bu[ptr], "                   : ");
                 ptr += l2;
@@ -238,7 +225,7 @@ static void print_data(struct gps_context_t *context,
             l2 = sprintf(&bu[ptr], "0x%02x ", (unsigned int)buffer[l1]);
             ptr += l2;
         }
-        gpsd_report(context->debug, LOG_IO,"%s\n", bu);
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, context->debug,"%s\n", bu);
     }
     /*@+bufferoverflowhigh@*/
 #endif
@@ -270,7 +257,7 @@ static int vy_decode_ais_header(struct gps_device_t *device,
         ais->mmsi  &= mask;
         if(ais->mmsi == device->gpsdata.own_mmsi)
             ais->own_mmsi = 1;
-        gpsd_report(device->context->debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, device->context->debug,
                     "VY:NMEA2000 AIS message type %u, own MMSI %09u, %s MMSI %09u:\n",
                     ais->type, device->gpsdata.own_mmsi, ais->own_mmsi?"own":"", ais->mmsi);
         return(1);
@@ -278,7 +265,7 @@ static int vy_decode_ais_header(struct gps_device_t *device,
         ais->type   =  0;
         ais->repeat =  0;
         ais->mmsi   =  0;
-        gpsd_report(device->context->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, device->context->debug,
                     "VY:NMEA2000 AIS message type %u, too short message.\n",
                     ais->type);
     }
@@ -351,9 +338,9 @@ static gps_mask_t hnd_059392(unsigned char *bu, int len, struct PGN *pgn, struct
   */
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   NMEA 2000 ISO Ack\n");
     return(0);
 }
@@ -361,266 +348,61 @@ static gps_mask_t hnd_059392(unsigned char *bu, int len, struct PGN *pgn, struct
 /*
  *   PGN 59904: ISO Request
  */
-static uint16_t crt_059904(uint8_t bufp[], size_t len,
-                           uint8_t prio, uint8_t src, uint8_t dest,
-                           uint32_t pgn,
-                           struct gps_device_t *session)
-{
-    if(len < 8+7)
-        return 0;
-    set8leu32(bufp, 59904, 0);
-
-    bufp[4]= prio;
-    bufp[5]= src;
-    bufp[6]= dest;
-
-    memset(bufp + 7, 0, 8);
-    set8leu16(bufp, (uint16_t)(pgn & 0xffff), 7);
-    set8leu8(bufp, (uint8_t)((pgn >> 16) & 0xffff), 7 + 2);
-
-    gpsd_report(session->context->debug, LOG_DATA,
-                "creating pgn %6u requesting pgn %u:\n", 59904, pgn);
-
-    return 8+7;
-}
-
-static void vyspi_send_product_information(struct gps_device_t *session) {
-
-    static const char * modelid = "vyacht network router";
-    static const char * serial_code = "130524";
-    static const char * model_version = "9.4";
-
-    char software_version[32];
-
-    uint8_t bu[134 + 7];
-
-    sprintf(software_version, "%s", VERSION);
-
-    memset(bu, 0xff, 134);
-    set8leu32(bu, 126996, 0);
-
-    bu[4]= 0x06;
-    bu[5]= session->driver.nmea2000.own_src_id;
-    bu[6]= 0xff;
-
-    set8leu16(bu, (uint16_t)(0x0514), 7); // stole this from NGW-1
-    set8leu16(bu, (uint16_t)(0x2c69), 9); // stole this from NGW-1
-    memcpy(bu + 11, modelid, strlen(modelid));
-    memcpy(bu + 43, software_version, strlen(software_version));
-    memcpy(bu + 75, model_version, strlen(model_version));
-    memcpy(bu + 107, serial_code, strlen(serial_code));
-    set8leu8(bu, 0x00, 139);             // stole cert level from NGW-1
-    set8leu8(bu, 0x01, 140);             // stole load from NGW-1
-
-    // using protocol version 1
-    vyspi_write_with_protocol(session, FRM_TYPE_NMEA2000, bu, 134 + 7, 1);
-
-    gpsd_report(session->context->debug, LOG_IO,
-                "                   NMEA 2000 ISO - sent product information from src= %u\n",
-                session->driver.nmea2000.own_src_id);
-}
-
-static void vyspi_send_pgn_list(struct gps_device_t *session) {
-
-    uint8_t bu[223];
-    uint16_t l1, l2;
-    uint8_t r;
-
-    struct PGN pgn;
-
-    memset(bu, 0xff, 223);
-    set8leu32(bu, 126464, 0);
-
-    bu[4]= 0x06;
-    bu[5]= session->driver.nmea2000.own_src_id;
-    bu[6]= 0xff;
-
-    for(r = 0; r < 2; r++) {
-
-        bu[7] = r; // 0= transmit, 1= receive
-
-        l1 = 0; l2= 0;
-        //TODO - not sure what happens if we need to report more one day
-        while ((pgnlist[l1].pgn != 0) && (8+l2*3 + 3 < 223)) {
-            if ( ((r == 0) && pgnlist[l1].transmit)
-                 || ((r == 1) && pgnlist[l1].receive)) {
-                     set8leu24(bu, pgnlist[l1].pgn, 8+l2*3);
-                     l2++;
-            }
-            l1++;
-        }
-
-        // using protocol version 1
-        vyspi_write_with_protocol(session, FRM_TYPE_NMEA2000, bu, 8+l2*3, 1);
-
-        pgn.pgn = 126464;
-        print_data(session->context, bu, 8+l2*3, &pgn);
-    }
-
-    gpsd_report(session->context->debug, LOG_IO,
-                "                   NMEA 2000 ISO - sent receive & transmit list from src= %u\n",
-                session->driver.nmea2000.own_src_id);
-}
-
-/**
- *   PGN 59904: ISO Request
- */
-static gps_mask_t hnd_059904(unsigned char *bu, int len UNUSED, struct PGN *pgn, struct gps_device_t *session)
+static gps_mask_t hnd_059904(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
-    uint32_t request_pgn =
-        (uint32_t)( (uint16_t)getleu16(bu, 0) | ((uint16_t)(bu[2]) << 16));
+    uint32_t request_pgn = len >= 3 ? getleu24(bu, 0) : 0;
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   NMEA 2000 ISO - PGN requested= %u\n", request_pgn);
 
-    if((session->driver.vyspi.dest == 0xff)
-       || (session->driver.vyspi.dest == session->driver.nmea2000.own_src_id)) {
-
-        if(request_pgn == 60928) {
-            vyspi_claim_our_source_addr(session);
-        } else if(request_pgn == 126996) {
-            vyspi_send_product_information(session);
-        } else if(request_pgn == 126464) {
-            vyspi_send_pgn_list(session);
-        }
-    }
+    // our node answers what is asked of it
+    if(session->gpsdata.dev.protocol_version)
+        (void)n2k_node_input(session, pgn->pgn, session->driver.vyspi.prio,
+                             session->driver.vyspi.src,
+                             session->driver.vyspi.dest,
+                             bu, (size_t)len, timestamp());
 
     return(0);
 }
 
-
-static void vyspi_claim_our_source_addr(struct gps_device_t *session)
-{
-        // make a claim back with lower ecu name and same src addr
-        uint8_t cmd[64];
-        uint16_t len;
-
-        if(session->driver.nmea2000.own_src_id >= 240)
-            return;
-
-        len = crt_060928(cmd, 64,
-                         0x06,
-                         session->driver.nmea2000.own_src_id,
-                         255, // its a broadcast to all
-                         session);
-
-        // using protocol version 1
-        vyspi_write_with_protocol(session, FRM_TYPE_NMEA2000, cmd, len, 1);
-
-        gpsd_report(session->context->debug, LOG_IO,
-                "                   NMEA 2000 ISO - claimed source src= %u\n",
-                    session->driver.nmea2000.own_src_id);
-
-        // nothing more to do here
-        // - if other nodes "complains" it will send address claims and we'll just react to that
-}
-
-static void vyspi_addr_claim_call(struct gps_device_t *session)
-{
-    // init source addresses
-    uint16_t e = 0;
-    for(e = 0; e < 256; e++) {
-        session->gpsdata.ecu_names[e] = 0;
-    }
-
-    // make an iso claim address call to enumerate nodes out there
-    uint8_t cmd[64];
-    size_t len = 0;
-
-    len = crt_059904(cmd, 64,
-                     0x06,
-                     0xfe, // Source Address is 254 (NULL address), as required by protocol
-                     255, // its a broadcast to all
-                     60928,
-                     session);
-
-    gpsd_report(session->context->debug, LOG_INF,
-                "NMEA 2000 ISO - making an address claim call.\n");
-
-    // using protocol version 1
-    vyspi_write_with_protocol(session, FRM_TYPE_NMEA2000, cmd, len, 1);
-}
-
 /*
- *
+ *   PGN 60160: ISO Transport Protocol, Data Transfer
+ *   PGN 60416: ISO Transport Protocol, Connection Management
  */
-static void vyspi_claim_free_source_addr(struct gps_device_t *session)
+static gps_mask_t hnd_060160(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
-    // now we need to send our own address claim based on a free address
-    uint16_t e = 0;
-    session->driver.nmea2000.own_src_id = 255;
-    for(e = 1; e < 256; e++) {
-        if((session->gpsdata.ecu_names[e] == 0)
-           && (session->gpsdata.src_addr_seen[e] == 0)){
-            // this is a free source address
-            session->driver.nmea2000.own_src_id = e;
-            break;
-
-        } else {
-            uint64_t ecu = session->gpsdata.ecu_names[e];
-
-            uint32_t uniq   = (ecu >>  0) & 0x1fffff;
-            uint16_t manu   = (ecu >> 21) & 0x7ff;
-
-            if(ecu != 0)
-                gpsd_report(session->context->debug, LOG_INF,
-                            "Search free src addr: 0x%02x in use by %u:%u\n", e, manu, uniq);
-            else
-                gpsd_report(session->context->debug, LOG_INF,
-                            "Search free src addr: 0x%02x in use by unkown device\n", e);
-
-        }
-    }
+    print_data(session->context, bu, len, pgn);
 
-    gpsd_report(session->context->debug, LOG_INF,
-                "Claim (new) source address %u.\n",
-                session->driver.nmea2000.own_src_id);
+    if(session->gpsdata.dev.protocol_version)
+        (void)n2k_node_input(session, pgn->pgn, session->driver.vyspi.prio,
+                             session->driver.vyspi.src,
+                             session->driver.vyspi.dest,
+                             bu, (size_t)len, timestamp());
 
-    if(session->driver.nmea2000.own_src_id < 240) {
-        vyspi_claim_our_source_addr(session);
-    }
+    return(0);
 }
 
-static void vyspi_get_ecu_name(uint64_t * ecu_name, struct gps_device_t *session) {
-
-    *ecu_name = 0xc0f0823fe76b4b35;
-
-    *ecu_name &= ~((uint64_t)0x7ff << 21);
-    *ecu_name &= ~((uint64_t)0x1fffff << 0);
-
-    *ecu_name |= ((uint64_t)session->driver.nmea2000.manufactureid << 21);
-    *ecu_name |= ((uint64_t)session->driver.nmea2000.deviceid << 0);
+static gps_mask_t hnd_060416(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
+{
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
+		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
+    return hnd_060160(bu, len, pgn, session);
 }
 
 /*
- *   PGN 60928: ISO  Address Claim
+ * The bus registry, when the daemon keeps one and the frame being
+ * handled said where it came from.
  */
-static uint16_t crt_060928(uint8_t bufp[], size_t len,
-                       uint8_t prio, uint8_t src, uint8_t dest,
-                       struct gps_device_t *session)
+static struct n2k_bus_t *vyspi_bus(struct gps_device_t *session)
 {
-    if(len < 8+7)
-        return 0;
-
-    uint64_t ECU_name;
-    vyspi_get_ecu_name(&ECU_name, session);
-
-    set8leu32(bufp, 60928, 0);
-
-    bufp[4]= prio;
-    bufp[5]= src;
-    bufp[6]= dest;
-
-    set8leu64(bufp, ECU_name, 7);
-
-    gpsd_report(session->context->debug, LOG_DATA,
-                "creating pgn %6d with ecu name %lu:\n", 60928, ECU_name);
-
-    return 8+7;
+    if(session->driver.vyspi.src == N2K_NODE_GLOBAL)
+        return NULL;
+    return session->context->n2kbus;
 }
 
+
 /*
  *   PGN 60928: ISO  Address Claim
  */
@@ -660,10 +442,10 @@ static gps_mask_t hnd_060928(unsigned char *bu, int len, struct PGN *pgn, struct
     dc     = (getub(bu, 6) >> 1) & 0x7F;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   NMEA 2000 ISO - Id= %u, Manufacturer= %u, Industry Group = %u, "
                 "Device Class = %u, "
                 "Device Instance Lower = %u, "
@@ -673,35 +455,16 @@ static gps_mask_t hnd_060928(unsigned char *bu, int len, struct PGN *pgn, struct
                 manu,
                 grp, dc, ilo, ihi, bu[5]);
 
-    if(session->gpsdata.dev.protocol_version) {
-        // record that we have seen this source address with this ecu name
-        // no test needed, always 0 <= src <= 255 due to uint8_t
-        session->gpsdata.ecu_names[session->driver.vyspi.src] = ECU_name;
-    }
+    if(vyspi_bus(session) != NULL)
+        n2k_bus_claim(vyspi_bus(session), session->driver.vyspi.src,
+                      bu, (size_t)len, timestamp());
 
-    if(session->driver.nmea2000.own_src_id == session->driver.vyspi.src) {
-
-        gpsd_report(session->context->debug, LOG_INF,
-                    "NMEA 2000 ISO - source address 0x%02x claims our own source address.\n",
-                    session->driver.nmea2000.own_src_id);
-
-        // someone claims our source address
-        uint64_t our_ecu_name;
-        vyspi_get_ecu_name(&our_ecu_name, session);
-
-        // lower wins, then claim a new one if we are higer
-        if(ECU_name < our_ecu_name) {
-            gpsd_report(session->context->debug, LOG_INF,
-                        "NMEA 2000 ecu name higher, we loose.\n");
-            // all info should be collected already
-            vyspi_claim_free_source_addr(session);
-        } else {
-            gpsd_report(session->context->debug, LOG_INF,
-                        "NMEA 2000 ecu name higher, we win.\n");
-            // reclaim our so that other node knows
-            vyspi_claim_our_source_addr(session);
-        }
-    }
+    // the node keeps the claims, and defends our address
+    if(session->gpsdata.dev.protocol_version)
+        (void)n2k_node_input(session, pgn->pgn, session->driver.vyspi.prio,
+                             session->driver.vyspi.src,
+                             session->driver.vyspi.dest,
+                             bu, (size_t)len, timestamp());
 
     return(0);
 }
@@ -713,9 +476,9 @@ static gps_mask_t hnd_060928(unsigned char *bu, int len, struct PGN *pgn, struct
 static gps_mask_t hnd_126208(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                 "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   NMEA 2000 ISO - Commandd/Request/Ack\n");
     return(0);
 }
@@ -728,25 +491,25 @@ static gps_mask_t hnd_126464(unsigned char *bu, int len, struct PGN *pgn, struct
     int i = 0;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
-    if(session->context->debug >= LOG_IO) {
-        gpsd_report(session->context->debug, LOG_IO,
+    if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_IO, session->context->debug)) {
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                     "                   NMEA 2000 ISO - Transmit/Receive PGN List\n");
 
         if(bu[0] == 0) {
-            gpsd_report(session->context->debug, LOG_IO,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                         "                   NMEA 2000 ISO - Transmit\n");
         } else {
-            gpsd_report(session->context->debug, LOG_IO,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                         "                   NMEA 2000 ISO - Receive\n");
         }
 
         // staring at 0 as we need last 3 of 4 bytes read starting at 1
         for(i = 1; i < len; i+= 3) {
             uint32_t p = getleu24(bu, i);
-            gpsd_report(session->context->debug, LOG_IO,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                         "                   [%u] %u\n", i, p);
         }
     }
@@ -768,8 +531,16 @@ static gps_mask_t hnd_126996(unsigned char *bu, int len, struct PGN *pgn, struct
     char model_version[33];
     char model_serial_code[33];
 
-    uint8_t cert_level = bu[132];
-    uint8_t load_equivalency = bu[133];
+    uint8_t cert_level;
+    uint8_t load_equivalency;
+
+    if(len < 134)
+        return(0);
+    cert_level = bu[132];
+    load_equivalency = bu[133];
+    if(vyspi_bus(session) != NULL)
+        n2k_bus_product(vyspi_bus(session), session->driver.vyspi.src,
+                        bu, (size_t)len);
 
     memset(model_id, 0, 33);
     memset(software_version, 0, 33);
@@ -781,54 +552,50 @@ static gps_mask_t hnd_126996(unsigned char *bu, int len, struct PGN *pgn, struct
     memcpy(model_version, bu + 68, 32);
     memcpy(model_serial_code, bu + 100, 32);
 
-    gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   NMEA 2000 ISO - Product Information\n");
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   n2k version= %u, product code= %u\n",
                 n2k_version, prod_code);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   cert level= %u, load= %u\n",
                 cert_level, load_equivalency);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   model id          = %s\n", model_id);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   software version  = %s\n", software_version);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   model version     = %s\n", model_version);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   model serial code = %s\n", model_serial_code);
 
     return(0);
 }
 
 
-static gps_mask_t setles8value(unsigned char * bu, int pos, gps_mask_t set, gps_mask_t pset, double factor,
-                          double * dest_val, gps_mask_t * dest_set) {
-
-    gps_mask_t mask = 0;
-    int8_t val = (int8_t)bu[pos];
-
-    if(val != 0x7f) {
-        *dest_val = val*factor;
-        *dest_set |= pset;
-        mask = set;
-    }
-
-    return mask;
-}
+/*
+ *   PGNs described in n2kgen.py, decoded from their schema tables
+ */
+static gps_mask_t hnd_schema(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
+{
+    const struct n2k_pgn_t *schema = n2k_schema_find(pgn->pgn);
+    gps_mask_t mask;
+    char fields[256];
 
+    print_data(session->context, bu, len, pgn);
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
+		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
+    if (schema == NULL)
+        return 0;
 
-static gps_mask_t setleu8value(unsigned char * bu, int pos, gps_mask_t set, gps_mask_t pset, double factor,
-                         double * dest_val, gps_mask_t * dest_set) {
+    mask = n2k_decode(schema, bu, len, session);
 
-    gps_mask_t mask = 0;
-    uint8_t val = (uint8_t)bu[pos];
-    if(val != 0xff) {
-        *dest_val = val*factor;
-        *dest_set |= pset;
-        mask = set;
+    if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_IO, session->context->debug)) {
+        (void)n2k_describe(schema, bu, len, fields, sizeof(fields));
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
+                    "                   %s\n", fields);
     }
     return mask;
 }
@@ -885,148 +652,13 @@ static gps_mask_t setles32value(unsigned char * bu, int pos, gps_mask_t set, gps
     return mask;
 }
 
-/*
- *   PGN 127488: Engine Parameter Rapid Update
- */
-static gps_mask_t hnd_127488(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /* [17]
-    1   0   uint8  Engine instance
-    2 1-2   uint16 RPM (x .25 RPM)
-    3 3-4   uint16 Boost Pressure (100Pa)
-    4   6   sint8  Engine Tilt/Trim (+/- 1%)
-    5 6-7   uint16 Reserved Bits
-   */
-
-    gps_mask_t pset = 0;
-    gps_mask_t mask = 0;
-    uint8_t instance  = bu[0];
-
-    if(instance == 0)
-        pset = ENG_PORT_PSET;
-    else if(instance == 1)
-        pset = ENG_STARBOARD_PSET;
-    else {
-        gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d): unkown engine instance %d\n",
-                    pgn->pgn, session->driver.nmea2000.unit, instance);
-        return 0;
-    }
-
-    mask |= setleu16value(bu, 1, ENGINE_SET, pset | ENG_SPEED_PSET, 0.25,
-                  &session->gpsdata.engine.instance[instance].speed, &session->gpsdata.engine.set);
-
-    mask |= setleu16value(bu, 3, ENGINE_SET, pset | ENG_BOOST_PRESSURE_PSET, 100.0,
-                  &session->gpsdata.engine.instance[instance].boost_pressure, &session->gpsdata.engine.set);
-
-    mask |= setleu8value(bu, 6, ENGINE_SET, pset | ENG_TILT_PSET, 1,
-                  &session->gpsdata.engine.instance[instance].tilt, &session->gpsdata.engine.set);
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d):\n",
-                pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO, "instance= %s, speed= %0.2f rpm, boost pres= %0.2f, tilt= %0.2f\n",
-                instance?"starboard":"single/port",
-                session->gpsdata.engine.instance[instance].speed,
-                session->gpsdata.engine.instance[instance].boost_pressure,
-                session->gpsdata.engine.instance[instance].tilt);
-
-    if(mask > 0)
-        return ONLINE_SET | mask;
-
-    return 0;
-}
-
-/*
- *   PGN 127489: Engine Parameter Dynamic
- */
-static gps_mask_t hnd_127489(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /* [17]
-    1      0           uint8    Engine Instance  (port, starboard, forward, etc.)
-    2   1- 2           uint16   Engine Oil Pressure (100Pa)
-    3   3- 4           uint16   Engine Oil Temperature (0.1K)
-    4   5- 6           uint16   Engine Temperature (0.01K)
-    5   7- 8           sint16   Alternator potential (0.01V)
-    6   9-10           sint16   Fuel rate (cm³ / hour)
-    7  11-14           uint32   Total engine hours (1sec)
-    8  15-16           uint16   Engine coolant pressure (100Pa)
-    9  17-18           uint16   Fuel Pressure (1000Pa)
-    10    19           uint8    Not Available
-    11    20 bits 0-7  bits     Engine Discrete Status 1
-    12    21 bits 0-7  bits     Engine Discrete Status 2
-    13    22           sint8    Percent Engine Load (1%)
-    14    23           sint8    Percent Engine Torque (1%)
-   */
-
-    gps_mask_t pset = 0;
-    gps_mask_t mask = 0;
-    uint8_t instance  = bu[0];
-
-    if(instance == 0)
-        pset = ENG_PORT_PSET;
-    else if(instance == 1)
-        pset = ENG_STARBOARD_PSET;
-    else
-        return 0;
-
-    mask |= setleu16value(bu, 1, ENGINE_SET, pset | ENG_OIL_PRESSURE_PSET, 100.0,
-                  &session->gpsdata.engine.instance[instance].oil_pressure, &session->gpsdata.engine.set);
-    mask |= setleu16value(bu, 3, ENGINE_SET, pset | ENG_OIL_TEMPERATURE_PSET, 0.1,
-                  &session->gpsdata.engine.instance[instance].oil_temperature, &session->gpsdata.engine.set);
-    mask |= setleu16value(bu, 5, ENGINE_SET, pset | ENG_TEMPERATURE_PSET, 0.01,
-                  &session->gpsdata.engine.instance[instance].temperature, &session->gpsdata.engine.set);
-    mask |= setleu16value(bu, 7, ENGINE_SET, pset | ENG_ALTERNATOR_VOLTAGE_PSET, 0.01,
-                  &session->gpsdata.engine.instance[instance].alternator_voltage, &session->gpsdata.engine.set);
-
-    mask |= setleu16value(bu, 9, ENGINE_SET, pset | ENG_FUEL_RATE_PSET, 1000,
-                  &session->gpsdata.engine.instance[instance].fuel_rate, &session->gpsdata.engine.set);
-    mask |= setleu32value(bu, 11, ENGINE_SET, pset | ENG_TOTAL_HOURS_PSET, 1.0,
-                  &session->gpsdata.engine.instance[instance].total_hours, &session->gpsdata.engine.set);
-    mask |= setleu16value(bu, 15, ENGINE_SET, pset | ENG_COOLANT_PRESSURE_PSET, 1000.0,
-                  &session->gpsdata.engine.instance[instance].coolant_pressure, &session->gpsdata.engine.set);
-    mask |= setleu16value(bu, 17, ENGINE_SET, pset | ENG_FUEL_PRESSURE_PSET, 0.01,
-                  &session->gpsdata.engine.instance[instance].fuel_pressure, &session->gpsdata.engine.set);
-
-    // TODO - descrete statuses
-
-    mask |= setles8value(bu, 22, ENGINE_SET, pset | ENG_TORQUE_PSET, 0.01,
-                 &session->gpsdata.engine.instance[instance].torque, &session->gpsdata.engine.set);
-    mask |= setles8value(bu, 23, ENGINE_SET, pset | ENG_LOAD_PSET, 0.01,
-                 &session->gpsdata.engine.instance[instance].load, &session->gpsdata.engine.set);
-
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO, "instance= %s, oil pres= %0.2f, oil temp= %0.2f, temp= %0.2f (%04x)\n",
-                instance?"starboard":"single/port",
-                session->gpsdata.engine.instance[instance].oil_pressure,
-                session->gpsdata.engine.instance[instance].oil_temperature - 273.15,
-                session->gpsdata.engine.instance[instance].temperature - 273.15,
-                getleu16(bu, 5));
-    gpsd_report(session->context->debug, LOG_IO, "volt= %0.2fV, fule rate= %0.2fL/h, run time= %0.2fsecs, coolant pres= %0.2f\n",
-                session->gpsdata.engine.instance[instance].alternator_voltage,
-                session->gpsdata.engine.instance[instance].fuel_rate,
-                session->gpsdata.engine.instance[instance].total_hours,
-                session->gpsdata.engine.instance[instance].coolant_pressure);
-    gpsd_report(session->context->debug, LOG_IO, "fuel press= %0.2fpa, torque= %0.2f%%, load= %0.2f%%\n",
-                session->gpsdata.engine.instance[instance].fuel_pressure,
-                session->gpsdata.engine.instance[instance].torque,
-                session->gpsdata.engine.instance[instance].load);
-
-
-    if(mask > 0)
-        return ONLINE_SET | mask;
-    return 0;
-}
-
 /*
  *   PGN 127493: Transmission Parameters, Dynamic
  */
 static gps_mask_t hnd_127493(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
 
@@ -1044,119 +676,10 @@ static gps_mask_t hnd_127505(unsigned char *bu, int len, struct PGN *pgn, struct
     */
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    return(0);
-}
-
-/*
- *   PGN 127257: Attitude
- */
-static gps_mask_t hnd_127257(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /* [8] The SSC200 uses this PGN to indicate the vessel’s attitude (pitch and roll). The Yaw (field 2) is not used, therefore this field always contains 0x7FFF (data not available).
-
-           1:  SID – The sequence identifier field is used to tie related PGNs together. For example, the SSC200 will transmit identical SIDs for Vessel Heading (PGN 127250), Attitude (127257), and Rate of Turn (127251) to indicate that the readings are linked together (i.e., the data from each PGN was taken at the same time although they are reported at slightly different times).
-
-           2:  Yaw – This field always contains a value of 0x7FFF (data not available).
-
-           3:  Pitch – This field is used to report the vessel’s pitch.
-
-           4:  Roll – This field is used to report the vessel’s roll.
-
-           5:  Reserved – This field is reserved by NMEA; therefore, the SSC200 sets all bits to a logic 1.
-  */
-    gps_mask_t mask = 0;
-    uint8_t sid    = bu[0];
-
-    // testing with a67
-    int16_t yaw   = getles16(bu, 1);
-    int16_t pitch = getles16(bu, 3);
-    int16_t roll  = getles16(bu, 5);
-
-    if(yaw == 0x7fff) {
-      session->gpsdata.attitude.yaw = NAN;
-    } else
-      session->gpsdata.attitude.yaw = yaw * 0.0001 * RAD_2_DEG;
-
-    if(roll == 0x7fff) {
-      session->gpsdata.attitude.roll = NAN;
-    } else
-      session->gpsdata.attitude.roll = roll * 0.0001 * RAD_2_DEG;
-
-    if(pitch == 0x7fff) {
-      session->gpsdata.attitude.pitch = NAN;
-    } else
-      session->gpsdata.attitude.pitch = pitch * 0.0001 * RAD_2_DEG;
-
-    mask |= (ONLINE_SET | ATTITUDE_SET);
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-                "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-                "                   SID= %u, yaw=%f, roll=%f, pitch= %f\n",
-                sid,
-                (session->gpsdata.attitude.yaw==NAN?0:session->gpsdata.attitude.yaw),
-                (session->gpsdata.attitude.yaw==NAN?0:session->gpsdata.attitude.roll),
-                (session->gpsdata.attitude.yaw==NAN?0:session->gpsdata.attitude.pitch));
-
-    return mask;
-}
-
-/*
- *   PGN 127258: GNSS Magnetic Variation
- */
-static gps_mask_t hnd_127258(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-    /*
-    1 Sequence ID
-    2 Variation Source
-    3 Reserved Bits
-    4 Age of Service (Date)
-    5 Variation
-    6 Reserved Bits
-    */
-
-    uint8_t sid;
-    uint8_t src;
-    uint8_t reserved1;
-    int16_t age;
-    double  var;
-    uint16_t reserved2;
-
-    sid             = bu[0];
-
-    src             = (bu[1] >> 0) & 0x0f;          // TODO, 5 == WMM2005 ([7]), == manual ([3])
-
-    reserved1       = (bu[1] >> 4) & 0x0f;          // 4 bits ([7]), always 0xf
-
-    // TODO: 0x7fff for N/A ([8])
-    age             = getleu16(bu, 2); // this is age in days from Jan 1, 1970
-
-    var             = getles16(bu, 4) * RAD_2_DEG * 0.0001;
-    reserved2       = getleu16(bu, 6);
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   SID= %u, Variation Source= %u, Reserved Bits= %u\n",
-		sid,
-		src,
-		reserved1);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   Age of Service (Date)= %u, Variation= %f, Reserved Bits= 0x%04x\n",
-		age,
-		var,
-		reserved2);
-
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
 
-
 /**
  *   \PGN 129025: GNSS Position Rapid Update
  */
@@ -1170,7 +693,7 @@ static gps_mask_t hnd_129025(unsigned char *bu, int len, struct PGN *pgn, struct
     lon = getles32(bu, 4);
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if((lat != 0x7fffffff) && (lon != 0x7fffffff)) {
@@ -1183,7 +706,7 @@ static gps_mask_t hnd_129025(unsigned char *bu, int len, struct PGN *pgn, struct
 
     (void)strlcpy(session->gpsdata.tag, "129025", sizeof(session->gpsdata.tag));
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   lat = %f, lon = %f\n",
 		(lat != 0x7fffffff)?session->newdata.latitude:NAN,
 		(lon != 0x7fffffff)?session->newdata.longitude:NAN);
@@ -1207,7 +730,7 @@ static gps_mask_t hnd_129026(unsigned char *bu, int len, struct PGN *pgn, struct
     gps_mask_t mask = 0;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     session->driver.nmea2000.sid[0]  =  bu[0];
@@ -1243,7 +766,7 @@ static gps_mask_t hnd_129026(unsigned char *bu, int len, struct PGN *pgn, struct
 
     (void)strlcpy(session->gpsdata.tag, "129026", sizeof(session->gpsdata.tag));
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   SID= %u, cog ref= %s, track= %.2f deg, speed= %.2f m/s; %.2f knots\n",
 		session->driver.nmea2000.sid[0],
 		(COG_Reference == 0) ? "True" : "Magnetic",
@@ -1269,7 +792,7 @@ static gps_mask_t hnd_129029(unsigned char *bu, int len, struct PGN *pgn, struct
 
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     mask                             = 0;
@@ -1355,7 +878,7 @@ static gps_mask_t hnd_129029(unsigned char *bu, int len, struct PGN *pgn, struct
 
     char times[JSON_DATE_MAX + 1];
     unix_to_iso8601(session->newdata.time, times, sizeof(times));
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   SID = %u, time = %s, lat = %f, lon = %f, alt = %f\n",
 		session->driver.nmea2000.sid[3],
 		times,
@@ -1363,7 +886,7 @@ static gps_mask_t hnd_129029(unsigned char *bu, int len, struct PGN *pgn, struct
 		session->newdata.longitude,
 		session->newdata.altitude + session->gpsdata.separation);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   status = %d, sep = %f, sats = %d, hdop = %f, pdop = %f, mode=%u\n",
 		session->gpsdata.status,
 		session->gpsdata.separation,
@@ -1387,7 +910,7 @@ static gps_mask_t hnd_126992(unsigned char *bu, int len, struct PGN *pgn, struct
     //    uint8_t        reserved; // [7] 4 bits
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     sid        = bu[0];
@@ -1401,7 +924,7 @@ static gps_mask_t hnd_126992(unsigned char *bu, int len, struct PGN *pgn, struct
     char tbuf[JSON_DATE_MAX + 1];
     unix_to_iso8601(session->newdata.time, tbuf, sizeof(tbuf));
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   SID = %u, source = %u, time = %s\n",
 		sid,
 		source,
@@ -1438,7 +961,7 @@ static gps_mask_t hnd_129539(unsigned char *bu, int len, struct PGN *pgn, struct
     int16_t hdop, vdop, tdop;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     mask                             = 0;
@@ -1475,9 +998,9 @@ static gps_mask_t hnd_129539(unsigned char *bu, int len, struct PGN *pgn, struct
     }
     /*@+type@*/
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   SID:%02x hdop:%5.2f vdop:%5.2f tdop:%5.2f mode:%u\n",
 		session->driver.nmea2000.sid[1],
 		session->gpsdata.dop.hdop,
@@ -1538,7 +1061,7 @@ static gps_mask_t hnd_129540(unsigned char *bu, int len, struct PGN *pgn, struct
     int         l1, l2;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     session->driver.nmea2000.sid[2]           = bu[0];
@@ -1548,7 +1071,7 @@ static gps_mask_t hnd_129540(unsigned char *bu, int len, struct PGN *pgn, struct
         session->gpsdata.used[l2] = 0;
     }
 
-   gpsd_report(session->context->debug, LOG_DATA,
+   GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d): satellites visible: %d\n",
                pgn->pgn, session->driver.nmea2000.unit,
                session->gpsdata.satellites_visible);
@@ -1613,7 +1136,7 @@ static gps_mask_t hnd_129541(unsigned char *bu, int len, struct PGN *pgn, struct
     */
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return 0;
 }
@@ -1636,12 +1159,12 @@ static gps_mask_t hnd_129033(unsigned char *bu, int len, struct PGN *pgn, struct
     ts = date * 24*60*60 + time/1e4;
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     char times[JSON_DATE_MAX + 1];
     unix_to_iso8601(ts, times, sizeof(times));
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   date = %u, time = %u, ts= %s, offset = %u\n",
 		date,
 		time,
@@ -1664,7 +1187,7 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"vy pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -1678,7 +1201,7 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type1.lon = (int)(lon * 0.06);
         } else {
             ais->type1.lon = AIS_LON_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LON \n");
         }
 
@@ -1686,7 +1209,7 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type1.lat = (int)(lat * 0.06);
         } else {
             ais->type1.lat = AIS_LAT_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LAT \n");
         }
 
@@ -1703,7 +1226,7 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, struct PGN *pgn, struct
     }
     else {
         ais->type1.speed     = AIS_SPEED_NOT_AVAILABLE;
-        gpsd_report(session->context->debug, LOG_DATA,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                     "NOT AVAILABLE: SPEED \n");
     }
 
@@ -1716,15 +1239,15 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, struct PGN *pgn, struct
 	vy_decode_ais_channel_info(bu, len, 163, session);
 
     if(ais->type1.heading == AIS_HEADING_NOT_AVAILABLE) {
-        gpsd_report(session->context->debug, LOG_DATA,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                     "NOT AVAILABLE: HEADING \n");
     }
     if(ais->type1.course == AIS_COURSE_NOT_AVAILABLE) {
-        gpsd_report(session->context->debug, LOG_DATA,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                     "NOT AVAILABLE: COURSE \n");
     }
     if(ais->type1.turn == AIS_TURN_NOT_AVAILABLE) {
-        gpsd_report(session->context->debug, LOG_DATA,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                     "NOT AVAILABLE: TURN \n");
     }
 
@@ -1732,7 +1255,7 @@ static gps_mask_t hnd_129038(unsigned char *bu, int len, struct PGN *pgn, struct
     if (session->driver.aivdm.ais_channel == 'B') {
         channel = 'B';
     }
-	gpsd_report(session->context->debug, LOG_IO,
+	GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                 CLASS %c: lon = %f, lat = %f, course = %u, speed = %u, hdg= %u, turn=%d\n",
                 channel,
                 ais->type1.lon / AIS_LATLON_DIV,
@@ -1760,7 +1283,7 @@ static gps_mask_t hnd_129039(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -1772,7 +1295,7 @@ static gps_mask_t hnd_129039(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type18.lon = (int)(lon * 0.06);
         } else {
             ais->type18.lon = AIS_GNS_LON_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LON \n");
         }
 
@@ -1780,7 +1303,7 @@ static gps_mask_t hnd_129039(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type18.lat = (int)(lat * 0.06);
         } else {
             ais->type18.lat = AIS_GNS_LAT_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LAT \n");
         }
 
@@ -1795,7 +1318,7 @@ static gps_mask_t hnd_129039(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type18.speed    = (unsigned int) (speed * MPS_TO_KNOTS * 0.01 / 0.1);
         } else {
             ais->type18.speed    = AIS_SPEED_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: SPEED\n");
         }
         ais->type18.radio    = (unsigned int) (getleu32(bu, 18) & 0x7ffff);
@@ -1815,7 +1338,7 @@ static gps_mask_t hnd_129039(unsigned char *bu, int len, struct PGN *pgn, struct
         if (session->driver.aivdm.ais_channel == 'B') {
             channel = 'B';
         }
-        gpsd_report(session->context->debug, LOG_IO,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                     "                  CLASS %c: lon = %f, lat = %f, course = %d, speed = %u, ch = %c\n",
                     channel,
                     ais->type18.lon / AIS_LATLON_DIV,
@@ -1842,7 +1365,7 @@ static gps_mask_t hnd_129040(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -1856,7 +1379,7 @@ static gps_mask_t hnd_129040(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type19.lon = (int)(lon * 0.06);
         } else {
             ais->type19.lon = AIS_GNS_LON_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LON \n");
         }
 
@@ -1864,7 +1387,7 @@ static gps_mask_t hnd_129040(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type19.lat = (int)(lat * 0.06);
         } else {
             ais->type19.lat = AIS_GNS_LAT_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LAT \n");
         }
 
@@ -1878,7 +1401,7 @@ static gps_mask_t hnd_129040(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type19.speed    = (unsigned int) (speed * MPS_TO_KNOTS * 0.01 / 0.1);
         } else {
             ais->type19.speed    = AIS_SPEED_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: SPEED\n");
         }
         ais->type19.reserved     = (unsigned int) ((bu[18] >> 0) & 0xff);
@@ -1926,7 +1449,7 @@ static gps_mask_t hnd_129793(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -1943,7 +1466,7 @@ static gps_mask_t hnd_129794(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -2044,7 +1567,7 @@ static gps_mask_t hnd_129798(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -2058,7 +1581,7 @@ static gps_mask_t hnd_129798(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type9.lon = (int)(lon * 0.06);
         } else {
             ais->type9.lon = AIS_LON_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LON \n");
         }
 
@@ -2066,7 +1589,7 @@ static gps_mask_t hnd_129798(unsigned char *bu, int len, struct PGN *pgn, struct
             ais->type9.lat = (int)(lat * 0.06);
         } else {
             ais->type9.lat = AIS_LAT_NOT_AVAILABLE;
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: LAT \n");
         }
 
@@ -2078,7 +1601,7 @@ static gps_mask_t hnd_129798(unsigned char *bu, int len, struct PGN *pgn, struct
         if(speed != 0xffff) {
             ais->type9.speed     = (unsigned int) (speed * MPS_TO_KNOTS * 0.01 / 0.1);
         } else {
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "NOT AVAILABLE: SPEED\n");
             ais->type9.speed     = AIS_SAR_SPEED_NOT_AVAILABLE;
         }
@@ -2113,7 +1636,7 @@ static gps_mask_t hnd_129802(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0x3fffffff) != 0) {
@@ -2141,7 +1664,7 @@ static gps_mask_t hnd_129809(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                 "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -2162,7 +1685,7 @@ static gps_mask_t hnd_129809(unsigned char *bu, int len, struct PGN *pgn, struct
         index %= MAX_TYPE24_INTERLEAVE;
         session->driver.aivdm.context[0].type24_queue.index = index;
 
-        gpsd_report(session->context->debug, LOG_PROG,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_PROG, session->context->debug,
                     "NMEA2000: AIS message 24A from %09u stashed: %s.\n",
                     ais->mmsi, saveptr->shipname);
 
@@ -2185,7 +1708,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, struct PGN *pgn, struct
 
     ais =  &session->gpsdata.ais;
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if (vy_decode_ais_header(session, bu, len, ais, 0xffffffffU) != 0) {
@@ -2224,7 +1747,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, struct PGN *pgn, struct
                 beam         = 0;
                 to_starboard = 0;
             }
-            gpsd_report(session->context->debug, LOG_DATA,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                         "mmsi: %09u length: %u, beam: %u\n",
                         ais->mmsi, length, beam);
         }
@@ -2236,15 +1759,15 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, struct PGN *pgn, struct
                 }
                 ais->type24.shipname[AIS_SHIPNAME_MAXLEN] = (char) 0;
 
-                gpsd_report(session->context->debug, LOG_PROG,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_PROG, session->context->debug,
                             "NMEA2000: AIS 24B from %09u matches a 24A.\n",
                             ais->mmsi);
                 /* prevent false match if a 24B is repeated */
                 session->driver.aivdm.context[0].type24_queue.ships[i].mmsi = 0;
 
-                gpsd_report(session->context->debug, LOG_DATA,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                             "AIS: MMSI:  %09u\n", ais->mmsi);
-                gpsd_report(session->context->debug, LOG_DATA,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                             "AIS: name:  %-20.20s v:%-8.8s c:%-8.8s b:%6u s:%6u p:%6u s:%6u\n",
                             ais->type24.shipname,
                             ais->type24.vendorid,
@@ -2260,10 +1783,10 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, struct PGN *pgn, struct
             }
         }
 
-        gpsd_report(session->context->debug, LOG_DATA,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                     "AIS: MMSI  :  %09u\n", ais->mmsi);
 
-        gpsd_report(session->context->debug, LOG_DATA,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                     "AIS: vendor:  %-8.8s c:%-8.8s b:%6u s:%6u p:%6u s:%6u\n",
                     ais->type24.vendorid,
                     ais->type24.callsign,
@@ -2286,7 +1809,7 @@ static gps_mask_t hnd_129810(unsigned char *bu, int len, struct PGN *pgn, struct
 static gps_mask_t hnd_130842(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if(len == 0x1d)
@@ -2303,7 +1826,7 @@ static gps_mask_t hnd_130842(unsigned char *bu, int len, struct PGN *pgn, struct
 static gps_mask_t hnd_127506(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -2323,7 +1846,7 @@ static gps_mask_t hnd_127508(unsigned char *bu, int len, struct PGN *pgn, struct
     */
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
 
@@ -2333,172 +1856,12 @@ static gps_mask_t hnd_127508(unsigned char *bu, int len, struct PGN *pgn, struct
 static gps_mask_t hnd_127513(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
 
 
-/**
- *   \PGN 127245: NAV Rudder
- */
-static gps_mask_t hnd_127245(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /*
-   [2], [5]
-   1 Rudder Instance, generated by rudder instance switch, can have values 0 .. 15
-   2 Direction Order, 0 if no order provided
-   3 Reserved Bits,   1s
-   4 Angle Order,     0x7fff is n/a
-   5 Position,        signed rudder angle in units of 0.0001 radians
-   6 Reserved Bits
-   PGN 127245 - Rudder, may be used to report rudder position or it may be used to set a rudder demand. [6]
-   Only Position is mapped to RSA [4]
-   */
-    uint8_t rudder_inst;
-    uint8_t dir_order;
-    uint8_t reserved1;
-    uint8_t angle_order;
-    double  position;
-    uint8_t reserved2;
-
-    // TODO: these are only wild guesses since we know byte pos of "position"
-    rudder_inst  = bu[0] & 0x0f;       // TODO: which bits lower/higher 0 .. 15
-    dir_order    = bu[1] & 0xff;       // TODO: guess would be 1 bit?
-    reserved1    = bu[1];
-    angle_order  = getles16(bu, 2);    // TODO N/A
-
-    // corresponds to RSA port rudder sensor
-    position     = getles16(bu, 4) * 0.0001 * RAD_2_DEG;
-
-    reserved2    = getub(bu, 6);
-
-    session->gpsdata.navigation.rudder_angle = position;
-    session->gpsdata.navigation.set          = NAV_RUDDER_ANGLE_PSET;
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   Rudder Instance= %u, Direction Order= %u, Reserved Bits= %u\n",
-		rudder_inst,
-		dir_order,
-		reserved1);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   Angle Order = %u, Position = %f, Reserved Bits= %u\n",
-		angle_order,
-		position,
-		reserved2);
-
-    return NAVIGATION_SET;
-}
-
-
-/**
- *   \PGN 127250: NAV Vessel Heading
- */
-static gps_mask_t hnd_127250(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /*
-    1 SID
-    2 Heading Sensor Reading
-    3 Deviation
-    4 Variation
-    5 Heading Sensor Reference
-    6 Reserved Bits
-    */
-
-    uint8_t sid;
-    uint16_t hdg;
-    int16_t dev;
-    int16_t var;
-    double heading = 0.0;
-    uint8_t ref = 0; // Heading Sensor Reference (M&T?)
-    const size_t buflen = 255;
-    // [3] says ref = 1 for magnetic north (how many bits?)
-
-    print_data(session->context, bu, len, pgn);
-
-    sid = getub(bu, 0);
-
-    /*@-type@*/
-    hdg = getleu16(bu, 1);
-    if (hdg != 0xffff) {
-        heading = hdg * RAD_2_DEG * 0.0001;
-    }
-
-    dev = getles16(bu, 3);
-    if (dev != 0x7fff) {
-        session->gpsdata.environment.set       |= ENV_DEVIATION_PSET;
-        session->gpsdata.environment.deviation = dev * RAD_2_DEG * 0.0001;
-    }
-
-    var = getles16(bu, 5);
-    if (var != 0x7fff) {
-        session->gpsdata.environment.set       |= ENV_VARIATION_PSET;
-        session->gpsdata.environment.variation = var * RAD_2_DEG * 0.0001;
-    }
-
-    // observed b0000 0001, 1 = magnetic (see also [3]), 0 = true
-    ref = getub(bu, 7) & 0x01; // ??? len, only a couple of bits
-
-    /*@+type@*/
-    if (hdg != 0xffff) {
-        if(ref == 1) {
-            session->gpsdata.navigation.set = NAV_HDG_MAGN_PSET;
-            session->gpsdata.navigation.heading[compass_magnetic] = heading;
-        } else {
-            session->gpsdata.navigation.set = NAV_HDG_TRUE_PSET;
-            session->gpsdata.navigation.heading[compass_true] = heading;
-        }
-    } else {
-        session->gpsdata.navigation.set = 0;
-        session->gpsdata.navigation.heading[compass_magnetic] = NAN;
-        session->gpsdata.navigation.heading[compass_true] = NAN;
-    }
-
-    HDGboat = session->gpsdata.navigation.heading[compass_magnetic];
-
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    char bufp[buflen];
-    memset(bufp, 0, buflen);
-
-    if (hdg == 0xffff) {
-      (void)sprintf(bufp, "Heading= %s, ", "-");
-      (void)sprintf(bufp + strlen(bufp), "Sensor= %s, ", "-");
-    } else {
-      (void)snprintf(bufp, buflen, "Heading= %.2f, ", heading);
-      (void)snprintf(bufp + strlen(bufp), buflen - strlen(bufp), "Sensor= %.2f, ",
-		     hdg  * RAD_2_DEG * 0.0001);
-    }
-    if (dev == 0x7fff) {
-      (void)sprintf(bufp + strlen(bufp), "Deviation= %s, ", "-");
-    } else {
-      (void)snprintf(bufp + strlen(bufp), buflen - strlen(bufp),
-		     "Deviation= %.2f, ",
-		     dev * RAD_2_DEG * 0.0001);
-    }
-    if (var == 0x7fff) {
-      (void)sprintf(bufp + strlen(bufp), "Variation= %s", "-");
-    } else {
-      (void)snprintf(bufp + strlen(bufp), buflen - strlen(bufp), "Variation= %.2f", var * RAD_2_DEG * 0.0001);
-    }
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   VY: SID = %d, %s, Heading Sensor Reference= %s (%u), Reserved = %u\n",
-		sid,
-		bufp,
-		ref == 1? "Magnetic":"True",
-		ref,
-		0);
-
-    return (ONLINE_SET | NAVIGATION_SET | ENVIRONMENT_SET);
-}
-
 /**
  * \todo PGN 128237: Heading/Track Control
  * is missing a mask and a storage structure for storing the results
@@ -2574,36 +1937,36 @@ static gps_mask_t hnd_127237(unsigned char *bu, int len, struct PGN *pgn, struct
     vessel_heading               = getleu16(bu, 19);
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   Rudder Limit Exceeded= %u, Off-Heading Limit Exceeded = %u, Off-Track Limit Exceeded= %u\n",
 		rudder_limit_exceeded,
 		off_heading_limit_exceeded,
 		off_track_limit_exceeded);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   Override= %u, Steering Mode= %u, Turn Mode= %u, Heading Reference= %u\n",
 		override,
 		steering_mode,
 		turn_mode,
 		heading_reference);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   Reserved Bits= %u, Commanded Rudder Direction= %u, Commanded Rudder Angle= %u\n",
 		reserved,
 		commanded_rudder_direction,
 		commanded_rudder_angle);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   Heading-To-Steer (Course)= %f, Track= %u, Rudder Limit= %u, Off-Heading Limit= %u\n",
 		heading_to_steer,
 		track,
 		rudder_limit,
 		off_heading_limit);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   Radius of Turn Order= %u, Rate of Turn Order= %u, Off-Track Limit= %u, Vessel Heading= %u\n",
 		radius_of_turn_order,
 		rate_of_turn_order,
@@ -2613,183 +1976,6 @@ static gps_mask_t hnd_127237(unsigned char *bu, int len, struct PGN *pgn, struct
     return(0);
 }
 
-/**
- *   \PGN 128251: Rate of Turn
- */
-static gps_mask_t hnd_127251(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-    uint8_t sid;
-    double rot;
-
-    sid = getub(bu, 0);
-
-    // TODO : find explain for odd magic number 3/16 deg/min (or 3/16/60 in deg/sec)
-    rot = getles32(bu, 1) * 0.00001 * 3.0/16.0/60.0 * RAD_2_DEG; // per sec, let compiler optimize
-
-    session->gpsdata.navigation.set              = NAV_ROT_PSET;
-    session->gpsdata.navigation.rate_of_turn     = rot;
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   sid = %d, rate = %f deg/s\n",
-		sid,
-		rot);
-
-    return NAVIGATION_SET;
-}
-
-
-/**
- *   \PGN 128259: NAV Speed
- */
-static gps_mask_t hnd_128259(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-    const double nm = 1852; // nm in meter
-    gps_mask_t mask = 0;
-
-    print_data(session->context, bu, len, pgn);
-
-    uint8_t sid = getub(bu, 0);
-    uint16_t speed_water = getleu16(bu, 1);   // 1 x 10-2 m/s
-    // [3] says not available means 0xffff, usually not used
-    uint16_t speed_ground = getleu16(bu, 3);
-
-    /*
-      http://askjackrabbit.typepad.com/ask_jack_rabbit/page/6/
-
-      The allowable reference values are:
-
-      1) Paddle Wheel
-      2) Pitot Tube
-      3) Doppler Log
-      4) Correlation Log (Ultra-Sound)
-      5) EM Log (Electro-Mechanical)
-    */
-
-    uint16_t type = getleu16(bu, 5);          // TODO: len in bytes? what does it mean?
-    //    uint8_t reserved = getub(bu, 7);          // TODO: all 1 for DST100UM
-
-    if(speed_water != 0xffff) {
-        session->gpsdata.navigation.set = NAV_STW_PSET;
-        session->gpsdata.navigation.speed_thru_water = speed_water * 0.01;
-        mask |= NAVIGATION_SET;
-    } else {
-        session->gpsdata.navigation.speed_thru_water = NAN;
-    }
-
-    if(speed_ground != 0xffff) {
-        session->gpsdata.navigation.set = NAV_SOG_PSET;
-        session->gpsdata.navigation.speed_over_ground = speed_ground * 0.01;
-        mask |= NAVIGATION_SET;
-    } else {
-        session->gpsdata.navigation.speed_over_ground = NAN;
-    }
-
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   sid = %d, speed= %f m/s, %f knots, %f km/h, speed ground= %u, type= %u\n",
-		sid,
-		speed_water * 0.01,
-		speed_water * 0.01 * 3600.0/nm,
-		speed_water * 0.01 * 3.6,
-		speed_ground,
-		type);
-
-    return mask;
-}
-
-
-/**
- *   \PGN 128267: NAV Water Depth
- */
-static gps_mask_t hnd_128267(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-    print_data(session->context, bu, len, pgn);
-
-    uint8_t sid = getub(bu, 0); // can be tied to 128259
-    uint32_t depth = getleu32(bu, 1);  // 1x10-2m
-    int16_t offset = getles16(bu, 5); // TODO: 0x7fff N/A, 1x10-3m
-    //    uint8_t res = getub(bu, 7); // reserved, len in bits?
-
-
-    if(depth == 0xffffffff) {
-      session->gpsdata.navigation.depth = NAN;
-    } else {
-      session->gpsdata.navigation.depth = depth *.01;
-      session->gpsdata.navigation.set = NAV_DPT_PSET;
-    }
-
-    if(offset == 0x7fff) {
-      session->gpsdata.navigation.depth_offset = NAN;
-    } else {
-      session->gpsdata.navigation.depth_offset = offset * 0.001;
-      session->gpsdata.navigation.set |= NAV_DPT_OFF_PSET;
-    }
-
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   SID = %d, depth = %f m, offset = %f m\n",
-		sid,
-	        session->gpsdata.navigation.depth,
-		session->gpsdata.navigation.depth_offset);
-
-    return (ONLINE_SET | NAVIGATION_SET);
-}
-
-
-/**
- *   \PGN 128275: NAV Distance Log
- */
-static gps_mask_t hnd_128275(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /*
-    [9]: date in Days since January 1, 1970, Date is relative to UTC Time.
-         time 24 hour clock, 0 = midnight, time is in UTC, range 0 to 86,401 s
-	 distance resolution 1m
-   */
-    uint16_t date = getleu16(bu, 0); // TODO: 0xffff == not used
-    uint32_t time = getleu32(bu, 4); // TODO: 0xffffffff == not used
-    uint32_t dist = getleu32(bu, 6); // total cumulative distance in meter
-    uint32_t rest = getleu32(bu, 10); // distance since last reset in meter
-
-    session->gpsdata.navigation.distance_total = dist * METERS_TO_NM;
-    session->gpsdata.navigation.set = NAV_DIST_TOT_PSET;
-
-    session->gpsdata.navigation.distance_trip  = rest * METERS_TO_NM;
-    session->gpsdata.navigation.set |= NAV_DIST_TRIP_PSET;
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    char d[255]; char t[255];
-    if(date != 0xffff)
-      sprintf(d, "%u", date);
-    else
-      sprintf(d, "-");
-    if(time != 0xffffffff)
-      sprintf(t, "%u", time);
-    else
-      sprintf(t, "-");
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   date = %s, time = %s, dist= %um, dist since reset = %um\n",
-		d,
-		t,
-		dist,
-		rest);
-
-    return NAVIGATION_SET;
-}
-
-
 /**
  * \PGN 129283: NAV Cross Track Error
  */
@@ -2823,16 +2009,16 @@ static gps_mask_t hnd_129283(unsigned char *bu, int len, struct PGN *pgn, struct
     reserved     = getleu16(bu, 7);
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   SID = %u, XTE Mode = %u, reserve = %d, \n",
 		sid,
 		mode,
 		reserve);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   Navigation Terminated= %d, XTE= %fm, res = %u\n",
 		terminated,
 		(session->gpsdata.waypoint.set & WPY_XTE_PSET)?session->gpsdata.waypoint.xte:NAN,
@@ -2954,31 +2140,31 @@ static gps_mask_t hnd_129284(unsigned char *bu, int len, struct PGN *pgn, struct
                   &session->gpsdata.waypoint.speed_to_destination, &session->gpsdata.waypoint.set);
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
-    if(session->context->debug >= LOG_IO) {
+    if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_IO, session->context->debug)) {
         if((eta_date < 0xffff) || (eta_time < 0xffffffff))
             unix_to_iso8601(session->gpsdata.waypoint.eta, etas, sizeof(etas));
 
 
-        gpsd_report(session->context->debug, LOG_IO,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
             "                   SID= %u, Perpendicular Crossed= %u, Arrival Circle Entered= %u, Calculation Type= %u\n",
             sid,
             perpendicular_crossed,
             arrival_circle_entered,
             calc_type);
 
-        gpsd_report(session->context->debug, LOG_IO,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
             "                   ETA= %s\n", etas);
 
-        gpsd_report(session->context->debug, LOG_IO,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
             "                   Bearing, Org To Dest Wpt= %f, Bearing, Pos To Dest Wpt= %f, Course/Bearing Ref.= %u\n",
             (session->gpsdata.waypoint.set & WPY_BEARING_FROM_ORG_TO_PSET)?session->gpsdata.waypoint.bearing_from_org_to_destination:NAN,
             (session->gpsdata.waypoint.set & WPY_BEARING_FROM_POS_TO_PSET)?session->gpsdata.waypoint.bearing_from_pos_to_destination:NAN,
             (course_bearing_ref != 3)?course_bearing_ref:3);
 
-        gpsd_report(session->context->debug, LOG_IO,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
             "                   Org Wpt #= %u, Dest Wpt #= %u, Dest Wpt Lat= %f, Dest Wpt Lon= %f, Dist to Dest Wpt= %fm, Wpt Closing Velocity= %fm/s\n",
             org_wpt_number,
             dest_wpt_number,
@@ -3014,7 +2200,7 @@ static gps_mask_t hnd_129285(unsigned char *bu, int len, struct PGN *pgn, struct
     14 Fields 10 thru 13 repeat as needed
     */
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
@@ -3039,220 +2225,11 @@ static gps_mask_t hnd_129291(unsigned char *bu, int len, struct PGN *pgn, struct
     6 Reserved Bits
     */
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
     return(0);
 }
 
-/**
- *   \PGN 130306: NAV Wind Data
- *   http://askjackrabbit.typepad.com/ask_jack_rabbit/page/7/
- */
-static gps_mask_t hnd_130306(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /*
-    1 Sequence ID
-    2 Wind Speed
-    3 Wind Direction
-    4 Wind Reference
-    5 Reserv
-
-    0) Theoretical Wind (ground referenced, referenced to True North; calculated using COG/SOG)
-    1) Theoretical Wind (ground referenced, referenced to Magnetic North; calculated using COG/SOG)
-    2) Apparent Wind (relative to the vessel centerline)
-    3) Theoretical (Calculated to Centerline of the vessel, referenced to ground; calculated using COG/SOG)
-    4) Theoretical (Calculated to Centerline of the vessel, referenced to water; calculated using Heading/Speed through Water)
-
-    According to
-
-    http://www.maretron.com/support/manuals/USB100UM_1.6.pdf
-
-
-    0 - 1 are translated to MWD and 2 - 4 to MWV:
-
-    MWD,dir,T,dir,M,speed,N,speed,M
-    MWV,dir,ref,speed,M,A
-
-    Speed is in knots.
-
-  */
-
-    static char * wind_ref[] = {
-      "True North",
-      "Magnetic North",
-      "Apparent",
-      "True to Boat",
-      "True to Water"
-    };
-
-    static gps_mask_t angles[] = {
-        ENV_WIND_TRUE_NORTH_ANGLE_PSET,
-        ENV_WIND_MAGN_ANGLE_PSET,
-        ENV_WIND_APPARENT_ANGLE_PSET,
-        ENV_WIND_TRUE_TO_BOAT_ANGLE_PSET,
-        ENV_WIND_TRUE_TO_WATER_ANGLE_PSET
-    };
-
-    static gps_mask_t speeds[] = {
-        ENV_WIND_TRUE_NORTH_SPEED_PSET,
-        ENV_WIND_MAGN_ANGLE_PSET,
-        ENV_WIND_APPARENT_SPEED_PSET,
-        ENV_WIND_TRUE_TO_BOAT_SPEED_PSET,
-        ENV_WIND_TRUE_TO_WATER_SPEED_PSET
-    };
-
-    gps_mask_t pset = 0, mask = 0, pset_s = 0, pset_a = 0;
-    double * speed = NULL;
-    double * angle = NULL;
-
-    uint8_t sid;
-    uint8_t ref = 0xff;
-    uint8_t res;
-
-    sid          = getub(bu, 0);
-    ref          = getub(bu, 5) & 0x07;         // see res 24 - 21 bits
-    res          = getub(bu, 6);                // 21 bits ([19]), makes ref == 3 bits
-
-    if(ref > 0x04)
-        return 0;
-
-    // accidentally ref and enum wind_reference are identical
-    angle = &session->gpsdata.environment.wind[ref].angle;
-    speed = &session->gpsdata.environment.wind[ref].speed;
-    pset_s = speeds[ref];
-    pset_a = angles[ref];
-
-    mask |= setleu16value(bu, 1, ENVIRONMENT_SET, pset|pset_s, 0.01,
-                    speed, &session->gpsdata.environment.set);
-    mask |= setleu16value(bu, 3, ENVIRONMENT_SET, pset|pset_a, RAD_2_DEG * 0.0001,
-                    angle, &session->gpsdata.environment.set);
-
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-        "pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-        "                   SID = %u, wind speed = %f m/s, dir = %f, ref = %s (%02x), res = %u\n",
-        sid,
-        (!isnan(session->gpsdata.environment.wind[ref].speed))?session->gpsdata.environment.wind[ref].speed:NAN,
-        (!isnan(session->gpsdata.environment.wind[ref].angle))?session->gpsdata.environment.wind[ref].angle:NAN,
-        (ref < 5) ? wind_ref[ref] : "-", ref, res);
-
-    return ONLINE_SET | mask;
-}
-
-
-/**
- *   \PGN 130310: NAV Water Temp., Outside Air Temp., Atmospheric Pressure
- */
-static gps_mask_t hnd_130310(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /*
-    1 Sequence ID
-    2 Water Temp
-    3 Outside Ambient Air Temp.
-    4 Atmospheric Pressure
-    5 Reserved Bits
-  */
-
-    uint8_t sid;
-    uint16_t pres;
-    uint8_t res;
-
-    gps_mask_t mask = 0, pset = 0;
-
-    sid          = getub(bu, 0);
-    pres         = getleu16(bu, 5);
-    res          = getsb(bu, 7);
-
-    #define PSI_2_BAR 1.0/14.50377
-
-    // Kelvin
-    mask |= setleu16value(bu, 1, ENVIRONMENT_SET, pset|ENV_TEMP_WATER_PSET, 0.01,
-                    &session->gpsdata.environment.temp[temp_water], &session->gpsdata.environment.set);
-    mask |= setleu16value(bu, 3, ENVIRONMENT_SET, pset|ENV_TEMP_AIR_PSET, 0.01,
-                    &session->gpsdata.environment.temp[temp_air], &session->gpsdata.environment.set);
-
-
-
-    if(pres != 0xffff) {
-    }
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   SID = %u, water = %f C, outside = %f C, pressure = %f mbar, res = %u\n",
-		sid,
-		(!isnan(session->gpsdata.environment.temp[temp_water]))?session->gpsdata.environment.temp[temp_water] + KELVIN_2_CELSIUS:NAN,
-        (!isnan(session->gpsdata.environment.temp[temp_air]))?session->gpsdata.environment.temp[temp_air] + KELVIN_2_CELSIUS:NAN,
-		pres * PSI_2_BAR * 0.001,
-		res);
-
-    return mask;
-}
-
-
-/**
- *   \PGN 130311: NAV Environmental Parameters
- */
-static gps_mask_t hnd_130311(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
-{
-  /*[2], [10]
-    rework of 130310 and should be used for new designs
-    1 Sequence ID
-    2 Temperature Instance - 0x00 == sea, 0x01 == outside temperature
-    3 Humidity Instance    - WSO100: 0x01 == outside humidity.
-    4 Temperature          - outside air units of 0.01°K.
-    5 Humidity             – relative humidity in units of 0.004%
-    6 Atmospheric Pressure - units of 100Pa
-  */
-
-    gps_mask_t mask = 0, pset = 0;
-
-    uint8_t sid;
-    uint8_t temp_inst;
-    uint8_t hum_inst;
-    int16_t hum;
-    int16_t pres;
-
-    enum temp_reference_t tr;
-
-    sid = getub(bu, 0);
-    temp_inst     = getub(bu, 1) & (0x01 << 6);     // TODO: which temp instances
-    hum_inst      = getub(bu, 1) & (0x01 << 2);     // TODO: which hum instances
-    hum           = getleu16(bu, 4);  // TODO: s/u? 0x7fff for n/a?
-    pres          = getleu16(bu, 6);  // TODO: s/u? 0xffff for n/a?
-
-    if(temp_inst == 0x00) {
-        tr = temp_water;
-        mask |= setleu16value(bu, 2, ENVIRONMENT_SET, pset|ENV_TEMP_WATER_PSET, 0.01,
-                        &session->gpsdata.environment.temp[temp_water], &session->gpsdata.environment.set);
-    } else if(temp_inst == 0x01) {
-        tr = temp_air;
-        mask |= setleu16value(bu, 2, ENVIRONMENT_SET, pset|ENV_TEMP_AIR_PSET, 0.01,
-                        &session->gpsdata.environment.temp[temp_air], &session->gpsdata.environment.set);
-    } else
-        return 0;
-
-    print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
-		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
-
-    gpsd_report(session->context->debug, LOG_IO,
-		"                   SID= %u, temp inst= %d, hum inst= %d, temp = %f C, hum = %f%%, pres = %f\n",
-		sid,
-		temp_inst,
-		hum_inst,
-		(!isnan(session->gpsdata.environment.temp[temp_air]))?session->gpsdata.environment.temp[temp_air] + KELVIN_2_CELSIUS:NAN,
-		hum / 0.004,
-		pres * 0.0001);
-
-    return mask;
-}
-
 /**
  * \todo  PGN 130312: NAV Temperature
  *   deprecated in NMEA 3.0
@@ -3304,7 +2281,7 @@ static gps_mask_t hnd_130312(unsigned char *bu, int len, struct PGN *pgn, struct
     reserve       = getub(bu, 7);
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d):\n", pgn->pgn, session->driver.nmea2000.unit);
 
     if(0) {
@@ -3314,7 +2291,7 @@ static gps_mask_t hnd_130312(unsigned char *bu, int len, struct PGN *pgn, struct
         mask |= ENVIRONMENT_SET;
     }
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
 		"                   SID= %u, temp inst = %u, temp src = %s, temp = %f, temp set = %f, res = %u\n",
 		sid,
 		temp_inst,
@@ -3350,9 +2327,9 @@ static gps_mask_t hnd_130824(unsigned char *bu, int len UNUSED, struct PGN *pgn
     uint16_t ind = (code >> 0) & 0x07;  //  3 bit industry
     
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d): unkown\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
         "                   manu = %u, ind= %u\n",
         man, ind);
     
@@ -3392,9 +2369,9 @@ static gps_mask_t hnd_130845(unsigned char *bu, int len UNUSED, struct PGN *pgn
     uint16_t type_id = getleu16(bu, 6);
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d): unkown\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
         "                   manu = %u, ind= %u, msg= %u, rpt= %u, type= %u\n",
         man, ind, msg_id, repeat_id, type_id);
 
@@ -3435,9 +2412,9 @@ static gps_mask_t hnd_130850(unsigned char *bu, int len UNUSED, struct PGN *pgn
     */
 
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d): unkown\n", pgn->pgn, session->driver.nmea2000.unit);
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                 "                   manu = %u, ind= %u, prop= %u, dev= %u, ev= %u, dir= %u, deg= %.02f\n",
                 man, ind, prop_id, dev_id, event, dir_id, rad*RAD_2_DEG * 0.0001);
 
@@ -3451,7 +2428,7 @@ static gps_mask_t hnd_130850(unsigned char *bu, int len UNUSED, struct PGN *pgn
 static gps_mask_t hnd_unknown(unsigned char *bu, int len, struct PGN *pgn, struct gps_device_t *session)
 {
     print_data(session->context, bu, len, pgn);
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"pgn %6d(%3d): unkown\n", pgn->pgn, session->driver.nmea2000.unit);
 
     return 0;
@@ -3530,9 +2507,9 @@ static void vyspi_n_discard(struct gps_packet_t *lexer, uint8_t nchars)
   lexer->inbufptr = lexer->inbufptr - discard;
   lexer->inbuflen = remaining;
 
-  if (lexer->debug >= LOG_RAW+1) {
+  if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_RAW+1, lexer->debug)) {
     char scratchbuf[MAX_PACKET_LENGTH*2+1];
-    gpsd_report(lexer->debug, LOG_RAW+1,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW+1, lexer->debug,
 		"Packet type %d discarded %lu chars remaining %lu = %s\n",
 		lexer->type, discard, remaining,
 		gpsd_packetdump(scratchbuf,  sizeof(scratchbuf),
@@ -3568,7 +2545,7 @@ static void vyspi_packet_accept(struct gps_packet_t *lexer, int packet_type)
 
     if(packetlen != lexer->frm_length) {
         char scratchbuf[MAX_PACKET_LENGTH*2+1];
-        gpsd_report(lexer->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, lexer->debug,
                     "Fatal error with packet length %zu != frame length %u\n%s\n",
                     packetlen, lexer->frm_length,
                     gpsd_packetdump(scratchbuf,  sizeof(scratchbuf),
@@ -3590,6 +2567,7 @@ static void vyspi_packet_accept(struct gps_packet_t *lexer, int packet_type)
         lexer->out_offset[cnt] = newoffset;
         lexer->out_new_version[cnt] = lexer->frm_version;
         lexer->out_len[cnt] = packetlen;
+        lexer->out_port[cnt] = lexer->frm_port;
 
         lexer->out_type[cnt] = lexer->frm_type;
         if(lexer->frm_type == FRM_TYPE_NMEA0183)
@@ -3599,9 +2577,9 @@ static void vyspi_packet_accept(struct gps_packet_t *lexer, int packet_type)
         lexer->type = VYSPI_PACKET;
         lexer->out_count++;
 
-        if (lexer->debug >= LOG_DATA) {
+        if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_DATA, lexer->debug)) {
             char scratchbuf[MAX_PACKET_LENGTH*2+1];
-            gpsd_report(lexer->debug, LOG_DATA, // LOG_RAW+1,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, lexer->debug, // LOG_RAW+1,
                         "vy-packet no %u type %d with frame type %u accepted %zu = %s\n",
                         cnt, packet_type, lexer->out_type[cnt], packetlen,
                         gpsd_packetdump(scratchbuf,  sizeof(scratchbuf),
@@ -3611,7 +2589,7 @@ static void vyspi_packet_accept(struct gps_packet_t *lexer, int packet_type)
 
 
     } else {
-        gpsd_report(lexer->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, lexer->debug,
                     "Rejected too long packet type %d len %zu\n",
                     packet_type, packetlen);
     }
@@ -3630,12 +2608,12 @@ enum
 
 static int vyspi_packet_parse(struct gps_packet_t *lexer, unsigned char c) {
 
-    char *state_table[] = {
+    static const char *state_table[] = {
 #include "packet_names.h"
     };
 
     nextstate(lexer, c);
-    gpsd_report(lexer->debug, LOG_RAW + 2,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW + 2, lexer->debug,
                 "%08ld: character '%c' [%02x], new state: %s\n",
                 lexer->char_counter, (isprint(c) ? c : '.'), c,
                 state_table[lexer->state]);
@@ -3677,12 +2655,12 @@ static int vyspi_packet_parse(struct gps_packet_t *lexer, unsigned char c) {
             }
             if (!checksum_ok) {
                 char scratchbuf[MAX_PACKET_LENGTH*2+1];
-                gpsd_report(lexer->debug, LOG_WARN,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, lexer->debug,
                             "NMEA packet accepted = %s\n",
                             gpsd_packetdump(scratchbuf,  sizeof(scratchbuf),
                                             (char *)lexer->outbuffer,
                                             lexer->outbuflen));
-                gpsd_report(lexer->debug, LOG_WARN,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, lexer->debug,
                             "bad checksum in NMEA packet; expected %s.\n",
                             csum);
                 lexer->state = GROUND_STATE;
@@ -3720,7 +2698,7 @@ static void vyspi_preparse_serial(struct gps_device_t *session) {
     struct gps_packet_t *lexer = &session->packet;
     int packet_type = -2;
 
-    gpsd_report(session->context->debug, LOG_RAW + 1,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW + 1, session->context->debug,
                 "VYSPI: preparse serial called with input len = %lu and ptr at %lu\n",
                 lexer->inbuflen, lexer->inbufptr - lexer->inbuffer);
     // one extra for reading both, len and type/origin
@@ -3732,7 +2710,7 @@ static void vyspi_preparse_serial(struct gps_device_t *session) {
         uint8_t * bp = lexer->inbufptr; // need this for storing back
         uint8_t b = *lexer->inbufptr++;
         
-        gpsd_report(session->context->debug, LOG_RAW + 1,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW + 1, session->context->debug,
                     "VYSPI: preparse serial [%c] %02x @ %p state= %u\n",
                     (isprint(b) ? b : '.'), b, lexer->inbufptr, lexer->frm_state);
 
@@ -3843,7 +2821,7 @@ static void vyspi_preparse_serial(struct gps_device_t *session) {
                 lexer->type = VYSPI_PACKET;
                 packet_type = vyspi_packet_parse(lexer, b);
                 if(packet_type > -2) {
-                    gpsd_report(session->context->debug, LOG_RAW,
+                    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
                                 "VYSPI: preparse serial discovered a packet type = %d\n",
                                 packet_type);
 
@@ -3858,7 +2836,7 @@ static void vyspi_preparse_serial(struct gps_device_t *session) {
              */
             if((size_t)(lexer->inbufptr - lexer->inbuffer) >= lexer->frm_length) {
                 // frame is complete
-                gpsd_report(session->context->debug, LOG_RAW,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
                             "VYSPI: preparse serial discovered complete frame with len %u >= %lu\n",
                             lexer->frm_length, lexer->inbufptr - lexer->inbuffer);
                 if(lexer->frm_version) {
@@ -3895,7 +2873,7 @@ static void vyspi_preparse_serial(struct gps_device_t *session) {
 
         if(lexer->frm_state == FRM_END) {
 
-            gpsd_report(session->context->debug, LOG_RAW,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
                         "VYSPI: preparse serial complete frame type %s version %u with len %u, %lu\n",
                         type_names[lexer->frm_type],
                         lexer->frm_version,
@@ -3937,7 +2915,7 @@ static void vyspi_preparse_spi(struct gps_device_t *session) {
 
   size_t packetlen = vyspi_packetlen(lexer);
 
-  gpsd_report(session->context->debug, LOG_DATA,
+  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 	      "VYSPI: preparse called with packet len = %lu\n", packetlen);
 
   // one extra for reading both, len and type/origin
@@ -3950,14 +2928,14 @@ static void vyspi_preparse_spi(struct gps_device_t *session) {
     b = *lexer->inbufptr++;
     uint8_t pkgLen  =  b & 0xFF;
 
-    gpsd_report(session->context->debug, LOG_DATA, "VYSPI: ptype= %s, org= %d, len= %d\n",
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "VYSPI: ptype= %s, org= %d, len= %d\n",
 		((pkgType > PKG_TYPE_NMEA2000) && (pkgType < PKG_TYPE_NMEA0183))
 		? typeNames[0] : typeNames[pkgType],
 		pkgOrg, pkgLen);
 
     if((lexer->inbuffer + lexer->inbuflen < lexer->inbufptr) || (pkgLen <= 0)) {
       // discard
-      gpsd_report(session->context->debug, LOG_WARN, "VYSPI: input too short\n");
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug, "VYSPI: input too short\n");
       lexer->inbufptr = lexer->inbuffer + lexer->inbuflen;
       vyspi_packet_discard(lexer);
       break;
@@ -3966,7 +2944,7 @@ static void vyspi_preparse_spi(struct gps_device_t *session) {
     if(pkgType == PKG_TYPE_NMEA2000) {
 
       if((size_t)lexer->inbuflen < (size_t)(lexer->inbufptr - lexer->inbuffer) + pkgLen + 8) {
-          gpsd_report(session->context->debug, LOG_WARN, "VYSPI: exit prematurely: %ld + 8 + %d > %lu\n",
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug, "VYSPI: exit prematurely: %ld + 8 + %d > %lu\n",
                       (lexer->inbufptr - lexer->inbuffer), pkgLen, packetlen);
           // discard
           lexer->inbufptr = lexer->inbuffer + lexer->inbuflen;
@@ -3980,7 +2958,7 @@ static void vyspi_preparse_spi(struct gps_device_t *session) {
       uint32_t pkgid = getleu32(lexer->inbufptr, 0);
       lexer->inbufptr += 4;
 
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		  "VYSPI: PGN = %u, pid= %u, org= %u, len= %u\n",
 		  session->driver.vyspi.last_pgn, pkgid, pkgOrg, pkgLen);
 
@@ -4003,14 +2981,14 @@ static void vyspi_preparse_spi(struct gps_device_t *session) {
     } else if (pkgType == PKG_TYPE_NMEA0183) {
 
         if(lexer->inbuflen < (unsigned int)(lexer->inbufptr - lexer->inbuffer + pkgLen)) {
-          gpsd_report(session->context->debug, LOG_WARN, "VYSPI: exit prematurely: %ld + %d > %lu\n",
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug, "VYSPI: exit prematurely: %ld + %d > %lu\n",
                       (lexer->inbufptr - lexer->inbuffer), pkgLen, packetlen);
           // discard
           lexer->inbufptr = lexer->inbuffer + lexer->inbuflen;
 	break;
       }
 
-      gpsd_report(session->context->debug, LOG_DATA, "VYSPI: org= %d, len= %d\n",
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "VYSPI: org= %d, len= %d\n",
 		  pkgOrg, pkgLen);
 
 
@@ -4028,7 +3006,7 @@ static void vyspi_preparse_spi(struct gps_device_t *session) {
 
     } else {
 
-      gpsd_report(session->context->debug, LOG_ERROR, "UNKOWN: len= %d\n",
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug, "UNKOWN: len= %d\n",
 		  pkgLen);
 
       // discard
@@ -4076,25 +3054,28 @@ static ssize_t vyspi_get(struct gps_device_t *session)
 
       status = read(fd, pkg->inbuffer + pkg->inbuflen,
                     sizeof(pkg->inbuffer) - (pkg->inbuflen));
+      TRACE_EVENT(TRACE_READ, fd, status, 0);
+      if (status > 0)
+          pkg->rx_ns = monotonic_ns();
 
-      gpsd_report(session->context->debug, LOG_IO,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                   "VYSPI reading from device with status %zd\n", status);
 
       pkg->outbuflen = 0;
       if(status == -1) {
           if ((errno == EAGAIN) || (errno == EINTR)) {
-              gpsd_report(session->context->debug, LOG_IO, "no bytes ready\n");
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug, "no bytes ready\n");
               status = 0;
               /* fall through, input buffer may be nonempty */
           } else {
-              gpsd_report(session->context->debug, LOG_ERROR,
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
                           "errno: %s\n", strerror(errno));
               return -1;
           }
       } else {
-          if (session->context->debug >= LOG_IO) {
+          if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_IO, session->context->debug)) {
               char scratchbuf[MAX_PACKET_LENGTH*2+1];
-              gpsd_report(session->context->debug, LOG_IO,
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                           "Read %zd chars to buffer offset %zd (total %zd): %s\n",
                           status, pkg->inbuflen, pkg->inbuflen + status,
                           gpsd_packetdump(scratchbuf, sizeof(scratchbuf),
@@ -4103,7 +3084,7 @@ static ssize_t vyspi_get(struct gps_device_t *session)
       }
 
       if(status <= 0) {
-          gpsd_report(session->context->debug, LOG_WARN,
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug,
                       "VYSPI: exit with len in bytes= %lu, errno= %d\n",
                       status, errno);
           return 0;
@@ -4117,13 +3098,13 @@ static ssize_t vyspi_get(struct gps_device_t *session)
           pkg->inbufptr = pkg->inbuffer;
       }
   } else {
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                   "not reading new data - processing queue with %lu bytes remaining\n",
                   packet_buffered_input(pkg));
 
-      if (session->context->debug >= LOG_DATA) {
+      if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_DATA, session->context->debug)) {
           char scratchbuf[MAX_PACKET_LENGTH*2+1];
-          gpsd_report(session->context->debug, LOG_DATA, // LOG_RAW+1,
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, // LOG_RAW+1,
                       "bytes remaining: %s\n",
                       gpsd_packetdump(scratchbuf,  sizeof(scratchbuf),
                                       (char *)pkg->inbuffer, packet_buffered_input(pkg)));
@@ -4139,12 +3120,12 @@ static ssize_t vyspi_get(struct gps_device_t *session)
   if (pkg->outbuflen > 0) {
       if ((session->driver.nmea2000.workpgn == NULL)
           && (session->packet.type == NMEA2000_PACKET)) {
-          gpsd_report(session->context->debug, LOG_DATA,
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                       "VYSPI: exit with 0 with with no known PGN in N2k\n");
           return 0;
       }
 
-      gpsd_report(session->context->debug, LOG_RAW,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
         "VYSPI: exit with outbuf len = %lu and %lu bytes remaining\n",
         pkg->outbuflen,
         packet_buffered_input(pkg));
@@ -4155,7 +3136,7 @@ static ssize_t vyspi_get(struct gps_device_t *session)
        * It can still be 0 or -1 at this point even if buffer data
        * was consumed.
        */
-      gpsd_report(session->context->debug, LOG_RAW,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
         "VYSPI: exit with outbuf len = 0 and %lu bytes read and %lu bytes remaining\n",
                   status, packet_buffered_input(pkg));
       return status;
@@ -4175,7 +3156,7 @@ static ssize_t vyspi_get(struct gps_device_t *session)
     session->packet.outbuflen = len;
     session->packet.type = VYSPI_PACKET;
 
-    gpsd_report(session->context->debug, LOG_DATA,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
 		"VYSPI: len = %d, bytes= %d, errno= %d\n",
 		len, status, errno);
   }
@@ -4184,114 +3165,28 @@ static ssize_t vyspi_get(struct gps_device_t *session)
   */
 }
 
-static bool vyspi_filter_serial_input(char *str, struct gps_device_t *session) {
-  	struct gps_packet_t * lexer = &session->packet;
-	bool changed=false;
-	char conv[128], cstr[128];
-	char argh[20][32];
-	const char s[2] = ",";  //delimiter
-
-	/* There are two NMEA 0183 measurements connected to one of the serial inputs of the vyacht, delivering two relevant signals
-	$IIMWV Apparent wind angle of the masttop + windspeed
-	$HCHDM Magnetic bearing of the masttop windmeter
-
-	The compass signal would conflict with the boat compass signal and is converted in a non existin message $CCHDX, it is not needed to be seen on the N2K bus
-	it is used together with the main boat HDG from N2k bus to calculate the mast differential angle
-	
-	The measured AWA is wrong by the delta angle, and gets corrected and the message is altered to a valid $CCMWV message which will be sent to the N2k bus
-	both messages are sent then to the nmea parser as usual, gets sent out to UDP in their corrected or filtered form
-	*/
-
-	if (strncmp("$HCHDM", str, 6) == 0) {		    //measured HDG is assumed to be masttop, extract HDGmast, and replace whole sentence by a non existing = $CCHDX
-							    /*
-							      === HDM - Heading Magnetic ===
-
-							      $--HDM,x.x,T*hh<CR><LF>
-
-							      0. Heading Magnetic
-							      1. T = True
-							      2. Checksum
-							    */
-	  	gpsd_report(session->context->debug, LOG_IO, "DEFER: %s\n", str);
-
-   		char *token;
-		strcpy(cstr,str); //keep the original safe   
-
-   		/* get the first token */
-   		token = strtok(cstr, s);
-   		int i=0;
-   		/* walk through other tokens */
-   		while( token != NULL ) {
-    			strcpy(argh[i],token);
-			if (i==1) {
-				HDGmast = atof(argh[i]);
-				gpsd_report(session->context->debug, LOG_IO, "CORR: HDGboat=%.0f, HDGmast=%.0f, AWAmast=%.0f, AWAboat=%.0f\n",HDGboat,HDGmast,AWAmast,AWAboat);
-			}
-      			token = strtok(NULL, s);
-			i++;
-   		}
-		sprintf(conv,"$CCHDX,%.0f,%s,A",HDGmast,argh[2]);		
-		nmea_add_checksum(conv);
-		strcpy(str,conv);
-		gpsd_report(session->context->debug, LOG_IO, "DEFMXX: %s\n",str);
-		changed = true;
-
-
-	} else if (strncmp("$IIMWV", str, 6) == 0) {	//measured MWV is assumed to be masttop, extract AWAmast, calculate AWAboat and replace whole sentence by a calculated MWV = $CCMWV
-
-							/*
-							=== MWV - Wind Speed and Angle ===
-
-							------------------------------------------------------------------------------
-								1   2 3   4 5
-								|   | |   | |
-							 $--MWV,x.x,a,x.x,a,a*hh<CR><LF>
-							------------------------------------------------------------------------------
-
-							Field Number:
-
-							1. Wind Angle, 0 to 360 degrees
-							2. Reference, R = Relative, T = True
-							3. Wind Speed
-							4. Wind Speed Units, K/M/N
-							5. Status, A = Data Valid
-							6. Checksum
-							 */
-
-          	gpsd_report(session->context->debug, LOG_IO, "DEFER: %s\n",str);
-
-   		char *token;
-		strcpy(cstr,str); //keep the original safe   
-
-   		/* get the first token */
-   		token = strtok(cstr, s);
-   		int i=0;
-   		/* walk through other tokens */
-   		while( token != NULL ) {
-    			strcpy(argh[i],token);
-			if (i==1) {
-				AWAmast = atof(argh[i]);			//first argument is apparent wind angle (measured at masttop)
-				
-				
-				if (isnan(HDGboat)) HDGboat = 0;		//if boat heading is missing, we asume zero			
-				float dAmast = HDGmast-HDGboat;	
-				if (dAmast<-180) dAmast = 360 + dAmast;		//delta Angle Mast to boat is -60<x<60 typical. If delta is crossing 0 degree, correct.
-
-				AWAboat = AWAmast+dAmast;				
-				if (AWAboat<0) AWAboat = 360 + AWAboat;		//there is no negative bearing
-				if (AWAboat>360) AWAboat = AWAboat - 360; 	//and nothing above 360 is real
-				gpsd_report(session->context->debug, LOG_IO, "CORR: HDGboat=%.0f, HDGmast=%.0f, AWAmast=%.0f, AWAboat=%.0f, dAmast=%.0f\n",HDGboat,HDGmast,AWAmast,AWAboat,dAmast);
-			}
-      			token = strtok(NULL, s);
-			i++;
-   		}
-		sprintf(conv,"$CCMWV,%.0f,%s,%s,%s,A",AWAboat,argh[2],argh[3],argh[4]);		
-		nmea_add_checksum(conv);
-		strcpy(str,conv);
-		gpsd_report(session->context->debug, LOG_IO, "DEFMXX: %s\n",str);
-		changed = true;
-	}
-	return changed;
+static bool vyspi_replace_frame(struct gps_packet_t *lexer, uint16_t ct,
+                                const char *buf, size_t len)
+{
+    // frames lie back to back, so the ones after this one move along
+    size_t start = lexer->out_offset[ct];
+    size_t tail = start + lexer->out_len[ct];
+    size_t used = lexer->out_offset[lexer->out_count - 1]
+        + lexer->out_len[lexer->out_count - 1];
+    uint16_t n;
+
+    if (used - lexer->out_len[ct] + len >= sizeof(lexer->outbuffer))
+        return false;
+
+    memmove(lexer->outbuffer + start + len, lexer->outbuffer + tail,
+            used - tail + 1);
+    memcpy(lexer->outbuffer + start, buf, len);
+    for (n = ct + 1; n < lexer->out_count; n++)
+        lexer->out_offset[n] = (uint16_t)(lexer->out_offset[n] + len
+                                          - lexer->out_len[ct]);
+    lexer->outbuflen = lexer->outbuflen + len - lexer->out_len[ct];
+    lexer->out_len[ct] = (uint16_t)len;
+    return true;
 }
 
 /*@-mustfreeonly@*/
@@ -4302,20 +3197,20 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
   uint8_t ct = 0;
 
   struct PGN *work = NULL;
-  char sbuf[128];
+  char sbuf[NMEA_MAX + 1];
 
   static char * typeNames [] = {
       "COMMAND", "NMEA0183", "NMEA2000", "SEATALK", "AIS", "UNKOWN"
   };
 
-  gpsd_report(session->context->debug, LOG_RAW,
+  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
               "VYSPI: parse_input called with packet len = %lu and %u frames\n",
               lexer->outbuflen, lexer->out_count);
 
 
   for(ct = 0; ct < lexer->out_count; ct++) {
 
-      gpsd_report(session->context->debug, LOG_DATA, "VYSPI:[%d] type= %s, len= %u\n",ct,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "VYSPI:[%d] type= %s, len= %u\n",ct,
                   (lexer->out_type[ct] < FRM_TYPE_MAX)
                   ? typeNames[lexer->out_type[ct]] : typeNames[FRM_TYPE_MAX],
                   lexer->out_len[ct]);
@@ -4329,7 +3224,7 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
               offset = 7;
 
           if(offset > lexer->out_len[ct]) {
-              gpsd_report(session->context->debug, LOG_WARN,
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug,
                           "VYSPI: exit prematurely: %u > %lu\n",
                           offset, lexer->outbuflen);
               return 0;
@@ -4346,7 +3241,7 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
               session->driver.vyspi.prio = getub(lexer->outbuffer, lexer->out_offset[ct] + 4);
               session->driver.vyspi.src = getub(lexer->outbuffer, lexer->out_offset[ct] + 5);
               session->driver.vyspi.dest = getub(lexer->outbuffer, lexer->out_offset[ct] + 6);
-              gpsd_report(session->context->debug, LOG_DATA,
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                           "VYSPI: version 2 PGN = %u, prio= %u, src= %u, dest=%u\n",
                           session->driver.vyspi.last_pgn,
                           session->driver.vyspi.prio,
@@ -4355,8 +3250,16 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
 
               session->gpsdata.src_addr_seen[session->driver.vyspi.src] = 1;
 
+              if(session->context->n2kbus != NULL)
+                  n2k_bus_packet(session->context->n2kbus,
+                                 session->driver.vyspi.last_pgn,
+                                 session->driver.vyspi.src,
+                                 lexer->out_len[ct] - offset, timestamp());
+
           } else {
-              gpsd_report(session->context->debug, LOG_DATA,
+              // these do not say where they came from
+              session->driver.vyspi.src = N2K_NODE_GLOBAL;
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                           "VYSPI: version 1 PGN = %u\n",
                           session->driver.vyspi.last_pgn);
           }
@@ -4369,32 +3272,37 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
                   session->packet.outbuffer + offset + lexer->out_offset[ct];
 
               mask |= (work->func)(b, lexer->out_len[ct] - offset, work, session);
+              TRACE_EVENT(TRACE_PGN, session->gpsdata.gps_fd,
+                          session->driver.vyspi.last_pgn,
+                          session->driver.vyspi.src);
 
           } else {
-              gpsd_report(session->context->debug, LOG_ERROR,
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
                           "VYSPI: no work PGN found for pgn = %u\n",
                           session->driver.vyspi.last_pgn);
           }
 
       } else if (lexer->out_type[ct] == FRM_TYPE_NMEA0183) {
 
-	strcpy(sbuf,(char *)lexer->outbuffer + lexer->out_offset[ct]);	//keep copy
-	if (vyspi_filter_serial_input(sbuf, session)) {			//ok, changed the sentence
-		if (strlen(sbuf) <= lexer->out_len[ct]) {
-			lexer->out_len[ct] = strlen(sbuf);
-		} else {
-			gpsd_report(session->context->debug, LOG_IO, "DEFER: NewLen=%d, Len=%d, %s\n",strlen(sbuf),lexer->out_len[ct],sbuf);			
-			lexer->out_len[ct] = (size_t) strlen(sbuf);
-			//lexer->out_count = ct;	
-			
-			//skip the rest if new sentence is longer than original
-		}
-		strcpy((char *)lexer->outbuffer + lexer->out_offset[ct], sbuf);
-
-	}
-	//*****************
+          if (session->context->xform != NULL) {
+              enum xform_result_t xr =
+                  nmea_xform_apply(session->context->xform, session,
+                                   lexer->out_port[ct],
+                                   (char *)lexer->outbuffer + lexer->out_offset[ct],
+                                   lexer->out_len[ct], sbuf, sizeof(sbuf));
+
+              if (xr == xform_drop) {
+                  // not parsed, and not forwarded or reported raw either
+                  lexer->out_type[ct] = FRM_TYPE_MAX;
+                  continue;
+              } else if (xr == xform_rewrite
+                         && !vyspi_replace_frame(lexer, ct, sbuf, strlen(sbuf))) {
+                  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug,
+                              "VYSPI: no room for rewritten %s", sbuf);
+              }
+          }
 
-        gpsd_report(session->context->debug, LOG_IO, "PARSE: %s\n",
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug, "PARSE: %s\n",
               lexer->outbuffer + lexer->out_offset[ct]);
   	mask |= nmea_parse_len((char *)lexer->outbuffer + lexer->out_offset[ct],
                          lexer->out_len[ct],
@@ -4414,7 +3322,7 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
 
       } else if (lexer->out_type[ct] == FRM_TYPE_ST) {
 
-          gpsd_report(session->context->debug, LOG_RAW,
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_RAW, session->context->debug,
                       "VYSPI: Seatalk len= %u (or %lu)\n",
                       lexer->out_len[ct], lexer->outbuflen);
 
@@ -4424,94 +3332,109 @@ static gps_mask_t vyspi_parse_serial_input(struct gps_device_t *session)
       } else if (lexer->out_type[ct] == FRM_TYPE_CMD) {
 
           if(memcmp(session->packet.outbuffer + lexer->out_offset[ct], "stat", 4) == 0) {
-              gpsd_report(session->context->debug, LOG_DATA, "DATA with STATS\n");
+              GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "DATA with STATS\n");
               if(memcmp(session->packet.outbuffer + lexer->out_offset[ct] + 4, "n2k", 3) == 0) {
                   uint32_t error_count = getleu32(session->packet.outbuffer, lexer->out_offset[ct] + 7);
                   uint32_t packet_count = getleu32(session->packet.outbuffer, lexer->out_offset[ct] + 11);
                   uint32_t frame_count = getleu32(session->packet.outbuffer, lexer->out_offset[ct] + 15);
-                  gpsd_report(session->context->debug, LOG_DATA,
+                  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                               "DATA with N2K: packets= %u, frames= %u, errors= %u\n",
                               packet_count, frame_count, error_count);
               }
           } else {
-                  gpsd_report(session->context->debug, LOG_ERROR, "UNKOWN CMD: %s len= %u\n",
+                  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug, "UNKOWN CMD: %s len= %u\n",
                               session->packet.outbuffer + lexer->out_offset[ct], lexer->out_len[ct]);
           }
 
       } else {
 
-          gpsd_report(session->context->debug, LOG_ERROR, "UNKOWN: len= %u\n",
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug, "UNKOWN: len= %u\n",
 
                       lexer->out_len[ct]);
 
       }
   }
 
-  // calling it here - just to make sure we are not missing a beat
-  // vyspi_handle_time_trigger(session);
-
+  // the node starts once we know the device speaks a protocol with
+  // source addresses, and whatever came by transport goes in the mask
+  vyspi_handle_time_trigger(session);
+  mask |= session->driver.vyspi.transport_mask;
+  session->driver.vyspi.transport_mask = 0;
 
   return mask;
 }
 
-void vyspi_handle_time_trigger(struct gps_device_t *session)
+static ssize_t vyspi_node_write(struct gps_device_t *session,
+                                const uint8_t *buf, size_t len)
 {
-    if(!session->driver.nmea2000.enable_writing) {
-        // nothing to do here currently if we do not want to enablle writing
-        gpsd_report(session->context->debug, LOG_RAW,
-                    "N2K not marked for write handling. Ignoring startup sequence.\n");
-        return;
-    }
-
-    // are we actually ready to start the n2k node?
-    if(session->gpsdata.dev.node_state == node_init) {
-
-        if((session->gpsdata.dev.protocol_version == 0)
-           && session->packet.frm_version) {
-
-            // first of all - we saw version > 0 protocol, lets switch
-            session->gpsdata.dev.protocol_version = session->packet.frm_version;
-
-            if(session->driver.nmea2000.own_src_id < 0xff) {
-
-                // if we have a configured source addr lets use that and claim directly
-
-                gpsd_report(session->context->debug, LOG_INF,
-                            "NMEA 2000 node starting. Claiming stored source address 0x%02x.\n",
-                            session->driver.nmea2000.own_src_id);
-
-                vyspi_claim_our_source_addr(session);
-
-                // no need for node starting phase
-                session->gpsdata.dev.node_state = node_ready;
+    // the node only runs on protocol version 1 and up
+    return vyspi_write_with_protocol(session, FRM_TYPE_NMEA2000, buf, len, 1);
+}
 
-            } else {
+static void vyspi_node_deliver(struct gps_device_t *session, uint32_t pgn,
+                               uint8_t src, uint8_t dest,
+                               const uint8_t *data, size_t len)
+{
+    // a PGN that came by transport, handled as if it came in one piece
+    struct PGN *work = vyspi_find_pgn(pgn);
+
+    session->driver.vyspi.last_pgn = pgn;
+    session->driver.vyspi.src = src;
+    session->driver.vyspi.dest = dest;
+    if (work != NULL)
+        session->driver.vyspi.transport_mask |=
+            (work->func)((unsigned char *)data, (int)len, work, session);
+}
 
-                gpsd_report(session->context->debug, LOG_INF,
-                            "NMEA 2000 node starting. No pre-configured source address. Making address claim call.\n");
+static void vyspi_node_start(struct gps_device_t *session)
+{
+    struct n2k_node_t *node = &session->n2k;
+    int i;
+
+    node->write = vyspi_node_write;
+    node->deliver = vyspi_node_deliver;
+    node->name = n2k_node_name(session->driver.nmea2000.manufactureid,
+                               session->driver.nmea2000.deviceid);
+    node->ntx = node->nrx = 0;
+    for (i = 0; pgnlist[i].pgn != 0; i++) {
+        if (pgnlist[i].transmit && node->ntx < N2K_NODE_PGNS)
+            node->tx_pgns[node->ntx++] = pgnlist[i].pgn;
+        if (pgnlist[i].receive && node->nrx < N2K_NODE_PGNS)
+            node->rx_pgns[node->nrx++] = pgnlist[i].pgn;
+    }
 
-                // waiting for incoming answers now
-                session->gpsdata.dev.node_state = node_starting;
-                tu_gettime(&session->gpsdata.dev.node_state_time);
+    n2k_node_start(session, session->driver.nmea2000.own_src_id, timestamp());
+}
 
-                // make a poll call to all other devices
-                vyspi_addr_claim_call(session);
-            }
+void vyspi_handle_time_trigger(struct gps_device_t *session)
+{
+    timestamp_t wake;
 
-        }
+    if(session->n2k.state != n2k_node_off) {
+        // the node's timers
+        wake = n2k_node_wake(&session->n2k);
+        if ((wake != 0) && (wake <= timestamp()))
+            n2k_node_tick(session, timestamp());
+        return;
+    }
 
-    } else if(session->gpsdata.dev.node_state == node_starting) {
+    if(!session->driver.nmea2000.enable_writing) {
+        // nothing to do here currently if we do not want to enablle writing
+        return;
+    }
 
-        // give it 2 seconds to collect other node's addresses
-        if(tu_get_millis_since(&session->gpsdata.dev.node_state_time) > 2000) {
+    // are we actually ready to start the n2k node?
+    if((session->gpsdata.dev.protocol_version == 0)
+       && session->packet.frm_version) {
 
-            gpsd_report(session->context->debug, LOG_INF,
-                        "NMEA 2000 node waited 2 sec for others to report. Claiming source address now.\n");
+        // first of all - we saw version > 0 protocol, lets switch
+        session->gpsdata.dev.protocol_version = session->packet.frm_version;
 
-            vyspi_claim_free_source_addr(session);
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
+                    "NMEA 2000 node starting on protocol version %u.\n",
+                    session->gpsdata.dev.protocol_version);
 
-            session->gpsdata.dev.node_state = node_ready;
-        }
+        vyspi_node_start(session);
     }
 }
 /*@+mustfreeonly@*/
@@ -4532,7 +3455,7 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
 
   uint8_t len = 0;
 
-  gpsd_report(session->context->debug, LOG_ERROR,
+  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
 	      "VYSPI: parse_input called with packet len = %d\n", packet_len);
 
   // one extra for reading both, len and type/origin
@@ -4542,7 +3465,7 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
     uint8_t pkgOrg  = (uint8_t)((buf[len] & 0xF0) >> 5);
     uint8_t pkgLen =  (uint8_t)buf[len + 1] & 0xFF;
 
-    gpsd_report(session->context->debug, LOG_DATA, "VYSPI: ptype= %s, org= %d, len= %d\n",
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "VYSPI: ptype= %s, org= %d, len= %d\n",
 		((pkgType > PKG_TYPE_NMEA2000) && (pkgType < PKG_TYPE_NMEA0183))
 		? typeNames[0] : typeNames[pkgType],
 		pkgOrg, pkgLen);
@@ -4555,7 +3478,7 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
     if(pkgType == PKG_TYPE_NMEA2000) {
 
         if(len + pkgLen + 8 > packet_len) {
-            gpsd_report(session->context->debug, LOG_WARN, "VYSPI: exit prematurely: %d + 8 + %d > %d\n",
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug, "VYSPI: exit prematurely: %d + 8 + %d > %d\n",
                         len, pkgLen, packet_len);
             break;
       }
@@ -4563,7 +3486,7 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
       session->driver.vyspi.last_pgn = getleu32(buf, len);
       uint32_t pkgid = getleu32(buf, len + 4);
 
-      gpsd_report(session->context->debug, LOG_DATA,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug,
                   "VYSPI: PGN = %u, pid= %u, org= %u, len= %u\n",
                   session->driver.vyspi.last_pgn, pkgid, pkgOrg, pkgLen);
 
@@ -4574,8 +3497,10 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
       if (work != NULL) {
           mask |= (work->func)(&session->packet.outbuffer[len],
                                (int)pkgLen, work, session);
+          TRACE_EVENT(TRACE_PGN, session->gpsdata.gps_fd,
+                      session->driver.vyspi.last_pgn, pkgOrg);
       } else {
-          gpsd_report(session->context->debug, LOG_ERROR,
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
                       "VYSPI: no work PGN found for pgn = %u\n",
                       session->driver.vyspi.last_pgn);
       }
@@ -4590,7 +3515,7 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
 
       gps_mask_t st = 0;
 
-      gpsd_report(session->context->debug, LOG_DATA, "VYSPI: org= %d, len= %d\n",
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_DATA, session->context->debug, "VYSPI: org= %d, len= %d\n",
 		  pkgOrg, pkgLen);
 
       char sentence[NMEA_MAX + 1];
@@ -4599,12 +3524,12 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
       memcpy(sentence, (char *)&session->packet.outbuffer[len], pkgLen);
 
       if (sentence[strlen(sentence)-1] != '\n')
-          gpsd_report(session->context->debug, LOG_IO, "<= GPS: %s\n", sentence);
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug, "<= GPS: %s\n", sentence);
       else
-          gpsd_report(session->context->debug, LOG_IO, "<= GPS: %s", sentence);
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug, "<= GPS: %s", sentence);
 
       if ((st= nmea_parse(sentence, session)) == 0) {
-          gpsd_report(session->context->debug, LOG_WARN, "unknown sentence: \"%s\"\n",	sentence);
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug, "unknown sentence: \"%s\"\n",	sentence);
       }
 
       mask |= st;
@@ -4614,7 +3539,7 @@ static gps_mask_t vyspi_parse_spi_input(struct gps_device_t *session)
 
     } else {
 
-      gpsd_report(session->context->debug, LOG_ERROR, "UNKOWN: len= %d\n",
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug, "UNKOWN: len= %d\n",
 		  pkgLen);
 
       break;
@@ -4641,7 +3566,7 @@ static void vyspi_set_serial(struct gps_device_t *session, speed_t speed) {
   memset (&tty, 0, sizeof tty);
 
   if (tcgetattr(session->gpsdata.gps_fd, &session->ttyset_old) != 0) {
-    gpsd_report(session->context->debug, LOG_ERROR,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
 		"SEATALK tcgetattr error %d: %s\n", errno, strerror(errno));
     session->gpsdata.gps_fd = -1;
     return;
@@ -4664,11 +3589,11 @@ static void vyspi_set_serial(struct gps_device_t *session, speed_t speed) {
 
   /* Set Baud Rate */
   if(cfsetospeed (&session->ttyset, (speed_t)speed) < 0) {
-    gpsd_report(session->context->debug, LOG_ERROR,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
 		"Failed to set new speed %d: %s\n", errno, strerror(errno));
   }
   if(cfsetispeed (&session->ttyset, (speed_t)speed) < 0) {
-    gpsd_report(session->context->debug, LOG_ERROR,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
 		"Failed to set new speed %d: %s\n", errno, strerror(errno));
   }
 
@@ -4720,7 +3645,7 @@ static void vyspi_set_serial(struct gps_device_t *session, speed_t speed) {
   tcflush( session->gpsdata.gps_fd, TCIFLUSH );
 
   if ( tcsetattr ( session->gpsdata.gps_fd, TCSANOW, &session->ttyset ) != 0) {
-    gpsd_report(session->context->debug, LOG_ERROR,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
 		"SEATALK tcsetattr error %d: %s\n", errno, strerror(errno));
     session->gpsdata.gps_fd = -1;
     return;
@@ -4751,14 +3676,14 @@ int vy_port_list_read(struct gps_device_t *session, struct devconfig_t * dev) {
 
         } else {
 
-            gpsd_report(session->context->debug, LOG_ERROR,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
                         "Unkown or illegal port type '%s'\n", port->type_str);
             return -1;
         }
 
         if(port->type == PORT_TYPE_SEATALK) {
             if((port->speed != 0) && (port->speed != 4800)) {
-                gpsd_report(session->context->debug, LOG_WARN,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_WARN, session->context->debug,
                             "Ignoring odd port speed for seatalk!\n");
             }
         } else if(port->type == PORT_TYPE_NMEA0183) {
@@ -4771,13 +3696,13 @@ int vy_port_list_read(struct gps_device_t *session, struct devconfig_t * dev) {
             }
 
             if(!port_speed_matched) {
-                gpsd_report(session->context->debug, LOG_ERROR,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
                             "NMEA0183 requires legal port speed %d!\n", port->speed);
                 return -1;
             }
         }
 
-        gpsd_report(session->context->debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                     "port %d: %s @ %d baud\n",
                     port->no,
                     port->type_str,
@@ -4812,7 +3737,7 @@ ssize_t vyspi_write_with_protocol(struct gps_device_t *session,
                                   const uint8_t protocol_version)
 /* pass low-level data to devices straight through */
 {
-    gpsd_report(session->context->debug, LOG_INF,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                 "vyspi_write: %s (%s) ports= %d\n",
                 buf, session->gpsdata.dev.path, session->gpsdata.dev.port_count);
 
@@ -4823,10 +3748,19 @@ ssize_t vyspi_write_with_protocol(struct gps_device_t *session,
     size_t frmlen = frm_toHDLC8(frm, 255, frm_type, protocol_version, buf, len);
     gpsd_serial_write(session, (const char *)frm, frmlen);
 
+    vyspi_write_stats(session, frm_type, frmlen, len);
+    return len;
+}
+
+static void vyspi_write_stats(struct gps_device_t *session,
+                              enum frm_type_t frm_type,
+                              size_t frmlen, size_t len)
+/* count what went out, and log the rates now and then */
+{
     session->driver.vyspi.bytes_written_frm[frm_type] += frmlen;
     session->driver.vyspi.bytes_written_raw[frm_type] += len;
 
-    if(session->context->debug >= LOG_IO) {
+    if (LOG_SUBACTIVE(LOG_SUB_VYSPI, LOG_IO, session->context->debug)) {
 
         int i = 0;
         
@@ -4837,7 +3771,7 @@ ssize_t vyspi_write_with_protocol(struct gps_device_t *session,
         uint32_t diff = nowms - session->driver.vyspi.bytes_written_last_ms;
         double rate = 1000.0*((double)(frmlen))/((double)diff);
         
-        gpsd_report(session->context->debug, LOG_IO,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                     "Wrote %f bytes/s (%0.2fkBit/s) as %lu bytes in %u ms\n",
                     rate, rate*8.0/1024.0,
                     frmlen, diff);
@@ -4851,7 +3785,7 @@ ssize_t vyspi_write_with_protocol(struct gps_device_t *session,
                     ((double)(nowms - session->driver.vyspi.bytes_written_last_sec));
                 double rate_r = 1000.0*((double)(session->driver.vyspi.bytes_written_raw[i]))/
                     ((double)(nowms - session->driver.vyspi.bytes_written_last_sec));
-                gpsd_report(session->context->debug, LOG_IO,
+                GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                             "%s   %0.2f (%0.2f) kBit/s with %u (%u) bytes in %u ms\n",
                             ftn[i],
                             rate_f*8.0/1024.0, rate_r*8.0/1024.0,
@@ -4862,14 +3796,12 @@ ssize_t vyspi_write_with_protocol(struct gps_device_t *session,
                 session->driver.vyspi.bytes_written_frm[i] = 0;
                 session->driver.vyspi.bytes_written_raw[i] = 0;
             }
-            gpsd_report(session->context->debug, LOG_IO,
+            GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_IO, session->context->debug,
                         "    last= %u ms, now= %u ms\n",
                         session->driver.vyspi.bytes_written_last_sec, nowms);
             session->driver.vyspi.bytes_written_last_sec = nowms;
         }
     }
-    
-    return len;
 }
 
 ssize_t vyspi_write(struct gps_device_t *session,
@@ -4882,19 +3814,56 @@ ssize_t vyspi_write(struct gps_device_t *session,
                               session->gpsdata.dev.protocol_version);
 }
 
+ssize_t vyspi_write_batch(struct gps_device_t *session,
+                          enum frm_type_t frm_type,
+                          const uint8_t *buf,
+                          const size_t *lens,
+                          int count)
+/* frame several payloads back to back and write them in one go */
+{
+    uint8_t frm[VYSPI_BATCH_MAX];
+    size_t used = 0, raw = 0;
+    int i;
+
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
+                "vyspi_write_batch: %d frames (%s) ports= %d\n",
+                count, session->gpsdata.dev.path, session->gpsdata.dev.port_count);
+
+    for(i = 0; i < count; i++) {
+        // only when a frame might not fit, which a batch rarely needs
+        if(used + 255 > sizeof(frm)) {
+            gpsd_serial_write(session, (const char *)frm, used);
+            vyspi_write_stats(session, frm_type, used, raw);
+            used = raw = 0;
+        }
+        if(lens[i] > 0)
+            used += frm_toHDLC8(frm + used, 255, frm_type,
+                                session->gpsdata.dev.protocol_version,
+                                buf, lens[i]);
+        raw += lens[i];
+        buf += lens[i];
+    }
+    if(used > 0) {
+        gpsd_serial_write(session, (const char *)frm, used);
+        vyspi_write_stats(session, frm_type, used, raw);
+    }
+
+    return count;
+}
+
 #ifndef S_SPLINT_S
 
 int vyspi_init(struct gps_device_t *session) {
 
     int i = 0;
 
-    gpsd_report(session->context->debug, LOG_INF,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                     "initializing configuration for device '%s'.\n",
 		session->gpsdata.dev.path);
 
     if(vy_port_list_read(session, &session->gpsdata.dev) != 0) {
 
-        gpsd_report(session->context->debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
                     "Error reading port configuration. Assuming defaults.\n");
         return 1;
     }
@@ -4913,7 +3882,7 @@ int vyspi_init(struct gps_device_t *session) {
 
         vy_port2cmd(&session->gpsdata.dev.portlist[i], cmd);
 
-        gpsd_report(session->context->debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                     "setting port configuration for port '%d'.\n",
                     session->gpsdata.dev.portlist[i].no);
 
@@ -4922,11 +3891,11 @@ int vyspi_init(struct gps_device_t *session) {
 
     // send start command to stm32
 
-    gpsd_report(session->context->debug, LOG_INF,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                 "Sending start command.\n");
 
     if(session->driver.nmea2000.enable_writing) {
-        gpsd_report(session->context->debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                 "NMEA 2000 - enable writing - requesting new frame protocol.\n");
         memcpy(cmd, "vers", 4);
         cmd[4] = 2;
@@ -4990,7 +3959,7 @@ int vyspi_open(struct gps_device_t *session) {
 
   // this is port in case of TCP/IP or detailed port configuration for serial
 
-  gpsd_report(session->context->debug, LOG_INF,
+  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
 		"Device path = %s.\n", path);
 
   // SPI or serial start with "/dev"
@@ -5000,18 +3969,18 @@ int vyspi_open(struct gps_device_t *session) {
     if(port != NULL)
       *port++ = '\0';
 
-    gpsd_report(session->context->debug, LOG_INF,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
 		"Assuming SPI or serial device %s.\n", path);
 
     if ((dsock = open(path, O_RDWR | O_NOCTTY)) == -1) {
-      gpsd_report(session->context->debug, LOG_ERROR,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug,
 		  "read-only device open failed: %s\n",
 		  strerror(errno));
       return -1;
     }
 
     session->gpsdata.gps_fd = dsock;
-    gpsd_report(session->context->debug, LOG_INF,
+    GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
 		"Device %s opened with sock = %d.\n", path, dsock);
 
     // ugly hack:
@@ -5023,12 +3992,12 @@ int vyspi_open(struct gps_device_t *session) {
             ioctl(dsock, VYSPI_RESET, NULL);
         }
         session->gpsdata.dev.isSerial = 0;
-        gpsd_report(session->context->debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                     "Opened %s as SPI device.\n", path);
 
     } else {
 
-        gpsd_report(session->context->debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                     "opening serial feed at %s.\n", path);
         session->gpsdata.dev.isSerial = 1;
         vyspi_set_serial(session, (speed_t)B115200);
@@ -5047,15 +4016,15 @@ int vyspi_open(struct gps_device_t *session) {
       } else
           *port++ = '\0';
 
-      gpsd_report(session->context->debug, LOG_INF,
+      GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_INF, session->context->debug,
                   "opening UDP VYSPI feed at %s, port %s.\n", path, port);
 
       if ((session->gpsdata.gps_fd = netlib_connectsock(AF_UNSPEC, path, port, "udp")) < 0) {
-          gpsd_report(session->context->debug, LOG_ERROR, "UDP device open error %s.\n",
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_ERROR, session->context->debug, "UDP device open error %s.\n",
                       netlib_errstr(session->gpsdata.gps_fd));
           return -1;
       } else
-          gpsd_report(session->context->debug, LOG_SPIN,
+          GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_SPIN, session->context->debug,
                       "TCP device opened on fd %d\n", session->gpsdata.gps_fd);
       session->gpsdata.dev.isSerial = 1;
   }
@@ -5084,7 +4053,7 @@ const char /*@ observer @*/ *gpsd_vyspidump(struct gps_device_t *device) {
   size_t binbuflen = device->packet.outbuflen;
 
   /*
-  gpsd_report(session->context->debug, LOG_SPIN,
+  GPSD_SUBLOG(LOG_SUB_VYSPI, LOG_SPIN, session->context->debug,
 	      "VYSPI: gpsd_vyspidump %u entered with len = %ld\n",
 	      device->driver.vyspi.last_pgn, binbuflen);
   */
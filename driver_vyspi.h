@@ -23,6 +23,14 @@ ssize_t vyspi_write(struct gps_device_t *,
                     const uint8_t *,
                     const size_t);
 
+/* framed bytes vyspi_write_batch() gathers before each write */
+#define VYSPI_BATCH_MAX 4096
+ssize_t vyspi_write_batch(struct gps_device_t *,
+                          enum frm_type_t,
+                          const uint8_t *,
+                          const size_t *,
+                          int);
+
 struct PGN {
     uint32_t  pgn;
     uint8_t  fast;
@@ -1160,30 +1160,12 @@ bool aivdm_decode(const char *buf, size_t buflen,
 		  struct ais_t *ais,
 		  int debug)
 {
-#ifdef __UNUSED_DEBUG__
-    char *sixbits[64] = {
-        "000000", "000001", "000010", "000011", "000100",
-        "000101", "000110", "000111", "001000", "001001",
-        "001010", "001011", "001100", "001101", "001110",
-        "001111", "010000", "010001", "010010", "010011",
-        "010100", "010101", "010110", "010111", "011000",
-        "011001", "011010", "011011", "011100", "011101",
-        "011110", "011111", "100000", "100001", "100010",
-        "100011", "100100", "100101", "100110", "100111",
-        "101000", "101001", "101010", "101011", "101100",
-        "101101", "101110", "101111", "110000", "110001",
-        "110010", "110011", "110100", "110101", "110110",
-        "110111", "111000", "111001", "111010", "111011",
-        "111100", "111101", "111110", "111111",
-    };
-#endif /* __UNUSED_DEBUG__ */
-    int nfrags, ifrag, nfields = 0;
+    int nfrags, ifrag, seqid, nfields = 0;
     unsigned char *field[NMEA_MAX*2];
     unsigned char fieldcopy[NMEA_MAX*2+1];
     unsigned char *data, *cp;
-    unsigned char pad;
+    unsigned int pad, source;
     struct aivdm_context_t *ais_context;
-    int i;
 
     if (buflen == 0)
         return false;
@@ -1260,86 +1242,45 @@ bool aivdm_decode(const char *buf, size_t buflen,
 
     nfrags = atoi((char *)field[1]); /* number of fragments to expect */
     ifrag = atoi((char *)field[2]); /* fragment id */
+    /* sequential message ID; single-fragment sentences usually omit it */
+    seqid = isdigit(field[3][0]) ? atoi((char *)field[3]) : -1;
     data = field[5];
-    pad = field[6][0]; /* number of padding bits */
+    /* number of padding bits */
+    pad = isdigit(field[6][0]) ? (unsigned int)(field[6][0] - '0') : 0;
+    /*
+     * Talker ID and VDM/VDO tell apart receivers multiplexed onto one
+     * device, whose sequential IDs are independent of each other.
+     */
+    source = ((unsigned int)field[0][1] << 16)
+        | ((unsigned int)field[0][2] << 8) | (unsigned int)field[0][5];
     gpsd_report(session->context->debug, LOG_PROG,
-                "nfrags=%d, ifrag=%d, decoded_frags=%d, data=%s\n",
-                nfrags, ifrag, ais_context->decoded_frags, data);
-
-    /* assemble the binary data */
-
-    /* check fragment ordering */
-    if (ifrag != ais_context->decoded_frags + 1) {
-        gpsd_report(session->context->debug, LOG_ERROR,
-                    "invalid fragment #%d received, expected #%d.\n",
-                    ifrag, ais_context->decoded_frags + 1);
-        if (ifrag != 1)
-            return false;
-        /* else, ifrag==1: Just discard all that was previously decoded and
-         * simply handle that packet */
-        ais_context->decoded_frags = 0;
-    }
-    if (ifrag == 1) {
-        (void)memset(ais_context->bits, '\0', sizeof(ais_context->bits));
-        ais_context->bitlen = 0;
-    }
-
-    /* wacky 6-bit encoding, shades of FIELDATA */
-    /*@ +charint @*/
-    for (cp = data; cp < data + strlen((char *)data); cp++) {
-        unsigned char ch;
-        ch = *cp;
-        ch -= 48;
-        if (ch >= 40)
-            ch -= 8;
-#ifdef __UNUSED_DEBUG__
-        gpsd_report(session->context->debug, LOG_RAW,
-                    "%c: %s\n", *cp, sixbits[ch]);
-#endif /* __UNUSED_DEBUG__ */
-        /*@ -shiftnegative @*/
-        for (i = 5; i >= 0; i--) {
-            if ((ch >> i) & 0x01) {
-                ais_context->bits[ais_context->bitlen / 8] |=
-                    (1 << (7 - ais_context->bitlen % 8));
-            }
-            ais_context->bitlen++;
-            if (ais_context->bitlen > sizeof(ais_context->bits)) {
-                gpsd_report(session->context->debug, LOG_INF,
-                            "overlong AIVDM payload truncated.\n");
-                return false;
-            }
-        }
-        /*@ +shiftnegative @*/
-    }
-    if (isdigit(pad))
-        ais_context->bitlen -= (pad - '0');	/* ASCII assumption */
-    /*@ -charint @*/
-
-    /* time to pass buffered-up data to where it's actually processed? */
-    if (ifrag == nfrags) {
-        if (debug >= LOG_INF) {
-            size_t clen = (ais_context->bitlen + 7) / 8;
-            gpsd_report(session->context->debug, LOG_INF,
-                        "AIVDM payload is %zd bits, %zd chars: %s\n",
-                        ais_context->bitlen, clen,
-                        gpsd_hexdump(session->msgbuf, sizeof(session->msgbuf),
-                                     (char *)ais_context->bits, clen));
-        }
-
-        /* clear waiting fragments count */
-        ais_context->decoded_frags = 0;
+                "nfrags=%d, ifrag=%d, seqid=%d, data=%s\n",
+                nfrags, ifrag, seqid, data);
+
+    /* assemble the binary data, filing fragments until all are in */
+    if (aivdm_reassemble(&session->driver.aivdm.reassembly, source,
+                         session->driver.aivdm.ais_channel, seqid,
+                         nfrags, ifrag, (char *)data, pad, timestamp(),
+                         ais_context->bits, sizeof(ais_context->bits),
+                         &ais_context->bitlen,
+                         session->context->debug) != 1)
+        return false;
 
-        /* decode the assembled binary packet */
-        return ais_binary_decode(session->context->debug,
-                                 ais,
-                                 ais_context->bits,
-                                 ais_context->bitlen,
-                                 &ais_context->type24_queue);
+    if (debug >= LOG_INF) {
+        size_t clen = (ais_context->bitlen + 7) / 8;
+        gpsd_report(session->context->debug, LOG_INF,
+                    "AIVDM payload is %zd bits, %zd chars: %s\n",
+                    ais_context->bitlen, clen,
+                    gpsd_hexdump(session->msgbuf, sizeof(session->msgbuf),
+                                 (char *)ais_context->bits, clen));
     }
 
-    /* we're still waiting on another sentence */
-    ais_context->decoded_frags++;
-    return false;
+    /* decode the assembled binary packet */
+    return ais_binary_decode(session->context->debug,
+                             ais,
+                             ais_context->bits,
+                             ais_context->bitlen,
+                             &ais_context->type24_queue);
 }
 /*@ +fixedformalarray +usedef +branchstate @*/
 
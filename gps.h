@@ -1851,6 +1851,10 @@ struct navigation_t {
 #define NAV_HDG_MAGN_PSET	    (1llu<<12)
 #define NAV_ROT_PSET	        (1llu<<13)
 #define NAV_RUDDER_ANGLE_PSET	(1llu<<14)
+#define NAV_VMG_PSET	        (1llu<<15)
+#define NAV_LEEWAY_PSET	        (1llu<<16)
+#define NAV_CTW_PSET	        (1llu<<17)
+#define NAV_CURRENT_PSET	    (1llu<<18)
 
     gps_mask_t set;
 
@@ -1884,6 +1888,18 @@ struct navigation_t {
 
   // magnetic or true heading
   double heading[2];
+
+  // knots, boat speed made good towards the true wind
+  double vmg;
+
+  // deg, drift to starboard through the water, and the course through
+  // the water it leaves, deg true
+  double leeway;
+  double course_thru_water;
+
+  // the current: deg true it sets towards, knots
+  double current_set;
+  double current_drift;
 };
 
 
@@ -2169,6 +2185,9 @@ struct policy_t {
 
     bool watcher;			/* is watcher mode on? */
     bool json;				/* requesting JSON? */
+    bool binary;			/* TPV/SKY/AIS as binary records? */
+    int targets;			/* AIS target delta interval, 0 = off */
+    bool cpa;				/* AIS collision alarms? */
     bool signalk;			/* requesting signalk? */
     bool nmea;				/* requesting dumping as NMEA? */
     bool canboat;			/* requesting dumping as canboat? */
@@ -2178,6 +2197,10 @@ struct policy_t {
     bool split24;			/* requesting split AIS Type 24s */
     bool pps;				/* requesting PPS in NMEA/raw modes */
     int loglevel;			/* requested log level of messages */
+    unsigned int logmask;		/* LOG_SUBMASK set of subsystems traced */
+    bool stats;				/* periodic STATS on /debug */
+    bool n2kbus;			/* periodic N2KDEVICES on /n2k */
+    int n2ksource;			/* ...or N2KDEVICE, -1 for the list */
     char devpath[GPS_PATH_MAX];		/* specific device to watch */
     char remote[GPS_PATH_MAX];		/* ...if this was passthrough */
 };
@@ -2243,6 +2266,7 @@ typedef int socket_t;
 #define WATCH_DEVICE	0x000800u	/* watch specific device */
 #define WATCH_SPLIT24	0x001000u	/* split AIS Type 24s */
 #define WATCH_PPS	0x002000u	/* enable PPS JSON */
+#define WATCH_BINARY	0x004000u	/* TPV/SKY/AIS as binary records */
 #define WATCH_NEWSTYLE	0x010000u	/* force JSON streaming */
 #define WATCH_OLDSTYLE	0x020000u	/* force old-style streaming */
 
@@ -2461,6 +2485,116 @@ extern double wgs84_separation(double, double);
 #define GPSD_SHARED_MEMORY	"shared memory"
 #define GPSD_DBUS_EXPORT	"DBUS export"
 
+/* parts of the shared-memory export a reader can ask for */
+enum shm_section_id {
+    SHM_SECTION_HEAD,		/* mask and status of the last report */
+    SHM_SECTION_DEVICE,		/* device that shipped it */
+    SHM_SECTION_FIX,
+    SHM_SECTION_SKY,
+    SHM_SECTION_NAVIGATION,
+    SHM_SECTION_WAYPOINT,
+    SHM_SECTION_ENVIRONMENT,
+    SHM_SECTION_ENGINE,
+    SHM_SECTION_ATTITUDE,
+    SHM_SECTION_AIS,		/* last AIS message */
+    SHM_SECTIONS
+};
+#define SHM_SECTION(id)		(1u << (id))
+#define SHM_ALL_SECTIONS	(SHM_SECTION(SHM_SECTIONS) - 1)
+extern void gps_shm_select(struct gps_data_t *, unsigned int);
+#define SHM_MERGED	-1	/* gps_shm_device(): newest section of any device */
+extern int gps_shm_slots(struct gps_data_t *, char (*)[GPS_PATH_MAX], int);
+extern int gps_shm_find(struct gps_data_t *, const char *);
+extern int gps_shm_device(struct gps_data_t *, int);
+
+/*
+ * Binary streaming: a client that sends ?WATCH={"binary":true} gets its
+ * TPV, SKY and AIS reports as records rather than JSON objects; every
+ * other report and response stays JSON text.  A record starts with a
+ * byte that can't begin a JSON line, so the two interleave freely.
+ *
+ * The 8-byte header is in network byte order: magic, version, kind,
+ * flags, payload length (16 bits) and a fingerprint of the sender's
+ * structure layouts (16 bits).  The payload is a NUL-terminated device
+ * path and tag followed by fields copied straight out of gps_data_t in
+ * the sender's byte order, which the GPS_BINARY_LITTLE flag records.
+ * A reader whose layout or byte order differs can still skip records by
+ * their length, but can't interpret them; binary mode is meant for
+ * consumers on the same machine or architecture as the daemon.
+ */
+#define GPS_BINARY_MAGIC	0xb5
+#define GPS_BINARY_VERSION	1
+#define GPS_BINARY_HEADER	8
+#define GPS_BINARY_LITTLE	0x01	/* flags: payload is little-endian */
+
+enum gps_binary_kind_t {
+    GPS_BINARY_TPV = 1,
+    GPS_BINARY_SKY,
+    GPS_BINARY_AIS,
+};
+
+/*
+ * Event ring: gpsd appends a fixed-size record for every decoded update
+ * to a shared-memory ring that any number of local readers follow with
+ * cursors of their own.  A reader that falls more than a ring's worth
+ * behind loses records and is told so.
+ */
+enum gps_ring_kind_t {
+    GPS_RING_FIX = 1,
+    GPS_RING_NAV,
+    GPS_RING_ENV,
+    GPS_RING_ATTITUDE,
+    GPS_RING_AIS,
+};
+
+struct gps_ring_record_t {
+    uint64_t seq;		/* position in the stream */
+    uint64_t ts;		/* CLOCK_MONOTONIC nanoseconds when reported */
+    gps_mask_t set;		/* report mask */
+    uint16_t device;		/* see gps_ring_device() */
+    uint16_t kind;		/* enum gps_ring_kind_t */
+    uint32_t reserved;
+    union {
+	struct {
+	    timestamp_t time;
+	    double latitude, longitude, altitude, climb;
+	    int32_t mode, status;
+	} fix;
+	struct {
+	    gps_mask_t set;	/* NAV_*_PSET */
+	    double speed_over_ground, speed_thru_water;
+	    double course_over_ground, heading, heading_magnetic;
+	    double rate_of_turn, depth;
+	} nav;
+	struct {
+	    gps_mask_t set;	/* ENV_*_PSET */
+	    double apparent_angle, apparent_speed;
+	    double true_angle, true_speed;	/* true north */
+	    double temp_water, temp_air, pressure;
+	} env;
+	struct {
+	    double heading, pitch, roll;
+	} attitude;
+	struct {
+	    uint32_t type, mmsi, status;
+	    int32_t turn;
+	    uint32_t speed;			/* deciknots */
+	    int32_t lon, lat;			/* 1/10000 minute */
+	    uint32_t course, heading;		/* AIS units, types 1-3 */
+	} ais;
+    } u;
+};
+
+#define GPS_RING_OVERRUN	-2	/* gps_ring_next() lost records */
+
+struct gps_ring_t;
+extern /*@null@*/struct gps_ring_t *gps_ring_open(void);
+extern int gps_ring_next(struct gps_ring_t *, /*@out@*/struct gps_ring_record_t *,
+			 int);
+extern unsigned long gps_ring_lost(const struct gps_ring_t *);
+extern /*@null@*/const char *gps_ring_device(struct gps_ring_t *, int);
+extern void gps_ring_close(/*@only@*/struct gps_ring_t *);
+
 /*
  * Platform-specific declarations
  */
@@ -33,6 +33,13 @@ int json_device_read(const char *, /*@out@*/struct devconfig_t *,
 void json_version_dump(/*@out@*/char *, size_t);
 void json_aivdm_dump(const struct ais_t *, /*@null@*/const char *, bool,
 		     /*@out@*/char *, size_t);
+void json_aistarget_dump(const struct ais_target_t *, /*@out@*/char *, size_t);
+int json_aistargets_read(const char *, /*@out@*/struct ais_target_query_t *,
+			 /*@null@*/const char **);
+void json_cpa_dump(const struct ais_cpa_event_t *,
+		   /*@null@*/const struct ais_target_t *, /*@out@*/char *, size_t);
+int json_cpa_read(const char *, double *, double *, /*@null@*/const char **);
+int json_n2kdevices_read(const char *, int *, /*@null@*/const char **);
 int json_rtcm2_read(const char *, char *, size_t, struct rtcm2_t *,
 		    /*@null@*/const char **);
 int json_rtcm3_read(const char *, char *, size_t, struct rtcm3_t *,
@@ -41,6 +48,43 @@ int json_ais_read(const char *, char *, size_t, struct ais_t *,
 		  /*@null@*/const char **);
 int libgps_json_unpack(const char *, struct gps_data_t *,
 		       /*@null@*/const char **);
+
+/*
+ * jsonout.c: cursor-based writer the dumpers above are built on; the
+ * pseudo-NMEA and SignalK writers use it too
+ */
+struct json_out_t {
+    char *buf;
+    size_t len;		/* bytes written, not counting the NUL */
+    size_t cap;		/* size of buf */
+    bool overflow;	/* output was truncated */
+};
+void json_out_init(/*@out@*/struct json_out_t *, char *, size_t);
+void json_out_resume(/*@out@*/struct json_out_t *, char *, size_t);
+void json_out_mem(struct json_out_t *, const char *, size_t);
+void json_out_raw(struct json_out_t *, const char *);
+void json_out_char(struct json_out_t *, char);
+void json_out_uint_pad(struct json_out_t *, unsigned long long, int);
+void json_out_uint(struct json_out_t *, unsigned long long);
+void json_out_int(struct json_out_t *, long long);
+void json_out_int_pad(struct json_out_t *, long long, int);
+void json_out_fixed(struct json_out_t *, double, int);
+void json_out_fixed_pad(struct json_out_t *, double, int, int);
+void json_out_dm(struct json_out_t *, double, int);
+void json_out_scaled(struct json_out_t *, long long, int);
+void json_out_string(struct json_out_t *, const char *);
+void json_out_printf(struct json_out_t *, const char *, ...);
+void json_out_trim(struct json_out_t *);
+void json_out_key(struct json_out_t *, const char *);
+void json_out_member_raw(struct json_out_t *, const char *, const char *);
+void json_out_member_str(struct json_out_t *, const char *, const char *);
+void json_out_member_string(struct json_out_t *, const char *, const char *);
+void json_out_member_int(struct json_out_t *, const char *, long long);
+void json_out_member_uint(struct json_out_t *, const char *,
+			  unsigned long long);
+void json_out_member_fixed(struct json_out_t *, const char *, double, int);
+void json_out_member_scaled(struct json_out_t *, const char *, long long, int);
+void json_out_member_bool(struct json_out_t *, const char *, bool);
 #ifdef __cplusplus
 }
 #endif
@@ -182,7 +182,6 @@ uint32_t last_bytes_send_second = 0,
 
 const char *gpsd_canboatdump(char *scbuf, size_t scbuflen, struct gps_device_t *device);
 
-static int max_subscriber_loglevel = LOG_ERROR - 1; // -1 is LOG_ERROR
 static void set_max_subscriber_loglevel(void);
 
 static volatile sig_atomic_t signalled;
@@ -207,12 +206,12 @@ ssize_t gpsd_write(struct gps_device_t *session,
 void gpsd_external_report(const int debuglevel, const int errlevel,
      const char *fmt, ...)
 {
-    if((debuglevel < errlevel) && (max_subscriber_loglevel < errlevel))
+    if((debuglevel < errlevel) && (gpsd_log_sublevel[LOG_SUB_CORE] < errlevel))
       return;
 
     va_list ap;
     va_start(ap, fmt);
-    gpsd_labeled_report(debuglevel, max_subscriber_loglevel, errlevel, "gpsd:", fmt, ap);
+    gpsd_labeled_report(debuglevel, gpsd_log_sublevel[LOG_SUB_CORE], errlevel, "gpsd:", fmt, ap);
     va_end(ap);
 }
 
@@ -287,8 +286,16 @@ static void usage(void)
 #ifndef FORCE_GLOBAL_ENABLE
 "  -G         		    = make gpsd listen on INADDR_ANY\n"
 #endif /* FORCE_GLOBAL_ENABLE */
-"  -P pidfile	      	    = set file to record process ID \n\
-  -D integer (default 0)    = set debug level \n\
+"  -P pidfile	      	    = set file to record process ID \n"
+"  -B packets[,usec]	    = per-device budget for one poll pass (0 = none)\n"
+#ifdef TRACE_ENABLE
+"  -T			    = record binary event trace for gpstrace\n"
+#endif /* TRACE_ENABLE */
+#ifdef INGEST_THREADS_ENABLE
+"  -r			    = read and decode each device in its own thread\n"
+"  -A cpu[,cpu...]	    = pin reader threads to these CPUs\n"
+#endif /* INGEST_THREADS_ENABLE */
+"  -D integer (default 0)    = set debug level \n\
   -S integer (default %s) = set port for daemon \n\
   -h		     	    = help message \n\
   -V			    = emit version and exit.\n\
@@ -341,6 +348,14 @@ static struct vessel_t vessel;
 
 static struct gps_device_t devices[MAXDEVICES];
 
+#ifdef INGEST_THREADS_ENABLE
+static bool ingest_threads = false;	/* -r given */
+static bool ingest_running = false;	/* reader threads take new devices */
+static int ingest_cpus[MAXDEVICES];	/* -A list, assigned round robin */
+static int ingest_ncpus = 0;
+static int ingest_pipe[2] = {-1, -1};	/* readers wake the main loop */
+#endif /* INGEST_THREADS_ENABLE */
+
 static void adjust_max_fd(int fd, bool on)
 /* track the largest fd currently in use */
 {
@@ -369,6 +384,59 @@ static void adjust_max_fd(int fd, bool on)
 #endif /* !defined(LIMITED_MAX_DEVICES) && !defined(LIMITED_MAX_CLIENT_FD) */
 }
 
+static int sched_order(struct gps_device_t **order)
+/* allocated devices in service order: by class, round robin within one */
+{
+    static const int rank[SCHED_CLASSES] = {
+        1,	/* SCHED_NORMAL */
+        0,	/* SCHED_REALTIME */
+        2,	/* SCHED_BULK */
+    };
+    static unsigned int turn = 0;
+    int n = 0, r, i;
+
+    turn++;
+    for (r = 0; r < SCHED_CLASSES; r++)
+        for (i = 0; i < MAXDEVICES; i++) {
+            struct gps_device_t *devp = &devices[(i + turn) % MAXDEVICES];
+            if (allocated_device(devp) && rank[devp->sched.class] == r)
+                order[n++] = devp;
+        }
+    return n;
+}
+
+static bool sched_carry(void)
+/* does some device still have buffered input from the last pass? */
+{
+    struct gps_device_t *devp;
+
+    for (devp = devices; devp < devices + MAXDEVICES; devp++) {
+#ifdef INGEST_THREADS_ENABLE
+        if (devp->ingest != NULL)
+            continue;	/* its reader thread takes care of that */
+#endif /* INGEST_THREADS_ENABLE */
+        if (allocated_device(devp) && devp->sched.pending)
+            return true;
+    }
+    return false;
+}
+
+static void watch_device(struct gps_device_t *device)
+/* have a reader thread, or else the main loop, wait for device input */
+{
+#ifdef INGEST_THREADS_ENABLE
+    if (ingest_running) {
+        int slot = (int)(device - devices);
+        int cpu = ingest_ncpus > 0 ? ingest_cpus[slot % ingest_ncpus] : -1;
+
+        if (ingest_start(device, cpu, ingest_pipe[1]))
+            return;
+    }
+#endif /* INGEST_THREADS_ENABLE */
+    FD_SET(device->gpsdata.gps_fd, &all_fds);
+    adjust_max_fd(device->gpsdata.gps_fd, true);
+}
+
 #ifdef SOCKET_EXPORT_ENABLE
 #ifndef IPTOS_LOWDELAY
 #define IPTOS_LOWDELAY 0x10
@@ -643,6 +711,7 @@ struct subscriber_t
     int fd;			/* client file descriptor. -1 if unused */
     timestamp_t active;		/* when subscriber last polled for data */
     struct policy_t policy;	/* configurable bits */
+    timestamp_t targets_sent;	/* last AIS target delta shipped */
     pthread_mutex_t mutex;	/* serialize access to fd */
 
     enum wsState state;
@@ -690,9 +759,15 @@ static /*@null@*//*@observer@ */ struct subscriber_t *allocate_client(void)
             subscribers[si].policy.canboat   = false;
             subscribers[si].policy.watcher   = true;
             subscribers[si].policy.json      = false;
+            subscribers[si].policy.binary    = false;
+            subscribers[si].policy.targets   = 0;
+            subscribers[si].targets_sent     = 0;
+            subscribers[si].policy.cpa       = false;
             subscribers[si].policy.signalk   = false;
             subscribers[si].policy.protocol  = tcp;
             subscribers[si].policy.loglevel  = LOG_ERROR - 1;
+            subscribers[si].policy.logmask   = 0;
+            subscribers[si].policy.stats     = false;
 
             subscribers[si].state = WS_STATE_OPENING;
             subscribers[si].frameType = WS_INCOMPLETE_FRAME;
@@ -725,6 +800,9 @@ static void detach_client(struct subscriber_t *sub)
     sub->active         = (timestamp_t)0;
     sub->policy.watcher = false;
     sub->policy.json    = false;
+    sub->policy.binary  = false;
+    sub->policy.targets = 0;
+    sub->policy.cpa     = false;
     sub->policy.signalk = false;
     sub->policy.nmea    = false;
     sub->policy.canboat = false;
@@ -734,6 +812,8 @@ static void detach_client(struct subscriber_t *sub)
     sub->policy.split24 = false;
     sub->policy.protocol = tcp;
     sub->policy.loglevel = LOG_ERROR - 1;
+    sub->policy.logmask = 0;
+    sub->policy.stats = false;
     sub->policy.devpath[0] = '\0';
 
     // websocket & http specific
@@ -791,6 +871,7 @@ static ssize_t throttled_write_(struct subscriber_t *sub, const char *buf,
     gpsd_acquire_reporting_lock();
 #endif /* PPS_ENABLE */
     status = send(sub->fd, buf, len, 0);
+    TRACE_EVENT(TRACE_WRITE, TRACE_NODEV, sub_index(sub), status);
 #if defined(PPS_ENABLE)
     gpsd_release_reporting_lock();
 
@@ -830,9 +911,21 @@ ssize_t throttled_write(struct subscriber_t *sub, const char *buf,
       return throttled_write_(sub, buf, len);
 }
 
+/*
+ * Untagged messages go to every log subscriber, subsystem messages
+ * to those that gave no sub= list or named the subsystem in it.
+ */
+#define sub_logs(sub, subsys) ((subsys) == LOG_SUB_CORE \
+			       || ((sub)->policy.logmask & LOG_SUBMASK(subsys)) != 0)
+
 static void set_max_subscriber_loglevel() {
 
-  int dl = 0;
+  int subsys;
+  int dl[LOG_SUB_COUNT];
+
+  dl[LOG_SUB_CORE] = 0;
+  for (subsys = LOG_SUB_CORE + 1; subsys < LOG_SUB_COUNT; subsys++)
+    dl[subsys] = LOG_ERROR - 1;
 
   struct subscriber_t *sub;
   for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
@@ -840,23 +933,33 @@ static void set_max_subscriber_loglevel() {
     if (sub == NULL || sub->active == 0)
       continue;
 
-    if(dl < sub->policy.loglevel)
-      dl = sub->policy.loglevel;
+    for (subsys = LOG_SUB_CORE; subsys < LOG_SUB_COUNT; subsys++)
+      if(sub_logs(sub, subsys) && dl[subsys] < sub->policy.loglevel)
+        dl[subsys] = sub->policy.loglevel;
   }
 
-  max_subscriber_loglevel = dl;
+  for (subsys = LOG_SUB_CORE; subsys < LOG_SUB_COUNT; subsys++)
+    gpsd_log_sublevel[subsys] = dl[subsys];
 }
 
 
-void gpsd_throttled_report(const int errlevel, const char * buf) {
+void gpsd_throttled_report(const int subsys, const int errlevel,
+                           const char * buf) {
 
   struct subscriber_t *sub;
+
+#ifdef INGEST_THREADS_ENABLE
+  /* a reader thread must not write to clients; the main loop does it */
+  if (ingest_log(subsys, errlevel, buf))
+    return;
+#endif /* INGEST_THREADS_ENABLE */
+
   for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
     /*@-nullderef@*/
     if (sub == NULL || sub->active == 0)
       continue;
 
-    if(errlevel <= sub->policy.loglevel) {
+    if(errlevel <= sub->policy.loglevel && sub_logs(sub, subsys)) {
       (void)throttled_write(sub, buf, strlen(buf));
     }
   }
@@ -891,6 +994,9 @@ static void deactivate_device(struct gps_device_t *device)
         "{\"class\":\"DEVICE\",\"path\":\"%s\",\"activated\":0}\r\n",
         device->gpsdata.dev.path);
 #endif /* SOCKET_EXPORT_ENABLE */
+#ifdef INGEST_THREADS_ENABLE
+    ingest_stop(device);
+#endif /* INGEST_THREADS_ENABLE */
     if (!BAD_SOCKET(device->gpsdata.gps_fd)) {
     FD_CLR(device->gpsdata.gps_fd, &all_fds);
     adjust_max_fd(device->gpsdata.gps_fd, false);
@@ -901,6 +1007,10 @@ static void deactivate_device(struct gps_device_t *device)
 #endif /* NTPSHM_ENABLE */
     gpsd_deactivate(device);
     }
+#ifdef SHM_EXPORT_ENABLE
+    shm_deactivate(&context, device->gpsdata.dev.path);
+    ring_deactivate(&context, device->gpsdata.dev.path);
+#endif /* SHM_EXPORT_ENABLE */
 }
 
 #if defined(SOCKET_EXPORT_ENABLE) || defined(CONTROL_SOCKET_ENABLE)
@@ -942,8 +1052,7 @@ static bool open_device( /*@null@*/struct gps_device_t *device)
 
     gpsd_report(context.debug, LOG_INF,
     "device %s activated\n", device->gpsdata.dev.path);
-    FD_SET(device->gpsdata.gps_fd, &all_fds);
-    adjust_max_fd(device->gpsdata.gps_fd, true);
+    watch_device(device);
     return true;
 }
 
@@ -1178,8 +1287,7 @@ static bool awaken(struct gps_device_t *device)
         gpsd_report(context.debug, LOG_RAW,
     "flagging descriptor %d in assign_channel()\n",
     device->gpsdata.gps_fd);
-        FD_SET(device->gpsdata.gps_fd, &all_fds);
-        adjust_max_fd(device->gpsdata.gps_fd, true);
+        watch_device(device);
         return true;
     }
     }
@@ -1382,18 +1490,84 @@ static int gpsd_device_rejects(struct gps_device_t * devp) {
     return 0;
 }
 
-static void gpsd_device_write(struct gps_device_t * srcdev,
-                              enum frm_type_t frm_type,
-      const char *buf, size_t len) {
+static int outrate_kind(enum frm_type_t frm_type)
+/* which kind of paced output a frame type is, -1 if it is not paced */
+{
+    if (frm_type == FRM_TYPE_NMEA2000)
+        return OUTRATE_N2K;
+    if (frm_type == FRM_TYPE_NMEA0183)
+        return OUTRATE_NMEA;
+    return -1;
+}
 
+static void gpsd_device_output(struct gps_device_t *srcdev,
+                               struct gps_device_t *devp,
+                               enum frm_type_t frm_type,
+                               const char *buf, const size_t *lens,
+                               int count, timestamp_t now)
+/* write frames to one device, and count them against its load */
+{
+    const struct gps_type_t *dt = devp->device_type;
+    int kind = outrate_kind(frm_type);
+    const char *p;
+    int i;
+
+    if(dt->packet_type == VYSPI_PACKET) {
+
+        if(devp->context->readonly && (frm_type != FRM_TYPE_NMEA2000))
+            return;
+        (void)vyspi_write_batch(devp, frm_type,
+                                (const uint8_t *)buf, lens, count);
+
+    } else if(dt->packet_type == NMEA_PACKET) {
+
+        for (i = 0, p = buf; i < count; p += lens[i++]) {
+            (void)gpsd_write(devp, p, lens[i]);
+            gpsd_report(context.debug, LOG_IO,
+                        "gpsd_write: %.*s (%s > %s)\n", (int)lens[i], p,
+                        srcdev != NULL ? srcdev->gpsdata.dev.path : "held",
+                        devp->gpsdata.dev.path);
+        }
+
+    } else
+        return;
+
+    if(kind >= 0) {
+        /* CAN runs at 250kbit/s, NMEA 0183 at the port's speed */
+        if(kind == OUTRATE_N2K)
+            devp->outrate.kind[kind].capacity = 250000;
+        else if(dt->packet_type == NMEA_PACKET && devp->gpsdata.dev.baudrate > 0)
+            devp->outrate.kind[kind].capacity = devp->gpsdata.dev.baudrate;
+        else
+            devp->outrate.kind[kind].capacity = 4800;
+        outrate_count(&devp->outrate, kind, lens, count, now);
+    }
+}
+
+static void gpsd_device_write_batch(struct gps_device_t * srcdev,
+                                    enum frm_type_t frm_type,
+                                    const char *buf, const size_t *lens,
+                                    int count)
+/* hand count frames, packed back to back, to every device that takes them */
+{
     struct gps_device_t *devp;
+    int kind = outrate_kind(frm_type);
+    timestamp_t now = timestamp();
+    char paced[OUTRATE_BUF];
+    size_t pacedlens[OUTRATE_FRAMES];
+    int n;
+
     for (devp = devices; devp < devices + MAXDEVICES; devp++) {
 
     if (allocated_device(devp)) {
 
+    /* its reader thread may be re-initialising or writing to it */
+    ingest_lock(devp);
+
     if(gpsd_device_rejects(devp)) {
                 gpsd_report(context.debug, LOG_RAW,
                             "gpsd_write to device %s rejected\n", devp->gpsdata.dev.path);
+                ingest_unlock(devp);
                 continue;
             }
 
@@ -1401,26 +1575,114 @@ static void gpsd_device_write(struct gps_device_t * srcdev,
     "gpsd_write to device %s accepted\n", devp->gpsdata.dev.path);
 
     const struct gps_type_t *dt = devp->device_type;
-    if(dt == NULL) continue;
+    if(dt == NULL) {
+        ingest_unlock(devp);
+        continue;
+    }
 
     if(gpsd_device_forward(srcdev, devp)) {
 
-                if(dt->packet_type == VYSPI_PACKET) {
-
-                    if(!devp->context->readonly || (frm_type == FRM_TYPE_NMEA2000))
-                        (void)vyspi_write(devp, frm_type, buf, (size_t)len);
+        /* what this output has just had is held back for later */
+        n = kind < 0 ? -1 :
+            outrate_pace(&devp->outrate, context.outrate,
+                         (int)(devp - devices), kind, buf, lens, count,
+                         paced, pacedlens, now);
+        if(n < 0)
+            gpsd_device_output(srcdev, devp, frm_type, buf, lens, count, now);
+        else if(n > 0)
+            gpsd_device_output(srcdev, devp, frm_type,
+                               paced, pacedlens, n, now);
+    }
+    ingest_unlock(devp);
+    }
+    }
+}
 
-                } else if(dt->packet_type == NMEA_PACKET) {
+static void outrate_report(void)
+/* send the frames held back whose time has come */
+{
+    struct gps_device_t *devp;
+    timestamp_t now = timestamp();
+    char buf[OUTRATE_BUF];
+    size_t lens[OUTRATE_FRAMES];
+    int n;
 
-    (void)gpsd_write(devp, buf, (size_t)len);
-    gpsd_report(context.debug, LOG_IO,
-    "gpsd_write: %s (%s > %s)\n", buf,
-    srcdev->gpsdata.dev.path, devp->gpsdata.dev.path);
+    for (devp = devices; devp < devices + MAXDEVICES; devp++) {
+        timestamp_t wake;
 
+        if (!allocated_device(devp) || devp->device_type == NULL)
+            continue;
+        wake = outrate_wake(&devp->outrate);
+        if (wake == 0 || wake > now)
+            continue;
+        ingest_lock(devp);
+        if ((n = outrate_due(&devp->outrate, OUTRATE_N2K, buf, lens, now)) > 0)
+            gpsd_device_output(NULL, devp, FRM_TYPE_NMEA2000,
+                               buf, lens, n, now);
+        if ((n = outrate_due(&devp->outrate, OUTRATE_NMEA, buf, lens, now)) > 0)
+            gpsd_device_output(NULL, devp, FRM_TYPE_NMEA0183,
+                               buf, lens, n, now);
+        ingest_unlock(devp);
     }
+}
+
+static void n2k_node_report(void)
+/* run the timers of the NMEA 2000 nodes the main loop looks after */
+{
+    struct gps_device_t *devp;
+    timestamp_t now = timestamp();
+
+    for (devp = devices; devp < devices + MAXDEVICES; devp++) {
+        timestamp_t wake;
+
+        if (!allocated_device(devp) || devp->ingest != NULL)
+            continue;
+        wake = n2k_node_wake(&devp->n2k);
+        if (wake != 0 && wake <= now)
+            n2k_node_tick(devp, now);
     }
+}
+
+static double n2k_node_timeout(double timeout)
+/* shorten a select() timeout to when the next node timer runs out */
+{
+    struct gps_device_t *devp;
+    timestamp_t now = timestamp();
+
+    for (devp = devices; devp < devices + MAXDEVICES; devp++) {
+        timestamp_t wake;
+
+        if (!allocated_device(devp) || devp->ingest != NULL)
+            continue;
+        wake = n2k_node_wake(&devp->n2k);
+        if (wake != 0 && wake - now < timeout)
+            timeout = wake > now ? wake - now : 0.0;
     }
+    return timeout;
+}
+
+static double outrate_timeout(double timeout)
+/* shorten a select() timeout to when the next held frame is due */
+{
+    struct gps_device_t *devp;
+    timestamp_t now = timestamp();
+
+    for (devp = devices; devp < devices + MAXDEVICES; devp++) {
+        timestamp_t wake;
+
+        if (!allocated_device(devp))
+            continue;
+        wake = outrate_wake(&devp->outrate);
+        if (wake != 0 && wake - now < timeout)
+            timeout = wake > now ? wake - now : 0.0;
     }
+    return timeout;
+}
+
+static void gpsd_device_write(struct gps_device_t * srcdev,
+                              enum frm_type_t frm_type,
+      const char *buf, size_t len) {
+    gpsd_device_write_batch(srcdev, frm_type, buf, &len, 1);
 }
 
 static void gpsd_udp_write(const char *buf, size_t len) {
@@ -1459,10 +1721,10 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
     struct handshake hs;
     nullHandshake(&hs);
 
-//    gpsd_report(context.debug, LOG_INF, "incomming frame: %s\n", buf);
+//    GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug, "incomming frame: %s\n", buf);
 
     if (sub->state == WS_STATE_OPENING) {
-        gpsd_report(context.debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                     "Handling a HTTP handshake.\n");
         sub->frameType = wsParseHandshake((uint8_t *)buf, 0, &hs);
         if(sub->frameType == WS_PREFLIGHTED_FRAME) {
@@ -1477,24 +1739,24 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
                            "Date: Wed, 20 Jan 2016 12:39:21 GMT\r\n"
                            "Connection: keep-alive\r\n\r\n");
 
-            gpsd_report(context.debug, LOG_INF,
+            GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                         "returning OPTIONS: %s\n", reply);
             return throttled_write(sub, reply, len);
         }
     } else {
         sub->frameType = wsParseInputFrame(buf, 0, &data, &dataSize);
-        gpsd_report(context.debug, LOG_INF,
+        GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                     "incoming frame with %s\n", data);
     }
 
     if (sub->frameType == WS_INCOMPLETE_FRAME) {
-        gpsd_report(context.debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_WS, LOG_ERROR, context.debug,
                     "Incomplete frame or buffer too small\n");
         return 0;
     }
 
     if(sub->frameType == WS_ERROR_FRAME) {
-        gpsd_report(context.debug, LOG_ERROR,
+        GPSD_SUBLOG(LOG_SUB_WS, LOG_ERROR, context.debug,
                     "Error in incoming frame\n");
 
         if (sub->state == WS_STATE_OPENING) {
@@ -1523,18 +1785,23 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
             bool raw     = 0;
             bool nmea    = false;
             bool signalk = false;
+            bool n2kbus  = false;
             bool track   = false;
             int debug    = 0;
+            int level    = 5;
+            unsigned int logmask = LOG_SUBMASK_ALL;	/* sub= narrows it */
+            bool stats   = false;
+            int n2ksource = -1;
             uint32_t startAfter = 0;
             char field[255];
             uint8_t pcnt = 0;
 
-            gpsd_report(context.debug, LOG_INF,
+            GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                         "incoming resource request with %s\n", hs.resource);
 
             while((hs.params[pcnt].param[0] != '\0')
                   && (pcnt < WS_MAX_PARAM_NO)) {
-                gpsd_report(context.debug, LOG_INF,
+                GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                             "parameter %s = %s\n",
                             hs.params[pcnt].param,
                             hs.params[pcnt].value);
@@ -1544,6 +1811,14 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
                     startAfter = atol(hs.params[pcnt].value);
                 if(strncmp(hs.params[pcnt].param, "field", 10) == 0)
                     strncpy(field, hs.params[pcnt].value, 254);
+                if(strcmp(hs.params[pcnt].param, "level") == 0)
+                    level = atoi(hs.params[pcnt].value);
+                if(strcmp(hs.params[pcnt].param, "sub") == 0)
+                    logmask = gpsd_log_submask(hs.params[pcnt].value);
+                if(strcmp(hs.params[pcnt].param, "stats") == 0)
+                    stats = atoi(hs.params[pcnt].value) != 0;
+                if(strcmp(hs.params[pcnt].param, "src") == 0)
+                    n2ksource = atoi(hs.params[pcnt].value);
                 pcnt++;
             }
 
@@ -1556,21 +1831,18 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
             } else if (strcmp(hs.resource, "/raw") == 0) {
                 raw = 1;
                 nmea = true;
+            } else if (strcmp(hs.resource, "/n2k") == 0) {
+                n2kbus = true;
             } else if (strncmp(hs.resource, "/debug", 6) == 0) {
 
-                debug = 5;
-                if(strlen(hs.resource) >= 14) {
-                    if(strncmp(hs.resource + 6, "?level=", 7) == 0) {
-                        debug = atoi(hs.resource + 13);
-                        gpsd_report(context.debug, LOG_INF,
-                                    "incoming resource request with loglevel %d\n",
-                                    debug);
-                    }
-                }
+                debug = level;
+                GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
+                            "incoming resource request with loglevel %d, subsystems %#x\n",
+                            debug, logmask);
 
 
             } else {
-                gpsd_report(context.debug, LOG_INF,
+                GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                             "404 Not Found: %s\n", hs.resource);
                 len = snprintf((char *)reply, replylen,
                                "HTTP/1.1 404 Not Found\r\n\r\n");
@@ -1602,11 +1874,16 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
             */
 
             sub->policy.json      = false;
+            sub->policy.binary    = false;
             sub->policy.signalk   = signalk;
             sub->policy.nmea      = nmea;
             sub->policy.watcher   = true;
             sub->policy.raw       = raw;
             sub->policy.loglevel  = debug;
+            sub->policy.logmask   = logmask;
+            sub->policy.stats     = debug > 0 && stats;
+            sub->policy.n2kbus    = n2kbus;
+            sub->policy.n2ksource = n2ksource;
             set_max_subscriber_loglevel();
 
             if(sub->frameType == WS_GET_FRAME) {
@@ -1626,7 +1903,7 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
                                "Access-Control-Allow-Origin: *\r\n"
                                "Content-Type: application/json\r\n\r\n%s",
                                strlen(content), content);
-                gpsd_report(context.debug, LOG_INF,
+                GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                             "returning GET (%lu): %s\n", replylen, reply);
 
                 sub->policy.protocol  = http;
@@ -1646,7 +1923,7 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
 
             sub->state = WS_STATE_NORMAL;
             sub->frameType = WS_INCOMPLETE_FRAME;
-            gpsd_report(context.debug, LOG_INF,
+            GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug,
                         "answering handshake to %sclient: %s\n",
                         "ws", reply);
             return status;
@@ -1654,7 +1931,7 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
     } else {
         if (sub->frameType == WS_CLOSING_FRAME) {
             sub->policy.protocol = tcp;
-            gpsd_report(context.debug, LOG_INF, "closing frame\n");
+            GPSD_SUBLOG(LOG_SUB_WS, LOG_INF, context.debug, "closing frame\n");
             if (sub->state == WS_STATE_CLOSING) {
                 return -1;
             } else {
@@ -1677,6 +1954,356 @@ static ssize_t handle_websocket_request(struct subscriber_t *sub,
     return -1;
 }
 
+/*
+ * Read-to-send latency bookkeeping.  all_reports() records which device
+ * and kind of message is being shipped; report_write() charges the time
+ * since that device's last input read to the device, the message class
+ * and the output format.
+ */
+enum report_class {class_tpv, class_sky, class_att, class_env, class_nav,
+                   class_ais, class_other, class_count};
+enum report_format {format_json, format_nmea, format_raw, format_canboat,
+                    format_signalk, format_binary, format_count};
+
+static const char *report_class_names[class_count] = {
+    "TPV", "SKY", "ATT", "ENV", "NAV", "AIS", "OTHER",
+};
+static const char *report_format_names[format_count] = {
+    "json", "nmea", "raw", "canboat", "signalk", "binary",
+};
+
+#ifdef AIVDM_ENABLE
+static struct ais_targets_t ais_targets;
+static struct ais_cpa_t ais_cpa;
+#endif /* AIVDM_ENABLE */
+static struct nmea_xform_t xform;
+static struct outrate_rules_t outrate_rules;
+static struct n2k_bus_t n2k_bus;
+static struct arbiter_t arbiter;
+static struct derive_t derive;
+
+static struct latency_t class_latency[class_count];
+static struct latency_t format_latency[format_count];
+static /*@null@*/struct gps_device_t *report_device;
+static enum report_class report_class;
+
+static enum report_class classify_report(gps_mask_t changed)
+{
+    if ((changed & AIS_SET) != 0)
+        return class_ais;
+    if ((changed & ATTITUDE_SET) != 0)
+        return class_att;
+    if ((changed & ENVIRONMENT_SET) != 0)
+        return class_env;
+    if ((changed & NAVIGATION_SET) != 0)
+        return class_nav;
+    if ((changed & SATELLITE_SET) != 0)
+        return class_sky;
+    if ((changed & (REPORT_IS | LATLON_SET | TIME_SET)) != 0)
+        return class_tpv;
+    return class_other;
+}
+
+static ssize_t report_write(struct subscriber_t *sub,
+                            enum report_format format,
+                            const char *buf, size_t len)
+/* ship a report to a subscriber, accounting its latency */
+{
+    ssize_t status = throttled_write(sub, buf, len);
+
+    if (status > 0 && report_device != NULL
+        && report_device->packet.rx_ns != 0) {
+        uint64_t lat = monotonic_ns() - report_device->packet.rx_ns;
+        latency_add(&report_device->latency, lat);
+        latency_add(&class_latency[report_class], lat);
+        latency_add(&format_latency[format], lat);
+    }
+    return status;
+}
+
+/* room json_stats_dump() keeps for closing the reply after an entry */
+#define STATS_TAIL	128
+
+static bool stats_entry_fits(char *reply, size_t replylen, size_t mark)
+/* take back the entry written after mark unless the reply can still close */
+{
+    if (strlen(reply) + STATS_TAIL < replylen)
+        return true;
+    reply[mark] = '\0';
+    return false;
+}
+
+static void json_stats_dump(char *reply, size_t replylen)
+/* dump p50/p99/max latencies per device, message class and format */
+{
+    struct gps_device_t *devp;
+    double busy = 0, busy2 = 0;
+    int i, contended = 0;
+    bool truncated = false;
+    size_t mark;
+
+    (void)strlcpy(reply, "{\"class\":\"STATS\",\"unit\":\"us\",\"devices\":[",
+                  replylen);
+    for (devp = devices; devp < devices + MAXDEVICES; devp++)
+        if (allocated_device(devp)) {
+            /* devices that ran into their budget compete for the loop */
+            if (devp->sched.cut > 0) {
+                busy += devp->sched.busy_ns;
+                busy2 += (double)devp->sched.busy_ns * devp->sched.busy_ns;
+                contended++;
+            }
+            if (truncated)
+                continue;
+            mark = strlen(reply);
+            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+                           "{\"path\":\"%s\",", devp->gpsdata.dev.path);
+            (void)latency_json_dump(&DEVICE_VIEW(devp)->latency,
+                                    reply, replylen);
+            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+                           ",\"sched\":{\"class\":\"%s\",\"packets\":%lu,"
+                           "\"passes\":%lu,\"cut\":%lu,\"busy\":%.1f,"
+                           "\"maxpass\":%.1f},",
+                           sched_class_names[devp->sched.class],
+                           devp->sched.packets, devp->sched.passes,
+                           devp->sched.cut, devp->sched.busy_ns / 1e3,
+                           devp->sched.max_pass_ns / 1e3);
+            /* and what we write to it */
+            (void)strlcat(reply, "\"output\":", replylen);
+            (void)outrate_json_dump(&devp->outrate, reply, replylen);
+            (void)strlcat(reply, "},", replylen);
+            truncated = !stats_entry_fits(reply, replylen, mark);
+        }
+    if (reply[strlen(reply) - 1] == ',')
+        reply[strlen(reply) - 1] = '\0';
+    /* Jain's index over the loop time the competing devices got */
+    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+                   "],\"fairness\":%.3f,\"messages\":[",
+                   contended > 1 ? busy * busy / (contended * busy2) : 1.0);
+    for (i = 0; i < class_count && !truncated; i++)
+        if (class_latency[i].count > 0) {
+            mark = strlen(reply);
+            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+                           "{\"type\":\"%s\",", report_class_names[i]);
+            (void)latency_json_dump(&class_latency[i], reply, replylen);
+            (void)strlcat(reply, "},", replylen);
+            truncated = !stats_entry_fits(reply, replylen, mark);
+        }
+    if (reply[strlen(reply) - 1] == ',')
+        reply[strlen(reply) - 1] = '\0';
+    (void)strlcat(reply, "],\"formats\":[", replylen);
+    for (i = 0; i < format_count && !truncated; i++)
+        if (format_latency[i].count > 0) {
+            mark = strlen(reply);
+            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+                           "{\"format\":\"%s\",", report_format_names[i]);
+            (void)latency_json_dump(&format_latency[i], reply, replylen);
+            (void)strlcat(reply, "},", replylen);
+            truncated = !stats_entry_fits(reply, replylen, mark);
+        }
+    if (reply[strlen(reply) - 1] == ',')
+        reply[strlen(reply) - 1] = '\0';
+    /* which device each data item is published from */
+    (void)strlcat(reply, "],\"sources\":[", replylen);
+    for (i = 0; i < arbiter_items && !truncated; i++)
+        if (arbiter.item[i].device >= 0) {
+            const struct arbiter_source_t *src = &arbiter.item[i];
+
+            mark = strlen(reply);
+            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+                           "{\"item\":\"%s\",\"path\":\"%s\","
+                           "\"updates\":%lu,\"switches\":%lu,"
+                           "\"age\":%.1f},",
+                           arbiter_item_name(i),
+                           devices[src->device].gpsdata.dev.path,
+                           src->updates, src->switches,
+                           timestamp() - src->last);
+            truncated = !stats_entry_fits(reply, replylen, mark);
+        }
+    if (reply[strlen(reply) - 1] == ',')
+        reply[strlen(reply) - 1] = '\0';
+    /* say what did not fit, as the N2K bus dumps do */
+    (void)strlcat(reply, truncated ? "],\"truncated\":true}\r\n" : "]}\r\n",
+                  replylen);
+}
+
+#ifdef AIVDM_ENABLE
+static void cpa_report(int slot, timestamp_t now)
+/* raise and clear collision alarms for one target, or all if slot < 0 */
+{
+    struct ais_cpa_event_t ev[32];
+    struct subscriber_t *sub;
+    char buf[GPS_JSON_RESPONSE_MAX];
+    char sk[GPS_JSON_RESPONSE_MAX];
+    int i, n;
+
+    do {
+        n = ais_cpa_changes(&ais_cpa, &ais_targets, slot, now,
+                            ev, (int)(sizeof(ev) / sizeof(ev[0])));
+        for (i = 0; i < n; i++) {
+            const struct ais_target_t *tp = &ais_targets.target[ev[i].slot];
+            bool named = tp->mmsi == ev[i].mmsi && tp->shipname[0] != '\0';
+
+            gpsd_report(context.debug, LOG_INF,
+                        "CPA %s for %u: %.0f m in %.0f s\n",
+                        ev[i].alarm ? "alarm" : "clear", ev[i].mmsi,
+                        ev[i].cpa, ev[i].tcpa);
+            json_cpa_dump(&ev[i], tp, buf, sizeof(buf));
+            signalk_cpa_dump(&vessel, &ev[i], named ? tp->shipname : NULL,
+                             sk, sizeof(sk));
+            for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
+                if (sub->active == 0 || !sub->policy.watcher)
+                    continue;
+                if (sub->policy.cpa)
+                    (void)throttled_write(sub, buf, strlen(buf));
+                if (sub->policy.signalk && sub->policy.protocol != http)
+                    (void)throttled_write(sub, sk, strlen(sk));
+            }
+        }
+        /* a full pass stops early when ev fills; go round for the rest */
+    } while (slot < 0 && n == (int)(sizeof(ev) / sizeof(ev[0])));
+}
+
+static void aistargets_query(struct subscriber_t *sub,
+                             const struct ais_target_query_t *query,
+                             char *reply, size_t replylen)
+/* ship the matching targets one per line, then a summary as the reply */
+{
+    static int slots[AIS_TARGET_MAX];
+    char buf[GPS_JSON_RESPONSE_MAX];
+    char tbuf[JSON_DATE_MAX+1];
+    int i, n;
+
+    n = ais_targets_select(&ais_targets, query, slots, AIS_TARGET_MAX);
+    for (i = 0; i < n; i++) {
+        json_aistarget_dump(&ais_targets.target[slots[i]], buf, sizeof(buf));
+        (void)throttled_write(sub, buf, strlen(buf));
+    }
+    (void)snprintf(reply, replylen,
+                   "{\"class\":\"AISTARGETS\",\"time\":\"%s\","
+                   "\"count\":%d,\"tracked\":%d}\r\n",
+                   unix_to_iso8601(timestamp(), tbuf, sizeof(tbuf)),
+                   n, ais_targets.count);
+}
+
+static void aistargets_report(void)
+/* expire quiet targets and stream what changed to clients that asked */
+{
+    static timestamp_t last;
+    timestamp_t now = timestamp();
+    struct subscriber_t *sub;
+    char buf[GPS_JSON_RESPONSE_MAX];
+    int i;
+
+    if (now - last < 1.0)
+        return;
+    last = now;
+    ais_targets_expire(&ais_targets, now);
+    for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
+        if (sub->active == 0 || sub->policy.targets <= 0
+            || now - sub->targets_sent < sub->policy.targets)
+            continue;
+        for (i = 0; i < AIS_TARGET_MAX; i++) {
+            const struct ais_target_t *tp = &ais_targets.target[i];
+
+            if (tp->mmsi != 0 && tp->changed > sub->targets_sent) {
+                json_aistarget_dump(tp, buf, sizeof(buf));
+                (void)throttled_write(sub, buf, strlen(buf));
+            }
+        }
+        /* evictions since a fresh subscriber's snapshot don't concern it */
+        if (sub->targets_sent > 0)
+            for (i = 0; i < AIS_TARGET_MAX; i++)
+                if (ais_targets.gone[i].mmsi != 0
+                    && ais_targets.gone[i].when > sub->targets_sent) {
+                    (void)snprintf(buf, sizeof(buf),
+                                   "{\"class\":\"TARGET\",\"mmsi\":%u,"
+                                   "\"gone\":true}\r\n",
+                                   ais_targets.gone[i].mmsi);
+                    (void)throttled_write(sub, buf, strlen(buf));
+                }
+        sub->targets_sent = now;
+    }
+    ais_cpa_batch(&ais_cpa, now);
+    cpa_report(-1, now);
+}
+
+static void cpa_query(struct subscriber_t *sub, char *reply, size_t replylen)
+/* ship the standing alarms one per line, then a summary as the reply */
+{
+    timestamp_t now = timestamp();
+    char buf[GPS_JSON_RESPONSE_MAX];
+    char tbuf[JSON_DATE_MAX+1];
+    int i, n = 0;
+
+    for (i = 0; i < AIS_TARGET_MAX; i++)
+        if (ais_cpa.alarm[i] != 0) {
+            struct ais_cpa_event_t ev;
+
+            ais_cpa_event(&ais_cpa, i, ais_cpa.alarm[i], now, &ev);
+            json_cpa_dump(&ev, &ais_targets.target[i], buf, sizeof(buf));
+            (void)throttled_write(sub, buf, strlen(buf));
+            n++;
+        }
+    (void)snprintf(reply, replylen,
+                   "{\"class\":\"CPALIST\",\"time\":\"%s\",\"own\":%s,"
+                   "\"cpa_limit\":%.0f,\"tcpa_limit\":%.0f,\"count\":%d}\r\n",
+                   unix_to_iso8601(now, tbuf, sizeof(tbuf)),
+                   ais_cpa.own_valid ? "true" : "false",
+                   ais_cpa.cpa_limit, ais_cpa.tcpa_limit, n);
+}
+#endif /* AIVDM_ENABLE */
+
+static void stats_report(void)
+/* push STATS once a second to /debug websockets that asked for it */
+{
+    static timestamp_t last;
+    timestamp_t now = timestamp();
+    struct subscriber_t *sub;
+    char buf[GPS_JSON_RESPONSE_MAX];
+
+    if (now - last < 1.0)
+        return;
+    last = now;
+    buf[0] = '\0';
+    for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
+        if (sub->active == 0 || !sub->policy.stats)
+            continue;
+        if (buf[0] == '\0')
+            json_stats_dump(buf, sizeof(buf));
+        (void)throttled_write(sub, buf, strlen(buf));
+    }
+}
+
+static void n2k_bus_report(void)
+/* push the bus registry once a second to /n2k websockets */
+{
+    static timestamp_t last;
+    timestamp_t now = timestamp();
+    struct subscriber_t *sub;
+    char buf[GPS_JSON_RESPONSE_MAX];
+    int src;
+
+    if (now - last < 1.0)
+        return;
+    last = now;
+    buf[0] = '\0';
+    for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
+        if (sub->active == 0 || !sub->policy.n2kbus)
+            continue;
+        if (sub->policy.n2ksource >= 0) {
+            /* the list is shared, a source is not */
+            src = sub->policy.n2ksource;
+            if (n2k_bus_json_source(&n2k_bus, src, now, buf, sizeof(buf)) > 0)
+                (void)throttled_write(sub, buf, strlen(buf));
+            buf[0] = '\0';
+            continue;
+        }
+        if (buf[0] == '\0')
+            (void)n2k_bus_json_dump(&n2k_bus, now, buf, sizeof(buf));
+        (void)throttled_write(sub, buf, strlen(buf));
+    }
+}
+
 static void handle_request(struct subscriber_t *sub,
        const char *buf, const char **after,
        char *reply, size_t replylen)
@@ -1708,10 +2335,17 @@ static void handle_request(struct subscriber_t *sub,
         if (*buf == ';') {
             ++buf;
         } else {
+            int targets = sub->policy.targets;
             int status = json_watch_read(buf + 1, &sub->policy, &end);
+            /* a newly enabled target stream starts with a full snapshot */
+            if (targets <= 0 && sub->policy.targets > 0)
+                sub->targets_sent = 0;
 #ifndef TIMING_ENABLE
             sub->policy.timing = false;
 #endif /* TIMING_ENABLE */
+            /* websocket frames are text; keep those clients on JSON */
+            if (isWebsocket(sub))
+                sub->policy.binary = false;
             if (end == NULL)
                 buf += strlen(buf);
             else {
@@ -1847,6 +2481,9 @@ static void handle_request(struct subscriber_t *sub,
     && (devconf.parity == DEVDEFAULT_PARITY)
     && (devconf.stopbits == DEVDEFAULT_STOPBITS);
 
+        /* keep a reader thread out while we reconfigure */
+        ingest_lock(device);
+
         /* interpret defaults */
         if (devconf.baudrate == DEVDEFAULT_BPS)
     devconf.baudrate =
@@ -1876,6 +2513,7 @@ static void handle_request(struct subscriber_t *sub,
     && dt->rate_switcher != NULL)
     if (dt->rate_switcher(device, devconf.cycle))
         device->gpsdata.dev.cycle = devconf.cycle;
+        ingest_unlock(device);
     }
         }
         /*@+branchstate@*/
@@ -1902,15 +2540,15 @@ static void handle_request(struct subscriber_t *sub,
         buf += 5;
         for (devp = devices; devp < devices + MAXDEVICES; devp++)
             if (allocated_device(devp) && subscribed(sub, devp))
-        if ((devp->observed & GPS_TYPEMASK) != 0)
+        if ((DEVICE_VIEW(devp)->observed & GPS_TYPEMASK) != 0)
             active++;
         (void)snprintf(reply, replylen,
                "{\"class\":\"POLL\",\"time\":\"%s\",\"active\":%d,\"tpv\":[",
                unix_to_iso8601(timestamp(), tbuf, sizeof(tbuf)), active);
         for (devp = devices; devp < devices + MAXDEVICES; devp++) {
             if (allocated_device(devp) && subscribed(sub, devp)) {
-                if ((devp->observed & GPS_TYPEMASK) != 0) {
-                    json_tpv_dump(devp, &sub->policy,
+                if ((DEVICE_VIEW(devp)->observed & GPS_TYPEMASK) != 0) {
+                    json_tpv_dump(DEVICE_VIEW(devp), &sub->policy,
                         reply + strlen(reply),
                         replylen - strlen(reply));
                         rstrip(reply);
@@ -1923,8 +2561,8 @@ static void handle_request(struct subscriber_t *sub,
         (void)strlcat(reply, "],\"gst\":[", replylen);
         for (devp = devices; devp < devices + MAXDEVICES; devp++) {
             if (allocated_device(devp) && subscribed(sub, devp)) {
-                if ((devp->observed & GPS_TYPEMASK) != 0) {
-                    json_noise_dump(&devp->gpsdata,
+                if ((DEVICE_VIEW(devp)->observed & GPS_TYPEMASK) != 0) {
+                    json_noise_dump(&DEVICE_VIEW(devp)->gpsdata,
                         reply + strlen(reply),
                         replylen - strlen(reply));
                     rstrip(reply);
@@ -1937,8 +2575,8 @@ static void handle_request(struct subscriber_t *sub,
         (void)strlcat(reply, "],\"sky\":[", replylen);
         for (devp = devices; devp < devices + MAXDEVICES; devp++) {
             if (allocated_device(devp) && subscribed(sub, devp)) {
-                if ((devp->observed & GPS_TYPEMASK) != 0) {
-                    json_sky_dump(&devp->gpsdata,
+                if ((DEVICE_VIEW(devp)->observed & GPS_TYPEMASK) != 0) {
+                    json_sky_dump(&DEVICE_VIEW(devp)->gpsdata,
                         reply + strlen(reply),
                         replylen - strlen(reply));
                     rstrip(reply);
@@ -1949,9 +2587,110 @@ static void handle_request(struct subscriber_t *sub,
         if (reply[strlen(reply) - 1] == ',')
             reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
             (void)strlcat(reply, "]}\r\n", replylen);
+#ifdef AIVDM_ENABLE
+    } else if (strncmp(buf, "AISTARGETS", 10) == 0
+           && (buf[10] == ';' || buf[10] == '=')) {
+        struct ais_target_query_t query;
+        int status = 0;
+
+        buf += 10;
+        query.minlat = query.minlon = query.maxlat = query.maxlon = NAN;
+        query.lat = query.lon = query.radius = NAN;
+        query.since = 0;
+        if (*buf == ';')
+            ++buf;
+        else {
+            status = json_aistargets_read(buf + 1, &query, &end);
+            if (end == NULL)
+                buf += strlen(buf);
+            else {
+                if (*end == ';')
+                    ++end;
+                buf = end;
+            }
+        }
+        if (status != 0) {
+            (void)snprintf(reply, replylen,
+                "{\"class\":\"ERROR\",\"message\":\"Invalid AISTARGETS: %s\"}\r\n",
+                json_error_string(status));
+            gpsd_report(context.debug, LOG_ERROR, "response: %s\n", reply);
+        } else
+            aistargets_query(sub, &query, reply, replylen);
+    } else if (strncmp(buf, "CPA", 3) == 0
+           && (buf[3] == ';' || buf[3] == '=')) {
+        double cpa_limit = ais_cpa.cpa_limit, tcpa_limit = ais_cpa.tcpa_limit;
+        int status = 0;
+
+        buf += 3;
+        if (*buf == ';')
+            ++buf;
+        else {
+            status = json_cpa_read(buf + 1, &cpa_limit, &tcpa_limit, &end);
+            if (end == NULL)
+                buf += strlen(buf);
+            else {
+                if (*end == ';')
+                    ++end;
+                buf = end;
+            }
+        }
+        if (status == 0 && (cpa_limit <= 0 || tcpa_limit <= 0))
+            (void)snprintf(reply, replylen,
+                "{\"class\":\"ERROR\",\"message\":\"Invalid CPA: limits must be positive\"}\r\n");
+        else if (status != 0) {
+            (void)snprintf(reply, replylen,
+                "{\"class\":\"ERROR\",\"message\":\"Invalid CPA: %s\"}\r\n",
+                json_error_string(status));
+            gpsd_report(context.debug, LOG_ERROR, "response: %s\n", reply);
+        } else {
+            /* the limits are the daemon's; every watcher sees the result */
+            if (cpa_limit != ais_cpa.cpa_limit
+                || tcpa_limit != ais_cpa.tcpa_limit) {
+                timestamp_t now = timestamp();
+
+                ais_cpa.cpa_limit = cpa_limit;
+                ais_cpa.tcpa_limit = tcpa_limit;
+                ais_cpa_batch(&ais_cpa, now);
+                cpa_report(-1, now);
+            }
+            cpa_query(sub, reply, replylen);
+        }
+#endif /* AIVDM_ENABLE */
     } else if (strncmp(buf, "VERSION;", 8) == 0) {
         buf += 8;
         json_version_dump(reply, replylen);
+    } else if (strncmp(buf, "STATS;", 6) == 0) {
+        buf += 6;
+        json_stats_dump(reply, replylen);
+    } else if (strncmp(buf, "N2KDEVICES", 10) == 0
+           && (buf[10] == ';' || buf[10] == '=')) {
+        int src = -1, status = 0;
+
+        buf += 10;
+        if (*buf == ';')
+            ++buf;
+        else {
+            status = json_n2kdevices_read(buf + 1, &src, &end);
+            if (end == NULL)
+                buf += strlen(buf);
+            else {
+                if (*end == ';')
+                    ++end;
+                buf = end;
+            }
+        }
+        if (status != 0) {
+            (void)snprintf(reply, replylen,
+                "{\"class\":\"ERROR\",\"message\":\"Invalid N2KDEVICES: %s\"}\r\n",
+                json_error_string(status));
+            gpsd_report(context.debug, LOG_ERROR, "response: %s\n", reply);
+        } else if (src < 0)
+            (void)n2k_bus_json_dump(&n2k_bus, timestamp(), reply, replylen);
+        else if (n2k_bus_json_source(&n2k_bus, src, timestamp(),
+                                     reply, replylen) == 0)
+            (void)snprintf(reply, replylen,
+                "{\"class\":\"ERROR\",\"message\":\"No N2K source %d\"}\r\n",
+                src);
     } else {
         const char *errend;
         errend = buf + strlen(buf) - 1;
@@ -2023,7 +2762,7 @@ static void raw_report_write(struct subscriber_t *sub, struct gps_device_t *devi
 
     if (TEXTUAL_PACKET_TYPE(device->packet.type)
     && (sub->policy.raw > 0 || sub->policy.nmea)) {
-    (void)throttled_write(sub,
+    (void)report_write(sub, format_nmea,
       (char *)device->packet.outbuffer,
       device->packet.outbuflen);
     return;
@@ -2037,7 +2776,7 @@ static void raw_report_write(struct subscriber_t *sub, struct gps_device_t *devi
         for(cnt = 0; cnt < device->packet.out_count; cnt++) {
             if((device->packet.out_type[cnt] == FRM_TYPE_AIS)
                || (FRM_TYPE_NMEA0183 == device->packet.out_type[cnt])) {
-                (void)throttled_write(sub,
+                (void)report_write(sub, format_nmea,
                                       (char *)(device->packet.outbuffer + device->packet.out_offset[cnt]),
                                       device->packet.out_len[cnt]);
                 gpsd_report(context.debug, LOG_DATA,
@@ -2053,7 +2792,7 @@ static void raw_report_write(struct subscriber_t *sub, struct gps_device_t *devi
      * super-raw mode.
      */
     if (sub->policy.raw > 1) {
-        (void)throttled_write(sub,
+        (void)report_write(sub, format_raw,
                               (char *)device->packet.outbuffer,
                               device->packet.outbuflen);
         return;
@@ -2067,13 +2806,13 @@ static void raw_report_write(struct subscriber_t *sub, struct gps_device_t *devi
             const char * hd =
                 gpsd_canboatdump(device->msgbuf, sizeof(device->msgbuf),
                                  device);
-            (void)throttled_write(sub, (char *)hd, strlen(hd));
+            (void)report_write(sub, format_canboat, (char *)hd, strlen(hd));
         }
         if (sub->policy.raw == 1) {
             const char *hd = gpsd_vyspidump(device);
             if(strlen(hd) > 0) {
                 (void)strlcat((char *)hd, "\r\n", sizeof(device->msgbuf));
-                (void)throttled_write(sub, (char *)hd, strlen(hd));
+                (void)report_write(sub, format_raw, (char *)hd, strlen(hd));
             }
         }
     } else {
@@ -2086,7 +2825,7 @@ static void raw_report_write(struct subscriber_t *sub, struct gps_device_t *devi
                          (char *)device->packet.outbuffer,
                          device->packet.outbuflen);
             (void)strlcat((char *)hd, "\r\n", sizeof(device->msgbuf));
-            (void)throttled_write(sub, (char *)hd, strlen(hd));
+            (void)report_write(sub, format_raw, (char *)hd, strlen(hd));
         }
     }
 #endif /* BINARY_ENABLE */
@@ -2162,7 +2901,7 @@ static void pseudonmea_write(gps_mask_t changed,
             continue;
         if (sub->policy.watcher && sub->policy.nmea) {
             if (changed & DATA_IS) {
-                (void)throttled_write(sub, buf, len);
+                (void)report_write(sub, format_nmea, buf, len);
             }
         }
     }
@@ -2191,9 +2930,14 @@ static void pseudon2k_report(gps_mask_t changed,
         }
     } else go = 1;
 
-    if(go)
-        n2k_binary_dump(changed, device, gpsd_device_write);
-    else
+    if(go) {
+        static struct n2k_batch_t batch;
+
+        if(n2k_binary_dump(changed, device, &batch) > 0)
+            gpsd_device_write_batch(device, FRM_TYPE_NMEA2000,
+                                    (const char *)batch.buf, batch.len,
+                                    batch.count);
+    } else
         gpsd_report(context.debug, LOG_DATA,
                     "<= PSEUDON2K: no translatable data found.\n");
 }
@@ -2329,17 +3073,53 @@ static void signalk_report(gps_mask_t changed,
                 gpsd_external_report(context.debug, LOG_INF,
                                      "signalk update: %s\n",
                                      buf);
-                (void)throttled_write(sub, buf, strlen(buf));
+                (void)report_write(sub, format_signalk, buf, strlen(buf));
             }
         }
     }
 }
 
+static int device_slot(const struct gps_device_t *device)
+/* index in devices[] of a device or of its ingest view */
+{
+    struct gps_device_t *devp;
+
+    for (devp = devices; devp < devices + MAXDEVICES; devp++)
+        if (devp == device || DEVICE_VIEW(devp) == device)
+            return (int)(devp - devices);
+    return -1;
+}
+
 static void all_reports(struct gps_device_t *device, gps_mask_t changed)
 /* report on the corrent packet from a specified device */
 {
+    struct arbiter_saved_t saved;
+    struct derive_saved_t derived;
+    gps_mask_t published;
 #ifdef SOCKET_EXPORT_ENABLE
     struct subscriber_t *sub;
+#endif /* SOCKET_EXPORT_ENABLE */
+
+    TRACE_EVENT(TRACE_REPORT, device->gpsdata.gps_fd,
+                changed & 0xffffffff, changed >> 32);
+    report_device = device;
+    report_class = classify_report(changed);
+
+#ifdef AIVDM_ENABLE
+    if ((changed & AIS_SET) != 0) {
+        timestamp_t now = timestamp();
+        int slot;
+
+        (void)ais_targets_update(&ais_targets, &device->gpsdata.ais, now);
+        slot = ais_targets_lookup(&ais_targets, device->gpsdata.ais.mmsi);
+        if (slot >= 0 && ais_cpa.own_valid) {
+            ais_cpa_target(&ais_cpa, &ais_targets, slot, now);
+            cpa_report(slot, now);
+        }
+    }
+#endif /* AIVDM_ENABLE */
+
+#ifdef SOCKET_EXPORT_ENABLE
 
     /* add any just-identified device to watcher lists */
     if ((changed & DRIVER_IS) != 0) {
@@ -2447,7 +3227,7 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
          * make filtering decisiona.
          */
         for (dgnss = devices; dgnss < devices + MAXDEVICES; dgnss++)
-    if (dgnss != device)
+    if (dgnss != device && DEVICE_VIEW(dgnss) != device)
         netgnss_report(&context, device, dgnss);
     }
 #endif /* NETFEED_ENABLE */
@@ -2457,25 +3237,65 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
 #endif /* defined(DBUS_EXPORT_ENABLE) && !defined(S_SPLINT_S) */
     }
 
+#ifdef AIVDM_ENABLE
+    /* own ship moved: rescreen every target against the new fix */
+    if ((changed & REPORT_IS) != 0 && device->gpsdata.fix.mode >= MODE_2D) {
+        timestamp_t now = timestamp();
+        /* course and speed over ground come with the navigation data */
+        double course =
+            device->gpsdata.navigation.course_over_ground[compass_true];
+        double speed =
+            device->gpsdata.navigation.speed_over_ground * KNOTS_TO_MPS;
+
+        ais_cpa_own(&ais_cpa, &ais_targets, device->gpsdata.fix.latitude,
+                    device->gpsdata.fix.longitude, course, speed, now);
+        ais_cpa_batch(&ais_cpa, now);
+        cpa_report(-1, now);
+    }
+#endif /* AIVDM_ENABLE */
+
 #ifdef SHM_EXPORT_ENABLE
     if ((changed & (REPORT_IS|GST_SET|SATELLITE_SET|SUBFRAME_SET|
-        ATTITUDE_SET|RTCM2_SET|RTCM3_SET|AIS_SET)) != 0)
+        ATTITUDE_SET|RTCM2_SET|RTCM3_SET|AIS_SET|NAVIGATION_SET|
+        ENVIRONMENT_SET|ENGINE_SET|WAYPOINT_SET)) != 0)
     shm_update(&context, &device->gpsdata);
+    ring_update(&context, &device->gpsdata, changed);
 #endif /* SHM_EXPORT_ENABLE */
 
+    /*
+     * The translated outputs publish each data item from one device
+     * only; what this device lost to another is masked out of them,
+     * and the mast transformations follow the heading chosen.
+     */
+    published = arbiter_update(&arbiter, device_slot(device),
+                               &device->gpsdata, changed, timestamp(),
+                               &saved);
+    if ((published & NAVIGATION_SET) != 0
+        && (device->gpsdata.navigation.set & NAV_HDG_MAGN_PSET) != 0)
+        nmea_xform_note(&xform, XFORM_VAR_HEADING,
+                        device->gpsdata.navigation.heading[compass_magnetic]);
+
+    /* true wind, VMG, current and the rest go out along with it */
+    published = derive_update(&derive, &device->gpsdata, published,
+                              timestamp(), &derived);
+
     /* report n2k packages to n2k device, node should never be ready if not write enabled */
     if(device->gpsdata.dev.node_state == node_ready)
-        pseudon2k_report(changed, device);
+        pseudon2k_report(published, device);
     else
         gpsd_report(context.debug, LOG_RAW,
                     "N2K not ready or in readonly. Not reporting in N2K.\n");
 
 
     /* report pseudonmea packages to devices and users subscribed */
-    pseudonmea_report(changed, device);
+    pseudonmea_report(published, device);
 
     /* report out updates to signalk subscribers */
-    signalk_report(changed, device);
+    signalk_report(published, device);
+
+    /* clients watching the device still see all it said */
+    derive_restore(&device->gpsdata, &derived);
+    arbiter_restore(&device->gpsdata, &saved);
 
     /* report raw packets to users subscribed to those */
     raw_report(device);
@@ -2545,8 +3365,9 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
         gpsd_report(context.debug, LOG_PROG,
     "time to report a fix\n");
 
-    if (sub->policy.json) {
+    if (sub->policy.json || sub->policy.binary) {
         char buf[GPS_JSON_RESPONSE_MAX * 4];
+        gps_mask_t jsonmask = changed;
 
         if ((changed & AIS_SET) != 0)
     if (device->gpsdata.ais.type == 24
@@ -2554,11 +3375,22 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
         && !sub->policy.split24)
         continue;
 
-        json_data_report(changed,
+        /* binary records replace the JSON for these three */
+        if (sub->policy.binary) {
+            size_t len = binary_data_report(changed, device,
+                                            buf, sizeof(buf));
+            if (len > 0)
+    (void)report_write(sub, format_binary, buf, len);
+            jsonmask &= ~(REPORT_IS | SATELLITE_SET | AIS_SET);
+        }
+
+        if (sub->policy.json) {
+        json_data_report(jsonmask,
          device, &sub->policy,
          buf, sizeof(buf));
         if (buf[0] != '\0')
-    (void)throttled_write(sub, buf, strlen(buf));
+    (void)report_write(sub, format_json, buf, strlen(buf));
+        }
 
     }
         }
@@ -2566,6 +3398,7 @@ static void all_reports(struct gps_device_t *device, gps_mask_t changed)
     /*@+nullderef@*/
     } /* subscribers */
 #endif /* SOCKET_EXPORT_ENABLE */
+    report_device = NULL;
 }
 
 static void handle_gpsd_cleanstring(const char *buf, char * reply) {
@@ -2846,12 +3679,30 @@ int main(int argc, char *argv[])
     int msocks[2] = {-1, -1};
     int canboat_socks[2] = {-1, -1};
     bool go_background = true;
+#ifdef TRACE_ENABLE
+    bool tracing = false;
+#endif /* TRACE_ENABLE */
     volatile bool in_restart;
 
     no_timeouts = 0;
 
     context.debug = 0;
     gps_context_init(&context);
+#ifdef AIVDM_ENABLE
+    ais_targets_init(&ais_targets);
+    ais_cpa_init(&ais_cpa);
+#endif /* AIVDM_ENABLE */
+    nmea_xform_init(&xform);
+    context.xform = &xform;
+    outrate_init(&outrate_rules);
+    context.outrate = &outrate_rules;
+    n2k_bus_init(&n2k_bus);
+    context.n2kbus = &n2k_bus;
+    arbiter_init(&arbiter);
+    context.arbiter = &arbiter;
+    derive_init(&derive);
+    context.sched_packets = SCHED_PACKETS;
+    context.sched_usec = SCHED_USEC;
 
 #ifdef CONTROL_SOCKET_ENABLE
     INVALIDATE_SOCKET(csock);
@@ -2860,7 +3711,7 @@ int main(int argc, char *argv[])
     context.pps_hook = ship_pps_drift_message;
 #endif /* PPS_ENABLE */
 
-    while ((option = getopt(argc, argv, "F:D:S:bGhlNnP:V")) != -1) {
+    while ((option = getopt(argc, argv, "A:B:F:D:S:bGhlNnP:rTV")) != -1) {
     switch (option) {
     case 'D':
         context.debug = (int)strtol(optarg, 0, 0);
@@ -2879,6 +3730,14 @@ int main(int argc, char *argv[])
     case 'b':
         context.readonly = true;
         break;
+    case 'B':
+        {
+            char *cp;
+            context.sched_packets = (int)strtol(optarg, &cp, 10);
+            if (*cp == ',')
+                context.sched_usec = (int)strtol(cp + 1, NULL, 10);
+        }
+        break;
 #ifndef FORCE_GLOBAL_ENABLE
     case 'G':
         listen_global = true;
@@ -2900,6 +3759,29 @@ int main(int argc, char *argv[])
     case 'P':
         pid_file = optarg;
         break;
+#ifdef TRACE_ENABLE
+    case 'T':
+        tracing = true;
+        break;
+#endif /* TRACE_ENABLE */
+#ifdef INGEST_THREADS_ENABLE
+    case 'r':
+        ingest_threads = true;
+        break;
+    case 'A':
+        {
+            char *cp = optarg;
+            ingest_ncpus = 0;
+            while (*cp != '\0' && ingest_ncpus < MAXDEVICES) {
+                ingest_cpus[ingest_ncpus++] = (int)strtol(cp, &cp, 10);
+                if (*cp == ',')
+                    ++cp;
+                else
+                    break;
+            }
+        }
+        break;
+#endif /* INGEST_THREADS_ENABLE */
     case 'V':
         (void)printf("gpsd: %s (revision %s)\n", VERSION, REVISION);
         exit(EXIT_SUCCESS);
@@ -3062,8 +3944,17 @@ int main(int argc, char *argv[])
     } else
     gpsd_report(context.debug, LOG_PROG,
         "shared-segment creation succeeded,\n");
+    if (!ring_acquire(&context))
+    gpsd_report(context.debug, LOG_ERROR,
+        "event ring creation failed,\n");
 #endif /* SHM_EXPORT_ENABLE */
 
+#ifdef TRACE_ENABLE
+    if (tracing && !trace_acquire(context.debug))
+    gpsd_report(context.debug, LOG_ERROR,
+        "trace-segment creation failed,\n");
+#endif /* TRACE_ENABLE */
+
 
     /*
      * We open devices specified on the command line *before* dropping
@@ -3088,7 +3979,11 @@ int main(int argc, char *argv[])
      * Read additional configuration information here:
      * forward rules, interface accept/reject rules, etc.
      */
-    config_parse(interfaces, &vessel, devices);
+    config_parse(interfaces, &vessel, devices, &xform, &outrate_rules,
+                 &arbiter, &derive);
+#ifdef AIVDM_ENABLE
+    ais_cpa.own_mmsi = vessel.mmsi;
+#endif /* AIVDM_ENABLE */
 
     for (device = devices; device < devices + MAXDEVICES; device++) {
 
@@ -3107,6 +4002,30 @@ int main(int argc, char *argv[])
     gpsd_report(context.debug, LOG_INF,
                 "Device init done.\n");
 
+#ifdef INGEST_THREADS_ENABLE
+    /* hand devices opened so far over to reader threads */
+    if (ingest_threads && !ingest_running) {
+        if (pipe(ingest_pipe) != 0) {
+            gpsd_report(context.debug, LOG_ERROR,
+                        "can't create reader wakeup pipe: %s\n",
+                        strerror(errno));
+        } else {
+            (void)fcntl(ingest_pipe[0], F_SETFL, O_NONBLOCK);
+            (void)fcntl(ingest_pipe[1], F_SETFL, O_NONBLOCK);
+            FD_SET(ingest_pipe[0], &all_fds);
+            adjust_max_fd(ingest_pipe[0], true);
+            ingest_running = true;
+            for (device = devices; device < devices + MAXDEVICES; device++)
+                if (allocated_device(device)
+                    && !BAD_SOCKET(device->gpsdata.gps_fd)) {
+                    FD_CLR(device->gpsdata.gps_fd, &all_fds);
+                    adjust_max_fd(device->gpsdata.gps_fd, false);
+                    watch_device(device);
+                }
+        }
+    }
+#endif /* INGEST_THREADS_ENABLE */
+
     if (udpsocks() < 0) {
 
         gpsd_report(context.debug, LOG_ERR,
@@ -3259,10 +4178,18 @@ int main(int argc, char *argv[])
 #ifdef EFDS
     fd_set efds;
 #endif /* EFDS */
-    switch(gpsd_await_data(&rfds, maxfd, &all_fds, context.debug))
+    struct gps_device_t *order[MAXDEVICES];
+    int ordered, next;
+    /* don't sleep in select() while a device has buffered input left */
+    bool carry = sched_carry();
+
+    switch(gpsd_await_data(&rfds, maxfd, &all_fds, context.debug,
+                           carry ? 0.0 :
+                           n2k_node_timeout(outrate_timeout(1.0))))
     {
     case AWAIT_TIMEOUT:
-            no_timeouts++;
+            if (!carry)
+                no_timeouts++;
         break;
     case AWAIT_GOT_INPUT:
             no_timeouts = 0;
@@ -3337,9 +4264,32 @@ int main(int argc, char *argv[])
         }
 #endif /* CONTROL_SOCKET_ENABLE */
 
-    /* poll all active devices */
-    for (device = devices; device < devices + MAXDEVICES; device++)
-        if (allocated_device(device) && device->gpsdata.gps_fd > 0) {
+#ifdef INGEST_THREADS_ENABLE
+    /* report what the reader threads decoded */
+    if (ingest_running) {
+        if (FD_ISSET(ingest_pipe[0], &rfds)) {
+            char junk[64];
+            while (read(ingest_pipe[0], junk, sizeof(junk)) > 0)
+                continue;
+        }
+        for (device = devices; device < devices + MAXDEVICES; device++)
+            if (allocated_device(device) && device->ingest != NULL) {
+                int status = ingest_drain(device, all_reports);
+                if (status == DEVICE_ERROR || status == DEVICE_EOF)
+                    deactivate_device(device);
+            }
+    }
+#endif /* INGEST_THREADS_ENABLE */
+
+    /* poll all active devices, latency-sensitive classes first */
+    ordered = sched_order(order);
+    for (next = 0; next < ordered; next++)
+        if (allocated_device(device = order[next])
+            && device->gpsdata.gps_fd > 0) {
+#ifdef INGEST_THREADS_ENABLE
+            if (device->ingest != NULL)
+                continue;	/* its reader thread polls it */
+#endif /* INGEST_THREADS_ENABLE */
 
             if(device->device_type && (device->device_type->packet_type == VYSPI_PACKET)) {
                if(no_timeouts > 2) {
@@ -3378,12 +4328,6 @@ int main(int argc, char *argv[])
                 break;
             }
 
-            // TODO - find a better place for this - many fragments scanned can have this being called rarely
-            if(device->device_type && (device->device_type->packet_type == VYSPI_PACKET)) {
-                gpsd_report(device->context->debug, LOG_RAW,
-                            "VYSPI should access time trigger.\n");
-                vyspi_handle_time_trigger(device);
-            }
         }
 
 
@@ -3402,7 +4346,16 @@ int main(int argc, char *argv[])
     }
 #endif /* __UNUSED_AUTOCONNECT__ */
 
+    n2k_node_report();
+
 #ifdef SOCKET_EXPORT_ENABLE
+    outrate_report();
+    stats_report();
+    n2k_bus_report();
+#ifdef AIVDM_ENABLE
+    aistargets_report();
+#endif /* AIVDM_ENABLE */
+
     /* accept and execute commands for all clients */
     for (sub = subscribers; sub < subscribers + MAXSUBSCRIBERS; sub++) {
         if (sub->active == 0)
@@ -3531,6 +4484,11 @@ int main(int argc, char *argv[])
     gpsd_report(context.debug, LOG_WARN,
     "received terminating signal %d.\n", signalled);
 
+#ifdef INGEST_THREADS_ENABLE
+    for (device = devices; device < devices + MAXDEVICES; device++)
+        ingest_stop(device);
+#endif /* INGEST_THREADS_ENABLE */
+
     gpsd_terminate(&context);
 
     gpsd_report(context.debug, LOG_WARN, "exiting.\n");
@@ -3550,8 +4508,13 @@ int main(int argc, char *argv[])
 
 #ifdef SHM_EXPORT_ENABLE
     shm_release(&context);
+    ring_release(&context);
 #endif /* SHM_EXPORT_ENABLE */
 
+#ifdef TRACE_ENABLE
+    trace_release();
+#endif /* TRACE_ENABLE */
+
 #ifdef CONTROL_SOCKET_ENABLE
     if (control_socket)
     (void)unlink(control_socket);
@@ -17,8 +17,10 @@ extern "C" {
 #include <termios.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <time.h>
 #include "gps.h"
 #include "gpsd_config.h"
+#include "trace.h"
 
 /*
  * Tell GCC that we want thread-safe behavior with _REENTRANT;
@@ -206,12 +208,14 @@ struct gps_packet_t {
     uint8_t   out_new_version[MAX_OUT_BUF_RECORDS];
     uint16_t  out_offset[MAX_OUT_BUF_RECORDS];
     uint16_t  out_len[MAX_OUT_BUF_RECORDS];
+    uint8_t   out_port[MAX_OUT_BUF_RECORDS];
     uint8_t   outbuffer[MAX_PACKET_LENGTH*2+1];
     size_t outbuflen;
     unsigned long char_counter;		/* count characters processed */
     unsigned long retry_counter;	/* count sniff retries */
     unsigned counter;			/* packets since last driver switch */
     int debug;				/* lexer debug level */
+    uint64_t rx_ns;			/* monotonic ns of the last input read */
 #ifdef TIMING_ENABLE
     timestamp_t start_time;		/* timestamp of first input */
     unsigned long start_char;		/* char counter at first input */
@@ -272,6 +276,8 @@ struct gps_context_t {
 #define CENTURY_VALID		0x04	/* have received ZDA or 4-digit year */
     int debug;				/* dehug verbosity level */
     bool readonly;			/* if true, never write to device */
+    int sched_packets;			/* multipoll budget, 0 = unlimited */
+    int sched_usec;			/* multipoll time budget, 0 = unlimited */
     /* DGPS status */
     int fixcnt;				/* count of good fixes seen */
     /* timekeeping */
@@ -301,7 +307,12 @@ struct gps_context_t {
     /* we don't want the compiler to treat writes to shmexport as dead code,
      * and we don't want them reordered either */
     /*@reldef@*/volatile char *shmexport;
+    /*@reldef@*/volatile char *shmring;
 #endif
+    /*@null@*/struct nmea_xform_t *xform;	/* sentence rewriting rules */
+    /*@null@*/struct outrate_rules_t *outrate;	/* output pacing rules */
+    /*@null@*/struct n2k_bus_t *n2kbus;	/* nodes on the NMEA 2000 bus */
+    /*@null@*/struct arbiter_t *arbiter;	/* where each data item comes from */
 };
 
 /* state for resolving interleaved Type 24 packets */
@@ -315,10 +326,35 @@ struct ais_type24_queue_t {
     int index;
 };
 
+/*
+ * State for reassembling multipart AIVDM messages.  Fragments are filed
+ * by sender, radio channel and sequential message ID, so messages from
+ * several receivers or both channels can interleave freely; partial
+ * messages are dropped after AIVDM_FRAG_TTL seconds, or when the table
+ * is full and room is needed.
+ */
+#define AIVDM_FRAG_MAX		9	/* the fragment count is one digit */
+#define AIVDM_FRAG_SLOTS	16	/* multipart messages in flight */
+#define AIVDM_FRAG_TTL		5.0	/* seconds to wait for the rest */
+struct aivdm_frag_t {
+    timestamp_t started;
+    unsigned int source;	/* who sent it; 0 marks a free slot */
+    char channel;		/* radio channel */
+    int seqid;			/* sequential message ID, -1 if none */
+    int nfrags;			/* fragments in the message */
+    unsigned int have;		/* bit n set when fragment n+1 is held */
+    unsigned char pad;		/* fill bits after the last fragment */
+    unsigned char len[AIVDM_FRAG_MAX];
+    char data[AIVDM_FRAG_MAX][NMEA_MAX];
+};
+struct aivdm_reassembly_t {
+    struct aivdm_frag_t slot[AIVDM_FRAG_SLOTS];
+    unsigned long completed, dropped;
+};
+
 /* state for resolving AIVDM decodes */
 struct aivdm_context_t {
-    /* hold context for decoding AIDVM packet sequences */
-    int decoded_frags;		/* for tracking AIDVM parts in a multipart sequence */
+    /* the payload of the message being decoded */
     unsigned char bits[2048];
     size_t bitlen; /* how many valid bits */
     struct ais_type24_queue_t type24_queue;
@@ -490,6 +526,497 @@ struct ntrip_stream_t
 #define free_device(devp)	 (devp)->gpsdata.dev.path[0] = '\0'
 #define initialized_device(devp) ((devp)->context != NULL)
 
+/*
+ * Log-linear latency histogram in nanoseconds: exact below 32ns, then
+ * 16 sub-buckets per power of two (about 6% resolution) up to 2^40ns.
+ */
+#define LATENCY_SUB_BITS	4
+#define LATENCY_SUB		(1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_MSB		39
+#define LATENCY_BUCKETS		((LATENCY_MAX_MSB - LATENCY_SUB_BITS + 2) * LATENCY_SUB)
+
+struct latency_t {
+    unsigned long count;
+    uint64_t max;
+    uint32_t bucket[LATENCY_BUCKETS];
+};
+
+/*
+ * Share of a main-loop pass a device may take in gpsd_multipoll(), so
+ * one chatty source can't starve the others.  Devices are sorted into
+ * classes by what they report: heading and precision-time sources are
+ * served first with a larger budget, AIS-mostly sources last with a
+ * smaller one.
+ */
+#define SCHED_PACKETS	16	/* default packets per device per pass */
+#define SCHED_USEC	2000	/* default microseconds per device per pass */
+
+enum sched_class_t {SCHED_NORMAL, SCHED_REALTIME, SCHED_BULK, SCHED_CLASSES};
+
+struct sched_t {
+    enum sched_class_t class;
+    bool pending;		/* budget ran out with input still buffered */
+    unsigned long passes;	/* multipoll calls that handled packets */
+    unsigned long packets;	/* packets handled */
+    unsigned long ais;		/* ...of which AIS */
+    unsigned long cut;		/* passes ended by the budget */
+    uint64_t busy_ns;		/* time spent in those passes */
+    uint64_t max_pass_ns;	/* longest single pass */
+};
+
+/*
+ * AIS target table: the latest dynamic and static data for every vessel
+ * heard, merged from whichever messages carried it, so clients can ask
+ * for the traffic picture instead of replaying every report.  Targets
+ * are found by MMSI through an open-addressed hash and by position
+ * through a hashed grid of AIS_TARGET_CELL-degree cells; ones not heard
+ * from for AIS_TARGET_TTL seconds are dropped.
+ */
+#define AIS_TARGET_MAX		4096	/* vessels tracked at once */
+#define AIS_TARGET_HASH		(AIS_TARGET_MAX * 2)
+#define AIS_TARGET_BUCKETS	4096	/* spatial hash buckets, power of 2 */
+#define AIS_TARGET_CELL		0.1	/* grid cell size, degrees */
+#define AIS_TARGET_TTL		600.0	/* seconds */
+
+struct ais_target_t {
+    unsigned int mmsi;		/* 0 if the slot is free */
+    timestamp_t seen;		/* last message from it */
+    timestamp_t changed;	/* last change to anything reported */
+    timestamp_t fixed;		/* when lat/lon were reported */
+    unsigned int type;		/* last position message type */
+    bool own;			/* our own vessel */
+    double lat, lon;		/* degrees, NaN if unknown */
+    double speed;		/* knots, NaN if unknown */
+    double course;		/* degrees, NaN if unknown */
+    int heading;		/* degrees, -1 if unknown */
+    int status;			/* navigation status, -1 if unknown */
+    int turn;			/* raw rate of turn, AIS_TURN_NOT_AVAILABLE */
+    unsigned int imo;
+    char callsign[8];
+    char shipname[35];		/* long enough for aid-to-navigation names */
+    char destination[21];
+    unsigned int shiptype;
+    unsigned int to_bow, to_stern, to_port, to_starboard;
+    unsigned int draught;	/* decimeters */
+    long cell;			/* grid cell, -1 without a position */
+    int next;			/* next in bucket or free list, -1 at end */
+};
+
+struct ais_targets_t {
+    struct ais_target_t target[AIS_TARGET_MAX];
+    int hash[AIS_TARGET_HASH];		/* slot + 1 by MMSI, 0 if empty */
+    int bucket[AIS_TARGET_BUCKETS];	/* first slot in each, -1 if none */
+    int free;				/* first free slot, -1 if full */
+    int count;
+    /* recent evictions, so delta streams can tell clients */
+    struct {
+	unsigned int mmsi;
+	timestamp_t when;
+    } gone[AIS_TARGET_MAX];
+    int gone_next;
+};
+
+/* what ?AISTARGETS asks for; NaN or 0 members don't restrict */
+struct ais_target_query_t {
+    double minlat, minlon, maxlat, maxlon;	/* bounding box */
+    double lat, lon, radius;			/* circle, radius in meters */
+    timestamp_t since;				/* changed after this */
+};
+
+/*
+ * Closest point of approach for every target against our own ship.
+ * Positions and velocities live in parallel arrays indexed like the
+ * target table, in meters and m/s on a plane tangent near own ship, so
+ * one branch-free loop screens the whole table and the compiler can
+ * vectorize it.  Entries without a usable position are NaN and never
+ * match.  A target raises an alarm when it will pass within cpa_limit
+ * inside tcpa_limit seconds, or is that close already, and clears when
+ * it stays outside AIS_CPA_RELEASE times both limits.
+ */
+#define AIS_CPA_LIMIT		926.0	/* default alarm distance, meters */
+#define AIS_TCPA_LIMIT		900.0	/* default look-ahead, seconds */
+#define AIS_CPA_RELEASE		1.2	/* hysteresis on clearing */
+#define AIS_CPA_REANCHOR	20000.0	/* meters own ship moves before
+					 * the plane is re-centered */
+
+struct ais_cpa_t {
+    double x[AIS_TARGET_MAX], y[AIS_TARGET_MAX];	/* east/north, m */
+    double vx[AIS_TARGET_MAX], vy[AIS_TARGET_MAX];	/* m/s */
+    double t[AIS_TARGET_MAX];		/* when x and y were true */
+    double cpa2[AIS_TARGET_MAX];	/* squared CPA, m^2 */
+    double tcpa[AIS_TARGET_MAX];	/* seconds, negative once past */
+    unsigned char danger[AIS_TARGET_MAX];	/* inside the limits */
+    unsigned char clear[AIS_TARGET_MAX];	/* outside the release */
+    unsigned int alarm[AIS_TARGET_MAX];	/* MMSI the alarm is up for */
+    bool own_valid;
+    unsigned int own_mmsi;		/* our AIS, never a threat */
+    double lat0, lon0, coslat0;		/* tangent point of the plane */
+    double ox, oy, ovx, ovy;		/* own ship on the plane */
+    timestamp_t ot;
+    double cpa_limit, tcpa_limit;
+};
+
+/* an alarm raised or cleared, or one standing, as reported to clients */
+struct ais_cpa_event_t {
+    int slot;
+    unsigned int mmsi;
+    bool alarm;
+    timestamp_t time;
+    double cpa, tcpa;		/* meters, seconds */
+    double range, bearing;	/* meters, degrees true from own ship */
+};
+
+/*
+ * Sentence transformation rules, from "transform" sections of the
+ * configuration plus the built-in ones.  A rule matches a sentence ID,
+ * optionally a talker and the port the sentence came in on, and then
+ * derives fields or named values from its fields and other values, sets
+ * fields to constants, renames the sentence, or drops it.  Rules are
+ * compiled into a small hash on the sentence ID, so a sentence no rule
+ * is about costs one lookup.
+ */
+#define XFORM_RULES		32	/* rules, built-in ones included */
+#define XFORM_STEPS		6	/* derive and set steps in one rule */
+#define XFORM_TERMS		4	/* terms in one derived value */
+#define XFORM_VARS		16	/* named values, "heading" included */
+#define XFORM_FIELDS		32	/* fields a rule can address */
+#define XFORM_BUCKETS		64	/* hash on sentence ID, power of 2 */
+#define XFORM_NAMELEN		16
+#define XFORM_VAR_HEADING	0	/* boat's magnetic heading */
+
+enum xform_result_t {xform_pass, xform_rewrite, xform_drop};
+
+struct xform_term_t {
+    enum {term_const, term_field, term_var} kind;
+    int index;				/* field number or value slot */
+    double k;				/* constant, or sign of the term */
+};
+
+struct xform_step_t {
+    bool set;				/* constant rather than derived */
+    int field;				/* field written, 0 for a value */
+    int var;				/* value slot written */
+    int nterms;
+    struct xform_term_t term[XFORM_TERMS];
+    char text[XFORM_NAMELEN];		/* what set writes */
+};
+
+struct xform_rule_t {
+    char name[XFORM_NAMELEN];
+    bool enabled;
+    char talker[3];			/* empty for any talker */
+    char id[8];				/* sentence, or whole proprietary tag */
+    char port[DEVICE_SHORTNAME_MAX];	/* empty for any port */
+    char rename[8];			/* new tag, empty to keep it */
+    bool drop;
+    int decimals;			/* -1 to keep the field's own */
+    double modulo;			/* derived fields wrap into [0,modulo) */
+    int nsteps;
+    struct xform_step_t step[XFORM_STEPS];
+    int next;				/* next rule on the same ID, -1 ends */
+};
+
+struct nmea_xform_t {
+    int nrules;
+    struct xform_rule_t rule[XFORM_RULES];
+    int nvars;
+    char varname[XFORM_VARS][XFORM_NAMELEN];
+    double var[XFORM_VARS];
+    uint64_t key[XFORM_BUCKETS];	/* packed sentence ID, 0 if empty */
+    int first[XFORM_BUCKETS];		/* first rule on the ID */
+};
+
+/*
+ * Table-driven decoding of the NMEA 2000 PGNs whose fields map straight
+ * onto struct gps_data_t.  The tables are generated by n2kgen.py from
+ * its PGN schema; n2k_decode() walks them for both N2K drivers, and
+ * n2k_encode() walks them the other way for the pseudo-N2K output.
+ */
+#define N2K_INDEX_MAX	5		/* values an index field may take */
+#define N2K_NOWHERE	((size_t)-1)	/* no PSET word */
+
+struct n2k_field_t {
+    const char *name;
+    unsigned short bit;			/* first bit, least significant first */
+    unsigned char width;		/* bits, at most 32 */
+    unsigned char flags;
+#define N2K_SIGNED	0x01
+#define N2K_INDEX	0x02		/* picks the instance of what follows */
+#define N2K_INDEXED	0x04		/* target is per instance */
+    unsigned char end;			/* payload bytes the field needs */
+    unsigned char limit;		/* values an index may take */
+    uint32_t na;			/* raw value for "not available" */
+    double scale;
+    size_t dest;			/* offset in struct gps_data_t */
+    size_t stride;			/* between instances */
+    size_t setword;			/* offset of the PSET word */
+    gps_mask_t mask;			/* reported when stored */
+    gps_mask_t pset[N2K_INDEX_MAX];	/* by index when indexed */
+};
+
+struct n2k_pgn_t {
+    unsigned int pgn;
+    const char *name;
+    bool nan;				/* N/A fields are stored as NaN */
+    int len;				/* payload bytes encoded */
+    int nfields;
+    const struct n2k_field_t *field;
+    size_t reset[2];			/* PSET words this PGN replaces */
+    /*@null@*/void (*hook)(struct gps_device_t *);
+};
+
+/*
+ * Output rate control.  What gpsd writes to an output device is keyed
+ * by PGN and instance, or by NMEA 0183 sentence type; a key with a rule
+ * goes out at most every min_ms, holding back the latest frame offered
+ * until it is due, and a frame identical to the last one sent is only
+ * repeated every max_ms.  Keys without a rule pass straight through.
+ */
+#define OUTRATE_RULES		64
+#define OUTRATE_SLOTS		32	/* keys held per output device */
+#define OUTRATE_FRAME_MAX	96	/* longer frames are never held */
+#define OUTRATE_BUF		4096	/* frames paced in one write */
+#define OUTRATE_FRAMES		64
+#define OUTRATE_N2K		0	/* kinds of output, for the load */
+#define OUTRATE_NMEA		1
+#define OUTRATE_KINDS		2
+#define OUTRATE_SENTENCE	0x80000000u	/* key flag, else a PGN */
+
+struct outrate_rule_t {
+    uint32_t key;			/* PGN or sentence, no instance */
+    int device;				/* index in devices[], -1 for all */
+    unsigned int min_ms;		/* 0: as fast as offered */
+    unsigned int max_ms;		/* 0: unchanged counts as changed */
+};
+
+struct outrate_rules_t {
+    int count;
+    struct outrate_rule_t rule[OUTRATE_RULES];
+};
+
+struct outrate_slot_t {
+    uint32_t key;
+    unsigned int min_ms, max_ms;
+    bool dirty;				/* holding a frame not yet sent */
+    unsigned char len;
+    timestamp_t sent;
+    unsigned char frame[OUTRATE_FRAME_MAX];
+};
+
+struct outrate_load_t {
+    unsigned long frames, bytes;	/* written */
+    unsigned long held, coalesced, repeated;
+    double capacity;			/* bits per second */
+    double bits;			/* in the current window */
+    timestamp_t window;
+    double load, peak;			/* share of capacity, per window */
+};
+
+struct outrate_t {
+    int nslots;
+    struct outrate_slot_t slot[OUTRATE_SLOTS];
+    struct outrate_load_t kind[OUTRATE_KINDS];
+};
+
+/*
+ * An ISO 11783 network node, the part of NMEA 2000 that lets gpsd write
+ * to the bus: it claims a source address against the other nodes by
+ * NAME, answers ISO requests, and moves messages longer than a fast
+ * packet with the ISO transport protocol.  Everything it sends goes
+ * through write() as a framed PGN (PGN, priority, source, destination,
+ * payload); what it reassembles comes back through deliver().
+ */
+#define N2K_NODE_NULL		254	/* source address before a claim */
+#define N2K_NODE_GLOBAL		255
+#define N2K_FAST_MAX		223	/* longest fast packet payload */
+#define N2K_TP_MAX		1785	/* longest transport payload */
+#define N2K_TP_SESSIONS		4	/* transfers received at once */
+#define N2K_NODE_PGNS		128	/* in each of the PGN lists */
+
+enum n2k_node_state_t {
+    n2k_node_off,			/* not writing to the bus */
+    n2k_node_waiting,			/* asked who is there, listening */
+    n2k_node_claiming,			/* claimed, waiting for objections */
+    n2k_node_ready,			/* address is ours */
+    n2k_node_lost,			/* no address left to claim */
+};
+
+enum n2k_tp_state_t {
+    n2k_tp_idle,
+    n2k_tp_bam,				/* broadcasting, paced */
+    n2k_tp_rts,				/* waiting for clear to send */
+    n2k_tp_eom,				/* all sent, waiting for the ack */
+    n2k_tp_receive,
+};
+
+struct n2k_tp_t {
+    enum n2k_tp_state_t state;
+    uint8_t peer;			/* other end of the transfer */
+    uint8_t dest;			/* N2K_NODE_GLOBAL for a broadcast */
+    uint8_t prio;
+    uint32_t pgn;
+    uint16_t size;
+    uint8_t packets;
+    uint16_t next;			/* sequence number due next */
+    uint16_t last;			/* last one of the clear window */
+    uint8_t window;			/* most packets the sender takes */
+    timestamp_t deadline;
+    uint8_t data[N2K_TP_MAX];
+};
+
+struct n2k_node_t {
+    enum n2k_node_state_t state;
+    uint64_t name;
+    uint8_t address;			/* N2K_NODE_NULL while we have none */
+    uint8_t preferred;			/* configured, or N2K_NODE_NULL */
+    timestamp_t deadline;		/* of waiting or claiming */
+    uint32_t tx_pgns[N2K_NODE_PGNS], rx_pgns[N2K_NODE_PGNS];
+    int ntx, nrx;
+    struct n2k_tp_t tx;
+    struct n2k_tp_t rx[N2K_TP_SESSIONS];
+    uint8_t pending, pending_dest;	/* PGN lists waiting for tx */
+    ssize_t (*write)(struct gps_device_t *, const uint8_t *, size_t);
+    /*@null@*/void (*deliver)(struct gps_device_t *, uint32_t, uint8_t,
+			      uint8_t, const uint8_t *, size_t);
+    unsigned long claims, conflicts, requests, naks;
+    unsigned long tp_sent, tp_received, tp_aborts;
+};
+
+/*
+ * What the daemon knows about every node on the NMEA 2000 bus, by
+ * source address: its NAME and product information, and per PGN it
+ * sends how often, how much and in what sizes.  PGNs get a column in
+ * the order they are first seen, so a frame costs a hash probe and a
+ * table cell.  Drivers on reader threads write into it, hence the lock.
+ */
+#define N2K_BUS_SOURCES		256
+#define N2K_BUS_PGNS		64	/* PGN columns; later ones count as overflow */
+#define N2K_BUS_HASH		128	/* PGN hash slots, a power of two */
+#define N2K_BUS_SIZES		4	/* payload size buckets: 8, 32, 96, more */
+#define N2K_BUS_STRING		32	/* product information strings */
+
+struct n2k_bus_cell_t {
+    uint32_t packets, bytes;
+    uint32_t size[N2K_BUS_SIZES];
+    float interval;			/* smoothed seconds between packets */
+    timestamp_t last;
+};
+
+struct n2k_bus_source_t {
+    uint64_t name;			/* 0 until it claims */
+    timestamp_t first, last;		/* heard */
+    uint32_t packets, frames, bytes;
+    uint32_t fast_errors, fast_cancels;	/* fast packets lost in reassembly */
+    uint32_t claims;
+    bool product;			/* the fields below are set */
+    uint16_t n2k_version, product_code;
+    uint8_t cert_level, load;
+    char model_id[N2K_BUS_STRING + 1];
+    char software[N2K_BUS_STRING + 1];
+    char model_version[N2K_BUS_STRING + 1];
+    char serial[N2K_BUS_STRING + 1];
+};
+
+struct n2k_bus_t {
+    bool lock;
+    int npgns;
+    uint32_t pgn[N2K_BUS_PGNS];
+    uint8_t hash[N2K_BUS_HASH];		/* column + 1, 0 for empty */
+    uint32_t overflow;			/* packets of PGNs without a column */
+    struct n2k_bus_source_t source[N2K_BUS_SOURCES];
+    struct n2k_bus_cell_t cell[N2K_BUS_SOURCES][N2K_BUS_PGNS];
+};
+
+/*
+ * Arbitration between devices that report the same data item.  Each
+ * item prefers some devices, best first, and goes to the best one
+ * heard within its timeout; devices not listed come after, in the
+ * order they take over.  What a device loses is masked out of the
+ * pseudo-N2K, pseudo-NMEA and Signal K output for that update, so
+ * every item is published from one source.  Heading can be blended
+ * with the rate of turn and course smoothed as a velocity vector.
+ */
+#define ARBITER_PRIORITIES	4
+
+enum arbiter_item_t {
+    arbiter_position,			/* the fix */
+    arbiter_course,			/* SOG and COG */
+    arbiter_heading,
+    arbiter_stw,
+    arbiter_depth,
+    arbiter_rot,
+    arbiter_items,
+};
+
+struct arbiter_source_t {
+    int priority[ARBITER_PRIORITIES];	/* indices in devices[] */
+    int npriority;
+    double timeout;			/* seconds before failing over */
+    double smooth;			/* time constant, 0 for none */
+    int device;				/* selected, -1 for none yet */
+    timestamp_t last;			/* heard from the selected one */
+    unsigned long updates, switches;
+};
+
+struct arbiter_t {
+    struct arbiter_source_t item[arbiter_items];
+    double heading[2];			/* estimate per compass reference */
+    timestamp_t heading_time[2];
+    double rot;				/* deg/s, from the selected source */
+    timestamp_t rot_time;
+    double east, north;			/* smoothed velocity, knots */
+    int course_ref;			/* compass reference it is kept in */
+    timestamp_t course_time;
+};
+
+/* what arbiter_update() changed in the device's data */
+struct arbiter_saved_t {
+    gps_mask_t set, navset;
+    double heading[2];
+    double speed_over_ground, course_over_ground[2];
+};
+
+/*
+ * Quantities derived from what the sensors report: true wind, ground
+ * wind, VMG, leeway and the current.  The engine keeps the last value
+ * of every input and derived quantity; a rule is run again only when
+ * one of its inputs changed in the report at hand, and what it derives
+ * is written into that report for the outputs.
+ */
+enum derive_quantity_t {
+    derive_awa, derive_aws,		/* inputs */
+    derive_stw, derive_sog, derive_cog,
+    derive_hdg_true, derive_hdg_magn, derive_variation, derive_heel,
+    derive_heading,			/* derived, true */
+    derive_leeway,
+    derive_twa, derive_tws,		/* to the bow, through the water */
+    derive_twd,				/* true north, through the water */
+    derive_gwd, derive_gws,		/* over the ground */
+    derive_mwd,
+    derive_vmg,
+    derive_ctw,
+    derive_set, derive_drift,
+    derive_quantities,
+};
+
+#define DERIVE_BIT(q)	(1u << (q))
+
+struct derive_t {
+    double timeout;			/* seconds an input stays good */
+    double leeway_k;			/* deg kn^2 per deg of heel, 0: off */
+    double value[derive_quantities];	/* angles deg, speeds knots */
+    timestamp_t time[derive_quantities];
+    unsigned long updates, runs;	/* reports seen, rules run */
+};
+
+/* what derive_update() changed in the device's data */
+struct derive_saved_t {
+    gps_mask_t set, navset;
+    double vmg, leeway, course_thru_water, current_set, current_drift;
+    struct environment_t environment;
+};
+
+struct ingest_t;
 
 struct gps_device_t {
 /* session object, encapsulates all global state */
@@ -520,6 +1047,13 @@ struct gps_device_t {
     timestamp_t releasetime;
     bool zerokill;
     timestamp_t reawake;
+    struct latency_t latency;		/* input read() to subscriber send() */
+    struct sched_t sched;		/* multipoll budget bookkeeping */
+    struct outrate_t outrate;		/* pacing of what we write to it */
+    struct n2k_node_t n2k;		/* our node on its NMEA 2000 bus */
+#ifdef INGEST_THREADS_ENABLE
+    /*@null@*/struct ingest_t *ingest;	/* reader thread, if one owns us */
+#endif /* INGEST_THREADS_ENABLE */
 #ifdef TIMING_ENABLE
     timestamp_t sor;	/* timestamp start of this reporting cycle */
     unsigned long chars;	/* characters in the cycle */
@@ -733,6 +1267,7 @@ struct gps_device_t {
             uint8_t prio;
             uint8_t src;
             uint8_t dest;
+            gps_mask_t transport_mask;	/* of PGNs the node reassembled */
             
             uint32_t bytes_written_frm[5]; /* collecting stats per type */ 
             uint32_t bytes_written_raw[5]; /* net amount of data w/o frm overhead */
@@ -776,6 +1311,7 @@ struct gps_device_t {
 #ifdef AIVDM_ENABLE
 	struct {
 	    struct aivdm_context_t context[AIVDM_CHANNELS];
+	    struct aivdm_reassembly_t reassembly;
 	    char ais_channel;
 	} aivdm;
 #endif /* AIVDM_ENABLE */
@@ -821,6 +1357,61 @@ struct gps_device_t {
 
 #define ISGPS_ERRLEVEL_BASE	LOG_RAW
 
+/*
+ * Logging subsystems.  A log subscriber gets every subsystem unless it
+ * names some (/debug?level=8&sub=vyspi), so one chatty driver can be
+ * traced without raising verbosity everywhere.
+ */
+#define LOG_SUB_CORE	0	/* untagged, gpsd_external_report() */
+#define LOG_SUB_VYSPI	1	/* VYSPI framing and driver */
+#define LOG_SUB_N2K	2	/* NMEA2000 driver and encoder */
+#define LOG_SUB_SEATALK	3	/* SeaTalk driver */
+#define LOG_SUB_WS	4	/* websocket/HTTP client handling */
+#define LOG_SUB_SIGNALK	5	/* SignalK encoder */
+#define LOG_SUB_COUNT	6
+#define LOG_SUBMASK(s)	(1u << (s))
+#define LOG_SUBMASK_ALL	(LOG_SUBMASK(LOG_SUB_COUNT) - 1)
+
+/* highest level any log subscriber wants, per subsystem */
+extern int gpsd_log_sublevel[LOG_SUB_COUNT];
+
+/*
+ * Levels above MAX_LOGLEVEL (scons max_loglevel=N) are compiled out.
+ * With squelch nothing is ever reported, so nothing is compiled in.
+ */
+#if defined(SQUELCH_ENABLE)
+#define LOG_COMPILED(lvl)	0
+#elif defined(MAX_LOGLEVEL)
+#define LOG_COMPILED(lvl)	((lvl) <= MAX_LOGLEVEL)
+#else
+#define LOG_COMPILED(lvl)	1
+#endif /* SQUELCH_ENABLE */
+
+/*
+ * The level tests happen before the call, so the arguments (hexdumps,
+ * state names, ...) of a filtered message are never evaluated.
+ */
+#define LOG_SUBACTIVE(sub, lvl, dbg) \
+    (LOG_COMPILED(lvl) && ((dbg) >= (lvl) || gpsd_log_sublevel[sub] >= (lvl)))
+
+#define GPSD_LOG(lvl, dbg, ...) \
+    do { \
+	if (LOG_COMPILED(lvl) && (dbg) >= (lvl)) \
+	    gpsd_report((dbg), (lvl), __VA_ARGS__); \
+    } while (0)
+
+#define GPSD_EXTLOG(lvl, dbg, ...) \
+    do { \
+	if (LOG_SUBACTIVE(LOG_SUB_CORE, lvl, dbg)) \
+	    gpsd_external_report((dbg), (lvl), __VA_ARGS__); \
+    } while (0)
+
+#define GPSD_SUBLOG(sub, lvl, dbg, ...) \
+    do { \
+	if (LOG_SUBACTIVE(sub, lvl, dbg)) \
+	    gpsd_subsys_report((sub), (dbg), (lvl), __VA_ARGS__); \
+    } while (0)
+
 #define IS_HIGHEST_BIT(v,m)	(v & ~((m<<1)-1))==0
 
 /* driver helper functions */
@@ -901,7 +1492,8 @@ extern void gpsd_assert_sync(struct gps_device_t *);
 extern void gpsd_close(struct gps_device_t *);
 
 extern ssize_t gpsd_write(struct gps_device_t *, const char *, const size_t);
-extern void gpsd_throttled_report(const int errlevel, const char * buf);
+extern void gpsd_throttled_report(const int subsys, const int errlevel,
+				  const char * buf);
 
 extern void gpsd_time_init(struct gps_context_t *, time_t);
 extern void gpsd_set_century(struct gps_device_t *);
@@ -932,6 +1524,23 @@ extern int gpsd_hexpack(/*@in@*/const char *, /*@out@*/char *, size_t);
 extern ssize_t hex_escapes(/*@out@*/char *, const char *);
 extern void gpsd_position_fix_dump(struct gps_device_t *,
 				   /*@out@*/char[], size_t);
+
+/* numfmt.c: snprintf-compatible conversions for the report writers */
+extern int numfmt_uint(/*@out@*/char *, size_t, unsigned long long, int);
+extern int numfmt_int(/*@out@*/char *, size_t, long long, int);
+extern int numfmt_scaled(/*@out@*/char *, size_t, long long, int);
+extern int numfmt_fixed(/*@out@*/char *, size_t, double, int, int);
+extern int numfmt_dm(/*@out@*/char *, size_t, double, int);
+
+/* gpsd_binary.c and libgps_binary.c: binary report records, see gps.h */
+extern size_t binary_data_report(const gps_mask_t,
+				 const struct gps_device_t *,
+				 /*@out@*/char *, size_t);
+extern uint16_t gps_binary_layout(void);
+extern unsigned int gps_binary_flags(void);
+extern ssize_t gps_binary_length(const char *, size_t);
+extern int gps_binary_unpack(const char *, size_t, struct gps_data_t *);
+
 extern void gpsd_clear_data(struct gps_device_t *);
 extern socket_t netlib_connectsock(int, const char *, const char *, const char *);
 extern socket_t netlib_localsocket(const char *, int);
@@ -1012,15 +1621,256 @@ extern void clear_dop(/*@out@*/struct dop_t *);
 
 /* shmexport.c */
 #define GPSD_KEY	0x47505344	/* "GPSD" */
+#define SHM_MAGIC	0x53454354	/* "SECT" */
+#define SHM_VERSION	3
+#define SHM_SLOTS	MAXDEVICES
+
+/*
+ * The export segment has one slot per device, found by device path and
+ * kept for that path until the device is deactivated.  Each slot is split
+ * into sections (see enum shm_section_id in gps.h), each guarded by its
+ * own sequence lock (odd while the daemon writes it) and only rewritten
+ * when a report touches it.  Readers copy just the sections they asked
+ * for, and of those only the ones whose sequence number moved.
+ */
+struct shm_section_t {
+    volatile uint32_t seq;
+    uint32_t offset;		/* of the payload from the slot start */
+    uint32_t length;
+    volatile uint32_t tick;	/* segment tick of the last rewrite */
+};
+
+struct shm_head_t {
+    gps_mask_t set;
+    timestamp_t online;
+    int status;
+    uint32_t own_mmsi;
+    char tag[MAXTAGLEN+1];
+};
+
+struct shm_fix_t {
+    struct gps_fix_t fix;
+    double separation;
+    double epe;
+};
+
+struct shm_sky_t {
+    int satellites_used;
+    int used[MAXCHANNELS];
+    struct dop_t dop;
+    timestamp_t skyview_time;
+    int satellites_visible;
+    int PRN[MAXCHANNELS];
+    int elevation[MAXCHANNELS];
+    int azimuth[MAXCHANNELS];
+    double ss[MAXCHANNELS];
+};
+
+struct shm_slot_t
+{
+    volatile uint32_t seq;	/* guards path */
+    volatile uint32_t tick;	/* segment tick of the last update */
+    char path[GPS_PATH_MAX];	/* empty while the slot is free */
+    struct shm_section_t section[SHM_SECTIONS];
+    struct shm_head_t head;
+    struct devconfig_t dev;
+    struct shm_fix_t fix;
+    struct shm_sky_t sky;
+    struct navigation_t navigation;
+    struct waypoint_navigation_t waypoint;
+    struct environment_t environment;
+    struct engine_t engine;
+    struct attitude_t attitude;
+    struct ais_t ais;
+};
+
 struct shmexport_t
 {
-    int bookend1;
-    struct gps_data_t gpsdata;
-    int bookend2;
+    uint32_t magic;
+    uint16_t version;
+    uint16_t nsections;
+    uint16_t nslots;
+    uint16_t reserved;
+    uint32_t slotsize;		/* stride of slot[] */
+    volatile uint32_t tick;	/* bumped after every update */
+    volatile uint32_t last;	/* slot of the last update */
+    uint32_t copied;		/* payload bytes written by the last update */
+    uint64_t total_copied;
+    struct shm_slot_t slot[SHM_SLOTS];
 };
 extern bool shm_acquire(struct gps_context_t *);
 extern void shm_release(struct gps_context_t *);
 extern void shm_update(struct gps_context_t *, struct gps_data_t *);
+extern void shm_deactivate(struct gps_context_t *, const char *);
+
+/* shmring.c */
+#define GPSD_RING_KEY	0x47505352	/* "GPSR" */
+#define RING_MAGIC	0x52494e47	/* "RING" */
+#define RING_VERSION	1
+#define RING_RECORDS	4096		/* must be a power of two */
+#define RING_DEVICES	MAXDEVICES
+
+/*
+ * Single writer, many readers.  The writer stamps each record's seq
+ * last; a reader whose copy doesn't carry the seq it expected knows the
+ * writer has lapped it.  Readers park on the futex word, which the
+ * writer bumps (and wakes only if somebody is waiting) after each
+ * batch of records.
+ */
+struct shmring_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recsize;
+    uint32_t records;
+    uint32_t ndevices;
+    volatile uint64_t head;	/* seq of the next record to write */
+    volatile uint32_t futex;
+    volatile uint32_t waiters;
+    struct {
+	volatile uint32_t seq;	/* guards path */
+	char path[GPS_PATH_MAX];
+    } device[RING_DEVICES];
+    struct gps_ring_record_t rec[RING_RECORDS];
+};
+extern bool ring_acquire(struct gps_context_t *);
+extern void ring_release(struct gps_context_t *);
+extern void ring_update(struct gps_context_t *, struct gps_data_t *,
+			gps_mask_t);
+extern void ring_deactivate(struct gps_context_t *, const char *);
+
+/* ingest.c */
+#ifdef INGEST_THREADS_ENABLE
+extern bool ingest_start(struct gps_device_t *, int, int);
+extern void ingest_stop(struct gps_device_t *);
+extern int ingest_drain(struct gps_device_t *,
+			void (*)(struct gps_device_t *, gps_mask_t));
+extern struct gps_device_t *ingest_view(struct gps_device_t *);
+extern void ingest_lock(struct gps_device_t *);
+extern void ingest_unlock(struct gps_device_t *);
+extern bool ingest_log(int, int, const char *);
+/* the copy of a device the main thread may read while a reader runs */
+#define DEVICE_VIEW(devp)	ingest_view(devp)
+#else
+#define DEVICE_VIEW(devp)	(devp)
+#define ingest_lock(devp)	do { } while (0)
+#define ingest_unlock(devp)	do { } while (0)
+#endif /* INGEST_THREADS_ENABLE */
+
+/* latency.c */
+extern void latency_add(struct latency_t *, uint64_t);
+extern uint64_t latency_quantile(const struct latency_t *, double);
+extern size_t latency_json_dump(const struct latency_t *, char *, size_t);
+
+/* ais_targets.c */
+extern void ais_targets_init(/*@out@*/struct ais_targets_t *);
+extern bool ais_targets_update(struct ais_targets_t *, const struct ais_t *,
+			       timestamp_t);
+extern void ais_targets_expire(struct ais_targets_t *, timestamp_t);
+extern int ais_targets_select(const struct ais_targets_t *,
+			      const struct ais_target_query_t *,
+			      /*@out@*/int *, int);
+extern int ais_targets_lookup(const struct ais_targets_t *, unsigned int);
+
+/* ais_cpa.c */
+extern void ais_cpa_init(/*@out@*/struct ais_cpa_t *);
+extern void ais_cpa_own(struct ais_cpa_t *, const struct ais_targets_t *,
+			double, double, double, double, timestamp_t);
+extern void ais_cpa_target(struct ais_cpa_t *, const struct ais_targets_t *,
+			   int, timestamp_t);
+extern void ais_cpa_batch(struct ais_cpa_t *, timestamp_t);
+extern int ais_cpa_changes(struct ais_cpa_t *, const struct ais_targets_t *,
+			   int, timestamp_t,
+			   /*@out@*/struct ais_cpa_event_t *, int);
+extern void ais_cpa_event(const struct ais_cpa_t *, int, unsigned int,
+			  timestamp_t, /*@out@*/struct ais_cpa_event_t *);
+
+/* nmea_xform.c */
+extern void nmea_xform_init(/*@out@*/struct nmea_xform_t *);
+extern /*@null@*/struct xform_rule_t *nmea_xform_rule(struct nmea_xform_t *,
+						       const char *);
+extern bool nmea_xform_option(struct nmea_xform_t *, struct xform_rule_t *,
+			      const char *, const char *);
+extern void nmea_xform_compile(struct nmea_xform_t *);
+extern void nmea_xform_note(/*@null@*/struct nmea_xform_t *, int, double);
+extern enum xform_result_t nmea_xform_apply(struct nmea_xform_t *,
+					    const struct gps_device_t *, int,
+					    const char *, size_t,
+					    /*@out@*/char *, size_t);
+
+/* n2k_decode.c */
+extern const struct n2k_pgn_t n2k_schema[];
+extern const int n2k_schema_count;
+extern /*@null@*/const struct n2k_pgn_t *n2k_schema_find(unsigned int);
+extern gps_mask_t n2k_decode(const struct n2k_pgn_t *, const unsigned char *,
+			     int, struct gps_device_t *);
+extern size_t n2k_encode(const struct n2k_pgn_t *, const struct gps_data_t *,
+			 unsigned int, unsigned char *, size_t);
+extern int n2k_instance(const struct n2k_pgn_t *, const unsigned char *, int);
+extern size_t n2k_describe(const struct n2k_pgn_t *, const unsigned char *,
+			   int, /*@out@*/char *, size_t);
+
+/* outrate.c */
+extern void outrate_init(/*@out@*/struct outrate_rules_t *);
+extern bool outrate_set(struct outrate_rules_t *, const char *, int,
+			unsigned int, unsigned int);
+extern uint32_t outrate_key(int, const char *, size_t);
+extern bool outrate_offer(struct outrate_t *, const struct outrate_rules_t *,
+			  int, int, const char *, size_t, timestamp_t);
+extern int outrate_pace(struct outrate_t *, const struct outrate_rules_t *,
+			int, int, const char *, const size_t *, int,
+			char *, size_t *, timestamp_t);
+extern int outrate_due(struct outrate_t *, int, char *, size_t *,
+		       timestamp_t);
+extern timestamp_t outrate_wake(const struct outrate_t *);
+extern void outrate_count(struct outrate_t *, int, const size_t *, int,
+			  timestamp_t);
+extern size_t outrate_json_dump(const struct outrate_t *, char *, size_t);
+
+/* n2k_node.c */
+extern uint64_t n2k_node_name(unsigned int, unsigned int);
+extern void n2k_node_start(struct gps_device_t *, uint8_t, timestamp_t);
+extern void n2k_node_stop(struct gps_device_t *);
+extern bool n2k_node_input(struct gps_device_t *, uint32_t, uint8_t, uint8_t,
+			   uint8_t, const uint8_t *, size_t, timestamp_t);
+extern int n2k_node_send(struct gps_device_t *, uint32_t, uint8_t, uint8_t,
+			 const uint8_t *, size_t, timestamp_t);
+extern timestamp_t n2k_node_wake(const struct n2k_node_t *);
+extern void n2k_node_tick(struct gps_device_t *, timestamp_t);
+
+/* n2k_bus.c */
+extern void n2k_bus_init(/*@out@*/struct n2k_bus_t *);
+extern void n2k_bus_packet(struct n2k_bus_t *, uint32_t, uint8_t, size_t,
+			   timestamp_t);
+extern void n2k_bus_fast_error(struct n2k_bus_t *, uint8_t, bool);
+extern void n2k_bus_claim(struct n2k_bus_t *, uint8_t, const uint8_t *,
+			  size_t, timestamp_t);
+extern void n2k_bus_product(struct n2k_bus_t *, uint8_t, const uint8_t *,
+			    size_t);
+extern size_t n2k_bus_json_dump(struct n2k_bus_t *, timestamp_t,
+				char *, size_t);
+extern size_t n2k_bus_json_source(struct n2k_bus_t *, int, timestamp_t,
+				  char *, size_t);
+
+/* arbiter.c */
+extern void arbiter_init(/*@out@*/struct arbiter_t *);
+extern int arbiter_item(const char *);
+extern const char *arbiter_item_name(int);
+extern bool arbiter_prefer(struct arbiter_t *, int, int);
+extern bool arbiter_set(struct arbiter_t *, int, double, double);
+extern gps_mask_t arbiter_update(struct arbiter_t *, int, struct gps_data_t *,
+				 gps_mask_t, timestamp_t,
+				 /*@out@*/struct arbiter_saved_t *);
+extern void arbiter_restore(struct gps_data_t *,
+			    const struct arbiter_saved_t *);
+
+/* derive.c */
+extern void derive_init(/*@out@*/struct derive_t *);
+extern gps_mask_t derive_update(struct derive_t *, struct gps_data_t *,
+				gps_mask_t, timestamp_t,
+				/*@out@*/struct derive_saved_t *);
+extern void derive_restore(struct gps_data_t *,
+			   const struct derive_saved_t *);
 
 
 /* dbusexport.c */
@@ -1057,7 +1907,8 @@ extern void gpsd_deactivate(struct gps_device_t *);
 extern int gpsd_await_data(/*@out@*/fd_set *,
 			    const int, 
 			    /*@in@*/fd_set *,
-			    const int);
+			    const int,
+			    const double);
 extern gps_mask_t gpsd_poll(struct gps_device_t *);
 #define DEVICE_EOF	-3
 #define DEVICE_ERROR	-2
@@ -1068,6 +1919,8 @@ extern int gpsd_multipoll(const bool,
 			  struct gps_device_t *,
 			  void (*)(struct gps_device_t *, gps_mask_t),
 			  float reawake_time);
+extern const char *sched_class_names[SCHED_CLASSES];
+extern void sched_classify(struct gps_device_t *, gps_mask_t);
 extern void gpsd_wrap(struct gps_device_t *);
 extern bool gpsd_add_device(const char *device_name, bool flag_nowait);
 extern /*@observer@*/const char *gpsd_maskdump(gps_mask_t);
@@ -1079,6 +1932,13 @@ extern bool ais_binary_decode(const int debug,
 			      struct ais_t *ais,
 			      const unsigned char *, size_t,
 			      /*@null@*/struct ais_type24_queue_t *);
+extern int aivdm_reassemble(struct aivdm_reassembly_t *,
+			    unsigned int, char, int, int, int,
+			    const char *, unsigned int, timestamp_t,
+			    /*@out@*/unsigned char *, size_t, size_t *,
+			    const int);
+extern bool aivdm_decode(const char *, size_t,
+			 struct gps_device_t *, struct ais_t *, int);
 
 /* debugging apparatus for the client library */
 #ifdef CLIENTDEBUG_ENABLE
@@ -1096,15 +1956,20 @@ extern void libgps_dump_state(struct gps_data_t *);
 
 void gpsd_labeled_report(const int, const int, const int,
 			 const char *, const char *, va_list);
+extern unsigned int gpsd_log_submask(const char *);
 # if __GNUC__ >= 3 || (__GNUC__ == 2 && __GNUC_MINOR__ >= 7)
 __attribute__((__format__(__printf__, 3, 4))) void gpsd_report(const int, const int, const char *, ...);
 __attribute__((__format__(__printf__, 3, 4))) void gpsd_external_report(const int, const int, const char *, ...);
+__attribute__((__format__(__printf__, 4, 5))) void gpsd_subsys_report(const int, const int, const int, const char *, ...);
 # else /* not a new enough GCC, use the unprotected prototype */
 void gpsd_report(const int, const int, const char *, ...);
 void gpsd_external_report(const int, const int, const char *, ...);
+void gpsd_subsys_report(const int, const int, const int, const char *, ...);
 #endif
 
-int config_parse(struct interface_t *, struct vessel_t *, struct gps_device_t *);
+int config_parse(struct interface_t *, struct vessel_t *, struct gps_device_t *,
+                 struct nmea_xform_t *, struct outrate_rules_t *,
+                 struct arbiter_t *, struct derive_t *);
 
 #ifdef S_SPLINT_S
 extern struct protoent *getprotobyname(const char *);
@@ -1137,6 +2002,14 @@ void cfmakeraw(struct termios *);
 /* Needed because 4.x versions of GCC are really annoying */
 #define ignore_return(funcall)	assert(funcall != -23)
 
+static /*@unused@*/ inline uint64_t monotonic_ns(void)
+/* CLOCK_MONOTONIC in nanoseconds, for latency bookkeeping */
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 static /*@unused@*/ inline void memory_barrier(void)
 {
 #ifndef S_SPLINT_S
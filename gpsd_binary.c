@@ -0,0 +1,223 @@
+/****************************************************************************
+
+NAME
+   gpsd_binary.c - binary TPV, SKY and AIS records for local clients
+
+DESCRIPTION
+   A client that sets "binary":true in its ?WATCH gets these three
+reports, which are the bulk of the traffic on a busy AIS or GNSS feed,
+as length-prefixed records copied straight out of gps_data_t instead of
+JSON text.  Nothing is formatted on the way out and libgps_binary.c
+copies the fields back without parsing anything.
+
+   The header (see gps.h) carries a schema version, the sender's byte
+order and a fingerprint of the structure layouts, so a client built
+against a different gps.h or on another architecture rejects the
+records instead of misreading them.  Binary mode is meant for readers on
+the same host; anything that crosses machines should stay on JSON.
+
+   TPV fields that JSON would suppress because the fix doesn't support
+them are sent as NaN, so both paths leave the client with the same
+gps_data_t.  AIS records carry only the part of the union the message
+type uses.
+
+PERMISSIONS
+  This file is Copyright (c) 2010 by the GPSD project
+  BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+#include "bits.h"
+#include "gps_json.h"
+
+#ifdef SOCKET_EXPORT_ENABLE
+
+static size_t binary_begin(struct json_out_t *out, unsigned int kind,
+			   const char *path, const char *tag)
+/* write a header with the length left blank; returns where it starts */
+{
+    size_t start = out->len;
+    char header[GPS_BINARY_HEADER];
+
+    putbyte(header, 0, GPS_BINARY_MAGIC);
+    putbyte(header, 1, GPS_BINARY_VERSION);
+    putbyte(header, 2, kind);
+    putbyte(header, 3, gps_binary_flags());
+    putbe16(header, 4, 0);
+    putbe16(header, 6, gps_binary_layout());
+    json_out_mem(out, header, sizeof(header));
+    json_out_mem(out, path, strlen(path) + 1);
+    json_out_mem(out, tag, strlen(tag) + 1);
+    return start;
+}
+
+static void binary_end(struct json_out_t *out, size_t start)
+/* fill in the payload length, or drop a record that didn't fit */
+{
+    size_t payload = out->len - start - GPS_BINARY_HEADER;
+
+    if (out->overflow || payload > 0xffff) {
+	out->len = start;
+	return;
+    }
+    putbe16(out->buf, start + 4, payload);
+}
+
+static void binary_tpv(const struct gps_data_t *gpsdata,
+		       struct json_out_t *out)
+{
+    struct gps_fix_t fix = gpsdata->fix;
+    double nav[4];
+    int status = gpsdata->status;
+    size_t start;
+
+    nav[0] = gpsdata->navigation.course_over_ground[compass_true];
+    nav[1] = gpsdata->navigation.speed_over_ground;
+    nav[2] = gpsdata->navigation.epd;
+    nav[3] = gpsdata->navigation.eps;
+    /* the same suppression json_tpv_dump() does */
+    if (fix.mode < MODE_2D) {
+	fix.latitude = fix.longitude = NAN;
+	fix.epx = fix.epy = NAN;
+	nav[0] = nav[1] = nav[2] = nav[3] = NAN;
+    }
+    if (fix.mode < MODE_3D)
+	fix.altitude = fix.epv = fix.climb = fix.epc = NAN;
+
+    start = binary_begin(out, GPS_BINARY_TPV, gpsdata->dev.path,
+			 gpsdata->tag[0] != '\0' ? gpsdata->tag : "-");
+    json_out_mem(out, (const char *)&status, sizeof(status));
+    json_out_mem(out, (const char *)&fix, sizeof(fix));
+    json_out_mem(out, (const char *)nav, sizeof(nav));
+    binary_end(out, start);
+}
+
+static void binary_sky(const struct gps_data_t *datap,
+		       struct json_out_t *out)
+{
+    int i, j, n = 0, reported = 0;
+    size_t start;
+
+    /* the same insurance against flaky drivers json_sky_dump() has */
+    for (i = 0; i < datap->satellites_visible; i++)
+	if (datap->PRN[i])
+	    reported++;
+    for (i = 0; i < reported; i++)
+	if (datap->PRN[i])
+	    n++;
+
+    start = binary_begin(out, GPS_BINARY_SKY, datap->dev.path,
+			 datap->tag[0] != '\0' ? datap->tag : "-");
+    json_out_mem(out, (const char *)&datap->skyview_time,
+		 sizeof(datap->skyview_time));
+    json_out_mem(out, (const char *)&datap->dop, sizeof(datap->dop));
+    json_out_mem(out, (const char *)&n, sizeof(n));
+    for (i = 0; i < reported; i++) {
+	int used = 0;
+
+	if (datap->PRN[i] == 0)
+	    continue;
+	for (j = 0; j < datap->satellites_used; j++)
+	    if (datap->used[j] == datap->PRN[i]) {
+		used = 1;
+		break;
+	    }
+	json_out_mem(out, (const char *)&datap->PRN[i], sizeof(int));
+	json_out_mem(out, (const char *)&datap->elevation[i], sizeof(int));
+	json_out_mem(out, (const char *)&datap->azimuth[i], sizeof(int));
+	json_out_mem(out, (const char *)&datap->ss[i], sizeof(double));
+	json_out_mem(out, (const char *)&used, sizeof(used));
+    }
+    binary_end(out, start);
+}
+
+#ifdef AIVDM_ENABLE
+static size_t binary_ais_size(const struct ais_t *ais)
+/* how much of struct ais_t this message type actually uses */
+{
+#define AIS_PREFIX(member) \
+    (offsetof(struct ais_t, member) + sizeof(((struct ais_t *)0)->member))
+    switch (ais->type) {
+    case 1:
+    case 2:
+    case 3:
+	return AIS_PREFIX(type1);
+    case 4:
+    case 11:
+	return AIS_PREFIX(type4);
+    case 5:
+	return AIS_PREFIX(type5);
+    case 7:
+    case 13:
+	return AIS_PREFIX(type7);
+    case 9:
+	return AIS_PREFIX(type9);
+    case 10:
+	return AIS_PREFIX(type10);
+    case 14:
+	return AIS_PREFIX(type14);
+    case 15:
+	return AIS_PREFIX(type15);
+    case 16:
+	return AIS_PREFIX(type16);
+    case 18:
+	return AIS_PREFIX(type18);
+    case 19:
+	return AIS_PREFIX(type19);
+    case 20:
+	return AIS_PREFIX(type20);
+    case 21:
+	return AIS_PREFIX(type21);
+    case 22:
+	return AIS_PREFIX(type22);
+    case 23:
+	return AIS_PREFIX(type23);
+    case 24:
+	return AIS_PREFIX(type24);
+    case 27:
+	return AIS_PREFIX(type27);
+    default:
+	/* binary messages and anything unusual go whole */
+	return sizeof(struct ais_t);
+    }
+#undef AIS_PREFIX
+}
+
+static void binary_ais(const struct gps_data_t *datap,
+		       struct json_out_t *out)
+{
+    size_t start = binary_begin(out, GPS_BINARY_AIS, datap->dev.path, "");
+
+    json_out_mem(out, (const char *)&datap->ais, binary_ais_size(&datap->ais));
+    binary_end(out, start);
+}
+#endif /* AIVDM_ENABLE */
+
+size_t binary_data_report(const gps_mask_t changed,
+			  const struct gps_device_t *session,
+			  /*@out@*/char *buf, size_t buflen)
+/* report a session state as binary records; returns the bytes written */
+{
+    const struct gps_data_t *datap = &session->gpsdata;
+    struct json_out_t out;
+
+    json_out_init(&out, buf, buflen);
+    if ((changed & REPORT_IS) != 0)
+	binary_tpv(datap, &out);
+    if ((changed & SATELLITE_SET) != 0)
+	binary_sky(datap, &out);
+#ifdef AIVDM_ENABLE
+    if ((changed & AIS_SET) != 0)
+	binary_ais(datap, &out);
+#endif /* AIVDM_ENABLE */
+    return out.len;
+}
+
+#endif /* SOCKET_EXPORT_ENABLE */
+
+/* gpsd_binary.c ends here */
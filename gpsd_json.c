@@ -120,39 +120,29 @@ void json_version_dump( /*@out@*/ char *reply, size_t replylen)
 #endif /* TIMING_ENABLE */
 
 
-void json_tpv_dump(const struct gps_device_t *session,
-		   const struct policy_t *policy CONDITIONALLY_UNUSED,
-		   /*@out@*/ char *reply, size_t replylen)
+static void json_tpv_emit(const struct gps_device_t *session,
+			  const struct policy_t *policy CONDITIONALLY_UNUSED,
+			  struct json_out_t *out)
 {
     const struct gps_data_t *gpsdata = &session->gpsdata;
 #ifdef TIMING_ENABLE
     timestamp_t rtime = timestamp();
 #endif /* TIMING_ENABLE */
 
-    assert(replylen > 2);
-    (void)strlcpy(reply, "{\"class\":\"TPV\",", replylen);
-    (void)snprintf(reply + strlen(reply),
-		   replylen - strlen(reply),
-		   "\"tag\":\"%s\",",
-		   gpsdata->tag[0] != '\0' ? gpsdata->tag : "-");
+    json_out_raw(out, "{\"class\":\"TPV\",");
+    json_out_member_str(out, "tag",
+			gpsdata->tag[0] != '\0' ? gpsdata->tag : "-");
     if (gpsdata->dev.path[0] != '\0')
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"device\":\"%s\",", gpsdata->dev.path);
-    (void)snprintf(reply + strlen(reply),
-		   replylen - strlen(reply),
-		   "\"mode\":%d,", gpsdata->fix.mode);
+	json_out_member_str(out, "device", gpsdata->dev.path);
+    json_out_member_int(out, "mode", gpsdata->fix.mode);
     if (isnan(gpsdata->fix.time) == 0) {
 	char tbuf[JSON_DATE_MAX+1];
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"time\":\"%s\",",
-		       unix_to_iso8601(gpsdata->fix.time, tbuf, sizeof(tbuf)));
+	json_out_member_str(out, "time",
+			    unix_to_iso8601(gpsdata->fix.time,
+					    tbuf, sizeof(tbuf)));
     }
     if (isnan(gpsdata->fix.ept) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"ept\":%.3f,", gpsdata->fix.ept);
+	json_out_member_fixed(out, "ept", gpsdata->fix.ept, 3);
     /*
      * Suppressing TPV fields that would be invalid because the fix
      * quality doesn't support them is nice for cutting down on the
@@ -165,78 +155,64 @@ void json_tpv_dump(const struct gps_device_t *session,
      */
     if (gpsdata->fix.mode >= MODE_2D) {
 	if (isnan(gpsdata->fix.latitude) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"lat\":%.9f,", gpsdata->fix.latitude);
+	    json_out_member_fixed(out, "lat", gpsdata->fix.latitude, 9);
 	if (isnan(gpsdata->fix.longitude) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"lon\":%.9f,", gpsdata->fix.longitude);
+	    json_out_member_fixed(out, "lon", gpsdata->fix.longitude, 9);
 	if (gpsdata->fix.mode >= MODE_3D && isnan(gpsdata->fix.altitude) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"alt\":%.3f,", gpsdata->fix.altitude);
+	    json_out_member_fixed(out, "alt", gpsdata->fix.altitude, 3);
 	if (isnan(gpsdata->fix.epx) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"epx\":%.3f,", gpsdata->fix.epx);
+	    json_out_member_fixed(out, "epx", gpsdata->fix.epx, 3);
 	if (isnan(gpsdata->fix.epy) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"epy\":%.3f,", gpsdata->fix.epy);
+	    json_out_member_fixed(out, "epy", gpsdata->fix.epy, 3);
 	if ((gpsdata->fix.mode >= MODE_3D) && isnan(gpsdata->fix.epv) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"epv\":%.3f,", gpsdata->fix.epv);
+	    json_out_member_fixed(out, "epv", gpsdata->fix.epv, 3);
 	if (isnan(gpsdata->navigation.course_over_ground[compass_true]) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"cog\":%.4f,", gpsdata->navigation.course_over_ground[compass_true]);
+	    json_out_member_fixed(out, "cog",
+				  gpsdata->navigation.course_over_ground[compass_true], 4);
 	if (isnan(gpsdata->navigation.speed_over_ground) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"sog\":%.3f,", gpsdata->navigation.speed_over_ground);
+	    json_out_member_fixed(out, "sog",
+				  gpsdata->navigation.speed_over_ground, 3);
 	if ((gpsdata->fix.mode >= MODE_3D) && isnan(gpsdata->fix.climb) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"climb\":%.3f,", gpsdata->fix.climb);
+	    json_out_member_fixed(out, "climb", gpsdata->fix.climb, 3);
 	if (isnan(gpsdata->navigation.epd) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"epd\":%.4f,", gpsdata->navigation.epd);
+	    json_out_member_fixed(out, "epd", gpsdata->navigation.epd, 4);
 	if (isnan(gpsdata->navigation.eps) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"eps\":%.2f,", gpsdata->navigation.eps);	
+	    json_out_member_fixed(out, "eps", gpsdata->navigation.eps, 2);
 	if ((gpsdata->fix.mode >= MODE_3D) && isnan(gpsdata->fix.epc) == 0)
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"epc\":%.2f,", gpsdata->fix.epc);
+	    json_out_member_fixed(out, "epc", gpsdata->fix.epc, 2);
 #ifdef TIMING_ENABLE
 	if (policy->timing) {
 #ifdef PPS_ENABLE
 	    /*@-type -formattype@*/ /* splint is confused about struct timespec */
 	    if (session->ppscount)
-		(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-			       "\"pps\":%.9f,", 
-			       session->ppslast.clock.tv_sec + session->ppslast.clock.tv_nsec / 1e9);
+		json_out_member_fixed(out, "pps",
+				      session->ppslast.clock.tv_sec + session->ppslast.clock.tv_nsec / 1e9, 9);
 	    /*@+type +formattype@*/
 #endif /* PPS_ENABLE */
-	    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-			   "\"sor\":%.9f,\"chars\":%lu,\"sats\":%2d,\"rtime\":%.9f,\"week\":%u,\"tow\":%.3f,\"rollovers\":%d",
-			   session->sor,
-			   session->chars,
-			   gpsdata->satellites_used,
-			   rtime,
-			   session->context->gps_week,
-			   session->context->gps_tow,
-			   session->context->rollovers);
+	    json_out_member_fixed(out, "sor", session->sor, 9);
+	    json_out_member_uint(out, "chars", session->chars);
+	    json_out_printf(out, "\"sats\":%2d,", gpsdata->satellites_used);
+	    json_out_member_fixed(out, "rtime", rtime, 9);
+	    json_out_member_uint(out, "week", session->context->gps_week);
+	    json_out_member_fixed(out, "tow", session->context->gps_tow, 3);
+	    json_out_key(out, "rollovers");
+	    json_out_int(out, session->context->rollovers);
 	}
 #endif /* TIMING_ENABLE */
     }
-    if (reply[strlen(reply) - 1] == ',')
-	reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
-    (void)strlcat(reply, "}\r\n", replylen);
+    json_out_trim(out);
+    json_out_raw(out, "}\r\n");
+}
+
+void json_tpv_dump(const struct gps_device_t *session,
+		   const struct policy_t *policy CONDITIONALLY_UNUSED,
+		   /*@out@*/ char *reply, size_t replylen)
+{
+    struct json_out_t out;
+
+    assert(replylen > 2);
+    json_out_init(&out, reply, replylen);
+    json_tpv_emit(session, policy, &out);
 }
 
 void json_noise_dump(const struct gps_data_t *gpsdata,
@@ -280,62 +256,41 @@ void json_noise_dump(const struct gps_data_t *gpsdata,
     (void)strlcat(reply, "}\r\n", replylen);
 }
 
-void json_sky_dump(const struct gps_data_t *datap,
-		   /*@out@*/ char *reply, size_t replylen)
+static void json_sky_emit(const struct gps_data_t *datap,
+			  struct json_out_t *out)
 {
     int i, reported = 0;
 
-    assert(replylen > 2);
-    (void)strlcpy(reply, "{\"class\":\"SKY\",", replylen);
-    (void)snprintf(reply + strlen(reply),
-		   replylen - strlen(reply),
-		   "\"tag\":\"%s\",",
-		   datap->tag[0] != '\0' ? datap->tag : "-");
+    json_out_raw(out, "{\"class\":\"SKY\",");
+    json_out_member_str(out, "tag", datap->tag[0] != '\0' ? datap->tag : "-");
     if (datap->dev.path[0] != '\0')
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"device\":\"%s\",", datap->dev.path);
+	json_out_member_str(out, "device", datap->dev.path);
     if (isnan(datap->skyview_time) == 0) {
 	char tbuf[JSON_DATE_MAX+1];
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"time\":\"%s\",",
-		       unix_to_iso8601(datap->skyview_time, tbuf, sizeof(tbuf)));
+	json_out_member_str(out, "time",
+			    unix_to_iso8601(datap->skyview_time,
+					    tbuf, sizeof(tbuf)));
     }
     if (isnan(datap->dop.xdop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"xdop\":%.2f,", datap->dop.xdop);
+	json_out_member_fixed(out, "xdop", datap->dop.xdop, 2);
     if (isnan(datap->dop.ydop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"ydop\":%.2f,", datap->dop.ydop);
+	json_out_member_fixed(out, "ydop", datap->dop.ydop, 2);
     if (isnan(datap->dop.vdop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"vdop\":%.2f,", datap->dop.vdop);
+	json_out_member_fixed(out, "vdop", datap->dop.vdop, 2);
     if (isnan(datap->dop.tdop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"tdop\":%.2f,", datap->dop.tdop);
+	json_out_member_fixed(out, "tdop", datap->dop.tdop, 2);
     if (isnan(datap->dop.hdop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"hdop\":%.2f,", datap->dop.hdop);
+	json_out_member_fixed(out, "hdop", datap->dop.hdop, 2);
     if (isnan(datap->dop.gdop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"gdop\":%.2f,", datap->dop.gdop);
+	json_out_member_fixed(out, "gdop", datap->dop.gdop, 2);
     if (isnan(datap->dop.pdop) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"pdop\":%.2f,", datap->dop.pdop);
+	json_out_member_fixed(out, "pdop", datap->dop.pdop, 2);
     /* insurance against flaky drivers */
     for (i = 0; i < datap->satellites_visible; i++)
 	if (datap->PRN[i])
 	    reported++;
     if (reported) {
-	(void)strlcat(reply, "\"satellites\":[", replylen);
+	json_out_raw(out, "\"satellites\":[");
 	for (i = 0; i < reported; i++) {
 	    int j; 
 	    bool used = false;
@@ -345,21 +300,32 @@ void json_sky_dump(const struct gps_data_t *datap,
 		    break;
 		}
 	    if (datap->PRN[i]) {
-		(void)snprintf(reply + strlen(reply),
-			       replylen - strlen(reply),
-			       "{\"PRN\":%d,\"el\":%d,\"az\":%d,\"ss\":%.0f,\"used\":%s},",
-			       datap->PRN[i],
-			       datap->elevation[i], datap->azimuth[i],
-			       datap->ss[i], used ? "true" : "false");
+		json_out_raw(out, "{\"PRN\":");
+		json_out_int(out, datap->PRN[i]);
+		json_out_raw(out, ",\"el\":");
+		json_out_int(out, datap->elevation[i]);
+		json_out_raw(out, ",\"az\":");
+		json_out_int(out, datap->azimuth[i]);
+		json_out_raw(out, ",\"ss\":");
+		json_out_fixed(out, datap->ss[i], 0);
+		json_out_raw(out, used ? ",\"used\":true}," : ",\"used\":false},");
 	    }
 	}
-	if (reply[strlen(reply) - 1] == ',')
-	    reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
-	(void)strlcat(reply, "]", replylen);
+	json_out_trim(out);
+	json_out_char(out, ']');
     }
-    if (reply[strlen(reply) - 1] == ',')
-	reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
-    (void)strlcat(reply, "}\r\n", replylen);
+    json_out_trim(out);
+    json_out_raw(out, "}\r\n");
+}
+
+void json_sky_dump(const struct gps_data_t *datap,
+		   /*@out@*/ char *reply, size_t replylen)
+{
+    struct json_out_t out;
+
+    assert(replylen > 2);
+    json_out_init(&out, reply, replylen);
+    json_sky_emit(datap, &out);
 }
 
 void json_device_dump(const struct gps_device_t *device,
@@ -490,6 +456,13 @@ void json_watch_dump(const struct policy_t *ccp,
 		   ccp->timing ? "true" : "false",
 		   ccp->split24 ? "true" : "false",
 		   ccp->pps ? "true" : "false");
+    if (ccp->binary)
+	(void)strlcat(reply, "\"binary\":true,", replylen);
+    if (ccp->targets > 0)
+	(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+		       "\"targets\":%d,", ccp->targets);
+    if (ccp->cpa)
+	(void)strlcat(reply, "\"cpa\":true,", replylen);
     if (ccp->devpath[0] != '\0')
 	(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
 		       "\"device\":\"%s\",", ccp->devpath);
@@ -1423,9 +1396,9 @@ void json_rtcm3_dump(const struct rtcm3_t *rtcm,
 #endif /* defined(RTCM104V3_ENABLE) */
 
 #if defined(AIVDM_ENABLE)
-void json_aivdm_dump(const struct ais_t *ais,
-		     /*@null@*/const char *device, bool scaled,
-		     /*@out@*/char *buf, size_t buflen)
+static void json_aivdm_emit(const struct ais_t *ais,
+			    /*@null@*/const char *device, bool scaled,
+			    struct json_out_t *out)
 {
     char buf1[JSON_VAL_MAX * 2 + 1];
     char buf2[JSON_VAL_MAX * 2 + 1];
@@ -1730,37 +1703,39 @@ void json_aivdm_dump(const struct ais_t *ais,
 	"Reserved for future use",
     };
 
-    (void)snprintf(buf, buflen, "{\"class\":\"AIS\",");
+    json_out_raw(out, "{\"class\":\"AIS\",");
     if (device != NULL && device[0] != '\0')
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"device\":\"%s\",", device);
-    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		   "\"type\":%u,\"repeat\":%u,\"mmsi\":%u,\"scaled\":%s,",
-		   ais->type, ais->repeat, ais->mmsi, JSON_BOOL(scaled));
+	json_out_member_str(out, "device", device);
+    json_out_member_uint(out, "type", ais->type);
+    json_out_member_uint(out, "repeat", ais->repeat);
+    json_out_member_uint(out, "mmsi", ais->mmsi);
+    json_out_member_bool(out, "scaled", scaled);
     /*@ -formatcode -mustfreefresh @*/
     switch (ais->type) {
     case 1:			/* Position Report */
     case 2:
     case 3:
 	if (scaled) {
-	    char turnlegend[20];
-	    char speedlegend[20];
+	    json_out_key(out, "status");
+	    json_out_char(out, '"');
+	    json_out_uint(out, ais->type1.status);
+	    json_out_raw(out, "\",");
+	    json_out_member_str(out, "status_text",
+				nav_legends[ais->type1.status]);
 
 	    /*
 	     * Express turn as nan if not available,
 	     * "fastleft"/"fastright" for fast turns.
 	     */
 	    if (ais->type1.turn == -128)
-		(void)strlcpy(turnlegend, "\"nan\"", sizeof(turnlegend));
+		json_out_member_raw(out, "turn", "\"nan\"");
 	    else if (ais->type1.turn == -127)
-		(void)strlcpy(turnlegend, "\"fastleft\"", sizeof(turnlegend));
+		json_out_member_raw(out, "turn", "\"fastleft\"");
 	    else if (ais->type1.turn == 127)
-		(void)strlcpy(turnlegend, "\"fastright\"",
-			      sizeof(turnlegend));
+		json_out_member_raw(out, "turn", "\"fastright\"");
 	    else {
 		double rot1 = ais->type1.turn / 4.733;
-		(void)snprintf(turnlegend, sizeof(turnlegend),
-			       "%.0f", rot1 * rot1);
+		json_out_member_fixed(out, "turn", rot1 * rot1, 0);
 	    }
 
 	    /*
@@ -1768,179 +1743,114 @@ void json_aivdm_dump(const struct ais_t *ais,
 	     * "fast" for fast movers.
 	     */
 	    if (ais->type1.speed == AIS_SPEED_NOT_AVAILABLE)
-		(void)strlcpy(speedlegend, "\"nan\"", sizeof(speedlegend));
+		json_out_member_raw(out, "speed", "\"nan\"");
 	    else if (ais->type1.speed == AIS_SPEED_FAST_MOVER)
-		(void)strlcpy(speedlegend, "\"fast\"", sizeof(speedlegend));
+		json_out_member_raw(out, "speed", "\"fast\"");
 	    else
-		(void)snprintf(speedlegend, sizeof(speedlegend),
-			       "%.1f", ais->type1.speed / 10.0);
+		json_out_member_scaled(out, "speed", (long long)ais->type1.speed, 1);
 
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"status\":\"%u\",\"status_text\":\"%s\","
-			   "\"turn\":%s,\"speed\":%s,"
-			   "\"accuracy\":%s,\"lon\":%.4f,\"lat\":%.4f,"
-			   "\"course\":%.1f,\"heading\":%u,\"second\":%u,"
-			   "\"maneuver\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type1.status,
-			   nav_legends[ais->type1.status],
-			   turnlegend,
-			   speedlegend,
-			   JSON_BOOL(ais->type1.accuracy),
-			   ais->type1.lon / AIS_LATLON_DIV,
-			   ais->type1.lat / AIS_LATLON_DIV,
-			   ais->type1.course / 10.0,
-			   ais->type1.heading,
-			   ais->type1.second,
-			   ais->type1.maneuver,
-			   JSON_BOOL(ais->type1.raim), ais->type1.radio);
+	    json_out_member_bool(out, "accuracy", ais->type1.accuracy);
+	    json_out_member_fixed(out, "lon", ais->type1.lon / AIS_LATLON_DIV, 4);
+	    json_out_member_fixed(out, "lat", ais->type1.lat / AIS_LATLON_DIV, 4);
+	    json_out_member_scaled(out, "course", (long long)ais->type1.course, 1);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"status\":%u,\"status_text\":\"%s\","
-			   "\"turn\":%d,\"speed\":%u,"
-			   "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-			   "\"course\":%u,\"heading\":%u,\"second\":%u,"
-			   "\"maneuver\":%u,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type1.status,
-			   nav_legends[ais->type1.status],
-			   ais->type1.turn,
-			   ais->type1.speed,
-			   JSON_BOOL(ais->type1.accuracy),
-			   ais->type1.lon,
-			   ais->type1.lat,
-			   ais->type1.course,
-			   ais->type1.heading,
-			   ais->type1.second,
-			   ais->type1.maneuver,
-			   JSON_BOOL(ais->type1.raim), ais->type1.radio);
+	    json_out_member_uint(out, "status", ais->type1.status);
+	    json_out_member_str(out, "status_text",
+				nav_legends[ais->type1.status]);
+	    json_out_member_int(out, "turn", ais->type1.turn);
+	    json_out_member_uint(out, "speed", ais->type1.speed);
+	    json_out_member_bool(out, "accuracy", ais->type1.accuracy);
+	    json_out_member_int(out, "lon", ais->type1.lon);
+	    json_out_member_int(out, "lat", ais->type1.lat);
+	    json_out_member_uint(out, "course", ais->type1.course);
 	}
+	json_out_member_uint(out, "heading", ais->type1.heading);
+	json_out_member_uint(out, "second", ais->type1.second);
+	json_out_member_uint(out, "maneuver", ais->type1.maneuver);
+	json_out_member_bool(out, "raim", ais->type1.raim);
+	json_out_key(out, "radio");
+	json_out_uint(out, ais->type1.radio);
+	json_out_raw(out, "}\r\n");
 	break;
     case 4:			/* Base Station Report */
     case 11:			/* UTC/Date Response */
 	/* some fields have beem merged to an ISO8601 date */
+	json_out_raw(out, "\"timestamp\":\"");
+	json_out_uint_pad(out, ais->type4.year, 4);
+	json_out_char(out, '-');
+	json_out_uint_pad(out, ais->type4.month, 2);
+	json_out_char(out, '-');
+	json_out_uint_pad(out, ais->type4.day, 2);
+	json_out_char(out, 'T');
+	json_out_uint_pad(out, ais->type4.hour, 2);
+	json_out_char(out, ':');
+	json_out_uint_pad(out, ais->type4.minute, 2);
+	json_out_char(out, ':');
+	json_out_uint_pad(out, ais->type4.second, 2);
+	json_out_raw(out, "Z\",");
+	json_out_member_bool(out, "accuracy", ais->type4.accuracy);
 	if (scaled) {
-	    // The use of %u instead of %04u for the year is to allow
-	    // out-of-band year values.
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"timestamp\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\","
-			   "\"accuracy\":%s,\"lon\":%.4f,\"lat\":%.4f,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type4.year,
-			   ais->type4.month,
-			   ais->type4.day,
-			   ais->type4.hour,
-			   ais->type4.minute,
-			   ais->type4.second,
-			   JSON_BOOL(ais->type4.accuracy),
-			   ais->type4.lon / AIS_LATLON_DIV,
-			   ais->type4.lat / AIS_LATLON_DIV,
-			   ais->type4.epfd,
-			   EPFD_DISPLAY(ais->type4.epfd),
-			   JSON_BOOL(ais->type4.raim), ais->type4.radio);
+	    json_out_member_fixed(out, "lon", ais->type4.lon / AIS_LATLON_DIV, 4);
+	    json_out_member_fixed(out, "lat", ais->type4.lat / AIS_LATLON_DIV, 4);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"timestamp\":\"%04u-%02u-%02uT%02u:%02u:%02uZ\","
-			   "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type4.year,
-			   ais->type4.month,
-			   ais->type4.day,
-			   ais->type4.hour,
-			   ais->type4.minute,
-			   ais->type4.second,
-			   JSON_BOOL(ais->type4.accuracy),
-			   ais->type4.lon,
-			   ais->type4.lat,
-			   ais->type4.epfd,
-			   EPFD_DISPLAY(ais->type4.epfd),
-			   JSON_BOOL(ais->type4.raim), ais->type4.radio);
+	    json_out_member_int(out, "lon", ais->type4.lon);
+	    json_out_member_int(out, "lat", ais->type4.lat);
 	}
+	json_out_member_uint(out, "epfd", ais->type4.epfd);
+	json_out_member_str(out, "epfd_text", EPFD_DISPLAY(ais->type4.epfd));
+	json_out_member_bool(out, "raim", ais->type4.raim);
+	json_out_key(out, "radio");
+	json_out_uint(out, ais->type4.radio);
+	json_out_raw(out, "}\r\n");
 	break;
     case 5:			/* Ship static and voyage related data */
 	/* some fields have beem merged to an ISO8601 partial date */
-	if (scaled) {
-            /* *INDENT-OFF* */
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"imo\":%u,\"ais_version\":%u,\"callsign\":\"%s\","
-			   "\"shipname\":\"%s\","
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"eta\":\"%02u-%02uT%02u:%02uZ\","
-			   "\"draught\":%.1f,\"destination\":\"%s\","
-			   "\"dte\":%u}\r\n",
-			   ais->type5.imo,
-			   ais->type5.ais_version,
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type5.callsign),
-			   json_stringify(buf2, sizeof(buf2),
-					  ais->type5.shipname),
-			   ais->type5.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type5.shiptype),
-			   ais->type5.to_bow, ais->type5.to_stern,
-			   ais->type5.to_port, ais->type5.to_starboard,
-			   ais->type5.epfd,
-			   EPFD_DISPLAY(ais->type5.epfd),
-			   ais->type5.month,
-			   ais->type5.day,
-			   ais->type5.hour, ais->type5.minute,
-			   ais->type5.draught / 10.0,
-			   json_stringify(buf3, sizeof(buf3),
-					  ais->type5.destination),
-			   ais->type5.dte);
-            /* *INDENT-ON* */
-	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"imo\":%u,\"ais_version\":%u,\"callsign\":\"%s\","
-			   "\"shipname\":\"%s\","
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"eta\":\"%02u-%02uT%02u:%02uZ\","
-			   "\"draught\":%u,\"destination\":\"%s\","
-			   "\"dte\":%u}\r\n",
-			   ais->type5.imo,
-			   ais->type5.ais_version,
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type5.callsign),
-			   json_stringify(buf2, sizeof(buf2),
-					  ais->type5.shipname),
-			   ais->type5.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type5.shiptype),
-			   ais->type5.to_bow,
-			   ais->type5.to_stern,
-			   ais->type5.to_port,
-			   ais->type5.to_starboard,
-			   ais->type5.epfd,
-			   EPFD_DISPLAY(ais->type5.epfd),
-			   ais->type5.month,
-			   ais->type5.day,
-			   ais->type5.hour,
-			   ais->type5.minute,
-			   ais->type5.draught,
-			   json_stringify(buf3, sizeof(buf3),
-					  ais->type5.destination),
-			   ais->type5.dte);
-	}
+	json_out_member_uint(out, "imo", ais->type5.imo);
+	json_out_member_uint(out, "ais_version", ais->type5.ais_version);
+	json_out_member_string(out, "callsign", ais->type5.callsign);
+	json_out_member_string(out, "shipname", ais->type5.shipname);
+	json_out_member_uint(out, "shiptype", ais->type5.shiptype);
+	json_out_member_str(out, "shiptype_text",
+			    SHIPTYPE_DISPLAY(ais->type5.shiptype));
+	json_out_member_uint(out, "to_bow", ais->type5.to_bow);
+	json_out_member_uint(out, "to_stern", ais->type5.to_stern);
+	json_out_member_uint(out, "to_port", ais->type5.to_port);
+	json_out_member_uint(out, "to_starboard", ais->type5.to_starboard);
+	json_out_member_uint(out, "epfd", ais->type5.epfd);
+	json_out_member_str(out, "epfd_text", EPFD_DISPLAY(ais->type5.epfd));
+	json_out_raw(out, "\"eta\":\"");
+	json_out_uint_pad(out, ais->type5.month, 2);
+	json_out_char(out, '-');
+	json_out_uint_pad(out, ais->type5.day, 2);
+	json_out_char(out, 'T');
+	json_out_uint_pad(out, ais->type5.hour, 2);
+	json_out_char(out, ':');
+	json_out_uint_pad(out, ais->type5.minute, 2);
+	json_out_raw(out, "Z\",");
+	if (scaled)
+	    json_out_member_scaled(out, "draught", (long long)ais->type5.draught, 1);
+	else
+	    json_out_member_uint(out, "draught", ais->type5.draught);
+	json_out_member_string(out, "destination", ais->type5.destination);
+	json_out_key(out, "dte");
+	json_out_uint(out, ais->type5.dte);
+	json_out_raw(out, "}\r\n");
 	break;
     case 6:			/* Binary Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"seqno\":%u,\"dest_mmsi\":%u,"
-		       "\"retransmit\":%s,\"dac\":%u,\"fid\":%u,",
-		       ais->type6.seqno,
-		       ais->type6.dest_mmsi,
-		       JSON_BOOL(ais->type6.retransmit),
-		       ais->type6.dac,
-		       ais->type6.fid);
+	json_out_printf(out,
+			"\"seqno\":%u,\"dest_mmsi\":%u,"
+			"\"retransmit\":%s,\"dac\":%u,\"fid\":%u,",
+			ais->type6.seqno,
+			ais->type6.dest_mmsi,
+			JSON_BOOL(ais->type6.retransmit),
+			ais->type6.dac,
+			ais->type6.fid);
 	structured = false;
 	if (ais->type6.dac == 200) {
 	    switch (ais->type6.fid) {
 	    case 21:
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"country\":\"%s\",\"locode\":\"%s\",\"section\":\"%s\",\"terminal\":\"%s\",\"hectometre\":\"%s\",\"eta\":\"%u-%uT%u:%u\",\"tugs\":%u,\"airdraught\":%u}",
+		json_out_printf(out,
+				"\"country\":\"%s\",\"locode\":\"%s\",\"section\":\"%s\",\"terminal\":\"%s\",\"hectometre\":\"%s\",\"eta\":\"%u-%uT%u:%u\",\"tugs\":%u,\"airdraught\":%u}",
 		    ais->type6.dac200fid21.country,
 		    ais->type6.dac200fid21.locode,
 		    ais->type6.dac200fid21.section,
@@ -1954,26 +1864,26 @@ void json_aivdm_dump(const struct ais_t *ais,
 		    ais->type6.dac200fid21.airdraught);
 		break;
 	    case 22:
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"country\":\"%s\",\"locode\":\"%s\","
-			       "\"section\":\"%s\","
-			       "\"terminal\":\"%s\",\"hectometre\":\"%s\","
-			       "\"eta\":\"%u-%uT%u:%u\","
-			       "\"status\":%u,\"status_text\":\"%s\"}",
-			       ais->type6.dac200fid22.country,
-			       ais->type6.dac200fid22.locode,
-			       ais->type6.dac200fid22.section,
-			       ais->type6.dac200fid22.terminal,
-			       ais->type6.dac200fid22.hectometre,
-			       ais->type6.dac200fid22.month,
-			       ais->type6.dac200fid22.day,
-			       ais->type6.dac200fid22.hour,
-			       ais->type6.dac200fid22.minute,
-			       ais->type6.dac200fid22.status,
-			       rta_status[ais->type6.dac200fid22.status]);
+		json_out_printf(out,
+				"\"country\":\"%s\",\"locode\":\"%s\","
+				"\"section\":\"%s\","
+				"\"terminal\":\"%s\",\"hectometre\":\"%s\","
+				"\"eta\":\"%u-%uT%u:%u\","
+				"\"status\":%u,\"status_text\":\"%s\"}",
+				ais->type6.dac200fid22.country,
+				ais->type6.dac200fid22.locode,
+				ais->type6.dac200fid22.section,
+				ais->type6.dac200fid22.terminal,
+				ais->type6.dac200fid22.hectometre,
+				ais->type6.dac200fid22.month,
+				ais->type6.dac200fid22.day,
+				ais->type6.dac200fid22.hour,
+				ais->type6.dac200fid22.minute,
+				ais->type6.dac200fid22.status,
+				rta_status[ais->type6.dac200fid22.status]);
 		break;
 	    case 55:
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		    "\"crew\":%u,\"passengers\":%u,\"personnel\":%u}",
 
 		    ais->type6.dac200fid55.crew,
@@ -1985,48 +1895,47 @@ void json_aivdm_dump(const struct ais_t *ais,
 	else if (ais->type6.dac == 235 || ais->type6.dac == 250) {
 	    switch (ais->type6.fid) {
 	    case 10:	/* GLA - AtoN monitoring data */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"off_pos\":%s,\"alarm\":%s,"
-			       "\"stat_ext\":%u,",
-			       JSON_BOOL(ais->type6.dac235fid10.off_pos),
-			       JSON_BOOL(ais->type6.dac235fid10.alarm),
-			       ais->type6.dac235fid10.stat_ext);
+		json_out_printf(out,
+				"\"off_pos\":%s,\"alarm\":%s,"
+				"\"stat_ext\":%u,",
+				JSON_BOOL(ais->type6.dac235fid10.off_pos),
+				JSON_BOOL(ais->type6.dac235fid10.alarm),
+				ais->type6.dac235fid10.stat_ext);
 		if (scaled && ais->type6.dac235fid10.ana_int != 0)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"ana_int\":%.2f,",
-				   ais->type6.dac235fid10.ana_int*0.05);
+		    json_out_printf(out,
+				    "\"ana_int\":%.2f,",
+				    ais->type6.dac235fid10.ana_int*0.05);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"ana_int\":%u,",
-				   ais->type6.dac235fid10.ana_int);
+		    json_out_printf(out,
+				    "\"ana_int\":%u,",
+				    ais->type6.dac235fid10.ana_int);
 		if (scaled && ais->type6.dac235fid10.ana_ext1 != 0)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"ana_ext1\":%.2f,",
-				   ais->type6.dac235fid10.ana_ext1*0.05);
+		    json_out_printf(out,
+				    "\"ana_ext1\":%.2f,",
+				    ais->type6.dac235fid10.ana_ext1*0.05);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"ana_ext1\":%u,",
-				   ais->type6.dac235fid10.ana_ext1);
+		    json_out_printf(out,
+				    "\"ana_ext1\":%u,",
+				    ais->type6.dac235fid10.ana_ext1);
 		if (scaled && ais->type6.dac235fid10.ana_ext2 != 0)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"ana_ext2\":%.2f,",
-				   ais->type6.dac235fid10.ana_ext2*0.05);
+		    json_out_printf(out,
+				    "\"ana_ext2\":%.2f,",
+				    ais->type6.dac235fid10.ana_ext2*0.05);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"ana_ext2\":%u,",
-				   ais->type6.dac235fid10.ana_ext2);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"racon\":%u,"
-			       "\"racon_text\":\"%s\","
-			       "\"light\":%u,"
-			       "\"light_text\":\"%s\"",
-			       ais->type6.dac235fid10.racon,
-			       racon_status[ais->type6.dac235fid10.racon],
-			       ais->type6.dac235fid10.light,
-			       light_status[ais->type6.dac235fid10.light]);
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf)-1] = '\0';
-		(void)strlcat(buf, "}\r\n", buflen);
+		    json_out_printf(out,
+				    "\"ana_ext2\":%u,",
+				    ais->type6.dac235fid10.ana_ext2);
+		json_out_printf(out,
+				"\"racon\":%u,"
+				"\"racon_text\":\"%s\","
+				"\"light\":%u,"
+				"\"light_text\":\"%s\"",
+				ais->type6.dac235fid10.racon,
+				racon_status[ais->type6.dac235fid10.racon],
+				ais->type6.dac235fid10.light,
+				light_status[ais->type6.dac235fid10.light]);
+		json_out_trim(out);
+		json_out_raw(out, "}\r\n");
 		structured = true;
 		break;
 	    }
@@ -2036,193 +1945,191 @@ void json_aivdm_dump(const struct ais_t *ais,
 	    switch (ais->type6.fid) {
 	    case 12:	/* IMO236 -Dangerous cargo indication */
 		/* some fields have beem merged to an ISO8601 partial date */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"lastport\":\"%s\",\"departure\":\"%02u-%02uT%02u:%02uZ\","
-			       "\"nextport\":\"%s\",\"eta\":\"%02u-%02uT%02u:%02uZ\","
-			       "\"dangerous\":\"%s\",\"imdcat\":\"%s\","
-			       "\"unid\":%u,\"amount\":%u,\"unit\":%u}\r\n",
-			       json_stringify(buf1, sizeof(buf1),
+		json_out_printf(out,
+				"\"lastport\":\"%s\",\"departure\":\"%02u-%02uT%02u:%02uZ\","
+				"\"nextport\":\"%s\",\"eta\":\"%02u-%02uT%02u:%02uZ\","
+				"\"dangerous\":\"%s\",\"imdcat\":\"%s\","
+				"\"unid\":%u,\"amount\":%u,\"unit\":%u}\r\n",
+				json_stringify(buf1, sizeof(buf1),
 					      ais->type6.dac1fid12.lastport),
-			       ais->type6.dac1fid12.lmonth,
-			       ais->type6.dac1fid12.lday,
-			       ais->type6.dac1fid12.lhour,
-			       ais->type6.dac1fid12.lminute,
-			       json_stringify(buf2, sizeof(buf2),
+				ais->type6.dac1fid12.lmonth,
+				ais->type6.dac1fid12.lday,
+				ais->type6.dac1fid12.lhour,
+				ais->type6.dac1fid12.lminute,
+				json_stringify(buf2, sizeof(buf2),
 					      ais->type6.dac1fid12.nextport),
-			       ais->type6.dac1fid12.nmonth,
-			       ais->type6.dac1fid12.nday,
-			       ais->type6.dac1fid12.nhour,
-			       ais->type6.dac1fid12.nminute,
-			       json_stringify(buf3, sizeof(buf3),
+				ais->type6.dac1fid12.nmonth,
+				ais->type6.dac1fid12.nday,
+				ais->type6.dac1fid12.nhour,
+				ais->type6.dac1fid12.nminute,
+				json_stringify(buf3, sizeof(buf3),
 					      ais->type6.dac1fid12.dangerous),
-			       json_stringify(buf4, sizeof(buf4),
+				json_stringify(buf4, sizeof(buf4),
 					      ais->type6.dac1fid12.imdcat),
-			       ais->type6.dac1fid12.unid,
-			       ais->type6.dac1fid12.amount,
-			       ais->type6.dac1fid12.unit);
+				ais->type6.dac1fid12.unid,
+				ais->type6.dac1fid12.amount,
+				ais->type6.dac1fid12.unit);
 		structured = true;
 		break;
 	    case 15:	/* IMO236 - Extended Ship Static and Voyage Related Data */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		    "\"airdraught\":%u}\r\n",
 		    ais->type6.dac1fid15.airdraught);
 		structured = true;
 		break;
 	    case 16:	/* IMO236 - Number of persons on board */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
+		json_out_printf(out,
+				"\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
 		structured = true;
 		break;
 	    case 18:	/* IMO289 - Clearance time to enter port */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"arrival\":\"%02u-%02uT%02u:%02uZ\",\"portname\":\"%s\",\"destination\":\"%s\",",
-			       ais->type6.dac1fid18.linkage,
-			       ais->type6.dac1fid18.month,
-			       ais->type6.dac1fid18.day,
-			       ais->type6.dac1fid18.hour,
-			       ais->type6.dac1fid18.minute,
-			       json_stringify(buf1, sizeof(buf1),
+		json_out_printf(out,
+				"\"linkage\":%u,\"arrival\":\"%02u-%02uT%02u:%02uZ\",\"portname\":\"%s\",\"destination\":\"%s\",",
+				ais->type6.dac1fid18.linkage,
+				ais->type6.dac1fid18.month,
+				ais->type6.dac1fid18.day,
+				ais->type6.dac1fid18.hour,
+				ais->type6.dac1fid18.minute,
+				json_stringify(buf1, sizeof(buf1),
 					      ais->type6.dac1fid18.portname),
-			       json_stringify(buf2, sizeof(buf2),
+				json_stringify(buf2, sizeof(buf2),
 					      ais->type6.dac1fid18.destination));
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"lon\":%.3f,\"lat\":%.3f}\r\n",
-				   ais->type6.dac1fid18.lon/AIS_LATLON3_DIV,
-				   ais->type6.dac1fid18.lat/AIS_LATLON3_DIV);
+		    json_out_printf(out,
+				    "\"lon\":%.3f,\"lat\":%.3f}\r\n",
+				    ais->type6.dac1fid18.lon/AIS_LATLON3_DIV,
+				    ais->type6.dac1fid18.lat/AIS_LATLON3_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			       "\"lon\":%d,\"lat\":%d}\r\n",
 			       ais->type6.dac1fid18.lon,
 			       ais->type6.dac1fid18.lat);
 		structured = true;
 		break;
 	    case 20:        /* IMO289 - Berthing Data */
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"berth_length\":%u,"
-			       "\"position\":%u,\"position_text\":\"%s\","
-			       "\"arrival\":\"%u-%uT%u:%u\","
-			       "\"availability\":%u,"
-			       "\"agent\":%u,\"fuel\":%u,\"chandler\":%u,"
-			       "\"stevedore\":%u,\"electrical\":%u,"
-			       "\"water\":%u,\"customs\":%u,\"cartage\":%u,"
-			       "\"crane\":%u,\"lift\":%u,\"medical\":%u,"
-			       "\"navrepair\":%u,\"provisions\":%u,"
-			       "\"shiprepair\":%u,\"surveyor\":%u,"
-			       "\"steam\":%u,\"tugs\":%u,\"solidwaste\":%u,"
-			       "\"liquidwaste\":%u,\"hazardouswaste\":%u,"
-			       "\"ballast\":%u,\"additional\":%u,"
-			       "\"regional1\":%u,\"regional2\":%u,"
-			       "\"future1\":%u,\"future2\":%u,"
-			       "\"berth_name\":\"%s\",",
-			       ais->type6.dac1fid20.linkage,
-			       ais->type6.dac1fid20.berth_length,
-			       ais->type6.dac1fid20.position,
-			       position_types[ais->type6.dac1fid20.position],
-			       ais->type6.dac1fid20.month,
-			       ais->type6.dac1fid20.day,
-			       ais->type6.dac1fid20.hour,
-			       ais->type6.dac1fid20.minute,
-			       ais->type6.dac1fid20.availability,
-			       ais->type6.dac1fid20.agent,
-			       ais->type6.dac1fid20.fuel,
-			       ais->type6.dac1fid20.chandler,
-			       ais->type6.dac1fid20.stevedore,
-			       ais->type6.dac1fid20.electrical,
-			       ais->type6.dac1fid20.water,
-			       ais->type6.dac1fid20.customs,
-			       ais->type6.dac1fid20.cartage,
-			       ais->type6.dac1fid20.crane,
-			       ais->type6.dac1fid20.lift,
-			       ais->type6.dac1fid20.medical,
-			       ais->type6.dac1fid20.navrepair,
-			       ais->type6.dac1fid20.provisions,
-			       ais->type6.dac1fid20.shiprepair,
-			       ais->type6.dac1fid20.surveyor,
-			       ais->type6.dac1fid20.steam,
-			       ais->type6.dac1fid20.tugs,
-			       ais->type6.dac1fid20.solidwaste,
-			       ais->type6.dac1fid20.liquidwaste,
-			       ais->type6.dac1fid20.hazardouswaste,
-			       ais->type6.dac1fid20.ballast,
-			       ais->type6.dac1fid20.additional,
-			       ais->type6.dac1fid20.regional1,
-			       ais->type6.dac1fid20.regional2,
-			       ais->type6.dac1fid20.future1,
-			       ais->type6.dac1fid20.future2,
-			       json_stringify(buf1, sizeof(buf1),
+                json_out_printf(out,
+				"\"linkage\":%u,\"berth_length\":%u,"
+				"\"position\":%u,\"position_text\":\"%s\","
+				"\"arrival\":\"%u-%uT%u:%u\","
+				"\"availability\":%u,"
+				"\"agent\":%u,\"fuel\":%u,\"chandler\":%u,"
+				"\"stevedore\":%u,\"electrical\":%u,"
+				"\"water\":%u,\"customs\":%u,\"cartage\":%u,"
+				"\"crane\":%u,\"lift\":%u,\"medical\":%u,"
+				"\"navrepair\":%u,\"provisions\":%u,"
+				"\"shiprepair\":%u,\"surveyor\":%u,"
+				"\"steam\":%u,\"tugs\":%u,\"solidwaste\":%u,"
+				"\"liquidwaste\":%u,\"hazardouswaste\":%u,"
+				"\"ballast\":%u,\"additional\":%u,"
+				"\"regional1\":%u,\"regional2\":%u,"
+				"\"future1\":%u,\"future2\":%u,"
+				"\"berth_name\":\"%s\",",
+				ais->type6.dac1fid20.linkage,
+				ais->type6.dac1fid20.berth_length,
+				ais->type6.dac1fid20.position,
+				position_types[ais->type6.dac1fid20.position],
+				ais->type6.dac1fid20.month,
+				ais->type6.dac1fid20.day,
+				ais->type6.dac1fid20.hour,
+				ais->type6.dac1fid20.minute,
+				ais->type6.dac1fid20.availability,
+				ais->type6.dac1fid20.agent,
+				ais->type6.dac1fid20.fuel,
+				ais->type6.dac1fid20.chandler,
+				ais->type6.dac1fid20.stevedore,
+				ais->type6.dac1fid20.electrical,
+				ais->type6.dac1fid20.water,
+				ais->type6.dac1fid20.customs,
+				ais->type6.dac1fid20.cartage,
+				ais->type6.dac1fid20.crane,
+				ais->type6.dac1fid20.lift,
+				ais->type6.dac1fid20.medical,
+				ais->type6.dac1fid20.navrepair,
+				ais->type6.dac1fid20.provisions,
+				ais->type6.dac1fid20.shiprepair,
+				ais->type6.dac1fid20.surveyor,
+				ais->type6.dac1fid20.steam,
+				ais->type6.dac1fid20.tugs,
+				ais->type6.dac1fid20.solidwaste,
+				ais->type6.dac1fid20.liquidwaste,
+				ais->type6.dac1fid20.hazardouswaste,
+				ais->type6.dac1fid20.ballast,
+				ais->type6.dac1fid20.additional,
+				ais->type6.dac1fid20.regional1,
+				ais->type6.dac1fid20.regional2,
+				ais->type6.dac1fid20.future1,
+				ais->type6.dac1fid20.future2,
+				json_stringify(buf1, sizeof(buf1),
 					      ais->type6.dac1fid20.berth_name));
             if (scaled)
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"berth_lon\":%.3f,"
-			       "\"berth_lat\":%.3f,"
-			       "\"berth_depth\":%.1f}\r\n",
-			       ais->type6.dac1fid20.berth_lon / AIS_LATLON3_DIV,
-			       ais->type6.dac1fid20.berth_lat / AIS_LATLON3_DIV,
-			       ais->type6.dac1fid20.berth_depth * 0.1);
+		json_out_printf(out,
+				"\"berth_lon\":%.3f,"
+				"\"berth_lat\":%.3f,"
+				"\"berth_depth\":%.1f}\r\n",
+				ais->type6.dac1fid20.berth_lon / AIS_LATLON3_DIV,
+				ais->type6.dac1fid20.berth_lat / AIS_LATLON3_DIV,
+				ais->type6.dac1fid20.berth_depth * 0.1);
             else
-                (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"berth_lon\":%d,"
-			       "\"berth_lat\":%d,"
-			       "\"berth_depth\":%u}\r\n",
-			       ais->type6.dac1fid20.berth_lon,
-			       ais->type6.dac1fid20.berth_lat,
-			       ais->type6.dac1fid20.berth_depth);
+                json_out_printf(out,
+				"\"berth_lon\":%d,"
+				"\"berth_lat\":%d,"
+				"\"berth_depth\":%u}\r\n",
+				ais->type6.dac1fid20.berth_lon,
+				ais->type6.dac1fid20.berth_lat,
+				ais->type6.dac1fid20.berth_depth);
 		structured = true;
 		break;
 	    case 23:    /* IMO289 - Area notice - addressed */
 		break;
 	    case 25:	/* IMO289 - Dangerous cargo indication */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"unit\":%u,\"amount\":%u,\"cargos\":[",
-			       ais->type6.dac1fid25.unit,
-			       ais->type6.dac1fid25.amount);
+		json_out_printf(out,
+				"\"unit\":%u,\"amount\":%u,\"cargos\":[",
+				ais->type6.dac1fid25.unit,
+				ais->type6.dac1fid25.amount);
 		for (i = 0; i < (int)ais->type6.dac1fid25.ncargos; i++)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "{\"code\":%u,\"subtype\":%u},",
-
-				   ais->type6.dac1fid25.cargos[i].code,
-				   ais->type6.dac1fid25.cargos[i].subtype);
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf) - 1] = '\0';
-		(void)strlcat(buf, "]}\r\n", buflen);
+		    json_out_printf(out,
+				    "{\"code\":%u,\"subtype\":%u},",
+
+				    ais->type6.dac1fid25.cargos[i].code,
+				    ais->type6.dac1fid25.cargos[i].subtype);
+		json_out_trim(out);
+		json_out_raw(out, "]}\r\n");
 		structured = true;
 		break;
 	    case 28:	/* IMO289 - Route info - addressed */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"sender\":%u,"
-			       "\"rtype\":%u,"
-			       "\"rtype_text\":\"%s\","
-			       "\"start\":\"%02u-%02uT%02u:%02uZ\","
-			       "\"duration\":%u,\"waypoints\":[",
-			       ais->type6.dac1fid28.linkage,
-			       ais->type6.dac1fid28.sender,
-			       ais->type6.dac1fid28.rtype,
-			       route_type[ais->type6.dac1fid28.rtype],
-			       ais->type6.dac1fid28.month,
-			       ais->type6.dac1fid28.day,
-			       ais->type6.dac1fid28.hour,
-			       ais->type6.dac1fid28.minute,
-			       ais->type6.dac1fid28.duration);
+		json_out_printf(out,
+				"\"linkage\":%u,\"sender\":%u,"
+				"\"rtype\":%u,"
+				"\"rtype_text\":\"%s\","
+				"\"start\":\"%02u-%02uT%02u:%02uZ\","
+				"\"duration\":%u,\"waypoints\":[",
+				ais->type6.dac1fid28.linkage,
+				ais->type6.dac1fid28.sender,
+				ais->type6.dac1fid28.rtype,
+				route_type[ais->type6.dac1fid28.rtype],
+				ais->type6.dac1fid28.month,
+				ais->type6.dac1fid28.day,
+				ais->type6.dac1fid28.hour,
+				ais->type6.dac1fid28.minute,
+				ais->type6.dac1fid28.duration);
 		for (i = 0; i < ais->type6.dac1fid28.waycount; i++) {
 		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "{\"lon\":%.4f,\"lat\":%.4f},",
 			    ais->type6.dac1fid28.waypoints[i].lon / AIS_LATLON4_DIV,
 			    ais->type6.dac1fid28.waypoints[i].lat / AIS_LATLON4_DIV);
 		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "{\"lon\":%d,\"lat\":%d},",
 			    ais->type6.dac1fid28.waypoints[i].lon,
 			    ais->type6.dac1fid28.waypoints[i].lat);
 		}
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf)-1] = '\0';
-		(void)strlcat(buf, "]}\r\n", buflen);
+		json_out_trim(out);
+		json_out_raw(out, "]}\r\n");
 		structured = true;
 		break;
 	    case 30:	/* IMO289 - Text description - addressed */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		       "\"linkage\":%u,\"text\":\"%s\"}\r\n",
 		       ais->type6.dac1fid30.linkage,
 		       json_stringify(buf1, sizeof(buf1),
@@ -2231,23 +2138,23 @@ void json_aivdm_dump(const struct ais_t *ais,
 		break;
 	    case 14:	/* IMO236 - Tidal Window */
 	    case 32:	/* IMO289 - Tidal Window */
-	      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+	      json_out_printf(out,
 		  "\"month\":%u,\"day\":%u,\"tidals\":[",
 		  ais->type6.dac1fid32.month,
 		  ais->type6.dac1fid32.day);
 	      for (i = 0; i < ais->type6.dac1fid32.ntidals; i++) {
 		  const struct tidal_t *tp =  &ais->type6.dac1fid32.tidals[i];
 		  if (scaled)
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		      json_out_printf(out,
 			  "{\"lon\":%.3f,\"lat\":%.3f,",
 			  tp->lon / AIS_LATLON3_DIV,
 			  tp->lat / AIS_LATLON3_DIV);
 		  else
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		      json_out_printf(out,
 			  "{\"lon\":%d,\"lat\":%d,",
 			  tp->lon,
 			  tp->lat);
-		  (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		  json_out_printf(out,
 		      "\"from_hour\":%u,\"from_min\":%u,\"to_hour\":%u,\"to_min\":%u,\"cdir\":%u,",
 		      tp->from_hour,
 		      tp->from_min,
@@ -2255,41 +2162,40 @@ void json_aivdm_dump(const struct ais_t *ais,
 		      tp->to_min,
 		      tp->cdir);
 		  if (scaled)
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		      json_out_printf(out,
 			  "\"cspeed\":%.1f},",
 			  tp->cspeed / 10.0);
 		  else
-		      (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		      json_out_printf(out,
 			  "\"cspeed\":%u},",
 			  tp->cspeed);
 	      }
-	      if (buf[strlen(buf) - 1] == ',')
-		  buf[strlen(buf)-1] = '\0';
-	      (void)strlcat(buf, "]}\r\n", buflen);
+	      json_out_trim(out);
+	      json_out_raw(out, "]}\r\n");
 	      structured = true;
 	      break;
 	    }
 	}
 	if (!structured)
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"data\":\"%zd:%s\"}\r\n",
-			   ais->type6.bitcount,
-			   json_stringify(buf1, sizeof(buf1),
+	    json_out_printf(out,
+			    "\"data\":\"%zd:%s\"}\r\n",
+			    ais->type6.bitcount,
+			    json_stringify(buf1, sizeof(buf1),
 					  gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
 					      (char *)ais->type6.bitdata,
 					      (ais->type6.bitcount + 7) / 8)));
 	break;
     case 7:			/* Binary Acknowledge */
     case 13:			/* Safety Related Acknowledge */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"mmsi1\":%u,\"mmsi2\":%u,\"mmsi3\":%u,\"mmsi4\":%u}\r\n",
-		       ais->type7.mmsi1,
-		       ais->type7.mmsi2, ais->type7.mmsi3, ais->type7.mmsi4);
+	json_out_printf(out,
+			"\"mmsi1\":%u,\"mmsi2\":%u,\"mmsi3\":%u,\"mmsi4\":%u}\r\n",
+			ais->type7.mmsi1,
+			ais->type7.mmsi2, ais->type7.mmsi3, ais->type7.mmsi4);
 	break;
     case 8:			/* Binary Broadcast Message */
 	structured = false;
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"dac\":%u,\"fid\":%u,",ais->type8.dac, ais->type8.fid);
+	json_out_printf(out,
+			"\"dac\":%u,\"fid\":%u,",ais->type8.dac, ais->type8.fid);
 	if (ais->type8.dac == 1) {
 	    const char *trends[] = {
 		"steady",
@@ -2319,242 +2225,241 @@ void json_aivdm_dump(const struct ais_t *ais,
 		/* some fields have been merged to an ISO8601 partial date */
 		/* layout is almost identical to FID=31 from IMO289 */
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"lat\":%.3f,\"lon\":%.3f,",
-				   ais->type8.dac1fid11.lat / AIS_LATLON3_DIV,
-				   ais->type8.dac1fid11.lon / AIS_LATLON3_DIV);
+		    json_out_printf(out,
+				    "\"lat\":%.3f,\"lon\":%.3f,",
+				    ais->type8.dac1fid11.lat / AIS_LATLON3_DIV,
+				    ais->type8.dac1fid11.lon / AIS_LATLON3_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"lat\":%d,\"lon\":%d,",
-				   ais->type8.dac1fid11.lat,
-				   ais->type8.dac1fid11.lon);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"timestamp\":\"%02uT%02u:%02uZ\","
-			       "\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
-			       "\"wgustdir\":%u,\"humidity\":%u,",
-			       ais->type8.dac1fid11.day,
-			       ais->type8.dac1fid11.hour,
-			       ais->type8.dac1fid11.minute,
-			       ais->type8.dac1fid11.wspeed,
-			       ais->type8.dac1fid11.wgust,
-			       ais->type8.dac1fid11.wdir,
-			       ais->type8.dac1fid11.wgustdir,
-			       ais->type8.dac1fid11.humidity);
+		    json_out_printf(out,
+				    "\"lat\":%d,\"lon\":%d,",
+				    ais->type8.dac1fid11.lat,
+				    ais->type8.dac1fid11.lon);
+		json_out_printf(out,
+				"\"timestamp\":\"%02uT%02u:%02uZ\","
+				"\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
+				"\"wgustdir\":%u,\"humidity\":%u,",
+				ais->type8.dac1fid11.day,
+				ais->type8.dac1fid11.hour,
+				ais->type8.dac1fid11.minute,
+				ais->type8.dac1fid11.wspeed,
+				ais->type8.dac1fid11.wgust,
+				ais->type8.dac1fid11.wdir,
+				ais->type8.dac1fid11.wgustdir,
+				ais->type8.dac1fid11.humidity);
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
-				   "\"pressure\":%u,\"pressuretend\":\"%s\",",
-				   (ais->type8.dac1fid11.airtemp - DAC1FID11_AIRTEMP_OFFSET) / DAC1FID11_AIRTEMP_DIV,
-				   (ais->type8.dac1fid11.dewpoint - DAC1FID11_DEWPOINT_OFFSET) / DAC1FID11_DEWPOINT_DIV,
-				   ais->type8.dac1fid11.pressure - DAC1FID11_PRESSURE_OFFSET,
-				   trends[ais->type8.dac1fid11.pressuretend]);
+		    json_out_printf(out,
+				    "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
+				    "\"pressure\":%u,\"pressuretend\":\"%s\",",
+				    (ais->type8.dac1fid11.airtemp - DAC1FID11_AIRTEMP_OFFSET) / DAC1FID11_AIRTEMP_DIV,
+				    (ais->type8.dac1fid11.dewpoint - DAC1FID11_DEWPOINT_OFFSET) / DAC1FID11_DEWPOINT_DIV,
+				    ais->type8.dac1fid11.pressure - DAC1FID11_PRESSURE_OFFSET,
+				    trends[ais->type8.dac1fid11.pressuretend]);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"airtemp\":%u,\"dewpoint\":%u,"
-				   "\"pressure\":%u,\"pressuretend\":%u,",
-				   ais->type8.dac1fid11.airtemp,
-				   ais->type8.dac1fid11.dewpoint,
-				   ais->type8.dac1fid11.pressure,
-				   ais->type8.dac1fid11.pressuretend);
+		    json_out_printf(out,
+				    "\"airtemp\":%u,\"dewpoint\":%u,"
+				    "\"pressure\":%u,\"pressuretend\":%u,",
+				    ais->type8.dac1fid11.airtemp,
+				    ais->type8.dac1fid11.dewpoint,
+				    ais->type8.dac1fid11.pressure,
+				    ais->type8.dac1fid11.pressuretend);
 
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"visibility\":%.1f,",
-				   ais->type8.dac1fid11.visibility / DAC1FID11_VISIBILITY_DIV);
+		    json_out_printf(out,
+				    "\"visibility\":%.1f,",
+				    ais->type8.dac1fid11.visibility / DAC1FID11_VISIBILITY_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"visibility\":%u,",
-				   ais->type8.dac1fid11.visibility);
+		    json_out_printf(out,
+				    "\"visibility\":%u,",
+				    ais->type8.dac1fid11.visibility);
 		if (!scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%d,",
-				   ais->type8.dac1fid11.waterlevel);
+		    json_out_printf(out,
+				    "\"waterlevel\":%d,",
+				    ais->type8.dac1fid11.waterlevel);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%.1f,",
-				   (ais->type8.dac1fid11.waterlevel - DAC1FID11_WATERLEVEL_OFFSET) / DAC1FID11_WATERLEVEL_DIV);
+		    json_out_printf(out,
+				    "\"waterlevel\":%.1f,",
+				    (ais->type8.dac1fid11.waterlevel - DAC1FID11_WATERLEVEL_OFFSET) / DAC1FID11_WATERLEVEL_DIV);
 
 		if (scaled) {
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"leveltrend\":\"%s\","
-				   "\"cspeed\":%.1f,\"cdir\":%u,"
-				   "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
-				   "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
-				   "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
-				   "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
-				   "\"seastate\":%u,\"watertemp\":%.1f,"
-				   "\"preciptype\":%u,\"preciptype_text\":\"%s\","
-				   "\"salinity\":%.1f,\"ice\":%u,\"ice_text\":\"%s\"",
-				   trends[ais->type8.dac1fid11.leveltrend],
-				   ais->type8.dac1fid11.cspeed / DAC1FID11_CSPEED_DIV,
-				   ais->type8.dac1fid11.cdir,
-				   ais->type8.dac1fid11.cspeed2 / DAC1FID11_CSPEED_DIV,
-				   ais->type8.dac1fid11.cdir2,
-				   ais->type8.dac1fid11.cdepth2,
-				   ais->type8.dac1fid11.cspeed3 / DAC1FID11_CSPEED_DIV,
-				   ais->type8.dac1fid11.cdir3,
-				   ais->type8.dac1fid11.cdepth3,
-				   ais->type8.dac1fid11.waveheight / DAC1FID11_WAVEHEIGHT_DIV,
-				   ais->type8.dac1fid11.waveperiod,
-				   ais->type8.dac1fid11.wavedir,
-				   ais->type8.dac1fid11.swellheight / DAC1FID11_WAVEHEIGHT_DIV,
-				   ais->type8.dac1fid11.swellperiod,
-				   ais->type8.dac1fid11.swelldir,
-				   ais->type8.dac1fid11.seastate,
-				   (ais->type8.dac1fid11.watertemp - DAC1FID11_WATERTEMP_OFFSET) / DAC1FID11_WATERTEMP_DIV,
-				   ais->type8.dac1fid11.preciptype,
-				   preciptypes[ais->type8.dac1fid11.preciptype],
-				   ais->type8.dac1fid11.salinity / DAC1FID11_SALINITY_DIV,
-				   ais->type8.dac1fid11.ice,
-				   ice[ais->type8.dac1fid11.ice]);
+		    json_out_printf(out,
+				    "\"leveltrend\":\"%s\","
+				    "\"cspeed\":%.1f,\"cdir\":%u,"
+				    "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
+				    "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
+				    "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
+				    "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
+				    "\"seastate\":%u,\"watertemp\":%.1f,"
+				    "\"preciptype\":%u,\"preciptype_text\":\"%s\","
+				    "\"salinity\":%.1f,\"ice\":%u,\"ice_text\":\"%s\"",
+				    trends[ais->type8.dac1fid11.leveltrend],
+				    ais->type8.dac1fid11.cspeed / DAC1FID11_CSPEED_DIV,
+				    ais->type8.dac1fid11.cdir,
+				    ais->type8.dac1fid11.cspeed2 / DAC1FID11_CSPEED_DIV,
+				    ais->type8.dac1fid11.cdir2,
+				    ais->type8.dac1fid11.cdepth2,
+				    ais->type8.dac1fid11.cspeed3 / DAC1FID11_CSPEED_DIV,
+				    ais->type8.dac1fid11.cdir3,
+				    ais->type8.dac1fid11.cdepth3,
+				    ais->type8.dac1fid11.waveheight / DAC1FID11_WAVEHEIGHT_DIV,
+				    ais->type8.dac1fid11.waveperiod,
+				    ais->type8.dac1fid11.wavedir,
+				    ais->type8.dac1fid11.swellheight / DAC1FID11_WAVEHEIGHT_DIV,
+				    ais->type8.dac1fid11.swellperiod,
+				    ais->type8.dac1fid11.swelldir,
+				    ais->type8.dac1fid11.seastate,
+				    (ais->type8.dac1fid11.watertemp - DAC1FID11_WATERTEMP_OFFSET) / DAC1FID11_WATERTEMP_DIV,
+				    ais->type8.dac1fid11.preciptype,
+				    preciptypes[ais->type8.dac1fid11.preciptype],
+				    ais->type8.dac1fid11.salinity / DAC1FID11_SALINITY_DIV,
+				    ais->type8.dac1fid11.ice,
+				    ice[ais->type8.dac1fid11.ice]);
 		} else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"leveltrend\":%u,"
-				   "\"cspeed\":%u,\"cdir\":%u,"
-				   "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
-				   "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
-				   "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
-				   "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
-				   "\"seastate\":%u,\"watertemp\":%u,"
-				   "\"preciptype\":%u,\"preciptype_text\":\"%s\","
-				   "\"salinity\":%u,\"ice\":%u,\"ice_text\":\"%s\"",
-				   ais->type8.dac1fid11.leveltrend,
-				   ais->type8.dac1fid11.cspeed,
-				   ais->type8.dac1fid11.cdir,
-				   ais->type8.dac1fid11.cspeed2,
-				   ais->type8.dac1fid11.cdir2,
-				   ais->type8.dac1fid11.cdepth2,
-				   ais->type8.dac1fid11.cspeed3,
-				   ais->type8.dac1fid11.cdir3,
-				   ais->type8.dac1fid11.cdepth3,
-				   ais->type8.dac1fid11.waveheight,
-				   ais->type8.dac1fid11.waveperiod,
-				   ais->type8.dac1fid11.wavedir,
-				   ais->type8.dac1fid11.swellheight,
-				   ais->type8.dac1fid11.swellperiod,
-				   ais->type8.dac1fid11.swelldir,
-				   ais->type8.dac1fid11.seastate,
-				   ais->type8.dac1fid11.watertemp,
-				   ais->type8.dac1fid11.preciptype,
-				   preciptypes[ais->type8.dac1fid11.preciptype],
-				   ais->type8.dac1fid11.salinity,
-				   ais->type8.dac1fid11.ice,
-				   ice[ais->type8.dac1fid11.ice]);
-		(void)strlcat(buf, "}\r\n", buflen);
+		    json_out_printf(out,
+				    "\"leveltrend\":%u,"
+				    "\"cspeed\":%u,\"cdir\":%u,"
+				    "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
+				    "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
+				    "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
+				    "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
+				    "\"seastate\":%u,\"watertemp\":%u,"
+				    "\"preciptype\":%u,\"preciptype_text\":\"%s\","
+				    "\"salinity\":%u,\"ice\":%u,\"ice_text\":\"%s\"",
+				    ais->type8.dac1fid11.leveltrend,
+				    ais->type8.dac1fid11.cspeed,
+				    ais->type8.dac1fid11.cdir,
+				    ais->type8.dac1fid11.cspeed2,
+				    ais->type8.dac1fid11.cdir2,
+				    ais->type8.dac1fid11.cdepth2,
+				    ais->type8.dac1fid11.cspeed3,
+				    ais->type8.dac1fid11.cdir3,
+				    ais->type8.dac1fid11.cdepth3,
+				    ais->type8.dac1fid11.waveheight,
+				    ais->type8.dac1fid11.waveperiod,
+				    ais->type8.dac1fid11.wavedir,
+				    ais->type8.dac1fid11.swellheight,
+				    ais->type8.dac1fid11.swellperiod,
+				    ais->type8.dac1fid11.swelldir,
+				    ais->type8.dac1fid11.seastate,
+				    ais->type8.dac1fid11.watertemp,
+				    ais->type8.dac1fid11.preciptype,
+				    preciptypes[ais->type8.dac1fid11.preciptype],
+				    ais->type8.dac1fid11.salinity,
+				    ais->type8.dac1fid11.ice,
+				    ice[ais->type8.dac1fid11.ice]);
+		json_out_raw(out, "}\r\n");
 		structured = true;
 		break;
 	    case 13:        /* IMO236 - Fairway closed */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"reason\":\"%s\",\"closefrom\":\"%s\","
-			       "\"closeto\":\"%s\",\"radius\":%u,"
-			       "\"extunit\":%u,"
-			       "\"from\":\"%02u-%02uT%02u:%02u\","
-			       "\"to\":\"%02u-%02uT%02u:%02u\"}\r\n",
-			       json_stringify(buf1, sizeof(buf1),
+		json_out_printf(out,
+				"\"reason\":\"%s\",\"closefrom\":\"%s\","
+				"\"closeto\":\"%s\",\"radius\":%u,"
+				"\"extunit\":%u,"
+				"\"from\":\"%02u-%02uT%02u:%02u\","
+				"\"to\":\"%02u-%02uT%02u:%02u\"}\r\n",
+				json_stringify(buf1, sizeof(buf1),
 					      ais->type8.dac1fid13.reason),
-			       json_stringify(buf2, sizeof(buf2),
+				json_stringify(buf2, sizeof(buf2),
 					      ais->type8.dac1fid13.closefrom),
-			       json_stringify(buf3, sizeof(buf3),
+				json_stringify(buf3, sizeof(buf3),
 					      ais->type8.dac1fid13.closeto),
-			       ais->type8.dac1fid13.radius,
-			       ais->type8.dac1fid13.extunit,
-			       ais->type8.dac1fid13.fmonth,
-			       ais->type8.dac1fid13.fday,
-			       ais->type8.dac1fid13.fhour,
-			       ais->type8.dac1fid13.fminute,
-			       ais->type8.dac1fid13.tmonth,
-			       ais->type8.dac1fid13.tday,
-			       ais->type8.dac1fid13.thour,
-			       ais->type8.dac1fid13.tminute);
+				ais->type8.dac1fid13.radius,
+				ais->type8.dac1fid13.extunit,
+				ais->type8.dac1fid13.fmonth,
+				ais->type8.dac1fid13.fday,
+				ais->type8.dac1fid13.fhour,
+				ais->type8.dac1fid13.fminute,
+				ais->type8.dac1fid13.tmonth,
+				ais->type8.dac1fid13.tday,
+				ais->type8.dac1fid13.thour,
+				ais->type8.dac1fid13.tminute);
 		structured = true;
 		break;
 	    case 15:        /* IMO236 - Extended ship and voyage */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"airdraught\":%u}\r\n",
-			       ais->type8.dac1fid15.airdraught);
+		json_out_printf(out,
+				"\"airdraught\":%u}\r\n",
+				ais->type8.dac1fid15.airdraught);
 		structured = true;
 		break;
 	    case 16:	/* IMO289 - Number of persons on board */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
+		json_out_printf(out,
+				"\"persons\":%u}\t\n", ais->type6.dac1fid16.persons);
 		structured = true;
 		break;
 	    case 17:        /* IMO289 - VTS-generated/synthetic targets */
-		(void)strlcat(buf, "\"targets\":[", buflen);
+		json_out_raw(out, "\"targets\":[");
 		for (i = 0; i < ais->type8.dac1fid17.ntargets; i++) {
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "{\"idtype\":%u,\"idtype_text\":\"%s\",",
-				   ais->type8.dac1fid17.targets[i].idtype,
-				   idtypes[ais->type8.dac1fid17.targets[i].idtype]);
+		    json_out_printf(out,
+				    "{\"idtype\":%u,\"idtype_text\":\"%s\",",
+				    ais->type8.dac1fid17.targets[i].idtype,
+				    idtypes[ais->type8.dac1fid17.targets[i].idtype]);
 		    switch (ais->type8.dac1fid17.targets[i].idtype) {
 		    case DAC1FID17_IDTYPE_MMSI:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "\"%s\":\"%u\",",
 			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
 			    ais->type8.dac1fid17.targets[i].id.mmsi);
 			break;
 		    case DAC1FID17_IDTYPE_IMO:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "\"%s\":\"%u\",",
 			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
 			    ais->type8.dac1fid17.targets[i].id.imo);
 			break;
 		    case DAC1FID17_IDTYPE_CALLSIGN:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "\"%s\":\"%s\",",
 			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
 			    json_stringify(buf1, sizeof(buf1),
 					   ais->type8.dac1fid17.targets[i].id.callsign));
 			break;
 		    default:
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "\"%s\":\"%s\",",
 			    idtypes[ais->type8.dac1fid17.targets[i].idtype],
 			    json_stringify(buf1, sizeof(buf1),
 					   ais->type8.dac1fid17.targets[i].id.other));
 		    }
 		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "\"lat\":%.3f,\"lon\":%.3f,",
 			    ais->type8.dac1fid17.targets[i].lat / AIS_LATLON3_DIV,
 			    ais->type8.dac1fid17.targets[i].lon / AIS_LATLON3_DIV);
 		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "\"lat\":%d,\"lon\":%d,",
 			    ais->type8.dac1fid17.targets[i].lat,
 			    ais->type8.dac1fid17.targets[i].lon);
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			"\"course\":%u,\"second\":%u,\"speed\":%u},",
 			ais->type8.dac1fid17.targets[i].course,
 			ais->type8.dac1fid17.targets[i].second,
 			ais->type8.dac1fid17.targets[i].speed);
 		}
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf) - 1] = '\0';
-		(void)strlcat(buf, "]}\r\n", buflen);
+		json_out_trim(out);
+		json_out_raw(out, "]}\r\n");
 		structured = true;
 		break;
 	    case 19:        /* IMO289 - Marine Traffic Signal */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"station\":\"%s\","
-			       "\"lon\":%.3f,\"lat\":%.3f,\"status\":%u,"
-			       "\"signal\":%u,\"signal_text\":\"%s\","
-			       "\"hour\":%u,\"minute\":%u,"
-			       "\"nextsignal\":%u"
-			       "\"nextsignal_text\":\"%s\""
-			       "}\r\n",
-			       ais->type8.dac1fid19.linkage,
-			       json_stringify(buf1, sizeof(buf1),
+		json_out_printf(out,
+				"\"linkage\":%u,\"station\":\"%s\","
+				"\"lon\":%.3f,\"lat\":%.3f,\"status\":%u,"
+				"\"signal\":%u,\"signal_text\":\"%s\","
+				"\"hour\":%u,\"minute\":%u,"
+				"\"nextsignal\":%u"
+				"\"nextsignal_text\":\"%s\""
+				"}\r\n",
+				ais->type8.dac1fid19.linkage,
+				json_stringify(buf1, sizeof(buf1),
 					      ais->type8.dac1fid19.station),
-			       ais->type8.dac1fid19.lon / AIS_LATLON3_DIV,
-			       ais->type8.dac1fid19.lat / AIS_LATLON3_DIV,
-			       ais->type8.dac1fid19.status,
-			       ais->type8.dac1fid19.signal,
-			       SIGNAL_DISPLAY(ais->type8.dac1fid19.signal),
-			       ais->type8.dac1fid19.hour,
-			       ais->type8.dac1fid19.minute,
-			       ais->type8.dac1fid19.nextsignal,
-			       SIGNAL_DISPLAY(ais->type8.dac1fid19.nextsignal));
+				ais->type8.dac1fid19.lon / AIS_LATLON3_DIV,
+				ais->type8.dac1fid19.lat / AIS_LATLON3_DIV,
+				ais->type8.dac1fid19.status,
+				ais->type8.dac1fid19.signal,
+				SIGNAL_DISPLAY(ais->type8.dac1fid19.signal),
+				ais->type8.dac1fid19.hour,
+				ais->type8.dac1fid19.minute,
+				ais->type8.dac1fid19.nextsignal,
+				SIGNAL_DISPLAY(ais->type8.dac1fid19.nextsignal));
 		structured = true;
 		break;
 	    case 21:        /* IMO289 - Weather obs. report from ship */
@@ -2566,40 +2471,39 @@ void json_aivdm_dump(const struct ais_t *ais,
 	    case 25:        /* IMO289 - Dangerous Cargo Indication */
 		break;
 	    case 27:        /* IMO289 - Route information - broadcast */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"linkage\":%u,\"sender\":%u,"
-			       "\"rtype\":%u,"
-			       "\"rtype_text\":\"%s\","
-			       "\"start\":\"%02u-%02uT%02u:%02uZ\","
-			       "\"duration\":%u,\"waypoints\":[",
-			       ais->type8.dac1fid27.linkage,
-			       ais->type8.dac1fid27.sender,
-			       ais->type8.dac1fid27.rtype,
-			       route_type[ais->type8.dac1fid27.rtype],
-			       ais->type8.dac1fid27.month,
-			       ais->type8.dac1fid27.day,
-			       ais->type8.dac1fid27.hour,
-			       ais->type8.dac1fid27.minute,
-			       ais->type8.dac1fid27.duration);
+		json_out_printf(out,
+				"\"linkage\":%u,\"sender\":%u,"
+				"\"rtype\":%u,"
+				"\"rtype_text\":\"%s\","
+				"\"start\":\"%02u-%02uT%02u:%02uZ\","
+				"\"duration\":%u,\"waypoints\":[",
+				ais->type8.dac1fid27.linkage,
+				ais->type8.dac1fid27.sender,
+				ais->type8.dac1fid27.rtype,
+				route_type[ais->type8.dac1fid27.rtype],
+				ais->type8.dac1fid27.month,
+				ais->type8.dac1fid27.day,
+				ais->type8.dac1fid27.hour,
+				ais->type8.dac1fid27.minute,
+				ais->type8.dac1fid27.duration);
 		for (i = 0; i < ais->type8.dac1fid27.waycount; i++) {
 		    if (scaled)
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "{\"lon\":%.4f,\"lat\":%.4f},",
 			    ais->type8.dac1fid27.waypoints[i].lon / AIS_LATLON4_DIV,
 			    ais->type8.dac1fid27.waypoints[i].lat / AIS_LATLON4_DIV);
 		    else
-			(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+			json_out_printf(out,
 			    "{\"lon\":%d,\"lat\":%d},",
 			    ais->type8.dac1fid27.waypoints[i].lon,
 			    ais->type8.dac1fid27.waypoints[i].lat);
 		}
-		if (buf[strlen(buf) - 1] == ',')
-		    buf[strlen(buf) - 1] = '\0';
-		(void)strlcat(buf, "]}\r\n", buflen);
+		json_out_trim(out);
+		json_out_raw(out, "]}\r\n");
 		structured = true;
 		break;
 	    case 29:        /* IMO289 - Text Description - broadcast */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		       "\"linkage\":%u,\"text\":\"%s\"}\r\n",
 		       ais->type8.dac1fid29.linkage,
 		       json_stringify(buf1, sizeof(buf1),
@@ -2610,129 +2514,129 @@ void json_aivdm_dump(const struct ais_t *ais,
 		/* some fields have been merged to an ISO8601 partial date */
 		/* layout is almost identical to FID=11 from IMO236 */
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"lat\":%.3f,\"lon\":%.3f,",
-				   ais->type8.dac1fid31.lat / AIS_LATLON3_DIV,
-				   ais->type8.dac1fid31.lon / AIS_LATLON3_DIV);
+		    json_out_printf(out,
+				    "\"lat\":%.3f,\"lon\":%.3f,",
+				    ais->type8.dac1fid31.lat / AIS_LATLON3_DIV,
+				    ais->type8.dac1fid31.lon / AIS_LATLON3_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"lat\":%d,\"lon\":%d,",
-				   ais->type8.dac1fid31.lat,
-				   ais->type8.dac1fid31.lon);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"accuracy\":%s,",
-			       JSON_BOOL(ais->type8.dac1fid31.accuracy));
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"timestamp\":\"%02uT%02u:%02uZ\","
-			       "\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
-			       "\"wgustdir\":%u,\"humidity\":%u,",
-			       ais->type8.dac1fid31.day,
-			       ais->type8.dac1fid31.hour,
-			       ais->type8.dac1fid31.minute,
-			       ais->type8.dac1fid31.wspeed,
-			       ais->type8.dac1fid31.wgust,
-			       ais->type8.dac1fid31.wdir,
-			       ais->type8.dac1fid31.wgustdir,
-			       ais->type8.dac1fid31.humidity);
+		    json_out_printf(out,
+				    "\"lat\":%d,\"lon\":%d,",
+				    ais->type8.dac1fid31.lat,
+				    ais->type8.dac1fid31.lon);
+		json_out_printf(out,
+				"\"accuracy\":%s,",
+				JSON_BOOL(ais->type8.dac1fid31.accuracy));
+		json_out_printf(out,
+				"\"timestamp\":\"%02uT%02u:%02uZ\","
+				"\"wspeed\":%u,\"wgust\":%u,\"wdir\":%u,"
+				"\"wgustdir\":%u,\"humidity\":%u,",
+				ais->type8.dac1fid31.day,
+				ais->type8.dac1fid31.hour,
+				ais->type8.dac1fid31.minute,
+				ais->type8.dac1fid31.wspeed,
+				ais->type8.dac1fid31.wgust,
+				ais->type8.dac1fid31.wdir,
+				ais->type8.dac1fid31.wgustdir,
+				ais->type8.dac1fid31.humidity);
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
-				   "\"pressure\":%u,\"pressuretend\":\"%s\","
-				   "\"visgreater\":%s,",
-				   ais->type8.dac1fid31.airtemp / DAC1FID31_AIRTEMP_DIV,
-				   ais->type8.dac1fid31.dewpoint / DAC1FID31_DEWPOINT_DIV,
-				   ais->type8.dac1fid31.pressure - DAC1FID31_PRESSURE_OFFSET,
-				   trends[ais->type8.dac1fid31.pressuretend],
-				   JSON_BOOL(ais->type8.dac1fid31.visgreater));
+		    json_out_printf(out,
+				    "\"airtemp\":%.1f,\"dewpoint\":%.1f,"
+				    "\"pressure\":%u,\"pressuretend\":\"%s\","
+				    "\"visgreater\":%s,",
+				    ais->type8.dac1fid31.airtemp / DAC1FID31_AIRTEMP_DIV,
+				    ais->type8.dac1fid31.dewpoint / DAC1FID31_DEWPOINT_DIV,
+				    ais->type8.dac1fid31.pressure - DAC1FID31_PRESSURE_OFFSET,
+				    trends[ais->type8.dac1fid31.pressuretend],
+				    JSON_BOOL(ais->type8.dac1fid31.visgreater));
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"airtemp\":%d,\"dewpoint\":%d,"
-				   "\"pressure\":%u,\"pressuretend\":%u,"
-				   "\"visgreater\":%s,",
-				   ais->type8.dac1fid31.airtemp,
-				   ais->type8.dac1fid31.dewpoint,
-				   ais->type8.dac1fid31.pressure,
-				   ais->type8.dac1fid31.pressuretend,
-				   JSON_BOOL(ais->type8.dac1fid31.visgreater));
+		    json_out_printf(out,
+				    "\"airtemp\":%d,\"dewpoint\":%d,"
+				    "\"pressure\":%u,\"pressuretend\":%u,"
+				    "\"visgreater\":%s,",
+				    ais->type8.dac1fid31.airtemp,
+				    ais->type8.dac1fid31.dewpoint,
+				    ais->type8.dac1fid31.pressure,
+				    ais->type8.dac1fid31.pressuretend,
+				    JSON_BOOL(ais->type8.dac1fid31.visgreater));
 
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"visibility\":%.1f,",
-				   ais->type8.dac1fid31.visibility / DAC1FID31_VISIBILITY_DIV);
+		    json_out_printf(out,
+				    "\"visibility\":%.1f,",
+				    ais->type8.dac1fid31.visibility / DAC1FID31_VISIBILITY_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"visibility\":%u,",
-				   ais->type8.dac1fid31.visibility);
+		    json_out_printf(out,
+				    "\"visibility\":%u,",
+				    ais->type8.dac1fid31.visibility);
 		if (!scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%d,",
-				   ais->type8.dac1fid31.waterlevel);
+		    json_out_printf(out,
+				    "\"waterlevel\":%d,",
+				    ais->type8.dac1fid31.waterlevel);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"waterlevel\":%.1f,",
-				   (ais->type8.dac1fid31.waterlevel - DAC1FID31_WATERLEVEL_OFFSET) / DAC1FID31_WATERLEVEL_DIV);
+		    json_out_printf(out,
+				    "\"waterlevel\":%.1f,",
+				    (ais->type8.dac1fid31.waterlevel - DAC1FID31_WATERLEVEL_OFFSET) / DAC1FID31_WATERLEVEL_DIV);
 
 		if (scaled) {
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"leveltrend\":\"%s\","
-				   "\"cspeed\":%.1f,\"cdir\":%u,"
-				   "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
-				   "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
-				   "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
-				   "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
-				   "\"seastate\":%u,\"watertemp\":%.1f,"
-				   "\"preciptype\":\"%s\",\"salinity\":%.1f,\"ice\":\"%s\"",
-				   trends[ais->type8.dac1fid31.leveltrend],
-				   ais->type8.dac1fid31.cspeed / DAC1FID31_CSPEED_DIV,
-				   ais->type8.dac1fid31.cdir,
-				   ais->type8.dac1fid31.cspeed2 / DAC1FID31_CSPEED_DIV,
-				   ais->type8.dac1fid31.cdir2,
-				   ais->type8.dac1fid31.cdepth2,
-				   ais->type8.dac1fid31.cspeed3 / DAC1FID31_CSPEED_DIV,
-				   ais->type8.dac1fid31.cdir3,
-				   ais->type8.dac1fid31.cdepth3,
-				   ais->type8.dac1fid31.waveheight / DAC1FID31_HEIGHT_DIV,
-				   ais->type8.dac1fid31.waveperiod,
-				   ais->type8.dac1fid31.wavedir,
-				   ais->type8.dac1fid31.swellheight / DAC1FID31_HEIGHT_DIV,
-				   ais->type8.dac1fid31.swellperiod,
-				   ais->type8.dac1fid31.swelldir,
-				   ais->type8.dac1fid31.seastate,
-				   ais->type8.dac1fid31.watertemp / DAC1FID31_WATERTEMP_DIV,
-				   preciptypes[ais->type8.dac1fid31.preciptype],
-				   ais->type8.dac1fid31.salinity / DAC1FID31_SALINITY_DIV,
-				   ice[ais->type8.dac1fid31.ice]);
+		    json_out_printf(out,
+				    "\"leveltrend\":\"%s\","
+				    "\"cspeed\":%.1f,\"cdir\":%u,"
+				    "\"cspeed2\":%.1f,\"cdir2\":%u,\"cdepth2\":%u,"
+				    "\"cspeed3\":%.1f,\"cdir3\":%u,\"cdepth3\":%u,"
+				    "\"waveheight\":%.1f,\"waveperiod\":%u,\"wavedir\":%u,"
+				    "\"swellheight\":%.1f,\"swellperiod\":%u,\"swelldir\":%u,"
+				    "\"seastate\":%u,\"watertemp\":%.1f,"
+				    "\"preciptype\":\"%s\",\"salinity\":%.1f,\"ice\":\"%s\"",
+				    trends[ais->type8.dac1fid31.leveltrend],
+				    ais->type8.dac1fid31.cspeed / DAC1FID31_CSPEED_DIV,
+				    ais->type8.dac1fid31.cdir,
+				    ais->type8.dac1fid31.cspeed2 / DAC1FID31_CSPEED_DIV,
+				    ais->type8.dac1fid31.cdir2,
+				    ais->type8.dac1fid31.cdepth2,
+				    ais->type8.dac1fid31.cspeed3 / DAC1FID31_CSPEED_DIV,
+				    ais->type8.dac1fid31.cdir3,
+				    ais->type8.dac1fid31.cdepth3,
+				    ais->type8.dac1fid31.waveheight / DAC1FID31_HEIGHT_DIV,
+				    ais->type8.dac1fid31.waveperiod,
+				    ais->type8.dac1fid31.wavedir,
+				    ais->type8.dac1fid31.swellheight / DAC1FID31_HEIGHT_DIV,
+				    ais->type8.dac1fid31.swellperiod,
+				    ais->type8.dac1fid31.swelldir,
+				    ais->type8.dac1fid31.seastate,
+				    ais->type8.dac1fid31.watertemp / DAC1FID31_WATERTEMP_DIV,
+				    preciptypes[ais->type8.dac1fid31.preciptype],
+				    ais->type8.dac1fid31.salinity / DAC1FID31_SALINITY_DIV,
+				    ice[ais->type8.dac1fid31.ice]);
 		} else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-				   "\"leveltrend\":%u,"
-				   "\"cspeed\":%u,\"cdir\":%u,"
-				   "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
-				   "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
-				   "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
-				   "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
-				   "\"seastate\":%u,\"watertemp\":%d,"
-				   "\"preciptype\":%u,\"salinity\":%u,\"ice\":%u",
-				   ais->type8.dac1fid31.leveltrend,
-				   ais->type8.dac1fid31.cspeed,
-				   ais->type8.dac1fid31.cdir,
-				   ais->type8.dac1fid31.cspeed2,
-				   ais->type8.dac1fid31.cdir2,
-				   ais->type8.dac1fid31.cdepth2,
-				   ais->type8.dac1fid31.cspeed3,
-				   ais->type8.dac1fid31.cdir3,
-				   ais->type8.dac1fid31.cdepth3,
-				   ais->type8.dac1fid31.waveheight,
-				   ais->type8.dac1fid31.waveperiod,
-				   ais->type8.dac1fid31.wavedir,
-				   ais->type8.dac1fid31.swellheight,
-				   ais->type8.dac1fid31.swellperiod,
-				   ais->type8.dac1fid31.swelldir,
-				   ais->type8.dac1fid31.seastate,
-				   ais->type8.dac1fid31.watertemp,
-				   ais->type8.dac1fid31.preciptype,
-				   ais->type8.dac1fid31.salinity,
-				   ais->type8.dac1fid31.ice);
-		(void)strlcat(buf, "}\r\n", buflen);
+		    json_out_printf(out,
+				    "\"leveltrend\":%u,"
+				    "\"cspeed\":%u,\"cdir\":%u,"
+				    "\"cspeed2\":%u,\"cdir2\":%u,\"cdepth2\":%u,"
+				    "\"cspeed3\":%u,\"cdir3\":%u,\"cdepth3\":%u,"
+				    "\"waveheight\":%u,\"waveperiod\":%u,\"wavedir\":%u,"
+				    "\"swellheight\":%u,\"swellperiod\":%u,\"swelldir\":%u,"
+				    "\"seastate\":%u,\"watertemp\":%d,"
+				    "\"preciptype\":%u,\"salinity\":%u,\"ice\":%u",
+				    ais->type8.dac1fid31.leveltrend,
+				    ais->type8.dac1fid31.cspeed,
+				    ais->type8.dac1fid31.cdir,
+				    ais->type8.dac1fid31.cspeed2,
+				    ais->type8.dac1fid31.cdir2,
+				    ais->type8.dac1fid31.cdepth2,
+				    ais->type8.dac1fid31.cspeed3,
+				    ais->type8.dac1fid31.cdir3,
+				    ais->type8.dac1fid31.cdepth3,
+				    ais->type8.dac1fid31.waveheight,
+				    ais->type8.dac1fid31.waveperiod,
+				    ais->type8.dac1fid31.wavedir,
+				    ais->type8.dac1fid31.swellheight,
+				    ais->type8.dac1fid31.swellperiod,
+				    ais->type8.dac1fid31.swelldir,
+				    ais->type8.dac1fid31.seastate,
+				    ais->type8.dac1fid31.watertemp,
+				    ais->type8.dac1fid31.preciptype,
+				    ais->type8.dac1fid31.salinity,
+				    ais->type8.dac1fid31.ice);
+		json_out_raw(out, "}\r\n");
 		structured = true;
 		break;
 	    }
@@ -2873,28 +2777,28 @@ void json_aivdm_dump(const struct ais_t *ais,
 		    || (int)ais->type8.dac200fid10.hazard >= NITEMS(hazard_types)
 		    || !isascii((int)ais->type8.dac200fid10.vin[0]))
 		    break;
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"vin\":\"%s\",\"length\":%u,\"beam\":%u,"
-			       "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			       "\"hazard\":%u,\"hazard_text\":\"%s\","
-			       "\"draught\":%u,"
-			       "\"loaded\":%u,\"loaded_text\":\"%s\","
-			       "\"speed_q\":%s,"
-			       "\"course_q\":%s,"
-			       "\"heading_q\":%s}\r\n",
-			       ais->type8.dac200fid10.vin,
-			       ais->type8.dac200fid10.length,
-			       ais->type8.dac200fid10.beam,
-			       ais->type8.dac200fid10.shiptype,
-			       cp->legend,
-			       ais->type8.dac200fid10.hazard,
-			       HTYPE_DISPLAY(ais->type8.dac200fid10.hazard),
-			       ais->type8.dac200fid10.draught,
-			       ais->type8.dac200fid10.loaded,
-			       LSTATUS_DISPLAY(ais->type8.dac200fid10.loaded),
-			       JSON_BOOL(ais->type8.dac200fid10.speed_q),
-			       JSON_BOOL(ais->type8.dac200fid10.course_q),
-			       JSON_BOOL(ais->type8.dac200fid10.heading_q));
+		json_out_printf(out,
+				"\"vin\":\"%s\",\"length\":%u,\"beam\":%u,"
+				"\"shiptype\":%u,\"shiptype_text\":\"%s\","
+				"\"hazard\":%u,\"hazard_text\":\"%s\","
+				"\"draught\":%u,"
+				"\"loaded\":%u,\"loaded_text\":\"%s\","
+				"\"speed_q\":%s,"
+				"\"course_q\":%s,"
+				"\"heading_q\":%s}\r\n",
+				ais->type8.dac200fid10.vin,
+				ais->type8.dac200fid10.length,
+				ais->type8.dac200fid10.beam,
+				ais->type8.dac200fid10.shiptype,
+				cp->legend,
+				ais->type8.dac200fid10.hazard,
+				HTYPE_DISPLAY(ais->type8.dac200fid10.hazard),
+				ais->type8.dac200fid10.draught,
+				ais->type8.dac200fid10.loaded,
+				LSTATUS_DISPLAY(ais->type8.dac200fid10.loaded),
+				JSON_BOOL(ais->type8.dac200fid10.speed_q),
+				JSON_BOOL(ais->type8.dac200fid10.course_q),
+				JSON_BOOL(ais->type8.dac200fid10.heading_q));
 		structured = true;
 		break;
 	    case 23:	/* EMMA warning */
@@ -2904,34 +2808,34 @@ void json_aivdm_dump(const struct ais_t *ais,
 		 */
 		if ((int)ais->type8.dac200fid23.type >= NITEMS(emma_types))
 		    break;
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"start\":\"%4u-%02u-%02uT%02u:%02u\","
-			       "\"end\":\"%4u-%02u-%02uT%02u:%02u\",",
-			       ais->type8.dac200fid23.start_year + 2000,
-			       ais->type8.dac200fid23.start_month,
-			       ais->type8.dac200fid23.start_hour,
-			       ais->type8.dac200fid23.start_minute,
-			       ais->type8.dac200fid23.start_day,
-			       ais->type8.dac200fid23.end_year + 2000,
-			       ais->type8.dac200fid23.end_month,
-			       ais->type8.dac200fid23.end_day,
-			       ais->type8.dac200fid23.end_hour,
-			       ais->type8.dac200fid23.end_minute);
+		json_out_printf(out,
+				"\"start\":\"%4u-%02u-%02uT%02u:%02u\","
+				"\"end\":\"%4u-%02u-%02uT%02u:%02u\",",
+				ais->type8.dac200fid23.start_year + 2000,
+				ais->type8.dac200fid23.start_month,
+				ais->type8.dac200fid23.start_hour,
+				ais->type8.dac200fid23.start_minute,
+				ais->type8.dac200fid23.start_day,
+				ais->type8.dac200fid23.end_year + 2000,
+				ais->type8.dac200fid23.end_month,
+				ais->type8.dac200fid23.end_day,
+				ais->type8.dac200fid23.end_hour,
+				ais->type8.dac200fid23.end_minute);
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			"\"start_lon\":%.4f,\"start_lat\":%.4f,\"end_lon\":%.4f,\"end_lat\":%.4f,",
 			ais->type8.dac200fid23.start_lon / AIS_LATLON_DIV,
 			ais->type8.dac200fid23.start_lat / AIS_LATLON_DIV,
 			ais->type8.dac200fid23.end_lon / AIS_LATLON_DIV,
 			ais->type8.dac200fid23.end_lat / AIS_LATLON_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			"\"start_lon\":%d,\"start_lat\":%d,\"end_lon\":%d,\"end_lat\":%d,",
 			ais->type8.dac200fid23.start_lon,
 			ais->type8.dac200fid23.start_lat,
 			ais->type8.dac200fid23.end_lon,
 			ais->type8.dac200fid23.end_lat);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		    "\"type\":%u,\"type_text\":\"%s\",\"min\":%d,\"max\":%d,\"class\":%u,\"class_text\":\"%s\",\"wind\":%u,\"wind_text\":\"%s\"}\r\n",
 
 		    ais->type8.dac200fid23.type,
@@ -2945,32 +2849,31 @@ void json_aivdm_dump(const struct ais_t *ais,
 		structured = true;
 		break;
 	    case 24:	/* Inland AIS Water Levels */
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		    "\"country\":\"%s\",\"gauges\":[",
 		    ais->type8.dac200fid24.country);
 		for (i = 0; i < ais->type8.dac200fid24.ngauges; i++) {
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			"{\"id\":%u,\"level\":%d}",
 			ais->type8.dac200fid24.gauges[i].id,
 			ais->type8.dac200fid24.gauges[i].level);
 		}
-		if (buf[strlen(buf)-1] == ',')
-		    buf[strlen(buf)-1] = '\0';
-		(void)strlcat(buf, "]}\r\n", buflen - strlen(buf));
+		json_out_trim(out);
+		json_out_raw(out, "]}\r\n");
 		structured = true;
 		break;
 	    case 40:	/* Inland AIS Signal Strength */
 		if (scaled)
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			"\"lon\":%.4f,\"lat\":%.4f,",
 			ais->type8.dac200fid40.lon / AIS_LATLON_DIV,
 			ais->type8.dac200fid40.lat / AIS_LATLON_DIV);
 		else
-		    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		    json_out_printf(out,
 			"\"lon\":%d,\"lat\":%d,",
 			ais->type8.dac200fid40.lon,
 			ais->type8.dac200fid40.lat);
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
+		json_out_printf(out,
 		    "\"form\":%u,\"facing\":%u,\"direction\":%u,\"direction_text\":\"%s\",\"status\":%u,\"status_text\":\"%s\"}\r\n",
 		    ais->type8.dac200fid40.form,
 		    ais->type8.dac200fid40.facing,
@@ -2983,10 +2886,10 @@ void json_aivdm_dump(const struct ais_t *ais,
 	    }
 	}
 	if (!structured)
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"data\":\"%zd:%s\"}\r\n",
-			   ais->type8.bitcount,
-			   json_stringify(buf1, sizeof(buf1),
+	    json_out_printf(out,
+			    "\"data\":\"%zd:%s\"}\r\n",
+			    ais->type8.bitcount,
+			    json_stringify(buf1, sizeof(buf1),
 					  gpsd_hexdump(scratchbuf, sizeof(scratchbuf), 
 						       (char *)ais->type8.bitdata,
 						       (ais->type8.bitcount + 7) / 8)));
@@ -3020,606 +2923,599 @@ void json_aivdm_dump(const struct ais_t *ais,
 		(void)snprintf(speedlegend, sizeof(speedlegend),
 			       "%u", ais->type1.speed);
 
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"alt\":%s,\"speed\":%s,\"accuracy\":%s,"
-			   "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-			   "\"second\":%u,\"regional\":%u,\"dte\":%u,"
-			   "\"raim\":%s,\"radio\":%u}\r\n",
-			   altlegend,
-			   speedlegend,
-			   JSON_BOOL(ais->type9.accuracy),
-			   ais->type9.lon / AIS_LATLON_DIV,
-			   ais->type9.lat / AIS_LATLON_DIV,
-			   ais->type9.course / 10.0,
-			   ais->type9.second,
-			   ais->type9.regional,
-			   ais->type9.dte,
-			   JSON_BOOL(ais->type9.raim), ais->type9.radio);
+	    json_out_printf(out,
+			    "\"alt\":%s,\"speed\":%s,\"accuracy\":%s,"
+			    "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
+			    "\"second\":%u,\"regional\":%u,\"dte\":%u,"
+			    "\"raim\":%s,\"radio\":%u}\r\n",
+			    altlegend,
+			    speedlegend,
+			    JSON_BOOL(ais->type9.accuracy),
+			    ais->type9.lon / AIS_LATLON_DIV,
+			    ais->type9.lat / AIS_LATLON_DIV,
+			    ais->type9.course / 10.0,
+			    ais->type9.second,
+			    ais->type9.regional,
+			    ais->type9.dte,
+			    JSON_BOOL(ais->type9.raim), ais->type9.radio);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"alt\":%u,\"speed\":%u,\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-			   "\"second\":%u,\"regional\":%u,\"dte\":%u,"
-			   "\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type9.alt,
-			   ais->type9.speed,
-			   JSON_BOOL(ais->type9.accuracy),
-			   ais->type9.lon,
-			   ais->type9.lat,
-			   ais->type9.course,
-			   ais->type9.second,
-			   ais->type9.regional,
-			   ais->type9.dte,
-			   JSON_BOOL(ais->type9.raim), ais->type9.radio);
+	    json_out_printf(out,
+			    "\"alt\":%u,\"speed\":%u,\"accuracy\":%s,"
+			    "\"lon\":%d,\"lat\":%d,\"course\":%u,"
+			    "\"second\":%u,\"regional\":%u,\"dte\":%u,"
+			    "\"raim\":%s,\"radio\":%u}\r\n",
+			    ais->type9.alt,
+			    ais->type9.speed,
+			    JSON_BOOL(ais->type9.accuracy),
+			    ais->type9.lon,
+			    ais->type9.lat,
+			    ais->type9.course,
+			    ais->type9.second,
+			    ais->type9.regional,
+			    ais->type9.dte,
+			    JSON_BOOL(ais->type9.raim), ais->type9.radio);
 	}
 	break;
     case 10:			/* UTC/Date Inquiry */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"dest_mmsi\":%u}\r\n", ais->type10.dest_mmsi);
+	json_out_printf(out,
+			"\"dest_mmsi\":%u}\r\n", ais->type10.dest_mmsi);
 	break;
     case 12:			/* Safety Related Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"seqno\":%u,\"dest_mmsi\":%u,\"retransmit\":%s,\"text\":\"%s\"}\r\n",
-		       ais->type12.seqno,
-		       ais->type12.dest_mmsi,
-		       JSON_BOOL(ais->type12.retransmit),
-		       json_stringify(buf1, sizeof(buf1), ais->type12.text));
+	json_out_printf(out,
+			"\"seqno\":%u,\"dest_mmsi\":%u,\"retransmit\":%s,\"text\":\"%s\"}\r\n",
+			ais->type12.seqno,
+			ais->type12.dest_mmsi,
+			JSON_BOOL(ais->type12.retransmit),
+			json_stringify(buf1, sizeof(buf1), ais->type12.text));
 	break;
     case 14:			/* Safety Related Broadcast Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"text\":\"%s\"}\r\n",
-		       json_stringify(buf1, sizeof(buf1), ais->type14.text));
+	json_out_printf(out,
+			"\"text\":\"%s\"}\r\n",
+			json_stringify(buf1, sizeof(buf1), ais->type14.text));
 	break;
     case 15:			/* Interrogation */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"mmsi1\":%u,\"type1_1\":%u,\"offset1_1\":%u,"
-		       "\"type1_2\":%u,\"offset1_2\":%u,\"mmsi2\":%u,"
-		       "\"type2_1\":%u,\"offset2_1\":%u}\r\n",
-		       ais->type15.mmsi1,
-		       ais->type15.type1_1,
-		       ais->type15.offset1_1,
-		       ais->type15.type1_2,
-		       ais->type15.offset1_2,
-		       ais->type15.mmsi2,
-		       ais->type15.type2_1, ais->type15.offset2_1);
+	json_out_printf(out,
+			"\"mmsi1\":%u,\"type1_1\":%u,\"offset1_1\":%u,"
+			"\"type1_2\":%u,\"offset1_2\":%u,\"mmsi2\":%u,"
+			"\"type2_1\":%u,\"offset2_1\":%u}\r\n",
+			ais->type15.mmsi1,
+			ais->type15.type1_1,
+			ais->type15.offset1_1,
+			ais->type15.type1_2,
+			ais->type15.offset1_2,
+			ais->type15.mmsi2,
+			ais->type15.type2_1, ais->type15.offset2_1);
 	break;
     case 16:
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"mmsi1\":%u,\"offset1\":%u,\"increment1\":%u,"
-		       "\"mmsi2\":%u,\"offset2\":%u,\"increment2\":%u}\r\n",
-		       ais->type16.mmsi1,
-		       ais->type16.offset1,
-		       ais->type16.increment1,
-		       ais->type16.mmsi2,
-		       ais->type16.offset2, ais->type16.increment2);
+	json_out_printf(out,
+			"\"mmsi1\":%u,\"offset1\":%u,\"increment1\":%u,"
+			"\"mmsi2\":%u,\"offset2\":%u,\"increment2\":%u}\r\n",
+			ais->type16.mmsi1,
+			ais->type16.offset1,
+			ais->type16.increment1,
+			ais->type16.mmsi2,
+			ais->type16.offset2, ais->type16.increment2);
 	break;
     case 17:
 	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"lon\":%.1f,\"lat\":%.1f,\"data\":\"%zd:%s\"}\r\n",
-			   ais->type17.lon / AIS_GNSS_LATLON_DIV,
-			   ais->type17.lat / AIS_GNSS_LATLON_DIV,
-			   ais->type17.bitcount,
-			   gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+	    json_out_printf(out,
+			    "\"lon\":%.1f,\"lat\":%.1f,\"data\":\"%zd:%s\"}\r\n",
+			    ais->type17.lon / AIS_GNSS_LATLON_DIV,
+			    ais->type17.lat / AIS_GNSS_LATLON_DIV,
+			    ais->type17.bitcount,
+			    gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
 					(char *)ais->type17.bitdata,
 					(ais->type17.bitcount + 7) / 8));
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"lon\":%d,\"lat\":%d,\"data\":\"%zd:%s\"}\r\n",
-			   ais->type17.lon,
-			   ais->type17.lat,
-			   ais->type17.bitcount,
-			   gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+	    json_out_printf(out,
+			    "\"lon\":%d,\"lat\":%d,\"data\":\"%zd:%s\"}\r\n",
+			    ais->type17.lon,
+			    ais->type17.lat,
+			    ais->type17.bitcount,
+			    gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
 					(char *)ais->type17.bitdata,
 					(ais->type17.bitcount + 7) / 8));
 	}
 	break;
     case 18:
+    case 19:
+	/* type 19 starts with the same members as type 18 */
+	json_out_member_uint(out, "reserved", ais->type18.reserved);
+	if (scaled)
+	    json_out_member_scaled(out, "speed", (long long)ais->type18.speed, 1);
+	else
+	    json_out_member_uint(out, "speed", ais->type18.speed);
+	json_out_member_bool(out, "accuracy", ais->type18.accuracy);
 	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
-			   "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"cs\":%s,\"display\":%s,\"dsc\":%s,\"band\":%s,"
-			   "\"msg22\":%s,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type18.reserved,
-			   ais->type18.speed / 10.0,
-			   JSON_BOOL(ais->type18.accuracy),
-			   ais->type18.lon / AIS_LATLON_DIV,
-			   ais->type18.lat / AIS_LATLON_DIV,
-			   ais->type18.course / 10.0,
-			   ais->type18.heading,
-			   ais->type18.second,
-			   ais->type18.regional,
-			   JSON_BOOL(ais->type18.cs),
-			   JSON_BOOL(ais->type18.display),
-			   JSON_BOOL(ais->type18.dsc),
-			   JSON_BOOL(ais->type18.band),
-			   JSON_BOOL(ais->type18.msg22),
-			   JSON_BOOL(ais->type18.raim), ais->type18.radio);
+	    json_out_member_fixed(out, "lon", ais->type18.lon / AIS_LATLON_DIV, 4);
+	    json_out_member_fixed(out, "lat", ais->type18.lat / AIS_LATLON_DIV, 4);
+	    json_out_member_scaled(out, "course", (long long)ais->type18.course, 1);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"cs\":%s,\"display\":%s,\"dsc\":%s,\"band\":%s,"
-			   "\"msg22\":%s,\"raim\":%s,\"radio\":%u}\r\n",
-			   ais->type18.reserved,
-			   ais->type18.speed,
-			   JSON_BOOL(ais->type18.accuracy),
-			   ais->type18.lon,
-			   ais->type18.lat,
-			   ais->type18.course,
-			   ais->type18.heading,
-			   ais->type18.second,
-			   ais->type18.regional,
-			   JSON_BOOL(ais->type18.cs),
-			   JSON_BOOL(ais->type18.display),
-			   JSON_BOOL(ais->type18.dsc),
-			   JSON_BOOL(ais->type18.band),
-			   JSON_BOOL(ais->type18.msg22),
-			   JSON_BOOL(ais->type18.raim), ais->type18.radio);
+	    json_out_member_int(out, "lon", ais->type18.lon);
+	    json_out_member_int(out, "lat", ais->type18.lat);
+	    json_out_member_uint(out, "course", ais->type18.course);
 	}
-	break;
-    case 19:
-	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%.1f,\"accuracy\":%s,"
-			   "\"lon\":%.4f,\"lat\":%.4f,\"course\":%.1f,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"shipname\":\"%s\","
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"raim\":%s,\"dte\":%u,\"assigned\":%s}\r\n",
-			   ais->type19.reserved,
-			   ais->type19.speed / 10.0,
-			   JSON_BOOL(ais->type19.accuracy),
-			   ais->type19.lon / AIS_LATLON_DIV,
-			   ais->type19.lat / AIS_LATLON_DIV,
-			   ais->type19.course / 10.0,
-			   ais->type19.heading,
-			   ais->type19.second,
-			   ais->type19.regional,
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type19.shipname),
-			   ais->type19.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type19.shiptype),
-			   ais->type19.to_bow,
-			   ais->type19.to_stern,
-			   ais->type19.to_port,
-			   ais->type19.to_starboard,
-			   ais->type19.epfd,
-			   EPFD_DISPLAY(ais->type19.epfd),
-			   JSON_BOOL(ais->type19.raim),
-			   ais->type19.dte,
-			   JSON_BOOL(ais->type19.assigned));
+	json_out_member_uint(out, "heading", ais->type18.heading);
+	json_out_member_uint(out, "second", ais->type18.second);
+	json_out_member_uint(out, "regional", ais->type18.regional);
+	if (ais->type == 18) {
+	    json_out_member_bool(out, "cs", ais->type18.cs);
+	    json_out_member_bool(out, "display", ais->type18.display);
+	    json_out_member_bool(out, "dsc", ais->type18.dsc);
+	    json_out_member_bool(out, "band", ais->type18.band);
+	    json_out_member_bool(out, "msg22", ais->type18.msg22);
+	    json_out_member_bool(out, "raim", ais->type18.raim);
+	    json_out_key(out, "radio");
+	    json_out_uint(out, ais->type18.radio);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"reserved\":%u,\"speed\":%u,\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"course\":%u,"
-			   "\"heading\":%u,\"second\":%u,\"regional\":%u,"
-			   "\"shipname\":\"%s\","
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"to_bow\":%u,\"to_stern\":%u,\"to_port\":%u,"
-			   "\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"raim\":%s,\"dte\":%u,\"assigned\":%s}\r\n",
-			   ais->type19.reserved,
-			   ais->type19.speed,
-			   JSON_BOOL(ais->type19.accuracy),
-			   ais->type19.lon,
-			   ais->type19.lat,
-			   ais->type19.course,
-			   ais->type19.heading,
-			   ais->type19.second,
-			   ais->type19.regional,
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type19.shipname),
-			   ais->type19.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type19.shiptype),
-			   ais->type19.to_bow,
-			   ais->type19.to_stern,
-			   ais->type19.to_port,
-			   ais->type19.to_starboard,
-			   ais->type19.epfd,
-			   EPFD_DISPLAY(ais->type19.epfd),
-			   JSON_BOOL(ais->type19.raim),
-			   ais->type19.dte,
-			   JSON_BOOL(ais->type19.assigned));
+	    json_out_member_string(out, "shipname", ais->type19.shipname);
+	    json_out_member_uint(out, "shiptype", ais->type19.shiptype);
+	    json_out_member_str(out, "shiptype_text",
+				SHIPTYPE_DISPLAY(ais->type19.shiptype));
+	    json_out_member_uint(out, "to_bow", ais->type19.to_bow);
+	    json_out_member_uint(out, "to_stern", ais->type19.to_stern);
+	    json_out_member_uint(out, "to_port", ais->type19.to_port);
+	    json_out_member_uint(out, "to_starboard", ais->type19.to_starboard);
+	    json_out_member_uint(out, "epfd", ais->type19.epfd);
+	    json_out_member_str(out, "epfd_text",
+				EPFD_DISPLAY(ais->type19.epfd));
+	    json_out_member_bool(out, "raim", ais->type19.raim);
+	    json_out_member_uint(out, "dte", ais->type19.dte);
+	    json_out_key(out, "assigned");
+	    json_out_raw(out, JSON_BOOL(ais->type19.assigned));
 	}
+	json_out_raw(out, "}\r\n");
 	break;
     case 20:			/* Data Link Management Message */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"offset1\":%u,\"number1\":%u,"
-		       "\"timeout1\":%u,\"increment1\":%u,"
-		       "\"offset2\":%u,\"number2\":%u,"
-		       "\"timeout2\":%u,\"increment2\":%u,"
-		       "\"offset3\":%u,\"number3\":%u,"
-		       "\"timeout3\":%u,\"increment3\":%u,"
-		       "\"offset4\":%u,\"number4\":%u,"
-		       "\"timeout4\":%u,\"increment4\":%u}\r\n",
-		       ais->type20.offset1,
-		       ais->type20.number1,
-		       ais->type20.timeout1,
-		       ais->type20.increment1,
-		       ais->type20.offset2,
-		       ais->type20.number2,
-		       ais->type20.timeout2,
-		       ais->type20.increment2,
-		       ais->type20.offset3,
-		       ais->type20.number3,
-		       ais->type20.timeout3,
-		       ais->type20.increment3,
-		       ais->type20.offset4,
-		       ais->type20.number4,
-		       ais->type20.timeout4, ais->type20.increment4);
+	json_out_printf(out,
+			"\"offset1\":%u,\"number1\":%u,"
+			"\"timeout1\":%u,\"increment1\":%u,"
+			"\"offset2\":%u,\"number2\":%u,"
+			"\"timeout2\":%u,\"increment2\":%u,"
+			"\"offset3\":%u,\"number3\":%u,"
+			"\"timeout3\":%u,\"increment3\":%u,"
+			"\"offset4\":%u,\"number4\":%u,"
+			"\"timeout4\":%u,\"increment4\":%u}\r\n",
+			ais->type20.offset1,
+			ais->type20.number1,
+			ais->type20.timeout1,
+			ais->type20.increment1,
+			ais->type20.offset2,
+			ais->type20.number2,
+			ais->type20.timeout2,
+			ais->type20.increment2,
+			ais->type20.offset3,
+			ais->type20.number3,
+			ais->type20.timeout3,
+			ais->type20.increment3,
+			ais->type20.offset4,
+			ais->type20.number4,
+			ais->type20.timeout4, ais->type20.increment4);
 	break;
     case 21:			/* Aid to Navigation */
+	json_out_member_uint(out, "aid_type", ais->type21.aid_type);
+	json_out_member_str(out, "aid_type_text",
+			    NAVAIDTYPE_DISPLAY(ais->type21.aid_type));
+	json_out_member_string(out, "name", ais->type21.name);
 	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"aid_type\":%u,\"aid_type_text\":\"%s\","
-			   "\"name\":\"%s\",\"lon\":%.4f,"
-			   "\"lat\":%.4f,\"accuracy\":%s,\"to_bow\":%u,"
-			   "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"second\":%u,\"regional\":%u,"
-			   "\"off_position\":%s,\"raim\":%s,"
-			   "\"virtual_aid\":%s}\r\n",
-			   ais->type21.aid_type,
-			   NAVAIDTYPE_DISPLAY(ais->type21.aid_type),
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type21.name),
-			   ais->type21.lon / AIS_LATLON_DIV,
-			   ais->type21.lat / AIS_LATLON_DIV,
-			   JSON_BOOL(ais->type21.accuracy),
-			   ais->type21.to_bow, ais->type21.to_stern,
-			   ais->type21.to_port, ais->type21.to_starboard,
-			   ais->type21.epfd,
-			   EPFD_DISPLAY(ais->type21.epfd),
-			   ais->type21.second,
-			   ais->type21.regional,
-			   JSON_BOOL(ais->type21.off_position),
-			   JSON_BOOL(ais->type21.raim),
-			   JSON_BOOL(ais->type21.virtual_aid));
+	    json_out_member_fixed(out, "lon", ais->type21.lon / AIS_LATLON_DIV, 4);
+	    json_out_member_fixed(out, "lat", ais->type21.lat / AIS_LATLON_DIV, 4);
+	    json_out_member_bool(out, "accuracy", ais->type21.accuracy);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"aid_type\":%u,\"aid_type_text\":\"%s\","
-			   "\"name\":\"%s\",\"accuracy\":%s,"
-			   "\"lon\":%d,\"lat\":%d,\"to_bow\":%u,"
-			   "\"to_stern\":%u,\"to_port\":%u,\"to_starboard\":%u,"
-			   "\"epfd\":%u,\"epfd_text\":\"%s\","
-			   "\"second\":%u,\"regional\":%u,"
-			   "\"off_position\":%s,\"raim\":%s,"
-			   "\"virtual_aid\":%s}\r\n",
-			   ais->type21.aid_type,
-			   NAVAIDTYPE_DISPLAY(ais->type21.aid_type),
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type21.name),
-			   JSON_BOOL(ais->type21.accuracy),
-			   ais->type21.lon,
-			   ais->type21.lat,
-			   ais->type21.to_bow,
-			   ais->type21.to_stern,
-			   ais->type21.to_port,
-			   ais->type21.to_starboard,
-			   ais->type21.epfd,
-			   EPFD_DISPLAY(ais->type21.epfd),
-			   ais->type21.second,
-			   ais->type21.regional,
-			   JSON_BOOL(ais->type21.off_position),
-			   JSON_BOOL(ais->type21.raim),
-			   JSON_BOOL(ais->type21.virtual_aid));
+	    json_out_member_bool(out, "accuracy", ais->type21.accuracy);
+	    json_out_member_int(out, "lon", ais->type21.lon);
+	    json_out_member_int(out, "lat", ais->type21.lat);
 	}
+	json_out_member_uint(out, "to_bow", ais->type21.to_bow);
+	json_out_member_uint(out, "to_stern", ais->type21.to_stern);
+	json_out_member_uint(out, "to_port", ais->type21.to_port);
+	json_out_member_uint(out, "to_starboard", ais->type21.to_starboard);
+	json_out_member_uint(out, "epfd", ais->type21.epfd);
+	json_out_member_str(out, "epfd_text", EPFD_DISPLAY(ais->type21.epfd));
+	json_out_member_uint(out, "second", ais->type21.second);
+	json_out_member_uint(out, "regional", ais->type21.regional);
+	json_out_member_bool(out, "off_position", ais->type21.off_position);
+	json_out_member_bool(out, "raim", ais->type21.raim);
+	json_out_key(out, "virtual_aid");
+	json_out_raw(out, JSON_BOOL(ais->type21.virtual_aid));
+	json_out_raw(out, "}\r\n");
 	break;
     case 22:			/* Channel Management */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"channel_a\":%u,\"channel_b\":%u,"
-		       "\"txrx\":%u,\"power\":%s,",
-		       ais->type22.channel_a,
-		       ais->type22.channel_b,
-		       ais->type22.txrx, JSON_BOOL(ais->type22.power));
+	json_out_printf(out,
+			"\"channel_a\":%u,\"channel_b\":%u,"
+			"\"txrx\":%u,\"power\":%s,",
+			ais->type22.channel_a,
+			ais->type22.channel_b,
+			ais->type22.txrx, JSON_BOOL(ais->type22.power));
 	if (ais->type22.addressed) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"dest1\":%u,\"dest2\":%u,",
-			   ais->type22.mmsi.dest1, ais->type22.mmsi.dest2);
+	    json_out_printf(out,
+			    "\"dest1\":%u,\"dest2\":%u,",
+			    ais->type22.mmsi.dest1, ais->type22.mmsi.dest2);
 	} else if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
-			   "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\",",
-			   ais->type22.area.ne_lon / AIS_CHANNEL_LATLON_DIV,
-			   ais->type22.area.ne_lat / AIS_CHANNEL_LATLON_DIV,
-			   ais->type22.area.sw_lon / AIS_CHANNEL_LATLON_DIV,
-			   ais->type22.area.sw_lat /
-			   AIS_CHANNEL_LATLON_DIV);
+	    json_out_printf(out,
+			    "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
+			    "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\",",
+			    ais->type22.area.ne_lon / AIS_CHANNEL_LATLON_DIV,
+			    ais->type22.area.ne_lat / AIS_CHANNEL_LATLON_DIV,
+			    ais->type22.area.sw_lon / AIS_CHANNEL_LATLON_DIV,
+			    ais->type22.area.sw_lat /
+			    AIS_CHANNEL_LATLON_DIV);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":%d,\"ne_lat\":%d,"
-			   "\"sw_lon\":%d,\"sw_lat\":%d,",
-			   ais->type22.area.ne_lon,
-			   ais->type22.area.ne_lat,
-			   ais->type22.area.sw_lon, ais->type22.area.sw_lat);
+	    json_out_printf(out,
+			    "\"ne_lon\":%d,\"ne_lat\":%d,"
+			    "\"sw_lon\":%d,\"sw_lat\":%d,",
+			    ais->type22.area.ne_lon,
+			    ais->type22.area.ne_lat,
+			    ais->type22.area.sw_lon, ais->type22.area.sw_lat);
 	}
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"addressed\":%s,\"band_a\":%s,"
-		       "\"band_b\":%s,\"zonesize\":%u}\r\n",
-		       JSON_BOOL(ais->type22.addressed),
-		       JSON_BOOL(ais->type22.band_a),
-		       JSON_BOOL(ais->type22.band_b), ais->type22.zonesize);
+	json_out_printf(out,
+			"\"addressed\":%s,\"band_a\":%s,"
+			"\"band_b\":%s,\"zonesize\":%u}\r\n",
+			JSON_BOOL(ais->type22.addressed),
+			JSON_BOOL(ais->type22.band_a),
+			JSON_BOOL(ais->type22.band_b), ais->type22.zonesize);
 	break;
     case 23:			/* Group Assignment Command */
 	if (scaled) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
-			   "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\","
-			   "\"stationtype\":%u,\"stationtype_text\":\"%s\","
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"interval\":%u,\"quiet\":%u}\r\n",
-			   ais->type23.ne_lon / AIS_CHANNEL_LATLON_DIV,
-			   ais->type23.ne_lat / AIS_CHANNEL_LATLON_DIV,
-			   ais->type23.sw_lon / AIS_CHANNEL_LATLON_DIV,
-			   ais->type23.sw_lat / AIS_CHANNEL_LATLON_DIV,
-			   ais->type23.stationtype,
-			   STATIONTYPE_DISPLAY(ais->type23.stationtype),
-			   ais->type23.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type23.shiptype),
-			   ais->type23.interval, ais->type23.quiet);
+	    json_out_printf(out,
+			    "\"ne_lon\":\"%f\",\"ne_lat\":\"%f\","
+			    "\"sw_lon\":\"%f\",\"sw_lat\":\"%f\","
+			    "\"stationtype\":%u,\"stationtype_text\":\"%s\","
+			    "\"shiptype\":%u,\"shiptype_text\":\"%s\","
+			    "\"interval\":%u,\"quiet\":%u}\r\n",
+			    ais->type23.ne_lon / AIS_CHANNEL_LATLON_DIV,
+			    ais->type23.ne_lat / AIS_CHANNEL_LATLON_DIV,
+			    ais->type23.sw_lon / AIS_CHANNEL_LATLON_DIV,
+			    ais->type23.sw_lat / AIS_CHANNEL_LATLON_DIV,
+			    ais->type23.stationtype,
+			    STATIONTYPE_DISPLAY(ais->type23.stationtype),
+			    ais->type23.shiptype,
+			    SHIPTYPE_DISPLAY(ais->type23.shiptype),
+			    ais->type23.interval, ais->type23.quiet);
 	} else {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"ne_lon\":%d,\"ne_lat\":%d,"
-			   "\"sw_lon\":%d,\"sw_lat\":%d,"
-			   "\"stationtype\":%u,\"stationtype_text\":\"%s\","
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"interval\":%u,\"quiet\":%u}\r\n",
-			   ais->type23.ne_lon,
-			   ais->type23.ne_lat,
-			   ais->type23.sw_lon,
-			   ais->type23.sw_lat,
-			   ais->type23.stationtype,
-			   STATIONTYPE_DISPLAY(ais->type23.stationtype),
-			   ais->type23.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type23.shiptype),
-			   ais->type23.interval, ais->type23.quiet);
+	    json_out_printf(out,
+			    "\"ne_lon\":%d,\"ne_lat\":%d,"
+			    "\"sw_lon\":%d,\"sw_lat\":%d,"
+			    "\"stationtype\":%u,\"stationtype_text\":\"%s\","
+			    "\"shiptype\":%u,\"shiptype_text\":\"%s\","
+			    "\"interval\":%u,\"quiet\":%u}\r\n",
+			    ais->type23.ne_lon,
+			    ais->type23.ne_lat,
+			    ais->type23.sw_lon,
+			    ais->type23.sw_lat,
+			    ais->type23.stationtype,
+			    STATIONTYPE_DISPLAY(ais->type23.stationtype),
+			    ais->type23.shiptype,
+			    SHIPTYPE_DISPLAY(ais->type23.shiptype),
+			    ais->type23.interval, ais->type23.quiet);
 	}
 	break;
     case 24:			/* Class B CS Static Data Report */
 	if (ais->type24.part != both) {
 	    static char *partnames[] = {"AB", "A", "B"};
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"part\":\"%s\",",
-			   json_stringify(buf1, sizeof(buf1),
-					  partnames[ais->type24.part]));
+	    json_out_member_string(out, "part", partnames[ais->type24.part]);
 	}
 	if (ais->type24.part != part_b)
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"shipname\":\"%s\",",
-			   json_stringify(buf1, sizeof(buf1),
-				      ais->type24.shipname));
+	    json_out_member_string(out, "shipname", ais->type24.shipname);
 	if (ais->type24.part != part_a) {
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"shiptype\":%u,\"shiptype_text\":\"%s\","
-			   "\"vendorid\":\"%s\",\"model\":%u,\"serial\":%u,"
-			   "\"callsign\":\"%s\",",
-			   ais->type24.shiptype,
-			   SHIPTYPE_DISPLAY(ais->type24.shiptype),
-			   json_stringify(buf1, sizeof(buf1),
-					  ais->type24.vendorid),
-			   ais->type24.model,
-			   ais->type24.serial,
-			   json_stringify(buf2, sizeof(buf2),
-					  ais->type24.callsign));
+	    json_out_member_uint(out, "shiptype", ais->type24.shiptype);
+	    json_out_member_str(out, "shiptype_text",
+				SHIPTYPE_DISPLAY(ais->type24.shiptype));
+	    json_out_member_string(out, "vendorid", ais->type24.vendorid);
+	    json_out_member_uint(out, "model", ais->type24.model);
+	    json_out_member_uint(out, "serial", ais->type24.serial);
+	    json_out_member_string(out, "callsign", ais->type24.callsign);
 	    if (AIS_AUXILIARY_MMSI(ais->mmsi)) {
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"mothership_mmsi\":%u}\r\n",
-			       ais->type24.mothership_mmsi);
+		json_out_key(out, "mothership_mmsi");
+		json_out_uint(out, ais->type24.mothership_mmsi);
+		json_out_raw(out, "}\r\n");
 	    } else {
-		(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			       "\"to_bow\":%u,\"to_stern\":%u,"
-			       "\"to_port\":%u,\"to_starboard\":%u",
-			       ais->type24.dim.to_bow,
-			       ais->type24.dim.to_stern,
-			       ais->type24.dim.to_port,
-			       ais->type24.dim.to_starboard);
+		json_out_member_uint(out, "to_bow", ais->type24.dim.to_bow);
+		json_out_member_uint(out, "to_stern", ais->type24.dim.to_stern);
+		json_out_member_uint(out, "to_port", ais->type24.dim.to_port);
+		json_out_key(out, "to_starboard");
+		json_out_uint(out, ais->type24.dim.to_starboard);
 	    }
 	}
-	if (buf[strlen(buf)-1] == ',')
-	    buf[strlen(buf)-1] = '\0';
-	strncat(buf, "}\r\n", buflen);
+	json_out_trim(out);
+	json_out_raw(out, "}\r\n");
 	break;
     case 25:			/* Binary Message, Single Slot */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
-		       "\"app_id\":%u,\"data\":\"%zd:%s\"}\r\n",
-		       JSON_BOOL(ais->type25.addressed),
-		       JSON_BOOL(ais->type25.structured),
-		       ais->type25.dest_mmsi,
-		       ais->type25.app_id,
-		       ais->type25.bitcount,
-		       gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+	json_out_printf(out,
+			"\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
+			"\"app_id\":%u,\"data\":\"%zd:%s\"}\r\n",
+			JSON_BOOL(ais->type25.addressed),
+			JSON_BOOL(ais->type25.structured),
+			ais->type25.dest_mmsi,
+			ais->type25.app_id,
+			ais->type25.bitcount,
+			gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
 				    (char *)ais->type25.bitdata,
 				    (ais->type25.bitcount + 7) / 8));
 	break;
     case 26:			/* Binary Message, Multiple Slot */
-	(void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-		       "\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
-		       "\"app_id\":%u,\"data\":\"%zd:%s\",\"radio\":%u}\r\n",
-		       JSON_BOOL(ais->type26.addressed),
-		       JSON_BOOL(ais->type26.structured),
-		       ais->type26.dest_mmsi,
-		       ais->type26.app_id,
-		       ais->type26.bitcount,
-		       gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
+	json_out_printf(out,
+			"\"addressed\":%s,\"structured\":%s,\"dest_mmsi\":%u,"
+			"\"app_id\":%u,\"data\":\"%zd:%s\",\"radio\":%u}\r\n",
+			JSON_BOOL(ais->type26.addressed),
+			JSON_BOOL(ais->type26.structured),
+			ais->type26.dest_mmsi,
+			ais->type26.app_id,
+			ais->type26.bitcount,
+			gpsd_hexdump(scratchbuf, sizeof(scratchbuf),
 				    (char *)ais->type26.bitdata,
 				    (ais->type26.bitcount + 7) / 8),
-		       ais->type26.radio);
+			ais->type26.radio);
 	break;
     case 27:			/* Long Range AIS Broadcast message */
 	if (scaled)
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"status\":\"%s\","
-			   "\"accuracy\":%s,\"lon\":%.1f,\"lat\":%.1f,"
-			   "\"speed\":%u,\"course\":%u,\"raim\":%s,\"gnss\":%s}\r\n",
-			   nav_legends[ais->type27.status],
-			   JSON_BOOL(ais->type27.accuracy),
-			   ais->type27.lon / AIS_LONGRANGE_LATLON_DIV,
-			   ais->type27.lat / AIS_LONGRANGE_LATLON_DIV,
-			   ais->type27.speed,
-			   ais->type27.course,
-			   JSON_BOOL(ais->type27.raim),
-			   JSON_BOOL(ais->type27.gnss));
+	    json_out_member_str(out, "status", nav_legends[ais->type27.status]);
 	else
-	    (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-			   "\"status\":%u,"
-			   "\"accuracy\":%s,\"lon\":%d,\"lat\":%d,"
-			   "\"speed\":%u,\"course\":%u,\"raim\":%s,\"gnss\":%s}\r\n",
-			   ais->type27.status,
-			   JSON_BOOL(ais->type27.accuracy),
-			   ais->type27.lon,
-			   ais->type27.lat,
-			   ais->type27.speed,
-			   ais->type27.course,
-			   JSON_BOOL(ais->type27.raim),
-			   JSON_BOOL(ais->type27.gnss));
+	    json_out_member_uint(out, "status", ais->type27.status);
+	json_out_member_bool(out, "accuracy", ais->type27.accuracy);
+	if (scaled) {
+	    json_out_member_fixed(out, "lon",
+				  ais->type27.lon / AIS_LONGRANGE_LATLON_DIV, 1);
+	    json_out_member_fixed(out, "lat",
+				  ais->type27.lat / AIS_LONGRANGE_LATLON_DIV, 1);
+	} else {
+	    json_out_member_int(out, "lon", ais->type27.lon);
+	    json_out_member_int(out, "lat", ais->type27.lat);
+	}
+	json_out_member_uint(out, "speed", ais->type27.speed);
+	json_out_member_uint(out, "course", ais->type27.course);
+	json_out_member_bool(out, "raim", ais->type27.raim);
+	json_out_key(out, "gnss");
+	json_out_raw(out, JSON_BOOL(ais->type27.gnss));
+	json_out_raw(out, "}\r\n");
 	break;
     default:
-	if (buf[strlen(buf) - 1] == ',')
-	    buf[strlen(buf) - 1] = '\0';
-	(void)strlcat(buf, "}\r\n", buflen);
+	json_out_trim(out);
+	json_out_raw(out, "}\r\n");
 	break;
     }
     /*@ +formatcode +mustfreefresh @*/
 }
+
+void json_aivdm_dump(const struct ais_t *ais,
+		     /*@null@*/const char *device, bool scaled,
+		     /*@out@*/char *buf, size_t buflen)
+{
+    struct json_out_t out;
+
+    json_out_init(&out, buf, buflen);
+    json_aivdm_emit(ais, device, scaled, &out);
+}
+
+void json_aistarget_dump(const struct ais_target_t *tp,
+			 /*@out@*/char *buf, size_t buflen)
+/* one entry of the AIS target table, leaving out what isn't known */
+{
+    struct json_out_t out;
+    char tbuf[JSON_DATE_MAX+1];
+
+    json_out_init(&out, buf, buflen);
+    json_out_raw(&out, "{\"class\":\"TARGET\",");
+    json_out_member_uint(&out, "mmsi", tp->mmsi);
+    json_out_member_str(&out, "time",
+			unix_to_iso8601(tp->seen, tbuf, sizeof(tbuf)));
+    if (tp->own)
+	json_out_member_bool(&out, "own", true);
+    if (tp->type != 0)
+	json_out_member_uint(&out, "type", tp->type);
+    if (isnan(tp->lat) == 0) {
+	json_out_member_fixed(&out, "lat", tp->lat, 7);
+	json_out_member_fixed(&out, "lon", tp->lon, 7);
+    }
+    if (isnan(tp->speed) == 0)
+	json_out_member_fixed(&out, "speed", tp->speed, 1);
+    if (isnan(tp->course) == 0)
+	json_out_member_fixed(&out, "course", tp->course, 1);
+    if (tp->heading >= 0)
+	json_out_member_int(&out, "heading", tp->heading);
+    if (tp->status >= 0)
+	json_out_member_int(&out, "status", tp->status);
+    if (tp->turn != AIS_TURN_NOT_AVAILABLE)
+	json_out_member_int(&out, "turn", tp->turn);
+    if (tp->shipname[0] != '\0')
+	json_out_member_string(&out, "shipname", tp->shipname);
+    if (tp->callsign[0] != '\0')
+	json_out_member_string(&out, "callsign", tp->callsign);
+    if (tp->imo != 0)
+	json_out_member_uint(&out, "imo", tp->imo);
+    if (tp->shiptype != 0)
+	json_out_member_uint(&out, "shiptype", tp->shiptype);
+    if (tp->destination[0] != '\0')
+	json_out_member_string(&out, "destination", tp->destination);
+    if (tp->to_bow + tp->to_stern + tp->to_port + tp->to_starboard != 0) {
+	json_out_member_uint(&out, "to_bow", tp->to_bow);
+	json_out_member_uint(&out, "to_stern", tp->to_stern);
+	json_out_member_uint(&out, "to_port", tp->to_port);
+	json_out_member_uint(&out, "to_starboard", tp->to_starboard);
+    }
+    if (tp->draught != 0)
+	json_out_member_scaled(&out, "draught", (long long)tp->draught, 1);
+    json_out_trim(&out);
+    json_out_raw(&out, "}\r\n");
+}
+
+int json_aistargets_read(const char *buf,
+			 /*@out@*/struct ais_target_query_t *q,
+			 /*@null@*/const char **endptr)
+/* parse the area and age restrictions of an ?AISTARGETS request */
+{
+    /*@ -fullinitblock @*/
+    /* *INDENT-OFF* */
+    const struct json_attr_t json_attrs_query[] = {
+	{"class",  t_check, .dflt.check = "AISTARGETS"},
+	{"minlat", t_real,  .addr.real = &q->minlat, .dflt.real = NAN},
+	{"minlon", t_real,  .addr.real = &q->minlon, .dflt.real = NAN},
+	{"maxlat", t_real,  .addr.real = &q->maxlat, .dflt.real = NAN},
+	{"maxlon", t_real,  .addr.real = &q->maxlon, .dflt.real = NAN},
+	{"lat",    t_real,  .addr.real = &q->lat,    .dflt.real = NAN},
+	{"lon",    t_real,  .addr.real = &q->lon,    .dflt.real = NAN},
+	{"radius", t_real,  .addr.real = &q->radius, .dflt.real = NAN},
+	{"since",  t_time,  .addr.real = &q->since,  .dflt.real = 0},
+	{"since",  t_real,  .addr.real = &q->since,  .dflt.real = 0},
+	{NULL},
+    };
+    /* *INDENT-ON* */
+    /*@ +fullinitblock @*/
+
+    return json_read_object(buf, json_attrs_query, endptr);
+}
+
+void json_cpa_dump(const struct ais_cpa_event_t *ev,
+		   /*@null@*/const struct ais_target_t *tp,
+		   /*@out@*/char *buf, size_t buflen)
+/* a collision alarm raised or cleared */
+{
+    struct json_out_t out;
+    char tbuf[JSON_DATE_MAX+1];
+
+    json_out_init(&out, buf, buflen);
+    json_out_raw(&out, "{\"class\":\"CPA\",");
+    json_out_member_uint(&out, "mmsi", ev->mmsi);
+    json_out_member_str(&out, "time",
+			unix_to_iso8601(ev->time, tbuf, sizeof(tbuf)));
+    json_out_member_str(&out, "state", ev->alarm ? "alarm" : "clear");
+    if (tp != NULL && tp->mmsi == ev->mmsi && tp->shipname[0] != '\0')
+	json_out_member_string(&out, "shipname", tp->shipname);
+    if (isnan(ev->cpa) == 0) {
+	json_out_member_fixed(&out, "cpa", ev->cpa, 0);
+	json_out_member_fixed(&out, "tcpa", ev->tcpa, 0);
+    }
+    if (isnan(ev->range) == 0) {
+	json_out_member_fixed(&out, "range", ev->range, 0);
+	json_out_member_fixed(&out, "bearing", ev->bearing, 1);
+    }
+    json_out_trim(&out);
+    json_out_raw(&out, "}\r\n");
+}
+
+int json_cpa_read(const char *buf, double *cpa_limit, double *tcpa_limit,
+		  /*@null@*/const char **endptr)
+/* parse the alarm limits of a ?CPA request; absent ones are left alone */
+{
+    /*@ -fullinitblock @*/
+    /* *INDENT-OFF* */
+    const struct json_attr_t json_attrs_cpa[] = {
+	{"class", t_check, .dflt.check = "CPA"},
+	{"cpa",   t_real,  .addr.real = cpa_limit,  .nodefault = true},
+	{"tcpa",  t_real,  .addr.real = tcpa_limit, .nodefault = true},
+	{NULL},
+    };
+    /* *INDENT-ON* */
+    /*@ +fullinitblock @*/
+
+    return json_read_object(buf, json_attrs_cpa, endptr);
+}
 #endif /* defined(AIVDM_ENABLE) */
 
+int json_n2kdevices_read(const char *buf, int *src,
+			 /*@null@*/const char **endptr)
+/* parse the source of a ?N2KDEVICES request; -1 if it names none */
+{
+    /*@ -fullinitblock @*/
+    /* *INDENT-OFF* */
+    const struct json_attr_t json_attrs_n2kdevices[] = {
+	{"class", t_check,   .dflt.check = "N2KDEVICES"},
+	{"src",   t_integer, .addr.integer = src, .dflt.integer = -1},
+	{NULL},
+    };
+    /* *INDENT-ON* */
+    /*@ +fullinitblock @*/
+
+    return json_read_object(buf, json_attrs_n2kdevices, endptr);
+}
+
 #ifdef COMPASS_ENABLE
-void json_att_dump(const struct gps_data_t *gpsdata,
-		   /*@out@*/ char *reply, size_t replylen)
+static void json_att_emit(const struct gps_data_t *gpsdata,
+			  struct json_out_t *out)
 /* dump the contents of an attitude_t structure as JSON */
 {
-    assert(replylen > 2);
-    (void)strlcpy(reply, "{\"class\":\"ATT\",", replylen);
-    (void)snprintf(reply + strlen(reply),
-		   replylen - strlen(reply),
-		   "\"tag\":\"%s\",",
-		   gpsdata->tag[0] != '\0' ? gpsdata->tag : "-");
-    (void)snprintf(reply + strlen(reply),
-		   replylen - strlen(reply),
-		   "\"device\":\"%s\",", gpsdata->dev.path);
+    json_out_raw(out, "{\"class\":\"ATT\",");
+    json_out_member_str(out, "tag",
+			gpsdata->tag[0] != '\0' ? gpsdata->tag : "-");
+    json_out_member_str(out, "device", gpsdata->dev.path);
+#define ATT_STATUS(tag, st) do {			\
+	if (st != '\0') {				\
+	    json_out_raw(out, "\"" tag "\":\"");	\
+	    json_out_char(out, st);			\
+	    json_out_raw(out, "\",");			\
+	}						\
+    } while (0)
     if (isnan(gpsdata->attitude.heading) == 0) {
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"heading\":%.2f,", gpsdata->attitude.heading);
-	if (gpsdata->attitude.mag_st != '\0')
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"mag_st\":\"%c\",", gpsdata->attitude.mag_st);
-
+	json_out_member_fixed(out, "heading", gpsdata->attitude.heading, 2);
+	ATT_STATUS("mag_st", gpsdata->attitude.mag_st);
     }
     if (isnan(gpsdata->attitude.pitch) == 0) {
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"pitch\":%.2f,", gpsdata->attitude.pitch);
-	if (gpsdata->attitude.pitch_st != '\0')
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"pitch_st\":\"%c\",",
-			   gpsdata->attitude.pitch_st);
-
+	json_out_member_fixed(out, "pitch", gpsdata->attitude.pitch, 2);
+	ATT_STATUS("pitch_st", gpsdata->attitude.pitch_st);
     }
     if (isnan(gpsdata->attitude.yaw) == 0) {
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"yaw\":%.2f,", gpsdata->attitude.yaw);
-	if (gpsdata->attitude.yaw_st != '\0')
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"yaw_st\":\"%c\",", gpsdata->attitude.yaw_st);
-
+	json_out_member_fixed(out, "yaw", gpsdata->attitude.yaw, 2);
+	ATT_STATUS("yaw_st", gpsdata->attitude.yaw_st);
     }
     if (isnan(gpsdata->attitude.roll) == 0) {
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"roll\":%.2f,", gpsdata->attitude.roll);
-	if (gpsdata->attitude.roll_st != '\0')
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"roll_st\":\"%c\",", gpsdata->attitude.roll_st);
-
+	json_out_member_fixed(out, "roll", gpsdata->attitude.roll, 2);
+	ATT_STATUS("roll_st", gpsdata->attitude.roll_st);
     }
     if (isnan(gpsdata->attitude.yaw) == 0) {
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"yaw\":%.2f,", gpsdata->attitude.yaw);
-	if (gpsdata->attitude.yaw_st != '\0')
-	    (void)snprintf(reply + strlen(reply),
-			   replylen - strlen(reply),
-			   "\"yaw_st\":\"%c\",", gpsdata->attitude.yaw_st);
-
+	json_out_member_fixed(out, "yaw", gpsdata->attitude.yaw, 2);
+	ATT_STATUS("yaw_st", gpsdata->attitude.yaw_st);
     }
-    if (isnan(gpsdata->attitude.dip) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"dip\":%.3f,", gpsdata->attitude.dip);
-
-    if (isnan(gpsdata->attitude.mag_len) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"mag_len\":%.3f,", gpsdata->attitude.mag_len);
-    if (isnan(gpsdata->attitude.mag_x) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"mag_x\":%.3f,", gpsdata->attitude.mag_x);
-    if (isnan(gpsdata->attitude.mag_y) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"mag_y\":%.3f,", gpsdata->attitude.mag_y);
-    if (isnan(gpsdata->attitude.mag_z) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"mag_z\":%.3f,", gpsdata->attitude.mag_z);
-
-    if (isnan(gpsdata->attitude.acc_len) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"acc_len\":%.3f,", gpsdata->attitude.acc_len);
-    if (isnan(gpsdata->attitude.acc_x) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"acc_x\":%.3f,", gpsdata->attitude.acc_x);
-    if (isnan(gpsdata->attitude.acc_y) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"acc_y\":%.3f,", gpsdata->attitude.acc_y);
-    if (isnan(gpsdata->attitude.acc_z) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"acc_z\":%.3f,", gpsdata->attitude.acc_z);
-
-    if (isnan(gpsdata->attitude.gyro_x) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"gyro_x\":%.3f,", gpsdata->attitude.gyro_x);
-    if (isnan(gpsdata->attitude.gyro_y) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"gyro_y\":%.3f,", gpsdata->attitude.gyro_y);
+#undef ATT_STATUS
+#define ATT_FIELD(tag, field) do {					\
+	if (isnan(gpsdata->attitude.field) == 0)			\
+	    json_out_member_fixed(out, tag, gpsdata->attitude.field, 3); \
+    } while (0)
+    ATT_FIELD("dip", dip);
+
+    ATT_FIELD("mag_len", mag_len);
+    ATT_FIELD("mag_x", mag_x);
+    ATT_FIELD("mag_y", mag_y);
+    ATT_FIELD("mag_z", mag_z);
+
+    ATT_FIELD("acc_len", acc_len);
+    ATT_FIELD("acc_x", acc_x);
+    ATT_FIELD("acc_y", acc_y);
+    ATT_FIELD("acc_z", acc_z);
+
+    ATT_FIELD("gyro_x", gyro_x);
+    ATT_FIELD("gyro_y", gyro_y);
+
+    ATT_FIELD("temp", temp);
+    ATT_FIELD("depth", depth);
+#undef ATT_FIELD
+
+    json_out_trim(out);
+    json_out_raw(out, "}\r\n");
+}
 
-    if (isnan(gpsdata->attitude.temp) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"temp\":%.3f,", gpsdata->attitude.temp);
-    if (isnan(gpsdata->attitude.depth) == 0)
-	(void)snprintf(reply + strlen(reply),
-		       replylen - strlen(reply),
-		       "\"depth\":%.3f,", gpsdata->attitude.depth);
+void json_att_dump(const struct gps_data_t *gpsdata,
+		   /*@out@*/ char *reply, size_t replylen)
+{
+    struct json_out_t out;
 
-    if (reply[strlen(reply) - 1] == ',')
-	reply[strlen(reply) - 1] = '\0';	/* trim trailing comma */
-    (void)strlcat(reply, "}\r\n", replylen);
+    assert(replylen > 2);
+    json_out_init(&out, reply, replylen);
+    json_att_emit(gpsdata, &out);
 }
 #endif /* COMPASS_ENABLE */
 
+static void json_out_legacy(struct json_out_t *out,
+			    void (*dump)(const struct gps_data_t *,
+					 char *, size_t),
+			    const struct gps_data_t *datap)
+/* run a dumper that still writes a buffer of its own at the cursor */
+{
+    if (out->overflow)
+	return;
+    dump(datap, out->buf + out->len, out->cap - out->len);
+    out->len += strlen(out->buf + out->len);
+}
+
 void json_data_report(const gps_mask_t changed,
 		 const struct gps_device_t *session,
 		 const struct policy_t *policy,
@@ -3627,49 +3523,51 @@ void json_data_report(const gps_mask_t changed,
 /* report a session state in JSON */
 {
     const struct gps_data_t *datap = &session->gpsdata;
-    buf[0] = '\0';
+    struct json_out_t out;
+
+    json_out_init(&out, buf, buflen);
 
     if ((changed & REPORT_IS) != 0) {
-	json_tpv_dump(session, policy, buf+strlen(buf), buflen-strlen(buf));
+	json_tpv_emit(session, policy, &out);
     }
 
     if ((changed & GST_SET) != 0) {
-	json_noise_dump(datap, buf+strlen(buf), buflen-strlen(buf));
+	json_out_legacy(&out, json_noise_dump, datap);
     }
 
     if ((changed & SATELLITE_SET) != 0) {
-	json_sky_dump(datap, buf+strlen(buf), buflen-strlen(buf));
+	json_sky_emit(datap, &out);
     }
 
     if ((changed & SUBFRAME_SET) != 0) {
-	json_subframe_dump(datap, buf+strlen(buf), buflen-strlen(buf));
+	json_out_legacy(&out, json_subframe_dump, datap);
     }
 
 #ifdef COMPASS_ENABLE
     if ((changed & ATTITUDE_SET) != 0) {
-	json_att_dump(datap, buf+strlen(buf), buflen-strlen(buf));
+	json_att_emit(datap, &out);
     }
 #endif /* COMPASS_ENABLE */
 
 #ifdef RTCM104V2_ENABLE
-    if ((changed & RTCM2_SET) != 0) {
+    if ((changed & RTCM2_SET) != 0 && !out.overflow) {
 	json_rtcm2_dump(&datap->rtcm2, datap->dev.path,
-			buf+strlen(buf), buflen-strlen(buf));
+			buf + out.len, buflen - out.len);
+	out.len += strlen(buf + out.len);
     }
 #endif /* RTCM104V2_ENABLE */
 
 #ifdef RTCM104V3_ENABLE
-    if ((changed & RTCM3_SET) != 0) {
+    if ((changed & RTCM3_SET) != 0 && !out.overflow) {
 	json_rtcm3_dump(&datap->rtcm3, datap->dev.path,
-			buf+strlen(buf), buflen-strlen(buf));
+			buf + out.len, buflen - out.len);
+	out.len += strlen(buf + out.len);
     }
 #endif /* RTCM104V3_ENABLE */
 
 #ifdef AIVDM_ENABLE
     if ((changed & AIS_SET) != 0) {
-	json_aivdm_dump(&datap->ais, datap->dev.path,
-			policy->scaled,
-			buf+strlen(buf), buflen-strlen(buf));
+	json_aivdm_emit(&datap->ais, datap->dev.path, policy->scaled, &out);
     }
 #endif /* AIVDM_ENABLE */
 }
@@ -35,7 +35,7 @@ ssize_t gpsd_write(struct gps_device_t *session,
     return gpsd_serial_write(session, buf, len);
 }
 
-void gpsd_throttled_report(const int errlevel, const char * buf) {}
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED, const char * buf UNUSED) {}
 
 void gpsd_report(const int debuglevel, const int errlevel,
 		 const char *fmt, ...)
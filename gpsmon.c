@@ -588,7 +588,7 @@ static void packet_log(const char *fmt, ...)
 }
 #endif /* PPS_ENABLE */
 
-void gpsd_throttled_report(const int errlevel, const char * buf) {}
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED, const char * buf UNUSED) {}
 void gpsd_report(const int debuglevel, const int errlevel, const char *fmt, ...)
 /* our version of the logger */
 {
@@ -1288,7 +1288,7 @@ int main(int argc, char **argv)
 #ifdef EFDS
 	    fd_set efds;
 #endif /* EFDS */
-	    switch(gpsd_await_data(&rfds, maxfd, &all_fds, context.debug))
+	    switch(gpsd_await_data(&rfds, maxfd, &all_fds, context.debug, 1.0))
 	    {
 	    case AWAIT_GOT_INPUT:
 		break;
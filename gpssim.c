@@ -180,7 +180,7 @@ ssize_t gpsd_write(struct gps_device_t *session,
     return gpsd_serial_write(session, buf, len);
 }
 
-void gpsd_throttled_report(const int errlevel UNUSED, const char * buf UNUSED) {}
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED, const char * buf UNUSED) {}
 void gpsd_report(const int debuglevel, const int errlevel,
                  const char *fmt, ...)
 {
@@ -1286,19 +1286,19 @@ int main(int argc, char**argv) {
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // rate of turn
-            n2k_binary_127251_dump(&session, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
+            n2k_binary_schema_dump(&session, 127251, 0, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // depth
-            n2k_binary_128267_dump(&session, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
+            n2k_binary_schema_dump(&session, 128267, 0, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
-            n2k_binary_hdg_magnetic_dump(&session, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset,
+            n2k_binary_schema_dump(&session, 127250, compass_magnetic, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset,
                                          &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // only roll atm
-            n2k_binary_attitude_dump(&session, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
+            n2k_binary_schema_dump(&session, 127257, 0, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // AIS Class A (type1) position report
@@ -1306,7 +1306,7 @@ int main(int argc, char**argv) {
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // wind data
-            n2k_binary_130306_dump(&session, wind_apparent,
+            n2k_binary_schema_dump(&session, 130306, wind_apparent,
                 &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
@@ -1327,11 +1327,11 @@ int main(int argc, char**argv) {
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // trip log
-            n2k_binary_128275_dump(&session, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
+            n2k_binary_schema_dump(&session, 128275, 0, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
 
             // engine rapid update
-            n2k_binary_127488_dump(&session, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
+            n2k_binary_schema_dump(&session, 127488, 0, &pgn, bufb+n2k_payload_offset, len-n2k_payload_offset, &written);
             send_frame(&session, bufb, frmType, written, pgn, 0x03, 0x22, 0xfe);
         }
 
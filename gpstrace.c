@@ -0,0 +1,288 @@
+/*
+ * gpstrace
+ *
+ * Dump the binary event trace a gpsd started with -T keeps in shared
+ * memory.  By default prints per-stage latency histograms:
+ *      gpstrace
+ *
+ * This writes the ring as Chrome trace JSON, for chrome://tracing
+ * or Perfetto:
+ *      gpstrace -j > trace.json
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "trace.h"
+#include "revision.h"
+
+#define HIST_BUCKETS	40	/* log2 nanoseconds, up to ~9 minutes */
+#define MAXDEV		65536
+
+enum { STAGE_READ_FRAME, STAGE_FRAME_PGN, STAGE_FRAME_REPORT,
+       STAGE_REPORT_WRITE, STAGE_READ_WRITE, STAGES };
+
+static const char *stage_names[STAGES] = {
+    "read -> frame",
+    "frame -> pgn",
+    "frame -> report",
+    "report -> write",
+    "read -> write",
+};
+
+static const char *event_names[TRACE_EVENTS] = {
+    "?", "read", "frame", "pgn", "report", "write",
+};
+
+struct histogram_t {
+    unsigned long count;
+    uint64_t min, max, sum;
+    unsigned long bucket[HIST_BUCKETS];
+};
+
+static struct histogram_t hist[STAGES];
+static uint64_t last_read[MAXDEV], last_frame[MAXDEV];
+
+static void hist_add(struct histogram_t *h, uint64_t then, uint64_t now)
+{
+    uint64_t d;
+    int b = 0;
+
+    if (then == 0 || now < then)
+	return;
+    d = now - then;
+    while (b < HIST_BUCKETS - 1 && d >= (2ULL << b))
+	b++;
+    if (h->count == 0 || d < h->min)
+	h->min = d;
+    if (d > h->max)
+	h->max = d;
+    h->sum += d;
+    h->count++;
+    h->bucket[b]++;
+}
+
+static const char *fmt_ns(char *buf, size_t len, uint64_t ns)
+{
+    if (ns < 1000ULL)
+	(void)snprintf(buf, len, "%lluns", (unsigned long long)ns);
+    else if (ns < 1000000ULL)
+	(void)snprintf(buf, len, "%.1fus", ns / 1e3);
+    else if (ns < 1000000000ULL)
+	(void)snprintf(buf, len, "%.1fms", ns / 1e6);
+    else
+	(void)snprintf(buf, len, "%.1fs", ns / 1e9);
+    return buf;
+}
+
+static void histogram(const struct trace_record_t *rec, size_t n)
+{
+    uint64_t report_ts = 0, report_read = 0;
+    size_t i;
+    int s, b;
+    char b1[16], b2[16], b3[16];
+
+    for (i = 0; i < n; i++) {
+	const struct trace_record_t *r = &rec[i];
+	switch (r->event) {
+	case TRACE_READ:
+	    last_read[r->device] = r->ts;
+	    break;
+	case TRACE_FRAME:
+	    hist_add(&hist[STAGE_READ_FRAME], last_read[r->device], r->ts);
+	    last_frame[r->device] = r->ts;
+	    break;
+	case TRACE_PGN:
+	    hist_add(&hist[STAGE_FRAME_PGN], last_frame[r->device], r->ts);
+	    break;
+	case TRACE_REPORT:
+	    hist_add(&hist[STAGE_FRAME_REPORT], last_frame[r->device], r->ts);
+	    report_ts = r->ts;
+	    report_read = last_read[r->device];
+	    break;
+	case TRACE_WRITE:
+	    hist_add(&hist[STAGE_REPORT_WRITE], report_ts, r->ts);
+	    hist_add(&hist[STAGE_READ_WRITE], report_read, r->ts);
+	    break;
+	}
+    }
+
+    for (s = 0; s < STAGES; s++) {
+	struct histogram_t *h = &hist[s];
+	unsigned long peak = 0;
+
+	if (h->count == 0)
+	    continue;
+	(void)printf("%s: %lu samples, min %s, mean %s, max %s\n",
+		     stage_names[s], h->count,
+		     fmt_ns(b1, sizeof(b1), h->min),
+		     fmt_ns(b2, sizeof(b2), h->sum / h->count),
+		     fmt_ns(b3, sizeof(b3), h->max));
+	for (b = 0; b < HIST_BUCKETS; b++)
+	    if (h->bucket[b] > peak)
+		peak = h->bucket[b];
+	for (b = 0; b < HIST_BUCKETS; b++) {
+	    int bar;
+	    if (h->bucket[b] == 0)
+		continue;
+	    bar = (int)((h->bucket[b] * 50 + peak - 1) / peak);
+	    (void)printf("  < %8s %8lu %.*s\n",
+			 fmt_ns(b1, sizeof(b1), 2ULL << b), h->bucket[b],
+			 bar, "##################################################");
+	}
+    }
+}
+
+static void chrome_json(const struct trace_record_t *rec, size_t n, int pid)
+{
+    size_t i;
+
+    (void)printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (i = 0; i < n; i++) {
+	const struct trace_record_t *r = &rec[i];
+	const char *name =
+	    r->event < TRACE_EVENTS ? event_names[r->event] : event_names[0];
+
+	(void)printf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+		     "\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%u,\"args\":",
+		     name, (unsigned long long)(r->ts / 1000),
+		     (unsigned)(r->ts % 1000), pid, (unsigned)r->device);
+	switch (r->event) {
+	case TRACE_READ:
+	    (void)printf("{\"bytes\":%d}", (int32_t)r->arg[0]);
+	    break;
+	case TRACE_FRAME:
+	    (void)printf("{\"type\":%u,\"len\":%u}", r->arg[0], r->arg[1]);
+	    break;
+	case TRACE_PGN:
+	    (void)printf("{\"pgn\":%u,\"src\":%u}", r->arg[0], r->arg[1]);
+	    break;
+	case TRACE_REPORT:
+	    (void)printf("{\"mask\":\"0x%08x%08x\"}", r->arg[1], r->arg[0]);
+	    break;
+	case TRACE_WRITE:
+	    (void)printf("{\"client\":%u,\"bytes\":%d}",
+			 r->arg[0], (int32_t)r->arg[1]);
+	    break;
+	default:
+	    (void)printf("{\"arg\":[%u,%u,%u,%u]}",
+			 r->arg[0], r->arg[1], r->arg[2], r->arg[3]);
+	    break;
+	}
+	(void)printf("}%s\n", i + 1 < n ? "," : "");
+    }
+    (void)printf("]}\n");
+}
+
+static void usage(void)
+{
+    (void)fprintf(stderr,
+		  "Usage: gpstrace [-j] [-h] [-V]\n"
+		  "  -j  dump the trace ring as Chrome trace JSON\n"
+		  "  -h  show this help\n"
+		  "  -V  print version and exit\n"
+		  "Without -j, per-stage latency histograms are printed.\n");
+}
+
+int main(int argc, char **argv)
+{
+    const volatile struct trace_ring_t *ring;
+    struct trace_record_t *rec;
+    uint64_t head, tail, first, slot;
+    size_t n = 0;
+    bool json = false;
+    int shmid, option;
+
+    while ((option = getopt(argc, argv, "jhV")) != -1) {
+	switch (option) {
+	case 'j':
+	    json = true;
+	    break;
+	case 'V':
+	    (void)printf("gpstrace: %s (revision %s)\n", VERSION, REVISION);
+	    exit(EXIT_SUCCESS);
+	case 'h':
+	default:
+	    usage();
+	    exit(option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+    }
+
+    shmid = shmget((key_t)TRACE_KEY, 0, 0);
+    if (shmid == -1) {
+	(void)fprintf(stderr, "gpstrace: no trace segment (is gpsd running with -T?): %s\n",
+		      strerror(errno));
+	exit(EXIT_FAILURE);
+    }
+    ring = (const volatile struct trace_ring_t *)shmat(shmid, 0, SHM_RDONLY);
+    if ((int)(long)ring == -1) {
+	(void)fprintf(stderr, "gpstrace: shmat failed: %s\n", strerror(errno));
+	exit(EXIT_FAILURE);
+    }
+    if (ring->magic != TRACE_MAGIC || ring->version != TRACE_VERSION
+	|| ring->records != TRACE_RECORDS
+	|| ring->recsize != sizeof(struct trace_record_t)) {
+	(void)fprintf(stderr, "gpstrace: trace segment has an unknown layout\n");
+	exit(EXIT_FAILURE);
+    }
+
+    rec = malloc(sizeof(struct trace_record_t) * TRACE_RECORDS);
+    if (rec == NULL) {
+	(void)fprintf(stderr, "gpstrace: out of memory\n");
+	exit(EXIT_FAILURE);
+    }
+
+    /*
+     * The daemon keeps writing while we copy.  Only slots that are
+     * older than the head we saw first can be complete, and a slot whose
+     * sequence number no longer matches was overwritten or is torn.
+     */
+    tail = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    first = tail > TRACE_RECORDS ? tail - TRACE_RECORDS : 0;
+    for (slot = first; slot < tail; slot++) {
+	const volatile struct trace_record_t *r =
+	    &ring->rec[slot & (TRACE_RECORDS - 1)];
+	if (__atomic_load_n(&r->seq, __ATOMIC_ACQUIRE) != (uint32_t)slot)
+	    continue;
+	rec[n].ts = r->ts;
+	rec[n].event = r->event;
+	rec[n].device = r->device;
+	rec[n].arg[0] = r->arg[0];
+	rec[n].arg[1] = r->arg[1];
+	rec[n].arg[2] = r->arg[2];
+	rec[n].arg[3] = r->arg[3];
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (r->seq != (uint32_t)slot)
+	    continue;
+	rec[n].seq = (uint32_t)slot;
+	n++;
+    }
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (head != tail)
+	(void)fprintf(stderr, "gpstrace: %llu events arrived while copying\n",
+		      (unsigned long long)(head - tail));
+
+    if (json)
+	chrome_json(rec, n, (int)ring->pid);
+    else {
+	(void)printf("%zu events from gpsd pid %d\n", n, (int)ring->pid);
+	histogram(rec, n);
+    }
+
+    free(rec);
+    (void)shmdt((const void *)ring);
+    exit(EXIT_SUCCESS);
+}
@@ -326,14 +326,54 @@ time_t mkgmtime(register struct tm * t)
     return (result);
 }
 
+#ifndef USE_QT
+static int iso8601_field(const char *cp, int width)
+/* a fixed-width decimal field */
+{
+    int v = 0;
+
+    while (width-- > 0)
+	v = v * 10 + (*cp++ - '0');
+    return v;
+}
+#endif /* USE_QT */
+
 timestamp_t iso8601_to_unix( /*@in@*/ char *isotime)
 /* ISO8601 UTC to Unix UTC */
 {
 #ifndef USE_QT
+    static const char layout[] = "dddd-dd-ddTdd:dd:dd";
     char *dp = NULL;
     double usec;
     struct tm tm;
+    int i;
+
+    /*
+     * gpsd always writes YYYY-MM-DDTHH:MM:SS[.sss]Z; take that apart
+     * by hand, which is much cheaper than strptime() and independent
+     * of the locale, and leave anything else to strptime().
+     */
+    for (i = 0; layout[i] != '\0'; i++)
+	if (layout[i] == 'd' ? !isdigit((unsigned char)isotime[i])
+	    : isotime[i] != layout[i])
+	    break;
+    if (layout[i] == '\0' && !isdigit((unsigned char)isotime[i])) {
+	tm.tm_year = iso8601_field(isotime, 4) - 1900;
+	tm.tm_mon = iso8601_field(isotime + 5, 2) - 1;
+	tm.tm_mday = iso8601_field(isotime + 8, 2);
+	tm.tm_hour = iso8601_field(isotime + 11, 2);
+	tm.tm_min = iso8601_field(isotime + 14, 2);
+	tm.tm_sec = iso8601_field(isotime + 17, 2);
+	if (tm.tm_mon >= 0 && tm.tm_mon <= 11 && tm.tm_mday >= 1 && tm.tm_mday <= 31
+	    && tm.tm_hour <= 23 && tm.tm_min <= 59 && tm.tm_sec <= 60) {
+	    dp = isotime + i;
+	    usec = (*dp == '.') ? safe_atof(dp) : 0;
+	    return (timestamp_t)mkgmtime(&tm) + usec;
+	}
+    }
 
+    /* no garbage in the fields strptime() doesn't get to on bad input */
+    memset(&tm, '\0', sizeof(tm));
     /*@i1@*/ dp = strptime(isotime, "%Y-%m-%dT%H:%M:%S", &tm);
     if (dp != NULL && *dp == '.')
 	usec = strtod(dp, NULL);
@@ -26,7 +26,7 @@ void setleu32(uint8_t * b, int offset, uint32_t val) {
   b[offset + 3] = val >> 24;
 }
 
-void gpsd_throttled_report(const int errlevel UNUSED, const char * buf UNUSED) {}
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED, const char * buf UNUSED) {}
 void gpsd_report(const int debuglevel, const int errlevel, const char *fmt, ...)
 /* our version of the logger */
 {
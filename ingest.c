@@ -0,0 +1,559 @@
+/*
+ * ingest.c - per-device reader threads
+ *
+ * With reader threads enabled each active device gets a thread that
+ * waits on the device fd and runs gpsd_multipoll() on it, so a burst on
+ * one device (thousands of N2K frames off the SPI link) no longer holds
+ * up the others or client command handling.
+ *
+ * The thread owns the live session structure.  Whenever the decoder
+ * hands in a change set, the fields that reports read are copied into a
+ * slot of a single-producer/single-consumer ring.  The main thread
+ * drains the ring into a private copy of the session (the "view") and
+ * runs the report fan-out on that, so it never reads a structure that
+ * is being decoded into.  Everything else in the session keeps the
+ * values it had when the thread was started.
+ *
+ * Producer and consumer each own one index; the only shared state is
+ * head and tail, which are accessed with sequentially consistent
+ * atomics.  After publishing, the producer writes one byte into the
+ * wakeup pipe if the consumer had already caught up, so the main
+ * select() notices new data without polling.  When the ring is full
+ * the producer backs off and retries; nothing is dropped.
+ *
+ * Reader threads never touch the subscriber table.  A log line a
+ * driver emits on a reader goes into a second, smaller SPSC queue of
+ * the reader, and the main thread hands it to the log watchers when it
+ * drains the slots.  A log line that finds that queue full is dropped
+ * and counted rather than holding up decoding.
+ *
+ * ingest_lock() lets the main thread exclude the reader while it
+ * reconfigures the device or writes output to it, so frames the reader
+ * sends itself (N2K node traffic, VYSPI re-initialisation) don't
+ * interleave with the main thread's; the reader only holds that lock
+ * while it is decoding, never while it waits for input.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#ifndef S_SPLINT_S
+#include <sys/select.h>
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "driver_vyspi.h"
+
+#ifdef INGEST_THREADS_ENABLE
+
+#define INGEST_SLOTS	64		/* must be a power of two */
+#define INGEST_WAIT	250000		/* usec between idle polls */
+#define INGEST_BACKOFF	50000		/* nsec to wait on a full ring */
+#define INGEST_REAWAKE	0.01		/* as DEVICE_REAWAKE in gpsd.c */
+#define INGEST_MAX_TIMEOUTS	8	/* VYSPI re-init after this many */
+#define INGEST_LOG_LINES	32		/* must be a power of two */
+#define INGEST_LOG_LEN		512		/* longer lines are cut */
+
+/* navigation_t without its two averaging rings (128KB) */
+struct ingest_nav_t {
+    gps_mask_t set;
+    double speed_over_ground;
+    double eps;
+    double speed_thru_water;
+    double course_over_ground[2];
+    double epd;
+    double rate_of_turn;
+    double rudder_angle;
+    double depth;
+    double depth_offset;
+    double distance_total;
+    double distance_trip;
+    double heading[2];
+    double vmg;
+    double leeway;
+    double course_thru_water;
+    double current_set;
+    double current_drift;
+};
+
+struct ingest_slot_t {
+    gps_mask_t changed;
+    int status;				/* DEVICE_EOF/ERROR when thread ends */
+    const struct gps_type_t *device_type;
+    int observed;
+    bool cycle_end_reliable;
+    char subtype[64];
+    struct gps_packet_t packet;
+    /* the parts of gps_data_t that reports read */
+    gps_mask_t set;
+    timestamp_t online;
+    struct gps_fix_t fix;
+    double separation;
+    int status_fix;
+    int satellites_used;
+    int used[MAXCHANNELS];
+    struct dop_t dop;
+    double epe;
+    timestamp_t skyview_time;
+    int satellites_visible;
+    int PRN[MAXCHANNELS];
+    int elevation[MAXCHANNELS];
+    int azimuth[MAXCHANNELS];
+    double ss[MAXCHANNELS];
+    char tag[MAXTAGLEN+1];
+    enum node_state_t node_state;
+    int dev_flags;
+    char driver[64];
+    double cycle, mincycle;
+    int driver_mode;
+    struct ingest_nav_t navigation;
+    struct environment_t environment;
+    struct waypoint_navigation_t waypoint;
+    struct engine_t engine;
+    union {
+	struct rtcm2_t rtcm2;
+	struct rtcm3_t rtcm3;
+	struct subframe_t subframe;
+	struct ais_t ais;
+	struct attitude_t attitude;
+	struct gst_t gst;
+	struct version_t version;
+	struct timedrift_t timedrift;
+	char error[256];
+    } u;
+};
+
+struct ingest_log_t {
+    int subsys;
+    int errlevel;
+    char line[INGEST_LOG_LEN];
+};
+
+struct ingest_t {
+    struct gps_device_t *device;	/* live session, owned by the thread */
+    struct gps_device_t view;		/* what the main thread reports from */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    volatile bool stop;
+    int cpu;
+    int wakefd;
+    unsigned long stalls;		/* times the producer found the ring full */
+    uint32_t head;			/* written by the reader thread */
+    uint32_t tail;			/* written by the main thread */
+    struct ingest_slot_t slot[INGEST_SLOTS];
+    unsigned long log_drops;		/* log lines lost on a full queue */
+    uint32_t log_head;			/* written by the reader thread */
+    uint32_t log_tail;			/* written by the main thread */
+    struct ingest_log_t log[INGEST_LOG_LINES];
+};
+
+/* the reader the calling thread runs, NULL on the main thread */
+static __thread struct ingest_t *ingest_self = NULL;
+
+/* copy navigation scalars between navigation_t and ingest_nav_t */
+#define NAV_COPY(dst, src) do { \
+	(dst)->set = (src)->set; \
+	(dst)->speed_over_ground = (src)->speed_over_ground; \
+	(dst)->eps = (src)->eps; \
+	(dst)->speed_thru_water = (src)->speed_thru_water; \
+	memcpy((dst)->course_over_ground, (src)->course_over_ground, \
+	       sizeof((dst)->course_over_ground)); \
+	(dst)->epd = (src)->epd; \
+	(dst)->rate_of_turn = (src)->rate_of_turn; \
+	(dst)->rudder_angle = (src)->rudder_angle; \
+	(dst)->depth = (src)->depth; \
+	(dst)->depth_offset = (src)->depth_offset; \
+	(dst)->distance_total = (src)->distance_total; \
+	(dst)->distance_trip = (src)->distance_trip; \
+	memcpy((dst)->heading, (src)->heading, sizeof((dst)->heading)); \
+	(dst)->vmg = (src)->vmg; \
+	(dst)->leeway = (src)->leeway; \
+	(dst)->course_thru_water = (src)->course_thru_water; \
+	(dst)->current_set = (src)->current_set; \
+	(dst)->current_drift = (src)->current_drift; \
+    } while (0)
+
+static void ingest_snapshot(struct ingest_slot_t *s,
+			    const struct gps_device_t *d, gps_mask_t changed)
+/* reader side: capture what the reports for this change set will read */
+{
+    const struct gps_data_t *g = &d->gpsdata;
+
+    s->changed = changed;
+    s->status = 0;
+    s->device_type = d->device_type;
+    s->observed = d->observed;
+    s->cycle_end_reliable = d->cycle_end_reliable;
+    memcpy(s->subtype, d->subtype, sizeof(s->subtype));
+    memcpy(&s->packet, &d->packet, sizeof(s->packet));
+
+    s->set = g->set;
+    s->online = g->online;
+    s->fix = g->fix;
+    s->separation = g->separation;
+    s->status_fix = g->status;
+    s->satellites_used = g->satellites_used;
+    s->dop = g->dop;
+    s->epe = g->epe;
+    memcpy(s->tag, g->tag, sizeof(s->tag));
+    if ((changed & SATELLITE_SET) != 0) {
+	memcpy(s->used, g->used, sizeof(s->used));
+	s->skyview_time = g->skyview_time;
+	s->satellites_visible = g->satellites_visible;
+	memcpy(s->PRN, g->PRN, sizeof(s->PRN));
+	memcpy(s->elevation, g->elevation, sizeof(s->elevation));
+	memcpy(s->azimuth, g->azimuth, sizeof(s->azimuth));
+	memcpy(s->ss, g->ss, sizeof(s->ss));
+    }
+    s->node_state = g->dev.node_state;
+    s->dev_flags = g->dev.flags;
+    memcpy(s->driver, g->dev.driver, sizeof(s->driver));
+    s->cycle = g->dev.cycle;
+    s->mincycle = g->dev.mincycle;
+    s->driver_mode = g->dev.driver_mode;
+    NAV_COPY(&s->navigation, &g->navigation);
+    s->environment = g->environment;
+    s->waypoint = g->waypoint;
+    s->engine = g->engine;
+
+    if ((changed & AIS_SET) != 0)
+	s->u.ais = g->ais;
+    else if ((changed & ATTITUDE_SET) != 0)
+	s->u.attitude = g->attitude;
+    else if ((changed & RTCM2_SET) != 0)
+	s->u.rtcm2 = g->rtcm2;
+    else if ((changed & RTCM3_SET) != 0)
+	s->u.rtcm3 = g->rtcm3;
+    else if ((changed & SUBFRAME_SET) != 0)
+	s->u.subframe = g->subframe;
+    else if ((changed & GST_SET) != 0)
+	s->u.gst = g->gst;
+    else if ((changed & VERSION_SET) != 0)
+	s->u.version = g->version;
+    else if ((changed & TIMEDRIFT_SET) != 0)
+	s->u.timedrift = g->timedrift;
+    else if ((changed & ERROR_SET) != 0)
+	memcpy(s->u.error, g->error, sizeof(s->u.error));
+}
+
+static void ingest_apply(struct gps_device_t *d,
+			 const struct ingest_slot_t *s)
+/* main side: fold a change set into the view */
+{
+    struct gps_data_t *g = &d->gpsdata;
+
+    d->device_type = s->device_type;
+    d->observed = s->observed;
+    d->cycle_end_reliable = s->cycle_end_reliable;
+    memcpy(d->subtype, s->subtype, sizeof(d->subtype));
+    memcpy(&d->packet, &s->packet, sizeof(d->packet));
+
+    g->set = s->set;
+    g->online = s->online;
+    g->fix = s->fix;
+    g->separation = s->separation;
+    g->status = s->status_fix;
+    g->satellites_used = s->satellites_used;
+    g->dop = s->dop;
+    g->epe = s->epe;
+    memcpy(g->tag, s->tag, sizeof(g->tag));
+    if ((s->changed & SATELLITE_SET) != 0) {
+	memcpy(g->used, s->used, sizeof(g->used));
+	g->skyview_time = s->skyview_time;
+	g->satellites_visible = s->satellites_visible;
+	memcpy(g->PRN, s->PRN, sizeof(g->PRN));
+	memcpy(g->elevation, s->elevation, sizeof(g->elevation));
+	memcpy(g->azimuth, s->azimuth, sizeof(g->azimuth));
+	memcpy(g->ss, s->ss, sizeof(g->ss));
+    }
+    g->dev.node_state = s->node_state;
+    g->dev.flags = s->dev_flags;
+    memcpy(g->dev.driver, s->driver, sizeof(g->dev.driver));
+    g->dev.cycle = s->cycle;
+    g->dev.mincycle = s->mincycle;
+    g->dev.driver_mode = s->driver_mode;
+    NAV_COPY(&g->navigation, &s->navigation);
+    g->environment = s->environment;
+    g->waypoint = s->waypoint;
+    g->engine = s->engine;
+
+    if ((s->changed & AIS_SET) != 0)
+	g->ais = s->u.ais;
+    else if ((s->changed & ATTITUDE_SET) != 0)
+	g->attitude = s->u.attitude;
+    else if ((s->changed & RTCM2_SET) != 0)
+	g->rtcm2 = s->u.rtcm2;
+    else if ((s->changed & RTCM3_SET) != 0)
+	g->rtcm3 = s->u.rtcm3;
+    else if ((s->changed & SUBFRAME_SET) != 0)
+	g->subframe = s->u.subframe;
+    else if ((s->changed & GST_SET) != 0)
+	g->gst = s->u.gst;
+    else if ((s->changed & VERSION_SET) != 0)
+	g->version = s->u.version;
+    else if ((s->changed & TIMEDRIFT_SET) != 0)
+	g->timedrift = s->u.timedrift;
+    else if ((s->changed & ERROR_SET) != 0)
+	memcpy(g->error, s->u.error, sizeof(g->error));
+}
+
+static /*@null@*/struct ingest_slot_t *ingest_reserve(struct ingest_t *in)
+/* wait for a free slot; NULL if we are being stopped meanwhile */
+{
+    while (in->head - __atomic_load_n(&in->tail, __ATOMIC_SEQ_CST)
+	   >= INGEST_SLOTS) {
+	struct timespec delay = {0, INGEST_BACKOFF};
+	if (in->stop)
+	    return NULL;
+	in->stalls++;
+	(void)nanosleep(&delay, NULL);
+    }
+    return &in->slot[in->head & (INGEST_SLOTS - 1)];
+}
+
+static void ingest_commit(struct ingest_t *in)
+/* make the reserved slot visible and wake the main thread if idle */
+{
+    uint32_t head = in->head;
+
+    __atomic_store_n(&in->head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&in->tail, __ATOMIC_SEQ_CST) == head)
+	(void)write(in->wakefd, "", 1);
+}
+
+static void ingest_publish(struct gps_device_t *device, gps_mask_t changed)
+/* gpsd_multipoll() handler on the reader thread */
+{
+    struct ingest_t *in = device->ingest;
+    struct ingest_slot_t *s = ingest_reserve(in);
+
+    if (s == NULL)
+	return;
+    ingest_snapshot(s, device, changed);
+    ingest_commit(in);
+}
+
+bool ingest_log(int subsys, int errlevel, const char *buf)
+/* on a reader thread, queue a log line for the main thread; else false */
+{
+    struct ingest_t *in = ingest_self;
+    struct ingest_log_t *l;
+    uint32_t head;
+    size_t len;
+
+    if (in == NULL)
+	return false;
+    head = in->log_head;
+    if (head - __atomic_load_n(&in->log_tail, __ATOMIC_SEQ_CST)
+	>= INGEST_LOG_LINES) {
+	in->log_drops++;
+	return true;
+    }
+    l = &in->log[head & (INGEST_LOG_LINES - 1)];
+    l->subsys = subsys;
+    l->errlevel = errlevel;
+    len = strlcpy(l->line, buf, sizeof(l->line));
+    if (len >= sizeof(l->line))
+	l->line[sizeof(l->line) - 2] = '\n';	/* cut lines stay lines */
+    __atomic_store_n(&in->log_head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&in->log_tail, __ATOMIC_SEQ_CST) == head)
+	(void)write(in->wakefd, "", 1);
+    return true;
+}
+
+static void ingest_flush_log(struct ingest_t *in)
+/* main side: pass the queued log lines on to the log watchers */
+{
+    uint32_t tail = in->log_tail;
+
+    while (tail != __atomic_load_n(&in->log_head, __ATOMIC_SEQ_CST)) {
+	const struct ingest_log_t *l = &in->log[tail & (INGEST_LOG_LINES - 1)];
+
+	gpsd_throttled_report(l->subsys, l->errlevel, l->line);
+	__atomic_store_n(&in->log_tail, ++tail, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void ingest_finish(struct ingest_t *in, int status)
+/* tell the main thread this reader has given up on its device */
+{
+    struct ingest_slot_t *s = ingest_reserve(in);
+
+    if (s == NULL)
+	return;
+    s->changed = 0;
+    s->status = status;
+    ingest_commit(in);
+}
+
+static void *ingest_thread(void *arg)
+{
+    struct ingest_t *in = (struct ingest_t *)arg;
+    struct gps_device_t *device = in->device;
+    int timeouts = 0;
+
+    ingest_self = in;
+#ifdef __linux__
+    if (in->cpu >= 0) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(in->cpu, &set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+	    gpsd_report(device->context->debug, LOG_WARN,
+			"INGEST: %s can't be pinned to cpu %d\n",
+			device->gpsdata.dev.path, in->cpu);
+    }
+#endif /* __linux__ */
+
+    while (!in->stop) {
+	int fd = device->gpsdata.gps_fd;
+	fd_set rfds;
+	struct timeval tv;
+	int ready, status;
+
+	FD_ZERO(&rfds);
+	FD_SET(fd, &rfds);
+	tv.tv_sec = 0;
+	tv.tv_usec = device->sched.pending ? 0 : INGEST_WAIT;
+	ready = select(fd + 1, &rfds, NULL, NULL, &tv);
+	if (ready == -1 && errno != EINTR) {
+	    gpsd_report(device->context->debug, LOG_ERROR,
+			"INGEST: select on %s: %s\n",
+			device->gpsdata.dev.path, strerror(errno));
+	    ingest_finish(in, DEVICE_ERROR);
+	    break;
+	}
+	if (ready != 0 || !device->sched.pending)
+	    timeouts = (ready == 0) ? timeouts + 1 : 0;
+
+	(void)pthread_mutex_lock(&in->lock);
+	status = gpsd_multipoll(ready > 0, device, ingest_publish,
+				INGEST_REAWAKE);
+#ifdef VYSPI_ENABLE
+	if (device->device_type != NULL
+	    && device->device_type->packet_type == VYSPI_PACKET) {
+	    /* same watchdog the main loop applies when unthreaded */
+	    if (timeouts >= INGEST_MAX_TIMEOUTS) {
+		gpsd_report(device->context->debug, LOG_WARN,
+			    "INGEST: %s silent - re-activating device\n",
+			    device->gpsdata.dev.path);
+		timeouts = 0;
+		(void)vyspi_init(device);
+	    }
+	    vyspi_handle_time_trigger(device);
+	}
+#endif /* VYSPI_ENABLE */
+	(void)pthread_mutex_unlock(&in->lock);
+
+	if (status == DEVICE_EOF || status == DEVICE_ERROR) {
+	    ingest_finish(in, status);
+	    break;
+	}
+    }
+    return NULL;
+}
+
+bool ingest_start(struct gps_device_t *device, int cpu, int wakefd)
+/* hand an activated device over to its own reader thread */
+{
+    struct ingest_t *in;
+    int err;
+
+    in = (struct ingest_t *)calloc(1, sizeof(struct ingest_t));
+    if (in == NULL) {
+	gpsd_report(device->context->debug, LOG_ERROR,
+		    "INGEST: out of memory for %s\n", device->gpsdata.dev.path);
+	return false;
+    }
+    in->device = device;
+    in->cpu = cpu;
+    in->wakefd = wakefd;
+    (void)pthread_mutex_init(&in->lock, NULL);
+    device->ingest = in;
+    memcpy(&in->view, device, sizeof(in->view));
+
+    err = pthread_create(&in->thread, NULL, ingest_thread, (void *)in);
+    if (err != 0) {
+	gpsd_report(device->context->debug, LOG_ERROR,
+		    "INGEST: can't start reader for %s: %s\n",
+		    device->gpsdata.dev.path, strerror(err));
+	device->ingest = NULL;
+	(void)pthread_mutex_destroy(&in->lock);
+	free(in);
+	return false;
+    }
+    gpsd_report(device->context->debug, LOG_INF,
+		"INGEST: reader thread for %s started (cpu %d)\n",
+		device->gpsdata.dev.path, cpu);
+    return true;
+}
+
+void ingest_stop(struct gps_device_t *device)
+/* stop the reader; the device stays open for the caller to close */
+{
+    struct ingest_t *in = device->ingest;
+
+    if (in == NULL)
+	return;
+    in->stop = true;
+    (void)pthread_join(in->thread, NULL);
+    ingest_flush_log(in);
+    device->ingest = NULL;
+    gpsd_report(device->context->debug, LOG_INF,
+		"INGEST: reader thread for %s stopped, %lu stalls, "
+		"%lu log lines dropped\n",
+		device->gpsdata.dev.path, in->stalls, in->log_drops);
+    (void)pthread_mutex_destroy(&in->lock);
+    free(in);
+}
+
+int ingest_drain(struct gps_device_t *device,
+		 void (*handler)(struct gps_device_t *, gps_mask_t))
+/* main thread: report every published change set; 0 or DEVICE_EOF/ERROR */
+{
+    struct ingest_t *in = device->ingest;
+    uint32_t tail;
+
+    if (in == NULL)
+	return 0;
+    ingest_flush_log(in);
+    tail = in->tail;
+    while (tail != __atomic_load_n(&in->head, __ATOMIC_SEQ_CST)) {
+	const struct ingest_slot_t *s = &in->slot[tail & (INGEST_SLOTS - 1)];
+	int status = s->status;
+
+	if (status == 0) {
+	    ingest_apply(&in->view, s);
+	    if (handler != NULL)
+		handler(&in->view, s->changed);
+	}
+	__atomic_store_n(&in->tail, ++tail, __ATOMIC_SEQ_CST);
+	if (status != 0)
+	    return status;
+    }
+    return 0;
+}
+
+struct gps_device_t *ingest_view(struct gps_device_t *device)
+/* the copy of a threaded device that the main thread may read */
+{
+    return device->ingest != NULL ? &device->ingest->view : device;
+}
+
+void ingest_lock(struct gps_device_t *device)
+{
+    if (device->ingest != NULL)
+	(void)pthread_mutex_lock(&device->ingest->lock);
+}
+
+void ingest_unlock(struct gps_device_t *device)
+{
+    if (device->ingest != NULL)
+	(void)pthread_mutex_unlock(&device->ingest->lock);
+}
+#endif /* INGEST_THREADS_ENABLE */
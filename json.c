@@ -36,6 +36,17 @@ elements of an array must be of the same type.
 JSON object or a JSON array. JSON "float" quantities are actually
 stored as doubles.
 
+   Clients such as loggers fed by gpspipe -w spend most of their time
+in this parser, so it takes a few shortcuts that don't change what it
+accepts.  Attribute tables are mostly built on the stack for each call,
+so rather than hashing them the lookup exploits the fact that gpsd
+writes attributes in table order: the search for a name starts just
+after the previous match and wraps around, and candidates are rejected
+on their first character before strcmp() is called.  Strings and tokens
+are copied by tight loops rather than one trip round the state machine
+per character, and numbers are converted by hand or by safe_atof(), so
+the result doesn't depend on the locale.
+
    This parser processes object arrays in one of two different ways,
 defending on whether the array subtype is declared as object or
 structobject.
@@ -99,7 +110,9 @@ static void json_trace(int errlevel, const char *fmt, ...)
     }
 }
 
-# define json_debug_trace(args) (void) json_trace args
+/* test the level here so tracing costs nothing per character when off */
+# define json_debug_trace(args) \
+	do { if (debuglevel > 0) (void) json_trace args; } while (0)
 #else
 # define json_debug_trace(args) /*@i1@*/do { } while (0)
 #endif /* CLIENTDEBUG_ENABLE */
@@ -152,6 +165,44 @@ static /*@null@*/ char *json_target_address(const struct json_attr_t *cursor,
 
 /*@-immediatetrans -dependenttrans +usereleased +compdef@*/
 
+static const struct json_attr_t *json_attr_lookup(const struct json_attr_t
+						  *attrs,
+						  const struct json_attr_t
+						  *hint, const char *name)
+/* find the first spec for name, starting at hint and wrapping round */
+{
+    const struct json_attr_t *cursor;
+
+    for (cursor = hint; cursor->attribute != NULL; cursor++)
+	if (cursor->attribute[0] == name[0]
+	    && strcmp(cursor->attribute, name) == 0)
+	    goto found;
+    for (cursor = attrs; cursor < hint; cursor++)
+	if (cursor->attribute[0] == name[0]
+	    && strcmp(cursor->attribute, name) == 0)
+	    goto found;
+    return NULL;
+  found:
+    /* the hint may have dropped us inside a span of same-named specs */
+    while (cursor > attrs && cursor[-1].attribute[0] == name[0]
+	   && strcmp(cursor[-1].attribute, name) == 0)
+	--cursor;
+    return cursor;
+}
+
+static int json_atoi(const char *s)
+/* atoi() for the plain decimal integers gpsd writes */
+{
+    const char *digits = (*s == '-') ? s + 1 : s, *p;
+    int v = 0;
+
+    for (p = digits; *p >= '0' && *p <= '9' && p - digits < 9; p++)
+	v = v * 10 + (*p - '0');
+    if (*p != '\0' || p == digits)
+	return atoi(s);		/* odd syntax or possible overflow */
+    return (*s == '-') ? -v : v;
+}
+
 static int json_internal_read_object(const char *cp,
 				     const struct json_attr_t *attrs,
 				     /*@null@*/
@@ -174,7 +225,7 @@ static int json_internal_read_object(const char *cp,
     char valbuf[JSON_VAL_MAX + 1], *pval = NULL;
     bool value_quoted = false;
     char uescape[5];		/* enough space for 4 hex digits and a NUL */
-    const struct json_attr_t *cursor;
+    const struct json_attr_t *cursor, *hint = attrs;
     int substatus, n, maxlen = 0;
     unsigned int u;
     const struct json_enum_t *mp;
@@ -261,22 +312,26 @@ static int json_internal_read_object(const char *cp,
 	case in_attr:
 	    if (pattr == NULL)
 		return JSON_ERR_NULLPTR;
-	    if (*cp == '"') {
+	    while (*cp != '"' && *cp != '\0'
+		   && pattr < attrbuf + JSON_ATTR_MAX - 1)
+		*pattr++ = *cp++;
+	    if (*cp == '\0')
+		--cp;		/* let the loop see the end of input */
+	    else if (*cp == '"') {
 		*pattr++ = '\0';
 		json_debug_trace((1, "Collected attribute name %s\n",
 				  attrbuf));
-		for (cursor = attrs; cursor->attribute != NULL; cursor++) {
-		    json_debug_trace((2, "Checking against %s\n",
-				      cursor->attribute));
-		    if (strcmp(cursor->attribute, attrbuf) == 0)
-			break;
-		}
-		if (cursor->attribute == NULL) {
+		cursor = json_attr_lookup(attrs, hint, attrbuf);
+		if (cursor == NULL) {
 		    json_debug_trace((1,
 				      "Unknown attribute name '%s' (attributes begin with '%s').\n",
 				      attrbuf, attrs->attribute));
 		    return JSON_ERR_BADATTR;
 		}
+		for (hint = cursor + 1;
+		     hint->attribute != NULL
+		     && strcmp(hint->attribute, attrbuf) == 0; hint++)
+		    continue;
 		state = await_value;
 		if (cursor->type == t_string)
 		    maxlen = (int)cursor->len - 1;
@@ -287,11 +342,10 @@ static int json_internal_read_object(const char *cp,
 		else if (cursor->map != NULL)
 		    maxlen = (int)sizeof(valbuf) - 1;
 		pval = valbuf;
-	    } else if (pattr >= attrbuf + JSON_ATTR_MAX - 1) {
+	    } else {
 		json_debug_trace((1, "Attribute name too long.\n"));
 		return JSON_ERR_ATTRLEN;
-	    } else
-		*pattr++ = *cp;
+	    }
 	    break;
 	case await_value:
 	    if (isspace(*cp) || *cp == ':')
@@ -324,7 +378,13 @@ static int json_internal_read_object(const char *cp,
 	case in_val_string:
 	    if (pval == NULL)
 		return JSON_ERR_NULLPTR;
-	    if (*cp == '\\')
+	    while (*cp != '"' && *cp != '\\' && *cp != '\0'
+		   && pval <= valbuf + JSON_VAL_MAX - 1
+		   && pval <= valbuf + maxlen)
+		*pval++ = *cp++;
+	    if (*cp == '\0')
+		--cp;		/* let the loop see the end of input */
+	    else if (*cp == '\\')
 		state = in_escape;
 	    else if (*cp == '"') {
 		*pval++ = '\0';
@@ -372,7 +432,12 @@ static int json_internal_read_object(const char *cp,
 	case in_val_token:
 	    if (pval == NULL)
 		return JSON_ERR_NULLPTR;
-	    if (isspace(*cp) || *cp == ',' || *cp == '}') {
+	    while (*cp != ',' && *cp != '}' && *cp != '\0' && !isspace(*cp)
+		   && pval <= valbuf + JSON_VAL_MAX - 1)
+		*pval++ = *cp++;
+	    if (*cp == '\0')
+		--cp;		/* let the loop see the end of input */
+	    else if (isspace(*cp) || *cp == ',' || *cp == '}') {
 		*pval = '\0';
 		json_debug_trace((1, "Collected token value %s.\n", valbuf));
 		state = post_val;
@@ -392,9 +457,15 @@ static int json_internal_read_object(const char *cp,
 	     * of adjacent ones with the same attrname but different
 	     * types.  Here's where we try to seek forward for a
 	     * matching type/attr pair if we're not looking at one.
+	     * Almost every attribute has a single spec, so find that
+	     * out before examining the value.
 	     */
 	    for (;;) {
 		int seeking = cursor->type;
+		if (cursor[1].attribute == NULL	/* out of possiblities */
+		    || cursor[1].attribute[0] != attrbuf[0]
+		    || strcmp(cursor[1].attribute, attrbuf) != 0)
+		    break;
 		if (value_quoted && (cursor->type == t_string || cursor->type == t_time))
 		    break;
 		if ((strcmp(valbuf, "true")==0 || strcmp(valbuf, "false")==0)
@@ -407,10 +478,6 @@ static int json_internal_read_object(const char *cp,
 		    if (!decimal && (seeking == t_integer || seeking == t_uinteger))
 			break;
 		}
-		if (cursor[1].attribute==NULL)	/* out of possiblities */
-		    break;
-		if (strcmp(cursor[1].attribute, attrbuf)!=0)
-		    break;
 		++cursor;
 	    }
 	    if (value_quoted
@@ -444,13 +511,13 @@ static int json_internal_read_object(const char *cp,
 		switch (cursor->type) {
 		case t_integer:
 		    {
-			int tmp = atoi(valbuf);
+			int tmp = json_atoi(valbuf);
 			memcpy(lptr, &tmp, sizeof(int));
 		    }
 		    break;
 		case t_uinteger:
 		    {
-			unsigned int tmp = (unsigned int)atoi(valbuf);
+			unsigned int tmp = (unsigned int)json_atoi(valbuf);
 			memcpy(lptr, &tmp, sizeof(unsigned int));
 		    }
 		    break;
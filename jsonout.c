@@ -0,0 +1,304 @@
+/****************************************************************************
+
+NAME
+   jsonout.c - append-only JSON writer for the daemon's reports
+
+DESCRIPTION
+   The report dumpers used to build each object with a chain of
+snprintf(buf + strlen(buf), ...) calls, which rescans the buffer on
+every member and goes through printf's format interpreter for every
+number.  Here the writer keeps a cursor instead, and numbers are
+converted by the routines in numfmt.c straight into the buffer.
+
+   Output must stay byte-for-byte what printf would have produced, since
+the regression tests compare it; numfmt.c guarantees that.
+
+   When the buffer fills up the writer stops at the last byte that fits,
+keeps the string terminated and sets the overflow flag.
+
+PERMISSIONS
+  This file is Copyright (c) 2010 by the GPSD project
+  BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "gpsd.h"
+#include "gps_json.h"
+
+void json_out_init(struct json_out_t *out, char *buf, size_t cap)
+/* start writing at the beginning of buf */
+{
+    out->buf = buf;
+    out->len = 0;
+    out->cap = cap;
+    out->overflow = (cap == 0);
+    if (cap > 0)
+	buf[0] = '\0';
+}
+
+void json_out_resume(struct json_out_t *out, char *buf, size_t cap)
+/* continue after whatever buf already holds */
+{
+    json_out_init(out, buf, cap);
+    if (cap > 0) {
+	size_t used = strnlen(buf, cap);
+	out->len = used < cap ? used : cap - 1;
+	buf[out->len] = '\0';
+    }
+}
+
+void json_out_mem(struct json_out_t *out, const char *s, size_t n)
+/* append n bytes */
+{
+    if (out->overflow)
+	return;
+    if (out->len + n >= out->cap) {
+	n = out->cap - 1 - out->len;
+	out->overflow = true;
+    }
+    (void)memcpy(out->buf + out->len, s, n);
+    out->len += n;
+    out->buf[out->len] = '\0';
+}
+
+void json_out_raw(struct json_out_t *out, const char *s)
+/* append a string as is */
+{
+    json_out_mem(out, s, strlen(s));
+}
+
+void json_out_char(struct json_out_t *out, char c)
+/* append one character */
+{
+    if (out->overflow)
+	return;
+    if (out->len + 1 >= out->cap) {
+	out->overflow = true;
+	return;
+    }
+    out->buf[out->len++] = c;
+    out->buf[out->len] = '\0';
+}
+
+static void json_out_advance(struct json_out_t *out, int n)
+/* account for n bytes a numfmt_*() call stored at the cursor */
+{
+    if (n < 0)
+	return;
+    if ((size_t)n >= out->cap - out->len) {
+	out->len = out->cap - 1;
+	out->overflow = true;
+    } else
+	out->len += (size_t)n;
+}
+
+void json_out_uint_pad(struct json_out_t *out, unsigned long long v,
+		       int width)
+/* %0*llu: decimal, zero-padded to at least width digits */
+{
+    if (!out->overflow)
+	json_out_advance(out, numfmt_uint(out->buf + out->len,
+					  out->cap - out->len, v, width));
+}
+
+void json_out_uint(struct json_out_t *out, unsigned long long v)
+/* %llu */
+{
+    if (v < 10)
+	json_out_char(out, (char)('0' + (int)v));
+    else
+	json_out_uint_pad(out, v, 0);
+}
+
+void json_out_int(struct json_out_t *out, long long v)
+/* %lld */
+{
+    if (v < 0) {
+	json_out_char(out, '-');
+	json_out_uint(out, 0ULL - (unsigned long long)v);
+    } else
+	json_out_uint(out, (unsigned long long)v);
+}
+
+void json_out_int_pad(struct json_out_t *out, long long v, int width)
+/* %0*lld */
+{
+    if (!out->overflow)
+	json_out_advance(out, numfmt_int(out->buf + out->len,
+					 out->cap - out->len, v, width));
+}
+
+void json_out_fixed(struct json_out_t *out, double x, int decimals)
+/* %.*f */
+{
+    json_out_fixed_pad(out, x, 0, decimals);
+}
+
+void json_out_fixed_pad(struct json_out_t *out, double x, int width,
+			int decimals)
+/* %0*.*f */
+{
+    if (!out->overflow)
+	json_out_advance(out, numfmt_fixed(out->buf + out->len,
+					   out->cap - out->len,
+					   x, width, decimals));
+}
+
+void json_out_dm(struct json_out_t *out, double degrees, int width)
+/* |degrees| as NMEA DDMM.mmmm, zero-padded to width */
+{
+    if (!out->overflow)
+	json_out_advance(out, numfmt_dm(out->buf + out->len,
+					out->cap - out->len, degrees, width));
+}
+
+void json_out_scaled(struct json_out_t *out, long long units, int decimals)
+/* %.*f of an integer with an implied decimal point */
+{
+    if (!out->overflow)
+	json_out_advance(out, numfmt_scaled(out->buf + out->len,
+					    out->cap - out->len,
+					    units, decimals));
+}
+
+void json_out_string(struct json_out_t *out, const char *s)
+/* append a string with JSON escapes, as json_stringify() would */
+{
+    const char *sp;
+
+    for (sp = s; *sp != '\0' && !out->overflow; sp++) {
+	if (!isascii((unsigned char)*sp) || iscntrl((unsigned char)*sp)) {
+	    json_out_char(out, '\\');
+	    switch (*sp) {
+	    case '\b':
+		json_out_char(out, 'b');
+		break;
+	    case '\f':
+		json_out_char(out, 'f');
+		break;
+	    case '\n':
+		json_out_char(out, 'n');
+		break;
+	    case '\r':
+		json_out_char(out, 'r');
+		break;
+	    case '\t':
+		json_out_char(out, 't');
+		break;
+	    default:
+		json_out_raw(out, "u00");
+		json_out_char(out, "0123456789abcdef"[(*sp >> 4) & 0x0f]);
+		json_out_char(out, "0123456789abcdef"[*sp & 0x0f]);
+	    }
+	} else {
+	    if (*sp == '"' || *sp == '\\')
+		json_out_char(out, '\\');
+	    json_out_char(out, *sp);
+	}
+    }
+}
+
+void json_out_printf(struct json_out_t *out, const char *fmt, ...)
+/* anything the typed appenders don't cover */
+{
+    va_list ap;
+    int n;
+
+    if (out->overflow)
+	return;
+    va_start(ap, fmt);
+    n = vsnprintf(out->buf + out->len, out->cap - out->len, fmt, ap);
+    va_end(ap);
+    json_out_advance(out, n);
+}
+
+void json_out_trim(struct json_out_t *out)
+/* drop a trailing comma */
+{
+    if (out->len > 0 && out->buf[out->len - 1] == ',')
+	out->buf[--out->len] = '\0';
+}
+
+/*
+ * Members.  Keys are passed without quotes; each member is followed by
+ * a comma that json_out_trim() removes before the closing brace.
+ */
+
+void json_out_key(struct json_out_t *out, const char *key)
+{
+    json_out_char(out, '"');
+    json_out_raw(out, key);
+    json_out_mem(out, "\":", 2);
+}
+
+void json_out_member_raw(struct json_out_t *out, const char *key,
+			 const char *value)
+{
+    json_out_key(out, key);
+    json_out_raw(out, value);
+    json_out_char(out, ',');
+}
+
+void json_out_member_str(struct json_out_t *out, const char *key,
+			 const char *value)
+{
+    json_out_key(out, key);
+    json_out_char(out, '"');
+    json_out_raw(out, value);
+    json_out_mem(out, "\",", 2);
+}
+
+void json_out_member_string(struct json_out_t *out, const char *key,
+			    const char *value)
+{
+    json_out_key(out, key);
+    json_out_char(out, '"');
+    json_out_string(out, value);
+    json_out_mem(out, "\",", 2);
+}
+
+void json_out_member_int(struct json_out_t *out, const char *key,
+			 long long value)
+{
+    json_out_key(out, key);
+    json_out_int(out, value);
+    json_out_char(out, ',');
+}
+
+void json_out_member_uint(struct json_out_t *out, const char *key,
+			  unsigned long long value)
+{
+    json_out_key(out, key);
+    json_out_uint(out, value);
+    json_out_char(out, ',');
+}
+
+void json_out_member_fixed(struct json_out_t *out, const char *key,
+			   double value, int decimals)
+{
+    json_out_key(out, key);
+    json_out_fixed(out, value, decimals);
+    json_out_char(out, ',');
+}
+
+void json_out_member_scaled(struct json_out_t *out, const char *key,
+			    long long units, int decimals)
+{
+    json_out_key(out, key);
+    json_out_scaled(out, units, decimals);
+    json_out_char(out, ',');
+}
+
+void json_out_member_bool(struct json_out_t *out, const char *key,
+			  bool value)
+{
+    json_out_key(out, key);
+    json_out_raw(out, value ? "true," : "false,");
+}
+
+/* jsonout.c ends here */
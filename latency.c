@@ -0,0 +1,86 @@
+/*
+ * latency.c - HDR-style latency histograms
+ *
+ * Values are nanoseconds.  Bucketing costs a count-leading-zeros and a
+ * shift, so recording on every subscriber write is cheap; quantiles are
+ * only computed when somebody asks for ?STATS.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "gpsd.h"
+
+static unsigned int latency_bucket(uint64_t ns)
+/* map a value to its bucket index */
+{
+    int msb, e;
+
+    if (ns < 2 * LATENCY_SUB)
+	return (unsigned int)ns;
+    msb = 63 - __builtin_clzll(ns);
+    if (msb > LATENCY_MAX_MSB)
+	return LATENCY_BUCKETS - 1;
+    e = msb - LATENCY_SUB_BITS;
+    return (unsigned int)((e + 1) * LATENCY_SUB
+			  + (int)((ns >> e) & (LATENCY_SUB - 1)));
+}
+
+static uint64_t latency_ceiling(unsigned int idx)
+/* highest value that falls into a bucket */
+{
+    unsigned int e, m;
+
+    if (idx < 2 * LATENCY_SUB)
+	return idx;
+    e = idx / LATENCY_SUB - 1;
+    m = idx % LATENCY_SUB;
+    return ((uint64_t)(LATENCY_SUB + m + 1) << e) - 1;
+}
+
+void latency_add(struct latency_t *lat, uint64_t ns)
+/* record one sample */
+{
+    lat->bucket[latency_bucket(ns)]++;
+    lat->count++;
+    if (ns > lat->max)
+	lat->max = ns;
+}
+
+uint64_t latency_quantile(const struct latency_t *lat, double q)
+/* value below which a fraction q of the samples fall */
+{
+    unsigned long rank, seen = 0;
+    unsigned int i;
+
+    if (lat->count == 0)
+	return 0;
+    rank = (unsigned long)(q * lat->count + 0.5);
+    if (rank < 1)
+	rank = 1;
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+	seen += lat->bucket[i];
+	if (seen >= rank) {
+	    uint64_t v = latency_ceiling(i);
+	    return v < lat->max ? v : lat->max;
+	}
+    }
+    return lat->max;
+}
+
+size_t latency_json_dump(const struct latency_t *lat, char *reply,
+			 size_t replylen)
+/* append count and p50/p99/max in microseconds as JSON members */
+{
+    size_t used = strlen(reply);
+
+    (void)snprintf(reply + used, replylen - used,
+		   "\"count\":%lu,\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f",
+		   lat->count,
+		   latency_quantile(lat, 0.50) / 1e3,
+		   latency_quantile(lat, 0.99) / 1e3,
+		   lat->max / 1e3);
+    return strlen(reply);
+}
@@ -0,0 +1,201 @@
+/****************************************************************************
+
+NAME
+   libgps_binary.c - unpack the daemon's binary report records
+
+DESCRIPTION
+   A client that asks for ?WATCH={"binary":true} gets TPV, SKY and AIS
+reports as the records gpsd_binary.c writes instead of JSON objects.
+This turns them back into gps_data_t with nothing more than copies,
+setting the same mask bits the JSON unpacker would.  The header layout
+is described in gps.h.
+
+   A record whose version, byte order or layout fingerprint doesn't
+match this library is skipped and reported as an error rather than
+misread.  Record kinds this library doesn't know are skipped silently,
+so the daemon can add new ones without breaking older clients.
+
+PERMISSIONS
+  This file is Copyright (c) 2010 by the GPSD project
+  BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "gpsd.h"
+#include "bits.h"
+#include "libgps.h"
+
+#ifdef SOCKET_EXPORT_ENABLE
+
+uint16_t gps_binary_layout(void)
+/* fingerprint of the structure layouts the payloads are copied from */
+{
+    static const size_t sizes[] = {
+	sizeof(int), sizeof(double), sizeof(timestamp_t),
+	sizeof(struct gps_fix_t), sizeof(struct dop_t), sizeof(struct ais_t),
+    };
+    uint16_t fingerprint = 0;
+    unsigned int i;
+
+    for (i = 0; i < NITEMS(sizes); i++)
+	fingerprint = (uint16_t)(fingerprint * 31 + sizes[i]);
+    return fingerprint;
+}
+
+unsigned int gps_binary_flags(void)
+/* the header flags this host writes */
+{
+    const uint16_t probe = 1;
+
+    return *(const unsigned char *)&probe == 1 ? GPS_BINARY_LITTLE : 0;
+}
+
+ssize_t gps_binary_length(const char *buf, size_t avail)
+/* length of the record at buf, 0 if more is needed, -1 if not a record */
+{
+    if (avail < 1 || getub(buf, 0) != GPS_BINARY_MAGIC)
+	return -1;
+    if (avail < GPS_BINARY_HEADER)
+	return 0;
+    return (ssize_t)(GPS_BINARY_HEADER + getbeu16(buf, 4));
+}
+
+static const char *binary_string(const char **cp, const char *end)
+/* step over a NUL-terminated string in the payload */
+{
+    const char *s = *cp;
+    const char *nul = (const char *)memchr(s, '\0', (size_t)(end - s));
+
+    if (nul == NULL)
+	return NULL;
+    *cp = nul + 1;
+    return s;
+}
+
+static bool binary_take(void *dest, size_t size, const char **cp,
+			const char *end)
+/* copy the next field out of the payload */
+{
+    if ((size_t)(end - *cp) < size)
+	return false;
+    (void)memcpy(dest, *cp, size);
+    *cp += size;
+    return true;
+}
+
+static int binary_tpv(const char *cp, const char *end,
+		      struct gps_data_t *gpsdata)
+{
+    int status;
+
+    if (!binary_take(&status, sizeof(status), &cp, end)
+	|| !binary_take(&gpsdata->fix, sizeof(gpsdata->fix), &cp, end)
+	|| !binary_take(&gpsdata->navigation.course_over_ground[compass_true],
+			sizeof(double), &cp, end)
+	|| !binary_take(&gpsdata->navigation.speed_over_ground,
+			sizeof(double), &cp, end)
+	|| !binary_take(&gpsdata->navigation.epd, sizeof(double), &cp, end)
+	|| !binary_take(&gpsdata->navigation.eps, sizeof(double), &cp, end))
+	return -1;
+    gpsdata->status = status;
+    gpsdata->set = STATUS_SET;
+    libgps_tpv_mask(gpsdata);
+    return 0;
+}
+
+static int binary_sky(const char *cp, const char *end,
+		      struct gps_data_t *gpsdata)
+{
+    int i, n;
+
+    if (!binary_take(&gpsdata->skyview_time, sizeof(timestamp_t), &cp, end)
+	|| !binary_take(&gpsdata->dop, sizeof(gpsdata->dop), &cp, end)
+	|| !binary_take(&n, sizeof(n), &cp, end)
+	|| n < 0 || n > MAXCHANNELS)
+	return -1;
+    gpsdata->satellites_visible = 0;
+    gpsdata->satellites_used = 0;
+    (void)memset(gpsdata->PRN, '\0', sizeof(gpsdata->PRN));
+    (void)memset(gpsdata->used, '\0', sizeof(gpsdata->used));
+    for (i = 0; i < n; i++) {
+	int used;
+
+	if (!binary_take(&gpsdata->PRN[i], sizeof(int), &cp, end)
+	    || !binary_take(&gpsdata->elevation[i], sizeof(int), &cp, end)
+	    || !binary_take(&gpsdata->azimuth[i], sizeof(int), &cp, end)
+	    || !binary_take(&gpsdata->ss[i], sizeof(double), &cp, end)
+	    || !binary_take(&used, sizeof(used), &cp, end))
+	    return -1;
+	if (gpsdata->PRN[i] > 0)
+	    gpsdata->satellites_visible++;
+	if (used != 0)
+	    gpsdata->used[gpsdata->satellites_used++] = gpsdata->PRN[i];
+    }
+    gpsdata->set |= SATELLITE_SET;
+    return 0;
+}
+
+static int binary_ais(const char *cp, const char *end,
+		      struct gps_data_t *gpsdata)
+{
+    size_t size = (size_t)(end - cp);
+
+    /* the sender only ships the union member this type uses */
+    if (size < offsetof(struct ais_t, type1) || size > sizeof(struct ais_t))
+	return -1;
+    (void)memset(&gpsdata->ais, '\0', sizeof(gpsdata->ais));
+    (void)memcpy(&gpsdata->ais, cp, size);
+    gpsdata->set &= ~UNION_SET;
+    gpsdata->set |= AIS_SET;
+    return 0;
+}
+
+int gps_binary_unpack(const char *buf, size_t len,
+		      struct gps_data_t *gpsdata)
+/* unpack one complete record; -1 if it's malformed */
+{
+    const char *cp = buf + GPS_BINARY_HEADER, *end = buf + len;
+    const char *path, *tag;
+
+    if (len < GPS_BINARY_HEADER || getub(buf, 0) != GPS_BINARY_MAGIC
+	|| len != (size_t)(GPS_BINARY_HEADER + getbeu16(buf, 4)))
+	return -1;
+    if (getub(buf, 1) != GPS_BINARY_VERSION
+	|| getub(buf, 3) != gps_binary_flags()
+	|| getbeu16(buf, 6) != gps_binary_layout()) {
+	(void)strlcpy(gpsdata->error,
+		      "binary record from an incompatible daemon",
+		      sizeof(gpsdata->error));
+	gpsdata->set &= ~UNION_SET;
+	gpsdata->set |= ERROR_SET;
+	return 0;
+    }
+    if ((path = binary_string(&cp, end)) == NULL
+	|| (tag = binary_string(&cp, end)) == NULL)
+	return -1;
+
+    libgps_debug_trace((DEBUG_CALLS, "gps_binary_unpack(kind %u, %s)\n",
+			getub(buf, 2), path));
+    switch (getub(buf, 2)) {
+    case GPS_BINARY_TPV:
+	(void)strlcpy(gpsdata->dev.path, path, sizeof(gpsdata->dev.path));
+	(void)strlcpy(gpsdata->tag, tag, sizeof(gpsdata->tag));
+	return binary_tpv(cp, end, gpsdata);
+    case GPS_BINARY_SKY:
+	(void)strlcpy(gpsdata->dev.path, path, sizeof(gpsdata->dev.path));
+	(void)strlcpy(gpsdata->tag, tag, sizeof(gpsdata->tag));
+	return binary_sky(cp, end, gpsdata);
+    case GPS_BINARY_AIS:
+	(void)strlcpy(gpsdata->dev.path, path, sizeof(gpsdata->dev.path));
+	return binary_ais(cp, end, gpsdata);
+    default:
+	return 0;
+    }
+}
+
+#endif /* SOCKET_EXPORT_ENABLE */
+
+/* libgps_binary.c ends here */
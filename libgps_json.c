@@ -22,6 +22,7 @@ PERMISSIONS
 #include "gpsd.h"
 #ifdef SOCKET_EXPORT_ENABLE
 #include "gps_json.h"
+#include "libgps.h"
 
 /*
  * There's a splint limitation that parameters can be declared
@@ -397,6 +398,46 @@ int json_pps_read(const char *buf, struct gps_data_t *gpsdata,
     return status;
 }
 
+void libgps_tpv_mask(struct gps_data_t *gpsdata)
+/* set the mask bits a TPV report implies from the fields it carried */
+{
+    gpsdata->navigation.set = 0;
+    if (isnan(gpsdata->fix.time) == 0)
+	gpsdata->set |= TIME_SET;
+    if (isnan(gpsdata->fix.ept) == 0)
+	gpsdata->set |= TIMERR_SET;
+    if (isnan(gpsdata->fix.longitude) == 0)
+	gpsdata->set |= LATLON_SET;
+    if (isnan(gpsdata->fix.altitude) == 0)
+	gpsdata->set |= ALTITUDE_SET;
+    if (isnan(gpsdata->fix.epx) == 0 && isnan(gpsdata->fix.epy) == 0)
+	gpsdata->set |= HERR_SET;
+    if (isnan(gpsdata->fix.epv) == 0)
+	gpsdata->set |= VERR_SET;
+    if (isnan(gpsdata->navigation.course_over_ground[compass_true]) == 0) {
+	gpsdata->set |= NAVIGATION_SET;
+	gpsdata->navigation.set |= NAV_COG_TRUE_PSET;
+    }
+    if (isnan(gpsdata->navigation.speed_over_ground) == 0) {
+	gpsdata->set |= NAVIGATION_SET;
+	gpsdata->navigation.set |= NAV_SOG_PSET;
+    }
+    if (isnan(gpsdata->fix.climb) == 0)
+	gpsdata->set |= CLIMB_SET;
+    /*
+    if (isnan(gpsdata->fix.epd) == 0)
+	gpsdata->set |= TRACKERR_SET;
+    if (isnan(gpsdata->fix.eps) == 0)
+	gpsdata->set |= SPEEDERR_SET;
+    */
+    if (isnan(gpsdata->fix.epc) == 0)
+	gpsdata->set |= CLIMBERR_SET;
+    if (isnan(gpsdata->fix.epc) == 0)
+	gpsdata->set |= CLIMBERR_SET;
+    if (gpsdata->fix.mode != MODE_NOT_SEEN)
+	gpsdata->set |= MODE_SET;
+}
+
 int libgps_json_unpack(const char *buf,
 		       struct gps_data_t *gpsdata, const char **end)
 /* the only entry point - unpack a JSON object into gpsdata_t substructures */
@@ -407,140 +448,141 @@ int libgps_json_unpack(const char *buf,
     if (classtag == NULL)
 	return -1;
 #define STARTSWITH(str, prefix)	strncmp(str, prefix, sizeof(prefix)-1)==0
-    if (STARTSWITH(classtag, "\"class\":\"TPV\"")) {
-	status = json_tpv_read(buf, gpsdata, end);
-	gpsdata->status = STATUS_FIX;
-	gpsdata->set = STATUS_SET;
-	gpsdata->navigation.set = 0;
-	if (isnan(gpsdata->fix.time) == 0)
-	    gpsdata->set |= TIME_SET;
-	if (isnan(gpsdata->fix.ept) == 0)
-	    gpsdata->set |= TIMERR_SET;
-	if (isnan(gpsdata->fix.longitude) == 0)
-	    gpsdata->set |= LATLON_SET;
-	if (isnan(gpsdata->fix.altitude) == 0)
-	    gpsdata->set |= ALTITUDE_SET;
-	if (isnan(gpsdata->fix.epx) == 0 && isnan(gpsdata->fix.epy) == 0)
-	    gpsdata->set |= HERR_SET;
-	if (isnan(gpsdata->fix.epv) == 0)
-	    gpsdata->set |= VERR_SET;
-	if (isnan(gpsdata->navigation.course_over_ground[compass_true]) == 0) {
-	    gpsdata->set |= NAVIGATION_SET;
-	    gpsdata->navigation.set |= NAV_COG_TRUE_PSET;
+    /* switch on the class name's first letter, then confirm it */
+    switch (classtag[8] == '"' ? classtag[9] : '\0') {
+    case 'T':
+	if (STARTSWITH(classtag, "\"class\":\"TPV\"")) {
+	    status = json_tpv_read(buf, gpsdata, end);
+	    gpsdata->status = STATUS_FIX;
+	    gpsdata->set = STATUS_SET;
+	    libgps_tpv_mask(gpsdata);
+	    return status;
 	}
-	if (isnan(gpsdata->navigation.speed_over_ground) == 0) {
-	    gpsdata->set |= NAVIGATION_SET;
-	    gpsdata->navigation.set |= NAV_SOG_PSET;
+	break;
+    case 'G':
+	if (STARTSWITH(classtag, "\"class\":\"GST\"")) {
+	    status = json_noise_read(buf, gpsdata, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= GST_SET;
+	    }
+	    return status;
 	}
-	if (isnan(gpsdata->fix.climb) == 0)
-	    gpsdata->set |= CLIMB_SET;
-	/*
-	if (isnan(gpsdata->fix.epd) == 0)
-	    gpsdata->set |= TRACKERR_SET;
-	if (isnan(gpsdata->fix.eps) == 0)
-	    gpsdata->set |= SPEEDERR_SET;
-	*/
-	if (isnan(gpsdata->fix.epc) == 0)
-	    gpsdata->set |= CLIMBERR_SET;
-	if (isnan(gpsdata->fix.epc) == 0)
-	    gpsdata->set |= CLIMBERR_SET;
-	if (gpsdata->fix.mode != MODE_NOT_SEEN)
-	    gpsdata->set |= MODE_SET;
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"GST\"")) {
-	status = json_noise_read(buf, gpsdata, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= GST_SET;
+	break;
+    case 'S':
+	if (STARTSWITH(classtag, "\"class\":\"SKY\"")) {
+	    status = json_sky_read(buf, gpsdata, end);
+	    if (status == 0)
+		gpsdata->set |= SATELLITE_SET;
+	    return status;
 	}
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"SKY\"")) {
-	status = json_sky_read(buf, gpsdata, end);
-	if (status == 0)
-	    gpsdata->set |= SATELLITE_SET;
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"ATT\"")) {
-	status = json_att_read(buf, gpsdata, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= ATTITUDE_SET;
+	break;
+    case 'A':
+	if (STARTSWITH(classtag, "\"class\":\"ATT\"")) {
+	    status = json_att_read(buf, gpsdata, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= ATTITUDE_SET;
+	    }
+	    return status;
 	}
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"DEVICES\"")) {
-	status = json_devicelist_read(buf, gpsdata, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= DEVICELIST_SET;
+#ifdef AIVDM_ENABLE
+	if (STARTSWITH(classtag, "\"class\":\"AIS\"")) {
+	    status = json_ais_read(buf,
+				   gpsdata->dev.path, sizeof(gpsdata->dev.path),
+				   &gpsdata->ais, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= AIS_SET;
+	    }
+	    return status;
 	}
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"DEVICE\"")) {
-	status = json_device_read(buf, &gpsdata->dev, end);
-	if (status == 0)
-	    gpsdata->set |= DEVICE_SET;
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"WATCH\"")) {
-	status = json_watch_read(buf, &gpsdata->policy, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= POLICY_SET;
+#endif /* AIVDM_ENABLE */
+	break;
+    case 'D':
+	if (STARTSWITH(classtag, "\"class\":\"DEVICES\"")) {
+	    status = json_devicelist_read(buf, gpsdata, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= DEVICELIST_SET;
+	    }
+	    return status;
 	}
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"VERSION\"")) {
-	status = json_version_read(buf, gpsdata, end);
-	if (status ==  0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= VERSION_SET;
+	if (STARTSWITH(classtag, "\"class\":\"DEVICE\"")) {
+	    status = json_device_read(buf, &gpsdata->dev, end);
+	    if (status == 0)
+		gpsdata->set |= DEVICE_SET;
+	    return status;
 	}
-	return status;
+	break;
+    case 'W':
+	if (STARTSWITH(classtag, "\"class\":\"WATCH\"")) {
+	    status = json_watch_read(buf, &gpsdata->policy, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= POLICY_SET;
+	    }
+	    return status;
+	}
+	break;
+    case 'V':
+	if (STARTSWITH(classtag, "\"class\":\"VERSION\"")) {
+	    status = json_version_read(buf, gpsdata, end);
+	    if (status ==  0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= VERSION_SET;
+	    }
+	    return status;
+	}
+	break;
+    case 'R':
 #ifdef RTCM104V2_ENABLE
-    } else if (STARTSWITH(classtag, "\"class\":\"RTCM2\"")) {
-	status = json_rtcm2_read(buf,
-				 gpsdata->dev.path, sizeof(gpsdata->dev.path),
-				 &gpsdata->rtcm2, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= RTCM2_SET;
+	if (STARTSWITH(classtag, "\"class\":\"RTCM2\"")) {
+	    status = json_rtcm2_read(buf,
+				     gpsdata->dev.path, sizeof(gpsdata->dev.path),
+				     &gpsdata->rtcm2, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= RTCM2_SET;
+	    }
+	    return status;
 	}
-	return status;
 #endif /* RTCM104V2_ENABLE */
 #ifdef RTCM104V3_ENABLE
-    } else if (STARTSWITH(classtag, "\"class\":\"RTCM3\"")) {
-	status = json_rtcm3_read(buf,
-				 gpsdata->dev.path, sizeof(gpsdata->dev.path),
-				 &gpsdata->rtcm3, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= RTCM3_SET;
+	if (STARTSWITH(classtag, "\"class\":\"RTCM3\"")) {
+	    status = json_rtcm3_read(buf,
+				     gpsdata->dev.path, sizeof(gpsdata->dev.path),
+				     &gpsdata->rtcm3, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= RTCM3_SET;
+	    }
+	    return status;
 	}
-	return status;
 #endif /* RTCM104V3_ENABLE */
-#ifdef AIVDM_ENABLE
-    } else if (STARTSWITH(classtag, "\"class\":\"AIS\"")) {
-	status = json_ais_read(buf,
-			       gpsdata->dev.path, sizeof(gpsdata->dev.path),
-			       &gpsdata->ais, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= AIS_SET;
+	break;
+    case 'E':
+	if (STARTSWITH(classtag, "\"class\":\"ERROR\"")) {
+	    status = json_error_read(buf, gpsdata, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= ERROR_SET;
+	    }
+	    return status;
 	}
-	return status;
-#endif /* AIVDM_ENABLE */
-    } else if (STARTSWITH(classtag, "\"class\":\"ERROR\"")) {
-	status = json_error_read(buf, gpsdata, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= ERROR_SET;
-	}
-	return status;
-    } else if (STARTSWITH(classtag, "\"class\":\"PPS\"")) {
-	status = json_pps_read(buf, gpsdata, end);
-	if (status == 0) {
-	    gpsdata->set &= ~UNION_SET;
-	    gpsdata->set |= TIMEDRIFT_SET;
+	break;
+    case 'P':
+	if (STARTSWITH(classtag, "\"class\":\"PPS\"")) {
+	    status = json_pps_read(buf, gpsdata, end);
+	    if (status == 0) {
+		gpsdata->set &= ~UNION_SET;
+		gpsdata->set |= TIMEDRIFT_SET;
+	    }
+	    return status;
 	}
-	return status;
-    } else
-	return -1;
+	break;
+    }
+    return -1;
 #undef STARTSWITH
 }
 
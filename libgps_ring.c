@@ -0,0 +1,197 @@
+/****************************************************************************
+
+NAME
+   libgps_ring.c - reader access to the shared-memory event ring
+
+DESCRIPTION
+   Where gps_shm_read() hands back the latest state, this follows every
+update gpsd reported, in order, as small binary records.  Each reader
+keeps its own cursor, so any number of them can follow the ring without
+coordinating with each other or slowing the daemon down.  A reader that
+falls a whole ring behind is resynchronized to the oldest record still
+present and gets GPS_RING_OVERRUN once.
+
+   On Linux an idle reader sleeps on a futex the daemon pokes after each
+batch; elsewhere it polls.
+
+PERMISSIONS
+   This file is Copyright (c) 2010 by the GPSD project
+   BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+#include "gpsd_config.h"
+
+#ifdef SHM_EXPORT_ENABLE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif /* __linux__ */
+
+#include "gpsd.h"
+#include "libgps.h"
+
+struct gps_ring_t
+{
+    volatile struct shmring_t *shared;
+    uint64_t cursor;			/* seq of the next record to read */
+    unsigned long lost;			/* records skipped on overruns */
+    char path[GPS_PATH_MAX];		/* gps_ring_device() result */
+};
+
+#define RING_POLL_USEC	1000	/* sleep between looks without a futex */
+#define RING_SLACK	8	/* records the writer may be ahead of head */
+
+struct gps_ring_t *gps_ring_open(void)
+/* attach to the daemon's event ring, positioned at its head */
+{
+    struct gps_ring_t *ring;
+    volatile struct shmring_t *shared;
+    int shmid;
+
+    libgps_debug_trace((DEBUG_CALLS, "gps_ring_open()\n"));
+
+    shmid = shmget((key_t)GPSD_RING_KEY, sizeof(struct shmring_t), 0);
+    if (shmid == -1)
+	return NULL;
+    shared = (volatile struct shmring_t *)shmat(shmid, 0, 0);
+    if ((int)(long)shared == -1)
+	return NULL;
+    if (shared->magic != RING_MAGIC || shared->version != RING_VERSION
+	|| shared->recsize != sizeof(struct gps_ring_record_t)
+	|| shared->records != RING_RECORDS) {
+	(void)shmdt((const void *)shared);
+	errno = EINVAL;
+	return NULL;
+    }
+
+    ring = (struct gps_ring_t *)calloc(1, sizeof(struct gps_ring_t));
+    if (ring == NULL) {
+	(void)shmdt((const void *)shared);
+	return NULL;
+    }
+    ring->shared = shared;
+    ring->cursor = __atomic_load_n(&shared->head, __ATOMIC_ACQUIRE);
+    return ring;
+}
+
+static int ring_resync(struct gps_ring_t *ring, uint64_t head)
+/* skip past records the writer has overwritten or is about to */
+{
+    uint64_t oldest = head + RING_SLACK - RING_RECORDS;
+
+    if (head + RING_SLACK < RING_RECORDS || oldest <= ring->cursor)
+	oldest = ring->cursor + 1;
+    ring->lost += (unsigned long)(oldest - ring->cursor);
+    ring->cursor = oldest;
+    return GPS_RING_OVERRUN;
+}
+
+static bool ring_wait(struct gps_ring_t *ring, uint32_t seen, int timeout_ms)
+/* sleep until the daemon writes past the futex value we saw */
+{
+    volatile struct shmring_t *shared = ring->shared;
+#ifdef __linux__
+    struct timespec to;
+    long ret;
+
+    to.tv_sec = timeout_ms / 1000;
+    to.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    (void)__atomic_add_fetch(&shared->waiters, 1, __ATOMIC_SEQ_CST);
+    /* the kernel rechecks the word, so a wake between our look and the
+     * call is not lost */
+    ret = syscall(SYS_futex, &shared->futex, FUTEX_WAIT, seen,
+		  timeout_ms < 0 ? NULL : &to, NULL, 0);
+    (void)__atomic_sub_fetch(&shared->waiters, 1, __ATOMIC_SEQ_CST);
+    if (ret == -1 && errno == ETIMEDOUT)
+	return false;
+#else
+    int waited = 0;
+
+    while (shared->futex == seen) {
+	if (timeout_ms >= 0 && waited >= timeout_ms * 1000)
+	    return false;
+	(void)usleep(RING_POLL_USEC);
+	waited += RING_POLL_USEC;
+    }
+#endif /* __linux__ */
+    return true;
+}
+
+int gps_ring_next(struct gps_ring_t *ring, struct gps_ring_record_t *out,
+		  int timeout_ms)
+/* copy the next record; 0 on timeout, GPS_RING_OVERRUN if we were lapped */
+{
+    volatile struct shmring_t *shared = ring->shared;
+
+    for (;;) {
+	uint32_t seen = __atomic_load_n(&shared->futex, __ATOMIC_ACQUIRE);
+	uint64_t head = __atomic_load_n(&shared->head, __ATOMIC_ACQUIRE);
+	const volatile struct gps_ring_record_t *rec;
+
+	if (head - ring->cursor > RING_RECORDS - RING_SLACK)
+	    return ring_resync(ring, head);
+	if (ring->cursor == head) {
+	    if (timeout_ms == 0 || !ring_wait(ring, seen, timeout_ms))
+		return 0;
+	    continue;
+	}
+
+	rec = &shared->rec[ring->cursor & (RING_RECORDS - 1)];
+	if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) == ring->cursor) {
+	    (void)memcpy(out, (const void *)rec, sizeof(*out));
+	    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+	    if (rec->seq == ring->cursor) {
+		ring->cursor++;
+		return 1;
+	    }
+	}
+	/* the writer lapped us while we looked */
+	return ring_resync(ring,
+			   __atomic_load_n(&shared->head, __ATOMIC_ACQUIRE));
+    }
+}
+
+unsigned long gps_ring_lost(const struct gps_ring_t *ring)
+/* how many records overruns have cost this reader */
+{
+    return ring->lost;
+}
+
+const char *gps_ring_device(struct gps_ring_t *ring, int device)
+/* path of the device a record's device field refers to */
+{
+    volatile struct shmring_t *shared = ring->shared;
+    uint32_t seq;
+
+    if (device < 0 || device >= RING_DEVICES)
+	return NULL;
+    do {
+	seq = __atomic_load_n(&shared->device[device].seq, __ATOMIC_ACQUIRE);
+	(void)memcpy(ring->path, (const void *)shared->device[device].path,
+		     sizeof(ring->path));
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) != 0 || seq != shared->device[device].seq);
+    ring->path[sizeof(ring->path) - 1] = '\0';
+    return ring->path[0] != '\0' ? ring->path : NULL;
+}
+
+void gps_ring_close(struct gps_ring_t *ring)
+/* detach from the ring */
+{
+    if (ring == NULL)
+	return;
+    (void)shmdt((const void *)ring->shared);
+    free(ring);
+}
+
+#endif /* SHM_EXPORT_ENABLE */
+
+/* end */
@@ -5,9 +5,14 @@ NAME
 
 DESCRIPTION
    This is a very lightweight alternative to JSON-over-sockets.  Clients
-won't be able to filter by device, and won't get device activation/deactivation
-notifications.  But both client and daemon will avoid all the marshalling and
-unmarshalling overhead.
+won't get device activation/deactivation notifications.  But both client
+and daemon will avoid all the marshalling and unmarshalling overhead.
+
+   Every device has a slot of its own.  A client reads either one slot,
+chosen with gps_shm_device(), or by default a merged view that takes
+each section from whichever device wrote it last.  Only sections that
+changed since the last read are copied, and gps_shm_select() narrows
+that further to the sections a client uses.
 
 PERMISSIONS
    This file is Copyright (c) 2010 by the GPSD project
@@ -33,33 +38,59 @@ PERMISSIONS
 struct privdata_t
 {
     void *shmseg;
-    int tick;
+    uint32_t tick;
+    int device;				/* slot to read, or SHM_MERGED */
+    unsigned int sections;		/* what the client wants copied */
+    uint32_t seq[SHM_SECTIONS];		/* section versions we have */
+    int from[SHM_SECTIONS];		/* ...and the slots they came from */
+    void *scratch;			/* room for the largest section */
 };
 /*@+matchfields@*/
 
+#define SHM_RETRIES	3	/* attempts at a section the daemon is writing */
 
 int gps_shm_open(/*@out@*/struct gps_data_t *gpsdata)
 /* open a shared-memory connection to the daemon */
 {
-    int shmid;
+    volatile struct shmexport_t *shared;
+    size_t largest = 0;
+    int shmid, i;
 
     libgps_debug_trace((DEBUG_CALLS, "gps_shm_open()\n"));
 
     gpsdata->privdata = NULL;
-    shmid = shmget((key_t)GPSD_KEY, sizeof(struct gps_data_t), 0);
+    shmid = shmget((key_t)GPSD_KEY, sizeof(struct shmexport_t), 0);
     if (shmid == -1) {
 	/* daemon isn't running or failed to create shared segment */
 	return -1;
     }
-    gpsdata->privdata = (void *)malloc(sizeof(struct privdata_t));
+    gpsdata->privdata = (void *)calloc(1, sizeof(struct privdata_t));
     if (gpsdata->privdata == NULL)
 	return -1;
 
     PRIVATE(gpsdata)->shmseg = shmat(shmid, 0, 0);
-    if ((int)(long)gpsdata->privdata == -1) {
+    if ((int)(long)PRIVATE(gpsdata)->shmseg == -1) {
 	/* attach failed for sume unknown reason */
+	PRIVATE(gpsdata)->shmseg = NULL;
+	return -2;
+    }
+    shared = (volatile struct shmexport_t *)PRIVATE(gpsdata)->shmseg;
+    if (shared->magic != SHM_MAGIC || shared->version != SHM_VERSION
+	|| shared->nsections != SHM_SECTIONS || shared->nslots != SHM_SLOTS
+	|| shared->slotsize != sizeof(struct shm_slot_t)) {
+	/* a daemon with another export layout */
 	return -2;
     }
+    for (i = 0; i < SHM_SECTIONS; i++)
+	if (shared->slot[0].section[i].length > largest)
+	    largest = shared->slot[0].section[i].length;
+    PRIVATE(gpsdata)->scratch = malloc(largest);
+    if (PRIVATE(gpsdata)->scratch == NULL)
+	return -1;
+    PRIVATE(gpsdata)->sections = SHM_ALL_SECTIONS;
+    PRIVATE(gpsdata)->device = SHM_MERGED;
+    for (i = 0; i < SHM_SECTIONS; i++)
+	PRIVATE(gpsdata)->from[i] = -1;
 #ifndef USE_QT
     gpsdata->gps_fd = SHM_PSEUDO_FD;
 #else
@@ -68,6 +99,71 @@ int gps_shm_open(/*@out@*/struct gps_data_t *gpsdata)
     return 0;
 }
 
+void gps_shm_select(struct gps_data_t *gpsdata, unsigned int sections)
+/* choose the sections gps_shm_read() copies; the head always comes along */
+{
+    if (gpsdata->privdata != NULL)
+	PRIVATE(gpsdata)->sections = sections | SHM_SECTION(SHM_SECTION_HEAD);
+}
+
+int gps_shm_slots(struct gps_data_t *gpsdata,
+		  char (*paths)[GPS_PATH_MAX], int npaths)
+/* list the device path of each slot ("" if unused); return the slot count */
+{
+    volatile struct shmexport_t *shared;
+    int i;
+
+    if (gpsdata->privdata == NULL)
+	return -1;
+    shared = (volatile struct shmexport_t *)PRIVATE(gpsdata)->shmseg;
+    for (i = 0; i < SHM_SLOTS && i < npaths; i++) {
+	volatile struct shm_slot_t *slot = &shared->slot[i];
+	uint32_t before;
+
+	/* the daemon rewrites a path under the slot's sequence lock */
+	do {
+	    before = slot->seq;
+	    memory_barrier();
+	    (void)memcpy(paths[i], (const void *)slot->path, GPS_PATH_MAX);
+	    memory_barrier();
+	} while ((before & 1) != 0 || before != slot->seq);
+	paths[i][GPS_PATH_MAX - 1] = '\0';
+    }
+    return SHM_SLOTS;
+}
+
+int gps_shm_find(struct gps_data_t *gpsdata, const char *path)
+/* slot of a device path, or -1 if the daemon hasn't exported it */
+{
+    char paths[SHM_SLOTS][GPS_PATH_MAX];
+    int i, n = gps_shm_slots(gpsdata, paths, SHM_SLOTS);
+
+    for (i = 0; i < n; i++)
+	if (strcmp(paths[i], path) == 0)
+	    return i;
+    return -1;
+}
+
+int gps_shm_device(struct gps_data_t *gpsdata, int slot)
+/* read one device's slot from now on, or SHM_MERGED for all of them */
+{
+    int i;
+
+    if (gpsdata->privdata == NULL || slot < SHM_MERGED || slot >= SHM_SLOTS)
+	return -1;
+    PRIVATE(gpsdata)->device = slot;
+    PRIVATE(gpsdata)->tick = 0;
+    for (i = 0; i < SHM_SECTIONS; i++)
+	PRIVATE(gpsdata)->from[i] = -1;	/* copy everything afresh */
+    return 0;
+}
+
+static uint32_t shm_tick(volatile struct shmexport_t *shared, int device)
+/* update counter of what the client reads */
+{
+    return device == SHM_MERGED ? shared->tick : shared->slot[device].tick;
+}
+
 bool gps_shm_waiting(const struct gps_data_t *gpsdata, int timeout)
 /* check to see if new data has been written */
 {
@@ -78,7 +174,7 @@ bool gps_shm_waiting(const struct gps_data_t *gpsdata, int timeout)
     for (;;) {
 	bool newdata = false;
 	memory_barrier();
-	if (shared->bookend1 == shared->bookend2 && shared->bookend1 > PRIVATE(gpsdata)->tick)
+	if (shm_tick(shared, PRIVATE(gpsdata)->device) != PRIVATE(gpsdata)->tick)
 	    newdata = true;
 	memory_barrier();
 	if (newdata || (timestamp() - basetime >= (double)timeout))
@@ -88,6 +184,124 @@ bool gps_shm_waiting(const struct gps_data_t *gpsdata, int timeout)
     return true;
 }
 
+static int shm_newest(volatile struct shmexport_t *shared, int id)
+/* slot that most recently wrote a section, -1 if none has */
+{
+    int i, newest = -1;
+
+    for (i = 0; i < SHM_SLOTS; i++) {
+	volatile struct shm_section_t *section = &shared->slot[i].section[id];
+	if (section->seq == 0)
+	    continue;
+	if (newest == -1
+	    || (int32_t)(section->tick
+			 - shared->slot[newest].section[id].tick) > 0)
+	    newest = i;
+    }
+    return newest;
+}
+
+static int shm_snap(volatile struct shmexport_t *shared,
+		    struct privdata_t *priv, int slot, int id)
+/* copy a changed section to scratch: 1 if copied, 0 if unchanged, -1 torn */
+{
+    volatile struct shm_section_t *section = &shared->slot[slot].section[id];
+    int tries;
+
+    for (tries = 0; tries < SHM_RETRIES; tries++) {
+	uint32_t before, after;
+
+	/*
+	 * Following block of instructions must not be reordered,
+	 * otherwise havoc will ensue.  The daemon makes the sequence
+	 * number odd before it touches the payload and even again
+	 * afterwards, so a copy is good if the number was even and
+	 * did not move while we were copying.
+	 */
+	before = section->seq;
+	if (before == priv->seq[id] && slot == priv->from[id])
+	    return 0;
+	if ((before & 1) != 0)
+	    continue;
+	memory_barrier();
+	(void)memcpy(priv->scratch,
+		     (const void *)((const char *)&shared->slot[slot]
+				    + section->offset),
+		     section->length);
+	memory_barrier();
+	after = section->seq;
+	if (before == after) {
+	    priv->seq[id] = after;
+	    priv->from[id] = slot;
+	    return 1;
+	}
+    }
+    return -1;
+}
+
+static void shm_unpack(struct gps_data_t *gpsdata, int id, const void *from)
+/* move a section from scratch into the client's structure */
+{
+    switch (id) {
+    case SHM_SECTION_HEAD:
+	{
+	    const struct shm_head_t *head = (const struct shm_head_t *)from;
+	    gpsdata->set = head->set;
+	    gpsdata->online = head->online;
+	    gpsdata->status = head->status;
+	    gpsdata->own_mmsi = head->own_mmsi;
+	    (void)memcpy(gpsdata->tag, head->tag, sizeof(gpsdata->tag));
+	}
+	break;
+    case SHM_SECTION_DEVICE:
+	(void)memcpy(&gpsdata->dev, from, sizeof(gpsdata->dev));
+	break;
+    case SHM_SECTION_FIX:
+	{
+	    const struct shm_fix_t *fix = (const struct shm_fix_t *)from;
+	    gpsdata->fix = fix->fix;
+	    gpsdata->separation = fix->separation;
+	    gpsdata->epe = fix->epe;
+	}
+	break;
+    case SHM_SECTION_SKY:
+	{
+	    const struct shm_sky_t *sky = (const struct shm_sky_t *)from;
+	    gpsdata->satellites_used = sky->satellites_used;
+	    (void)memcpy(gpsdata->used, sky->used, sizeof(gpsdata->used));
+	    gpsdata->dop = sky->dop;
+	    gpsdata->skyview_time = sky->skyview_time;
+	    gpsdata->satellites_visible = sky->satellites_visible;
+	    (void)memcpy(gpsdata->PRN, sky->PRN, sizeof(gpsdata->PRN));
+	    (void)memcpy(gpsdata->elevation, sky->elevation,
+			 sizeof(gpsdata->elevation));
+	    (void)memcpy(gpsdata->azimuth, sky->azimuth,
+			 sizeof(gpsdata->azimuth));
+	    (void)memcpy(gpsdata->ss, sky->ss, sizeof(gpsdata->ss));
+	}
+	break;
+    case SHM_SECTION_NAVIGATION:
+	(void)memcpy(&gpsdata->navigation, from, sizeof(gpsdata->navigation));
+	break;
+    case SHM_SECTION_WAYPOINT:
+	(void)memcpy(&gpsdata->waypoint, from, sizeof(gpsdata->waypoint));
+	break;
+    case SHM_SECTION_ENVIRONMENT:
+	(void)memcpy(&gpsdata->environment, from,
+		     sizeof(gpsdata->environment));
+	break;
+    case SHM_SECTION_ENGINE:
+	(void)memcpy(&gpsdata->engine, from, sizeof(gpsdata->engine));
+	break;
+    case SHM_SECTION_ATTITUDE:
+	(void)memcpy(&gpsdata->attitude, from, sizeof(gpsdata->attitude));
+	break;
+    case SHM_SECTION_AIS:
+	(void)memcpy(&gpsdata->ais, from, sizeof(gpsdata->ais));
+	break;
+    }
+}
+
 int gps_shm_read(struct gps_data_t *gpsdata)
 /* read an update from the shared-memory segment */
 {
@@ -96,55 +310,63 @@ int gps_shm_read(struct gps_data_t *gpsdata)
 	return -1;
     else
     {
-	int before, after;
-	void *private_save = gpsdata->privdata;
-	volatile struct shmexport_t *shared = (struct shmexport_t *)PRIVATE(gpsdata)->shmseg;
-	struct gps_data_t noclobber;
+	struct privdata_t *priv = PRIVATE(gpsdata);
+	volatile struct shmexport_t *shared = (struct shmexport_t *)priv->shmseg;
+	uint32_t tick = shm_tick(shared, priv->device);
+	int copied = 0, id;
 
-	/*
-	 * Following block of instructions must not be reordered,
-	 * otherwise havoc will ensue.  The memory_barrier() call
-	 * should prevent reordering of the data accesses.
-	 *
-	 * This is a simple optimistic-concurrency technique.  We wrote
-	 * the second bookend first, then the data, then the first bookend.
-	 * Reader copies what it sees in normal order; that way, if we
-	 * start to write the segment during the read, the second bookend will
-	 * get clobbered first and the data can be detected as bad.
-	 */
-	before = shared->bookend1;
 	memory_barrier();
-	(void)memcpy((void *)&noclobber,
-		     (void *)&shared->gpsdata,
-		     sizeof(struct gps_data_t));
-	memory_barrier();
-	after = shared->bookend2;
+	for (id = 0; id < SHM_SECTIONS; id++) {
+	    int status, slot;
 
-	if (before != after)
-	    return 0;
-	else {
-	    (void)memcpy((void *)gpsdata,
-			 (void *)&noclobber,
-			 sizeof(struct gps_data_t));
-	    /*@i1@*/gpsdata->privdata = private_save;
-	    PRIVATE(gpsdata)->tick = after;
-	    if ((gpsdata->set & REPORT_IS)!=0) {
-		if (gpsdata->fix.mode >= 2)
-		    gpsdata->status = STATUS_FIX;
-		else
-		    gpsdata->status = STATUS_NO_FIX;
-		gpsdata->set = STATUS_SET;
+	    if ((priv->sections & SHM_SECTION(id)) == 0)
+		continue;
+	    slot = priv->device == SHM_MERGED
+		? shm_newest(shared, id) : priv->device;
+	    if (slot < 0)
+		continue;
+	    /* these two share a union in gps_data_t; take the current one */
+	    if ((id == SHM_SECTION_ATTITUDE && (gpsdata->set & ATTITUDE_SET) == 0)
+		|| (id == SHM_SECTION_AIS && (gpsdata->set & AIS_SET) == 0))
+		continue;
+	    status = shm_snap(shared, priv, slot, id);
+	    if (status < 0)
+		return 0;	/* daemon kept writing it, try again later */
+	    if (status > 0) {
+		shm_unpack(gpsdata, id, priv->scratch);
+		copied += (int)shared->slot[slot].section[id].length;
 	    }
-	    return (int)sizeof(struct gps_data_t);
 	}
+	if (copied == 0)
+	    return 0;
+
+	priv->tick = tick;
+#ifndef USE_QT
+	gpsdata->gps_fd = SHM_PSEUDO_FD;
+#else
+	gpsdata->gps_fd = (void *)(intptr_t)SHM_PSEUDO_FD;
+#endif /* USE_QT */
+	if ((gpsdata->set & REPORT_IS)!=0) {
+	    if (gpsdata->fix.mode >= 2)
+		gpsdata->status = STATUS_FIX;
+	    else
+		gpsdata->status = STATUS_NO_FIX;
+	    gpsdata->set = STATUS_SET;
+	}
+	return copied;
     }
     /*@ +compdestroy */
 }
 
 void gps_shm_close(struct gps_data_t *gpsdata)
 {
+    if (gpsdata->privdata == NULL)
+	return;
     if (PRIVATE(gpsdata)->shmseg != NULL)
 	(void)shmdt((const void *)PRIVATE(gpsdata)->shmseg);
+    free(PRIVATE(gpsdata)->scratch);
+    free(gpsdata->privdata);
+    gpsdata->privdata = NULL;
 }
 
 int gps_shm_mainloop(struct gps_data_t *gpsdata, int timeout UNUSED,
@@ -33,6 +33,7 @@
 #include "gps.h"
 #include "gpsd.h"
 #include "libgps.h"
+#include "bits.h"
 #ifdef SOCKET_EXPORT_ENABLE
 #include "gps_json.h"
 
@@ -144,23 +145,42 @@ int gps_sock_close(struct gps_data_t *gpsdata)
 /*@+usereleased +compdef@*/
 
 /*@-compdef -usedef -uniondef@*/
+static ssize_t gps_sock_response(const struct privdata_t *priv, bool *binary)
+/* length of the complete response at the front of the buffer, 0 if none */
+{
+    const char *eol;
+
+    if (priv->waiting > 0 && getub(priv->buffer, 0) == GPS_BINARY_MAGIC) {
+	/* a binary record frames itself */
+	ssize_t len = gps_binary_length(priv->buffer, (size_t)priv->waiting);
+
+	*binary = true;
+	if (len > (ssize_t)sizeof(priv->buffer))
+	    return -1;
+	return len <= priv->waiting ? len : 0;
+    }
+    *binary = false;
+    for (eol = priv->buffer;
+	 eol < priv->buffer + priv->waiting && *eol != '\n'; eol++)
+	continue;
+    if (eol == priv->buffer + priv->waiting)
+	return 0;
+    return eol - priv->buffer + 1;
+}
+
 int gps_sock_read(/*@out@*/struct gps_data_t *gpsdata)
 /* wait for and read data being streamed from the daemon */
 {
-    char *eol;
     ssize_t response_length;
+    bool binary;
     int status = -1;
 
     gpsdata->set &= ~PACKET_SET;
-    for (eol = PRIVATE(gpsdata)->buffer;
-	 *eol != '\n' && eol < PRIVATE(gpsdata)->buffer + PRIVATE(gpsdata)->waiting; eol++)
-	continue;
-    if (*eol != '\n')
-	eol = NULL;
+    response_length = gps_sock_response(PRIVATE(gpsdata), &binary);
 
     errno = 0;
 
-    if (eol == NULL) {
+    if (response_length == 0) {
 #ifndef USE_QT
 	/* read data: return -1 if no data waiting or buffered, 0 otherwise */
 	status = (int)recv(gpsdata->gps_fd,
@@ -197,20 +217,24 @@ int gps_sock_read(/*@out@*/struct gps_data_t *gpsdata)
 		return -1;
 	}
 	/* there's buffered data waiting to be returned */
-	for (eol = PRIVATE(gpsdata)->buffer;
-	     *eol != '\n' && eol < PRIVATE(gpsdata)->buffer + PRIVATE(gpsdata)->waiting; eol++)
-	    continue;
-	if (*eol != '\n')
-	    eol = NULL;
-	if (eol == NULL)
+	response_length = gps_sock_response(PRIVATE(gpsdata), &binary);
+	if (response_length == 0)
 	    return 0;
     }
+    if (response_length < 0) {
+	/* a record that can't fit; we've lost sync with the daemon */
+	PRIVATE(gpsdata)->waiting = 0;
+	return -1;
+    }
 
-    assert(eol != NULL);
-    *eol = '\0';
-    response_length = eol - PRIVATE(gpsdata)->buffer + 1;
     gpsdata->online = timestamp();
-    status = gps_unpack(PRIVATE(gpsdata)->buffer, gpsdata);
+    if (binary)
+	status = gps_binary_unpack(PRIVATE(gpsdata)->buffer,
+				   (size_t)response_length, gpsdata);
+    else {
+	PRIVATE(gpsdata)->buffer[response_length - 1] = '\0';
+	status = gps_unpack(PRIVATE(gpsdata)->buffer, gpsdata);
+    }
     /*@+matchanyintegral@*/
     memmove(PRIVATE(gpsdata)->buffer,
 	    PRIVATE(gpsdata)->buffer + response_length, PRIVATE(gpsdata)->waiting - response_length);
@@ -515,6 +539,8 @@ int gps_sock_stream(struct gps_data_t *gpsdata, unsigned int flags,
 		(void)strlcat(buf, "\"json\":false,", sizeof(buf));
 	    if (flags & WATCH_NMEA)
 		(void)strlcat(buf, "\"nmea\":false,", sizeof(buf));
+	    if (flags & WATCH_BINARY)
+		(void)strlcat(buf, "\"binary\":false,", sizeof(buf));
 	    if (flags & WATCH_RAW)
 		(void)strlcat(buf, "\"raw\":1,", sizeof(buf));
 	    if (flags & WATCH_RARE)
@@ -545,6 +571,8 @@ int gps_sock_stream(struct gps_data_t *gpsdata, unsigned int flags,
 		(void)strlcat(buf, "\"json\":true,", sizeof(buf));
 	    if (flags & WATCH_NMEA)
 		(void)strlcat(buf, "\"nmea\":true,", sizeof(buf));
+	    if (flags & WATCH_BINARY)
+		(void)strlcat(buf, "\"binary\":true,", sizeof(buf));
 	    if (flags & WATCH_RARE)
 		(void)strlcat(buf, "\"raw\":1,", sizeof(buf));
 	    if (flags & WATCH_RAW)
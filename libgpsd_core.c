@@ -87,8 +87,40 @@ const char *gpsd_prettydump(struct gps_device_t *session)
 }
 
 
-void gpsd_labeled_report(const int debuglevel, const int sublevel, const int errlevel,
-			 const char *label, const char *fmt, va_list ap)
+int gpsd_log_sublevel[LOG_SUB_COUNT] = {
+    LOG_ERROR - 1, LOG_ERROR - 1, LOG_ERROR - 1,
+    LOG_ERROR - 1, LOG_ERROR - 1, LOG_ERROR - 1,
+};
+
+static const char *log_subnames[LOG_SUB_COUNT] = {
+    "core", "vyspi", "n2k", "seatalk", "ws", "signalk",
+};
+
+unsigned int gpsd_log_submask(const char *names)
+/* map a comma separated list of subsystem names to a LOG_SUBMASK set */
+{
+    unsigned int mask = 0;
+    const char *sp = names;
+
+    while (sp != NULL && *sp != '\0') {
+	size_t len = strcspn(sp, ",");
+	int i;
+
+	for (i = 0; i < LOG_SUB_COUNT; i++)
+	    if (strlen(log_subnames[i]) == len
+		&& strncmp(log_subnames[i], sp, len) == 0)
+		mask |= LOG_SUBMASK(i);
+	sp += len;
+	if (*sp == ',')
+	    sp++;
+    }
+    return mask;
+}
+
+static void labeled_report(const int subsys,
+			   const int debuglevel, const int sublevel,
+			   const int errlevel,
+			   const char *label, const char *fmt, va_list ap)
 /* assemble command in printf(3) style, use stderr or syslog */
 {
 #ifndef SQUELCH_ENABLE
@@ -150,11 +182,30 @@ void gpsd_labeled_report(const int debuglevel, const int sublevel, const int err
 #endif /* PPS_ENABLE */
 
 	if(errlevel <= sublevel)
-	  gpsd_throttled_report(errlevel, buf2);
+	  gpsd_throttled_report(subsys, errlevel, buf2);
     }
 #endif /* !SQUELCH_ENABLE */
 }
 
+void gpsd_labeled_report(const int debuglevel, const int sublevel, const int errlevel,
+			 const char *label, const char *fmt, va_list ap)
+{
+    labeled_report(LOG_SUB_CORE, debuglevel, sublevel, errlevel,
+		   label, fmt, ap);
+}
+
+void gpsd_subsys_report(const int subsys, const int debuglevel,
+			const int errlevel, const char *fmt, ...)
+/* report a message of a subsystem, see GPSD_SUBLOG() */
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    labeled_report(subsys, debuglevel, gpsd_log_sublevel[subsys], errlevel,
+		   "gpsd:", fmt, ap);
+    va_end(ap);
+}
+
 static void gpsd_run_device_hook(const int debuglevel,
 				 char *device_name, char *hook)
 {
@@ -262,7 +313,12 @@ void gps_context_init(struct gps_context_t *context)
 #endif /* PPS_ENABLE */
 #ifdef SHM_EXPORT_ENABLE
 	.shmexport      = NULL,
+	.shmring        = NULL,
 #endif /* SHM_EXPORT_ENABLE */
+	.xform          = NULL,
+	.outrate        = NULL,
+	.n2kbus         = NULL,
+	.arbiter        = NULL,
     };
     /*@ +initallelements +nullassign +nullderef @*/
     /* *INDENT-ON* */
@@ -347,6 +403,9 @@ void gpsd_init(struct gps_device_t *session, struct gps_context_t *context,
 
     /* clear the private data union */
     memset(&session->driver, '\0', sizeof(session->driver));
+    memset(&session->sched, '\0', sizeof(session->sched));
+    /* a reused devices[] slot must not flush its last owner's frames */
+    memset(&session->outrate, '\0', sizeof(session->outrate));
 
 
     /*@ -mayaliasunique @*/
@@ -392,10 +451,12 @@ void gpsd_init(struct gps_device_t *session, struct gps_context_t *context,
     session->driver.nmea2000.enable_writing = 0x00;
 
     session->gpsdata.dev.node_state = node_init;
+    session->n2k.state = n2k_node_off;
+    session->n2k.address = N2K_NODE_NULL;
     // init source addresses
     for(e = 0; e < 256; e++) {
         session->gpsdata.ecu_names[e] = 0;
-        session->gpsdata.src_addr_seen[0] = 0;
+        session->gpsdata.src_addr_seen[e] = 0;
     }
 
 #ifdef TIMING_ENABLE
@@ -1126,7 +1187,8 @@ static void gpsd_error_model(struct gps_device_t *session,
 int gpsd_await_data(/*@out@*/fd_set *rfds,
 		     const int maxfd,
 		     /*@in@*/fd_set *all_fds,
-		     const int debug)
+		     const int debug,
+		     const double timeout)
 /* await data from any socket in the all_fds set */
 {
     int status;
@@ -1155,8 +1217,8 @@ int gpsd_await_data(/*@out@*/fd_set *rfds,
     errno = 0;
 
 //#ifdef COMPAT_SELECT
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
+    tv.tv_sec = (time_t)timeout;
+    tv.tv_usec = (suseconds_t)((timeout - tv.tv_sec) * 1e6);
     status = select(maxfd + 1, rfds, NULL, NULL, &tv);
 //#else
 //    status = pselect(maxfd + 1, rfds, NULL, NULL, NULL, NULL);
@@ -1501,6 +1563,9 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
                         session->packet.outbuflen,
                         gpsd_prettydump(session));
 
+        TRACE_EVENT(TRACE_FRAME, session->gpsdata.gps_fd,
+                    session->packet.type, session->packet.outbuflen);
+
         /* Get data from current packet into the fix structure */
         if (session->packet.type != COMMENT_PACKET)
             if (session->device_type != NULL
@@ -1608,15 +1673,63 @@ gps_mask_t gpsd_poll(struct gps_device_t *session)
     }
 }
 
+const char *sched_class_names[SCHED_CLASSES] = {
+    "normal", "realtime", "bulk",
+};
+
+void sched_classify(struct gps_device_t *device, gps_mask_t changed)
+/* sort a device into a scheduling class by what it reports */
+{
+    struct sched_t *sched = &device->sched;
+
+    if ((changed & AIS_SET) != 0)
+	sched->ais++;
+    /* compasses report heading as navigation data, HDG or PGN 127250 */
+    if ((changed & (ATTITUDE_SET | PPSTIME_IS)) != 0
+	|| ((changed & NAVIGATION_SET) != 0
+	    && (device->gpsdata.navigation.set
+		& (NAV_HDG_TRUE_PSET | NAV_HDG_MAGN_PSET)) != 0))
+	sched->class = SCHED_REALTIME;
+    else if (sched->class != SCHED_REALTIME)
+	sched->class = (sched->ais * 2 > sched->packets)
+	    ? SCHED_BULK : SCHED_NORMAL;
+}
+
+static void sched_budget(const struct gps_device_t *device,
+			 int *packets, uint64_t *ns)
+/* packets and nanoseconds this device may use in one pass, 0 = no limit */
+{
+    *packets = device->context->sched_packets;
+    *ns = (uint64_t)device->context->sched_usec * 1000;
+    switch (device->sched.class) {
+    case SCHED_REALTIME:
+	*packets *= 4;
+	*ns *= 4;
+	break;
+    case SCHED_BULK:
+	*packets = (*packets + 1) / 2;
+	*ns /= 2;
+	break;
+    default:
+	break;
+    }
+}
+
 int gpsd_multipoll(const bool data_ready,
 		   struct gps_device_t *device,
 		   void (*handler)(struct gps_device_t *, gps_mask_t),
 		   float reawake_time)
 /* consume and handle packets from a specified device */
 {
-    if (data_ready)
+    if (data_ready || device->sched.pending)
     {
-        int fragments;
+        int fragments, handled = 0, budget;
+        uint64_t budget_ns, start = monotonic_ns(), elapsed;
+        /* input left buffered by the last pass, no new read needed */
+        bool carried = device->sched.pending;
+
+        device->sched.pending = false;
+        sched_budget(device, &budget, &budget_ns);
 
         gpsd_report(device->context->debug, LOG_RAW + 1,
                     "polling %d\n", device->gpsdata.gps_fd);
@@ -1665,7 +1778,7 @@ int gpsd_multipoll(const bool data_ready,
                  * No data on the first fragment read means the device
                  * fd may have been in an end-of-file condition on select.
                  */
-                if (fragments == 0) {
+                if (fragments == 0 && !carried) {
                     gpsd_report(device->context->debug, LOG_DATA,
                                 "%s returned zero bytes\n",
                                 device->gpsdata.dev.path);
@@ -1741,19 +1854,39 @@ int gpsd_multipoll(const bool data_ready,
                 gpsd_report(device->context->debug, LOG_DATA,
                             "calling handler\n");
                 /*@i1@*/handler(device, changed);
+                device->sched.packets++;
+                sched_classify(device, changed);
             }
 
             /*
-             * Bernd Ocklin suggests:
-             * Exit when a full packet was received and parsed.
-             * This allows other devices to be serviced even if
-             * this device delivers a full packet at every single
-             * read.
-             * Otherwise we can sit here for a long time without
-             * any for-loop exit condition being met.
+             * Bernd Ocklin suggests exiting after a full packet so
+             * other devices get serviced even if this one delivers a
+             * packet on every read.  One packet per pass is too little
+             * for a busy bus, so stop once the device has used up its
+             * budget instead.  Whatever is still in the packet buffer
+             * is carried over to the next pass; the kernel buffer will
+             * wake select() by itself.
              */
-            //if ((changed & PACKET_SET) != 0)
-            //    break;
+            handled++;
+            if ((budget > 0 && handled >= budget)
+                || (budget_ns > 0 && monotonic_ns() - start >= budget_ns)) {
+                device->sched.cut++;
+                device->sched.pending =
+                    packet_buffered_input(&device->packet) > 0;
+                gpsd_report(device->context->debug, LOG_DATA,
+                            "%s used its budget after %d packets%s\n",
+                            device->gpsdata.dev.path, handled,
+                            device->sched.pending ? ", input carried over" : "");
+                break;
+            }
+        }
+
+        if (handled > 0) {
+            elapsed = monotonic_ns() - start;
+            device->sched.passes++;
+            device->sched.busy_ns += elapsed;
+            if (elapsed > device->sched.max_pass_ns)
+                device->sched.max_pass_ns = elapsed;
         }
     }
     else if (device->reawake>0 && timestamp()>device->reawake) {
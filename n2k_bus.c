@@ -0,0 +1,365 @@
+/*
+ * n2k_bus.c - a registry of the nodes on the NMEA 2000 bus
+ *
+ * The global frame counters cannot say which node loads the bus or
+ * drops fast packets.  The drivers therefore hand every packet they
+ * see here with its source address, and the registry keeps a row per
+ * source: the NAME it claimed, its product information, when it was
+ * first and last heard, its fast packet reassembly errors, and per PGN
+ * a cell with the packet and byte counts, a histogram of payload sizes
+ * and the smoothed interval between packets.
+ *
+ * PGNs get a column of the table in the order they are first seen,
+ * found through a small open hash, so a packet costs a probe or two
+ * and one cell.  Packets of PGNs that come after the columns are gone
+ * are only counted.  Frames are reckoned from the payload size: one
+ * for a single frame, else the fast packet frames it takes.
+ *
+ * A source is keyed by its address, but a node that claims a new
+ * address takes its NAME and product information along, and a new NAME
+ * on an address starts its row afresh.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "gpsd.h"
+#include "bits.h"
+#include "gps_json.h"
+
+#define HASH_BITS	7		/* log2(N2K_BUS_HASH) */
+#define PRODUCT_LEN	134		/* PGN 126996 */
+
+/* the table is written from reader threads and read by the main loop */
+static inline void bus_lock(struct n2k_bus_t *bus)
+{
+    while (__atomic_test_and_set(&bus->lock, __ATOMIC_ACQUIRE))
+	continue;
+}
+
+static inline void bus_unlock(struct n2k_bus_t *bus)
+{
+    __atomic_clear(&bus->lock, __ATOMIC_RELEASE);
+}
+
+void n2k_bus_init(struct n2k_bus_t *bus)
+{
+    memset(bus, 0, sizeof(*bus));
+}
+
+static int bus_column(struct n2k_bus_t *bus, uint32_t pgn)
+/* the column of a PGN, given one if it has none yet; -1 when all are taken */
+{
+    unsigned int h = (uint32_t)(pgn * 2654435761u) >> (32 - HASH_BITS);
+    int i;
+
+    /* with twice as many slots as columns a probe always ends */
+    for (i = 0; i < N2K_BUS_HASH; i++, h = (h + 1) & (N2K_BUS_HASH - 1)) {
+	if (bus->hash[h] == 0) {
+	    if (bus->npgns == N2K_BUS_PGNS)
+		return -1;
+	    bus->pgn[bus->npgns] = pgn;
+	    bus->hash[h] = (uint8_t)++bus->npgns;
+	    return bus->npgns - 1;
+	}
+	if (bus->pgn[bus->hash[h] - 1] == pgn)
+	    return bus->hash[h] - 1;
+    }
+    return -1;
+}
+
+static inline int size_bucket(size_t len)
+{
+    if (len <= 8)
+	return 0;
+    if (len <= 32)
+	return 1;
+    if (len <= 96)
+	return 2;
+    return 3;
+}
+
+void n2k_bus_packet(struct n2k_bus_t *bus, uint32_t pgn, uint8_t src,
+		    size_t len, timestamp_t now)
+/* a packet from src, after fast packet reassembly */
+{
+    struct n2k_bus_source_t *s = &bus->source[src];
+    int col;
+
+    bus_lock(bus);
+    if (s->packets == 0)
+	s->first = now;
+    s->last = now;
+    s->packets++;
+    s->frames += len <= 8 ? 1 : 1 + (uint32_t)(len / 7);
+    s->bytes += (uint32_t)len;
+
+    if ((col = bus_column(bus, pgn)) < 0)
+	bus->overflow++;
+    else {
+	struct n2k_bus_cell_t *c = &bus->cell[src][col];
+
+	if (c->packets > 0) {
+	    float dt = (float)(now - c->last);
+
+	    c->interval = c->packets == 1 ? dt : c->interval
+		+ (dt - c->interval) / 8;
+	}
+	c->last = now;
+	c->packets++;
+	c->bytes += (uint32_t)len;
+	c->size[size_bucket(len)]++;
+    }
+    bus_unlock(bus);
+}
+
+void n2k_bus_fast_error(struct n2k_bus_t *bus, uint8_t src, bool cancel)
+/* a fast packet from src that went wrong or was cut off by the next */
+{
+    bus_lock(bus);
+    if (cancel)
+	bus->source[src].fast_cancels++;
+    else
+	bus->source[src].fast_errors++;
+    bus_unlock(bus);
+}
+
+void n2k_bus_claim(struct n2k_bus_t *bus, uint8_t src, const uint8_t *data,
+		   size_t len, timestamp_t now)
+/* an address claim (PGN 60928) */
+{
+    struct n2k_bus_source_t *s = &bus->source[src];
+    uint64_t name;
+    int i;
+
+    if (len < 8 || src >= N2K_NODE_NULL)
+	return;
+    name = getleu64(data, 0);
+
+    bus_lock(bus);
+    if (s->name != name) {
+	struct n2k_bus_source_t *from = NULL;
+
+	for (i = 0; i < N2K_BUS_SOURCES; i++)
+	    if (bus->source[i].name == name && i != src) {
+		from = &bus->source[i];
+		break;
+	    }
+	if (s->name != 0) {
+	    /* someone else had this address; what we know was theirs */
+	    memset(s, 0, sizeof(*s));
+	    memset(bus->cell[src], 0, sizeof(bus->cell[src]));
+	    s->first = s->last = now;
+	}
+	if (from != NULL) {
+	    /* the node moved; its identity comes along */
+	    s->claims = from->claims;
+	    s->product = from->product;
+	    s->n2k_version = from->n2k_version;
+	    s->product_code = from->product_code;
+	    s->cert_level = from->cert_level;
+	    s->load = from->load;
+	    memcpy(s->model_id, from->model_id, sizeof(s->model_id));
+	    memcpy(s->software, from->software, sizeof(s->software));
+	    memcpy(s->model_version, from->model_version,
+		   sizeof(s->model_version));
+	    memcpy(s->serial, from->serial, sizeof(s->serial));
+	    from->name = 0;
+	    from->product = false;
+	}
+	s->name = name;
+    }
+    s->claims++;
+    bus_unlock(bus);
+}
+
+static void product_string(char *to, const uint8_t *from)
+/* a fixed product string, without its padding */
+{
+    int n = N2K_BUS_STRING;
+
+    while (n > 0 && (from[n - 1] == 0xff || from[n - 1] == '\0'
+		     || from[n - 1] == ' ' || from[n - 1] == '@'))
+	n--;
+    memcpy(to, from, (size_t)n);
+    to[n] = '\0';
+}
+
+void n2k_bus_product(struct n2k_bus_t *bus, uint8_t src, const uint8_t *data,
+		     size_t len)
+/* product information (PGN 126996) */
+{
+    struct n2k_bus_source_t *s = &bus->source[src];
+
+    if (len < PRODUCT_LEN)
+	return;
+    bus_lock(bus);
+    s->n2k_version = getleu16(data, 0);
+    s->product_code = getleu16(data, 2);
+    product_string(s->model_id, data + 4);
+    product_string(s->software, data + 36);
+    product_string(s->model_version, data + 68);
+    product_string(s->serial, data + 100);
+    s->cert_level = data[132];
+    s->load = data[133];
+    s->product = true;
+    bus_unlock(bus);
+}
+
+static double cell_rate(const struct n2k_bus_cell_t *c, timestamp_t now)
+/* packets per second, falling off once they stop coming */
+{
+    double interval = c->interval;
+
+    if (c->packets < 2 || interval <= 0)
+	return 0;
+    if (now - c->last > interval)
+	interval = now - c->last;
+    return 1 / interval;
+}
+
+static void source_name(struct json_out_t *out,
+			const struct n2k_bus_source_t *s)
+{
+    if (s->name == 0)
+	return;
+    json_out_key(out, "name");
+    json_out_printf(out, "\"%016llx\",", (unsigned long long)s->name);
+    json_out_member_uint(out, "manufacturer", (s->name >> 21) & 0x7ff);
+    json_out_member_uint(out, "device_function", (s->name >> 40) & 0xff);
+    json_out_member_uint(out, "device_class", (s->name >> 49) & 0x7f);
+}
+
+size_t n2k_bus_json_dump(struct n2k_bus_t *bus, timestamp_t now,
+			 char *reply, size_t replylen)
+/* every source heard, in brief, as an N2KDEVICES object */
+{
+    struct json_out_t out;
+    int src, col;
+
+    json_out_init(&out, reply, replylen);
+    json_out_raw(&out, "{\"class\":\"N2KDEVICES\",");
+    bus_lock(bus);
+    json_out_member_int(&out, "pgns", bus->npgns);
+    json_out_member_uint(&out, "overflow", bus->overflow);
+    json_out_raw(&out, "\"devices\":[");
+    for (src = 0; src < N2K_BUS_SOURCES; src++) {
+	const struct n2k_bus_source_t *s = &bus->source[src];
+	size_t mark = out.len;
+	double rate = 0;
+
+	if (s->packets == 0 && s->name == 0)
+	    continue;
+	for (col = 0; col < bus->npgns; col++)
+	    rate += cell_rate(&bus->cell[src][col], now);
+	json_out_char(&out, '{');
+	json_out_member_int(&out, "src", src);
+	source_name(&out, s);
+	if (s->product)
+	    json_out_member_string(&out, "model", s->model_id);
+	json_out_member_uint(&out, "packets", s->packets);
+	json_out_member_fixed(&out, "rate", rate, 1);
+	json_out_member_uint(&out, "errors", s->fast_errors + s->fast_cancels);
+	json_out_member_fixed(&out, "age", s->packets > 0 ? now - s->last : -1,
+			      1);
+	json_out_trim(&out);
+	json_out_raw(&out, "},");
+	/* leave room to close the object, and say what did not fit */
+	if (out.overflow || out.len + 32 >= replylen) {
+	    out.overflow = false;
+	    out.len = mark;
+	    reply[mark] = '\0';
+	    json_out_trim(&out);
+	    json_out_raw(&out, "],\"truncated\":true}\r\n");
+	    bus_unlock(bus);
+	    return out.len;
+	}
+    }
+    bus_unlock(bus);
+    json_out_trim(&out);
+    json_out_raw(&out, "]}\r\n");
+    return out.len;
+}
+
+size_t n2k_bus_json_source(struct n2k_bus_t *bus, int src, timestamp_t now,
+			   char *reply, size_t replylen)
+/* one source with its PGNs, as an N2KDEVICE object; 0 if never heard */
+{
+    const struct n2k_bus_source_t *s;
+    struct json_out_t out;
+    int col, i;
+
+    if (src < 0 || src >= N2K_BUS_SOURCES)
+	return 0;
+    s = &bus->source[src];
+    json_out_init(&out, reply, replylen);
+    bus_lock(bus);
+    if (s->packets == 0 && s->name == 0) {
+	bus_unlock(bus);
+	return 0;
+    }
+    json_out_raw(&out, "{\"class\":\"N2KDEVICE\",");
+    json_out_member_int(&out, "src", src);
+    source_name(&out, s);
+    if (s->product) {
+	json_out_raw(&out, "\"product\":{");
+	json_out_member_uint(&out, "n2k_version", s->n2k_version);
+	json_out_member_uint(&out, "product_code", s->product_code);
+	json_out_member_string(&out, "model_id", s->model_id);
+	json_out_member_string(&out, "software", s->software);
+	json_out_member_string(&out, "model_version", s->model_version);
+	json_out_member_string(&out, "serial", s->serial);
+	json_out_member_uint(&out, "cert_level", s->cert_level);
+	json_out_member_uint(&out, "load", s->load);
+	json_out_trim(&out);
+	json_out_raw(&out, "},");
+    }
+    json_out_member_uint(&out, "packets", s->packets);
+    json_out_member_uint(&out, "frames", s->frames);
+    json_out_member_uint(&out, "bytes", s->bytes);
+    json_out_member_uint(&out, "fast_errors", s->fast_errors);
+    json_out_member_uint(&out, "fast_cancels", s->fast_cancels);
+    json_out_member_uint(&out, "claims", s->claims);
+    if (s->packets > 0) {
+	json_out_member_fixed(&out, "first", now - s->first, 1);
+	json_out_member_fixed(&out, "age", now - s->last, 1);
+    }
+    json_out_raw(&out, "\"pgns\":[");
+    for (col = 0; col < bus->npgns; col++) {
+	const struct n2k_bus_cell_t *c = &bus->cell[src][col];
+	size_t mark = out.len;
+
+	if (c->packets == 0)
+	    continue;
+	json_out_char(&out, '{');
+	json_out_member_uint(&out, "pgn", bus->pgn[col]);
+	json_out_member_uint(&out, "packets", c->packets);
+	json_out_member_uint(&out, "bytes", c->bytes);
+	json_out_member_fixed(&out, "rate", cell_rate(c, now), 2);
+	json_out_raw(&out, "\"sizes\":[");
+	for (i = 0; i < N2K_BUS_SIZES; i++) {
+	    json_out_uint(&out, c->size[i]);
+	    json_out_char(&out, ',');
+	}
+	json_out_trim(&out);
+	json_out_raw(&out, "],");
+	json_out_member_fixed(&out, "age", now - c->last, 1);
+	json_out_trim(&out);
+	json_out_raw(&out, "},");
+	if (out.overflow || out.len + 32 >= replylen) {
+	    out.overflow = false;
+	    out.len = mark;
+	    reply[mark] = '\0';
+	    json_out_trim(&out);
+	    json_out_raw(&out, "],\"truncated\":true}\r\n");
+	    bus_unlock(bus);
+	    return out.len;
+	}
+    }
+    bus_unlock(bus);
+    json_out_trim(&out);
+    json_out_raw(&out, "]}\r\n");
+    return out.len;
+}
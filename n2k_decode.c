@@ -0,0 +1,253 @@
+/*
+ * n2k_decode.c - decode and encode NMEA 2000 PGNs from their schema tables
+ *
+ * The PGNs whose fields go straight into struct gps_data_t are described
+ * in n2kgen.py, which generates a table of fields for each: where the
+ * field sits in the payload, how wide it is, whether it is signed, what
+ * one count is worth, which member it goes into and which PSET bit says
+ * so.  n2k_decode() walks such a table; the VYSPI and SocketCAN drivers
+ * both hand these PGNs to it, so they decode them the same way.
+ * n2k_encode() walks it the other way, so what the pseudo-N2K output
+ * sends is what the drivers would read back.
+ *
+ * A field reading all ones (unsigned) or the largest positive value
+ * (signed) is not available.  It keeps its last value, or becomes NaN
+ * for PGNs whose schema says so.  An index field picks which instance
+ * of an array the fields after it go to; an index that is missing or
+ * has a value the schema has no PSET bits for makes the whole PGN go
+ * unreported, with nothing stored.
+ *
+ * Encoding starts from a payload of all ones, so reserved bits and the
+ * sequence ID read as not available.  A field is sent as not available
+ * when its member is NaN or its PSET bit is clear, and otherwise rounded
+ * to the nearest count, clamped short of the not-available value.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+#include "bits.h"
+
+static void n2k_heading_hook(struct gps_device_t *session)
+/* the sentence transformations want the boat's magnetic heading */
+{
+    /* with an arbiter the daemon notes the heading it chose */
+    if (session->context->arbiter == NULL)
+	nmea_xform_note(session->context->xform, XFORM_VAR_HEADING,
+			session->gpsdata.navigation.heading[compass_magnetic]);
+}
+
+#include "n2k_decode.i"
+
+static inline uint32_t n2k_bits(const unsigned char *bu,
+				const struct n2k_field_t *f)
+/* the raw field, which the caller has checked is all in the payload */
+{
+    uint64_t v = 0;
+    int i;
+
+    /* nearly every field is whole bytes */
+    if (f->bit % 8 == 0)
+	switch (f->width) {
+	case 8:
+	    return getub(bu, f->bit / 8);
+	case 16:
+	    return getleu16(bu, f->bit / 8);
+	case 32:
+	    return getleu32(bu, f->bit / 8);
+	}
+    for (i = (int)f->end - 1; i >= f->bit / 8; i--)
+	v = (v << 8) | bu[i];
+    v >>= f->bit % 8;
+    if (f->width < 32)
+	v &= (1u << f->width) - 1;
+    return (uint32_t)v;
+}
+
+static inline double n2k_value(const struct n2k_field_t *f, uint32_t raw)
+{
+    if ((f->flags & N2K_SIGNED) != 0 && f->width < 32
+	&& (raw & (1u << (f->width - 1))) != 0)
+	raw |= ~0u << f->width;
+    if ((f->flags & N2K_SIGNED) != 0)
+	return (int32_t)raw * f->scale;
+    return raw * f->scale;
+}
+
+gps_mask_t n2k_decode(const struct n2k_pgn_t *p, const unsigned char *bu,
+		      int len, struct gps_device_t *session)
+/* store what a PGN says into the session, return the report mask */
+{
+    char *base = (char *)&session->gpsdata;
+    gps_mask_t mask = 0, ipset = 0;
+    unsigned int index = 0;
+    bool reset = false;
+    int i;
+
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+	uint32_t raw = (int)f->end <= len ? n2k_bits(bu, f) : f->na;
+	double *dest;
+
+	if ((f->flags & N2K_INDEX) != 0) {
+	    /* the schema puts these first, so this leaves nothing half done */
+	    if ((int)f->end > len || raw >= f->limit)
+		return 0;
+	    index = raw;
+	    ipset = f->pset[raw];
+	    continue;
+	}
+	if (!reset) {
+	    if (p->reset[0] != N2K_NOWHERE)
+		*(gps_mask_t *)(base + p->reset[0]) = 0;
+	    if (p->reset[1] != N2K_NOWHERE)
+		*(gps_mask_t *)(base + p->reset[1]) = 0;
+	    reset = true;
+	}
+	dest = (double *)(base + f->dest + index * f->stride);
+	if (raw == f->na) {
+	    if (p->nan) {
+		*dest = NAN;
+		mask |= f->mask;
+	    }
+	    continue;
+	}
+	*dest = n2k_value(f, raw);
+	if (f->setword != N2K_NOWHERE) {
+	    if ((f->flags & N2K_INDEXED) != 0)
+		*(gps_mask_t *)(base + f->setword) |= f->pset[index] | ipset;
+	    else
+		*(gps_mask_t *)(base + f->setword) |= f->pset[0];
+	}
+	mask |= f->mask;
+    }
+
+    if (p->hook != NULL)
+	p->hook(session);
+    return mask != 0 ? (ONLINE_SET | mask) : 0;
+}
+
+static inline void n2k_put(unsigned char *bu, const struct n2k_field_t *f,
+			   uint32_t raw)
+/* store a raw field into a payload the caller has checked is long enough */
+{
+    uint64_t v, m;
+    int i;
+
+    if (f->width < 32)
+	raw &= (1u << f->width) - 1;
+    if (f->bit % 8 == 0)
+	switch (f->width) {
+	case 8:
+	    bu[f->bit / 8] = (unsigned char)raw;
+	    return;
+	case 16:
+	    bu[f->bit / 8] = (unsigned char)raw;
+	    bu[f->bit / 8 + 1] = (unsigned char)(raw >> 8);
+	    return;
+	case 32:
+	    for (i = 0; i < 4; i++)
+		bu[f->bit / 8 + i] = (unsigned char)(raw >> (8 * i));
+	    return;
+	}
+    v = (uint64_t)raw << (f->bit % 8);
+    m = (((uint64_t)1 << f->width) - 1) << (f->bit % 8);
+    for (i = f->bit / 8; i < (int)f->end; i++) {
+	bu[i] = (unsigned char)((bu[i] & ~m) | (v & m));
+	v >>= 8;
+	m >>= 8;
+    }
+}
+
+static inline uint32_t n2k_raw(const struct n2k_field_t *f, double value)
+/* nearest count to a value, kept clear of the not-available one */
+{
+    double r = rint(value / f->scale);
+    double hi = (double)f->na - 1;
+    double lo = (f->flags & N2K_SIGNED) != 0 ? -(double)f->na - 1 : 0;
+
+    if (r > hi)
+	r = hi;
+    else if (r < lo)
+	r = lo;
+    if ((f->flags & N2K_SIGNED) != 0)
+	return (uint32_t)(int32_t)r;
+    return (uint32_t)r;
+}
+
+size_t n2k_encode(const struct n2k_pgn_t *p, const struct gps_data_t *g,
+		  unsigned int index, unsigned char *bu, size_t buflen)
+/* build a PGN's payload for one instance; 0 if there is nothing to send */
+{
+    const char *base = (const char *)g;
+    bool any = false;
+    int i;
+
+    if ((size_t)p->len > buflen)
+	return 0;
+    memset(bu, 0xff, (size_t)p->len);
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+	gps_mask_t pset;
+	double value;
+
+	if ((f->flags & N2K_INDEX) != 0) {
+	    if (index >= f->limit)
+		return 0;
+	    n2k_put(bu, f, index);
+	    continue;
+	}
+	value = *(const double *)(base + f->dest + index * f->stride);
+	pset = f->pset[(f->flags & N2K_INDEXED) != 0 ? index : 0];
+	if (isnan(value) || (f->setword != N2K_NOWHERE && pset != 0
+		&& (*(const gps_mask_t *)(base + f->setword) & pset) == 0))
+	    n2k_put(bu, f, f->na);
+	else {
+	    n2k_put(bu, f, n2k_raw(f, value));
+	    any = true;
+	}
+    }
+    return any ? (size_t)p->len : 0;
+}
+
+int n2k_instance(const struct n2k_pgn_t *p, const unsigned char *bu, int len)
+/* the value of a PGN's index field, -1 if it has none or lacks it */
+{
+    int i;
+
+    for (i = 0; i < p->nfields; i++)
+	if ((p->field[i].flags & N2K_INDEX) != 0)
+	    return (int)p->field[i].end <= len ?
+		(int)n2k_bits(bu, &p->field[i]) : -1;
+    return -1;
+}
+
+size_t n2k_describe(const struct n2k_pgn_t *p, const unsigned char *bu,
+		    int len, char *buf, size_t buflen)
+/* the fields of a PGN as text, for the driver logs */
+{
+    size_t n = 0;
+    int i;
+
+    buf[0] = '\0';
+    for (i = 0; i < p->nfields && n < buflen; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+	uint32_t raw;
+
+	if ((int)f->end > len || (raw = n2k_bits(bu, f)) == f->na)
+	    n += snprintf(buf + n, buflen - n, "%s%s= -",
+			  i ? ", " : "", f->name);
+	else if ((f->flags & N2K_INDEX) != 0)
+	    n += snprintf(buf + n, buflen - n, "%s%s= %u",
+			  i ? ", " : "", f->name, raw);
+	else
+	    n += snprintf(buf + n, buflen - n, "%s%s= %.4f",
+			  i ? ", " : "", f->name, n2k_value(f, raw));
+    }
+    return n < buflen ? n : buflen - 1;
+}
@@ -0,0 +1,665 @@
+/*
+ * n2k_node.c - an ISO 11783 network node for writing to NMEA 2000
+ *
+ * Before a device may put anything of its own on an NMEA 2000 bus it
+ * has to hold a source address, and it holds one only as long as no
+ * node with a higher priority NAME (a lower number) claims the same.
+ * The node starts either by claiming its configured address, or by
+ * asking everyone for their claims, listening for two seconds and
+ * claiming an address nobody has.  After a claim it waits 250 ms for
+ * objections before it is ready.  A claim of our address by a higher
+ * priority NAME moves us to another free address, or leaves us with a
+ * cannot-claim if none is left; one by a lower priority NAME has us
+ * claim ours again.
+ *
+ * The node answers ISO requests for its address claim, its product
+ * information and its transmit and receive PGN lists, and refuses
+ * requests addressed to it for anything else with a NAK.
+ *
+ * Messages longer than a fast packet go by the ISO transport protocol:
+ * broadcasts announced with a BAM and sent one packet every 50 ms, and
+ * messages to one node with RTS/CTS flow control and an end of message
+ * acknowledgement.  Transfers from other nodes are reassembled the same
+ * ways and handed to deliver().
+ *
+ * Nothing here polls.  n2k_node_wake() says when the next timer of the
+ * node runs out, and n2k_node_tick() runs the ones that have.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "gpsd.h"
+#include "bits.h"
+
+#define N2K_HEADER		7	/* PGN, priority, source, destination */
+
+#define PGN_ACK			59392
+#define PGN_REQUEST		59904
+#define PGN_TP_DT		60160
+#define PGN_TP_CM		60416
+#define PGN_CLAIM		60928
+#define PGN_PGN_LIST		126464
+#define PGN_PRODUCT		126996
+
+#define TP_RTS			16
+#define TP_CTS			17
+#define TP_EOM			19
+#define TP_BAM			32
+#define TP_ABORT		255
+
+#define TP_BUSY			1	/* abort reasons */
+#define TP_RESOURCES		2
+#define TP_TIMEOUT		3
+
+#define TP_WINDOW		16	/* packets cleared to send at once */
+
+/* timers, in seconds */
+#define T_LISTEN		2.0	/* for claims after asking for them */
+#define T_CLAIM			0.25	/* for objections to a claim */
+#define T_BAM			0.05	/* between broadcast packets */
+#define T1			0.75	/* receiver, between packets */
+#define T2			1.25	/* receiver, after a CTS */
+#define T3			1.25	/* sender, for a CTS or the ack */
+#define T4			1.05	/* sender, after a CTS holding it */
+
+#define PENDING_TX_LIST		0x01	/* PGN lists waiting for the sender */
+#define PENDING_RX_LIST		0x02
+
+static void node_put(struct gps_device_t *session, uint32_t pgn, uint8_t prio,
+		     uint8_t src, uint8_t dest, const uint8_t *data,
+		     size_t len)
+/* one message as the drivers write it */
+{
+    uint8_t bu[N2K_HEADER + N2K_FAST_MAX];
+
+    if (len > N2K_FAST_MAX || session->n2k.write == NULL)
+	return;
+    putle32(bu, 0, pgn);
+    bu[4] = prio;
+    bu[5] = src;
+    bu[6] = dest;
+    memcpy(bu + N2K_HEADER, data, len);
+    (void)session->n2k.write(session, bu, N2K_HEADER + len);
+}
+
+static void node_mirror(struct gps_device_t *session)
+/* what the rest of gpsd looks at to decide whether to write */
+{
+    struct n2k_node_t *node = &session->n2k;
+
+    if (node->state == n2k_node_ready)
+	session->gpsdata.dev.node_state = node_ready;
+    else if (node->state == n2k_node_off)
+	session->gpsdata.dev.node_state = node_init;
+    else
+	session->gpsdata.dev.node_state = node_starting;
+#if defined(NMEA2000_ENABLE) || defined(VYSPI_ENABLE)
+    session->driver.nmea2000.own_src_id =
+	node->address < N2K_NODE_NULL ? node->address : 0xff;
+#endif /* defined(NMEA2000_ENABLE) || defined(VYSPI_ENABLE) */
+}
+
+uint64_t n2k_node_name(unsigned int manufacturer, unsigned int unique)
+/* our NAME: self-configurable, marine industry, a navigation device */
+{
+    uint64_t name = 0xc0f0823fe76b4b35ULL;
+
+    name &= ~((uint64_t)0x7ff << 21);
+    name &= ~(uint64_t)0x1fffff;
+    name |= (uint64_t)(manufacturer & 0x7ff) << 21;
+    name |= (uint64_t)(unique & 0x1fffff);
+    return name;
+}
+
+static void node_claim(struct gps_device_t *session, uint8_t address)
+{
+    uint8_t bu[8];
+
+    putle64(bu, 0, session->n2k.name);
+    node_put(session, PGN_CLAIM, 6, address, N2K_NODE_GLOBAL, bu, 8);
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, session->context->debug,
+		"N2K node: claimed source address %u\n", address);
+}
+
+static void node_claim_free(struct gps_device_t *session, timestamp_t now)
+/* claim an address no other node holds, or give up */
+{
+    struct n2k_node_t *node = &session->n2k;
+    unsigned int a;
+
+    for (a = 1; a < 240; a++)
+	if (session->gpsdata.ecu_names[a] == 0
+	    && session->gpsdata.src_addr_seen[a] == 0)
+	    break;
+    if (a == 240) {
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_WARN, session->context->debug,
+		    "N2K node: no source address left to claim\n");
+	node->address = N2K_NODE_NULL;
+	node->state = n2k_node_lost;
+	node_claim(session, N2K_NODE_NULL);
+    } else {
+	node->address = (uint8_t)a;
+	node->state = n2k_node_claiming;
+	node->deadline = now + T_CLAIM;
+	node->claims++;
+	node_claim(session, node->address);
+    }
+    node_mirror(session);
+}
+
+static void tp_cm(struct gps_device_t *session, uint8_t dest, uint8_t control,
+		  uint8_t b1, uint8_t b2, uint8_t b3, uint8_t b4,
+		  uint32_t pgn)
+/* a connection management message */
+{
+    uint8_t bu[8];
+
+    bu[0] = control;
+    bu[1] = b1;
+    bu[2] = b2;
+    bu[3] = b3;
+    bu[4] = b4;
+    putle24(bu, 5, pgn);
+    node_put(session, PGN_TP_CM, 7, session->n2k.address, dest, bu, 8);
+}
+
+static void tp_abort(struct gps_device_t *session, uint8_t dest,
+		     uint8_t reason, uint32_t pgn)
+{
+    tp_cm(session, dest, TP_ABORT, reason, 0xff, 0xff, 0xff, pgn);
+    session->n2k.tp_aborts++;
+}
+
+static void tp_cts(struct gps_device_t *session, struct n2k_tp_t *rx,
+		   timestamp_t now)
+/* clear the next window of packets */
+{
+    unsigned int last = rx->next + rx->window - 1;
+
+    rx->last = (uint16_t)(last < rx->packets ? last : rx->packets);
+    tp_cm(session, rx->peer, TP_CTS, (uint8_t)(rx->last - rx->next + 1),
+	  (uint8_t)rx->next, 0xff, 0xff, rx->pgn);
+    rx->deadline = now + T2;
+}
+
+static void tp_dt(struct gps_device_t *session, const struct n2k_tp_t *tx,
+		  uint8_t seq)
+/* a data packet, the end of the last one padded with 0xff */
+{
+    uint8_t bu[8];
+    size_t off = (size_t)(seq - 1) * 7;
+    size_t n = tx->size - off < 7 ? tx->size - off : 7;
+
+    memset(bu, 0xff, sizeof(bu));
+    bu[0] = seq;
+    memcpy(bu + 1, tx->data + off, n);
+    node_put(session, PGN_TP_DT, 7, session->n2k.address, tx->dest, bu, 8);
+}
+
+int n2k_node_send(struct gps_device_t *session, uint32_t pgn, uint8_t prio,
+		  uint8_t dest, const uint8_t *data, size_t len,
+		  timestamp_t now)
+/*
+ * Send a message from our address, by the transport protocol if it is
+ * longer than a fast packet.  Returns 0 if it went or is on its way,
+ * -1 if we have no address, it is too long or a transfer is running.
+ */
+{
+    struct n2k_node_t *node = &session->n2k;
+    struct n2k_tp_t *tx = &node->tx;
+
+    if (node->state != n2k_node_ready)
+	return -1;
+    if (len <= N2K_FAST_MAX) {
+	node_put(session, pgn, prio, node->address, dest, data, len);
+	return 0;
+    }
+    if (len > N2K_TP_MAX || tx->state != n2k_tp_idle)
+	return -1;
+
+    tx->peer = dest;
+    tx->dest = dest;
+    tx->prio = prio;
+    tx->pgn = pgn;
+    tx->size = (uint16_t)len;
+    tx->packets = (uint8_t)((len + 6) / 7);
+    tx->next = 1;
+    memcpy(tx->data, data, len);
+    if (dest == N2K_NODE_GLOBAL) {
+	tp_cm(session, dest, TP_BAM, (uint8_t)len, (uint8_t)(len >> 8),
+	      tx->packets, 0xff, pgn);
+	tx->state = n2k_tp_bam;
+	tx->deadline = now + T_BAM;
+    } else {
+	tp_cm(session, dest, TP_RTS, (uint8_t)len, (uint8_t)(len >> 8),
+	      tx->packets, 0xff, pgn);
+	tx->state = n2k_tp_rts;
+	tx->deadline = now + T3;
+    }
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, session->context->debug,
+		"N2K node: %s of PGN %u, %zu bytes to %u\n",
+		dest == N2K_NODE_GLOBAL ? "BAM" : "RTS", pgn, len, dest);
+    return 0;
+}
+
+static void node_product(struct gps_device_t *session)
+{
+    static const char *model_id = "vyacht network router";
+    static const char *model_version = "9.4";
+    static const char *serial_code = "130524";
+    uint8_t bu[134];
+
+    memset(bu, 0xff, sizeof(bu));
+    putle16(bu, 0, 0x0514);		/* NMEA 2000 database version */
+    putle16(bu, 2, 0x2c69);		/* product code */
+    memcpy(bu + 4, model_id, strlen(model_id));
+    memcpy(bu + 36, VERSION, strlen(VERSION));
+    memcpy(bu + 68, model_version, strlen(model_version));
+    memcpy(bu + 100, serial_code, strlen(serial_code));
+    bu[132] = 0x00;			/* certification level */
+    bu[133] = 0x01;			/* load equivalency */
+    node_put(session, PGN_PRODUCT, 6, session->n2k.address,
+	     N2K_NODE_GLOBAL, bu, sizeof(bu));
+}
+
+static bool node_list(struct gps_device_t *session, int which, uint8_t dest,
+		      timestamp_t now)
+/* the transmit (0) or receive (1) PGN list; false if the sender is busy */
+{
+    struct n2k_node_t *node = &session->n2k;
+    const uint32_t *pgns = which == 0 ? node->tx_pgns : node->rx_pgns;
+    int n = which == 0 ? node->ntx : node->nrx;
+    uint8_t bu[1 + 3 * N2K_NODE_PGNS];
+    int i;
+
+    bu[0] = (uint8_t)which;
+    for (i = 0; i < n; i++)
+	putle24(bu, 1 + 3 * i, pgns[i]);
+    return n2k_node_send(session, PGN_PGN_LIST, 6, dest, bu,
+			 (size_t)(1 + 3 * n), now) == 0;
+}
+
+static void node_pending(struct gps_device_t *session, timestamp_t now)
+/* send the PGN lists that had to wait for a transfer to end */
+{
+    struct n2k_node_t *node = &session->n2k;
+
+    if ((node->pending & PENDING_TX_LIST) != 0
+	&& node_list(session, 0, node->pending_dest, now))
+	node->pending &= ~PENDING_TX_LIST;
+    if ((node->pending & PENDING_RX_LIST) != 0
+	&& node_list(session, 1, node->pending_dest, now))
+	node->pending &= ~PENDING_RX_LIST;
+}
+
+static void node_request(struct gps_device_t *session, uint8_t src,
+			 uint8_t dest, const uint8_t *data, size_t len,
+			 timestamp_t now)
+{
+    struct n2k_node_t *node = &session->n2k;
+    uint32_t pgn;
+
+    if (len < 3 || node->state == n2k_node_off
+	|| (dest != N2K_NODE_GLOBAL && dest != node->address))
+	return;
+    pgn = getleu24(data, 0);
+    node->requests++;
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, session->context->debug,
+		"N2K node: %u requests PGN %u from %u\n", src, pgn, dest);
+
+    if (pgn == PGN_CLAIM) {
+	if (node->state == n2k_node_claiming || node->state == n2k_node_ready)
+	    node_claim(session, node->address);
+	else if (node->state == n2k_node_lost)
+	    node_claim(session, N2K_NODE_NULL);
+	return;
+    }
+    if (node->state != n2k_node_ready)
+	return;
+    if (pgn == PGN_PRODUCT)
+	node_product(session);
+    else if (pgn == PGN_PGN_LIST) {
+	/* long lists go by transport, to whoever asked */
+	uint8_t to = dest == N2K_NODE_GLOBAL ? N2K_NODE_GLOBAL : src;
+
+	node->pending |= PENDING_TX_LIST | PENDING_RX_LIST;
+	node->pending_dest = to;
+	node_pending(session, now);
+    } else if (dest == node->address) {
+	uint8_t bu[8];
+
+	bu[0] = 1;			/* NAK */
+	bu[1] = 0xff;
+	bu[2] = 0xff;
+	bu[3] = 0xff;
+	bu[4] = src;
+	putle24(bu, 5, pgn);
+	node_put(session, PGN_ACK, 6, node->address, N2K_NODE_GLOBAL, bu, 8);
+	node->naks++;
+    }
+}
+
+static void node_claimed(struct gps_device_t *session, uint8_t src,
+			 const uint8_t *data, size_t len, timestamp_t now)
+/* another node's address claim */
+{
+    struct n2k_node_t *node = &session->n2k;
+    uint64_t name;
+
+    if (len < 8 || src == N2K_NODE_GLOBAL)
+	return;
+    name = getleu64(data, 0);
+    if (src != N2K_NODE_NULL)
+	session->gpsdata.ecu_names[src] = name;
+    if (name == node->name || src != node->address
+	|| (node->state != n2k_node_claiming
+	    && node->state != n2k_node_ready))
+	return;
+
+    node->conflicts++;
+    if (name < node->name) {
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, session->context->debug,
+		    "N2K node: %016llx takes address %u from us\n",
+		    (unsigned long long)name, src);
+	node_claim_free(session, now);
+    } else {
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, session->context->debug,
+		    "N2K node: address %u stays ours against %016llx\n",
+		    src, (unsigned long long)name);
+	node_claim(session, node->address);
+    }
+}
+
+static struct n2k_tp_t *tp_find(struct n2k_node_t *node, uint8_t peer)
+{
+    int i;
+
+    for (i = 0; i < N2K_TP_SESSIONS; i++)
+	if (node->rx[i].state == n2k_tp_receive && node->rx[i].peer == peer)
+	    return &node->rx[i];
+    return NULL;
+}
+
+static struct n2k_tp_t *tp_open(struct n2k_node_t *node, uint8_t peer)
+/* a receive session for peer; it replaces one peer already had */
+{
+    struct n2k_tp_t *rx = tp_find(node, peer);
+    int i;
+
+    for (i = 0; rx == NULL && i < N2K_TP_SESSIONS; i++)
+	if (node->rx[i].state == n2k_tp_idle)
+	    rx = &node->rx[i];
+    return rx;
+}
+
+static void tp_control(struct gps_device_t *session, uint8_t src,
+		       uint8_t dest, const uint8_t *data, size_t len,
+		       timestamp_t now)
+{
+    struct n2k_node_t *node = &session->n2k;
+    struct n2k_tp_t *tx = &node->tx, *rx;
+    uint32_t pgn;
+    uint16_t size;
+
+    if (len < 8)
+	return;
+    pgn = getleu24(data, 5);
+    size = getleu16(data, 1);
+
+    switch (data[0]) {
+    case TP_RTS:
+	if (dest != node->address || node->state == n2k_node_off)
+	    return;
+	if ((rx = tp_open(node, src)) == NULL) {
+	    tp_abort(session, src, TP_BUSY, pgn);
+	    return;
+	}
+	if (size <= 8 || size > N2K_TP_MAX || data[3] != (size + 6) / 7) {
+	    rx->state = n2k_tp_idle;
+	    tp_abort(session, src, TP_RESOURCES, pgn);
+	    return;
+	}
+	rx->state = n2k_tp_receive;
+	rx->peer = src;
+	rx->dest = dest;
+	rx->pgn = pgn;
+	rx->size = size;
+	rx->packets = data[3];
+	rx->next = 1;
+	/* the sender may take fewer at a time */
+	rx->window = data[4] != 0 && data[4] < TP_WINDOW ? data[4] : TP_WINDOW;
+	tp_cts(session, rx, now);
+	break;
+    case TP_BAM:
+	if (dest != N2K_NODE_GLOBAL || size <= 8 || size > N2K_TP_MAX
+	    || data[3] != (size + 6) / 7 || (rx = tp_open(node, src)) == NULL)
+	    return;
+	rx->state = n2k_tp_receive;
+	rx->peer = src;
+	rx->dest = N2K_NODE_GLOBAL;
+	rx->pgn = pgn;
+	rx->size = size;
+	rx->packets = data[3];
+	rx->next = 1;
+	rx->last = data[3];
+	rx->deadline = now + T1;
+	break;
+    case TP_CTS:
+	if ((tx->state != n2k_tp_rts && tx->state != n2k_tp_eom)
+	    || src != tx->dest || dest != node->address || pgn != tx->pgn)
+	    return;
+	if (data[1] == 0) {
+	    /* hold on */
+	    tx->deadline = now + T4;
+	    return;
+	}
+	if (data[2] == 0 || data[2] > tx->packets) {
+	    tp_abort(session, src, TP_RESOURCES, pgn);
+	    tx->state = n2k_tp_idle;
+	    return;
+	}
+	for (tx->next = data[2];
+	     tx->next <= tx->packets && tx->next < data[2] + data[1];
+	     tx->next++)
+	    tp_dt(session, tx, (uint8_t)tx->next);
+	tx->state = tx->next > tx->packets ? n2k_tp_eom : n2k_tp_rts;
+	tx->deadline = now + T3;
+	break;
+    case TP_EOM:
+	if ((tx->state != n2k_tp_rts && tx->state != n2k_tp_eom)
+	    || src != tx->dest || dest != node->address || pgn != tx->pgn)
+	    return;
+	tx->state = n2k_tp_idle;
+	node->tp_sent++;
+	node_pending(session, now);
+	break;
+    case TP_ABORT:
+	if (dest != node->address)
+	    return;
+	if (tx->state != n2k_tp_idle && tx->dest == src && tx->pgn == pgn) {
+	    tx->state = n2k_tp_idle;
+	    node->tp_aborts++;
+	    node_pending(session, now);
+	}
+	if ((rx = tp_find(node, src)) != NULL && rx->pgn == pgn) {
+	    rx->state = n2k_tp_idle;
+	    node->tp_aborts++;
+	}
+	break;
+    }
+}
+
+static void tp_data(struct gps_device_t *session, uint8_t src, uint8_t dest,
+		    const uint8_t *data, size_t len, timestamp_t now)
+{
+    struct n2k_node_t *node = &session->n2k;
+    struct n2k_tp_t *rx = tp_find(node, src);
+    size_t off, n;
+
+    if (len < 8 || rx == NULL || rx->dest != dest)
+	return;
+    if (data[0] != rx->next) {
+	/* lost one; a broadcast is lost with it */
+	if (rx->dest != N2K_NODE_GLOBAL)
+	    tp_abort(session, src, TP_RESOURCES, rx->pgn);
+	rx->state = n2k_tp_idle;
+	return;
+    }
+    off = (size_t)(rx->next - 1) * 7;
+    n = rx->size - off < 7 ? rx->size - off : 7;
+    memcpy(rx->data + off, data + 1, n);
+    rx->next++;
+
+    if (rx->next > rx->packets) {
+	rx->state = n2k_tp_idle;
+	if (rx->dest != N2K_NODE_GLOBAL)
+	    tp_cm(session, src, TP_EOM, (uint8_t)rx->size,
+		  (uint8_t)(rx->size >> 8), rx->packets, 0xff, rx->pgn);
+	node->tp_received++;
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, session->context->debug,
+		    "N2K node: PGN %u, %u bytes from %u by transport\n",
+		    rx->pgn, rx->size, src);
+	if (node->deliver != NULL)
+	    node->deliver(session, rx->pgn, src, rx->dest, rx->data,
+			  rx->size);
+    } else if (rx->dest != N2K_NODE_GLOBAL && rx->next > rx->last)
+	tp_cts(session, rx, now);
+    else
+	rx->deadline = now + T1;
+}
+
+bool n2k_node_input(struct gps_device_t *session, uint32_t pgn, uint8_t prio,
+		    uint8_t src, uint8_t dest, const uint8_t *data, size_t len,
+		    timestamp_t now)
+/* a network management message from the bus; true if it was one */
+{
+    (void)prio;
+    switch (pgn) {
+    case PGN_CLAIM:
+	node_claimed(session, src, data, len, now);
+	return true;
+    case PGN_REQUEST:
+	node_request(session, src, dest, data, len, now);
+	return true;
+    case PGN_TP_CM:
+	tp_control(session, src, dest, data, len, now);
+	return true;
+    case PGN_TP_DT:
+	tp_data(session, src, dest, data, len, now);
+	return true;
+    }
+    return false;
+}
+
+void n2k_node_start(struct gps_device_t *session, uint8_t preferred,
+		    timestamp_t now)
+/* join the bus, with the configured address if there is one */
+{
+    struct n2k_node_t *node = &session->n2k;
+    int i;
+
+    node->tx.state = n2k_tp_idle;
+    for (i = 0; i < N2K_TP_SESSIONS; i++)
+	node->rx[i].state = n2k_tp_idle;
+    node->pending = 0;
+    node->preferred = preferred < N2K_NODE_NULL ? preferred : N2K_NODE_NULL;
+
+    if (node->preferred != N2K_NODE_NULL) {
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, session->context->debug,
+		    "N2K node: starting with source address %u\n",
+		    node->preferred);
+	node->address = node->preferred;
+	node->state = n2k_node_claiming;
+	node->deadline = now + T_CLAIM;
+	node->claims++;
+	node_claim(session, node->address);
+    } else {
+	uint8_t bu[3];
+
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, session->context->debug,
+		    "N2K node: starting, asking for address claims\n");
+	memset(session->gpsdata.ecu_names, 0,
+	       sizeof(session->gpsdata.ecu_names));
+	node->address = N2K_NODE_NULL;
+	node->state = n2k_node_waiting;
+	node->deadline = now + T_LISTEN;
+	putle24(bu, 0, PGN_CLAIM);
+	node_put(session, PGN_REQUEST, 6, N2K_NODE_NULL, N2K_NODE_GLOBAL,
+		 bu, sizeof(bu));
+    }
+    node_mirror(session);
+}
+
+void n2k_node_stop(struct gps_device_t *session)
+{
+    session->n2k.state = n2k_node_off;
+    session->n2k.address = N2K_NODE_NULL;
+    node_mirror(session);
+}
+
+timestamp_t n2k_node_wake(const struct n2k_node_t *node)
+/* when the next timer of the node runs out, 0 if none is running */
+{
+    timestamp_t wake = 0;
+    int i;
+
+#define EARLIER(t) if (wake == 0 || (t) < wake) wake = (t)
+    if (node->state == n2k_node_waiting || node->state == n2k_node_claiming)
+	EARLIER(node->deadline);
+    if (node->tx.state != n2k_tp_idle)
+	EARLIER(node->tx.deadline);
+    for (i = 0; i < N2K_TP_SESSIONS; i++)
+	if (node->rx[i].state != n2k_tp_idle)
+	    EARLIER(node->rx[i].deadline);
+#undef EARLIER
+    return wake;
+}
+
+void n2k_node_tick(struct gps_device_t *session, timestamp_t now)
+/* run the timers that have run out */
+{
+    struct n2k_node_t *node = &session->n2k;
+    struct n2k_tp_t *tx = &node->tx;
+    int i;
+
+    if (node->state == n2k_node_waiting && now >= node->deadline)
+	node_claim_free(session, now);
+    else if (node->state == n2k_node_claiming && now >= node->deadline) {
+	GPSD_SUBLOG(LOG_SUB_N2K, LOG_INF, session->context->debug,
+		    "N2K node: ready with source address %u\n",
+		    node->address);
+	node->state = n2k_node_ready;
+	node_mirror(session);
+    }
+
+    if (tx->state == n2k_tp_bam && now >= tx->deadline) {
+	tp_dt(session, tx, (uint8_t)tx->next++);
+	if (tx->next > tx->packets) {
+	    tx->state = n2k_tp_idle;
+	    node->tp_sent++;
+	} else
+	    tx->deadline = now + T_BAM;
+    } else if ((tx->state == n2k_tp_rts || tx->state == n2k_tp_eom)
+	       && now >= tx->deadline) {
+	tp_abort(session, tx->dest, TP_TIMEOUT, tx->pgn);
+	tx->state = n2k_tp_idle;
+    }
+
+    for (i = 0; i < N2K_TP_SESSIONS; i++) {
+	struct n2k_tp_t *rx = &node->rx[i];
+
+	if (rx->state == n2k_tp_receive && now >= rx->deadline) {
+	    if (rx->dest != N2K_NODE_GLOBAL)
+		tp_abort(session, rx->peer, TP_TIMEOUT, rx->pgn);
+	    else
+		node->tp_aborts++;
+	    rx->state = n2k_tp_idle;
+	}
+    }
+
+    if (node->pending != 0 && node->state == n2k_node_ready)
+	node_pending(session, now);
+}
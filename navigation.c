@@ -43,6 +43,12 @@ nav_clear(struct navigation_t * nav) {
   // magnetic or true heading
   nav->heading[0]        = NAN;
   nav->heading[1]        = NAN;
+
+  nav->vmg               = NAN;
+  nav->leeway            = NAN;
+  nav->course_thru_water = NAN;
+  nav->current_set       = NAN;
+  nav->current_drift     = NAN;
 }
 
 void
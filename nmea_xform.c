@@ -0,0 +1,540 @@
+/*
+ * nmea_xform.c - rewrite NMEA 0183 sentences by configured rules
+ *
+ * Rules come from "transform" sections of the configuration:
+ *
+ *	config transform 'mast_wind'
+ *		option match 'IIMWV'
+ *		option port 'port2'
+ *		list derive '$1=$1+mast-heading'
+ *		option modulo '360'
+ *		option decimals '0'
+ *		option rename 'CCMWV'
+ *
+ * "match" is a talker and sentence ("IIMWV"), a sentence from any talker
+ * ("MWV" or "--MWV"), or a whole proprietary tag ("PGRME").  "derive"
+ * computes a field ($n) or a named value from a sum of fields, named
+ * values and constants; "set" writes a constant into a field; "rename"
+ * gives the sentence a new tag and "drop" swallows it once its values
+ * have been taken.  "heading" is always the boat's magnetic heading, and
+ * a named value nothing has set yet counts as zero.
+ *
+ * The rules for a rotating mast are built in; a section of the same name
+ * as a built-in rule changes it, e.g. option enabled 'false'.
+ *
+ * The rules are hashed on sentence ID when loaded, so a sentence that no
+ * rule is about costs one probe of a 64-entry table.
+ *
+ * The named values are shared by all devices, so that a mast compass on
+ * one port can turn the wind from another.  With reader threads several
+ * devices apply rules at once while the main thread notes the heading,
+ * so they are read and written under a lock.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#ifdef INGEST_THREADS_ENABLE
+#include <pthread.h>
+#endif /* INGEST_THREADS_ENABLE */
+
+#include "gpsd.h"
+
+#ifdef INGEST_THREADS_ENABLE
+/* reader threads apply the rules while the main thread notes the heading */
+static pthread_mutex_t var_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif /* INGEST_THREADS_ENABLE */
+
+/*
+ * A compass and a wind vane at the masthead of a rotating mast.  The
+ * compass would fight the boat's own on the bus, so it is renamed to a
+ * sentence nobody reads, and the apparent wind is turned by the angle
+ * between mast and boat.
+ */
+static const char *const builtin[][3] = {
+    {"mast_heading", "match", "HCHDM"},
+    {"mast_heading", "derive", "mast=$1"},
+    {"mast_heading", "rename", "CCHDX"},
+    {"mast_wind", "match", "IIMWV"},
+    {"mast_wind", "derive", "$1=$1+mast-heading"},
+    {"mast_wind", "modulo", "360"},
+    {"mast_wind", "decimals", "0"},
+    {"mast_wind", "rename", "CCMWV"},
+};
+
+static uint64_t xform_key(const char *id, size_t len)
+/* pack a sentence ID of up to 7 characters into a nonzero key */
+{
+    uint64_t key = 0;
+    size_t i;
+
+    for (i = 0; i < len && i < 7; i++)
+	key = (key << 8) | (unsigned char)id[i];
+    return key;
+}
+
+static unsigned int xform_hash(uint64_t key)
+{
+    return (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> 58)
+	& (XFORM_BUCKETS - 1);
+}
+
+static int xform_var(struct nmea_xform_t *xf, const char *name, size_t len)
+/* find or make the slot for a named value */
+{
+    int i;
+
+    if (len == 0 || len >= XFORM_NAMELEN
+	|| !(isalpha((unsigned char)name[0]) || name[0] == '_'))
+	return -1;
+    for (i = 0; i < xf->nvars; i++)
+	if (strncmp(xf->varname[i], name, len) == 0
+	    && xf->varname[i][len] == '\0')
+	    return i;
+    if (xf->nvars >= XFORM_VARS)
+	return -1;
+    (void)memcpy(xf->varname[i], name, len);
+    xf->varname[i][len] = '\0';
+    xf->var[i] = NAN;
+    return xf->nvars++;
+}
+
+static int xform_field(const char *s, size_t len)
+/* "$n" to n, anything else to -1 */
+{
+    int n = 0;
+    size_t i;
+
+    if (len < 2 || len > 3 || s[0] != '$')
+	return -1;
+    for (i = 1; i < len; i++) {
+	if (!isdigit((unsigned char)s[i]))
+	    return -1;
+	n = n * 10 + s[i] - '0';
+    }
+    return (n > 0 && n < XFORM_FIELDS) ? n : -1;
+}
+
+static bool xform_bool(const char *value)
+{
+    return strcmp(value, "1") == 0 || strcmp(value, "true") == 0
+	|| strcmp(value, "yes") == 0 || strcmp(value, "on") == 0;
+}
+
+static bool xform_tag(const char *value, size_t min)
+/* is this something that can go between '$' and the first comma? */
+{
+    size_t i, len = strlen(value);
+
+    if (len < min || len > 7)
+	return false;
+    for (i = 0; i < len; i++)
+	if (!isupper((unsigned char)value[i])
+	    && !isdigit((unsigned char)value[i]))
+	    return false;
+    return true;
+}
+
+static bool xform_match(struct xform_rule_t *r, const char *value)
+{
+    size_t len;
+
+    if (value[0] == '$')
+	value++;
+    len = strlen(value);
+    r->talker[0] = '\0';
+    if (len == 5 && strncmp(value, "--", 2) == 0)
+	value += 2;
+    else if (len == 5 && value[0] != 'P') {
+	(void)memcpy(r->talker, value, 2);
+	r->talker[2] = '\0';
+	value += 2;
+    } else if (value[0] != 'P' && len != 3)
+	return false;
+    if (!xform_tag(value, 3))
+	return false;
+    (void)strlcpy(r->id, value, sizeof(r->id));
+    return true;
+}
+
+static bool xform_derive(struct nmea_xform_t *xf, struct xform_rule_t *r,
+			 const char *value, bool set)
+/* compile "target=expression", or "$n=text" for set */
+{
+    struct xform_step_t *st;
+    const char *eq = strchr(value, '='), *p;
+
+    if (eq == NULL || r->nsteps >= XFORM_STEPS)
+	return false;
+    st = &r->step[r->nsteps];
+    (void)memset(st, 0, sizeof(*st));
+    st->set = set;
+    if ((st->field = xform_field(value, (size_t)(eq - value))) < 0) {
+	st->field = 0;
+	if (set)
+	    return false;
+	if ((st->var = xform_var(xf, value, (size_t)(eq - value))) < 0)
+	    return false;
+    }
+
+    if (set) {
+	if (strpbrk(eq + 1, ",*$\r\n") != NULL
+	    || strlcpy(st->text, eq + 1, sizeof(st->text)) >= sizeof(st->text))
+	    return false;
+	r->nsteps++;
+	return true;
+    }
+
+    for (p = eq + 1; *p != '\0';) {
+	struct xform_term_t *t;
+	double sign = 1;
+	size_t len;
+
+	if (st->nterms >= XFORM_TERMS)
+	    return false;
+	t = &st->term[st->nterms];
+	if (*p == '+' || *p == '-')
+	    sign = (*p++ == '-') ? -1 : 1;
+	len = strcspn(p, "+-");
+	if (len == 0)
+	    return false;
+	if ((t->index = xform_field(p, len)) > 0) {
+	    t->kind = term_field;
+	    t->k = sign;
+	} else if (isdigit((unsigned char)*p) || *p == '.') {
+	    char *end;
+
+	    t->kind = term_const;
+	    t->k = sign * strtod(p, &end);
+	    if (end != p + len)
+		return false;
+	} else if ((t->index = xform_var(xf, p, len)) >= 0) {
+	    t->kind = term_var;
+	    t->k = sign;
+	} else
+	    return false;
+	st->nterms++;
+	p += len;
+    }
+    if (st->nterms == 0)
+	return false;
+    r->nsteps++;
+    return true;
+}
+
+void nmea_xform_init(/*@out@*/struct nmea_xform_t *xf)
+/* no rules but the built-in ones */
+{
+    size_t i;
+
+    (void)memset(xf, 0, sizeof(*xf));
+    (void)xform_var(xf, "heading", strlen("heading"));
+    for (i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++) {
+	struct xform_rule_t *r = nmea_xform_rule(xf, builtin[i][0]);
+
+	if (r != NULL)
+	    (void)nmea_xform_option(xf, r, builtin[i][1], builtin[i][2]);
+    }
+    nmea_xform_compile(xf);
+}
+
+/*@null@*/struct xform_rule_t *nmea_xform_rule(struct nmea_xform_t *xf,
+					      const char *name)
+/* the rule of this name, new if there is none yet */
+{
+    struct xform_rule_t *r;
+    int i;
+
+    for (i = 0; i < xf->nrules; i++)
+	if (strcmp(xf->rule[i].name, name) == 0)
+	    return &xf->rule[i];
+    if (xf->nrules >= XFORM_RULES)
+	return NULL;
+    r = &xf->rule[xf->nrules++];
+    (void)memset(r, 0, sizeof(*r));
+    (void)strlcpy(r->name, name, sizeof(r->name));
+    r->enabled = true;
+    r->decimals = -1;
+    r->next = -1;
+    return r;
+}
+
+bool nmea_xform_option(struct nmea_xform_t *xf, struct xform_rule_t *r,
+		       const char *option, const char *value)
+/* apply one configuration option to a rule; false if it makes no sense */
+{
+    if (strcmp(option, "match") == 0)
+	return xform_match(r, value);
+    else if (strcmp(option, "port") == 0)
+	return strlcpy(r->port, value, sizeof(r->port)) < sizeof(r->port);
+    else if (strcmp(option, "derive") == 0)
+	return xform_derive(xf, r, value, false);
+    else if (strcmp(option, "set") == 0)
+	return xform_derive(xf, r, value, true);
+    else if (strcmp(option, "rename") == 0) {
+	if (!xform_tag(value, 3))
+	    return false;
+	(void)strlcpy(r->rename, value, sizeof(r->rename));
+    } else if (strcmp(option, "drop") == 0)
+	r->drop = xform_bool(value);
+    else if (strcmp(option, "enabled") == 0)
+	r->enabled = xform_bool(value);
+    else if (strcmp(option, "decimals") == 0) {
+	if (!isdigit((unsigned char)value[0]) || value[1] != '\0')
+	    return false;
+	r->decimals = value[0] - '0';
+    } else if (strcmp(option, "modulo") == 0) {
+	if ((r->modulo = safe_atof(value)) <= 0) {
+	    r->modulo = 0;
+	    return false;
+	}
+    } else
+	return false;
+    return true;
+}
+
+void nmea_xform_compile(struct nmea_xform_t *xf)
+/* hash the enabled rules on sentence ID, keeping their order per ID */
+{
+    int i, j;
+
+    (void)memset(xf->key, 0, sizeof(xf->key));
+    for (i = 0; i < XFORM_BUCKETS; i++)
+	xf->first[i] = -1;
+    for (i = 0; i < xf->nrules; i++) {
+	struct xform_rule_t *r = &xf->rule[i];
+	uint64_t key;
+	unsigned int h;
+
+	r->next = -1;
+	if (!r->enabled || r->id[0] == '\0')
+	    continue;
+	key = xform_key(r->id, strlen(r->id));
+	for (h = xform_hash(key); xf->key[h] != 0 && xf->key[h] != key;
+	     h = (h + 1) & (XFORM_BUCKETS - 1))
+	    continue;
+	if (xf->key[h] == 0) {
+	    xf->key[h] = key;
+	    xf->first[h] = i;
+	} else {
+	    for (j = xf->first[h]; xf->rule[j].next >= 0; j = xf->rule[j].next)
+		continue;
+	    xf->rule[j].next = i;
+	}
+    }
+}
+
+static double xform_get(const struct nmea_xform_t *xf, int var)
+/* a named value, 0 if nothing has set it yet */
+{
+    double v;
+
+#ifdef INGEST_THREADS_ENABLE
+    (void)pthread_mutex_lock(&var_mutex);
+#endif /* INGEST_THREADS_ENABLE */
+    v = xf->var[var];
+#ifdef INGEST_THREADS_ENABLE
+    (void)pthread_mutex_unlock(&var_mutex);
+#endif /* INGEST_THREADS_ENABLE */
+    return isnan(v) ? 0 : v;
+}
+
+static void xform_set(struct nmea_xform_t *xf, int var, double value)
+{
+#ifdef INGEST_THREADS_ENABLE
+    (void)pthread_mutex_lock(&var_mutex);
+#endif /* INGEST_THREADS_ENABLE */
+    xf->var[var] = value;
+#ifdef INGEST_THREADS_ENABLE
+    (void)pthread_mutex_unlock(&var_mutex);
+#endif /* INGEST_THREADS_ENABLE */
+}
+
+void nmea_xform_note(/*@null@*/struct nmea_xform_t *xf, int var, double value)
+/* remember a value the rules may derive from */
+{
+    if (xf != NULL && var >= 0 && var < xf->nvars)
+	xform_set(xf, var, value);
+}
+
+static bool xform_port(const struct xform_rule_t *r,
+		       const struct gps_device_t *session, int port)
+/* did the sentence come in on the rule's port? */
+{
+    int i;
+
+    if (r->port[0] == '\0')
+	return true;
+    if (session == NULL)
+	return false;
+    for (i = 0; i < session->gpsdata.dev.port_count; i++)
+	if (session->gpsdata.dev.portlist[i].no == port)
+	    return strcmp(session->gpsdata.dev.portlist[i].name, r->port) == 0;
+    return false;
+}
+
+enum xform_result_t nmea_xform_apply(struct nmea_xform_t *xf,
+				     const struct gps_device_t *session,
+				     int port, const char *in, size_t len,
+				     /*@out@*/char *out, size_t outlen)
+/* run a sentence through the rules; out holds it if it was rewritten */
+{
+    const char *field[XFORM_FIELDS];
+    size_t flen[XFORM_FIELDS];
+    char fbuf[XFORM_FIELDS][XFORM_NAMELEN];
+    char tag[8];
+    size_t taglen, n, i;
+    uint64_t key;
+    unsigned int h, sum = 0;
+    int nf = 0, ri;
+    bool split = false;
+
+    if (len < 4 || in[0] != '$')
+	return xform_pass;
+    for (taglen = 0; taglen + 1 < len && taglen < 8; taglen++)
+	if (in[taglen + 1] == ',' || in[taglen + 1] == '*')
+	    break;
+    if (taglen >= 8)
+	return xform_pass;
+    if (in[1] == 'P')
+	key = xform_key(in + 1, taglen);
+    else if (taglen == 5)
+	key = xform_key(in + 3, 3);
+    else
+	return xform_pass;
+    for (h = xform_hash(key); xf->key[h] != key;
+	 h = (h + 1) & (XFORM_BUCKETS - 1))
+	if (xf->key[h] == 0)
+	    return xform_pass;
+
+    (void)memcpy(tag, in + 1, taglen);
+    tag[taglen] = '\0';
+    for (ri = xf->first[h]; ri >= 0; ri = xf->rule[ri].next) {
+	const struct xform_rule_t *r = &xf->rule[ri];
+	int s;
+
+	if ((r->talker[0] != '\0' && strncmp(tag, r->talker, 2) != 0)
+	    || !xform_port(r, session, port))
+	    continue;
+
+	if (!split) {
+	    /* fields end at a comma, the checksum, the line end or len */
+	    const char *p = in + 1, *end = in + len;
+
+	    while (nf < XFORM_FIELDS) {
+		field[nf] = p;
+		while (p < end && *p != ',' && *p != '*' && *p != '\r'
+		       && *p != '\n')
+		    p++;
+		flen[nf] = (size_t)(p - field[nf]);
+		nf++;
+		if (p >= end || *p != ',')
+		    break;
+		p++;
+	    }
+	    if (nf == XFORM_FIELDS && p < end && *p == ',')
+		return xform_pass;	/* more fields than we can rebuild */
+	    split = true;
+	}
+
+	for (s = 0; s < r->nsteps; s++) {
+	    const struct xform_step_t *st = &r->step[s];
+	    double v = 0;
+	    int t;
+
+	    if (st->set) {
+		while (nf <= st->field) {
+		    field[nf] = "";
+		    flen[nf++] = 0;
+		}
+		field[st->field] = st->text;
+		flen[st->field] = strlen(st->text);
+		continue;
+	    }
+	    for (t = 0; t < st->nterms; t++) {
+		const struct xform_term_t *tm = &st->term[t];
+		char num[XFORM_NAMELEN];
+
+		if (tm->kind == term_const)
+		    v += tm->k;
+		else if (tm->kind == term_var)
+		    v += tm->k * xform_get(xf, tm->index);
+		else if (tm->index < nf && flen[tm->index] > 0
+			 && flen[tm->index] < sizeof(num)) {
+		    (void)memcpy(num, field[tm->index], flen[tm->index]);
+		    num[flen[tm->index]] = '\0';
+		    v += tm->k * safe_atof(num);
+		} else
+		    break;
+	    }
+	    if (t < st->nterms)
+		continue;	/* a field it needs is empty */
+	    if (st->field == 0)
+		xform_set(xf, st->var, v);
+	    else {
+		int decimals = r->decimals;
+
+		if (r->modulo > 0) {
+		    v = fmod(v, r->modulo);
+		    if (v < 0)
+			v += r->modulo;
+		}
+		if (decimals < 0) {
+		    const char *dot = NULL;
+
+		    if (st->field < nf)
+			dot = memchr(field[st->field], '.', flen[st->field]);
+		    decimals = (dot == NULL) ? 0 : (int)(field[st->field]
+						+ flen[st->field] - dot - 1);
+		}
+		while (nf <= st->field) {
+		    field[nf] = "";
+		    flen[nf++] = 0;
+		}
+		flen[st->field] = (size_t)snprintf(fbuf[st->field],
+						   sizeof(fbuf[0]), "%.*f",
+						   decimals, v);
+		if (flen[st->field] >= sizeof(fbuf[0]))
+		    flen[st->field] = sizeof(fbuf[0]) - 1;
+		field[st->field] = fbuf[st->field];
+	    }
+	}
+	if (r->rename[0] != '\0') {
+	    (void)strlcpy(tag, r->rename, sizeof(tag));
+	    field[0] = tag;
+	    flen[0] = strlen(tag);
+	}
+	if (r->drop) {
+	    if (session != NULL)
+		gpsd_report(session->context->debug, LOG_IO,
+			    "XFORM: %s dropped by %s\n", tag, r->name);
+	    return xform_drop;
+	}
+    }
+    if (!split)
+	return xform_pass;
+
+    /* put it back together, with a fresh checksum */
+    n = 0;
+    out[n++] = '$';
+    for (i = 0; i < (size_t)nf; i++) {
+	size_t j;
+
+	if (n + flen[i] + 7 > outlen || n + flen[i] + 7 > NMEA_MAX)
+	    return xform_pass;
+	if (i > 0)
+	    out[n++] = ',';
+	for (j = 0; j < flen[i]; j++)
+	    out[n++] = field[i][j];
+    }
+    for (i = 1; i < n; i++)
+	sum ^= (unsigned char)out[i];
+    (void)snprintf(out + n, outlen - n, "*%02X\r\n", sum & 0xff);
+    if (session != NULL)
+	gpsd_report(session->context->debug, LOG_IO,
+		    "XFORM: %.*s -> %s", (int)len, in, out);
+    return xform_rewrite;
+}
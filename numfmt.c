@@ -0,0 +1,156 @@
+/****************************************************************************
+
+NAME
+   numfmt.c - printf-compatible number conversion for the report writers
+
+DESCRIPTION
+   The JSON, pseudo-NMEA and SignalK writers turn a handful of number
+shapes into text over and over: fixed decimals, zero-padded integers,
+NMEA DDMM.mmmm coordinates and integers that carry an implied decimal
+point.  Going through printf for each of them means a trip through the
+format interpreter and, on some C libraries, the locale machinery, which
+is where a busy translating daemon spends its time.
+
+   Every routine here produces exactly what the printf conversion named
+in its comment would, and has snprintf's contract: at most len-1
+characters plus a NUL are stored and the length of the full conversion
+is returned.  numfmt_fixed() hands a value to snprintf when it is so
+close to a rounding boundary that the scaled double can't be trusted to
+round the way the C library's exact conversion does.
+
+PERMISSIONS
+  This file is Copyright (c) 2010 by the GPSD project
+  BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+#define NUMFMT_MAXWIDTH	32	/* wider fields are left to snprintf */
+
+static const double numfmt_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+};
+
+static int numfmt_copy(char *buf, size_t len, const char *s, size_t n)
+/* store a finished conversion the way snprintf would */
+{
+    if (len > 0) {
+	size_t m = n < len ? n : len - 1;
+
+	(void)memcpy(buf, s, m);
+	buf[m] = '\0';
+    }
+    return (int)n;
+}
+
+static char *numfmt_digits(char *end, unsigned long long v, int decimals,
+			   int width, bool negative)
+/* lay v out leftwards from end, with an implied point and zero padding */
+{
+    char *p = end;
+    int i;
+
+    for (i = 0; i < decimals; i++) {
+	*--p = (char)('0' + (int)(v % 10));
+	v /= 10;
+    }
+    if (decimals > 0)
+	*--p = '.';
+    do {
+	*--p = (char)('0' + (int)(v % 10));
+	v /= 10;
+    } while (v != 0);
+    if (negative)
+	width--;
+    while (end - p < width)
+	*--p = '0';
+    if (negative)
+	*--p = '-';
+    return p;
+}
+
+int numfmt_uint(char *buf, size_t len, unsigned long long v, int width)
+/* %0*llu */
+{
+    char tmp[NUMFMT_MAXWIDTH + 24];
+    char *end = tmp + sizeof(tmp), *p;
+
+    if (width > NUMFMT_MAXWIDTH)
+	return snprintf(buf, len, "%0*llu", width, v);
+    p = numfmt_digits(end, v, 0, width, false);
+    return numfmt_copy(buf, len, p, (size_t)(end - p));
+}
+
+int numfmt_int(char *buf, size_t len, long long v, int width)
+/* %0*lld */
+{
+    char tmp[NUMFMT_MAXWIDTH + 24];
+    char *end = tmp + sizeof(tmp), *p;
+
+    if (width > NUMFMT_MAXWIDTH)
+	return snprintf(buf, len, "%0*lld", width, v);
+    p = numfmt_digits(end, v < 0 ? 0ULL - (unsigned long long)v
+		      : (unsigned long long)v, 0, width, v < 0);
+    return numfmt_copy(buf, len, p, (size_t)(end - p));
+}
+
+int numfmt_scaled(char *buf, size_t len, long long units, int decimals)
+/* %.*f of units / 10^decimals, computed exactly */
+{
+    char tmp[NUMFMT_MAXWIDTH + 24];
+    char *end = tmp + sizeof(tmp), *p;
+
+    if (decimals < 0)
+	decimals = 0;
+    else if (decimals > NUMFMT_MAXWIDTH)
+	decimals = NUMFMT_MAXWIDTH;
+    p = numfmt_digits(end, units < 0 ? 0ULL - (unsigned long long)units
+		      : (unsigned long long)units, decimals, 0, units < 0);
+    return numfmt_copy(buf, len, p, (size_t)(end - p));
+}
+
+int numfmt_fixed(char *buf, size_t len, double x, int width, int decimals)
+/* %0*.*f; a width of 0 means no padding */
+{
+    char tmp[NUMFMT_MAXWIDTH + 24];
+    char *end = tmp + sizeof(tmp), *p;
+    double scaled, whole, frac;
+
+    if (decimals >= 0 && decimals < (int)NITEMS(numfmt_pow10)
+	&& width <= NUMFMT_MAXWIDTH && isfinite(x) != 0) {
+	scaled = fabs(x) * numfmt_pow10[decimals];
+	if (scaled < 1e15) {
+	    whole = floor(scaled);
+	    frac = scaled - whole;
+	    /*
+	     * The multiplication may be off by half an ulp of the result;
+	     * if that could move the value across the .5 that decides the
+	     * rounding, let the C library do the exact conversion.
+	     */
+	    if (fabs(frac - 0.5) > scaled * 2.5e-16 + 1e-300) {
+		p = numfmt_digits(end, (unsigned long long)whole
+				  + (frac > 0.5 ? 1 : 0),
+				  decimals, width, signbit(x) != 0);
+		return numfmt_copy(buf, len, p, (size_t)(end - p));
+	    }
+	}
+    }
+    return snprintf(buf, len, "%0*.*f", width, decimals, x);
+}
+
+int numfmt_dm(char *buf, size_t len, double degrees, int width)
+/* |degrees| as NMEA DDMM.mmmm, zero-padded to width like %0*.4f */
+{
+    double angle = fabs(degrees), integer;
+    double fraction = modf(angle, &integer);
+
+    return numfmt_fixed(buf, len, floor(angle) * 100 + fraction * 60,
+			width, 4);
+}
+
+/* numfmt.c ends here */
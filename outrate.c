@@ -0,0 +1,422 @@
+/*
+ * outrate.c - pace what gpsd writes to its output devices
+ *
+ * A 10Hz GPS turned into NMEA 2000 and NMEA 0183 would otherwise put
+ * every position, course and heading on the bus as often as it comes
+ * in, which is more than a 250kbit/s CAN bus likes and far more than a
+ * 4800 baud NMEA 0183 listener can take.  Each output device keeps a
+ * slot per PGN and instance, or per sentence type, that has a rule.
+ * The latest frame offered goes out as soon as the rule's minimum
+ * interval has passed since the last; until then it is held, and
+ * anything newer replaces it.  A frame identical to the last one sent
+ * is only repeated after the rule's maximum interval, so data that
+ * does not change goes out at a slower cadence.
+ *
+ * The default rules follow the NMEA 2000 default transmission
+ * intervals, and for NMEA 0183 what fits 4800 baud.  Configuration
+ * sections change them, for all outputs or for one.
+ *
+ * The controller also keeps the load of every output: frames and bytes
+ * written, and the share of the link's capacity used per second.  A
+ * NMEA 2000 frame costs its CAN frames of 131 bits each, a NMEA 0183
+ * character 10 bits.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "gpsd.h"
+#include "bits.h"
+
+#define OUTRATE_INSTANCE	0x7f000000u	/* key bits for the instance */
+#define N2K_HEADER		7	/* PGN, priority, source, destination */
+#define CAN_FRAME_BITS		131	/* extended data frame, 8 bytes */
+#define OUTRATE_SLACK		0.002	/* seconds early that still will do */
+
+/* *INDENT-OFF* */
+static const struct {
+    const char *match;
+    unsigned int min_ms, max_ms;
+} outrate_defaults[] = {
+    /* NMEA 2000 default transmission intervals */
+    {"126992", 1000, 0},	/* system time */
+    {"127245",  100, 0},	/* rudder */
+    {"127250",  100, 0},	/* heading */
+    {"127251",  100, 0},	/* rate of turn */
+    {"127257", 1000, 0},	/* attitude */
+    {"127258", 1000, 5000},	/* magnetic variation */
+    {"127488",  100, 0},	/* engine, rapid */
+    {"127489",  500, 2000},	/* engine, dynamic */
+    {"128259", 1000, 0},	/* speed */
+    {"128267", 1000, 0},	/* depth */
+    {"128275", 1000, 5000},	/* distance log */
+    {"129025",  100, 0},	/* position, rapid */
+    {"129026",  250, 0},	/* COG and SOG, rapid */
+    {"129029", 1000, 0},	/* GNSS position */
+    {"129033", 1000, 0},	/* time and date */
+    {"129283", 1000, 0},	/* cross track error */
+    {"129284", 1000, 0},	/* navigation data */
+    {"129539", 1000, 5000},	/* DOPs */
+    {"130306",  100, 0},	/* wind */
+    {"130310",  500, 2000},	/* water and air temperature */
+    {"130311",  500, 2000},	/* environmental parameters */
+    /* NMEA 0183, sized for 4800 baud */
+    {"RMC", 1000, 0},
+    {"GGA", 1000, 0},
+    {"GLL", 1000, 0},
+    {"GNS", 1000, 0},
+    {"GSA", 1000, 5000},
+    {"VTG", 1000, 0},
+    {"ZDA", 1000, 0},
+    {"HDG",  200, 0},
+    {"HDM",  200, 0},
+    {"HDT",  200, 0},
+    {"ROT",  500, 0},
+    {"RSA",  500, 0},
+    {"MWV",  500, 0},
+    {"DBT", 1000, 0},
+    {"DPT", 1000, 0},
+    {"VHW", 1000, 0},
+    {"VLW", 1000, 5000},
+    {"MTW", 2000, 10000},
+    {"XTE", 1000, 0},
+    {"RMB", 1000, 0},
+};
+/* *INDENT-ON* */
+
+static uint32_t outrate_match(const char *match)
+/* the key a rule matches: a PGN, or a sentence type without talker */
+{
+    char *end;
+    unsigned long pgn;
+
+    if (isdigit((unsigned char)match[0])) {
+	pgn = strtoul(match, &end, 10);
+	if (*end != '\0' || pgn == 0 || pgn > 0x1ffff)
+	    return 0;
+	return (uint32_t)pgn;
+    }
+    if (strlen(match) != 3 || !isupper((unsigned char)match[0])
+	|| !isupper((unsigned char)match[1])
+	|| !isupper((unsigned char)match[2]))
+	return 0;
+    return OUTRATE_SENTENCE | ((uint32_t)match[0] << 16)
+	| ((uint32_t)match[1] << 8) | (uint32_t)match[2];
+}
+
+bool outrate_set(struct outrate_rules_t *rules, const char *match,
+		 int device, unsigned int min_ms, unsigned int max_ms)
+/* add a rule, or change the one for the same key and output */
+{
+    uint32_t key = outrate_match(match);
+    int i;
+
+    if (key == 0 || (max_ms != 0 && max_ms < min_ms))
+	return false;
+    for (i = 0; i < rules->count; i++)
+	if (rules->rule[i].key == key && rules->rule[i].device == device)
+	    break;
+    if (i == rules->count) {
+	if (rules->count == OUTRATE_RULES)
+	    return false;
+	rules->count++;
+    }
+    rules->rule[i].key = key;
+    rules->rule[i].device = device;
+    rules->rule[i].min_ms = min_ms;
+    rules->rule[i].max_ms = max_ms;
+    return true;
+}
+
+void outrate_init(struct outrate_rules_t *rules)
+{
+    size_t i;
+
+    rules->count = 0;
+    for (i = 0; i < sizeof(outrate_defaults) / sizeof(outrate_defaults[0]);
+	 i++)
+	(void)outrate_set(rules, outrate_defaults[i].match, -1,
+			  outrate_defaults[i].min_ms,
+			  outrate_defaults[i].max_ms);
+}
+
+uint32_t outrate_key(int kind, const char *frame, size_t len)
+/* what a frame is paced by; 0 for frames that are never paced */
+{
+    const unsigned char *bu = (const unsigned char *)frame;
+
+    if (kind == OUTRATE_N2K) {
+	const struct n2k_pgn_t *p;
+	uint32_t pgn;
+	int instance;
+
+	if (len < N2K_HEADER)
+	    return 0;
+	pgn = getleu32(bu, 0);
+	if (pgn == 0 || pgn > 0x1ffff)
+	    return 0;
+	/* wind by reference, temperature by source, engine by instance */
+	p = n2k_schema_find(pgn);
+	instance = p != NULL ?
+	    n2k_instance(p, bu + N2K_HEADER, (int)len - N2K_HEADER) : -1;
+	if (instance >= 0 && instance < 0x7f)
+	    pgn |= (uint32_t)(instance + 1) << 24;
+	return pgn;
+    }
+
+    /* $ttSSS, or proprietary and encapsulated sentences we leave be */
+    if (len < 7 || bu[0] != '$' || bu[1] == 'P'
+	|| (bu[6] != ',' && bu[6] != '*'))
+	return 0;
+    if (!isupper(bu[3]) || !isupper(bu[4]) || !isupper(bu[5]))
+	return 0;
+    /* relative and true wind are different data */
+    if (memcmp(bu + 3, "MWV,", 4) == 0) {
+	const unsigned char *c = memchr(bu + 7, ',', len - 7);
+
+	if (c != NULL && c + 1 < bu + len && isupper(c[1]))
+	    return OUTRATE_SENTENCE | ((uint32_t)c[1] << 24)
+		| ((uint32_t)bu[3] << 16) | ((uint32_t)bu[4] << 8) | bu[5];
+    }
+    return OUTRATE_SENTENCE
+	| ((uint32_t)bu[3] << 16) | ((uint32_t)bu[4] << 8) | bu[5];
+}
+
+static struct outrate_slot_t *outrate_slot(struct outrate_t *o,
+					   const struct outrate_rules_t *rules,
+					   int device, uint32_t key)
+/* the slot for a key, taken on first use if a rule covers it */
+{
+    const struct outrate_rule_t *rule = NULL;
+    struct outrate_slot_t *s;
+    int i;
+
+    for (i = 0; i < o->nslots; i++)
+	if (o->slot[i].key == key)
+	    return &o->slot[i];
+    if (rules == NULL || o->nslots == OUTRATE_SLOTS)
+	return NULL;
+    /* a rule for this output wins over one for all of them */
+    for (i = 0; i < rules->count; i++)
+	if (rules->rule[i].key == (key & ~OUTRATE_INSTANCE)) {
+	    if (rules->rule[i].device == device) {
+		rule = &rules->rule[i];
+		break;
+	    }
+	    if (rules->rule[i].device == -1)
+		rule = &rules->rule[i];
+	}
+    if (rule == NULL)
+	return NULL;
+    s = &o->slot[o->nslots++];
+    s->key = key;
+    s->min_ms = rule->min_ms;
+    s->max_ms = rule->max_ms;
+    s->dirty = false;
+    s->len = 0;
+    s->sent = 0;
+    return s;
+}
+
+static inline timestamp_t outrate_next(const struct outrate_slot_t *s)
+/* when a slot may send again */
+{
+    return s->sent + s->min_ms / 1000.0 - OUTRATE_SLACK;
+}
+
+static inline void outrate_sent(struct outrate_slot_t *s, timestamp_t now)
+/*
+ * Keep to the cadence while the source keeps up, so that what comes in
+ * a little early and is sent by outrate_due() does not push every later
+ * frame back by the lag.
+ */
+{
+    double interval = s->min_ms / 1000.0;
+
+    s->dirty = false;
+    if (now - s->sent < 2 * interval)
+	s->sent += interval;
+    else
+	s->sent = now;
+}
+
+bool outrate_offer(struct outrate_t *o, const struct outrate_rules_t *rules,
+		   int device, int kind, const char *frame, size_t len,
+		   timestamp_t now)
+/* true if a frame is to go out now; if not, it is held or not needed */
+{
+    uint32_t key = outrate_key(kind, frame, len);
+    struct outrate_slot_t *s;
+    bool same;
+
+    if (key == 0 || len > OUTRATE_FRAME_MAX
+	|| (s = outrate_slot(o, rules, device, key)) == NULL)
+	return true;
+
+    same = s->len == len && memcmp(s->frame, frame, len) == 0;
+    if (!same) {
+	if (s->dirty)
+	    o->kind[kind].coalesced++;
+	memcpy(s->frame, frame, len);
+	s->len = (unsigned char)len;
+	s->dirty = true;
+    } else if (s->max_ms == 0)
+	s->dirty = true;
+
+    if (s->dirty) {
+	if (now >= outrate_next(s)) {
+	    outrate_sent(s, now);
+	    return true;
+	}
+	o->kind[kind].held++;
+	return false;
+    }
+    /* unchanged since it was last sent */
+    if ((now - s->sent) * 1000 >= s->max_ms) {
+	s->sent = now;
+	o->kind[kind].repeated++;
+	return true;
+    }
+    return false;
+}
+
+int outrate_pace(struct outrate_t *o, const struct outrate_rules_t *rules,
+		 int device, int kind, const char *buf, const size_t *lens,
+		 int count, char *out, size_t *outlens, timestamp_t now)
+/*
+ * Offer frames back to back in buf, copying the ones to go out now to
+ * out (OUTRATE_BUF bytes, OUTRATE_FRAMES frames).  NMEA 0183 frames
+ * may hold several sentences, which are paced one by one.  Returns the
+ * frames in out, or -1 when the input does not fit and must go out as
+ * it is.
+ */
+{
+    size_t used = 0, total = 0;
+    int i, n = 0;
+
+    for (i = 0; i < count; i++)
+	total += lens[i];
+    if (total > OUTRATE_BUF || count > OUTRATE_FRAMES)
+	return -1;
+
+    for (i = 0; i < count; buf += lens[i++]) {
+	const char *p = buf, *end = buf + lens[i];
+
+	while (p < end) {
+	    const char *nl;
+	    size_t len;
+
+	    if (kind == OUTRATE_NMEA
+		&& (nl = memchr(p, '\n', (size_t)(end - p))) != NULL)
+		len = (size_t)(nl + 1 - p);
+	    else
+		len = (size_t)(end - p);
+	    if (n == OUTRATE_FRAMES)
+		return -1;
+	    if (outrate_offer(o, rules, device, kind, p, len, now)) {
+		memcpy(out + used, p, len);
+		outlens[n++] = len;
+		used += len;
+	    }
+	    p += len;
+	}
+    }
+    return n;
+}
+
+int outrate_due(struct outrate_t *o, int kind, char *out, size_t *outlens,
+		timestamp_t now)
+/* the held frames of a kind whose time has come, as outrate_pace() */
+{
+    size_t used = 0;
+    int i, n = 0;
+
+    for (i = 0; i < o->nslots; i++) {
+	struct outrate_slot_t *s = &o->slot[i];
+
+	if (!s->dirty
+	    || ((s->key & OUTRATE_SENTENCE) != 0) != (kind == OUTRATE_NMEA)
+	    || now < outrate_next(s))
+	    continue;
+	memcpy(out + used, s->frame, s->len);
+	outlens[n++] = s->len;
+	used += s->len;
+	outrate_sent(s, now);
+    }
+    return n;
+}
+
+timestamp_t outrate_wake(const struct outrate_t *o)
+/* when the next held frame is due, 0 if none is held */
+{
+    timestamp_t wake = 0;
+    int i;
+
+    for (i = 0; i < o->nslots; i++) {
+	const struct outrate_slot_t *s = &o->slot[i];
+	timestamp_t due = outrate_next(s);
+
+	if (s->dirty && (wake == 0 || due < wake))
+	    wake = due;
+    }
+    return wake;
+}
+
+void outrate_count(struct outrate_t *o, int kind, const size_t *lens,
+		   int count, timestamp_t now)
+/* account for frames written, and close the load window each second */
+{
+    struct outrate_load_t *l = &o->kind[kind];
+    int i;
+
+    if (l->window == 0)
+	l->window = now;
+    for (i = 0; i < count; i++) {
+	l->frames++;
+	l->bytes += lens[i];
+	if (kind == OUTRATE_N2K) {
+	    size_t payload = lens[i] > N2K_HEADER ? lens[i] - N2K_HEADER : 0;
+
+	    /* a fast packet carries 6 bytes, then 7 per CAN frame */
+	    l->bits += CAN_FRAME_BITS * (payload <= 8 ? 1 : 1 + payload / 7);
+	} else
+	    l->bits += 10.0 * lens[i];
+    }
+    if (now - l->window >= 1.0) {
+	l->load = l->capacity > 0 ?
+	    l->bits / (l->capacity * (now - l->window)) : 0;
+	if (l->load > l->peak)
+	    l->peak = l->load;
+	l->bits = 0;
+	l->window = now;
+    }
+}
+
+size_t outrate_json_dump(const struct outrate_t *o, char *reply,
+			 size_t replylen)
+/* append the load of an output, as a JSON object */
+{
+    static const char *names[OUTRATE_KINDS] = {"n2k", "nmea"};
+    size_t start = strlen(reply);
+    int k;
+
+    (void)strlcat(reply, "{", replylen);
+    for (k = 0; k < OUTRATE_KINDS; k++) {
+	const struct outrate_load_t *l = &o->kind[k];
+
+	(void)snprintf(reply + strlen(reply), replylen - strlen(reply),
+		       "\"%s\":{\"frames\":%lu,\"bytes\":%lu,\"held\":%lu,"
+		       "\"coalesced\":%lu,\"repeated\":%lu,\"load\":%.3f,"
+		       "\"peak\":%.3f},",
+		       names[k], l->frames, l->bytes, l->held,
+		       l->coalesced, l->repeated, l->load, l->peak);
+    }
+    if (reply[strlen(reply) - 1] == ',')
+	reply[strlen(reply) - 1] = '\0';
+    (void)strlcat(reply, "}", replylen);
+    return strlen(reply) - start;
+}
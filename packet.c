@@ -1477,11 +1477,11 @@ void packet_parse(struct gps_packet_t *lexer)
 	/*@ -modobserver @*/
 	unsigned char c = *lexer->inbufptr++;
 	/*@ +modobserver @*/
-	char *state_table[] = {
+	static const char *state_table[] = {
 #include "packet_names.h"
 	};
 	nextstate(lexer, c);
-	gpsd_report(lexer->debug, LOG_RAW + 2,
+	GPSD_LOG(LOG_RAW + 2, lexer->debug,
 		    "%08ld: character '%c' [%02x], new state: %s\n",
 		    lexer->char_counter, (isprint(c) ? c : '.'), c,
 		    state_table[lexer->state]);
@@ -2103,6 +2103,9 @@ ssize_t packet_get(int fd, struct gps_packet_t *lexer)
     recvd = read(fd, lexer->inbuffer + lexer->inbuflen,
 		 sizeof(lexer->inbuffer) - (lexer->inbuflen));
     /*@ +modobserver @*/
+    TRACE_EVENT(TRACE_READ, fd, recvd, 0);
+    if (recvd > 0)
+	lexer->rx_ns = monotonic_ns();
     if (recvd == -1) {
 	if ((errno == EAGAIN) || (errno == EINTR)) {
 	    gpsd_report(lexer->debug, LOG_RAW + 2, "no bytes ready\n");
@@ -2114,7 +2117,7 @@ ssize_t packet_get(int fd, struct gps_packet_t *lexer)
 	    return -1;
 	}
     } else {
-	if (lexer->debug >= LOG_IO) {
+	if (LOG_SUBACTIVE(LOG_SUB_CORE, LOG_IO, lexer->debug)) {
 	    char scratchbuf[MAX_PACKET_LENGTH*2+1];
 	    gpsd_external_report(lexer->debug, LOG_IO,
 			"Read %zd chars to buffer offset %zd (total %zd): %s\n",
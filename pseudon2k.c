@@ -12,13 +12,14 @@
 
 #include "pseudon2k.h"
 
-int n2k_dump(struct gps_device_t *session, uint32_t pgn, uint8_t *bu, size_t len,
-                    void (*write_handler)(struct gps_device_t *, enum frm_type_t, const char *, size_t));
 /**
  *  \file pseudon2k.c contains all functions around creating N2K sentences
  *
  *  @page vy_topgns PGNs generated
  *  @brief This page shows all PGNs that are used to generate N2K sentences.
+ *
+ *  The PGNs in n2kgen.py's schema are not encoded here but by
+ *  n2k_encode(), from the same tables the drivers decode them with.
  */
 
 /**
@@ -53,245 +54,6 @@ void n2k_binary_126992_dump(struct gps_device_t *session, uint32_t *pgn,
     *pgn = 126992;
 }
 
-/**
- *   \TOPGN 127250: NAV Vessel Heading
- */
-void n2k_binary_127250_dump(struct gps_device_t *session, uint32_t *pgn,
-                         enum compass_t compass,
-                         uint8_t bu[], size_t len, uint16_t * outlen)
-{
-
-    if(len < 8) return;
-
-    bu[0] = 0x14; // some sid
-
-    if (!isnan(session->gpsdata.navigation.heading[compass]))
-        set8les16(bu,
-                  session->gpsdata.navigation.heading[compass] / 0.0001 / RAD_2_DEG, 1);
-    else
-        set8les16(bu, 0xffff, 1);
-
-    if (!isnan(session->gpsdata.environment.deviation))
-        set8les16(bu,
-                  session->gpsdata.environment.deviation / 0.0001 / RAD_2_DEG, 3);
-    else
-        set8les16(bu, 0xffff, 3);
-
-    if (!isnan(session->gpsdata.environment.variation))
-        set8les16(bu,
-                  session->gpsdata.environment.variation / 0.0001 / RAD_2_DEG,
-                  5);
-
-    else
-        set8les16(bu, 0xffff, 5);
-
-    // 1: magnetic, 0: true
-    bu[7] = compass;
-
-  *outlen = 8;
-  *pgn = 127250;
-}
-
-void n2k_binary_hdg_magnetic_dump(struct gps_device_t *session, uint32_t *pgn,
-                         uint8_t bu[], size_t len, uint16_t * outlen)
-{
-    n2k_binary_127250_dump(session, pgn,
-                         compass_magnetic,
-                        bu, len, outlen);
-}
-
-void n2k_binary_hdg_true_dump(struct gps_device_t *session, uint32_t *pgn,
-                         uint8_t bu[], size_t len, uint16_t * outlen)
-{
-    n2k_binary_127250_dump(session, pgn,
-                         compass_true,
-                        bu, len, outlen);
-}
-
-/**
- *  \todo PGN 127251: Rate of Turn
- *
- *  NAVIGATION_SET: NAV_ROT_PSET
- */
-void n2k_binary_127251_dump(struct gps_device_t *session, uint32_t *pgn,
-                            uint8_t bu[], size_t len, uint16_t * outlen) {
-
-    if(len < 8) return;
-
-    bu[0] = 0x14; // some sid
-
-    if (!isnan(session->gpsdata.navigation.rate_of_turn)) {
-        // TODO : find explain for odd magic number 3/16 deg/min (or 3/16/60 in deg/sec)
-        set8les32(bu, session->gpsdata.navigation.rate_of_turn
-                  / (0.00001 * 3.0/16.0/60.0 * RAD_2_DEG), 1);
-                  // per sec, let compiler optimize
-    }
-
-    *outlen = 8;
-    *pgn = 127251;
-}
-
-
-/**
- *   \TOPGN 127257: Attitude
- */
-void n2k_binary_attitude_dump(struct gps_device_t *session,uint32_t *pgn,
-                                uint8_t bu[], size_t len, uint16_t * outlen)
-{
-    if(len < 8) return;
-
-    bu[0] = 0x14; // some sid
-
-    if(!(session->gpsdata.set & ATTITUDE_SET)) {
-        *outlen = 0;
-        return;
-    }
-
-    if (!isnan(session->gpsdata.attitude.yaw))
-        set8les16(bu,
-                  session->gpsdata.attitude.yaw / 0.0001 / RAD_2_DEG, 1);
-    else
-        set8les16(bu, 0xffff, 1);
-
-    if (!isnan(session->gpsdata.attitude.pitch))
-        set8les16(bu,
-                  session->gpsdata.attitude.pitch / 0.0001 / RAD_2_DEG, 3);
-    else
-        set8les16(bu, 0xffff, 3);
-
-    if (!isnan(session->gpsdata.attitude.roll))
-        set8les16(bu,
-                  session->gpsdata.attitude.roll / 0.0001 / RAD_2_DEG, 5);
-    else
-        set8les16(bu, 0xffff, 5);
-
-    *outlen = 8;
-    *pgn = 127257;
-
-}
-
-/**
- *  \todo PGN 127258: GNSS Magnetic Variation
- */
-void n2k_binary_127258_dump(struct gps_device_t *session UNUSED, uint32_t *pgn,
-                            uint8_t bu[] UNUSED, size_t len UNUSED, uint16_t * outlen) {
-    *outlen = 8;
-    *pgn = 127258;
-}
-
-/**
- *  \todo PGN 128259: NAV Speed
- */
-void n2k_binary_127259_dump(struct gps_device_t *session UNUSED, uint32_t *pgn,
-                            uint8_t bu[] UNUSED, size_t len UNUSED, uint16_t * outlen) {
-    *outlen = 8;
-    *pgn = 127259;
-}
-
-/*
- *   \todo PGN 127488: Engine Parameter Rapid Update
- */
-void n2k_binary_127488_dump(struct gps_device_t *session, uint32_t *pgn,
-                            uint8_t bu[], size_t len, uint16_t * outlen)
-{
-    uint8_t instance = 0;
-
-    if(len < 8) return;
-
-
-    // engine instance
-    if(session->gpsdata.engine.set & ENG_PORT_PSET) {
-        instance = 0;
-    } else if(session->gpsdata.engine.set & ENG_STARBOARD_PSET) {
-        instance = 1;
-    } else
-        return;
-
-    bu[0] = instance;
-
-    if(session->gpsdata.engine.set & ENG_SPEED_PSET)
-        set8leu16(bu, session->gpsdata.engine.instance[instance].speed/0.25, 1);
-    else
-        set8leu16(bu, 0xffff, 1);
-
-
-    if(session->gpsdata.engine.set & ENG_BOOST_PRESSURE_PSET)
-        set8leu16(bu, session->gpsdata.engine.instance[instance].boost_pressure/100.0, 3);
-    else
-        set8leu16(bu, 0xffff, 3);
-
-    if(session->gpsdata.engine.set & ENG_TILT_PSET)
-        set8leu8(bu, session->gpsdata.engine.instance[instance].tilt, 6);
-    else
-        set8leu8(bu, 0xff, 6);
-
-    *outlen = 8;
-    *pgn = 127488;
-}
-
-/*
- *   \todo PGN 127489: Engine Parameter Dynamic
- */
-void n2k_binary_127489_dump(struct gps_device_t *session UNUSED, uint32_t *pgn,
-                            uint8_t bu[] UNUSED, size_t len, uint16_t * outlen)
-{
-    if(len < 8) return;
-
-
-
-    *outlen = 8;
-    *pgn = 127489;
-}
-
-/**
- *   \TOPGN 128267: NAV Water Depth
- */
-void n2k_binary_128267_dump(struct gps_device_t *session, uint32_t *pgn,
-                                uint8_t bu[], size_t len, uint16_t * outlen)
-{
-    if(len < 8) return;
-
-    bu[0] = 0x14;
-
-    if (!isnan(session->gpsdata.navigation.depth))
-        set8leu32(bu, (uint32_t)(session->gpsdata.navigation.depth/.01), 1);
-    else
-        set8leu32(bu, (uint32_t)(0xffffffff), 1);
-
-    if (!isnan(session->gpsdata.navigation.depth_offset))
-        set8les16(bu, (int16_t)(session->gpsdata.navigation.depth_offset/.001), 5);
-    else
-        set8les16(bu, (int16_t)(0x7fff), 5);
-
-    *outlen = 8;
-    *pgn = 128267;
-}
-
-/**
- *  \TOPGN 128275: NAV Distance Log
- */
-void n2k_binary_128275_dump(struct gps_device_t *session, uint32_t *pgn,
-                            uint8_t bu[], size_t len UNUSED, uint16_t * outlen) {
-
-    set8leu16(bu, (uint16_t)0xffff, 0);  /// \todo date
-    set8leu32(bu, (uint32_t)0xffffffff, 2); /// \todo time
-
-    if (!isnan(session->gpsdata.navigation.distance_total))
-        set8leu32(bu, (uint32_t)(session->gpsdata.navigation.distance_total/METERS_TO_NM), 6);
-    else
-        set8leu32(bu, (uint32_t)(0xffffffff), 6);
-
-    if (!isnan(session->gpsdata.navigation.distance_trip))
-        set8leu32(bu, (uint32_t)(session->gpsdata.navigation.distance_trip/METERS_TO_NM), 10);
-    else
-        set8leu32(bu, (uint32_t)(0xffffffff), 10);
-
-
-    *outlen = 14;
-    *pgn = 128275;
-}
-
-
 /**
  *  \TOPGN 129025: GNSS Position Rapid Update
  */
@@ -555,7 +317,7 @@ void n2k_binary_129539_dump(struct gps_device_t *session, uint32_t *pgn,
     set8les16(bu, session->gpsdata.dop.vdop / 1e-2, 4);
     set8les16(bu, session->gpsdata.dop.tdop / 1e-2, 6);
 
-    gpsd_report(session->context->debug, LOG_IO,
+    GPSD_SUBLOG(LOG_SUB_N2K, LOG_IO, session->context->debug,
                 "                   hdop:%5.2f vdop:%5.2f tdop:%5.2f req_mode:%u act_mode:%u\n",
                 session->gpsdata.dop.hdop,
                 session->gpsdata.dop.vdop,
@@ -599,73 +361,6 @@ void n2k_binary_129540_dump(struct gps_device_t *session, uint32_t *pgn,
 }
 
 
-/**
- *   \TOPGN 130306: Wind
- */
-void n2k_binary_130306_dump(struct gps_device_t *session, enum wind_reference_t wr, uint32_t *pgn,
-                                uint8_t bu[], size_t len, uint16_t * outlen)
-{
-    *pgn = 0;
-
-    if(len < 8) return;
-
-    if(!(session->gpsdata.set & ENVIRONMENT_SET)) {
-        *outlen = 0;
-        return;
-    }
-
-    /*  0=True North,
-        1=Magnetic North,
-        2=Apparent,
-        3=True to boat,
-        4=True to water */
-
-        double angle = session->gpsdata.environment.wind[wr].angle;
-        double speed = session->gpsdata.environment.wind[wr].speed;
-
-    bu[0] = 0x14;
-    set8leu16(bu, (uint16_t)(!isnan(speed)?speed/.01:0xffff), 1);
-    set8leu16(bu, (uint16_t)(!isnan(angle)?angle/RAD_2_DEG/0.0001:angle), 3);
-    bu[5] = wr; // setting the apparent wind flag
-    bu[6] = 0x00;
-
-    *outlen = 8;
-    *pgn = 130306;
-}
-
-/**
- *  \todo PGN 130311: NAV Environmental Parameters
- */
-void n2k_binary_130311_dump(struct gps_device_t *session, uint32_t *pgn,
-                            uint8_t bu[], size_t len, uint16_t * outlen) {
-    if(len < 8) return;
-
-    if(!(session->gpsdata.set & ENVIRONMENT_SET)) {
-        *outlen = 0;
-        return;
-    }
-
-    bu[0] = 0x14;
-    bu[1] = 0x00;
-    set8leu16(bu, 0xffff, 2);
-
-    if(session->gpsdata.environment.set & ENV_TEMP_WATER_PSET) {
-        set8leu16(bu, session->gpsdata.environment.temp[temp_water]/0.01, 2); // =  temp * 0.01 - 273.15;
-        bu[1] = 0 & (0x01 << 6); // temp inst water, obviously unnecessary bit op - just for doc
-    } else if(session->gpsdata.environment.set & ENV_TEMP_AIR_PSET) {
-        set8leu16(bu, session->gpsdata.environment.temp[temp_air]/0.01, 2); // =  temp * 0.01 - 273.15;
-        bu[1] = 1 & (0x01 << 6); // temp inst water, obviously unnecessary bit op - just for doc
-    }
-
-    // bu[1] |= xxx & (0x01 << 2);
-
-    set8leu16(bu, 0xffff, 4); // hum
-    set8leu16(bu, 0xffff, 6); // pres
-
-    *outlen = 8;
-    *pgn = 130311;
-}
-
 /**
  *  \todo PGN 130312: NAV Temperature
  */
@@ -788,28 +483,81 @@ int n2k_environment_dump(struct gps_device_t *session,
 }
 */
 
-int n2k_dump(struct gps_device_t *session, uint32_t pgn, uint8_t *bu, size_t len,
-                    void (*write_handler)(struct gps_device_t *, enum frm_type_t, const char *, size_t)) {
-    if(pgn) {
-        set8leu32(bu, pgn, 0);
-        bu[4] = 0x03; // prio
-        bu[5] = session->driver.nmea2000.own_src_id;
-        bu[6] = 0xff; // usually broadcast
+/**
+ *  A PGN from the schema n2kgen.py generates, encoded from what the
+ *  session holds; *pgn is 0 when there is nothing to send.
+ */
+void n2k_binary_schema_dump(struct gps_device_t *session, unsigned int number,
+                            unsigned int index, uint32_t *pgn,
+                            uint8_t bu[], size_t len, uint16_t * outlen)
+{
+    const struct n2k_pgn_t *p = n2k_schema_find(number);
 
-        write_handler(session, FRM_TYPE_NMEA2000, (const char *)bu, len + 7);
-    }
+    *pgn = 0;
+    *outlen = 0;
+    if(p == NULL)
+        return;
+    *outlen = (uint16_t)n2k_encode(p, &session->gpsdata, index, bu, len);
+    if(*outlen > 0)
+        *pgn = number;
+}
 
-    return 0;
+/* where the next payload goes, NULL when the batch has no room for it */
+static uint8_t *n2k_batch_next(struct n2k_batch_t *batch)
+{
+    if(batch->count >= N2K_BATCH_FRAMES
+       || batch->used + N2K_HEADER_LEN + N2K_PAYLOAD_MAX > N2K_BATCH_BYTES)
+        return NULL;
+    return batch->buf + batch->used + N2K_HEADER_LEN;
 }
+
+/* put the header on the payload just written and count the frame */
+static void n2k_batch_add(struct gps_device_t *session,
+                          struct n2k_batch_t *batch,
+                          uint32_t pgn, uint16_t written)
+{
+    uint8_t *bu = batch->buf + batch->used;
+
+    if(pgn == 0 || written == 0)
+        return;
+    set8leu32(bu, pgn, 0);
+    bu[4] = 0x03; // prio
+    bu[5] = session->driver.nmea2000.own_src_id;
+    bu[6] = 0xff; // usually broadcast
+
+    batch->len[batch->count++] = written + N2K_HEADER_LEN;
+    batch->used += written + N2K_HEADER_LEN;
+}
+
+#define N2K_BATCH_DUMP(call) do { \
+        uint8_t *bu = n2k_batch_next(batch); \
+        uint32_t pgn = 0; \
+        uint16_t written = 0; \
+        if(bu == NULL) { \
+            gpsd_report(session->context->debug, LOG_WARN, \
+                        "PSEUDON2K: batch full, frames dropped\n"); \
+            return batch->count; \
+        } \
+        call; \
+        n2k_batch_add(session, batch, pgn, written); \
+    } while (0)
+
+#define N2K_HAND_DUMP(fn) \
+    N2K_BATCH_DUMP(fn(session, &pgn, bu, N2K_PAYLOAD_MAX, &written))
+#define N2K_SCHEMA_DUMP(number, index) \
+    N2K_BATCH_DUMP(n2k_binary_schema_dump(session, number, index, &pgn, \
+                                          bu, N2K_PAYLOAD_MAX, &written))
+
+/**
+ *  Collect the PGNs for a change mask into batch, returning how many.
+ *  The PGNs with a schema are only sent when one of their fields is
+ *  available; the rest are still encoded by hand above.
+ */
 int n2k_binary_dump(gps_mask_t changed,
                     struct gps_device_t *session,
-                    void (*write_handler)(struct gps_device_t *, enum frm_type_t, const char *buf, size_t len))
+                    struct n2k_batch_t *batch)
 {
-    uint16_t written;
-    uint16_t len = 280;
-    uint8_t bu[280];
-    uint32_t pgn;
-    int i = 0;
+    unsigned int i;
 
     // get a copy of the masks to tick off
     gps_mask_t mask = changed,
@@ -817,65 +565,58 @@ int n2k_binary_dump(gps_mask_t changed,
         wpymask = session->gpsdata.waypoint.set,
         envmask = session->gpsdata.environment.set;
 
+    batch->count = 0;
+    batch->used = 0;
+
     // RMC 126992, 127250*, 127258, 129025, 129026, 129029, 129033
     if ((mask & TIME_SET) != 0) {
 
         if (session->newdata.mode > MODE_NO_FIX) {
-            n2k_binary_126992_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_HAND_DUMP(n2k_binary_126992_dump);
         } else {
-            n2k_binary_129033_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_HAND_DUMP(n2k_binary_129033_dump);
         }
 
     }
 
     if((mask & LATLON_SET) != 0) {
 
-        n2k_binary_129025_dump(session, &pgn, bu+7, len-7, &written);
-        n2k_dump(session, pgn, bu, written, write_handler);
-
-        n2k_binary_129029_dump(session, &pgn, bu+7, len-7, &written);
-        n2k_dump(session, pgn, bu, written, write_handler);
+        N2K_HAND_DUMP(n2k_binary_129025_dump);
+        N2K_HAND_DUMP(n2k_binary_129029_dump);
 
     }
 
     if ((mask & NAVIGATION_SET) != 0) {
 
-        if((navmask & NAV_DPT_PSET) != 0) {
-            n2k_binary_128267_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
-        }
-        if((navmask & NAV_ROT_PSET) != 0) {
-            n2k_binary_127251_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
-        }
+        N2K_SCHEMA_DUMP(128267, 0);
+        N2K_SCHEMA_DUMP(127251, 0);
+        N2K_SCHEMA_DUMP(128259, 0);
+        N2K_SCHEMA_DUMP(127245, 0);
+        N2K_SCHEMA_DUMP(128275, 0);
+        N2K_SCHEMA_DUMP(128000, 0);
+        N2K_SCHEMA_DUMP(129291, 0);
+
         if( (navmask & (NAV_COG_TRUE_PSET | NAV_COG_MAGN_PSET | NAV_SOG_PSET)) != 0 ) {
-            n2k_binary_129026_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_HAND_DUMP(n2k_binary_129026_dump);
         }
 
         if(navmask & NAV_HDG_MAGN_PSET) {
-            n2k_binary_hdg_magnetic_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_SCHEMA_DUMP(127250, compass_magnetic);
         }
 
         if(navmask & NAV_HDG_TRUE_PSET) {
-            n2k_binary_hdg_true_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_SCHEMA_DUMP(127250, compass_true);
         }
     }
 
     if(mask & WAYPOINT_SET) {
         if(wpymask & (WPY_XTE_PSET | WPY_ARRIVAL_STATUS_PSET)) {
-            n2k_binary_129283_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_HAND_DUMP(n2k_binary_129283_dump);
         }
         if(wpymask & (WPY_ACTIVE_TO_PSET | WPY_ACTIVE_FROM_PSET
             | WPY_LATLON_TO_PSET | WPY_RANGE_TO_PSET | WPY_BEARING_FROM_ORG_TO_PSET | WPY_BEARING_FROM_POS_TO_PSET
             | WPY_SPEED_FROM_ORG_TO_PSET | WPY_ARRIVAL_STATUS_PSET | WPY_ETA_PSET)) {
-            n2k_binary_129284_dump(session, &pgn, bu+7, len-7, &written);
-            n2k_dump(session, pgn, bu, written, write_handler);
+            N2K_HAND_DUMP(n2k_binary_129284_dump);
         }
     }
 
@@ -883,37 +624,30 @@ int n2k_binary_dump(gps_mask_t changed,
         if(!(navmask & (NAV_HDG_TRUE_PSET | NAV_HDG_MAGN_PSET))) {
             // if neither magn or true heading is set but we do have
             // variation/deviation then we want to report it here
-            if((mask & ENVIRONMENT_SET) & (envmask & (ENV_DEVIATION_PSET | ENV_VARIATION_PSET))) {
-                n2k_binary_hdg_true_dump(session, &pgn, bu+7, len-7, &written);
-                n2k_dump(session, pgn, bu, written, write_handler);
+            if(envmask & (ENV_DEVIATION_PSET | ENV_VARIATION_PSET)) {
+                N2K_SCHEMA_DUMP(127250, compass_true);
             }
         }
 
+        // one per wind reference, and per temperature source
+        for(i = 0; i < 5; i++)
+            N2K_SCHEMA_DUMP(130306, i);
+        N2K_SCHEMA_DUMP(130311, temp_water);
+        N2K_SCHEMA_DUMP(130311, temp_air);
+    }
 
-        static gps_mask_t angles[] = {
-            ENV_WIND_TRUE_NORTH_ANGLE_PSET,
-            ENV_WIND_MAGN_ANGLE_PSET,
-            ENV_WIND_APPARENT_ANGLE_PSET,
-            ENV_WIND_TRUE_TO_BOAT_ANGLE_PSET,
-            ENV_WIND_TRUE_TO_WATER_ANGLE_PSET
-        };
-
-        static gps_mask_t speeds[] = {
-            ENV_WIND_TRUE_NORTH_SPEED_PSET,
-            ENV_WIND_MAGN_ANGLE_PSET,
-            ENV_WIND_APPARENT_SPEED_PSET,
-            ENV_WIND_TRUE_TO_BOAT_SPEED_PSET,
-            ENV_WIND_TRUE_TO_WATER_SPEED_PSET
-        };
-
-        for(i = 0; i < 5; i++) {
-            if((session->gpsdata.environment.set & angles[i])
-               || (session->gpsdata.environment.set & speeds[i]) ) {
-                    n2k_binary_130306_dump(session, i, &pgn, bu+7, len-7, &written);
-                    n2k_dump(session, pgn, bu, written, write_handler);
-                }
+    if (mask & ATTITUDE_SET) {
+        N2K_SCHEMA_DUMP(127257, 0);
+    }
+
+    if (mask & ENGINE_SET) {
+        for(i = 0; i < 2; i++) {
+            if(session->gpsdata.engine.set & (i == 0 ? ENG_PORT_PSET : ENG_STARBOARD_PSET)) {
+                N2K_SCHEMA_DUMP(127488, i);
+                N2K_SCHEMA_DUMP(127489, i);
             }
         }
-    return 0;
+    }
 
+    return batch->count;
 }
@@ -9,6 +9,7 @@
 #include <time.h>
 
 #include "gpsd.h"
+#include "gps_json.h"
 
 /*
  * Support for generic binary drivers.  These functions dump NMEA for passing
@@ -20,12 +21,35 @@
  * value NAN, it is a valid WGS84 geoidal separation in meters for the fix.
  */
 
-static double degtodm(double angle)
-/* decimal degrees to GPS-style, degrees first followed by minutes */
+#define NMEA_HEX	"0123456789ABCDEF"
+
+static void nmea_out_checksum(struct json_out_t *out, size_t start)
+/* end the sentence begun at start with *hh<CR><LF> */
+{
+    unsigned char sum = '\0';
+    size_t i = start;
+
+    if (out->cap == 0)
+	return;
+    if (out->buf[i] == '$' || out->buf[i] == '!')
+	i++;
+    for (; i < out->len && out->buf[i] != '*'; i++)
+	sum ^= (unsigned char)out->buf[i];
+    /* a '*' already there is where the checksum goes */
+    out->len = i;
+    out->buf[i] = '\0';
+    json_out_char(out, '*');
+    json_out_char(out, NMEA_HEX[sum >> 4]);
+    json_out_char(out, NMEA_HEX[sum & 0x0f]);
+    json_out_mem(out, "\r\n", 2);
+}
+
+static void nmea_out_hms(struct json_out_t *out, const struct tm *tm)
+/* hhmmss */
 {
-    double fraction, integer;
-    fraction = modf(angle, &integer);
-    return floor(angle) * 100 + fraction * 60;
+    json_out_int_pad(out, tm->tm_hour, 2);
+    json_out_int_pad(out, tm->tm_min, 2);
+    json_out_int_pad(out, tm->tm_sec, 2);
 }
 
 /*@ -mustdefine @*/
@@ -34,45 +58,49 @@ void gpsd_position_fix_dump(struct gps_device_t *session,
 {
     struct tm tm;
     time_t intfixtime;
+    struct json_out_t out;
 
+    json_out_init(&out, bufp, len);
     intfixtime = (time_t) session->gpsdata.fix.time;
     (void)gmtime_r(&intfixtime, &tm);
     if (session->gpsdata.fix.mode > MODE_NO_FIX) {
-	(void)snprintf(bufp, len,
-		       "$GPGGA,%02d%02d%02d,%09.4f,%c,%010.4f,%c,%d,%02d,",
-		       tm.tm_hour,
-		       tm.tm_min,
-		       tm.tm_sec,
-		       degtodm(fabs(session->gpsdata.fix.latitude)),
-		       ((session->gpsdata.fix.latitude > 0) ? 'N' : 'S'),
-		       degtodm(fabs(session->gpsdata.fix.longitude)),
-		       ((session->gpsdata.fix.longitude > 0) ? 'E' : 'W'),
-		       session->gpsdata.status,
-		       session->gpsdata.satellites_used);
+	json_out_raw(&out, "$GPGGA,");
+	nmea_out_hms(&out, &tm);
+	json_out_char(&out, ',');
+	json_out_dm(&out, session->gpsdata.fix.latitude, 9);
+	json_out_raw(&out, (session->gpsdata.fix.latitude > 0) ? ",N," : ",S,");
+	json_out_dm(&out, session->gpsdata.fix.longitude, 10);
+	json_out_raw(&out, (session->gpsdata.fix.longitude > 0) ? ",E," : ",W,");
+	json_out_int(&out, session->gpsdata.status);
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, session->gpsdata.satellites_used, 2);
+	json_out_char(&out, ',');
 	if (isnan(session->gpsdata.dop.hdop))
-	    (void)strlcat(bufp, ",", len);
-	else
-	    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-			   "%.2f,", session->gpsdata.dop.hdop);
+	    json_out_char(&out, ',');
+	else {
+	    json_out_fixed(&out, session->gpsdata.dop.hdop, 2);
+	    json_out_char(&out, ',');
+	}
 	if (isnan(session->gpsdata.fix.altitude))
-	    (void)strlcat(bufp, ",", len);
-	else
-	    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-			   "%.2f,M,", session->gpsdata.fix.altitude);
+	    json_out_char(&out, ',');
+	else {
+	    json_out_fixed(&out, session->gpsdata.fix.altitude, 2);
+	    json_out_raw(&out, ",M,");
+	}
 	if (isnan(session->gpsdata.separation))
-	    (void)strlcat(bufp, ",", len);
-	else
-	    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-			   "%.3f,M,", session->gpsdata.separation);
+	    json_out_char(&out, ',');
+	else {
+	    json_out_fixed(&out, session->gpsdata.separation, 3);
+	    json_out_raw(&out, ",M,");
+	}
 	if (isnan(session->mag_var))
-	    (void)strlcat(bufp, ",", len);
+	    json_out_char(&out, ',');
 	else {
-	    (void)snprintf(bufp + strlen(bufp),
-			   len - strlen(bufp),
-			   "%3.2f,", fabs(session->mag_var));
-	    (void)strlcat(bufp, (session->mag_var > 0) ? "E" : "W", len);
+	    /* %3.2f; never narrower than 3 anyway */
+	    json_out_fixed(&out, fabs(session->mag_var), 2);
+	    json_out_raw(&out, (session->mag_var > 0) ? ",E" : ",W");
 	}
-	nmea_add_checksum(bufp);
+	nmea_out_checksum(&out, 0);
     }
 }
 
@@ -113,6 +141,7 @@ static void gpsd_transit_fix_dump(struct gps_device_t *session,
     */
     struct tm tm;
     time_t intfixtime;
+    struct json_out_t out;
 
     tm.tm_mday = tm.tm_mon = tm.tm_year = tm.tm_hour = tm.tm_min = tm.tm_sec =
 	0;
@@ -124,83 +153,77 @@ static void gpsd_transit_fix_dump(struct gps_device_t *session,
     }
 #define ZEROIZE(x)	(isnan(x)!=0 ? 0.0 : x)
     /*@ -usedef @*/
-    (void)snprintf(bufp, len,
-		   "$GPRMC,%02d%02d%02d,%c,%09.4f,%c,%010.4f,%c,",
-		   tm.tm_hour,
-		   tm.tm_min,
-		   tm.tm_sec,
-		   session->gpsdata.status ? 'A' : 'V',
-		   ZEROIZE(degtodm(fabs(session->gpsdata.fix.latitude))),
-		   ((session->gpsdata.fix.latitude > 0) ? 'N' : 'S'),
-		   ZEROIZE(degtodm(fabs(session->gpsdata.fix.longitude))),
-		   ((session->gpsdata.fix.longitude > 0) ? 'E' : 'W'));
-
-    if ( !isnan(session->gpsdata.navigation.speed_over_ground) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.4f,", session->gpsdata.navigation.speed_over_ground);
-    } else {
-      (void)strlcat(bufp, ",", len);
-    }
-    if ( !isnan(session->gpsdata.navigation.course_over_ground[compass_true]) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.3f,", session->gpsdata.navigation.course_over_ground[compass_true]);
-    } else {
-      (void)strlcat(bufp, ",", len);
-    }
-
-    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		   "%02d%02d%02d,,",
-		   tm.tm_mday, tm.tm_mon, tm.tm_year);
+    json_out_init(&out, bufp, len);
+    json_out_raw(&out, "$GPRMC,");
+    nmea_out_hms(&out, &tm);
+    json_out_raw(&out, session->gpsdata.status ? ",A," : ",V,");
+    json_out_dm(&out, ZEROIZE(session->gpsdata.fix.latitude), 9);
+    json_out_raw(&out, (session->gpsdata.fix.latitude > 0) ? ",N," : ",S,");
+    json_out_dm(&out, ZEROIZE(session->gpsdata.fix.longitude), 10);
+    json_out_raw(&out, (session->gpsdata.fix.longitude > 0) ? ",E," : ",W,");
+
+    if ( !isnan(session->gpsdata.navigation.speed_over_ground) )
+      json_out_fixed(&out, session->gpsdata.navigation.speed_over_ground, 4);
+    json_out_char(&out, ',');
+    if ( !isnan(session->gpsdata.navigation.course_over_ground[compass_true]) )
+      json_out_fixed(&out,
+		     session->gpsdata.navigation.course_over_ground[compass_true],
+		     3);
+    json_out_char(&out, ',');
+
+    json_out_int_pad(&out, tm.tm_mday, 2);
+    json_out_int_pad(&out, tm.tm_mon, 2);
+    json_out_int_pad(&out, tm.tm_year, 2);
+    json_out_raw(&out, ",,");
 
     /*@ +usedef @*/
 #undef ZEROIZE
-    nmea_add_checksum(bufp);
+    nmea_out_checksum(&out, 0);
 }
 
 static void gpsd_binary_satellite_dump(struct gps_device_t *session,
 				       char bufp[], size_t len)
 {
     int i;
-    char *bufp2 = bufp;
-    bufp[0] = '\0';
+    size_t start = 0;
+    struct json_out_t out;
 
+    json_out_init(&out, bufp, len);
     for (i = 0; i < session->gpsdata.satellites_visible; i++) {
 	if (i % 4 == 0) {
-	    bufp += strlen(bufp);
-	    bufp2 = bufp;
-	    len -= snprintf(bufp, len,
-			    "$GPGSV,%d,%d,%02d",
-			    ((session->gpsdata.satellites_visible - 1) / 4) +
-			    1, (i / 4) + 1,
-			    session->gpsdata.satellites_visible);
-	}
-	bufp += strlen(bufp);
-	if (i < session->gpsdata.satellites_visible)
-	    len -= snprintf(bufp, len,
-			    ",%02d,%02d,%03d,%02.0f",
-			    session->gpsdata.PRN[i],
-			    session->gpsdata.elevation[i],
-			    session->gpsdata.azimuth[i],
-			    session->gpsdata.ss[i]);
-	if (i % 4 == 3 || i == session->gpsdata.satellites_visible - 1) {
-	    nmea_add_checksum(bufp2);
-	    len -= 5;
+	    start = out.len;
+	    json_out_raw(&out, "$GPGSV,");
+	    json_out_int(&out,
+			 ((session->gpsdata.satellites_visible - 1) / 4) + 1);
+	    json_out_char(&out, ',');
+	    json_out_int(&out, (i / 4) + 1);
+	    json_out_char(&out, ',');
+	    json_out_int_pad(&out, session->gpsdata.satellites_visible, 2);
 	}
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, session->gpsdata.PRN[i], 2);
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, session->gpsdata.elevation[i], 2);
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, session->gpsdata.azimuth[i], 3);
+	json_out_char(&out, ',');
+	json_out_fixed_pad(&out, session->gpsdata.ss[i], 2, 0);
+	if (i % 4 == 3 || i == session->gpsdata.satellites_visible - 1)
+	    nmea_out_checksum(&out, start);
     }
 
 #ifdef ZODIAC_ENABLE
     if (session->packet.type == ZODIAC_PACKET
 	&& session->driver.zodiac.Zs[0] != 0) {
-	bufp += strlen(bufp);
-	bufp2 = bufp;
-	(void)strlcpy(bufp, "$PRWIZCH", len);
+	start = out.len;
+	json_out_raw(&out, "$PRWIZCH");
 	for (i = 0; i < ZODIAC_CHANNELS; i++) {
-	    len -= snprintf(bufp + strlen(bufp), len,
-			    ",%02u,%X",
-			    session->driver.zodiac.Zs[i],
-			    session->driver.zodiac.Zv[i] & 0x0f);
+	    json_out_char(&out, ',');
+	    json_out_uint_pad(&out, session->driver.zodiac.Zs[i], 2);
+	    json_out_char(&out, ',');
+	    json_out_char(&out, NMEA_HEX[session->driver.zodiac.Zv[i] & 0x0f]);
 	}
-	nmea_add_checksum(bufp2);
+	nmea_out_checksum(&out, start);
     }
 #endif /* ZODIAC_ENABLE */
 }
@@ -208,9 +231,11 @@ static void gpsd_binary_satellite_dump(struct gps_device_t *session,
 static void gpsd_binary_quality_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
-    char *bufp2 = bufp;
     bool used_valid = (session->gpsdata.set & USED_IS) != 0;
+    struct json_out_t out;
 
+    json_out_init(&out, bufp, len);
+#define ZEROIZE(x)	(isnan(x)!=0 ? 0.0 : x)
     if (session->device_type != NULL && (session->gpsdata.set & MODE_SET) != 0) {
         int i, j;
         // following is cherry picked from newer versions
@@ -222,34 +247,30 @@ static void gpsd_binary_quality_dump(struct gps_device_t *session,
             max_channels = 12;
         }
 
-        (void)snprintf(bufp, len - strlen(bufp),
-		       "$GPGSA,%c,%d,", 'A', session->gpsdata.fix.mode);
+        json_out_raw(&out, "$GPGSA,A,");
+        json_out_int(&out, session->gpsdata.fix.mode);
+        json_out_char(&out, ',');
         j = 0;
         for (i = 0; i < max_channels; i++) {
             if (session->gpsdata.used[i]) {
-                bufp += strlen(bufp);
-                (void)snprintf(bufp, len - strlen(bufp),
-			       "%02d,",
-			       used_valid ? session->gpsdata.used[i] : 0);
+                json_out_int_pad(&out,
+				 used_valid ? session->gpsdata.used[i] : 0, 2);
+                json_out_char(&out, ',');
                 j++;
             }
         }
-        for (i = j; i < max_channels; i++) {
-            bufp += strlen(bufp);
-            (void)strlcpy(bufp, ",", len);
-        }
-        bufp += strlen(bufp);
-#define ZEROIZE(x)	(isnan(x)!=0 ? 0.0 : x)
+        for (i = j; i < max_channels; i++)
+            json_out_char(&out, ',');
 	if (session->gpsdata.fix.mode == MODE_NO_FIX)
-	    (void)strlcat(bufp, ",,,", len);
-	else
-	    (void)snprintf(bufp, len - strlen(bufp),
-			   "%.1f,%.1f,%.1f*",
-			   ZEROIZE(session->gpsdata.dop.pdop),
-			   ZEROIZE(session->gpsdata.dop.hdop),
-			   ZEROIZE(session->gpsdata.dop.vdop));
-	nmea_add_checksum(bufp2);
-	bufp += strlen(bufp);
+	    json_out_raw(&out, ",,,");
+	else {
+	    json_out_fixed(&out, ZEROIZE(session->gpsdata.dop.pdop), 1);
+	    json_out_char(&out, ',');
+	    json_out_fixed(&out, ZEROIZE(session->gpsdata.dop.hdop), 1);
+	    json_out_char(&out, ',');
+	    json_out_fixed(&out, ZEROIZE(session->gpsdata.dop.vdop), 1);
+	}
+	nmea_out_checksum(&out, 0);
     }
     if (isfinite(session->gpsdata.fix.epx)!=0
 	&& isfinite(session->gpsdata.fix.epy)!=0
@@ -257,19 +278,23 @@ static void gpsd_binary_quality_dump(struct gps_device_t *session,
 	&& isfinite(session->gpsdata.epe)!=0) {
 	struct tm tm;
 	time_t intfixtime;
+	size_t start = out.len;
 
 	tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
 	if (isnan(session->gpsdata.fix.time) == 0) {
 	    intfixtime = (time_t) session->gpsdata.fix.time;
 	    (void)gmtime_r(&intfixtime, &tm);
 	}
-	(void)snprintf(bufp, len - strlen(bufp),
-		       "$GPGBS,%02d%02d%02d,%.2f,M,%.2f,M,%.2f,M",
-		       tm.tm_hour, tm.tm_min, tm.tm_sec,
-		       ZEROIZE(session->gpsdata.fix.epx),
-		       ZEROIZE(session->gpsdata.fix.epy),
-		       ZEROIZE(session->gpsdata.fix.epv));
-	nmea_add_checksum(bufp);
+	json_out_raw(&out, "$GPGBS,");
+	nmea_out_hms(&out, &tm);
+	json_out_char(&out, ',');
+	json_out_fixed(&out, ZEROIZE(session->gpsdata.fix.epx), 2);
+	json_out_raw(&out, ",M,");
+	json_out_fixed(&out, ZEROIZE(session->gpsdata.fix.epy), 2);
+	json_out_raw(&out, ",M,");
+	json_out_fixed(&out, ZEROIZE(session->gpsdata.fix.epv), 2);
+	json_out_raw(&out, ",M");
+	nmea_out_checksum(&out, start);
     }
 #undef ZEROIZE
 }
@@ -280,6 +305,7 @@ static void gpsd_binary_time_dump(struct gps_device_t *session,
     struct tm tm;
     double integral;
     time_t integral_time;
+    struct json_out_t out;
 
     if (session->newdata.mode > MODE_NO_FIX) {
 	double fractional = modf(session->newdata.time, &integral);
@@ -294,15 +320,19 @@ static void gpsd_binary_time_dump(struct gps_device_t *session,
 	 * break any time they were run in a timezone different from the one
 	 * where they were generated.
 	 */
-	(void)snprintf(bufp, len,
-		       "$GPZDA,%02d%02d%05.2f,%02d,%02d,%04d,00,00",
-		       tm.tm_hour,
-		       tm.tm_min,
-		       (double)tm.tm_sec + fractional,
-		       tm.tm_mday,
-		       tm.tm_mon + 1,
-		       tm.tm_year + 1900);
-	nmea_add_checksum(bufp);
+	json_out_init(&out, bufp, len);
+	json_out_raw(&out, "$GPZDA,");
+	json_out_int_pad(&out, tm.tm_hour, 2);
+	json_out_int_pad(&out, tm.tm_min, 2);
+	json_out_fixed_pad(&out, (double)tm.tm_sec + fractional, 5, 2);
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, tm.tm_mday, 2);
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, tm.tm_mon + 1, 2);
+	json_out_char(&out, ',');
+	json_out_int_pad(&out, tm.tm_year + 1900, 4);
+	json_out_raw(&out, ",00,00");
+	nmea_out_checksum(&out, 0);
     }
 }
 
@@ -443,29 +473,36 @@ static void gpsd_binary_mwd_dump(struct gps_device_t *session,
                                     char bufp[], size_t len)
 {
     // $--MWD,x.x,T,x.x,M,x.x,N,x.x,M*hh<CR><LF>
-    (void)snprintf(bufp, len, "$GPMWD,");
+    struct json_out_t out;
+
+    json_out_init(&out, bufp, len);
+    json_out_raw(&out, "$GPMWD,");
 
     if ( !isnan(session->gpsdata.environment.wind[wind_true_north].angle) ) {
         double ang = session->gpsdata.environment.wind[wind_true_north].angle;
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), "%.2f,T,", ang);
+        json_out_fixed(&out, ang, 2);
+        json_out_raw(&out, ",T,");
     } else {
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), ",,");
+        json_out_raw(&out, ",,");
     }
     if ( !isnan(session->gpsdata.environment.wind[wind_magnetic_north].angle) ) {
         double ang = session->gpsdata.environment.wind[wind_magnetic_north].angle;
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), "%.2f,M,", ang);
+        json_out_fixed(&out, ang, 2);
+        json_out_raw(&out, ",M,");
     } else {
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), ",,");
+        json_out_raw(&out, ",,");
     }
     if ( !isnan(session->gpsdata.environment.wind[wind_true_north].speed) ) {
         double speed = session->gpsdata.environment.wind[wind_true_north].speed;
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), "%.2f,N,%.2f,M",
-        speed*MPS_TO_KNOTS, speed);
+        json_out_fixed(&out, speed*MPS_TO_KNOTS, 2);
+        json_out_raw(&out, ",N,");
+        json_out_fixed(&out, speed, 2);
+        json_out_raw(&out, ",M");
     } else {
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), ",,,,");
+        json_out_raw(&out, ",,,,");
     }
 
-    nmea_add_checksum(bufp);
+    nmea_out_checksum(&out, 0);
 
 }
 
@@ -475,33 +512,34 @@ static void gpsd_binary_mwv_dump(struct gps_device_t *session,
 {
   // $--MWV,x.x,[R,T],x.x,[K/M/N]*hh<CR><LF>
 
-    char RT = '\0';
+    const char *RT;
+    struct json_out_t out;
 
     if(wr == wind_apparent) {
-        RT = 'R';
+        RT = ",R,";
     } else if(wr == wind_true_to_boat) {
-        RT = 'T';
+        RT = ",T,";
     } else
         return;
 
-    (void)snprintf(bufp, len, "$GPMWV,");
+    json_out_init(&out, bufp, len);
+    json_out_raw(&out, "$GPMWV,");
 
     if ( !isnan(session->gpsdata.environment.wind[wr].angle) ) {
         double ang = session->gpsdata.environment.wind[wr].angle;
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), "%.2f,%c,", ang, RT);
-    } else {
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), ",%c,", RT);
+        json_out_fixed(&out, ang, 2);
     }
+    json_out_raw(&out, RT);
     if(!isnan(session->gpsdata.environment.wind[wr].speed)) {
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-                       "%.2f,N,", session->gpsdata.environment.wind[wr].speed*MPS_TO_KNOTS);
+        json_out_fixed(&out, session->gpsdata.environment.wind[wr].speed*MPS_TO_KNOTS, 2);
+        json_out_raw(&out, ",N,");
     } else {
-        (void)snprintf(bufp + strlen(bufp), len - strlen(bufp), ",,");
+        json_out_raw(&out, ",,");
     }
 
-    (void)strlcat(bufp, "A", len);
+    json_out_char(&out, 'A');
 
-    nmea_add_checksum(bufp);
+    nmea_out_checksum(&out, 0);
 }
 
 static void gpsd_binary_vwr_dump(struct gps_device_t *session,
@@ -509,118 +547,125 @@ static void gpsd_binary_vwr_dump(struct gps_device_t *session,
 {
   // $--VWR,x.x,a,x.x,N,x.x,M,x.x,K*hh<CR><LF>
   // deprecated, not for new designs
+  struct json_out_t out;
 
-  (void)snprintf(bufp, len, "$GPVWR,");
+  json_out_init(&out, bufp, len);
+  json_out_raw(&out, "$GPVWR,");
 
   if ( !isnan(session->gpsdata.environment.wind[wind_apparent].angle) ) {
       double ang = session->gpsdata.environment.wind[wind_apparent].angle;
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,%c,",
-		     ang <= 180 ? ang:360.0 - ang,
-		     ang <= 180 ? 'R':'L');
+      json_out_fixed(&out, ang <= 180 ? ang:360.0 - ang, 2);
+      json_out_raw(&out, ang <= 180 ? ",R,":",L,");
   } else {
-      (void)strlcat(bufp, ",,", len);
+      json_out_raw(&out, ",,");
   }
 
   if ( !isnan(session->gpsdata.environment.wind[wind_apparent].speed) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,N,", session->gpsdata.environment.wind[wind_apparent].speed*MPS_TO_KNOTS);
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-             "%.2f,M,", session->gpsdata.environment.wind[wind_apparent].speed);
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-             "%.2f,K", session->gpsdata.environment.wind[wind_apparent].speed*MPS_TO_KPH);
+      double speed = session->gpsdata.environment.wind[wind_apparent].speed;
+      json_out_fixed(&out, speed*MPS_TO_KNOTS, 2);
+      json_out_raw(&out, ",N,");
+      json_out_fixed(&out, speed, 2);
+      json_out_raw(&out, ",M,");
+      json_out_fixed(&out, speed*MPS_TO_KPH, 2);
+      json_out_raw(&out, ",K");
   } else {
-      (void)strlcat(bufp, ",,,,,", len);
+      json_out_raw(&out, ",,,,,");
   }
 
-  nmea_add_checksum(bufp);
+  nmea_out_checksum(&out, 0);
 }
 
 static void gpsd_binary_vtg_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
   // $--VTG,x.x,x,x.x,x.x,*hh<CR><LF>
-  (void)snprintf(bufp, len, "$GPVTG,");
+  struct json_out_t out;
+
+  json_out_init(&out, bufp, len);
+  json_out_raw(&out, "$GPVTG,");
 
   if ( !isnan(session->gpsdata.navigation.course_over_ground[compass_true]) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,T,", session->gpsdata.navigation.course_over_ground[compass_true]);
+      json_out_fixed(&out, session->gpsdata.navigation.course_over_ground[compass_true], 2);
+      json_out_raw(&out, ",T,");
   } else {
-      (void)strlcat(bufp, ",,", len);
+      json_out_raw(&out, ",,");
   }
 
   if ( !isnan(session->gpsdata.navigation.course_over_ground[compass_magnetic]) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,M,", session->gpsdata.navigation.course_over_ground[compass_magnetic]);
+      json_out_fixed(&out, session->gpsdata.navigation.course_over_ground[compass_magnetic], 2);
+      json_out_raw(&out, ",M,");
   } else {
-      (void)strlcat(bufp, ",,", len);
+      json_out_raw(&out, ",,");
   }
 
   if ( !isnan(session->gpsdata.navigation.speed_over_ground) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,N,", session->gpsdata.navigation.speed_over_ground);
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,K", session->gpsdata.navigation.speed_over_ground * KNOTS_TO_KPH);
+      json_out_fixed(&out, session->gpsdata.navigation.speed_over_ground, 2);
+      json_out_raw(&out, ",N,");
+      json_out_fixed(&out, session->gpsdata.navigation.speed_over_ground * KNOTS_TO_KPH, 2);
+      json_out_raw(&out, ",K");
   } else {
-      (void)strlcat(bufp, ",,", len);
-      (void)strlcat(bufp, ",,", len);
+      json_out_raw(&out, ",,,,");
   }
-  nmea_add_checksum(bufp);
+  nmea_out_checksum(&out, 0);
 }
 
 static void gpsd_binary_vhw_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
   // $--VHW,x.x,T,x.x,M,x.x,N,x.x,K*hh<CR><LF>
+  struct json_out_t out;
 
-  (void)snprintf(bufp, len, "$GPVHW,");
+  json_out_init(&out, bufp, len);
+  json_out_raw(&out, "$GPVHW,");
 
   if ( !isnan(session->gpsdata.navigation.heading[compass_true]) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,T,",
-		     session->gpsdata.navigation.heading[compass_true]);
+      json_out_fixed(&out, session->gpsdata.navigation.heading[compass_true], 2);
+      json_out_raw(&out, ",T,");
   } else {
-      (void)strlcat(bufp, ",,", len);
+      json_out_raw(&out, ",,");
   }
 
   if ( !isnan(session->gpsdata.navigation.heading[compass_magnetic]) ) {
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,M,",
-		     session->gpsdata.navigation.heading[compass_magnetic]);
+      json_out_fixed(&out, session->gpsdata.navigation.heading[compass_magnetic], 2);
+      json_out_raw(&out, ",M,");
   } else {
-      (void)strlcat(bufp, ",,", len);
+      json_out_raw(&out, ",,");
   }
 
   if ( !isnan(session->gpsdata.navigation.speed_thru_water) ) {
-
-      (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		     "%.2f,N,%.2f,K",
-		     session->gpsdata.navigation.speed_thru_water,
-                     session->gpsdata.navigation.speed_thru_water * KNOTS_TO_KPH );
-
+      json_out_fixed(&out, session->gpsdata.navigation.speed_thru_water, 2);
+      json_out_raw(&out, ",N,");
+      json_out_fixed(&out, session->gpsdata.navigation.speed_thru_water * KNOTS_TO_KPH, 2);
+      json_out_raw(&out, ",K");
   } else {
-      (void)strlcat(bufp, ",,,", len);
+      json_out_raw(&out, ",,,");
   }
 
-  nmea_add_checksum(bufp);
+  nmea_out_checksum(&out, 0);
 }
 
 static void gpsd_binary_dpt_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
   // $--DBT,x.x,f,x.x,M,x.x,F*hh<CR><LF>
+  struct json_out_t out;
+
+  json_out_init(&out, bufp, len);
   if (!isnan(session->gpsdata.navigation.depth_offset)) {
     if (!isnan(session->gpsdata.navigation.depth)) {
-      (void)snprintf(bufp, len, "$GPDPT,%.2f,%.2f",
-		     session->gpsdata.navigation.depth,
-		     session->gpsdata.navigation.depth_offset);
-      nmea_add_checksum(bufp);
+      json_out_raw(&out, "$GPDPT,");
+      json_out_fixed(&out, session->gpsdata.navigation.depth, 2);
+      json_out_char(&out, ',');
+      json_out_fixed(&out, session->gpsdata.navigation.depth_offset, 2);
+      nmea_out_checksum(&out, 0);
     }
   } else if (!isnan(session->gpsdata.navigation.depth)) {
-    (void)snprintf(bufp, len, "$GPDBT,%.2f,f,%.2f,M,,",
-		 session->gpsdata.navigation.depth *  METERS_TO_FEET,
-		 session->gpsdata.navigation.depth);
-    nmea_add_checksum(bufp);
+    json_out_raw(&out, "$GPDBT,");
+    json_out_fixed(&out, session->gpsdata.navigation.depth *  METERS_TO_FEET, 2);
+    json_out_raw(&out, ",f,");
+    json_out_fixed(&out, session->gpsdata.navigation.depth, 2);
+    json_out_raw(&out, ",M,,");
+    nmea_out_checksum(&out, 0);
   }
 }
 
@@ -628,34 +673,32 @@ static void gpsd_binary_hdg_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
   // $--HDG,x.x,x.x,a,x.x,a*hh<CR><LF>
+  struct json_out_t out;
 
-  (void)snprintf(bufp, len, "$GPHDG,");
+  json_out_init(&out, bufp, len);
+  json_out_raw(&out, "$GPHDG,");
 
-  if (!isnan(session->gpsdata.navigation.heading[compass_magnetic])) {
-    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		   "%.2f,",
-		   session->gpsdata.navigation.heading[compass_magnetic]);
-  } else {
-    (void)strlcat(bufp, ",", len);
-  }
+  if (!isnan(session->gpsdata.navigation.heading[compass_magnetic]))
+    json_out_fixed(&out, session->gpsdata.navigation.heading[compass_magnetic], 2);
+  json_out_char(&out, ',');
 
   if (isnan(session->gpsdata.environment.deviation))
-    (void)strlcat(bufp, ",,", len);
-  else
-    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		   "%.2f,%c,",
-		   fabs(session->gpsdata.environment.deviation),
-		   session->gpsdata.environment.deviation > 0?'E':'W');
+    json_out_raw(&out, ",,");
+  else {
+    json_out_fixed(&out, fabs(session->gpsdata.environment.deviation), 2);
+    json_out_raw(&out,
+		 session->gpsdata.environment.deviation > 0 ? ",E," : ",W,");
+  }
 
   if (isnan(session->gpsdata.environment.variation))
-    (void)strlcat(bufp, ",,", len);
-  else
-    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		   "%.2f,%c",
-		   fabs(session->gpsdata.environment.variation),
-		   session->gpsdata.environment.variation > 0?'E':'W');
-
-  nmea_add_checksum(bufp);
+    json_out_raw(&out, ",,");
+  else {
+    json_out_fixed(&out, fabs(session->gpsdata.environment.variation), 2);
+    json_out_raw(&out,
+		 session->gpsdata.environment.variation > 0 ? ",E" : ",W");
+  }
+
+  nmea_out_checksum(&out, 0);
 }
 
 
@@ -663,12 +706,14 @@ static void gpsd_binary_rsa_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
   // $--RSA,x.x,A,x.x,A
+  struct json_out_t out;
 
+  json_out_init(&out, bufp, len);
   if (!isnan(session->gpsdata.navigation.rudder_angle)) {
-    (void)snprintf(bufp, len - strlen(bufp),
-		   "$GPRSA,%.2f,A,,,",
-   		   session->gpsdata.navigation.rudder_angle);
-    nmea_add_checksum(bufp);
+    json_out_raw(&out, "$GPRSA,");
+    json_out_fixed(&out, session->gpsdata.navigation.rudder_angle, 2);
+    json_out_raw(&out, ",A,,,");
+    nmea_out_checksum(&out, 0);
   }
 
 }
@@ -700,13 +745,14 @@ static void gpsd_binary_xte_dump(struct gps_device_t *session,
    6. FAA mode indicator (NMEA 2.3 and later, optional)
    7. Checksum
   */
+  struct json_out_t out;
 
+  json_out_init(&out, bufp, len);
   if (!isnan(session->gpsdata.waypoint.xte)) {
-    (void)snprintf(bufp, len - strlen(bufp),
-		   "$GPXTE,A,A,%.2f,%c,N,",
-   		   fabs(session->gpsdata.waypoint.xte * METERS_TO_NM),
-		   session->gpsdata.waypoint.xte < 0?'R':'L');
-    nmea_add_checksum(bufp);
+    json_out_raw(&out, "$GPXTE,A,A,");
+    json_out_fixed(&out, fabs(session->gpsdata.waypoint.xte * METERS_TO_NM), 2);
+    json_out_raw(&out, session->gpsdata.waypoint.xte < 0 ? ",R,N," : ",L,N,");
+    nmea_out_checksum(&out, 0);
   }
 
 }
@@ -715,49 +761,91 @@ static void gpsd_binary_rot_dump(struct gps_device_t *session,
 				     char bufp[], size_t len)
 {
   // $--ROT,x.x,A
+  struct json_out_t out;
 
+  json_out_init(&out, bufp, len);
   if (!isnan(session->gpsdata.navigation.rate_of_turn)) {
 
     // from deg / sec to deg / min
-    (void)snprintf(bufp, len - strlen(bufp),
-		   "$GPROT,%.2f,A",
-   		   session->gpsdata.navigation.rate_of_turn * 60.0);
-    nmea_add_checksum(bufp);
+    json_out_raw(&out, "$GPROT,");
+    json_out_fixed(&out, session->gpsdata.navigation.rate_of_turn * 60.0, 2);
+    json_out_raw(&out, ",A");
+    nmea_out_checksum(&out, 0);
   }
 
 }
 
+static void gpsd_binary_vpw_dump(struct gps_device_t *session,
+				     char bufp[], size_t len)
+{
+  // $--VPW,x.x,N,x.x,M*hh<CR><LF>
+  struct json_out_t out;
+
+  json_out_init(&out, bufp, len);
+  if (!isnan(session->gpsdata.navigation.vmg)) {
+    json_out_raw(&out, "$GPVPW,");
+    json_out_fixed(&out, session->gpsdata.navigation.vmg, 2);
+    json_out_raw(&out, ",N,");
+    json_out_fixed(&out, session->gpsdata.navigation.vmg * KNOTS_TO_MPS, 2);
+    json_out_raw(&out, ",M");
+    nmea_out_checksum(&out, 0);
+  }
+}
+
+static void gpsd_binary_vdr_dump(struct gps_device_t *session,
+				     char bufp[], size_t len)
+{
+  // $--VDR,x.x,T,x.x,M,x.x,N*hh<CR><LF>
+  struct json_out_t out;
+
+  json_out_init(&out, bufp, len);
+  if (!isnan(session->gpsdata.navigation.current_set)
+      && !isnan(session->gpsdata.navigation.current_drift)) {
+    json_out_raw(&out, "$GPVDR,");
+    json_out_fixed(&out, session->gpsdata.navigation.current_set, 2);
+    json_out_raw(&out, ",T,,M,");
+    json_out_fixed(&out, session->gpsdata.navigation.current_drift, 2);
+    json_out_raw(&out, ",N");
+    nmea_out_checksum(&out, 0);
+  }
+}
+
 static void gpsd_binary_distance_traveled_dump(struct gps_device_t *session,
 				     char bufp[], size_t len) {
   //  $--VLW,x.x,N,x.x,N*hh<CR><LF>xs
-  (void)snprintf(bufp, len, "$GPVLW,");
+  struct json_out_t out;
+
+  json_out_init(&out, bufp, len);
+  json_out_raw(&out, "$GPVLW,");
 
   if (!isnan(session->gpsdata.navigation.distance_total)) {
-    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		 "%.2f,N,",
-		   session->gpsdata.navigation.distance_total);
+    json_out_fixed(&out, session->gpsdata.navigation.distance_total, 2);
+    json_out_raw(&out, ",N,");
   } else {
-    (void)strlcat(bufp, ",,", len);
+    json_out_raw(&out, ",,");
   }
 
   if (!isnan(session->gpsdata.navigation.distance_trip)) {
-    (void)snprintf(bufp + strlen(bufp), len - strlen(bufp),
-		 "%.2f,N,",
-		   session->gpsdata.navigation.distance_trip);
+    json_out_fixed(&out, session->gpsdata.navigation.distance_trip, 2);
+    json_out_raw(&out, ",N,");
   } else {
-    (void)strlcat(bufp, ",,", len);
+    json_out_raw(&out, ",,");
   }
 
-  nmea_add_checksum(bufp);
+  nmea_out_checksum(&out, 0);
 }
 
 static void gpsd_binary_temp_water_dump(struct gps_device_t *session,
 				     char bufp[], size_t len) {
   //  $--MTW,x.x,C*hh<CR><LF>
+  struct json_out_t out;
+
+  json_out_init(&out, bufp, len);
   if (!isnan(session->gpsdata.environment.temp[temp_water])) {
-    (void)snprintf(bufp, len, "$GPMTW,%.2f,C",
-		 session->gpsdata.environment.temp[temp_water] + KELVIN_2_CELSIUS);
-    nmea_add_checksum(bufp);
+    json_out_raw(&out, "$GPMTW,");
+    json_out_fixed(&out, session->gpsdata.environment.temp[temp_water] + KELVIN_2_CELSIUS, 2);
+    json_out_raw(&out, ",C");
+    nmea_out_checksum(&out, 0);
   }
 }
 
@@ -851,6 +939,14 @@ void nmea_navigation_dump(struct gps_device_t *session,
       if((session->gpsdata.navigation.set & NAV_RUDDER_ANGLE_PSET) != 0)
 	gpsd_binary_rsa_dump(session, bufp + strlen(bufp),
 			     len - strlen(bufp));
+
+      if((session->gpsdata.navigation.set & NAV_VMG_PSET) != 0)
+	gpsd_binary_vpw_dump(session, bufp + strlen(bufp),
+			     len - strlen(bufp));
+
+      if((session->gpsdata.navigation.set & NAV_CURRENT_PSET) != 0)
+	gpsd_binary_vdr_dump(session, bufp + strlen(bufp),
+			     len - strlen(bufp));
     }
 
     if ((session->gpsdata.set & WAYPOINT_SET) != 0) {
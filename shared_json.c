@@ -94,6 +94,12 @@ int json_watch_read(const char *buf,
 	                                  .nodefault = true},
 	{"nmea",	   t_boolean,  .addr.boolean = &ccp->nmea,
 	                                  .nodefault = true},
+	{"binary",         t_boolean,  .addr.boolean = &ccp->binary,
+	                                  .nodefault = true},
+	{"targets",        t_integer,  .addr.integer = &ccp->targets,
+	                                  .nodefault = true},
+	{"cpa",            t_boolean,  .addr.boolean = &ccp->cpa,
+	                                  .nodefault = true},
 	{"scaled",         t_boolean,  .addr.boolean = &ccp->scaled},
 	{"timing",         t_boolean,  .addr.boolean = &ccp->timing},
 	{"split24",        t_boolean,  .addr.boolean = &ccp->split24},
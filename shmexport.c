@@ -5,9 +5,14 @@ NAME
 
 DESCRIPTION
    This is a very lightweight alternative to JSON-over-sockets.  Clients
-won't be able to filter by device, and won't get device activation/deactivation
-notifications.  But both client and daemon will avoid all the marshalling and
-unmarshalling overhead.
+won't get device activation/deactivation notifications.  But both client
+and daemon will avoid all the marshalling and unmarshalling overhead.
+
+   Each device gets a slot of its own, looked up by path, and gives it
+up again when it is deactivated.  A slot is divided into sections (fix,
+sky, navigation, ...) that are rewritten only when a report changes
+them, so a position update no longer drags the AIS and navigation
+history buffers along with it.
 
 PERMISSIONS
    This file is Copyright (c) 2010 by the GPSD project
@@ -26,21 +31,72 @@ PERMISSIONS
 #include <sys/shm.h>
 
 #include "gpsd.h"
-#include "libgps.h" /* for SHM_PSEUDO_FD */
 
 /*@ -mustfreeonly -nullstate -mayaliasunique @*/
 
+/* report bits that make each section worth rewriting */
+static const gps_mask_t section_masks[SHM_SECTIONS] = {
+    [SHM_SECTION_HEAD] = ~(gps_mask_t)0,
+    [SHM_SECTION_DEVICE] = DEVICE_SET | DEVICEID_SET,
+    [SHM_SECTION_FIX] = TIME_SET | TIMERR_SET | LATLON_SET | ALTITUDE_SET
+			| CLIMB_SET | STATUS_SET | MODE_SET | HERR_SET
+			| VERR_SET | CLIMBERR_SET,
+    [SHM_SECTION_SKY] = SATELLITE_SET | USED_IS | DOP_SET,
+    [SHM_SECTION_NAVIGATION] = NAVIGATION_SET,
+    [SHM_SECTION_WAYPOINT] = WAYPOINT_SET,
+    [SHM_SECTION_ENVIRONMENT] = ENVIRONMENT_SET,
+    [SHM_SECTION_ENGINE] = ENGINE_SET,
+    [SHM_SECTION_ATTITUDE] = ATTITUDE_SET,
+    [SHM_SECTION_AIS] = AIS_SET,
+};
+
+static const struct {
+    size_t offset, length;
+} section_layout[SHM_SECTIONS] = {
+#define LAYOUT(member) \
+    {offsetof(struct shm_slot_t, member), \
+     sizeof(((struct shm_slot_t *)0)->member)}
+    [SHM_SECTION_HEAD] = LAYOUT(head),
+    [SHM_SECTION_DEVICE] = LAYOUT(dev),
+    [SHM_SECTION_FIX] = LAYOUT(fix),
+    [SHM_SECTION_SKY] = LAYOUT(sky),
+    [SHM_SECTION_NAVIGATION] = LAYOUT(navigation),
+    [SHM_SECTION_WAYPOINT] = LAYOUT(waypoint),
+    [SHM_SECTION_ENVIRONMENT] = LAYOUT(environment),
+    [SHM_SECTION_ENGINE] = LAYOUT(engine),
+    [SHM_SECTION_ATTITUDE] = LAYOUT(attitude),
+    [SHM_SECTION_AIS] = LAYOUT(ais),
+#undef LAYOUT
+};
+
+/* all sections of a slot get written on its first update */
+static bool shm_primed[SHM_SLOTS];
+/* a device has been left out for want of a slot, and was logged */
+static bool shm_full = false;
+
 bool shm_acquire(struct gps_context_t *context)
 /* initialize the shared-memory segment to be used for export */
 {
-    int shmid;
+    volatile struct shmexport_t *shared;
+    int shmid, i, j;
 
-    shmid = shmget((key_t)GPSD_KEY, sizeof(struct gps_data_t), (int)(IPC_CREAT|0666));
+    shmid = shmget((key_t)GPSD_KEY, sizeof(struct shmexport_t), (int)(IPC_CREAT|0666));
+    if (shmid == -1 && errno == EINVAL) {
+	/* left over by a gpsd with another layout; replace it */
+	shmid = shmget((key_t)GPSD_KEY, 0, 0);
+	if (shmid != -1 && shmctl(shmid, IPC_RMID, NULL) == 0) {
+	    gpsd_report(context->debug, LOG_WARN,
+			"removed stale export segment %d\n", shmid);
+	    shmid = shmget((key_t)GPSD_KEY, sizeof(struct shmexport_t),
+			   (int)(IPC_CREAT|0666));
+	} else
+	    errno = EINVAL;
+    }
     if (shmid == -1) {
 	gpsd_report(context->debug, LOG_ERROR,
 		    "shmget(%ld, %zd, 0666) failed: %s\n",
 		    (long int)GPSD_KEY,
-		    sizeof(struct gps_data_t),
+		    sizeof(struct shmexport_t),
 		    strerror(errno));
 	return false;
     }
@@ -50,6 +106,27 @@ bool shm_acquire(struct gps_context_t *context)
 	context->shmexport = NULL;
 	return false;
     }
+
+    shared = (volatile struct shmexport_t *)context->shmexport;
+    shared->magic = 0;
+    memory_barrier();
+    (void)memset((char *)context->shmexport + sizeof(shared->magic), '\0',
+		 sizeof(struct shmexport_t) - sizeof(shared->magic));
+    shared->version = SHM_VERSION;
+    shared->nsections = SHM_SECTIONS;
+    shared->nslots = SHM_SLOTS;
+    shared->slotsize = (uint32_t)sizeof(struct shm_slot_t);
+    for (j = 0; j < SHM_SLOTS; j++) {
+	for (i = 0; i < SHM_SECTIONS; i++) {
+	    shared->slot[j].section[i].offset =
+		(uint32_t)section_layout[i].offset;
+	    shared->slot[j].section[i].length =
+		(uint32_t)section_layout[i].length;
+	}
+	shm_primed[j] = false;
+    }
+    memory_barrier();
+    shared->magic = SHM_MAGIC;
     gpsd_report(context->debug, LOG_PROG,
 		"shmat() succeeded, segment %d\n", shmid);
     return true;
@@ -62,38 +139,218 @@ void shm_release(struct gps_context_t *context)
 	(void)shmdt((const void *)context->shmexport);
 }
 
+static void shm_copy_rb(volatile rb_t *to, const rb_t *from)
+/* bring an exported ring buffer up to date, copying only new entries */
+{
+    uint32_t in = to->in;
+
+    if (from->in - in > from->mask || from->in < in || from->out < to->out)
+	in = from->out;		/* reset, wrapped or first export */
+    for (; in != from->in; in++)
+	to->data[in & from->mask] = from->data[in & from->mask];
+    to->in = from->in;
+    to->out = from->out;
+    to->mask = from->mask;
+    to->max_size = from->max_size;
+}
+
+static size_t shm_fill(volatile struct shm_slot_t *shared, int id,
+		       const struct gps_data_t *gpsdata)
+/* copy one section's payload out of gpsdata, return bytes written */
+{
+    switch (id) {
+    case SHM_SECTION_HEAD:
+	shared->head.set = gpsdata->set;
+	shared->head.online = gpsdata->online;
+	shared->head.status = gpsdata->status;
+	shared->head.own_mmsi = gpsdata->own_mmsi;
+	(void)memcpy((void *)shared->head.tag, gpsdata->tag,
+		     sizeof(gpsdata->tag));
+	return sizeof(shared->head);
+    case SHM_SECTION_DEVICE:
+	(void)memcpy((void *)&shared->dev, &gpsdata->dev,
+		     sizeof(gpsdata->dev));
+	return sizeof(shared->dev);
+    case SHM_SECTION_FIX:
+	(void)memcpy((void *)&shared->fix.fix, &gpsdata->fix,
+		     sizeof(gpsdata->fix));
+	shared->fix.separation = gpsdata->separation;
+	shared->fix.epe = gpsdata->epe;
+	return sizeof(shared->fix);
+    case SHM_SECTION_SKY:
+	shared->sky.satellites_used = gpsdata->satellites_used;
+	(void)memcpy((void *)shared->sky.used, gpsdata->used,
+		     sizeof(gpsdata->used));
+	(void)memcpy((void *)&shared->sky.dop, &gpsdata->dop,
+		     sizeof(gpsdata->dop));
+	shared->sky.skyview_time = gpsdata->skyview_time;
+	shared->sky.satellites_visible = gpsdata->satellites_visible;
+	(void)memcpy((void *)shared->sky.PRN, gpsdata->PRN,
+		     sizeof(gpsdata->PRN));
+	(void)memcpy((void *)shared->sky.elevation, gpsdata->elevation,
+		     sizeof(gpsdata->elevation));
+	(void)memcpy((void *)shared->sky.azimuth, gpsdata->azimuth,
+		     sizeof(gpsdata->azimuth));
+	(void)memcpy((void *)shared->sky.ss, gpsdata->ss,
+		     sizeof(gpsdata->ss));
+	return sizeof(shared->sky);
+    case SHM_SECTION_NAVIGATION:
+	{
+	    /* the two history rings are most of this; ship only what's new */
+	    const struct navigation_t *nav = &gpsdata->navigation;
+	    volatile struct navigation_t *out = &shared->navigation;
+	    uint32_t sog = out->speed_over_grounds.in;
+	    uint32_t stw = out->speed_thru_waters.in;
+
+	    out->set = nav->set;
+	    out->speed_over_ground = nav->speed_over_ground;
+	    out->eps = nav->eps;
+	    out->speed_thru_water = nav->speed_thru_water;
+	    out->course_over_ground[0] = nav->course_over_ground[0];
+	    out->course_over_ground[1] = nav->course_over_ground[1];
+	    out->epd = nav->epd;
+	    out->rate_of_turn = nav->rate_of_turn;
+	    out->rudder_angle = nav->rudder_angle;
+	    out->depth = nav->depth;
+	    out->depth_offset = nav->depth_offset;
+	    out->distance_total = nav->distance_total;
+	    out->distance_trip = nav->distance_trip;
+	    out->heading[0] = nav->heading[0];
+	    out->heading[1] = nav->heading[1];
+	    out->vmg = nav->vmg;
+	    out->leeway = nav->leeway;
+	    out->course_thru_water = nav->course_thru_water;
+	    out->current_set = nav->current_set;
+	    out->current_drift = nav->current_drift;
+	    shm_copy_rb(&out->speed_over_grounds, &nav->speed_over_grounds);
+	    shm_copy_rb(&out->speed_thru_waters, &nav->speed_thru_waters);
+	    return offsetof(struct navigation_t, speed_over_grounds)
+		+ sizeof(*nav) - offsetof(struct navigation_t, vmg)
+		+ 2 * offsetof(rb_t, data)
+		+ sizeof(double_value_t) * ((out->speed_over_grounds.in - sog)
+					    + (out->speed_thru_waters.in - stw));
+	}
+    case SHM_SECTION_WAYPOINT:
+	(void)memcpy((void *)&shared->waypoint, &gpsdata->waypoint,
+		     sizeof(gpsdata->waypoint));
+	return sizeof(shared->waypoint);
+    case SHM_SECTION_ENVIRONMENT:
+	(void)memcpy((void *)&shared->environment, &gpsdata->environment,
+		     sizeof(gpsdata->environment));
+	return sizeof(shared->environment);
+    case SHM_SECTION_ENGINE:
+	(void)memcpy((void *)&shared->engine, &gpsdata->engine,
+		     sizeof(gpsdata->engine));
+	return sizeof(shared->engine);
+    case SHM_SECTION_ATTITUDE:
+	(void)memcpy((void *)&shared->attitude, &gpsdata->attitude,
+		     sizeof(gpsdata->attitude));
+	return sizeof(shared->attitude);
+    case SHM_SECTION_AIS:
+	(void)memcpy((void *)&shared->ais, &gpsdata->ais,
+		     sizeof(gpsdata->ais));
+	return sizeof(shared->ais);
+    }
+    return 0;
+}
+
+static int shm_slot(volatile struct shmexport_t *shared, const char *path)
+/* slot that belongs to a device path, claiming a free one if need be */
+{
+    int i, unused = -1;
+
+    for (i = 0; i < SHM_SLOTS; i++) {
+	volatile struct shm_slot_t *slot = &shared->slot[i];
+
+	if (slot->path[0] == '\0') {
+	    if (unused == -1)
+		unused = i;
+	} else if (strcmp((const char *)slot->path, path) == 0)
+	    return i;
+    }
+    if (unused != -1) {
+	volatile struct shm_slot_t *slot = &shared->slot[unused];
+
+	slot->seq++;
+	memory_barrier();
+	(void)strlcpy((char *)slot->path, path, sizeof(slot->path));
+	memory_barrier();
+	slot->seq++;
+    }
+    return unused;
+}
+
 void shm_update(struct gps_context_t *context, struct gps_data_t *gpsdata)
 /* export an update to all listeners */
 {
     if (context->shmexport != NULL)
     {
-	static int tick;
 	volatile struct shmexport_t *shared = (struct shmexport_t *)context->shmexport;
+	volatile struct shm_slot_t *slot;
+	uint32_t tick = shared->tick + 1;
+	size_t copied = 0;
+	int index, id;
 
-	++tick;
-	/*
-	 * Following block of instructions must not be reordered, otherwise
-	 * havoc will ensue.
-	 *
-	 * This is a simple optimistic-concurrency technique.  We write
-	 * the second bookend first, then the data, then the first bookend.
-	 * Reader copies what it sees in normal order; that way, if we
-	 * start to write the segment during the read, the second bookend will
-	 * get clobbered first and the data can be detected as bad.
-	 */
-	shared->bookend2 = tick;
-	memory_barrier();
-	memcpy((void *)(context->shmexport + offsetof(struct shmexport_t, gpsdata)),
-	       (void *)gpsdata,
-	       sizeof(struct gps_data_t));
-	memory_barrier();
-#ifndef USE_QT
-	shared->gpsdata.gps_fd = SHM_PSEUDO_FD;
-#else
-	shared->gpsdata.gps_fd = (void *)(intptr_t)SHM_PSEUDO_FD;
-#endif /* USE_QT */
+	index = shm_slot(shared, gpsdata->dev.path);
+	if (index < 0) {
+	    if (!shm_full)
+		gpsd_report(context->debug, LOG_WARN,
+			    "no export slot free for %s, not exported\n",
+			    gpsdata->dev.path);
+	    shm_full = true;
+	    return;
+	}
+	slot = &shared->slot[index];
+
+	for (id = 0; id < SHM_SECTIONS; id++) {
+	    volatile struct shm_section_t *section = &slot->section[id];
+
+	    if (shm_primed[index] && (gpsdata->set & section_masks[id]) == 0)
+		continue;
+	    /*
+	     * Sequence lock: the count is odd while the payload is being
+	     * rewritten.  A reader that sees an odd count, or a different
+	     * count after copying than before, has to try again.
+	     */
+	    section->seq++;
+	    memory_barrier();
+	    copied += shm_fill(slot, id, gpsdata);
+	    section->tick = tick;
+	    memory_barrier();
+	    section->seq++;
+	}
+	shm_primed[index] = true;
+	shared->copied = (uint32_t)copied;
+	shared->total_copied += copied;
+	slot->tick = tick;
+	shared->last = (uint32_t)index;
 	memory_barrier();
-	shared->bookend1 = tick;
+	shared->tick = tick;
+    }
+}
+
+void shm_deactivate(struct gps_context_t *context, const char *path)
+/* free the slot of a device that went away, for the next path to claim */
+{
+    if (context->shmexport != NULL)
+    {
+	volatile struct shmexport_t *shared = (struct shmexport_t *)context->shmexport;
+	int i;
+
+	for (i = 0; i < SHM_SLOTS; i++) {
+	    volatile struct shm_slot_t *slot = &shared->slot[i];
+
+	    if (slot->path[0] == '\0'
+		|| strcmp((const char *)slot->path, path) != 0)
+		continue;
+	    slot->seq++;
+	    memory_barrier();
+	    slot->path[0] = '\0';
+	    memory_barrier();
+	    slot->seq++;
+	    shm_primed[i] = false;
+	    shm_full = false;
+	}
     }
 }
 
@@ -0,0 +1,285 @@
+/****************************************************************************
+
+NAME
+   shmring.c - shared-memory event ring for local high-rate consumers
+
+DESCRIPTION
+   The SHM export is a snapshot: a reader that polls it misses whatever
+changed between two looks.  This ring keeps every update instead, as
+fixed-size binary records, so loggers and autopilot bridges on the same
+machine can follow the stream at full rate without JSON in between.
+There is one writer, the daemon, and any number of readers, each with
+its own cursor; see libgps_ring.c.
+
+   Records name their device by an index into a directory of paths.  A
+device gives its entry up when it is deactivated, and a new path takes
+the entry that has been free longest, so records still in the ring keep
+their path for as long as the directory allows.
+
+PERMISSIONS
+   This file is Copyright (c) 2010 by the GPSD project
+   BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+#include "gpsd_config.h"
+
+#ifdef SHM_EXPORT_ENABLE
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif /* __linux__ */
+
+#include "gpsd.h"
+
+/* ring head when each directory entry was given up, 0 if never used */
+static uint64_t ring_freed[RING_DEVICES];
+/* a device has been left out for want of an entry, and was logged */
+static bool ring_full = false;
+
+bool ring_acquire(struct gps_context_t *context)
+/* create the ring segment and reset it */
+{
+    volatile struct shmring_t *ring;
+    int shmid;
+
+    shmid = shmget((key_t)GPSD_RING_KEY, sizeof(struct shmring_t),
+		   (int)(IPC_CREAT|0666));
+    if (shmid == -1 && errno == EINVAL) {
+	/* left over by a gpsd with another layout; replace it */
+	shmid = shmget((key_t)GPSD_RING_KEY, 0, 0);
+	if (shmid != -1 && shmctl(shmid, IPC_RMID, NULL) == 0)
+	    shmid = shmget((key_t)GPSD_RING_KEY, sizeof(struct shmring_t),
+			   (int)(IPC_CREAT|0666));
+	else
+	    errno = EINVAL;
+    }
+    if (shmid == -1) {
+	gpsd_report(context->debug, LOG_ERROR,
+		    "ring shmget(%ld, %zd, 0666) failed: %s\n",
+		    (long int)GPSD_RING_KEY,
+		    sizeof(struct shmring_t),
+		    strerror(errno));
+	return false;
+    }
+    context->shmring = (char *)shmat(shmid, 0, 0);
+    if ((int)(long)context->shmring == -1) {
+	gpsd_report(context->debug, LOG_ERROR, "ring shmat failed: %s\n",
+		    strerror(errno));
+	context->shmring = NULL;
+	return false;
+    }
+
+    ring = (volatile struct shmring_t *)context->shmring;
+    ring->magic = 0;
+    memory_barrier();
+    (void)memset((char *)context->shmring + sizeof(ring->magic), '\0',
+		 offsetof(struct shmring_t, rec) - sizeof(ring->magic));
+    ring->version = RING_VERSION;
+    ring->recsize = (uint16_t)sizeof(struct gps_ring_record_t);
+    ring->records = RING_RECORDS;
+    ring->ndevices = RING_DEVICES;
+    (void)memset(ring_freed, '\0', sizeof(ring_freed));
+    memory_barrier();
+    ring->magic = RING_MAGIC;
+    gpsd_report(context->debug, LOG_PROG,
+		"event ring of %d records attached, segment %d\n",
+		RING_RECORDS, shmid);
+    return true;
+}
+
+void ring_release(struct gps_context_t *context)
+/* detach from the ring segment */
+{
+    if (context->shmring != NULL) {
+	(void)shmdt((const void *)context->shmring);
+	context->shmring = NULL;
+    }
+}
+
+static int ring_device(volatile struct shmring_t *ring, const char *path)
+/* directory index of a device path, claiming a free entry if need be */
+{
+    int i, unused = -1;
+
+    for (i = 0; i < RING_DEVICES; i++) {
+	if (ring->device[i].path[0] == '\0') {
+	    if (unused == -1 || ring_freed[i] < ring_freed[unused])
+		unused = i;
+	} else if (strcmp((const char *)ring->device[i].path, path) == 0)
+	    return i;
+    }
+    if (unused != -1) {
+	ring->device[unused].seq++;
+	memory_barrier();
+	(void)strlcpy((char *)ring->device[unused].path, path,
+		      sizeof(ring->device[unused].path));
+	memory_barrier();
+	ring->device[unused].seq++;
+    }
+    return unused;
+}
+
+static volatile struct gps_ring_record_t *ring_claim(volatile struct shmring_t *ring,
+						     uint64_t seq)
+/* start overwriting a slot; readers holding it will see the seq change */
+{
+    volatile struct gps_ring_record_t *rec = &ring->rec[seq & (RING_RECORDS - 1)];
+
+    rec->seq = ~(uint64_t)0;
+    memory_barrier();
+    return rec;
+}
+
+void ring_update(struct gps_context_t *context, struct gps_data_t *gpsdata,
+		 gps_mask_t changed)
+/* append one record per kind of data this report carries */
+{
+    volatile struct shmring_t *ring;
+    uint64_t head, ts;
+    int device, kinds = 0;
+    int kind;
+
+    if (context->shmring == NULL)
+	return;
+    ring = (volatile struct shmring_t *)context->shmring;
+    device = ring_device(ring, gpsdata->dev.path);
+    if (device < 0 && !ring_full) {
+	gpsd_report(context->debug, LOG_WARN,
+		    "no ring directory entry free for %s\n",
+		    gpsdata->dev.path);
+	ring_full = true;
+    }
+    head = ring->head;
+    ts = monotonic_ns();
+
+    for (kind = GPS_RING_FIX; kind <= GPS_RING_AIS; kind++) {
+	volatile struct gps_ring_record_t *rec;
+
+	switch (kind) {
+	case GPS_RING_FIX:
+	    if ((changed & (LATLON_SET | MODE_SET | ALTITUDE_SET)) == 0)
+		continue;
+	    rec = ring_claim(ring, head);
+	    rec->u.fix.time = gpsdata->fix.time;
+	    rec->u.fix.latitude = gpsdata->fix.latitude;
+	    rec->u.fix.longitude = gpsdata->fix.longitude;
+	    rec->u.fix.altitude = gpsdata->fix.altitude;
+	    rec->u.fix.climb = gpsdata->fix.climb;
+	    rec->u.fix.mode = gpsdata->fix.mode;
+	    rec->u.fix.status = gpsdata->status;
+	    break;
+	case GPS_RING_NAV:
+	    if ((changed & NAVIGATION_SET) == 0)
+		continue;
+	    rec = ring_claim(ring, head);
+	    rec->u.nav.set = gpsdata->navigation.set;
+	    rec->u.nav.speed_over_ground = gpsdata->navigation.speed_over_ground;
+	    rec->u.nav.speed_thru_water = gpsdata->navigation.speed_thru_water;
+	    rec->u.nav.course_over_ground =
+		gpsdata->navigation.course_over_ground[compass_true];
+	    rec->u.nav.heading = gpsdata->navigation.heading[compass_true];
+	    rec->u.nav.heading_magnetic =
+		gpsdata->navigation.heading[compass_magnetic];
+	    rec->u.nav.rate_of_turn = gpsdata->navigation.rate_of_turn;
+	    rec->u.nav.depth = gpsdata->navigation.depth;
+	    break;
+	case GPS_RING_ENV:
+	    if ((changed & ENVIRONMENT_SET) == 0)
+		continue;
+	    rec = ring_claim(ring, head);
+	    rec->u.env.set = gpsdata->environment.set;
+	    rec->u.env.apparent_angle =
+		gpsdata->environment.wind[wind_apparent].angle;
+	    rec->u.env.apparent_speed =
+		gpsdata->environment.wind[wind_apparent].speed;
+	    rec->u.env.true_angle =
+		gpsdata->environment.wind[wind_true_north].angle;
+	    rec->u.env.true_speed =
+		gpsdata->environment.wind[wind_true_north].speed;
+	    rec->u.env.temp_water = gpsdata->environment.temp[temp_water];
+	    rec->u.env.temp_air = gpsdata->environment.temp[temp_air];
+	    rec->u.env.pressure = gpsdata->environment.pressure;
+	    break;
+	case GPS_RING_ATTITUDE:
+	    if ((changed & ATTITUDE_SET) == 0)
+		continue;
+	    rec = ring_claim(ring, head);
+	    rec->u.attitude.heading = gpsdata->attitude.yaw;
+	    rec->u.attitude.pitch = gpsdata->attitude.pitch;
+	    rec->u.attitude.roll = gpsdata->attitude.roll;
+	    break;
+	case GPS_RING_AIS:
+	    if ((changed & AIS_SET) == 0)
+		continue;
+	    rec = ring_claim(ring, head);
+	    (void)memset((void *)&rec->u.ais, '\0', sizeof(rec->u.ais));
+	    rec->u.ais.type = gpsdata->ais.type;
+	    rec->u.ais.mmsi = gpsdata->ais.mmsi;
+	    if (gpsdata->ais.type >= 1 && gpsdata->ais.type <= 3) {
+		rec->u.ais.status = gpsdata->ais.type1.status;
+		rec->u.ais.turn = gpsdata->ais.type1.turn;
+		rec->u.ais.speed = gpsdata->ais.type1.speed;
+		rec->u.ais.lon = gpsdata->ais.type1.lon;
+		rec->u.ais.lat = gpsdata->ais.type1.lat;
+		rec->u.ais.course = gpsdata->ais.type1.course;
+		rec->u.ais.heading = gpsdata->ais.type1.heading;
+	    }
+	    break;
+	default:
+	    continue;
+	}
+	rec->ts = ts;
+	rec->set = changed;
+	rec->device = (uint16_t)(device < 0 ? 0xffff : device);
+	rec->kind = (uint16_t)kind;
+	memory_barrier();
+	rec->seq = head++;
+	kinds++;
+    }
+
+    if (kinds == 0)
+	return;
+    memory_barrier();
+    ring->head = head;
+    ring->futex++;
+#ifdef __linux__
+    memory_barrier();
+    if (ring->waiters > 0)
+	(void)syscall(SYS_futex, &ring->futex, FUTEX_WAKE, INT_MAX,
+		      NULL, NULL, 0);
+#endif /* __linux__ */
+}
+
+void ring_deactivate(struct gps_context_t *context, const char *path)
+/* give up the directory entry of a device that went away */
+{
+    volatile struct shmring_t *ring;
+    int i;
+
+    if (context->shmring == NULL)
+	return;
+    ring = (volatile struct shmring_t *)context->shmring;
+    for (i = 0; i < RING_DEVICES; i++) {
+	if (ring->device[i].path[0] == '\0'
+	    || strcmp((const char *)ring->device[i].path, path) != 0)
+	    continue;
+	ring->device[i].seq++;
+	memory_barrier();
+	ring->device[i].path[0] = '\0';
+	memory_barrier();
+	ring->device[i].seq++;
+	ring_freed[i] = ring->head;
+	ring_full = false;
+    }
+}
+
+#endif /* SHM_EXPORT_ENABLE */
+
+/* end */
@@ -9,7 +9,7 @@
 #include <time.h>
 
 #include "gpsd.h"
-#include "json.h"
+#include "gps_json.h"
 #include "timeutil.h"
 #include "ring_buffer.h"
 #include "signalk.h"
@@ -17,17 +17,16 @@
 char *unix_to_signalk(timestamp_t fixtime, /*@ out @*/
                       char isotime[], size_t len);
 
-void signalk_add_timestamp(/*@out@*/ char *reply, size_t replylen);
-void signalk_add_unixtimestamp(timestamp_t ts,
-                               /*@out@*/ char *reply, size_t replylen);
+void signalk_add_timestamp(struct json_out_t *out);
+void signalk_add_unixtimestamp(timestamp_t ts, struct json_out_t *out);
 void signalk_add_fixtimestamp(const struct gps_device_t *device,
-                              /*@out@*/ char *reply, size_t replylen);
+                              struct json_out_t *out);
 
 void signalk_value_full_dump(const struct gps_device_t *device,
                              int * pt, // first value on this level?
                              double value,
                              char * name,
-                             /*@out@*/ char *reply, size_t replylen);
+                             struct json_out_t *out);
 /*
 {
   "updates":[{
@@ -74,40 +73,42 @@ struct signalk_path_t {
     const struct json_attr_t jattr;
 };
 
-void signalk_add_unixtimestamp(timestamp_t ts,
-		      /*@out@*/ char *reply, size_t replylen)
+void signalk_add_unixtimestamp(timestamp_t ts, struct json_out_t *out)
 {
-    (void)strlcat(reply, "\"timestamp\":\"", replylen);
-    unix_to_signalk(ts,
-                    reply + strlen(reply), replylen - strlen(reply));
-    (void)strlcat(reply, "\"", replylen);
+    char isotime[64];
+
+    json_out_raw(out, "\"timestamp\":\"");
+    json_out_raw(out, unix_to_signalk(ts, isotime, sizeof(isotime)));
+    json_out_char(out, '"');
 }
 
-void signalk_add_timestamp(/*@out@*/ char *reply, size_t replylen)
+void signalk_add_timestamp(struct json_out_t *out)
 {
     timestamp_t ts = timestamp();
-    signalk_add_unixtimestamp(ts, reply, replylen);
+    signalk_add_unixtimestamp(ts, out);
 }
 
 void signalk_add_fixtimestamp(const struct gps_device_t *device,
-		      /*@out@*/ char *reply, size_t replylen)
+                              struct json_out_t *out)
 {
     timestamp_t ts = device->gpsdata.fix.time;
-    signalk_add_unixtimestamp(ts, reply, replylen);
+    signalk_add_unixtimestamp(ts, out);
 }
 
 void signalk_value_full_dump(const struct gps_device_t *device UNUSED,
                              int * pt, // first value on this level?
                              double value,
                              char * name,
-                             /*@out@*/ char *reply, size_t replylen)
+                             struct json_out_t *out)
 {
     if (!isnan(value)) {
         if(*pt > 0)
-            (void)strlcat(reply, ",", replylen);
-        (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                       "\"%s\":{\"value\":%.2f}",
-                       name, value);
+            json_out_char(out, ',');
+        json_out_char(out, '"');
+        json_out_raw(out, name);
+        json_out_raw(out, "\":{\"value\":");
+        json_out_fixed(out, value, 2);
+        json_out_char(out, '}');
         (*pt)++;
     }
 }
@@ -122,10 +123,10 @@ gps_mask_t signalk_track_dump(const struct gps_device_t *device, uint32_t startA
     uint32_t msec;
 
     char buf[255]; // more than enough here for the moment
-    int buflen = 255;
+    struct json_out_t out, item;
 
-    buf[0] = '\0';
-    (void)strcpy(reply, "{\"data\":[");
+    json_out_init(&out, reply, replylen);
+    json_out_raw(&out, "{\"data\":[");
 
     rb_t * rb = NULL;
     if(!strcmp(field, "speedOverGround"))
@@ -138,35 +139,35 @@ gps_mask_t signalk_track_dump(const struct gps_device_t *device, uint32_t startA
     while(rb_peek_n(rb, i, &val, &msec)) {
 
         if(msec > startAfter) {
+            json_out_init(&item, buf, sizeof(buf));
             if(c)
-                (void)strlcat(buf, ",", buflen);
+                json_out_char(&item, ',');
             c=1;
-            (void)strlcat(buf, "{\"navigation\":", buflen);
-            (void)snprintf(buf + strlen(buf), buflen - strlen(buf),
-                           "{\"%s\":{\"value\":%.4f,\"timestamp\":%u}}}",
-                           field, val*scale, msec);
-
-            if(strlen(buf) > replylen - strlen(reply) - 50) {
-                gpsd_report(device->context->debug, LOG_RAW,
+            json_out_raw(&item, "{\"navigation\":{\"");
+            json_out_raw(&item, field);
+            json_out_raw(&item, "\":{\"value\":");
+            json_out_fixed(&item, val*scale, 4);
+            json_out_raw(&item, ",\"timestamp\":");
+            json_out_uint(&item, msec);
+            json_out_raw(&item, "}}}");
+
+            if(item.len > replylen - out.len - 50) {
+                GPSD_SUBLOG(LOG_SUB_SIGNALK, LOG_RAW, device->context->debug,
                             "%s, len buf %lu, len reply: %lu\n",
-                            buf, strlen(buf),  replylen - strlen(reply) - 2);
+                            buf, item.len,  replylen - out.len - 2);
                 break;
             }
 
-            (void)strlcat(reply, buf, replylen);
-            buf[0] = '\0';
+            json_out_mem(&out, buf, item.len);
         }
         i++;
 
     }
 
 close:
-    (void)strlcat(reply, "]", replylen);
-
-    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                   ",\"now\":%u", tu_get_independend_time());
-
-    (void)strlcat(reply, "}", replylen);
+    json_out_raw(&out, "],\"now\":");
+    json_out_uint(&out, tu_get_independend_time());
+    json_out_char(&out, '}');
 
     return NAVIGATION_SET;
 }
@@ -178,49 +179,55 @@ gps_mask_t signalk_full_dump(const struct gps_device_t *device,
     gps_mask_t reported = 0;
     int pt[3];
     int i = 0;
+    struct json_out_t out;
+
+    json_out_init(&out, reply, replylen);
+    json_out_raw(&out, "{\"uuid\":\"urn:mrn:signalk:uuid:");
+    json_out_raw(&out, vessel->uuid);
+    json_out_char(&out, '"');
+    if(vessel->mmsi != 0) {
+        json_out_raw(&out, ",\"mmsi\":\"");
+        json_out_uint_pad(&out, vessel->mmsi, 9);
+        json_out_char(&out, '"');
+    }
 
-    (void)snprintf(reply, replylen,
-                   "{\"uuid\":\"urn:mrn:signalk:uuid:%s\"", vessel->uuid);
-    if(vessel->mmsi != 0)
-        (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                       ",\"mmsi\":\"%09u\"", vessel->mmsi);
-
-    (void)strlcat(reply, ",\"navigation\":{", replylen);
+    json_out_raw(&out, ",\"navigation\":{");
 
     // add actual values
     // TODO see to either use timestamps of last seen or invalidate at times
     pt[0] = 0;
     signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.rate_of_turn,
-                            "rateOfTurn", reply, replylen);
+                            "rateOfTurn", &out);
     signalk_value_full_dump(device, &pt[0],
                             device->gpsdata.navigation.course_over_ground[compass_magnetic]*DEG_2_RAD,
-                            "courseOverGroundMagnetic", reply, replylen);
+                            "courseOverGroundMagnetic", &out);
     signalk_value_full_dump(device, &pt[0],
                             device->gpsdata.navigation.course_over_ground[compass_true]*DEG_2_RAD,
-                            "courseOverGroundTrue", reply, replylen);
+                            "courseOverGroundTrue", &out);
     signalk_value_full_dump(device, &pt[0], device->gpsdata.environment.variation,
-                            "magneticVariation", reply, replylen);
+                            "magneticVariation", &out);
     signalk_value_full_dump(device, &pt[0],
                             device->gpsdata.navigation.heading[compass_true]*DEG_2_RAD,
-                            "headingTrue", reply, replylen);
+                            "headingTrue", &out);
     signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.heading[compass_magnetic]*DEG_2_RAD,
-                            "headingMagnetic", reply, replylen);
+                            "headingMagnetic", &out);
     signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.speed_over_ground*KNOTS_TO_MPS,
-                            "speedOverGround", reply, replylen);
+                            "speedOverGround", &out);
     signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.speed_thru_water*KNOTS_TO_MPS,
-                            "speedThroughWater", reply, replylen);
+                            "speedThroughWater", &out);
     signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.distance_total,
-                            "log", reply, replylen);
+                            "log", &out);
     signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.distance_trip,
-                            "logTrip", reply, replylen);
+                            "logTrip", &out);
 
     if (device->gpsdata.fix.mode > MODE_NO_FIX) {
         if(pt[0] > 0)
-            (void)strlcat(reply, ",", replylen);
-        (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                       "\"position\":{\"value\":{\"longitude\":%f,\"latitude\":%f}}",
-                       device->gpsdata.fix.longitude,
-                       device->gpsdata.fix.latitude);
+            json_out_char(&out, ',');
+        json_out_raw(&out, "\"position\":{\"value\":{\"longitude\":");
+        json_out_fixed(&out, device->gpsdata.fix.longitude, 6);
+        json_out_raw(&out, ",\"latitude\":");
+        json_out_fixed(&out, device->gpsdata.fix.latitude, 6);
+        json_out_raw(&out, "}}");
     }
 
     int go = 0;
@@ -232,20 +239,20 @@ gps_mask_t signalk_full_dump(const struct gps_device_t *device,
 
     if(go) {
         if(pt[0] > 0)
-            (void)strlcat(reply, ",", replylen);
+            json_out_char(&out, ',');
         pt[0]++;
         pt[1] = 0;
 
-        (void)strlcat(reply, "\"attitude\":{", replylen);
+        json_out_raw(&out, "\"attitude\":{");
 
         signalk_value_full_dump(device, &pt[1], device->gpsdata.attitude.roll*DEG_2_RAD,
-                                "roll", reply, replylen);
+                                "roll", &out);
         signalk_value_full_dump(device, &pt[1], device->gpsdata.attitude.pitch*DEG_2_RAD,
-                                "pitch", reply, replylen);
+                                "pitch", &out);
         signalk_value_full_dump(device, &pt[1], device->gpsdata.attitude.yaw*DEG_2_RAD,
-                                "yaw", reply, replylen);
+                                "yaw", &out);
 
-        (void)strlcat(reply, "}", replylen); // closing attitude
+        json_out_char(&out, '}'); // closing attitude
     }
 
     go = 0;
@@ -260,47 +267,47 @@ gps_mask_t signalk_full_dump(const struct gps_device_t *device,
 
     if(go) {
 
-        (void)strlcat(reply, "},\"environment\":{", replylen);
+        json_out_raw(&out, "},\"environment\":{");
         pt[0] = 0;
 
         signalk_value_full_dump(device, &pt[0], device->gpsdata.navigation.depth,
-                                "depthBelowTransducer", reply, replylen);
+                                "depthBelowTransducer", &out);
 
         if(pt[0] > 0)
-            (void)strlcat(reply, ",", replylen);
-        (void)strlcat(reply, "\"wind\":{", replylen);
+            json_out_char(&out, ',');
+        json_out_raw(&out, "\"wind\":{");
         pt[0]++;
 
         pt[1] = 0;
 
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_apparent].angle*DEG_2_RAD,
-                                "angleApparent", reply, replylen);
+                                "angleApparent", &out);
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_apparent].speed,
-                                "speedApparent", reply, replylen);
+                                "speedApparent", &out);
 
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_true_to_boat].angle*DEG_2_RAD,
-                                "angleTrueWater", reply, replylen);
+                                "angleTrueWater", &out);
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_true_to_boat].speed,
-                                "speedTrue", reply, replylen);
+                                "speedTrue", &out);
 
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_true_north].angle*DEG_2_RAD,
-                                "directionTrue", reply, replylen);
+                                "directionTrue", &out);
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_true_north].speed,
-                                "speedOverGround", reply, replylen);
+                                "speedOverGround", &out);
 
         signalk_value_full_dump(device, &pt[1], device->gpsdata.environment.wind[wind_magnetic_north].angle*DEG_2_RAD,
-                                "directionMagnetic", reply, replylen);
+                                "directionMagnetic", &out);
 
 
-        (void)strlcat(reply, "}", replylen); // closing wind
+        json_out_char(&out, '}'); // closing wind
 
         signalk_value_full_dump(device, &pt[0], device->gpsdata.environment.temp[temp_water],
-                                "waterTemp", reply, replylen);
+                                "waterTemp", &out);
     }
 
-    (void)strlcat(reply, "}", replylen); // closing environment or previous group
+    json_out_char(&out, '}'); // closing environment or previous group
 
-    (void)strlcat(reply, "}", replylen); // closing all
+    json_out_char(&out, '}'); // closing all
 
     return reported;
 }
@@ -373,8 +380,10 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
                                /*@out@*/ char reply[], size_t replylen)
 {
     gps_mask_t reported = 0;
+    struct json_out_t out;
 
-    (void)strlcpy(reply, "{\"updates\":[{", replylen);
+    json_out_init(&out, reply, replylen);
+    json_out_raw(&out, "{\"updates\":[{");
 
     /* in case we deal with a fix we also take the
        fix timestamp
@@ -383,12 +392,12 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
     */
     if(((device->gpsdata.navigation.set & LATLON_SET) != 0)
        && (device->gpsdata.fix.mode > MODE_NO_FIX)) {
-        signalk_add_fixtimestamp(device, reply, replylen);
+        signalk_add_fixtimestamp(device, &out);
     } else {
-        signalk_add_timestamp(reply, replylen);
+        signalk_add_timestamp(&out);
     }
 
-    (void)strlcat(reply, ",\"values\":[", replylen);
+    json_out_raw(&out, ",\"values\":[");
 
     // add actual values
     uint16_t pu = 0, pt = 0;
@@ -435,6 +444,26 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
          {"status",        t_real,
           .addr.real = &device->gpsdata.navigation.distance_trip,
           .dflt.real = 0.0}},
+        {"navigation.leewayAngle", NAVIGATION_SET, NAV_LEEWAY_PSET, 1.0*DEG_2_RAD,
+         {"status",        t_real,
+          .addr.real = &device->gpsdata.navigation.leeway,
+          .dflt.real = 0.0}},
+        {"navigation.courseThroughWaterTrue", NAVIGATION_SET, NAV_CTW_PSET, 1.0*DEG_2_RAD,
+         {"status",        t_real,
+          .addr.real = &device->gpsdata.navigation.course_thru_water,
+          .dflt.real = 0.0}},
+        {"performance.velocityMadeGood", NAVIGATION_SET, NAV_VMG_PSET, 1.0*KNOTS_TO_MPS,
+         {"status",        t_real,
+          .addr.real = &device->gpsdata.navigation.vmg,
+          .dflt.real = 0.0}},
+        {"environment.current.setTrue", NAVIGATION_SET, NAV_CURRENT_PSET, 1.0*DEG_2_RAD,
+         {"status",        t_real,
+          .addr.real = &device->gpsdata.navigation.current_set,
+          .dflt.real = 0.0}},
+        {"environment.current.drift", NAVIGATION_SET, NAV_CURRENT_PSET, 1.0*KNOTS_TO_MPS,
+         {"status",        t_real,
+          .addr.real = &device->gpsdata.navigation.current_drift,
+          .dflt.real = 0.0}},
         {"environment.depth.belowTransducer", NAVIGATION_SET, NAV_DPT_PSET, 1.0,
           {"status",        t_real,  .addr.real = &device->gpsdata.navigation.depth,
           .dflt.real = 0.0}},
@@ -490,22 +519,24 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
     signalk_update_engine_struct(device, path_updates_engine[starboard], starboard);
 
 
-    for(pu = 0; pu < 19; pu++) {
+    for(pu = 0; pu < sizeof(path_updates) / sizeof(path_updates[0]); pu++) {
         if(!isnan(*(double *)path_updates[pu].jattr.addr.real)) {
             if ((device->gpsdata.set & path_updates[pu].mask) != 0) {
                 if( (((device->gpsdata.navigation.set & path_updates[pu].submask) != 0) && (path_updates[pu].mask & NAVIGATION_SET))
                    || (((device->gpsdata.environment.set & path_updates[pu].submask) != 0) && (path_updates[pu].mask & ENVIRONMENT_SET)) ) {
 
                     if(pt > 0)
-                        (void)strlcat(reply, ",{", replylen);
+                        json_out_raw(&out, ",{");
                     else
-                        (void)strlcat(reply, "{", replylen);
-
-                    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                               "\"path\":\"%s\",\"value\":%.2f}",
-                               path_updates[pu].path,
-                               *(double *)path_updates[pu].jattr.addr.real
-                               * path_updates[pu].factor);
+                        json_out_char(&out, '{');
+
+                    json_out_raw(&out, "\"path\":\"");
+                    json_out_raw(&out, path_updates[pu].path);
+                    json_out_raw(&out, "\",\"value\":");
+                    json_out_fixed(&out,
+                                   *(double *)path_updates[pu].jattr.addr.real
+                                   * path_updates[pu].factor, 2);
+                    json_out_char(&out, '}');
                     reported |= path_updates[pu].mask;
                     pt++;
                 }
@@ -517,15 +548,16 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
     if((device->gpsdata.set & LATLON_SET) != 0) {
         if (device->gpsdata.fix.mode > MODE_NO_FIX) {
             if(pt > 0)
-                (void)strlcat(reply, ",{", replylen);
+                json_out_raw(&out, ",{");
             else
-                (void)strlcat(reply, "{", replylen);
+                json_out_char(&out, '{');
             pt++;
 
-            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                           "\"path\":\"navigation.position\",\"value\":{\"longitude\":%f,\"latitude\":%f}}",
-                           device->gpsdata.fix.longitude,
-                           device->gpsdata.fix.latitude);
+            json_out_raw(&out, "\"path\":\"navigation.position\",\"value\":{\"longitude\":");
+            json_out_fixed(&out, device->gpsdata.fix.longitude, 6);
+            json_out_raw(&out, ",\"latitude\":");
+            json_out_fixed(&out, device->gpsdata.fix.latitude, 6);
+            json_out_raw(&out, "}}");
             reported |= LATLON_SET;
         }
     }
@@ -533,14 +565,14 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
     if((device->gpsdata.set & ATTITUDE_SET)
        && !isnan(device->gpsdata.attitude.roll)) {
             if(pt > 0)
-                (void)strlcat(reply, ",{", replylen);
+                json_out_raw(&out, ",{");
             else
-                (void)strlcat(reply, "{", replylen);
+                json_out_char(&out, '{');
             pt++;
 
-            (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                           "\"path\":\"navigation.attitude\",\"value\":{\"roll\":%f}}",
-                           device->gpsdata.attitude.roll);
+            json_out_raw(&out, "\"path\":\"navigation.attitude\",\"value\":{\"roll\":");
+            json_out_fixed(&out, device->gpsdata.attitude.roll, 6);
+            json_out_raw(&out, "}}");
             reported |= ATTITUDE_SET;
     }
 
@@ -551,15 +583,17 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
                 if((device->gpsdata.engine.set & path_updates_engine[inst][pu].submask) != 0) {
 
                     if(pt > 0)
-                        (void)strlcat(reply, ",{", replylen);
+                        json_out_raw(&out, ",{");
                     else
-                        (void)strlcat(reply, "{", replylen);
-
-                    (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                               "\"path\":\"propulsion.port_engine.%s\",\"value\":%.2f}",
-                               path_updates_engine[inst][pu].path,
-                               *(double *)path_updates_engine[inst][pu].jattr.addr.real
-                               * path_updates_engine[inst][pu].factor);
+                        json_out_char(&out, '{');
+
+                    json_out_raw(&out, "\"path\":\"propulsion.port_engine.");
+                    json_out_raw(&out, path_updates_engine[inst][pu].path);
+                    json_out_raw(&out, "\",\"value\":");
+                    json_out_fixed(&out,
+                                   *(double *)path_updates_engine[inst][pu].jattr.addr.real
+                                   * path_updates_engine[inst][pu].factor, 2);
+                    json_out_char(&out, '}');
                     reported |= ENGINE_SET;
                     pt++;
                 }
@@ -568,16 +602,65 @@ gps_mask_t signalk_update_dump(struct gps_device_t *device,
     }
 
 
-    (void)strlcat(reply, "]}", replylen); // close values
-    (void)strlcat(reply, "],", replylen); // close updates
-    if(vessel->mmsi != 0)
-        (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                       "\"context\":\"vessels.urn:mrn:imo:mmsi:%u9\"", vessel->mmsi);
-    else
-        (void)snprintf(reply + strlen(reply), replylen - strlen(reply),
-                       "\"context\":\"vessels.urn:mrn:signalk:uuid:%s\"", vessel->uuid);
+    json_out_raw(&out, "]}"); // close values
+    json_out_raw(&out, "],"); // close updates
+    if(vessel->mmsi != 0) {
+        json_out_raw(&out, "\"context\":\"vessels.urn:mrn:imo:mmsi:");
+        json_out_uint(&out, vessel->mmsi);
+        json_out_raw(&out, "9\"");
+    } else {
+        json_out_raw(&out, "\"context\":\"vessels.urn:mrn:signalk:uuid:");
+        json_out_raw(&out, vessel->uuid);
+        json_out_char(&out, '"');
+    }
 
-    (void)strlcat(reply, "}", replylen);
+    json_out_char(&out, '}');
 
     return reported;
 }
+
+#ifdef AIVDM_ENABLE
+/*
+ * A collision alarm goes out as a notification on our own vessel, keyed
+ * by the other vessel's MMSI so that clearing it replaces the alarm.
+ */
+void signalk_cpa_dump(const struct vessel_t * vessel,
+                      const struct ais_cpa_event_t *ev,
+                      /*@null@*/ const char *shipname,
+                      /*@out@*/ char reply[], size_t replylen)
+{
+    struct json_out_t out;
+
+    json_out_init(&out, reply, replylen);
+    json_out_raw(&out, "{\"updates\":[{");
+    signalk_add_unixtimestamp(ev->time, &out);
+    json_out_raw(&out, ",\"values\":[{\"path\":"
+                 "\"notifications.navigation.closestApproach.urn:mrn:imo:mmsi:");
+    json_out_uint_pad(&out, ev->mmsi, 9);
+    json_out_raw(&out, "\",\"value\":{\"state\":\"");
+    json_out_raw(&out, ev->alarm ? "alarm" : "normal");
+    json_out_raw(&out, "\",\"method\":[");
+    if (ev->alarm)
+        json_out_raw(&out, "\"visual\",\"sound\"");
+    json_out_raw(&out, "],\"message\":\"");
+    if (shipname != NULL) {
+        json_out_string(&out, shipname);
+        json_out_char(&out, ' ');
+    }
+    if (ev->alarm)
+        json_out_printf(&out, "CPA %.0f m in %.0f s\"", ev->cpa, ev->tcpa);
+    else
+        json_out_raw(&out, "clear\"");
+    json_out_raw(&out, "}}]}],");
+    if(vessel->mmsi != 0) {
+        json_out_raw(&out, "\"context\":\"vessels.urn:mrn:imo:mmsi:");
+        json_out_uint_pad(&out, vessel->mmsi, 9);
+        json_out_char(&out, '"');
+    } else {
+        json_out_raw(&out, "\"context\":\"vessels.urn:mrn:signalk:uuid:");
+        json_out_raw(&out, vessel->uuid);
+        json_out_char(&out, '"');
+    }
+    json_out_char(&out, '}');
+}
+#endif /* AIVDM_ENABLE */
@@ -8,4 +8,11 @@ gps_mask_t signalk_full_dump(const struct gps_device_t *device,
                              const struct vessel_t * vessel,
                              /*@out@*/ char reply[], size_t replylen);
 
+#ifdef AIVDM_ENABLE
+void signalk_cpa_dump(const struct vessel_t * vessel,
+                      const struct ais_cpa_event_t *ev,
+                      /*@null@*/ const char *shipname,
+                      /*@out@*/ char reply[], size_t replylen);
+#endif /* AIVDM_ENABLE */
+
 #endif // _SIGNAL_K_
@@ -0,0 +1,354 @@
+/*
+ * test_aistargets - check the AIS target table against a brute-force model
+ *
+ * Drives the table with random position reports from more vessels than
+ * it can hold, moving them around the globe (across the antimeridian and
+ * near the poles too) and letting some go quiet, then checks every area
+ * query against a plain scan of the live targets.  Also checks that
+ * static data from type 5 and both halves of type 24 merge into the
+ * record the position reports built, and runs the CPA screening over
+ * head-on, crossing and diverging traffic.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+static struct ais_targets_t table;
+static struct ais_cpa_t cpa;
+static int failures = 0;
+
+static void position(struct ais_t *ais, unsigned int mmsi,
+		     double lat, double lon)
+{
+    (void)memset(ais, '\0', sizeof(*ais));
+    ais->type = 1;
+    ais->mmsi = mmsi;
+    ais->type1.lat = (int)lrint(lat * AIS_LATLON_DIV);
+    ais->type1.lon = (int)lrint(lon * AIS_LATLON_DIV);
+    ais->type1.speed = 123;
+    ais->type1.course = 900;
+    ais->type1.heading = AIS_HEADING_NOT_AVAILABLE;
+    ais->type1.turn = AIS_TURN_NOT_AVAILABLE;
+}
+
+static bool brute_match(const struct ais_target_t *tp,
+			const struct ais_target_query_t *q)
+{
+    bool boxed = isnan(q->minlat) == 0, circled = isnan(q->radius) == 0;
+
+    if (tp->changed <= q->since)
+	return false;
+    if (!boxed && !circled)
+	return true;
+    if (isnan(tp->lat) != 0)
+	return false;
+    if (boxed && (tp->lat < q->minlat || tp->lat > q->maxlat
+		  || (q->minlon <= q->maxlon
+		      ? (tp->lon < q->minlon || tp->lon > q->maxlon)
+		      : (tp->lon < q->minlon && tp->lon > q->maxlon))))
+	return false;
+    return !circled
+	|| earth_distance(q->lat, q->lon, tp->lat, tp->lon) <= q->radius;
+}
+
+static void check_query(const struct ais_target_query_t *q, const char *what)
+{
+    static int slots[AIS_TARGET_MAX];
+    static bool got[AIS_TARGET_MAX];
+    int i, n, want = 0;
+
+    (void)memset(got, '\0', sizeof(got));
+    n = ais_targets_select(&table, q, slots, AIS_TARGET_MAX);
+    for (i = 0; i < n; i++) {
+	if (got[slots[i]]) {
+	    (void)fprintf(stderr, "%s: slot %d reported twice\n", what,
+			  slots[i]);
+	    failures++;
+	}
+	got[slots[i]] = true;
+    }
+    for (i = 0; i < AIS_TARGET_MAX; i++) {
+	const struct ais_target_t *tp = &table.target[i];
+	bool match = tp->mmsi != 0 && brute_match(tp, q);
+
+	want += match;
+	if (match != got[i] && failures++ < 20)
+	    (void)fprintf(stderr, "%s: MMSI %u at %f %f %s\n", what,
+			  tp->mmsi, tp->lat, tp->lon,
+			  match ? "missed" : "wrongly included");
+    }
+    if (want != n && failures++ < 20)
+	(void)fprintf(stderr, "%s: %d matches, %d wanted\n", what, n, want);
+}
+
+static void check_merge(void)
+{
+    struct ais_t ais;
+    struct ais_target_query_t all = {NAN, NAN, NAN, NAN, NAN, NAN, NAN, 0};
+    const struct ais_target_t *tp;
+    int slot;
+
+    ais_targets_init(&table);
+    position(&ais, 211000001, 54.0, 10.0);
+    (void)ais_targets_update(&table, &ais, 1.0);
+
+    (void)memset(&ais, '\0', sizeof(ais));
+    ais.type = 24;
+    ais.mmsi = 211000001;
+    ais.type24.part = part_a;
+    (void)strlcpy(ais.type24.shipname, "SEAGULL", sizeof(ais.type24.shipname));
+    (void)ais_targets_update(&table, &ais, 2.0);
+    ais.type24.part = part_b;
+    ais.type24.shipname[0] = '\0';
+    ais.type24.shiptype = 37;
+    (void)strlcpy(ais.type24.callsign, "DA1234", sizeof(ais.type24.callsign));
+    ais.type24.dim.to_bow = 8;
+    ais.type24.dim.to_stern = 4;
+    (void)ais_targets_update(&table, &ais, 3.0);
+
+    (void)memset(&ais, '\0', sizeof(ais));
+    ais.type = 5;
+    ais.mmsi = 211000001;
+    ais.type5.imo = 9999999;
+    (void)strlcpy(ais.type5.shipname, "SEAGULL", sizeof(ais.type5.shipname));
+    (void)strlcpy(ais.type5.callsign, "DA1234", sizeof(ais.type5.callsign));
+    (void)strlcpy(ais.type5.destination, "KIEL",
+		  sizeof(ais.type5.destination));
+    ais.type5.shiptype = 37;
+    ais.type5.to_bow = 8;
+    ais.type5.to_stern = 4;
+    ais.type5.draught = 21;
+    (void)ais_targets_update(&table, &ais, 4.0);
+
+    if (ais_targets_select(&table, &all, &slot, 1) != 1) {
+	(void)fprintf(stderr, "merge: target missing\n");
+	failures++;
+	return;
+    }
+    tp = &table.target[slot];
+    if (strcmp(tp->shipname, "SEAGULL") != 0
+	|| strcmp(tp->callsign, "DA1234") != 0
+	|| strcmp(tp->destination, "KIEL") != 0
+	|| tp->shiptype != 37 || tp->imo != 9999999 || tp->to_bow != 8
+	|| tp->to_stern != 4 || tp->draught != 21
+	|| fabs(tp->lat - 54.0) > 1e-6 || fabs(tp->speed - 12.3) > 1e-9) {
+	(void)fprintf(stderr, "merge: static and dynamic data not combined\n");
+	failures++;
+    }
+    /* the type 5 repeated what type 24 said apart from the voyage data */
+    if (tp->changed != 4.0) {
+	(void)fprintf(stderr, "merge: change time %f\n", tp->changed);
+	failures++;
+    }
+    (void)ais_targets_update(&table, &ais, 5.0);
+    if (tp->changed != 4.0 || tp->seen != 5.0) {
+	(void)fprintf(stderr, "merge: repeat counted as a change\n");
+	failures++;
+    }
+}
+
+static void vessel(unsigned int mmsi, double lat, double lon,
+		   double course, double knots, timestamp_t now)
+{
+    struct ais_t ais;
+
+    position(&ais, mmsi, lat, lon);
+    ais.type1.course = (unsigned int)lrint(course * 10);
+    ais.type1.speed = (unsigned int)lrint(knots * 10);
+    (void)ais_targets_update(&table, &ais, now);
+    ais_cpa_target(&cpa, &table, ais_targets_lookup(&table, mmsi), now);
+}
+
+static void expect_cpa(unsigned int mmsi, double want_cpa, double want_tcpa,
+		       bool alarm, const char *what)
+{
+    int slot = ais_targets_lookup(&table, mmsi);
+    struct ais_cpa_event_t ev;
+
+    if (slot < 0) {
+	(void)fprintf(stderr, "cpa %s: target missing\n", what);
+	failures++;
+	return;
+    }
+    ais_cpa_event(&cpa, slot, mmsi, cpa.ot, &ev);
+    /* the plane is flat and positions are quantized to 1/10000 minute */
+    if (fabs(ev.cpa - want_cpa) > 5 + want_cpa * 0.01
+	|| fabs(ev.tcpa - want_tcpa) > 2 + fabs(want_tcpa) * 0.01
+	|| (cpa.danger[slot] != 0) != alarm) {
+	(void)fprintf(stderr, "cpa %s: %.0f m in %.0f s%s, wanted %.0f m "
+		      "in %.0f s%s\n", what, ev.cpa, ev.tcpa,
+		      cpa.danger[slot] ? " (danger)" : "", want_cpa, want_tcpa,
+		      alarm ? " (danger)" : "");
+	failures++;
+    }
+}
+
+static void check_cpa(void)
+{
+    /* own ship at 54N 10E, heading north at 10 knots */
+    const double lat = 54.0, lon = 10.0, v = 10 * KNOTS_TO_MPS;
+    const double mlat = 1 / 111195.0, mlon = mlat / cos(DEG_2_RAD * lat);
+    struct ais_cpa_event_t ev[8];
+    timestamp_t now = 100.0;
+    int n;
+
+    ais_targets_init(&table);
+    ais_cpa_init(&cpa);
+    ais_cpa_own(&cpa, &table, lat, lon, 0, v, now);
+
+    /* head on from 6 km north at 10 knots: 0 m in 6000/2v s */
+    vessel(211000001, lat + 6000 * mlat, lon, 180, 10, now);
+    /* crossing from 3 km west, heading east at 10 knots: meets us */
+    vessel(211000002, lat + 3000 * mlat, lon - 3000 * mlon, 90, 10, now);
+    /* on the same course 2 km to starboard: never closer */
+    vessel(211000003, lat, lon + 2000 * mlon, 0, 10, now);
+    /* 1500 m astern and going away */
+    vessel(211000004, lat - 1500 * mlat, lon, 180, 5, now);
+    /* keeping station 900 m to port */
+    vessel(211000006, lat, lon - 900 * mlon, 0, 10, now);
+    /* a base station next to us is not traffic */
+    vessel(211000005, lat, lon + 100 * mlon, 0, 0, now);
+    table.target[ais_targets_lookup(&table, 211000005)].type = 4;
+    ais_cpa_target(&cpa, &table, ais_targets_lookup(&table, 211000005), now);
+    ais_cpa_batch(&cpa, now);
+
+    expect_cpa(211000001, 0, 6000 / (2 * v), true, "head on");
+    expect_cpa(211000002, 0, 3000 / v, true, "crossing");
+    expect_cpa(211000003, 2000, 0, false, "parallel");
+    expect_cpa(211000004, 1500, -1500 / (v + 5 * KNOTS_TO_MPS), false,
+	       "diverging");
+    if (cpa.danger[ais_targets_lookup(&table, 211000005)] != 0) {
+	(void)fprintf(stderr, "cpa: base station flagged\n");
+	failures++;
+    }
+
+    n = ais_cpa_changes(&cpa, &table, -1, now, ev, 8);
+    if (n != 3 || !ev[0].alarm || !ev[1].alarm || !ev[2].alarm) {
+	(void)fprintf(stderr, "cpa: %d alarms raised, wanted 3\n", n);
+	failures++;
+    }
+    if (ais_cpa_changes(&cpa, &table, -1, now, ev, 8) != 0) {
+	(void)fprintf(stderr, "cpa: standing alarms raised again\n");
+	failures++;
+    }
+
+    /* the one to port edges out, but not past the release margin */
+    now += 10;
+    ais_cpa_own(&cpa, &table, lat + 10 * v * mlat, lon, 0, v, now);
+    vessel(211000006, lat + 10 * v * mlat, lon - 1000 * mlon, 0, 10, now);
+    n = ais_cpa_changes(&cpa, &table,
+			ais_targets_lookup(&table, 211000006), now, ev, 8);
+    if (n != 0) {
+	(void)fprintf(stderr, "cpa: %d changes inside the release band\n", n);
+	failures++;
+    }
+    vessel(211000006, lat + 10 * v * mlat, lon - 1200 * mlon, 0, 10, now);
+    n = ais_cpa_changes(&cpa, &table,
+			ais_targets_lookup(&table, 211000006), now, ev, 8);
+    if (n != 1 || ev[0].alarm || ev[0].mmsi != 211000006) {
+	(void)fprintf(stderr, "cpa: alarm to port not cleared\n");
+	failures++;
+    }
+
+    /* long after both have passed, their alarms drop */
+    now += 1200;
+    ais_cpa_own(&cpa, &table, lat + 1210 * v * mlat, lon, 0, v, now);
+    ais_cpa_batch(&cpa, now);
+    n = ais_cpa_changes(&cpa, &table, -1, now, ev, 8);
+    if (n != 2 || ev[0].alarm || ev[1].alarm) {
+	(void)fprintf(stderr, "cpa: %d alarms cleared, wanted 2\n", n);
+	failures++;
+    }
+}
+
+int main(void)
+{
+    struct ais_t ais;
+    timestamp_t now = 1000.0;
+    long k;
+    int round;
+
+    check_merge();
+    check_cpa();
+
+    ais_targets_init(&table);
+    srand48(38);
+    for (round = 0; round < 40; round++) {
+	struct ais_target_query_t q;
+	double lat = drand48() * 180 - 90, lon = drand48() * 360 - 180;
+	char what[64];
+
+	/* a mix of dense local traffic and scattered vessels */
+	for (k = 0; k < 600; k++) {
+	    unsigned int mmsi = 200000000 + (unsigned int)(lrand48() % (AIS_TARGET_MAX * 3 / 2));
+	    double tlat, tlon;
+
+	    if (k % 2 == 0) {
+		tlat = lat + (drand48() - 0.5) * 2;
+		tlon = lon + (drand48() - 0.5) * 2;
+	    } else {
+		tlat = drand48() * 180 - 90;
+		tlon = drand48() * 360 - 180;
+	    }
+	    if (tlat > 90)
+		tlat = 90;
+	    if (tlat < -90)
+		tlat = -90;
+	    if (tlon >= 180)
+		tlon -= 360;
+	    if (tlon < -180)
+		tlon += 360;
+	    position(&ais, mmsi, tlat, tlon);
+	    (void)ais_targets_update(&table, &ais, now);
+	    now += 0.5;
+	}
+	ais_targets_expire(&table, now);
+
+	q.minlat = q.minlon = q.maxlat = q.maxlon = NAN;
+	q.lat = q.lon = q.radius = NAN;
+	q.since = 0;
+	(void)snprintf(what, sizeof(what), "round %d all", round);
+	check_query(&q, what);
+
+	q.since = now - 60;
+	(void)snprintf(what, sizeof(what), "round %d since", round);
+	check_query(&q, what);
+	q.since = 0;
+
+	/* small enough to go through the grid rather than a full scan */
+	q.minlat = lat - drand48() * 0.4;
+	q.maxlat = lat + drand48() * 0.4;
+	q.minlon = lon - drand48() * 0.8;
+	q.maxlon = lon + drand48() * 0.8;
+	if (q.minlon < -180)
+	    q.minlon += 360;
+	if (q.maxlon >= 180)
+	    q.maxlon -= 360;
+	(void)snprintf(what, sizeof(what), "round %d box", round);
+	check_query(&q, what);
+
+	q.minlat = q.minlon = q.maxlat = q.maxlon = NAN;
+	q.lat = lat;
+	q.lon = lon;
+	q.radius = drand48() * 40000;
+	(void)snprintf(what, sizeof(what), "round %d circle", round);
+	check_query(&q, what);
+
+	q.radius = 3000000;
+	(void)snprintf(what, sizeof(what), "round %d wide circle", round);
+	check_query(&q, what);
+    }
+
+    if (failures != 0) {
+	(void)fprintf(stderr, "%d failures\n", failures);
+	exit(EXIT_FAILURE);
+    }
+    (void)printf("AIS target table test succeeded.\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,215 @@
+/*
+ * test_aivdm - stress the multipart AIVDM reassembly
+ *
+ * Splits type 5, 19 and 24 payloads into two or three fragments and
+ * sends them through aivdm_decode() as if four receivers were
+ * multiplexed onto one device, each using both radio channels, with the
+ * messages of every sender interleaved and some of them arriving with
+ * their fragments out of order.  Every message has to come out, decoded
+ * exactly as it is when sent in one piece.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "gpsd.h"
+
+ssize_t gpsd_write(struct gps_device_t *session,
+		   const char *buf,
+		   const size_t len)
+/* pass low-level data to devices straight through */
+{
+    return gpsd_serial_write(session, buf, len);
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel, const int errlevel,
+		 const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    gpsd_labeled_report(debuglevel, 0, errlevel, "test_aivdm:", fmt, ap);
+    va_end(ap);
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+/* assembled payloads from test/sample.aivdm */
+static const struct {
+    const char *data;
+    unsigned int pad;
+} payloads[] = {
+    {"55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp888888888880", 2},
+    {"542M92h00001@<7;?G0PD4i@R0<tqA8tj37>220o0h:2240Ht5000000000000000000002", 2},
+    {"C5N3SRgPEnJGEBT>NhWAwwo862PaLELTBJ:V00000000S0D:R220", 0},
+    {"H42O55i18tMET00000000000000", 2},
+    {"H42O55lti4hhhilD3nink000?050", 0},
+};
+#define NPAYLOADS	(int)(sizeof(payloads) / sizeof(payloads[0]))
+
+static const char *talkers[] = {"AI", "BS", "AB", "SA"};
+#define NTALKERS	4
+#define NSTREAMS	(NTALKERS * 2)	/* each talker on both channels */
+#define MESSAGES	200		/* per stream */
+#define OPEN		2		/* in flight per stream */
+
+struct message {
+    int payload, seqid, nfrags, sent;
+    int order[3];		/* which fragment goes out next */
+    int cut[4];			/* fragment boundaries in the payload */
+};
+
+struct stream {
+    int talker;
+    char channel;
+    int next;			/* messages started so far */
+    int nopen;
+    struct message open[OPEN];
+};
+
+static struct ais_t reference[NPAYLOADS];
+static struct gps_context_t context;
+static struct gps_device_t session;
+
+static void normalize(struct ais_t *ais)
+/* a 24B picks up the shipname of a queued 24A; that isn't our business */
+{
+    if (ais->type == 24 && ais->type24.part != part_a) {
+	ais->type24.part = part_b;
+	(void)memset(ais->type24.shipname, '\0',
+		     sizeof(ais->type24.shipname));
+    }
+}
+
+static bool feed(const char *talker, int nfrags, int ifrag, int seqid,
+		 char channel, const char *data, size_t len, unsigned int pad,
+		 struct ais_t *ais)
+{
+    char sentence[NMEA_MAX + 1];
+    char seq[12] = "";
+    unsigned int sum = 0;
+    size_t n;
+    char *p;
+
+    if (seqid >= 0)
+	(void)snprintf(seq, sizeof(seq), "%d", seqid);
+    n = (size_t)snprintf(sentence, sizeof(sentence), "!%sVDM,%d,%d,%s,%c,%.*s,%u",
+			 talker, nfrags, ifrag, seq, channel, (int)len, data,
+			 ifrag == nfrags ? pad : 0);
+    for (p = sentence + 1; *p != '\0'; p++)
+	sum ^= (unsigned char)*p;
+    (void)snprintf(sentence + n, sizeof(sentence) - n, "*%02X\r\n", sum);
+    return aivdm_decode(sentence, strlen(sentence), &session, ais, 0);
+}
+
+static void start(struct stream *sp, struct message *mp)
+{
+    const char *data = payloads[mp->payload = sp->next % NPAYLOADS].data;
+    int len = (int)strlen(data), i;
+
+    mp->seqid = sp->next % 10;
+    mp->nfrags = 2 + (int)(lrand48() % 2);
+    mp->sent = 0;
+    mp->cut[0] = 0;
+    mp->cut[mp->nfrags] = len;
+    for (i = 1; i < mp->nfrags; i++)
+	mp->cut[i] = len * i / mp->nfrags + (int)(lrand48() % 3) - 1;
+    for (i = 0; i < mp->nfrags; i++)
+	mp->order[i] = i;
+    /* a quarter of the messages arrive shuffled */
+    if (lrand48() % 4 == 0)
+	for (i = mp->nfrags - 1; i > 0; i--) {
+	    int j = (int)(lrand48() % (i + 1)), t = mp->order[i];
+
+	    mp->order[i] = mp->order[j];
+	    mp->order[j] = t;
+	}
+    sp->next++;
+}
+
+int main(void)
+{
+    struct stream streams[NSTREAMS];
+    struct ais_t ais;
+    int i, pending = NSTREAMS, expected = 0, good = 0, failures = 0;
+
+    gps_context_init(&context);
+    session.context = &context;
+
+    /* what each payload decodes to when it comes in one piece */
+    for (i = 0; i < NPAYLOADS; i++) {
+	if (!feed("AI", 1, 1, -1, 'A', payloads[i].data,
+		  strlen(payloads[i].data), payloads[i].pad, &reference[i])) {
+	    (void)fprintf(stderr, "payload %d doesn't decode\n", i);
+	    exit(EXIT_FAILURE);
+	}
+	normalize(&reference[i]);
+    }
+
+    srand48(39);
+    for (i = 0; i < NSTREAMS; i++) {
+	streams[i].talker = i / 2;
+	streams[i].channel = i % 2 ? 'B' : 'A';
+	streams[i].next = 0;
+	streams[i].nopen = 0;
+    }
+
+    while (pending > 0) {
+	struct stream *sp = &streams[lrand48() % NSTREAMS];
+	struct message *mp;
+	int k, frag;
+
+	while (sp->nopen < OPEN && sp->next < MESSAGES)
+	    start(sp, &sp->open[sp->nopen++]);
+	if (sp->nopen == 0)
+	    continue;
+	mp = &sp->open[lrand48() % sp->nopen];
+	frag = mp->order[mp->sent++];
+	k = mp->cut[frag];
+	if (feed(talkers[sp->talker], mp->nfrags, frag + 1, mp->seqid,
+		 sp->channel, payloads[mp->payload].data + k,
+		 (size_t)(mp->cut[frag + 1] - k),
+		 payloads[mp->payload].pad, &ais)) {
+	    normalize(&ais);
+	    if (mp->sent != mp->nfrags) {
+		if (failures++ < 20)
+		    (void)fprintf(stderr, "%s %c #%d: decoded early\n",
+				  talkers[sp->talker], sp->channel, mp->seqid);
+	    } else if (memcmp(&ais, &reference[mp->payload], sizeof(ais)) != 0) {
+		if (failures++ < 20)
+		    (void)fprintf(stderr, "%s %c #%d: wrong decode\n",
+				  talkers[sp->talker], sp->channel, mp->seqid);
+	    } else
+		good++;
+	}
+	if (mp->sent == mp->nfrags) {
+	    expected++;
+	    *mp = sp->open[--sp->nopen];
+	    if (sp->nopen == 0 && sp->next == MESSAGES)
+		pending--;
+	}
+    }
+
+    if (good != expected || session.driver.aivdm.reassembly.dropped != 0) {
+	(void)fprintf(stderr, "%d of %d messages decoded, %lu dropped\n",
+		      good, expected, session.driver.aivdm.reassembly.dropped);
+	failures++;
+    }
+    if (failures != 0)
+	exit(EXIT_FAILURE);
+    (void)printf("AIVDM reassembly test succeeded, %d messages.\n", good);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,219 @@
+/*
+ * test_arbiter - check the choice of source per data item
+ *
+ * A preferred device must take an item over at once and the others
+ * must get it only when it has gone quiet for the item's timeout;
+ * what a device loses must be masked out of its report and come back
+ * on restore; and the heading filter and course smoothing must follow
+ * a steady turn and hold a noisy course through north.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+/* the arbiter is in the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static struct arbiter_t arb;
+static struct gps_data_t data;
+static struct arbiter_saved_t saved;
+static int failures = 0;
+
+static void check(bool ok, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!ok) {
+	va_start(ap, fmt);
+	(void)vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	(void)fputc('\n', stderr);
+	failures++;
+    }
+}
+
+static gps_mask_t offer(int device, gps_mask_t navset, timestamp_t now)
+/* a navigation report, restored again */
+{
+    gps_mask_t published;
+
+    data.set = NAVIGATION_SET | ONLINE_SET;
+    data.navigation.set = navset;
+    published = arbiter_update(&arb, device, &data, data.set, now, &saved);
+    if ((published & NAVIGATION_SET) == 0)
+	check((data.set & NAVIGATION_SET) == 0,
+	      "NAVIGATION_SET left in the data");
+    navset = data.navigation.set;
+    arbiter_restore(&data, &saved);
+    check(data.set == (NAVIGATION_SET | ONLINE_SET)
+	  && data.navigation.set == saved.navset, "not restored");
+    return (published & NAVIGATION_SET) != 0 ? navset : 0;
+}
+
+static void priority(void)
+{
+    const gps_mask_t hdg = NAV_HDG_MAGN_PSET;
+    timestamp_t now = 1000.0;
+
+    arbiter_init(&arb);
+    (void)arbiter_prefer(&arb, arbiter_heading, 1);
+    (void)arbiter_prefer(&arb, arbiter_heading, 0);
+
+    check(offer(2, hdg, now) == hdg, "first source not taken");
+    check(offer(0, hdg, now) == hdg, "preferred source did not take over");
+    check(offer(2, hdg, now + 0.1) == 0, "worse source published");
+    check(offer(1, hdg, now + 0.2) == hdg, "best source did not take over");
+    check(offer(0, hdg, now + 0.3) == 0, "second best published");
+    check(arb.item[arbiter_heading].device == 1
+	  && arb.item[arbiter_heading].switches == 2, "%d switches",
+	  arb.item[arbiter_heading].switches);
+
+    /* the best goes quiet, the next to speak fails over */
+    check(offer(0, hdg, now + 2.2) == 0, "failed over before the timeout");
+    check(offer(2, hdg, now + 2.3) == hdg, "no failover after the timeout");
+    check(offer(0, hdg, now + 2.4) == hdg, "preferred source not back");
+    check(offer(1, hdg, now + 2.5) == hdg, "best source not back");
+
+    /* devices not listed keep the item among themselves */
+    check(offer(5, NAV_DPT_PSET, now) == NAV_DPT_PSET, "depth not taken");
+    check(offer(6, NAV_DPT_PSET, now + 1.0) == 0, "unlisted tie moved");
+    check(offer(6, NAV_DPT_PSET, now + 6.5) == NAV_DPT_PSET,
+	  "depth did not fail over");
+}
+
+static void masks(void)
+{
+    gps_mask_t published;
+    timestamp_t now = 1000.0;
+
+    arbiter_init(&arb);
+
+    /* a report keeps what it wins and loses the rest */
+    (void)offer(0, NAV_HDG_TRUE_PSET, now);
+    check(offer(1, NAV_HDG_TRUE_PSET | NAV_DPT_PSET | NAV_DIST_TOT_PSET, now)
+	  == (NAV_DPT_PSET | NAV_DIST_TOT_PSET), "mixed report masked wrong");
+
+    /* a fix that loses takes its time and report along */
+    data.set = TIME_SET | LATLON_SET | MODE_SET | REPORT_IS;
+    (void)arbiter_update(&arb, 3, &data, data.set, now, &saved);
+    arbiter_restore(&data, &saved);
+    data.set = TIME_SET | LATLON_SET | MODE_SET | REPORT_IS | ATTITUDE_SET;
+    published = arbiter_update(&arb, 4, &data, data.set, now, &saved);
+    check(published == ATTITUDE_SET && data.set == ATTITUDE_SET,
+	  "lost fix not masked");
+    arbiter_restore(&data, &saved);
+    check((data.set & REPORT_IS) != 0, "fix not restored");
+
+    /* a device not known passes everything through */
+    data.set = LATLON_SET;
+    check(arbiter_update(&arb, -1, &data, data.set, now, &saved)
+	  == LATLON_SET, "unknown device masked");
+}
+
+static void heading(void)
+{
+    timestamp_t now = 1000.0;
+    double err = 0, raw = 0, h;
+    int i;
+
+    arbiter_init(&arb);
+    check(arbiter_set(&arb, arbiter_heading, 2.0, 1.0), "smooth refused");
+    check(!arbiter_set(&arb, arbiter_heading, 0, 1.0), "zero timeout taken");
+
+    /* without a rate of turn the compass passes through */
+    data.navigation.heading[compass_magnetic] = 299.0;
+    (void)offer(0, NAV_HDG_MAGN_PSET, now);
+    check(arb.heading[compass_magnetic] == 299.0, "heading %f",
+	  arb.heading[compass_magnetic]);
+
+    /* a steady turn of 10 deg/s through north, the compass +-4 */
+    for (i = 0; i < 100; i++, now += 0.1) {
+	h = fmod(300.0 + i, 360.0);
+	data.navigation.rate_of_turn = 10.0;
+	(void)offer(1, NAV_ROT_PSET, now);
+	data.navigation.heading[compass_magnetic] =
+	    fmod(h + (i % 2 ? 4.0 : -4.0) + 360.0, 360.0);
+	data.set = NAVIGATION_SET;
+	data.navigation.set = NAV_HDG_MAGN_PSET;
+	(void)arbiter_update(&arb, 0, &data, data.set, now, &saved);
+	if (i >= 50) {
+	    err += fabs(remainder(data.navigation.heading[compass_magnetic]
+				  - h, 360.0));
+	    raw += 4.0;
+	}
+	arbiter_restore(&data, &saved);
+    }
+    check(err < raw / 4, "filtered error %.2f, raw %.2f", err / 50,
+	  raw / 50);
+}
+
+static void course(void)
+{
+    timestamp_t now = 1000.0;
+    double cog = 0, sog = 0;
+    int i;
+
+    arbiter_init(&arb);
+    (void)arbiter_set(&arb, arbiter_course, 3.0, 2.0);
+
+    /* a course that swings across north must stay around north */
+    for (i = 0; i < 50; i++, now += 0.2) {
+	data.navigation.speed_over_ground = 5.0;
+	data.navigation.course_over_ground[compass_true] = i % 2 ? 350.0 : 10.0;
+	data.navigation.course_over_ground[compass_magnetic] =
+	    i % 2 ? 345.0 : 5.0;
+	data.set = NAVIGATION_SET;
+	data.navigation.set = NAV_SOG_PSET | NAV_COG_TRUE_PSET
+	    | NAV_COG_MAGN_PSET;
+	(void)arbiter_update(&arb, 0, &data, data.set, now, &saved);
+	cog = data.navigation.course_over_ground[compass_true];
+	sog = data.navigation.speed_over_ground;
+	check(fabs(remainder(data.navigation.course_over_ground
+			     [compass_magnetic] - cog + 5.0, 360.0)) < 1e-9,
+	      "magnetic course lost its offset");
+	arbiter_restore(&data, &saved);
+    }
+    check(fabs(remainder(cog, 360.0)) < 3.0, "course %.1f, not north", cog);
+    check(fabs(sog - 5.0 * cos(10.0 * DEG_2_RAD)) < 0.05, "speed %.2f", sog);
+    check(data.navigation.course_over_ground[compass_true] == 350.0,
+	  "smoothed course not restored");
+}
+
+int main(void)
+{
+    priority();
+    masks();
+    heading();
+    course();
+    if (failures == 0)
+	(void)printf("source arbiter test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
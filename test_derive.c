@@ -0,0 +1,342 @@
+/*
+ * test_derive - check the derived wind, VMG, leeway and current
+ *
+ * Each derived quantity must come out at its known value from inputs
+ * that arrive in separate reports, with its PSET bits set, and go away
+ * again on restore; a report must not lose what it carries itself; and
+ * a report that feeds no rule, or whose inputs have gone stale, must
+ * run nothing.  With -b it times the engine over a mixed stream of
+ * wind, compass, log, GPS, depth and attitude reports:
+ *
+ *	test_derive -b
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+#define BENCH_REPEAT	1000000	/* reports timed */
+#define CLOSE		1e-6
+
+/* the engine is in the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static struct derive_t derive;
+static struct gps_data_t data;
+static struct derive_saved_t saved;
+static int failures = 0;
+
+static void check(bool ok, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!ok) {
+	va_start(ap, fmt);
+	(void)vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	(void)fputc('\n', stderr);
+	failures++;
+    }
+}
+
+static bool near(double got, double want)
+{
+    return fabs(got - want) < CLOSE;
+}
+
+static gps_mask_t helm(gps_mask_t navset, double hdg, double stw, double cog,
+		       double sog, timestamp_t now)
+/* a navigation report, left for the caller to look at and restore */
+{
+    data.set = NAVIGATION_SET;
+    data.navigation.set = navset;
+    data.navigation.heading[compass_true] = hdg;
+    data.navigation.speed_thru_water = stw;
+    data.navigation.course_over_ground[compass_true] = cog;
+    data.navigation.speed_over_ground = sog;
+    return derive_update(&derive, &data, data.set, now, &saved);
+}
+
+static gps_mask_t wind(gps_mask_t envset, double awa, double aws,
+		       double variation, timestamp_t now)
+/* an environment report, the speed in knots */
+{
+    data.set = ENVIRONMENT_SET;
+    data.environment.set = envset;
+    data.environment.wind[wind_apparent].angle = awa;
+    data.environment.wind[wind_apparent].speed = aws * KNOTS_TO_MPS;
+    data.environment.variation = variation;
+    return derive_update(&derive, &data, data.set, now, &saved);
+}
+
+#define APPARENT	(ENV_WIND_APPARENT_ANGLE_PSET | ENV_WIND_APPARENT_SPEED_PSET)
+#define TRUE_WIND	(ENV_WIND_TRUE_TO_BOAT_ANGLE_PSET \
+			 | ENV_WIND_TRUE_TO_BOAT_SPEED_PSET)
+#define NORTH_WIND	(ENV_WIND_TRUE_NORTH_ANGLE_PSET \
+			 | ENV_WIND_TRUE_NORTH_SPEED_PSET)
+#define MAGN_WIND	(ENV_WIND_MAGN_ANGLE_PSET | ENV_WIND_MAGN_SPEED_PSET)
+
+static void true_wind(void)
+{
+    const struct environment_t *env = &data.environment;
+    timestamp_t now = 1000.0;
+    gps_mask_t changed;
+
+    derive_init(&derive);
+    changed = helm(NAV_HDG_TRUE_PSET | NAV_STW_PSET, 10.0, 5.0, 0, 0, now);
+    check(changed == NAVIGATION_SET && data.navigation.set
+	  == (NAV_HDG_TRUE_PSET | NAV_STW_PSET), "nothing to derive, but did");
+    derive_restore(&data, &saved);
+
+    /* 5 knots on the beam at 5 knots: true wind 135 at 7.07 knots */
+    changed = wind(APPARENT, 90.0, 5.0, NAN, now + 0.1);
+    check(changed == (ENVIRONMENT_SET | NAVIGATION_SET),
+	  "mask %llx", (unsigned long long)changed);
+    check(env->set == (APPARENT | TRUE_WIND | NORTH_WIND),
+	  "wind PSETs %llx", (unsigned long long)env->set);
+    check(near(env->wind[wind_true_to_boat].angle, 135.0)
+	  && near(env->wind[wind_true_to_boat].speed,
+		  sqrt(50.0) * KNOTS_TO_MPS), "true wind %f at %f",
+	  env->wind[wind_true_to_boat].angle,
+	  env->wind[wind_true_to_boat].speed);
+    /* no course over ground, so the direction is through the water */
+    check(near(env->wind[wind_true_north].angle, 145.0),
+	  "true wind direction %f", env->wind[wind_true_north].angle);
+    check(data.navigation.set == NAV_VMG_PSET
+	  && near(data.navigation.vmg, -5.0 * sqrt(0.5)),
+	  "VMG %f", data.navigation.vmg);
+
+    derive_restore(&data, &saved);
+    check(data.set == ENVIRONMENT_SET && env->set == APPARENT
+	  && data.navigation.set == (NAV_HDG_TRUE_PSET | NAV_STW_PSET)
+	  && env->wind[wind_true_north].angle == 0, "not restored");
+
+    /* a report with a true wind of its own keeps it */
+    data.environment.wind[wind_true_to_boat].angle = 42.0;
+    (void)wind(APPARENT | TRUE_WIND, 90.0, 5.0, NAN, now + 0.2);
+    check(env->wind[wind_true_to_boat].angle == 42.0,
+	  "reported true wind overwritten");
+    derive_restore(&data, &saved);
+}
+
+static void ground_wind(void)
+{
+    const struct environment_t *env = &data.environment;
+    timestamp_t now = 1000.0;
+
+    derive_init(&derive);
+    /* steering the course made good, so the current is nil */
+    (void)helm(NAV_HDG_TRUE_PSET | NAV_STW_PSET | NAV_COG_TRUE_PSET
+	       | NAV_SOG_PSET, 10.0, 5.0, 10.0, 5.0, now);
+    check((data.navigation.set & NAV_CURRENT_PSET) != 0
+	  && data.navigation.current_drift < CLOSE, "drift %f",
+	  data.navigation.current_drift);
+    derive_restore(&data, &saved);
+
+    (void)wind(APPARENT | ENV_VARIATION_PSET, 90.0, 5.0, 3.0, now + 0.1);
+    check((env->set & (NORTH_WIND | MAGN_WIND)) == (NORTH_WIND | MAGN_WIND),
+	  "ground wind PSETs %llx", (unsigned long long)env->set);
+    check(near(env->wind[wind_true_north].angle, 145.0)
+	  && near(env->wind[wind_true_north].speed,
+		  sqrt(50.0) * KNOTS_TO_MPS), "ground wind %f at %f",
+	  env->wind[wind_true_north].angle, env->wind[wind_true_north].speed);
+    check(near(env->wind[wind_magnetic_north].angle, 142.0),
+	  "magnetic wind direction %f", env->wind[wind_magnetic_north].angle);
+    derive_restore(&data, &saved);
+}
+
+static void current(void)
+{
+    timestamp_t now = 1000.0;
+
+    derive_init(&derive);
+    /* heading north at 5 knots and going east at 5 knots */
+    (void)helm(NAV_HDG_TRUE_PSET | NAV_STW_PSET | NAV_COG_TRUE_PSET
+	       | NAV_SOG_PSET, 0.0, 5.0, 90.0, 5.0, now);
+    check((data.navigation.set & NAV_CURRENT_PSET) != 0
+	  && (data.navigation.set & NAV_HDG_TRUE_PSET) != 0,
+	  "current PSETs %llx", (unsigned long long)data.navigation.set);
+    check(near(data.navigation.current_set, 135.0)
+	  && near(data.navigation.current_drift, sqrt(50.0)),
+	  "current %f at %f", data.navigation.current_set,
+	  data.navigation.current_drift);
+    derive_restore(&data, &saved);
+}
+
+static void leeway(void)
+{
+    timestamp_t now = 1000.0;
+    gps_mask_t changed;
+
+    derive_init(&derive);
+    (void)helm(NAV_HDG_TRUE_PSET | NAV_STW_PSET, 0.0, 5.0, 0, 0, now);
+    derive_restore(&data, &saved);
+    data.set = ATTITUDE_SET;
+    data.attitude.roll = 10.0;
+    changed = derive_update(&derive, &data, data.set, now, &saved);
+    check(changed == ATTITUDE_SET, "leeway without a coefficient");
+    derive_restore(&data, &saved);
+
+    /* 9 degrees per degree at a knot, 10 degrees of heel at 5 knots */
+    derive.leeway_k = 9.0;
+    changed = derive_update(&derive, &data, data.set, now + 0.1, &saved);
+    check(changed == (ATTITUDE_SET | NAVIGATION_SET)
+	  && data.navigation.set == (NAV_LEEWAY_PSET | NAV_CTW_PSET),
+	  "leeway PSETs %llx", (unsigned long long)data.navigation.set);
+    check(near(data.navigation.leeway, 3.6)
+	  && near(data.navigation.course_thru_water, 3.6),
+	  "leeway %f, course through the water %f", data.navigation.leeway,
+	  data.navigation.course_thru_water);
+    derive_restore(&data, &saved);
+}
+
+static void incremental(void)
+{
+    timestamp_t now = 1000.0;
+    unsigned long runs;
+    gps_mask_t changed;
+
+    derive_init(&derive);
+    (void)helm(NAV_HDG_TRUE_PSET | NAV_STW_PSET, 10.0, 5.0, 0, 0, now);
+    derive_restore(&data, &saved);
+    (void)wind(APPARENT, 90.0, 5.0, NAN, now);
+    derive_restore(&data, &saved);
+
+    /* the depth feeds nothing */
+    runs = derive.runs;
+    data.set = NAVIGATION_SET;
+    data.navigation.set = NAV_DPT_PSET;
+    changed = derive_update(&derive, &data, data.set, now, &saved);
+    check(derive.runs == runs && changed == NAVIGATION_SET
+	  && data.navigation.set == NAV_DPT_PSET, "depth ran %lu rules",
+	  derive.runs - runs);
+    derive_restore(&data, &saved);
+
+    /* the wind feeds the true wind, its direction and the VMG */
+    (void)wind(APPARENT, 80.0, 5.0, NAN, now + 0.5);
+    check(derive.runs == runs + 3, "wind ran %lu rules", derive.runs - runs);
+    derive_restore(&data, &saved);
+
+    /* the log has gone quiet */
+    runs = derive.runs;
+    changed = wind(APPARENT, 80.0, 5.0, NAN, now + derive.timeout + 1);
+    check(derive.runs == runs && changed == ENVIRONMENT_SET
+	  && data.environment.set == APPARENT, "stale inputs ran %lu rules",
+	  derive.runs - runs);
+    derive_restore(&data, &saved);
+}
+
+static double since(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void benchmark(void)
+/* wind, compass and attitude at 10 Hz, log, GPS and depth at 1 Hz */
+{
+    struct timespec t0;
+    timestamp_t now = 1000.0;
+    double t;
+    int i;
+
+    derive_init(&derive);
+    derive.leeway_k = 9.0;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < BENCH_REPEAT; i++) {
+	now += 0.1 / 3;
+	switch (i % 30) {
+	case 0:
+	    (void)helm(NAV_STW_PSET | NAV_COG_TRUE_PSET | NAV_SOG_PSET,
+		       NAN, 6.0, 95.0, 6.5, now);
+	    break;
+	case 1:
+	    data.set = NAVIGATION_SET;
+	    data.navigation.set = NAV_DPT_PSET;
+	    (void)derive_update(&derive, &data, data.set, now, &saved);
+	    break;
+	default:
+	    switch (i % 3) {
+	    case 0:
+		(void)wind(APPARENT, 40.0 + i % 7, 12.0, NAN, now);
+		break;
+	    case 1:
+		(void)helm(NAV_HDG_TRUE_PSET, 88.0 + i % 5, NAN, NAN, NAN,
+			   now);
+		break;
+	    default:
+		data.set = ATTITUDE_SET;
+		data.attitude.roll = 12.0 + i % 3;
+		(void)derive_update(&derive, &data, data.set, now, &saved);
+	    }
+	}
+	derive_restore(&data, &saved);
+    }
+    t = since(&t0);
+    (void)printf("%d reports: %.1f ns/report, %.2f rules/report\n",
+		 BENCH_REPEAT, t * 1e9 / BENCH_REPEAT,
+		 (double)derive.runs / BENCH_REPEAT);
+}
+
+int main(int argc, char **argv)
+{
+    bool bench = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "b")) != -1) {
+	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_derive [-b]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    if (bench) {
+	benchmark();
+	exit(EXIT_SUCCESS);
+    }
+    true_wind();
+    ground_wind();
+    current();
+    leeway();
+    incremental();
+    if (failures == 0)
+	(void)printf("derived data test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
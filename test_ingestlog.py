@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+# encoding: utf-8
+#
+# This file is Copyright (c) 2010 by the GPSD project
+# BSD terms apply: see the file COPYING in the distribution root for details.
+"""test_ingestlog.py
+
+Run gpsd with per-device reader threads (-r) while clients watch its
+log.  The readers log as they decode a pty and a UDP source; those lines
+must reach the log watchers through the main thread.  Meanwhile log
+watchers come and go, and one of them never reads, so gpsd drops
+clients while readers are logging.  The daemon has to survive that and
+still answer queries.  The watchers name no subsystems, so they must
+see the websocket handling's log lines as well.
+
+Usage:
+    ./test_ingestlog.py [-g gpsd] [-s seconds]
+"""
+
+from __future__ import print_function
+
+import getopt
+import os
+import pty
+import socket
+import subprocess
+import sys
+import time
+
+GPSD_PORT = 12949
+UDP_PORT = 12950
+NMEA = [b"$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A",
+        b"$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47",
+        b"$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48"]
+HANDSHAKE = ("GET /debug?level=6 HTTP/1.1\r\n"
+             "Host: localhost:%d\r\n"
+             "Upgrade: websocket\r\n"
+             "Connection: Upgrade\r\n"
+             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+             "Sec-WebSocket-Version: 13\r\n\r\n" % GPSD_PORT).encode("ascii")
+
+
+def log_watcher(reads=True):
+    "a websocket client on the /debug resource"
+    s = socket.create_connection(("127.0.0.1", GPSD_PORT))
+    if not reads:
+        s.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+    s.sendall(HANDSHAKE)
+    s.setblocking(False)
+    return s
+
+
+def drain(s):
+    "whatever the socket has for us"
+    data = b""
+    try:
+        while True:
+            chunk = s.recv(65536)
+            if not chunk:
+                break
+            data += chunk
+    except (OSError, socket.error):
+        pass
+    return data
+
+
+def main():
+    gpsd = "./gpsd"
+    seconds = 5
+    (options, _) = getopt.getopt(sys.argv[1:], "g:s:h")
+    for (opt, val) in options:
+        if opt == "-g":
+            gpsd = val
+        elif opt == "-s":
+            seconds = int(val)
+        else:
+            print(__doc__)
+            sys.exit(0)
+
+    (master, slave) = pty.openpty()
+    sources = [os.ttyname(slave), "udp://127.0.0.1:%d" % UDP_PORT]
+    with open(os.devnull, "w") as null:
+        daemon = subprocess.Popen([gpsd, "-N", "-n", "-r", "-D", "6",
+                                   "-S", str(GPSD_PORT)] + sources,
+                                  stdout=null, stderr=null)
+    time.sleep(1)
+    watcher = log_watcher()
+    stuck = log_watcher(reads=False)
+    udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    end = time.time() + seconds
+    log = b""
+    churn = None
+    n = 0
+    while time.time() < end and daemon.poll() is None:
+        sentence = NMEA[n % len(NMEA)] + b"\r\n"
+        os.write(master, sentence)
+        udp.sendto(sentence, ("127.0.0.1", UDP_PORT))
+        if churn is not None:
+            churn.close()
+        churn = log_watcher()
+        log += drain(watcher)
+        n += 1
+        time.sleep(0.002)
+
+    errors = 0
+    if daemon.poll() is not None:
+        print("test_ingestlog: gpsd died with status %d" % daemon.returncode,
+              file=sys.stderr)
+        sys.exit(1)
+    if b"GPRMC" not in log:
+        print("test_ingestlog: no reader log lines in %d bytes of log"
+              % len(log), file=sys.stderr)
+        errors += 1
+    # a watcher that names no subsystems gets them all
+    if b"incoming resource request" not in log:
+        print("test_ingestlog: no websocket log lines without sub=",
+              file=sys.stderr)
+        errors += 1
+
+    query = socket.create_connection(("127.0.0.1", GPSD_PORT))
+    query.sendall(b"?VERSION;\n")
+    query.setblocking(False)
+    time.sleep(0.5)
+    if b'"class":"VERSION"' not in drain(query):
+        print("test_ingestlog: no answer to ?VERSION", file=sys.stderr)
+        errors += 1
+
+    # gpsd lingers on close, so let go of the unread data first
+    for s in (watcher, stuck, churn, query):
+        s.close()
+    daemon.terminate()
+    daemon.wait()
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,11 @@
 /* json.c - unit test for JSON partsing into fixed-extent structures
+ *
+ * With -b it times the test cases instead, then libgps_json_unpack() on
+ * every line of the JSON report streams given (e.g. gpspipe -w captures
+ * or gpsdecode output):
+ *
+ *	gpsdecode < test/sample.aivdm > ais.json
+ *	test_json -b ais.json
  *
  * This file is Copyright (c) 2010 by the GPSD project
  * BSD terms apply: see the file COPYING in the distribution root for details.
@@ -10,6 +17,7 @@
 #include <string.h>
 #include <stddef.h>
 #include <getopt.h>
+#include <time.h>
 
 #include "gpsd.h"
 #include "gps_json.h"
@@ -325,13 +333,72 @@ static void jsontest(int i)
     }
 }
 
+#define BENCH_CASES	20000	/* passes over the test cases when timing */
+#define BENCH_REPEAT	50	/* unpacks of each report when timing */
+
+static double elapsed(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void benchmark(int argc, char *argv[])
+{
+    struct timespec t0;
+    unsigned long reports = 0;
+    size_t bytes = 0;
+    double seconds;
+    int i, n;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (n = 0; n < BENCH_CASES; n++)
+	for (i = 1; i <= MAXTEST; i++)
+	    jsontest(i);
+    seconds = elapsed(&t0);
+    (void)printf("test cases: %d parses in %.3fs, %.0f parses/s\n",
+		 BENCH_CASES * MAXTEST, seconds,
+		 BENCH_CASES * MAXTEST / seconds);
+
+    seconds = 0;
+    for (i = 0; i < argc; i++) {
+	char line[GPS_JSON_RESPONSE_MAX * 4];
+	FILE *fp;
+
+	if ((fp = fopen(argv[i], "r")) == NULL) {
+	    (void)fprintf(stderr, "test_json: can't open %s\n", argv[i]);
+	    exit(EXIT_FAILURE);
+	}
+	while (fgets(line, (int)sizeof(line), fp) != NULL) {
+	    if (line[0] != '{')
+		continue;
+	    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+	    for (n = 0; n < BENCH_REPEAT; n++)
+		(void)libgps_json_unpack(line, &gpsdata, NULL);
+	    seconds += elapsed(&t0);
+	    reports += BENCH_REPEAT;
+	    bytes += strlen(line) * BENCH_REPEAT;
+	}
+	(void)fclose(fp);
+    }
+    if (reports > 0)
+	(void)printf("%lu unpacks in %.3fs: %.0f unpacks/s, %.1f MB/s\n",
+		     reports, seconds, reports / seconds,
+		     bytes / seconds / 1e6);
+}
+
 int main(int argc UNUSED, char *argv[]UNUSED)
 {
     int option;
     int individual = 0;
+    bool bench = false;
 
-    while ((option = getopt(argc, argv, "hn:D:?")) != -1) {
+    while ((option = getopt(argc, argv, "bhn:D:?")) != -1) {
 	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
 	case 'D':
 	    gps_enable_debug(atoi(optarg), stdout);
 	    break;
@@ -341,11 +408,16 @@ int main(int argc UNUSED, char *argv[]UNUSED)
 	case '?':
 	case 'h':
 	default:
-	    (void)fputs("usage: test_json [-D lvl]\n", stderr);
+	    (void)fputs("usage: test_json [-D lvl] [-b [file...]]\n", stderr);
 	    exit(EXIT_FAILURE);
 	}
     }
 
+    if (bench) {
+	benchmark(argc - optind, argv + optind);
+	exit(EXIT_SUCCESS);
+    }
+
     (void)fprintf(stderr, "JSON unit test ");
 
     if (individual)
@@ -0,0 +1,262 @@
+/*
+ * test_jsonout - exercise the cursor-based JSON writer
+ *
+ * With no arguments, checks that the hand-rolled number conversions
+ * agree with printf for the formats the dumpers use.  With -d it decodes
+ * the logs given and writes every report as TPV, SKY, ATT and AIS (both
+ * scaled and unscaled), which is what to diff against an older build.
+ * With -b it times json_data_report() on each report of the logs:
+ *
+ *	test_jsonout -b test/daemon/<name>.log ...
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "gps_json.h"
+
+#define BENCH_REPEAT	50	/* encodes of each report when timing */
+
+ssize_t gpsd_write(struct gps_device_t *session,
+		   const char *buf,
+		   const size_t len)
+/* pass low-level data to devices straight through */
+{
+    return gpsd_serial_write(session, buf, len);
+}
+
+void gpsd_throttled_report(const int subsys UNUSED,
+			   const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static int failures = 0;
+
+static void check_fixed(double x, int decimals)
+{
+    char want[64], got[64];
+    struct json_out_t out;
+
+    (void)snprintf(want, sizeof(want), "%.*f", decimals, x);
+    json_out_init(&out, got, sizeof(got));
+    json_out_fixed(&out, x, decimals);
+    if (strcmp(want, got) != 0) {
+	(void)fprintf(stderr, "%%.%df of %.17g: printf %s, writer %s\n",
+		      decimals, x, want, got);
+	failures++;
+    }
+}
+
+static void check_int(long long v)
+{
+    char want[32], got[32];
+    struct json_out_t out;
+
+    (void)snprintf(want, sizeof(want), "%lld", v);
+    json_out_init(&out, got, sizeof(got));
+    json_out_int(&out, v);
+    if (strcmp(want, got) != 0) {
+	(void)fprintf(stderr, "%%lld: printf %s, writer %s\n", want, got);
+	failures++;
+    }
+}
+
+static void selftest(void)
+{
+    static const double edges[] = {
+	0.0, -0.0, 0.5, -0.5, 1.5, 2.5, 0.05, 0.15, 0.25, 0.35, 0.45,
+	0.125, 0.0005, 0.9999999995, 9.5, 99.95, 179.99995, -179.99995,
+	1e-12, -1e-12, 1e14, 1e16, -1e16, 1e300, 123456789.123456789,
+	HUGE_VAL, -HUGE_VAL,
+    };
+    static const long long ints[] = {
+	0, 1, -1, 9, 10, -10, 99, 100, 4294967295LL, -2147483648LL,
+	9223372036854775807LL, -9223372036854775807LL - 1,
+    };
+    char small[8];
+    struct json_out_t out;
+    unsigned int i;
+    int d;
+
+    for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+	for (d = 0; d <= 9; d++)
+	    check_fixed(edges[i], d);
+    check_fixed(NAN, 3);
+    check_fixed(11.0, 12);
+    for (i = 0; i < sizeof(ints) / sizeof(ints[0]); i++)
+	check_int(ints[i]);
+
+    /* the ranges the dumpers actually see */
+    srand48(1);
+    for (i = 0; i < 2000000; i++) {
+	double x;
+
+	switch (i % 5) {
+	case 0:			/* latitude/longitude */
+	    x = drand48() * 360.0 - 180.0;
+	    break;
+	case 1:			/* AIS position in 1/10000 minute */
+	    x = (double)(lrand48() % 216000001 - 108000000) / 600000.0;
+	    break;
+	case 2:			/* tenths */
+	    x = (double)(lrand48() % 100000) / 10.0;
+	    break;
+	case 3:			/* errors, DOPs, altitudes */
+	    x = (drand48() - 0.3) * pow(10.0, (double)(lrand48() % 8));
+	    break;
+	default:		/* timestamps */
+	    x = 1.3e9 + drand48() * 1e8;
+	    break;
+	}
+	check_fixed(x, (int)(i % 10));
+	if (i % 7 == 0)
+	    check_int((long long)lrand48() - (1LL << 30));
+    }
+
+    /* truncation keeps the string terminated and says so */
+    json_out_init(&out, small, sizeof(small));
+    json_out_raw(&out, "{\"class\":");
+    if (!out.overflow || strcmp(small, "{\"class") != 0) {
+	(void)fprintf(stderr, "overflow not handled: \"%s\"\n", small);
+	failures++;
+    }
+
+    if (failures == 0)
+	(void)printf("JSON writer test succeeded.\n");
+}
+
+static void decode(const char *path, bool bench, unsigned long *reports,
+		   double *seconds, size_t *bytes)
+/* run a log through the drivers, dumping or timing each report */
+{
+    struct gps_device_t session;
+    struct gps_context_t context;
+    struct policy_t policy;
+    char buf[GPS_JSON_RESPONSE_MAX * 4];
+    FILE *fp;
+
+    if ((fp = fopen(path, "r")) == NULL) {
+	(void)fprintf(stderr, "test_jsonout: can't open %s\n", path);
+	exit(EXIT_FAILURE);
+    }
+    memset(&policy, '\0', sizeof(policy));
+    policy.json = true;
+    policy.scaled = true;
+
+    gps_context_init(&context);
+    gpsd_time_init(&context, time(NULL));
+    context.readonly = true;
+    gpsd_init(&session, &context, NULL);
+    gpsd_clear(&session);
+    session.gpsdata.gps_fd = fileno(fp);
+    session.gpsdata.dev.baudrate = 38400;
+    (void)strlcpy(session.gpsdata.dev.path, "stdin",
+		  sizeof(session.gpsdata.dev.path));
+
+    for (;;) {
+	gps_mask_t changed = gpsd_poll(&session);
+
+	if (changed == ERROR_SET || changed == NODATA_IS)
+	    break;
+	if (session.packet.type == COMMENT_PACKET)
+	    gpsd_set_century(&session);
+	if ((changed & (REPORT_IS|SATELLITE_SET|ATTITUDE_SET|AIS_SET)) == 0)
+	    continue;
+	if (bench) {
+	    struct timespec t0, t1;
+	    int n;
+
+	    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+	    for (n = 0; n < BENCH_REPEAT; n++)
+		json_data_report(changed, &session, &policy, buf, sizeof(buf));
+	    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+	    *seconds += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	    *reports += BENCH_REPEAT;
+	    *bytes += strlen(buf) * BENCH_REPEAT;
+	    continue;
+	}
+	if ((changed & REPORT_IS) != 0) {
+	    json_tpv_dump(&session, &policy, buf, sizeof(buf));
+	    (void)fputs(buf, stdout);
+	}
+	if ((changed & SATELLITE_SET) != 0) {
+	    json_sky_dump(&session.gpsdata, buf, sizeof(buf));
+	    (void)fputs(buf, stdout);
+	}
+#ifdef COMPASS_ENABLE
+	if ((changed & ATTITUDE_SET) != 0) {
+	    json_att_dump(&session.gpsdata, buf, sizeof(buf));
+	    (void)fputs(buf, stdout);
+	}
+#endif /* COMPASS_ENABLE */
+#ifdef AIVDM_ENABLE
+	if ((changed & AIS_SET) != 0) {
+	    json_aivdm_dump(&session.gpsdata.ais, "stdin", true,
+			    buf, sizeof(buf));
+	    (void)fputs(buf, stdout);
+	    json_aivdm_dump(&session.gpsdata.ais, "stdin", false,
+			    buf, sizeof(buf));
+	    (void)fputs(buf, stdout);
+	}
+#endif /* AIVDM_ENABLE */
+    }
+    (void)fclose(fp);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long reports = 0;
+    double seconds = 0;
+    size_t bytes = 0;
+    bool bench = false, dump = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "bd")) != -1) {
+	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
+	case 'd':
+	    dump = true;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_jsonout [-b|-d logfile...]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    if (!bench && !dump) {
+	selftest();
+	exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    for (; optind < argc; optind++)
+	decode(argv[optind], bench, &reports, &seconds, &bytes);
+    if (bench && reports > 0)
+	(void)printf("%lu encodes in %.3fs: %.0f encodes/s, %.1f MB/s\n",
+		     reports, seconds, reports / seconds,
+		     bytes / seconds / 1e6);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,253 @@
+/*
+ * test_n2kbus - check the registry of NMEA 2000 bus nodes
+ *
+ * PGNs must keep the column they were first given and the ones after
+ * the last column must only be counted; cells must add up packets,
+ * bytes and sizes and tell the rate; NAMEs and product information
+ * must follow a node to a new address; and the JSON dumps must stay
+ * whole when the table does not fit.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "gpsd.h"
+#include "bits.h"
+#include "gps_json.h"
+
+/* the registry is in the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static struct n2k_bus_t bus;
+static int failures = 0;
+
+static void check(bool ok, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!ok) {
+	va_start(ap, fmt);
+	(void)vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	(void)fputc('\n', stderr);
+	failures++;
+    }
+}
+
+static int column(uint32_t pgn)
+{
+    int i;
+
+    for (i = 0; i < bus.npgns; i++)
+	if (bus.pgn[i] == pgn)
+	    return i;
+    return -1;
+}
+
+static void claim(uint8_t src, uint64_t name, timestamp_t now)
+{
+    uint8_t bu[8];
+
+    putle64(bu, 0, name);
+    n2k_bus_claim(&bus, src, bu, sizeof(bu), now);
+}
+
+static void product(uint8_t src, const char *model)
+{
+    uint8_t bu[134];
+
+    memset(bu, 0xff, sizeof(bu));
+    putle16(bu, 0, 2100);
+    putle16(bu, 2, 1234);
+    memcpy(bu + 4, model, strlen(model));
+    memset(bu + 4 + strlen(model), ' ', 32 - strlen(model));
+    memcpy(bu + 36, "1.2.3", 5);
+    bu[36 + 5] = '\0';
+    memcpy(bu + 100, "SN\"42", 5);
+    bu[132] = 1;
+    bu[133] = 2;
+    n2k_bus_product(&bus, src, bu, sizeof(bu));
+}
+
+static void columns(void)
+{
+    int i, c;
+
+    n2k_bus_init(&bus);
+    n2k_bus_packet(&bus, 129025, 10, 8, 1000.0);
+    n2k_bus_packet(&bus, 129026, 10, 8, 1000.0);
+    n2k_bus_packet(&bus, 129025, 20, 8, 1000.0);
+    check(bus.npgns == 2 && column(129025) == 0 && column(129026) == 1,
+	  "PGNs not given columns in order");
+
+    /* the rest of the columns, and then some */
+    for (i = 0; i < N2K_BUS_PGNS + 10; i++)
+	n2k_bus_packet(&bus, 130000 + i, 30, 8, 1000.0);
+    check(bus.npgns == N2K_BUS_PGNS, "%d columns", bus.npgns);
+    check(bus.overflow == 12, "overflow %u, not 12", bus.overflow);
+    check(bus.source[30].packets == N2K_BUS_PGNS + 10,
+	  "overflowed packets not counted for the source");
+    c = column(130000);
+    for (i = 0; i < 5; i++)
+	n2k_bus_packet(&bus, 130000, 30, 8, 1000.0);
+    check(column(130000) == c && bus.cell[30][c].packets == 6,
+	  "known PGN moved column or lost count");
+    check(bus.overflow == 12, "known PGN counted as overflow");
+}
+
+static void cells(void)
+{
+    const struct n2k_bus_cell_t *c;
+    const struct n2k_bus_source_t *s;
+    timestamp_t now = 1000.0;
+    int i;
+
+    n2k_bus_init(&bus);
+    for (i = 0; i < 50; i++, now += 0.1)
+	n2k_bus_packet(&bus, 129025, 10, 8, now);
+    n2k_bus_packet(&bus, 129029, 10, 43, now);
+    n2k_bus_packet(&bus, 129029, 10, 20, now);
+    n2k_bus_packet(&bus, 126996, 10, 134, now);
+    c = &bus.cell[10][column(129025)];
+    check(c->packets == 50 && c->bytes == 400 && c->size[0] == 50,
+	  "cell counts wrong");
+    check(fabs(c->interval - 0.1) < 0.001, "interval %f, not 0.1",
+	  c->interval);
+    c = &bus.cell[10][column(129029)];
+    check(c->size[1] == 1 && c->size[2] == 1 && c->size[3] == 0,
+	  "sizes bucketed wrong");
+    s = &bus.source[10];
+    check(s->packets == 53 && s->bytes == 400 + 43 + 20 + 134,
+	  "source totals wrong");
+    /* 50 single frames, then fast packets of 7, 3 and 20 frames */
+    check(s->frames == 50 + 7 + 3 + 20, "frames %u", s->frames);
+
+    n2k_bus_fast_error(&bus, 10, false);
+    n2k_bus_fast_error(&bus, 10, true);
+    n2k_bus_fast_error(&bus, 10, true);
+    check(s->fast_errors == 1 && s->fast_cancels == 2,
+	  "fast packet errors not counted");
+}
+
+static void identity(void)
+{
+    const uint64_t name = 0xc0f0823fe76b4b35ULL;
+    timestamp_t now = 1000.0;
+
+    n2k_bus_init(&bus);
+    n2k_bus_packet(&bus, 129025, 40, 8, now);
+    claim(40, name, now);
+    product(40, "Depth sounder");
+    check(bus.source[40].name == name && bus.source[40].claims == 1
+	  && bus.source[40].product
+	  && strcmp(bus.source[40].model_id, "Depth sounder") == 0
+	  && strcmp(bus.source[40].software, "1.2.3") == 0
+	  && bus.source[40].product_code == 1234
+	  && bus.source[40].load == 2, "identity not stored");
+    check(bus.source[40].packets == 1,
+	  "first claim cleared what the source sent before it");
+
+    /* the node moves and takes its identity along */
+    claim(41, name, now);
+    check(bus.source[41].name == name && bus.source[41].product
+	  && strcmp(bus.source[41].model_id, "Depth sounder") == 0
+	  && bus.source[41].claims == 2, "identity did not move");
+    check(bus.source[40].name == 0 && !bus.source[40].product,
+	  "old address kept the identity");
+
+    /* another node on the address starts afresh */
+    claim(41, name + 1, now);
+    check(bus.source[41].name == name + 1 && !bus.source[41].product
+	  && bus.source[41].claims == 1, "new NAME kept the old identity");
+
+    /* a claim of no address and short product information are ignored */
+    claim(N2K_NODE_NULL, name + 2, now);
+    check(bus.source[N2K_NODE_NULL].name == 0, "cannot-claim stored");
+    n2k_bus_product(&bus, 50, (const uint8_t *)"short", 5);
+    check(!bus.source[50].product, "short product information stored");
+}
+
+static void dumps(void)
+{
+    char buf[GPS_JSON_RESPONSE_MAX];
+    timestamp_t now = 1000.0;
+    int i;
+
+    n2k_bus_init(&bus);
+    for (i = 0; i < 20; i++, now += 0.5)
+	n2k_bus_packet(&bus, 130306, 12, 8, now);
+    claim(12, 0xc0f0823fe76b4b35ULL, now);
+    product(12, "Wind");
+
+    (void)n2k_bus_json_dump(&bus, now, buf, sizeof(buf));
+    check(strncmp(buf, "{\"class\":\"N2KDEVICES\",\"pgns\":1,\"overflow\":0,"
+		  "\"devices\":[{\"src\":12,\"name\":\"c0f0823fe76b4b35\","
+		  "\"manufacturer\":1851,\"device_function\":130,"
+		  "\"device_class\":120,\"model\":\"Wind\",\"packets\":20,"
+		  "\"rate\":2.0,\"errors\":0,\"age\":0.5}]}\r\n",
+		  sizeof(buf)) == 0, "N2KDEVICES: %s", buf);
+
+    /* the rate falls off when the node goes quiet */
+    (void)n2k_bus_json_dump(&bus, now + 9.5, buf, sizeof(buf));
+    check(strstr(buf, "\"rate\":0.1,") != NULL, "rate did not fall: %s",
+	  buf);
+
+    check(n2k_bus_json_source(&bus, 12, now, buf, sizeof(buf)) > 0
+	  && strstr(buf, "\"serial\":\"SN\\\"42\",") != NULL
+	  && strstr(buf, "{\"pgn\":130306,\"packets\":20,\"bytes\":160,"
+		    "\"rate\":2.00,\"sizes\":[20,0,0,0],\"age\":0.5}")
+	  != NULL, "N2KDEVICE: %s", buf);
+    check(n2k_bus_json_source(&bus, 13, now, buf, sizeof(buf)) == 0,
+	  "dumped a source never heard");
+
+    /* a full bus does not fit; what does must still be JSON */
+    for (i = 0; i < N2K_BUS_SOURCES; i++)
+	n2k_bus_packet(&bus, 129025, (uint8_t)i, 8, now);
+    (void)n2k_bus_json_dump(&bus, now, buf, sizeof(buf));
+    check(strlen(buf) < sizeof(buf) - 1
+	  && strcmp(buf + strlen(buf) - 21, "],\"truncated\":true}\r\n") == 0
+	  && strstr(buf, "},],") == NULL, "truncated N2KDEVICES: %s",
+	  buf + strlen(buf) - 40);
+    for (i = 0; i < N2K_BUS_PGNS; i++)
+	n2k_bus_packet(&bus, 131000 + i, 12, 8, now);
+    (void)n2k_bus_json_source(&bus, 12, now, buf, sizeof(buf));
+    check(strcmp(buf + strlen(buf) - 21, "],\"truncated\":true}\r\n") == 0,
+	  "truncated N2KDEVICE: %s", buf + strlen(buf) - 40);
+}
+
+int main(void)
+{
+    columns();
+    cells();
+    identity();
+    dumps();
+    if (failures == 0)
+	(void)printf("NMEA 2000 bus registry test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,605 @@
+/*
+ * test_n2kdecode - check the NMEA 2000 schema decoder
+ *
+ * Every PGN in the schema is also decoded here the way the drivers'
+ * hand-written handlers did it, field by field with getleu16() and
+ * friends.  With no arguments, random payloads (with plenty of "not
+ * available" fields and out-of-range instances) go through both, and
+ * the navigation, environment, engine and attitude data and the report
+ * masks must come out identical; so must short payloads.  With -b it
+ * times both decoders per PGN:
+ *
+ *	test_n2kdecode -b
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "bits.h"
+
+#define TRIALS		20000	/* random payloads per PGN */
+#define PAYLOADS	256	/* payloads cycled through when timing */
+#define BENCH_REPEAT	2000	/* passes over them */
+#define PAYLOAD_MAX	32
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+static struct gps_context_t context;
+static struct gps_device_t table, hand;
+static int failures = 0;
+
+/*
+ * The hand-written decoders.  Each setter stores a field unless it is
+ * not available, in which case it stores NaN if asked to.
+ */
+
+static gps_mask_t store(bool na, bool nan, double value, double *dest,
+			gps_mask_t *set, gps_mask_t pset, gps_mask_t mask)
+{
+    if (na) {
+	if (!nan)
+	    return 0;
+	*dest = NAN;
+	return mask;
+    }
+    *dest = value;
+    if (set != NULL)
+	*set |= pset;
+    return mask;
+}
+
+static gps_mask_t u8(const unsigned char *bu, int pos, double k, bool nan,
+		     double *dest, gps_mask_t *set, gps_mask_t pset,
+		     gps_mask_t mask)
+{
+    uint8_t v = getub(bu, pos);
+    return store(v == 0xff, nan, v * k, dest, set, pset, mask);
+}
+
+static gps_mask_t s8(const unsigned char *bu, int pos, double k, bool nan,
+		     double *dest, gps_mask_t *set, gps_mask_t pset,
+		     gps_mask_t mask)
+{
+    int8_t v = getsb(bu, pos);
+    return store(v == 0x7f, nan, v * k, dest, set, pset, mask);
+}
+
+static gps_mask_t u16(const unsigned char *bu, int pos, double k, bool nan,
+		      double *dest, gps_mask_t *set, gps_mask_t pset,
+		      gps_mask_t mask)
+{
+    uint16_t v = getleu16(bu, pos);
+    return store(v == 0xffff, nan, v * k, dest, set, pset, mask);
+}
+
+static gps_mask_t s16(const unsigned char *bu, int pos, double k, bool nan,
+		      double *dest, gps_mask_t *set, gps_mask_t pset,
+		      gps_mask_t mask)
+{
+    int16_t v = getles16(bu, pos);
+    return store(v == 0x7fff, nan, v * k, dest, set, pset, mask);
+}
+
+static gps_mask_t u32(const unsigned char *bu, int pos, double k, bool nan,
+		      double *dest, gps_mask_t *set, gps_mask_t pset,
+		      gps_mask_t mask)
+{
+    uint32_t v = getleu32(bu, pos);
+    return store(v == 0xffffffff, nan, v * k, dest, set, pset, mask);
+}
+
+static gps_mask_t s32(const unsigned char *bu, int pos, double k, bool nan,
+		      double *dest, gps_mask_t *set, gps_mask_t pset,
+		      gps_mask_t mask)
+{
+    int32_t v = getles32(bu, pos);
+    return store(v == 0x7fffffff, nan, v * k, dest, set, pset, mask);
+}
+
+#define RAD	(0.0001 * RAD_2_DEG)
+#define NAV	&g->navigation.set
+#define ENV	&g->environment.set
+#define ENG	&g->engine.set
+#define DONE(mask)	return (mask) != 0 ? (ONLINE_SET | (mask)) : 0
+
+static gps_mask_t hand_none(const unsigned char *bu UNUSED,
+			    struct gps_data_t *g UNUSED)
+/* what a PGN comes to when its index is missing */
+{
+    return 0;
+}
+
+static gps_mask_t hand_127245(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    g->navigation.set = 0;
+    mask |= s16(bu, 4, RAD, true, &g->navigation.rudder_angle, NAV,
+		NAV_RUDDER_ANGLE_PSET, NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_127250(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+    int ref = getub(bu, 7) & 0x01;
+
+    g->navigation.set = 0;
+    mask |= u16(bu, 1, RAD, true, &g->navigation.heading[ref], NAV,
+		ref ? NAV_HDG_MAGN_PSET : NAV_HDG_TRUE_PSET, NAVIGATION_SET);
+    mask |= s16(bu, 3, RAD, true, &g->environment.deviation, ENV,
+		ENV_DEVIATION_PSET, ENVIRONMENT_SET);
+    mask |= s16(bu, 5, RAD, true, &g->environment.variation, ENV,
+		ENV_VARIATION_PSET, ENVIRONMENT_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_127251(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    g->navigation.set = 0;
+    mask |= s32(bu, 1, 3.125e-08 * RAD_2_DEG, true,
+		&g->navigation.rate_of_turn, NAV, NAV_ROT_PSET, NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_127257(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    mask |= s16(bu, 1, RAD, true, &g->attitude.yaw, NULL, 0, ATTITUDE_SET);
+    mask |= s16(bu, 3, RAD, true, &g->attitude.pitch, NULL, 0, ATTITUDE_SET);
+    mask |= s16(bu, 5, RAD, true, &g->attitude.roll, NULL, 0, ATTITUDE_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_127258(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    mask |= s16(bu, 4, RAD, false, &g->environment.variation, ENV,
+		ENV_VARIATION_PSET, ENVIRONMENT_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_127488(const unsigned char *bu, struct gps_data_t *g)
+{
+    static const gps_mask_t side[] = {ENG_PORT_PSET, ENG_STARBOARD_PSET};
+    gps_mask_t mask = 0;
+    uint8_t i = getub(bu, 0);
+    struct single_engine_t *e;
+
+    if (i > 1)
+	return 0;
+    e = &g->engine.instance[i];
+    mask |= u16(bu, 1, 0.25, false, &e->speed, ENG,
+		side[i] | ENG_SPEED_PSET, ENGINE_SET);
+    mask |= u16(bu, 3, 100.0, false, &e->boost_pressure, ENG,
+		side[i] | ENG_BOOST_PRESSURE_PSET, ENGINE_SET);
+    mask |= u8(bu, 6, 1, false, &e->tilt, ENG,
+	       side[i] | ENG_TILT_PSET, ENGINE_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_127489(const unsigned char *bu, struct gps_data_t *g)
+{
+    static const gps_mask_t side[] = {ENG_PORT_PSET, ENG_STARBOARD_PSET};
+    gps_mask_t mask = 0;
+    uint8_t i = getub(bu, 0);
+    struct single_engine_t *e;
+
+    if (i > 1)
+	return 0;
+    e = &g->engine.instance[i];
+    mask |= u16(bu, 1, 100.0, false, &e->oil_pressure, ENG,
+		side[i] | ENG_OIL_PRESSURE_PSET, ENGINE_SET);
+    mask |= u16(bu, 3, 0.1, false, &e->oil_temperature, ENG,
+		side[i] | ENG_OIL_TEMPERATURE_PSET, ENGINE_SET);
+    mask |= u16(bu, 5, 0.01, false, &e->temperature, ENG,
+		side[i] | ENG_TEMPERATURE_PSET, ENGINE_SET);
+    mask |= u16(bu, 7, 0.01, false, &e->alternator_voltage, ENG,
+		side[i] | ENG_ALTERNATOR_VOLTAGE_PSET, ENGINE_SET);
+    mask |= u16(bu, 9, 1000.0, false, &e->fuel_rate, ENG,
+		side[i] | ENG_FUEL_RATE_PSET, ENGINE_SET);
+    mask |= u32(bu, 11, 1, false, &e->total_hours, ENG,
+		side[i] | ENG_TOTAL_HOURS_PSET, ENGINE_SET);
+    mask |= u16(bu, 15, 1000.0, false, &e->coolant_pressure, ENG,
+		side[i] | ENG_COOLANT_PRESSURE_PSET, ENGINE_SET);
+    mask |= u16(bu, 17, 0.01, false, &e->fuel_pressure, ENG,
+		side[i] | ENG_FUEL_PRESSURE_PSET, ENGINE_SET);
+    mask |= s8(bu, 22, 0.01, false, &e->torque, ENG,
+	       side[i] | ENG_TORQUE_PSET, ENGINE_SET);
+    mask |= s8(bu, 23, 0.01, false, &e->load, ENG,
+	       side[i] | ENG_LOAD_PSET, ENGINE_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_128000(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    mask |= s16(bu, 1, RAD, false, &g->navigation.leeway, NAV,
+		NAV_LEEWAY_PSET, NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_128259(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    g->navigation.set = 0;
+    mask |= u16(bu, 1, 0.01, true, &g->navigation.speed_thru_water, NAV,
+		NAV_STW_PSET, NAVIGATION_SET);
+    mask |= u16(bu, 3, 0.01, true, &g->navigation.speed_over_ground, NAV,
+		NAV_SOG_PSET, NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_128267(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    g->navigation.set = 0;
+    mask |= u32(bu, 1, 0.01, true, &g->navigation.depth, NAV,
+		NAV_DPT_PSET, NAVIGATION_SET);
+    mask |= s16(bu, 5, 0.001, true, &g->navigation.depth_offset, NAV,
+		NAV_DPT_OFF_PSET, NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_128275(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    g->navigation.set = 0;
+    mask |= u32(bu, 6, METERS_TO_NM, true, &g->navigation.distance_total,
+		NAV, NAV_DIST_TOT_PSET, NAVIGATION_SET);
+    mask |= u32(bu, 10, METERS_TO_NM, true, &g->navigation.distance_trip,
+		NAV, NAV_DIST_TRIP_PSET, NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_129291(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    if ((getub(bu, 1) & 0x03) != 0)
+	return 0;
+    mask |= u16(bu, 2, RAD, false, &g->navigation.current_set, NAV,
+		NAV_CURRENT_PSET, NAVIGATION_SET);
+    mask |= u16(bu, 4, 0.01 * MPS_TO_KNOTS, false,
+		&g->navigation.current_drift, NAV, NAV_CURRENT_PSET,
+		NAVIGATION_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_130306(const unsigned char *bu, struct gps_data_t *g)
+{
+    static const gps_mask_t angles[] = {
+	ENV_WIND_TRUE_NORTH_ANGLE_PSET, ENV_WIND_MAGN_ANGLE_PSET,
+	ENV_WIND_APPARENT_ANGLE_PSET, ENV_WIND_TRUE_TO_BOAT_ANGLE_PSET,
+	ENV_WIND_TRUE_TO_WATER_ANGLE_PSET,
+    };
+    static const gps_mask_t speeds[] = {
+	ENV_WIND_TRUE_NORTH_SPEED_PSET, ENV_WIND_MAGN_SPEED_PSET,
+	ENV_WIND_APPARENT_SPEED_PSET, ENV_WIND_TRUE_TO_BOAT_SPEED_PSET,
+	ENV_WIND_TRUE_TO_WATER_SPEED_PSET,
+    };
+    gps_mask_t mask = 0;
+    uint8_t ref = getub(bu, 5) & 0x07;
+
+    if (ref > 4)
+	return 0;
+    mask |= u16(bu, 1, 0.01, false, &g->environment.wind[ref].speed, ENV,
+		speeds[ref], ENVIRONMENT_SET);
+    mask |= u16(bu, 3, RAD, false, &g->environment.wind[ref].angle, ENV,
+		angles[ref], ENVIRONMENT_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_130310(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+
+    mask |= u16(bu, 1, 0.01, false, &g->environment.temp[temp_water], ENV,
+		ENV_TEMP_WATER_PSET, ENVIRONMENT_SET);
+    mask |= u16(bu, 3, 0.01, false, &g->environment.temp[temp_air], ENV,
+		ENV_TEMP_AIR_PSET, ENVIRONMENT_SET);
+    DONE(mask);
+}
+
+static gps_mask_t hand_130311(const unsigned char *bu, struct gps_data_t *g)
+{
+    gps_mask_t mask = 0;
+    uint8_t inst = getub(bu, 1) & 0x3f;
+
+    if (inst > 1)
+	return 0;
+    mask |= u16(bu, 2, 0.01, false, &g->environment.temp[inst], ENV,
+		inst ? ENV_TEMP_AIR_PSET : ENV_TEMP_WATER_PSET,
+		ENVIRONMENT_SET);
+    DONE(mask);
+}
+
+static const struct {
+    unsigned int pgn;
+    gps_mask_t (*decode)(const unsigned char *, struct gps_data_t *);
+} hands[] = {
+    {127245, hand_127245}, {127250, hand_127250}, {127251, hand_127251},
+    {127257, hand_127257}, {127258, hand_127258}, {127488, hand_127488},
+    {127489, hand_127489}, {128000, hand_128000}, {128259, hand_128259},
+    {128267, hand_128267}, {128275, hand_128275}, {129291, hand_129291},
+    {130306, hand_130306}, {130310, hand_130310}, {130311, hand_130311},
+};
+#define NHANDS	(int)(sizeof(hands) / sizeof(hands[0]))
+
+static int payload_len(const struct n2k_pgn_t *p)
+{
+    int i, len = 0;
+
+    for (i = 0; i < p->nfields; i++)
+	if (p->field[i].end > len)
+	    len = p->field[i].end;
+    return len;
+}
+
+static void random_payload(const struct n2k_pgn_t *p, unsigned char *bu)
+/* random bytes, often not available, indexes mostly in range */
+{
+    int i;
+
+    for (i = 0; i < PAYLOAD_MAX; i++)
+	switch (rand() % 8) {
+	case 0:
+	case 1:
+	    bu[i] = 0xff;
+	    break;
+	case 2:
+	    bu[i] = 0x7f;
+	    break;
+	default:
+	    bu[i] = (unsigned char)rand();
+	}
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+
+	if ((f->flags & N2K_INDEX) != 0 && rand() % 4 != 0) {
+	    unsigned int v = (unsigned int)rand() % f->limit;
+	    unsigned int mask = ((1u << f->width) - 1) << (f->bit % 8);
+
+	    bu[f->bit / 8] = (unsigned char)((bu[f->bit / 8] & ~mask)
+					     | (v << (f->bit % 8)));
+	}
+    }
+}
+
+static void random_bytes(void *p, size_t n)
+{
+    unsigned char *b = (unsigned char *)p;
+
+    while (n-- > 0)
+	*b++ = (unsigned char)rand();
+}
+
+/* the navigation members the schema writes; the ring buffers are huge */
+static const size_t navigation[] = {
+    offsetof(struct navigation_t, set),
+    offsetof(struct navigation_t, speed_over_ground),
+    offsetof(struct navigation_t, speed_thru_water),
+    offsetof(struct navigation_t, rate_of_turn),
+    offsetof(struct navigation_t, rudder_angle),
+    offsetof(struct navigation_t, depth),
+    offsetof(struct navigation_t, depth_offset),
+    offsetof(struct navigation_t, distance_total),
+    offsetof(struct navigation_t, distance_trip),
+    offsetof(struct navigation_t, heading[0]),
+    offsetof(struct navigation_t, heading[1]),
+    offsetof(struct navigation_t, leeway),
+    offsetof(struct navigation_t, current_set),
+    offsetof(struct navigation_t, current_drift),
+};
+#define NAVIGATION	(sizeof(navigation) / sizeof(navigation[0]))
+
+static void random_state(struct gps_data_t *g)
+/* stale data and PSET bits in what the decoders write */
+{
+    size_t i;
+
+    for (i = 0; i < NAVIGATION; i++)
+	random_bytes((char *)&g->navigation + navigation[i], sizeof(double));
+    random_bytes(&g->environment, sizeof(g->environment));
+    random_bytes(&g->engine, sizeof(g->engine));
+    random_bytes(&g->attitude, sizeof(g->attitude));
+}
+
+static void copy_state(struct gps_data_t *to, const struct gps_data_t *from)
+{
+    size_t i;
+
+    for (i = 0; i < NAVIGATION; i++)
+	memcpy((char *)&to->navigation + navigation[i],
+	       (const char *)&from->navigation + navigation[i], sizeof(double));
+    memcpy(&to->environment, &from->environment, sizeof(to->environment));
+    memcpy(&to->engine, &from->engine, sizeof(to->engine));
+    memcpy(&to->attitude, &from->attitude, sizeof(to->attitude));
+}
+
+static bool same(const struct gps_data_t *a, const struct gps_data_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < NAVIGATION; i++)
+	if (memcmp((const char *)&a->navigation + navigation[i],
+		   (const char *)&b->navigation + navigation[i],
+		   sizeof(double)) != 0)
+	    return false;
+    return memcmp(&a->environment, &b->environment,
+		  sizeof(a->environment)) == 0
+	&& memcmp(&a->engine, &b->engine, sizeof(a->engine)) == 0
+	&& memcmp(&a->attitude, &b->attitude, sizeof(a->attitude)) == 0;
+}
+
+static void compare(const struct n2k_pgn_t *p,
+		    gps_mask_t (*decode)(const unsigned char *,
+					 struct gps_data_t *),
+		    const unsigned char *bu, int len, int want_len)
+{
+    gps_mask_t got, want;
+    int i;
+
+    random_state(&table.gpsdata);
+    copy_state(&hand.gpsdata, &table.gpsdata);
+    got = n2k_decode(p, bu, len, &table);
+    want = decode(bu, &hand.gpsdata);
+    if (got != want || !same(&table.gpsdata, &hand.gpsdata)) {
+	(void)fprintf(stderr, "%u (%d bytes): mask %llx, wanted %llx;",
+		      p->pgn, len, (unsigned long long)got,
+		      (unsigned long long)want);
+	for (i = 0; i < want_len; i++)
+	    (void)fprintf(stderr, " %02x", bu[i]);
+	(void)fputc('\n', stderr);
+	failures++;
+    }
+}
+
+static void selftest(void)
+{
+    unsigned char bu[PAYLOAD_MAX];
+    int h, t;
+
+    if (n2k_schema_count != NHANDS) {
+	(void)fprintf(stderr, "%d PGNs in the schema, %d decoded by hand\n",
+		      n2k_schema_count, NHANDS);
+	failures++;
+    }
+    for (h = 0; h < NHANDS; h++) {
+	const struct n2k_pgn_t *p = n2k_schema_find(hands[h].pgn);
+	int len;
+
+	if (p == NULL || p->pgn != hands[h].pgn) {
+	    (void)fprintf(stderr, "%u not in the schema\n", hands[h].pgn);
+	    failures++;
+	    continue;
+	}
+	len = payload_len(p);
+	for (t = 0; t < TRIALS; t++) {
+	    random_payload(p, bu);
+	    compare(p, hands[h].decode, bu, len, len);
+	}
+	/* whatever a short payload lacks is not available */
+	for (t = 0; t < TRIALS / 10; t++) {
+	    int cut = rand() % len, i;
+	    bool indexed = true;
+
+	    random_payload(p, bu);
+	    for (i = 0; i < p->nfields; i++) {
+		const struct n2k_field_t *f = &p->field[i];
+
+		if (f->end <= cut)
+		    continue;
+		if ((f->flags & N2K_INDEX) != 0)
+		    indexed = false;
+		else {
+		    memset(bu + f->bit / 8, 0xff, f->width / 8);
+		    if ((f->flags & N2K_SIGNED) != 0)
+			bu[f->end - 1] = 0x7f;
+		}
+	    }
+	    compare(p, indexed ? hands[h].decode : hand_none, bu, cut, len);
+	}
+    }
+    if (n2k_schema_find(129029) != NULL) {
+	(void)fprintf(stderr, "129029 found in the schema\n");
+	failures++;
+    }
+
+    if (failures == 0)
+	(void)printf("NMEA 2000 schema decoder test succeeded.\n");
+}
+
+static double since(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void benchmark(void)
+{
+    static unsigned char bu[PAYLOADS][PAYLOAD_MAX];
+    struct timespec t0;
+    double ts, th;
+    gps_mask_t sink = 0;
+    int h, i, pass;
+
+    (void)printf("   PGN  schema ns  hand ns  name\n");
+    for (h = 0; h < NHANDS; h++) {
+	const struct n2k_pgn_t *p = n2k_schema_find(hands[h].pgn);
+	int len;
+
+	if (p == NULL)
+	    continue;
+	len = payload_len(p);
+	for (i = 0; i < PAYLOADS; i++)
+	    random_payload(p, bu[i]);
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (pass = 0; pass < BENCH_REPEAT; pass++)
+	    for (i = 0; i < PAYLOADS; i++)
+		sink |= n2k_decode(p, bu[i], len, &table);
+	ts = since(&t0);
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (pass = 0; pass < BENCH_REPEAT; pass++)
+	    for (i = 0; i < PAYLOADS; i++)
+		sink |= hands[h].decode(bu[i], &hand.gpsdata);
+	th = since(&t0);
+
+	(void)printf("%6u  %9.1f  %7.1f  %s\n", p->pgn,
+		     ts * 1e9 / (BENCH_REPEAT * PAYLOADS),
+		     th * 1e9 / (BENCH_REPEAT * PAYLOADS), p->name);
+    }
+    if (sink == 1)
+	(void)printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool bench = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "b")) != -1) {
+	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_n2kdecode [-b]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    srand(1);
+    table.context = hand.context = &context;
+    if (bench)
+	benchmark();
+    else
+	selftest();
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,413 @@
+/*
+ * test_n2kencode - check the NMEA 2000 schema encoder and output batches
+ *
+ * For every PGN in the schema and every instance it may carry: random
+ * payloads decoded and encoded again must give back the same fields,
+ * and random values encoded and decoded again must come back within
+ * half a count.  n2k_binary_dump() must put the PGNs for a report into
+ * one batch of framed PGNs, each decoding to what the session holds.
+ * With -b it times the encoder per PGN and the batching of a report:
+ *
+ *	test_n2kencode -b
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "bits.h"
+#include "frame.h"
+#include "pseudon2k.h"
+
+#define TRIALS		20000	/* random payloads and values per instance */
+#define BENCH_REPEAT	200000	/* encodes per PGN when timing */
+#define PAYLOAD_MAX	32
+
+/* pseudon2k.c logs through the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static struct gps_context_t context;
+static struct gps_device_t session, back;
+static struct n2k_batch_t batch;
+static int failures = 0;
+
+static uint32_t bits(const unsigned char *bu, const struct n2k_field_t *f)
+/* a field the slow way, to check the encoder's fast paths */
+{
+    uint32_t v = 0;
+    int i;
+
+    for (i = 0; i < f->width; i++)
+	if ((bu[(f->bit + i) / 8] >> ((f->bit + i) % 8)) & 1)
+	    v |= 1u << i;
+    return v;
+}
+
+static double *member(struct gps_data_t *g, const struct n2k_field_t *f,
+		      unsigned int index)
+{
+    return (double *)((char *)g + f->dest + index * f->stride);
+}
+
+static gps_mask_t *setword(struct gps_data_t *g, size_t offset)
+{
+    return (gps_mask_t *)((char *)g + offset);
+}
+
+static unsigned int instances(const struct n2k_pgn_t *p)
+{
+    int i;
+
+    for (i = 0; i < p->nfields; i++)
+	if ((p->field[i].flags & N2K_INDEX) != 0)
+	    return p->field[i].limit;
+    return 1;
+}
+
+static void clear(struct gps_data_t *g, const struct n2k_pgn_t *p)
+/* what the PGN's fields go to: no data, no PSET bits */
+{
+    unsigned int n, index;
+    int i;
+
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+
+	if ((f->flags & N2K_INDEX) != 0)
+	    continue;
+	n = (f->flags & N2K_INDEXED) != 0 ? instances(p) : 1;
+	for (index = 0; index < n; index++)
+	    *member(g, f, index) = NAN;
+	if (f->setword != N2K_NOWHERE)
+	    *setword(g, f->setword) = 0;
+    }
+}
+
+static void random_payload(const struct n2k_pgn_t *p, unsigned int index,
+			   unsigned char *bu)
+/* random bytes, often not available, with the index given */
+{
+    int i;
+
+    for (i = 0; i < PAYLOAD_MAX; i++)
+	switch (rand() % 8) {
+	case 0:
+	case 1:
+	    bu[i] = 0xff;
+	    break;
+	case 2:
+	    bu[i] = 0x7f;
+	    break;
+	default:
+	    bu[i] = (unsigned char)rand();
+	}
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+
+	if ((f->flags & N2K_INDEX) != 0) {
+	    unsigned int mask = ((1u << f->width) - 1) << (f->bit % 8);
+
+	    bu[f->bit / 8] = (unsigned char)((bu[f->bit / 8] & ~mask)
+					     | (index << (f->bit % 8)));
+	}
+    }
+}
+
+static void report(const struct n2k_pgn_t *p, unsigned int index,
+		   const char *what, const unsigned char *bu, int len)
+{
+    int i;
+
+    (void)fprintf(stderr, "%u[%u]: %s;", p->pgn, index, what);
+    for (i = 0; i < len; i++)
+	(void)fprintf(stderr, " %02x", bu[i]);
+    (void)fputc('\n', stderr);
+    failures++;
+}
+
+static void payload_trip(const struct n2k_pgn_t *p, unsigned int index)
+/* payload, decoded, encoded again: the same fields */
+{
+    unsigned char in[PAYLOAD_MAX], out[PAYLOAD_MAX];
+    size_t len;
+    bool any;
+    int i;
+
+    random_payload(p, index, in);
+    clear(&session.gpsdata, p);
+    if (n2k_decode(p, in, p->len, &session) == 0 && p->nan) {
+	report(p, index, "not decoded", in, p->len);
+	return;
+    }
+    len = n2k_encode(p, &session.gpsdata, index, out, sizeof(out));
+    any = false;
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+
+	if ((f->flags & N2K_INDEX) == 0 && bits(in, f) != f->na)
+	    any = true;
+    }
+    if (len != (any ? (size_t)p->len : 0)) {
+	report(p, index, "wrong length", in, p->len);
+	return;
+    }
+    for (i = 0; len > 0 && i < p->nfields; i++)
+	if (bits(in, &p->field[i]) != bits(out, &p->field[i])) {
+	    report(p, index, p->field[i].name, in, p->len);
+	    return;
+	}
+}
+
+static void value_trip(const struct n2k_pgn_t *p, unsigned int index)
+/* values, encoded, decoded again: within half a count */
+{
+    unsigned char bu[PAYLOAD_MAX];
+    double want[PAYLOAD_MAX];
+    int i;
+
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+	double lo = (f->flags & N2K_SIGNED) != 0 ? -(double)f->na - 1 : 0;
+	double hi = (double)f->na - 1;
+
+	if ((f->flags & N2K_INDEX) != 0)
+	    continue;
+	want[i] = (lo + (hi - lo) * rand() / RAND_MAX) * f->scale;
+	*member(&session.gpsdata, f, index) = want[i];
+	if (f->setword != N2K_NOWHERE)
+	    *setword(&session.gpsdata, f->setword) = ~(gps_mask_t)0;
+    }
+    if (n2k_encode(p, &session.gpsdata, index, bu, sizeof(bu))
+	!= (size_t)p->len) {
+	report(p, index, "not encoded", bu, 0);
+	return;
+    }
+    clear(&back.gpsdata, p);
+    if (n2k_decode(p, bu, p->len, &back) == 0) {
+	report(p, index, "not decoded", bu, p->len);
+	return;
+    }
+    for (i = 0; i < p->nfields; i++) {
+	const struct n2k_field_t *f = &p->field[i];
+	double got;
+
+	if ((f->flags & N2K_INDEX) != 0)
+	    continue;
+	got = *member(&back.gpsdata, f, index);
+	if (!(fabs(got - want[i]) <= f->scale * (0.5 + 1e-9))) {
+	    (void)fprintf(stderr, "%u[%u] %s: %f came back as %f\n",
+			  p->pgn, index, f->name, want[i], got);
+	    failures++;
+	}
+	if (f->setword != N2K_NOWHERE
+	    && (*setword(&back.gpsdata, f->setword)
+		& f->pset[(f->flags & N2K_INDEXED) != 0 ? index : 0])
+	    != f->pset[(f->flags & N2K_INDEXED) != 0 ? index : 0]) {
+	    (void)fprintf(stderr, "%u[%u] %s: no PSET bit\n",
+			  p->pgn, index, f->name);
+	    failures++;
+	}
+    }
+}
+
+static void clamped(void)
+/* what does not fit goes out as the nearest value that does */
+{
+    const struct n2k_pgn_t *p = n2k_schema_find(128267);
+    unsigned char bu[PAYLOAD_MAX];
+
+    clear(&session.gpsdata, p);
+    session.gpsdata.navigation.set = NAV_DPT_PSET | NAV_DPT_OFF_PSET;
+    session.gpsdata.navigation.depth = -3;
+    session.gpsdata.navigation.depth_offset = 1e6;
+    if (n2k_encode(p, &session.gpsdata, 0, bu, sizeof(bu)) != 8
+	|| getleu32(bu, 1) != 0 || getles16(bu, 5) != 0x7ffe)
+	report(p, 0, "not clamped", bu, 8);
+    /* a value without its PSET bit is not sent */
+    session.gpsdata.navigation.set = NAV_DPT_OFF_PSET;
+    if (n2k_encode(p, &session.gpsdata, 0, bu, sizeof(bu)) != 8
+	|| getleu32(bu, 1) != 0xffffffff || bu[0] != 0xff)
+	report(p, 0, "depth sent", bu, 8);
+    if (n2k_encode(p, &session.gpsdata, 0, bu, 7) != 0)
+	report(p, 0, "overran", bu, 0);
+}
+
+static void batched(void)
+/* one report, one batch: what goes out and in which order */
+{
+    static const unsigned int want[] = {128267, 127251, 127250, 130306,
+					130311};
+    gps_mask_t changed = NAVIGATION_SET | ENVIRONMENT_SET;
+    const unsigned char *frame = batch.buf;
+    int i, n;
+
+    for (i = 0; i < n2k_schema_count; i++)
+	clear(&session.gpsdata, &n2k_schema[i]);
+    session.driver.nmea2000.own_src_id = 0x22;
+    session.gpsdata.navigation.set =
+	NAV_DPT_PSET | NAV_ROT_PSET | NAV_HDG_MAGN_PSET;
+    session.gpsdata.navigation.depth = 12.5;
+    session.gpsdata.navigation.rate_of_turn = -2.5;
+    session.gpsdata.navigation.heading[compass_magnetic] = 271.3;
+    session.gpsdata.environment.set = ENV_WIND_APPARENT_ANGLE_PSET
+	| ENV_WIND_APPARENT_SPEED_PSET | ENV_TEMP_AIR_PSET;
+    session.gpsdata.environment.wind[wind_apparent].angle = 33.7;
+    session.gpsdata.environment.wind[wind_apparent].speed = 5.5;
+    session.gpsdata.environment.temp[temp_air] = 291.5;
+
+    n = n2k_binary_dump(changed, &session, &batch);
+    if (n != (int)(sizeof(want) / sizeof(want[0])) || n != batch.count) {
+	(void)fprintf(stderr, "batch of %d frames, wanted %d\n", n,
+		      (int)(sizeof(want) / sizeof(want[0])));
+	failures++;
+	return;
+    }
+    for (i = 0; i < n; i++) {
+	const struct n2k_pgn_t *p = n2k_schema_find(getleu32(frame, 0));
+
+	if (p == NULL || p->pgn != want[i] || frame[5] != 0x22
+	    || batch.len[i] != (size_t)p->len + N2K_HEADER_LEN) {
+	    (void)fprintf(stderr, "frame %d is PGN %u, %zu bytes\n", i,
+			  getleu32(frame, 0), batch.len[i]);
+	    failures++;
+	    return;
+	}
+	(void)n2k_decode(p, frame + N2K_HEADER_LEN, p->len, &back);
+	frame += batch.len[i];
+    }
+    if (frame != batch.buf + batch.used
+	|| fabs(back.gpsdata.navigation.depth - 12.5) > 0.005
+	|| fabs(back.gpsdata.navigation.heading[compass_magnetic] - 271.3)
+	> 0.003
+	|| fabs(back.gpsdata.environment.wind[wind_apparent].speed - 5.5)
+	> 0.005
+	|| fabs(back.gpsdata.environment.temp[temp_air] - 291.5) > 0.005) {
+	(void)fprintf(stderr, "batch does not decode to the report\n");
+	failures++;
+    }
+
+    /* nothing to say, nothing sent */
+    if (n2k_binary_dump(0, &session, &batch) != 0 || batch.used != 0) {
+	(void)fprintf(stderr, "empty report batched %d frames\n", batch.count);
+	failures++;
+    }
+}
+
+static void selftest(void)
+{
+    unsigned int index;
+    int i, t;
+
+    for (i = 0; i < n2k_schema_count; i++) {
+	const struct n2k_pgn_t *p = &n2k_schema[i];
+
+	for (index = 0; index < instances(p); index++)
+	    for (t = 0; t < TRIALS; t++) {
+		payload_trip(p, index);
+		value_trip(p, index);
+	    }
+    }
+    clamped();
+    batched();
+
+    if (failures == 0)
+	(void)printf("NMEA 2000 schema encoder test succeeded.\n");
+}
+
+static double since(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void benchmark(void)
+{
+    unsigned char bu[PAYLOAD_MAX];
+    struct timespec t0;
+    size_t sink = 0;
+    double t;
+    int i, pass, frames = 0;
+
+    (void)printf("   PGN  ns/PGN    PGNs/s  name\n");
+    for (i = 0; i < n2k_schema_count; i++) {
+	const struct n2k_pgn_t *p = &n2k_schema[i];
+
+	value_trip(p, 0);
+	(void)clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (pass = 0; pass < BENCH_REPEAT; pass++)
+	    sink += n2k_encode(p, &session.gpsdata, 0, bu, sizeof(bu));
+	t = since(&t0);
+	(void)printf("%6u  %6.1f  %8.0f  %s\n", p->pgn,
+		     t * 1e9 / BENCH_REPEAT, BENCH_REPEAT / t, p->name);
+    }
+
+    batched();
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (pass = 0; pass < BENCH_REPEAT / 10; pass++)
+	frames += n2k_binary_dump(NAVIGATION_SET | ENVIRONMENT_SET,
+				  &session, &batch);
+    t = since(&t0);
+    (void)printf("report: %d PGNs per batch, %.0f ns per batch, "
+		 "%.0f PGNs/s\n", batch.count,
+		 t * 1e9 / (BENCH_REPEAT / 10), frames / t);
+    if (sink == 1)
+	(void)printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool bench = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "b")) != -1) {
+	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_n2kencode [-b]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    srand(1);
+    session.context = back.context = &context;
+    if (bench)
+	benchmark();
+    else
+	selftest();
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,710 @@
+/*
+ * test_n2knode - check the ISO 11783 node: address claims, requests
+ * and the transport protocol
+ *
+ * By default the nodes share a simulated bus and clock.  Nodes must
+ * end up with addresses of their own however they start, the lower
+ * NAME must keep a contested address, requests must be answered or
+ * refused, and messages too long for a fast packet must arrive whole,
+ * broadcast or sent to one node, and be given up on when the other end
+ * goes quiet.
+ *
+ * With -i the same node talks to a local responder, another node in
+ * this program, over a SocketCAN interface, framing messages as single
+ * frames and fast packets:
+ *
+ *	ip link add dev vcan0 type vcan && ip link set up vcan0
+ *	test_n2knode -i vcan0
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "bits.h"
+
+#define HEADER		7	/* PGN, priority, source, destination */
+#define BUS_FRAMES	8192
+#define NODES		3
+#define STEP		0.01	/* simulated seconds per step */
+
+/* the node logs through the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+struct frame_t {
+    int from;
+    size_t len;
+    uint8_t buf[HEADER + N2K_FAST_MAX];
+};
+
+struct delivered_t {
+    int count;
+    uint32_t pgn;
+    uint8_t src, dest;
+    size_t len;
+    uint8_t data[N2K_TP_MAX];
+};
+
+static struct gps_context_t context;
+static struct gps_device_t nodes[NODES];
+static struct delivered_t delivered[NODES];
+static struct frame_t bus[BUS_FRAMES];
+static int head, tail;
+static timestamp_t now;
+static int failures = 0;
+/* frames the bus loses, for the timeout tests */
+static bool (*lose)(const struct frame_t *);
+
+static void check(bool ok, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!ok) {
+	va_start(ap, fmt);
+	(void)vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	(void)fputc('\n', stderr);
+	failures++;
+    }
+}
+
+static uint32_t frame_pgn(const struct frame_t *f)
+{
+    return getleu32(f->buf, 0);
+}
+
+static ssize_t bus_write(struct gps_device_t *session, const uint8_t *buf,
+			 size_t len)
+{
+    struct frame_t *f = &bus[head % BUS_FRAMES];
+
+    f->from = (int)(session - nodes);
+    f->len = len;
+    memcpy(f->buf, buf, len);
+    head++;
+    return (ssize_t)len;
+}
+
+static void deliver(struct gps_device_t *session, uint32_t pgn, uint8_t src,
+		    uint8_t dest, const uint8_t *data, size_t len)
+{
+    struct delivered_t *d = &delivered[session - nodes];
+
+    d->count++;
+    d->pgn = pgn;
+    d->src = src;
+    d->dest = dest;
+    d->len = len;
+    memcpy(d->data, data, len);
+}
+
+static int seen(uint32_t pgn, int from, int since)
+/* frames of a PGN a node put on the bus since a bus position */
+{
+    int i, n = 0;
+
+    for (i = since; i < head; i++)
+	if (frame_pgn(&bus[i % BUS_FRAMES]) == pgn
+	    && (from < 0 || bus[i % BUS_FRAMES].from == from))
+	    n++;
+    return n;
+}
+
+static const struct frame_t *last(uint32_t pgn, int from)
+{
+    int i;
+
+    for (i = head - 1; i >= 0 && i >= head - BUS_FRAMES; i--)
+	if (frame_pgn(&bus[i % BUS_FRAMES]) == pgn
+	    && bus[i % BUS_FRAMES].from == from)
+	    return &bus[i % BUS_FRAMES];
+    return NULL;
+}
+
+static void bus_run(void)
+/* hand every frame written to the nodes that did not write it */
+{
+    while (tail < head) {
+	const struct frame_t *f = &bus[tail++ % BUS_FRAMES];
+	int i;
+
+	if (lose != NULL && lose(f))
+	    continue;
+	for (i = 0; i < NODES; i++)
+	    if (i != f->from && nodes[i].n2k.write != NULL)
+		(void)n2k_node_input(&nodes[i], frame_pgn(f), f->buf[4],
+				     f->buf[5], f->buf[6], f->buf + HEADER,
+				     f->len - HEADER, now);
+    }
+}
+
+static void run(double seconds)
+/* let the clock and the bus run */
+{
+    timestamp_t until = now + seconds;
+    int i;
+
+    bus_run();
+    while (now < until) {
+	now += STEP;
+	for (i = 0; i < NODES; i++) {
+	    timestamp_t wake = n2k_node_wake(&nodes[i].n2k);
+
+	    if (wake != 0 && wake <= now)
+		n2k_node_tick(&nodes[i], now);
+	}
+	bus_run();
+    }
+}
+
+static void reset(void)
+{
+    int i;
+
+    head = tail = 0;
+    lose = NULL;
+    now = 1000.0;
+    for (i = 0; i < NODES; i++) {
+	struct gps_device_t *s = &nodes[i];
+
+	memset(&s->n2k, 0, sizeof(s->n2k));
+	memset(s->gpsdata.ecu_names, 0, sizeof(s->gpsdata.ecu_names));
+	memset(s->gpsdata.src_addr_seen, 0,
+	       sizeof(s->gpsdata.src_addr_seen));
+	s->context = &context;
+	s->n2k.address = N2K_NODE_NULL;
+	s->n2k.write = bus_write;
+	s->n2k.deliver = deliver;
+	s->n2k.name = n2k_node_name(135, 1000 + i);
+	s->n2k.ntx = 2;
+	s->n2k.tx_pgns[0] = 60928;
+	s->n2k.tx_pgns[1] = 129025;
+	s->n2k.nrx = 1;
+	s->n2k.rx_pgns[0] = 59904;
+	memset(&delivered[i], 0, sizeof(delivered[i]));
+    }
+}
+
+static void claims(void)
+{
+    const struct frame_t *f;
+
+    /* a configured address is claimed at once */
+    reset();
+    n2k_node_start(&nodes[0], 10, now);
+    check(nodes[0].n2k.state == n2k_node_claiming, "not claiming 10");
+    check(nodes[0].gpsdata.dev.node_state == node_starting,
+	  "node_state not starting while claiming");
+    run(0.1);
+    check(nodes[0].n2k.state == n2k_node_claiming,
+	  "ready before 250ms");
+    run(0.2);
+    check(nodes[0].n2k.state == n2k_node_ready
+	  && nodes[0].gpsdata.dev.node_state == node_ready
+	  && nodes[0].driver.nmea2000.own_src_id == 10,
+	  "not ready on address 10");
+    f = last(60928, 0);
+    check(f != NULL && f->buf[5] == 10 && f->buf[6] == 255
+	  && getleu64(f->buf, HEADER) == nodes[0].n2k.name,
+	  "claim of 10 wrong on the bus");
+
+    /* without one, a node asks, listens and claims a free address */
+    n2k_node_start(&nodes[1], 0xff, now);
+    check(nodes[1].n2k.state == n2k_node_waiting, "not waiting");
+    f = last(59904, 1);
+    check(f != NULL && f->buf[5] == N2K_NODE_NULL
+	  && getleu24(f->buf, HEADER) == 60928, "no request for claims");
+    run(0.1);
+    check(nodes[1].gpsdata.ecu_names[10] == nodes[0].n2k.name,
+	  "claim of 10 not answered to the request");
+    run(2.5);
+    check(nodes[1].n2k.state == n2k_node_ready
+	  && nodes[1].n2k.address != 10
+	  && nodes[1].n2k.address < 240, "second node got %u",
+	  nodes[1].n2k.address);
+
+    /* the lower NAME takes a contested address */
+    nodes[2].n2k.name = nodes[0].n2k.name - 1;
+    n2k_node_start(&nodes[2], 10, now);
+    run(0.5);
+    check(nodes[2].n2k.state == n2k_node_ready
+	  && nodes[2].n2k.address == 10, "lower NAME lost 10");
+    check(nodes[0].n2k.state == n2k_node_ready
+	  && nodes[0].n2k.address != 10
+	  && nodes[0].n2k.address != nodes[1].n2k.address,
+	  "higher NAME kept or took %u", nodes[0].n2k.address);
+    check(nodes[0].n2k.conflicts == 1, "conflict not counted");
+
+    /* and keeps it against a higher one */
+    nodes[2].n2k.address = nodes[1].n2k.address;
+    nodes[2].n2k.name = nodes[1].n2k.name + 1;
+    nodes[2].n2k.state = n2k_node_claiming;
+    nodes[2].n2k.deadline = now + 0.25;
+    bus_write(&nodes[2], last(60928, 2)->buf, 15);
+    bus[(head - 1) % BUS_FRAMES].buf[5] = nodes[1].n2k.address;
+    putle64(bus[(head - 1) % BUS_FRAMES].buf, HEADER, nodes[2].n2k.name);
+    run(0.5);
+    check(nodes[1].n2k.state == n2k_node_ready
+	  && nodes[1].n2k.address == nodes[1].driver.nmea2000.own_src_id
+	  && nodes[2].n2k.address != nodes[1].n2k.address,
+	  "lower NAME did not defend its address");
+
+    /* with every address taken, a loser can only say it cannot claim */
+    reset();
+    n2k_node_start(&nodes[0], 10, now);
+    run(0.5);
+    memset(nodes[0].gpsdata.src_addr_seen, 1,
+	   sizeof(nodes[0].gpsdata.src_addr_seen));
+    nodes[1].n2k.name = nodes[0].n2k.name - 1;
+    n2k_node_start(&nodes[1], 10, now);
+    run(0.5);
+    check(nodes[0].n2k.state == n2k_node_lost
+	  && nodes[0].gpsdata.dev.node_state != node_ready,
+	  "no cannot-claim with no address left");
+    f = last(60928, 0);
+    check(f != NULL && f->buf[5] == N2K_NODE_NULL, "cannot-claim not sent");
+    check(n2k_node_send(&nodes[0], 129025, 2, 255,
+			(const uint8_t *)"12345678", 8, now) == -1,
+	  "sent without an address");
+}
+
+static void requests(void)
+{
+    const struct frame_t *f;
+    uint8_t req[3];
+    int mark, i;
+
+    reset();
+    n2k_node_start(&nodes[0], 10, now);
+    n2k_node_start(&nodes[1], 20, now);
+    run(0.5);
+
+    /* product information */
+    mark = head;
+    putle24(req, 0, 126996);
+    n2k_node_send(&nodes[1], 59904, 6, 10, req, 3, now);
+    run(0.1);
+    f = last(126996, 0);
+    check(seen(126996, 0, mark) == 1 && f->len == HEADER + 134
+	  && memcmp(f->buf + HEADER + 4, "vyacht network router", 21) == 0,
+	  "product information not sent");
+
+    /* a request to someone else is not for us */
+    mark = head;
+    n2k_node_send(&nodes[1], 59904, 6, 30, req, 3, now);
+    run(0.1);
+    check(seen(126996, 0, mark) == 0, "answered a request to 30");
+
+    /* short PGN lists go as fast packets */
+    mark = head;
+    putle24(req, 0, 126464);
+    n2k_node_send(&nodes[1], 59904, 6, 255, req, 3, now);
+    run(0.1);
+    check(seen(126464, 0, mark) == 2, "PGN lists not sent");
+    f = last(126464, 0);
+    check(f != NULL && f->len == HEADER + 4 && f->buf[HEADER] == 1
+	  && getleu24(f->buf, HEADER + 1) == 59904, "receive list wrong");
+
+    /* long ones by transport, to whoever asked */
+    nodes[0].n2k.ntx = N2K_NODE_PGNS;
+    for (i = 0; i < N2K_NODE_PGNS; i++)
+	nodes[0].n2k.tx_pgns[i] = 130000 + i;
+    n2k_node_send(&nodes[1], 59904, 6, 10, req, 3, now);
+    run(3.0);
+    check(delivered[1].count == 1 && delivered[1].pgn == 126464
+	  && delivered[1].len == 1 + 3 * N2K_NODE_PGNS
+	  && delivered[1].data[0] == 0
+	  && getleu24(delivered[1].data, 1 + 3 * 77) == 130077,
+	  "long transmit list did not arrive");
+    f = last(126464, 0);
+    check(f != NULL && f->buf[HEADER] == 1,
+	  "receive list did not follow the transfer");
+
+    /* anything else addressed to us is refused */
+    mark = head;
+    putle24(req, 0, 65280);
+    n2k_node_send(&nodes[1], 59904, 6, 10, req, 3, now);
+    run(0.1);
+    f = last(59392, 0);
+    check(seen(59392, 0, mark) == 1 && f->buf[HEADER] == 1
+	  && f->buf[HEADER + 4] == 20
+	  && getleu24(f->buf, HEADER + 5) == 65280, "no NAK for 65280");
+    mark = head;
+    n2k_node_send(&nodes[1], 59904, 6, 255, req, 3, now);
+    run(0.1);
+    check(seen(59392, 0, mark) == 0, "NAK to a global request");
+    check(nodes[0].n2k.requests == 5, "requests counted %lu",
+	  nodes[0].n2k.requests);
+}
+
+static void message(uint8_t *data, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+	data[i] = (uint8_t)(i * 7 + len);
+}
+
+static int dt_dropped;
+
+static bool drop_dt5(const struct frame_t *f)
+{
+    if (frame_pgn(f) == 60160 && f->buf[HEADER] == 5 && dt_dropped == 0) {
+	dt_dropped++;
+	return true;
+    }
+    return false;
+}
+
+static bool drop_from_1(const struct frame_t *f)
+{
+    return f->from == 1;
+}
+
+static bool drop_dt_from_0(const struct frame_t *f)
+{
+    return f->from == 0 && frame_pgn(f) == 60160 && f->buf[HEADER] > 3;
+}
+
+static void transport(void)
+{
+    static uint8_t data[N2K_TP_MAX];
+    unsigned long aborts;
+    int mark;
+
+    reset();
+    n2k_node_start(&nodes[0], 10, now);
+    n2k_node_start(&nodes[1], 20, now);
+    n2k_node_start(&nodes[2], 30, now);
+    run(0.5);
+
+    /* a broadcast, paced at 50ms a packet */
+    message(data, 300);
+    mark = head;
+    check(n2k_node_send(&nodes[0], 130820, 7, 255, data, 300, now) == 0,
+	  "BAM refused");
+    check(n2k_node_send(&nodes[0], 130820, 7, 255, data, 300, now) == -1,
+	  "second transfer not refused while busy");
+    check(n2k_node_wake(&nodes[0].n2k) > now, "no wake for the BAM");
+    run(1.0);
+    check(seen(60160, 0, mark) == 20, "BAM went too fast: %d packets in 1s",
+	  seen(60160, 0, mark));
+    run(2.0);
+    check(delivered[1].count == 1 && delivered[2].count == 1
+	  && delivered[1].len == 300 && delivered[1].dest == 255
+	  && memcmp(delivered[1].data, data, 300) == 0
+	  && memcmp(delivered[2].data, data, 300) == 0,
+	  "BAM not received whole");
+    check(seen(60416, 1, mark) == 0, "BAM answered");
+    check(nodes[0].n2k.tp_sent == 1 && nodes[1].n2k.tp_received == 1,
+	  "BAM not counted");
+    check(n2k_node_wake(&nodes[0].n2k) == 0, "wake after the BAM");
+
+    /* the largest message, to one node, in windows of 16 */
+    message(data, N2K_TP_MAX);
+    mark = head;
+    check(n2k_node_send(&nodes[0], 130821, 7, 20, data, N2K_TP_MAX, now)
+	  == 0, "RTS refused");
+    run(0.1);
+    check(delivered[1].count == 2 && delivered[1].pgn == 130821
+	  && delivered[1].len == N2K_TP_MAX && delivered[1].dest == 20
+	  && memcmp(delivered[1].data, data, N2K_TP_MAX) == 0,
+	  "RTS/CTS transfer not received whole");
+    check(delivered[2].count == 1, "third node took a transfer to 20");
+    check(seen(60416, 1, mark) == 16 + 1, "%d CTS and EOM, not 17",
+	  seen(60416, 1, mark));
+    check(nodes[0].n2k.tx.state == n2k_tp_idle && nodes[0].n2k.tp_sent == 2,
+	  "sender not done");
+
+    /* a lost packet ends it, and the sender hears so */
+    message(data, 400);
+    dt_dropped = 0;
+    lose = drop_dt5;
+    (void)n2k_node_send(&nodes[0], 130822, 7, 20, data, 400, now);
+    run(0.1);
+    check(delivered[1].count == 2 && nodes[1].n2k.tp_aborts == 1
+	  && nodes[0].n2k.tx.state == n2k_tp_idle,
+	  "lost packet not aborted");
+
+    /* the sender gives up on a receiver that does not answer */
+    aborts = nodes[0].n2k.tp_aborts;
+    lose = drop_from_1;
+    (void)n2k_node_send(&nodes[0], 130822, 7, 20, data, 400, now);
+    run(1.0);
+    check(nodes[0].n2k.tx.state == n2k_tp_rts, "gave up too early");
+    run(0.5);
+    check(nodes[0].n2k.tx.state == n2k_tp_idle
+	  && nodes[0].n2k.tp_aborts == aborts + 1,
+	  "no timeout waiting for CTS");
+
+    /* and the receiver on a sender that goes quiet */
+    run(1.0);
+    aborts = nodes[1].n2k.tp_aborts;
+    lose = drop_dt_from_0;
+    (void)n2k_node_send(&nodes[0], 130822, 7, 20, data, 400, now);
+    run(0.5);
+    check(n2k_node_wake(&nodes[1].n2k) != 0, "receiver has no timer");
+    run(1.5);
+    check(nodes[1].n2k.rx[0].state == n2k_tp_idle
+	  && nodes[1].n2k.tp_aborts == aborts + 1,
+	  "no timeout waiting for data");
+    lose = NULL;
+    run(2.0);
+    check(n2k_node_wake(&nodes[0].n2k) == 0
+	  && n2k_node_wake(&nodes[1].n2k) == 0, "timers left running");
+}
+
+#ifndef S_SPLINT_S
+/*
+ * Over SocketCAN every node has a socket of its own, and messages are
+ * cut into CAN frames here: up to 8 bytes in one, longer ones as fast
+ * packets.
+ */
+static int can_fd[NODES];
+static uint8_t fast_seq;
+
+static ssize_t can_write(struct gps_device_t *session, const uint8_t *buf,
+			 size_t len)
+{
+    int fd = can_fd[session - nodes];
+    uint32_t pgn = getleu32(buf, 0);
+    struct can_frame frame;
+    size_t n = len - HEADER, off;
+    uint8_t counter = 0;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = CAN_EFF_FLAG | ((uint32_t)(buf[4] & 7) << 26)
+	| (pgn << 8) | buf[5];
+    if (((pgn >> 8) & 0xff) < 240)
+	frame.can_id |= (uint32_t)buf[6] << 8;
+    if (n <= 8) {
+	frame.can_dlc = (uint8_t)n;
+	memcpy(frame.data, buf + HEADER, n);
+	return write(fd, &frame, sizeof(frame)) == sizeof(frame) ?
+	    (ssize_t)len : -1;
+    }
+    fast_seq = (uint8_t)((fast_seq + 1) & 7);
+    for (off = 0; off < n; counter++) {
+	size_t chunk;
+
+	memset(frame.data, 0xff, 8);
+	frame.can_dlc = 8;
+	frame.data[0] = (uint8_t)((fast_seq << 5) | counter);
+	if (counter == 0) {
+	    frame.data[1] = (uint8_t)n;
+	    chunk = n < 6 ? n : 6;
+	    memcpy(frame.data + 2, buf + HEADER, chunk);
+	} else {
+	    chunk = n - off < 7 ? n - off : 7;
+	    memcpy(frame.data + 1, buf + HEADER + off, chunk);
+	}
+	off += chunk;
+	if (write(fd, &frame, sizeof(frame)) != sizeof(frame))
+	    return -1;
+    }
+    return (ssize_t)len;
+}
+
+struct fast_t {
+    uint32_t id;
+    size_t len, have;
+    uint8_t data[N2K_FAST_MAX];
+};
+
+static void can_read(int node, struct fast_t *fast)
+/* everything waiting on a node's socket, into the node */
+{
+    struct can_frame frame;
+
+    while (read(can_fd[node], &frame, sizeof(frame)) == sizeof(frame)) {
+	uint32_t pgn = (frame.can_id >> 8) & 0x1ffff;
+	uint8_t src = frame.can_id & 0xff, dest = 255;
+
+	if (((pgn >> 8) & 0xff) < 240) {
+	    dest = pgn & 0xff;
+	    pgn &= 0x1ff00;
+	}
+	if (pgn != 126996 && pgn != 126464) {
+	    if (!n2k_node_input(&nodes[node], pgn, 6, src, dest, frame.data,
+				frame.can_dlc, timestamp()))
+		deliver(&nodes[node], pgn, src, dest, frame.data,
+			frame.can_dlc);
+	    continue;
+	}
+	if ((frame.data[0] & 0x1f) == 0) {
+	    fast->id = frame.can_id;
+	    fast->len = frame.data[1];
+	    fast->have = 0;
+	    memcpy(fast->data, frame.data + 2, 6);
+	    fast->have = 6;
+	} else if (frame.can_id == fast->id && fast->have < fast->len) {
+	    memcpy(fast->data + fast->have, frame.data + 1, 7);
+	    fast->have += 7;
+	}
+	if (fast->len > 0 && fast->have >= fast->len && frame.can_id == fast->id) {
+	    deliver(&nodes[node], pgn, src, dest, fast->data, fast->len);
+	    fast->len = 0;
+	}
+    }
+}
+
+static int can_open(const char *name)
+{
+    struct sockaddr_can addr;
+    struct ifreq ifr;
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+    if (fd < 0)
+	return -1;
+    memset(&ifr, 0, sizeof(ifr));
+    (void)strlcpy(ifr.ifr_name, name, sizeof(ifr.ifr_name));
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) != 0
+	|| (addr.can_ifindex = ifr.ifr_ifindex,
+	    bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+	|| fcntl(fd, F_SETFL, O_NONBLOCK) != 0) {
+	(void)close(fd);
+	return -1;
+    }
+    return fd;
+}
+
+static void can_run(double seconds)
+{
+    static struct fast_t fast[2];
+    timestamp_t until = timestamp() + seconds;
+
+    while (timestamp() < until) {
+	struct timeval tv = {0, 5000};
+	fd_set fds;
+	int i;
+
+	FD_ZERO(&fds);
+	FD_SET(can_fd[0], &fds);
+	FD_SET(can_fd[1], &fds);
+	(void)select((can_fd[0] > can_fd[1] ? can_fd[0] : can_fd[1]) + 1,
+		     &fds, NULL, NULL, &tv);
+	for (i = 0; i < 2; i++) {
+	    timestamp_t wake;
+
+	    can_read(i, &fast[i]);
+	    wake = n2k_node_wake(&nodes[i].n2k);
+	    if (wake != 0 && wake <= timestamp())
+		n2k_node_tick(&nodes[i], timestamp());
+	}
+    }
+}
+
+static void over_can(const char *name)
+/* node 0 is ours, node 1 the responder */
+{
+    static uint8_t data[600];
+    uint8_t req[3];
+
+    reset();
+    if ((can_fd[0] = can_open(name)) < 0 || (can_fd[1] = can_open(name)) < 0) {
+	(void)fprintf(stderr, "test_n2knode: cannot open %s\n", name);
+	exit(EXIT_FAILURE);
+    }
+    nodes[0].n2k.write = nodes[1].n2k.write = can_write;
+
+    n2k_node_start(&nodes[1], 40, timestamp());
+    can_run(0.5);
+    n2k_node_start(&nodes[0], 0xff, timestamp());
+    can_run(2.5);
+    check(nodes[0].n2k.state == n2k_node_ready
+	  && nodes[0].n2k.address != 40
+	  && nodes[1].n2k.state == n2k_node_ready, "no addresses over CAN");
+    check(nodes[0].gpsdata.ecu_names[40] == nodes[1].n2k.name,
+	  "responder's claim not seen over CAN");
+
+    putle24(req, 0, 126996);
+    (void)n2k_node_send(&nodes[1], 59904, 6, nodes[0].n2k.address,
+			req, 3, timestamp());
+    can_run(0.2);
+    check(delivered[1].pgn == 126996 && delivered[1].len == 134,
+	  "no product information over CAN");
+
+    message(data, sizeof(data));
+    (void)n2k_node_send(&nodes[0], 130820, 7, 40, data, sizeof(data),
+			timestamp());
+    can_run(0.5);
+    check(delivered[1].pgn == 130820 && delivered[1].len == sizeof(data)
+	  && memcmp(delivered[1].data, data, sizeof(data)) == 0,
+	  "RTS/CTS transfer not received over CAN");
+    (void)n2k_node_send(&nodes[0], 130821, 7, 255, data, 300, timestamp());
+    can_run(3.0);
+    check(delivered[1].pgn == 130821 && delivered[1].len == 300
+	  && memcmp(delivered[1].data, data, 300) == 0,
+	  "BAM not received over CAN");
+    (void)close(can_fd[0]);
+    (void)close(can_fd[1]);
+}
+#endif /* S_SPLINT_S */
+
+int main(int argc, char **argv)
+{
+    const char *canif = NULL;
+    int option;
+
+    while ((option = getopt(argc, argv, "i:")) != -1) {
+	switch (option) {
+	case 'i':
+	    canif = optarg;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_n2knode [-i canif]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+#ifndef S_SPLINT_S
+    if (canif != NULL)
+	over_can(canif);
+    else
+#endif /* S_SPLINT_S */
+    {
+	claims();
+	requests();
+	transport();
+    }
+    if (failures == 0)
+	(void)printf("NMEA 2000 node test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,243 @@
+/*
+ * test_nmea - check NMEA 0183 sentence dispatch and field splitting
+ *
+ * With no arguments, sends every sentence type the driver knows through
+ * nmea_parse() under several talker IDs and checks that each lands on
+ * its handler, that Garmin's PGRMC isn't taken for RMC, that unknown
+ * tags and bad checksums go nowhere, and that fields come out split as
+ * the handlers expect.  With -b it times nmea_parse() over the NMEA
+ * sentences in the logs given:
+ *
+ *	test_nmea -b test/daemon/<name>.log ...
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+
+#define BENCH_REPEAT	20	/* passes over the sentences when timing */
+#define BENCH_MAX	200000	/* sentences kept for timing */
+
+ssize_t gpsd_write(struct gps_device_t *session,
+		   const char *buf,
+		   const size_t len)
+/* pass low-level data to devices straight through */
+{
+    return gpsd_serial_write(session, buf, len);
+}
+
+void gpsd_throttled_report(const int subsys UNUSED,
+			   const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+/* keep in step with nmea_phrase[] in driver_nmea0183.c */
+static const char *phrases[] = {
+    "APA", "APB", "DBT", "DPT", "GGA", "GLL", "GST", "GSA", "GSV", "GBS",
+    "HDG", "HDM", "HDT", "MDA", "MTW", "MWD", "MWV", "RMC", "RMB", "ROT",
+    "RSA", "VHW", "VLW", "VTG", "VWR", "XTE", "ZDA", "PGRME",
+#ifdef TNT_ENABLE
+    "PTNTHTM",
+#endif /* TNT_ENABLE */
+#ifdef ASHTECH_ENABLE
+    "PASHR",
+#endif /* ASHTECH_ENABLE */
+#ifdef OCEANSERVER_ENABLE
+    "OHPR",
+#endif /* OCEANSERVER_ENABLE */
+};
+
+static struct gps_context_t context;
+static struct gps_device_t session;
+static int failures = 0;
+
+static gps_mask_t parse(const char *body, bool checksum)
+/* wrap a sentence body in '$' and a checksum and parse it */
+{
+    char sentence[NMEA_MAX + 1];
+    unsigned int sum = 0;
+    const char *p;
+
+    for (p = body; *p != '\0'; p++)
+	sum ^= (unsigned char)*p;
+    if (checksum)
+	(void)snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, sum);
+    else
+	(void)snprintf(sentence, sizeof(sentence), "$%s\r\n", body);
+    session.gpsdata.tag[0] = '\0';
+    return nmea_parse(sentence, &session);
+}
+
+static void expect_tag(const char *body, const char *want)
+{
+    (void)parse(body, true);
+    if (strcmp(session.gpsdata.tag, want) != 0) {
+	(void)fprintf(stderr, "%s: dispatched as \"%s\", wanted \"%s\"\n",
+		      body, session.gpsdata.tag, want);
+	failures++;
+    }
+}
+
+static void expect_fields(const char *body, bool checksum,
+			  const char *const *want, int n)
+{
+    int i;
+
+    (void)parse(body, checksum);
+    for (i = 0; i < n + 4; i++) {
+	const char *got = session.driver.nmea.field[i];
+	const char *expected = i < n ? want[i] : "";
+
+	if (got == NULL || strcmp(got, expected) != 0) {
+	    (void)fprintf(stderr, "%s: field %d is \"%s\", wanted \"%s\"\n",
+			  body, i, got == NULL ? "(null)" : got, expected);
+	    failures++;
+	}
+    }
+}
+
+static void selftest(void)
+{
+    static const char *talkers[] = {"GP", "GN", "II", "WI", "HC"};
+    static const char *split[] = {"GPXYZ", "a", "", "c", ""};
+    static const char *nostar[] = {"GPXYZ", "a", ""};
+    char body[NMEA_MAX];
+    unsigned int i, j;
+
+    for (i = 0; i < sizeof(phrases) / sizeof(phrases[0]); i++) {
+	if (strlen(phrases[i]) != 3) {
+	    /* enough empty fields for any handler's minimum */
+	    (void)snprintf(body, sizeof(body), "%s,,,,,,,,,,,,,,,,,,,,",
+			   phrases[i]);
+	    expect_tag(body, phrases[i]);
+	    continue;
+	}
+	for (j = 0; j < sizeof(talkers) / sizeof(talkers[0]); j++) {
+	    (void)snprintf(body, sizeof(body), "%s%s,,,,,,,,,,,,,,,,,,,,",
+			   talkers[j], phrases[i]);
+	    expect_tag(body, phrases[i]);
+	}
+    }
+
+    /* Garmin's binary-mode switch echoes back; it must not read as RMC */
+    expect_tag("PGRMC,,,,,,,,,,,,,", "");
+    expect_tag("PGRMO,,2", "");
+    /* unknown, misshapen and too-short tags */
+    expect_tag("GPXYZ,1,2,3", "");
+    expect_tag("GPRMCX,,,,,,,,,,,,", "");
+    expect_tag("RMC,,,,,,,,,,,,", "");
+    expect_tag("GP,,,,,,,,,,,,", "");
+    expect_tag(",,,,,,,,,,,,", "");
+    /* too few fields for the handler */
+    expect_tag("GPRMC,1,2", "");
+
+    /* a bad checksum is refused, an absent one is not checked */
+    if (parse("GPGGA,,,,,,,,,,,,,,", true) == 0
+	|| strcmp(session.gpsdata.tag, "GGA") != 0) {
+	(void)fprintf(stderr, "good checksum refused\n");
+	failures++;
+    }
+    session.gpsdata.tag[0] = '\0';
+    if (nmea_parse("$GPGGA,,,,,,,,,,,,,,*00\r\n", &session) != ONLINE_SET
+	|| session.gpsdata.tag[0] != '\0') {
+	(void)fprintf(stderr, "bad checksum accepted\n");
+	failures++;
+    }
+    (void)parse("GPGGA,,,,,,,,,,,,,,,", false);
+    if (strcmp(session.gpsdata.tag, "GGA") != 0) {
+	(void)fprintf(stderr, "sentence without checksum refused\n");
+	failures++;
+    }
+
+    /* a '*' ends the last field; without one the last field is dropped */
+    expect_fields("GPXYZ,a,,c", true, split, 4);
+    expect_fields("GPXYZ,a,,c", false, nostar, 2);
+
+    if (failures == 0)
+	(void)printf("NMEA dispatch test succeeded.\n");
+}
+
+static void benchmark(int argc, char **argv)
+{
+    static char lines[BENCH_MAX][NMEA_MAX + 1];
+    char buf[BUFSIZ];
+    struct timespec t0, t1;
+    double seconds;
+    int i, n = 0, pass;
+
+    for (i = 0; i < argc; i++) {
+	FILE *fp;
+
+	if ((fp = fopen(argv[i], "r")) == NULL) {
+	    (void)fprintf(stderr, "test_nmea: can't open %s\n", argv[i]);
+	    exit(EXIT_FAILURE);
+	}
+	while (n < BENCH_MAX && fgets(buf, sizeof(buf), fp) != NULL)
+	    if (buf[0] == '$' && strlen(buf) <= NMEA_MAX)
+		(void)strlcpy(lines[n++], buf, sizeof(lines[0]));
+	(void)fclose(fp);
+    }
+    if (n == 0) {
+	(void)fprintf(stderr, "test_nmea: no NMEA sentences\n");
+	exit(EXIT_FAILURE);
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (pass = 0; pass < BENCH_REPEAT; pass++)
+	for (i = 0; i < n; i++)
+	    (void)nmea_parse(lines[i], &session);
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    (void)printf("%d sentences x %d in %.3fs: %.0f sentences/s\n",
+		 n, BENCH_REPEAT, seconds, n * BENCH_REPEAT / seconds);
+}
+
+int main(int argc, char **argv)
+{
+    bool bench = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "b")) != -1) {
+	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_nmea [-b logfile...]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    gps_context_init(&context);
+    gpsd_time_init(&context, time(NULL));
+    context.readonly = true;
+    gpsd_init(&session, &context, NULL);
+    gpsd_clear(&session);
+
+    if (bench)
+	benchmark(argc - optind, argv + optind);
+    else
+	selftest();
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
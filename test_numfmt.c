@@ -0,0 +1,231 @@
+/*
+ * test_numfmt - check the report writers' number conversions against printf
+ *
+ * Every numfmt_*() routine promises the exact output of a printf
+ * conversion.  This walks the value ranges the JSON, pseudo-NMEA and
+ * SignalK writers actually feed them, exhaustively on the decimal grid
+ * and at every rounding midpoint (and the doubles either side of it),
+ * plus a random sweep, and compares both the text and the return value.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+static int failures = 0;
+
+static void report(const char *what, const char *want, int wantn,
+		   const char *got, int gotn)
+{
+    if (failures++ < 20)
+	(void)fprintf(stderr, "%s: printf \"%s\" (%d), numfmt \"%s\" (%d)\n",
+		      what, want, wantn, got, gotn);
+}
+
+static void check_fixed(double x, int width, int decimals)
+{
+    char want[512], got[512];
+    int wantn, gotn;
+
+    wantn = snprintf(want, sizeof(want), "%0*.*f", width, decimals, x);
+    gotn = numfmt_fixed(got, sizeof(got), x, width, decimals);
+    if (wantn != gotn || strcmp(want, got) != 0) {
+	char what[64];
+
+	(void)snprintf(what, sizeof(what), "%%0%d.%df of %.17g",
+		       width, decimals, x);
+	report(what, want, wantn, got, gotn);
+    }
+}
+
+static void check_around(double x, int width, int decimals)
+/* x and the doubles on either side of it, both signs */
+{
+    check_fixed(x, width, decimals);
+    check_fixed(nextafter(x, HUGE_VAL), width, decimals);
+    check_fixed(nextafter(x, -HUGE_VAL), width, decimals);
+    check_fixed(-x, width, decimals);
+}
+
+static void sweep_fixed(int width, int decimals, long units)
+/* every value k/10^decimals up to units and every midpoint between them */
+{
+    double scale = pow(10.0, (double)decimals);
+    long k;
+
+    for (k = 0; k <= units; k++) {
+	check_around(k / scale, width, decimals);
+	check_around((k + 0.5) / scale, width, decimals);
+    }
+}
+
+static void check_dm(double degrees, int width)
+{
+    char want[64], got[64];
+    double angle = fabs(degrees), integer;
+    double fraction = modf(angle, &integer);
+    int wantn, gotn;
+
+    wantn = snprintf(want, sizeof(want), "%0*.4f", width,
+		     floor(angle) * 100 + fraction * 60);
+    gotn = numfmt_dm(got, sizeof(got), degrees, width);
+    if (wantn != gotn || strcmp(want, got) != 0) {
+	char what[64];
+
+	(void)snprintf(what, sizeof(what), "DDMM.mmmm of %.17g", degrees);
+	report(what, want, wantn, got, gotn);
+    }
+}
+
+static void check_scaled(long long units, int decimals)
+{
+    char want[64], got[64];
+    int wantn, gotn;
+
+    wantn = snprintf(want, sizeof(want), "%.*f", decimals,
+		     units / pow(10.0, (double)decimals));
+    gotn = numfmt_scaled(got, sizeof(got), units, decimals);
+    if (wantn != gotn || strcmp(want, got) != 0) {
+	char what[64];
+
+	(void)snprintf(what, sizeof(what), "%lld scaled by 10^-%d",
+		       units, decimals);
+	report(what, want, wantn, got, gotn);
+    }
+}
+
+static void check_int(long long v, int width)
+{
+    char want[64], got[64];
+    int wantn, gotn;
+
+    wantn = snprintf(want, sizeof(want), "%0*lld", width, v);
+    gotn = numfmt_int(got, sizeof(got), v, width);
+    if (wantn != gotn || strcmp(want, got) != 0)
+	report("%0*lld", want, wantn, got, gotn);
+    if (v >= 0) {
+	wantn = snprintf(want, sizeof(want), "%0*llu", width,
+			 (unsigned long long)v);
+	gotn = numfmt_uint(got, sizeof(got), (unsigned long long)v, width);
+	if (wantn != gotn || strcmp(want, got) != 0)
+	    report("%0*llu", want, wantn, got, gotn);
+    }
+}
+
+static void check_truncation(void)
+/* short buffers are filled and terminated exactly as snprintf does */
+{
+    char want[16], got[16];
+    size_t len;
+
+    for (len = 0; len < sizeof(want); len++) {
+	int wantn, gotn;
+
+	(void)memset(want, 'x', sizeof(want));
+	(void)memset(got, 'x', sizeof(got));
+	wantn = snprintf(want, len, "%09.4f", 4807.0383);
+	gotn = numfmt_fixed(got, len, 4807.0383, 9, 4);
+	if (wantn != gotn || memcmp(want, got, sizeof(want)) != 0)
+	    report("truncated %09.4f", want, wantn, got, gotn);
+    }
+}
+
+int main(void)
+{
+    static const double edges[] = {
+	0.0, -0.0, 0.5, -0.5, 1.5, 2.5, 0.05, 0.15, 0.25, 0.35, 0.45,
+	0.125, 0.0005, 0.9999999995, 9.5, 99.95, 179.99995, -179.99995,
+	1e-12, -1e-12, 1e14, 1e16, -1e16, 1e300, 123456789.123456789,
+	HUGE_VAL, -HUGE_VAL,
+    };
+    static const long long ints[] = {
+	0, 1, -1, 9, 10, -10, 99, 100, 4294967295LL, -2147483648LL,
+	9223372036854775807LL, -9223372036854775807LL - 1,
+    };
+    unsigned int i;
+    int d, w;
+    long k;
+
+    /* odd values, every precision and padding the writers use */
+    for (i = 0; i < NITEMS(edges); i++)
+	for (d = 0; d <= 9; d++)
+	    for (w = 0; w <= 12; w += 4)
+		check_fixed(edges[i], w, d);
+    check_fixed(NAN, 0, 2);
+    check_fixed(NAN, 5, 2);
+    check_fixed(11.0, 0, 12);
+    check_fixed(11.0, 40, 2);
+
+    /* %02.0f signal strengths, %05.2f ZDA seconds, DOPs */
+    sweep_fixed(2, 0, 100);
+    sweep_fixed(5, 2, 6100);
+    sweep_fixed(0, 1, 10000);
+    /* %.2f angles, speeds, depths and temperatures; %.3f and %.4f */
+    sweep_fixed(0, 2, 100000);
+    sweep_fixed(0, 3, 100000);
+    sweep_fixed(0, 4, 100000);
+
+    /* NMEA coordinates: a grid over the globe, then every 1/10000
+     * minute rounding boundary within some whole degrees */
+    for (k = 0; k <= 1800000; k += 7)
+	check_dm(k / 10000.0, 10);
+    for (d = 0; d <= 179; d += 179) {
+	for (k = 0; k < 600000; k++) {
+	    double deg = d + (k + 0.5) / 600000.0;
+
+	    check_dm(deg, 10);
+	    check_dm(nextafter(deg, HUGE_VAL), 10);
+	    check_dm(nextafter(deg, -HUGE_VAL), 10);
+	}
+    }
+
+    /* AIS speeds, courses and draughts are integer tenths */
+    for (k = -100000; k <= 100000; k++)
+	check_scaled(k, 1);
+    for (d = 0; d <= 6; d++)
+	check_scaled(-123456789LL, d);
+
+    for (i = 0; i < NITEMS(ints); i++)
+	for (w = 0; w <= 24; w += 3)
+	    check_int(ints[i], w);
+    for (k = -1000; k <= 100000; k++)
+	check_int(k, (int)(k & 7));
+
+    /* random values in the shapes the dumpers see */
+    srand48(1);
+    for (k = 0; k < 1000000; k++) {
+	double x;
+
+	switch (k % 4) {
+	case 0:			/* latitude/longitude */
+	    x = drand48() * 360.0 - 180.0;
+	    break;
+	case 1:			/* errors, DOPs, altitudes */
+	    x = (drand48() - 0.3) * pow(10.0, (double)(lrand48() % 8));
+	    break;
+	case 2:			/* timestamps */
+	    x = 1.3e9 + drand48() * 1e8;
+	    break;
+	default:		/* AIS position in 1/10000 minute */
+	    x = (double)(lrand48() % 216000001 - 108000000) / 600000.0;
+	    break;
+	}
+	check_fixed(x, (int)(k % 3) * 5, (int)(k % 10));
+	if (k % 4 == 0)
+	    check_dm(x, 10);
+    }
+
+    check_truncation();
+
+    if (failures != 0) {
+	(void)fprintf(stderr, "%d mismatches\n", failures);
+	exit(EXIT_FAILURE);
+    }
+    (void)printf("Number formatting test succeeded.\n");
+    exit(EXIT_SUCCESS);
+}
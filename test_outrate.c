@@ -0,0 +1,327 @@
+/*
+ * test_outrate - check the output rate controller
+ *
+ * Frames offered faster than their rule's minimum interval must be
+ * held, the latest one replacing what is held, and go out from
+ * outrate_due() once the interval has passed.  Unchanged frames must
+ * only be repeated after the maximum interval.  Frames no rule covers
+ * must pass straight through, and a rule for one output must win over
+ * one for all of them.  The load must come out as the share of the
+ * link used.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gpsd.h"
+#include "bits.h"
+
+#define HEADER	7	/* PGN, priority, source, destination */
+
+/* n2k_decode.c logs through the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static struct outrate_rules_t rules;
+static struct outrate_t out;
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+	(void)fprintf(stderr, "%s\n", what);
+	failures++;
+    }
+}
+
+static size_t n2k_frame(char *buf, unsigned int pgn, int instance,
+			unsigned char fill)
+/* a framed 8 byte PGN, its index field set if it has one */
+{
+    const struct n2k_pgn_t *p = n2k_schema_find(pgn);
+    unsigned char *bu = (unsigned char *)buf;
+    int i;
+
+    putle32(bu, 0, pgn);
+    bu[4] = 2;
+    bu[5] = 1;
+    bu[6] = 0xff;
+    memset(bu + HEADER, fill, 8);
+    for (i = 0; p != NULL && i < p->nfields; i++)
+	if ((p->field[i].flags & N2K_INDEX) != 0) {
+	    const struct n2k_field_t *f = &p->field[i];
+	    int b;
+
+	    for (b = 0; b < f->width; b++) {
+		unsigned char m = 1u << ((f->bit + b) % 8);
+
+		if ((instance >> b) & 1)
+		    bu[HEADER + (f->bit + b) / 8] |= m;
+		else
+		    bu[HEADER + (f->bit + b) / 8] &= ~m;
+	    }
+	}
+    return HEADER + 8;
+}
+
+static void keys(void)
+{
+    char buf[32];
+    const char *mwv_r = "$WIMWV,045.0,R,10.2,N,A*00\r\n";
+    const char *mwv_t = "$WIMWV,045.0,T,10.2,N,A*00\r\n";
+    size_t len;
+
+    len = n2k_frame(buf, 129025, 0, 0x11);
+    check(outrate_key(OUTRATE_N2K, buf, len) == 129025, "129025 key");
+    len = n2k_frame(buf, 130306, 2, 0x11);
+    check(outrate_key(OUTRATE_N2K, buf, len) == (130306 | (3u << 24)),
+	  "130306 keeps its wind reference");
+    check(outrate_key(OUTRATE_N2K, buf, 3) == 0, "short N2K frame");
+
+    check(outrate_key(OUTRATE_NMEA, mwv_r, strlen(mwv_r))
+	  != outrate_key(OUTRATE_NMEA, mwv_t, strlen(mwv_t)),
+	  "MWV relative and true share a key");
+    check(outrate_key(OUTRATE_NMEA, "$GPRMC,1*00\r\n", 13)
+	  == outrate_key(OUTRATE_NMEA, "$GNRMC,2*00\r\n", 13),
+	  "RMC key depends on the talker");
+    check(outrate_key(OUTRATE_NMEA, "$PGRMZ,1*00\r\n", 13) == 0,
+	  "proprietary sentence is paced");
+    check(outrate_key(OUTRATE_NMEA, "!AIVDM,1*00\r\n", 13) == 0,
+	  "encapsulated sentence is paced");
+    check(outrate_key(OUTRATE_NMEA, "$GPR", 4) == 0, "short sentence key");
+}
+
+static void rules_set(void)
+{
+    struct outrate_rules_t r;
+
+    outrate_init(&r);
+    check(r.count > 0, "no default rules");
+    check(!outrate_set(&r, "0", -1, 100, 0), "PGN 0 accepted");
+    check(!outrate_set(&r, "200000", -1, 100, 0), "PGN too large accepted");
+    check(!outrate_set(&r, "12a", -1, 100, 0), "bad PGN accepted");
+    check(!outrate_set(&r, "GPRMC", -1, 100, 0), "talker accepted");
+    check(!outrate_set(&r, "rmc", -1, 100, 0), "lower case accepted");
+    check(!outrate_set(&r, "RMC", -1, 1000, 500), "max below min accepted");
+    check(outrate_set(&r, "RMC", 3, 2000, 0), "device rule refused");
+    check(outrate_set(&r, "RMC", 3, 3000, 0), "device rule not changed");
+}
+
+static void paced(void)
+/* a 10Hz source through a 100ms..-, a 1000ms..5000ms and no rule */
+{
+    char buf[32], outbuf[OUTRATE_BUF];
+    size_t lens[OUTRATE_FRAMES], len;
+    timestamp_t t0 = 1000.0, t;
+    int n, sent = 0, i;
+
+    memset(&out, 0, sizeof(out));
+    /* position every 100ms, offered every 50ms with a new value each */
+    for (i = 0; i < 20; i++) {
+	t = t0 + i * 0.05;
+	len = n2k_frame(buf, 129025, 0, (unsigned char)i);
+	if (outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t))
+	    sent++;
+	n = outrate_due(&out, OUTRATE_N2K, outbuf, lens, t);
+	sent += n;
+    }
+    check(sent == 10, "129025 not sent every 100ms");
+    check(out.kind[OUTRATE_N2K].held == 10, "129025 not held");
+
+    /* what is held is the latest, and goes out when due */
+    memset(&out, 0, sizeof(out));
+    len = n2k_frame(buf, 128259, 0, 1);
+    check(outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0),
+	  "first 128259 held");
+    len = n2k_frame(buf, 128259, 0, 2);
+    check(!outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0 + 0.2),
+	  "second 128259 sent early");
+    len = n2k_frame(buf, 128259, 0, 3);
+    check(!outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0 + 0.4),
+	  "third 128259 sent early");
+    check(out.kind[OUTRATE_N2K].coalesced == 1, "128259 not coalesced");
+    check(fabs(outrate_wake(&out) - (t0 + 1.0 - 0.002)) < 1e-6, "wrong wake time");
+    check(outrate_due(&out, OUTRATE_N2K, outbuf, lens, t0 + 0.99) == 0,
+	  "128259 due early");
+    check(outrate_due(&out, OUTRATE_NMEA, outbuf, lens, t0 + 1.0) == 0,
+	  "128259 due as a sentence");
+    n = outrate_due(&out, OUTRATE_N2K, outbuf, lens, t0 + 1.0);
+    check(n == 1 && lens[0] == len
+	  && (unsigned char)outbuf[HEADER] == 3, "latest 128259 not due");
+    check(outrate_wake(&out) == 0, "wake with nothing held");
+
+    /* unchanged, it waits for the maximum interval */
+    memset(&out, 0, sizeof(out));
+    len = n2k_frame(buf, 128275, 0, 7);
+    check(outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0),
+	  "first 128275 held");
+    for (i = 1, sent = 0; i <= 100; i++)
+	if (outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0 + i * 0.1))
+	    sent++;
+    check(sent == 2 && out.kind[OUTRATE_N2K].repeated == 2,
+	  "unchanged 128275 not repeated every 5s");
+
+    /* but without one it goes out at the minimum interval anyway */
+    memset(&out, 0, sizeof(out));
+    len = n2k_frame(buf, 128259, 0, 7);
+    for (i = 0, sent = 0; i < 30; i++)
+	if (outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0 + i * 0.1))
+	    sent++;
+    check(sent == 3, "unchanged 128259 not sent every second");
+
+    /* a source with jitter at the rule's interval keeps its rate */
+    memset(&out, 0, sizeof(out));
+    for (i = 0, sent = 0; i < 100; i++) {
+	t = t0 + i * 0.1 + ((i % 3) - 1) * 0.02;
+	len = n2k_frame(buf, 127250, 0, (unsigned char)i);
+	if (outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t))
+	    sent++;
+	sent += outrate_due(&out, OUTRATE_N2K, outbuf, lens, t + 0.03);
+    }
+    check(sent == 100, "jittery 127250 lost frames");
+
+    /* no rule, no pacing */
+    memset(&out, 0, sizeof(out));
+    len = n2k_frame(buf, 65280, 0, 7);
+    for (i = 0, sent = 0; i < 10; i++)
+	if (outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, t0))
+	    sent++;
+    check(sent == 10 && out.nslots == 0, "unruled PGN paced");
+}
+
+static void instances(void)
+/* wind by reference are separate slots */
+{
+    char buf[32];
+    size_t len;
+    int i;
+
+    memset(&out, 0, sizeof(out));
+    for (i = 0; i < 3; i++) {
+	len = n2k_frame(buf, 130306, i, 0x10);
+	check(outrate_offer(&out, &rules, 0, OUTRATE_N2K, buf, len, 1000.0),
+	      "130306 instance held by another");
+    }
+    check(out.nslots == 3, "130306 instances share a slot");
+}
+
+static void devices(void)
+/* a rule for one output wins over the one for all */
+{
+    struct outrate_rules_t r;
+    struct outrate_t other;
+    const char *rmc = "$GPRMC,1*00\r\n";
+    int i, sent0 = 0, sent1 = 0;
+
+    outrate_init(&r);
+    check(outrate_set(&r, "RMC", 1, 5000, 0), "device rule refused");
+    memset(&out, 0, sizeof(out));
+    memset(&other, 0, sizeof(other));
+    for (i = 0; i < 100; i++) {
+	timestamp_t t = 1000.0 + i * 0.1;
+	char s[16];
+
+	(void)snprintf(s, sizeof(s), "$GPRMC,%d*00\r\n", i % 10);
+	if (outrate_offer(&out, &r, 0, OUTRATE_NMEA, s, strlen(s), t))
+	    sent0++;
+	if (outrate_offer(&other, &r, 1, OUTRATE_NMEA, s, strlen(s), t))
+	    sent1++;
+    }
+    check(sent0 == 10, "RMC to output 0 not every second");
+    check(sent1 == 2, "RMC to output 1 not every 5 seconds");
+    check(outrate_key(OUTRATE_NMEA, rmc, strlen(rmc)) != 0, "RMC key");
+}
+
+static void split(void)
+/* several sentences in one write are paced one by one */
+{
+    const char *in = "$GPRMC,1*00\r\n$GPGGA,1*00\r\n$PGRMZ,1*00\r\n";
+    const char *again = "$GPRMC,2*00\r\n$GPGGA,2*00\r\n$PGRMZ,2*00\r\n";
+    char outbuf[OUTRATE_BUF];
+    size_t lens[OUTRATE_FRAMES], len = strlen(in);
+    int n;
+
+    memset(&out, 0, sizeof(out));
+    n = outrate_pace(&out, &rules, 0, OUTRATE_NMEA, in, &len, 1,
+		     outbuf, lens, 1000.0);
+    check(n == 3 && lens[0] == 13 && memcmp(outbuf, in, len) == 0,
+	  "first sentences not all sent");
+    n = outrate_pace(&out, &rules, 0, OUTRATE_NMEA, again, &len, 1,
+		     outbuf, lens, 1000.5);
+    check(n == 1 && lens[0] == 13 && memcmp(outbuf, "$PGRMZ,2", 8) == 0,
+	  "only the proprietary sentence should pass");
+    n = outrate_due(&out, OUTRATE_NMEA, outbuf, lens, 1001.0);
+    check(n == 2 && memcmp(outbuf, "$GPRMC,2", 8) == 0
+	  && memcmp(outbuf + lens[0], "$GPGGA,2", 8) == 0,
+	  "held sentences not due");
+}
+
+static void load(void)
+{
+    size_t lens[4] = {HEADER + 8, HEADER + 8, HEADER + 8, HEADER + 8};
+    size_t fast = HEADER + 43, line = 48;
+    struct outrate_load_t *l;
+    char reply[512];
+
+    memset(&out, 0, sizeof(out));
+    l = &out.kind[OUTRATE_N2K];
+    l->capacity = 250000;
+    outrate_count(&out, OUTRATE_N2K, lens, 4, 1000.0);
+    outrate_count(&out, OUTRATE_N2K, &fast, 1, 1000.5);
+    check(l->frames == 5 && l->bytes == 4 * 15 + 50, "N2K frames counted");
+    outrate_count(&out, OUTRATE_N2K, lens, 0, 1001.0);
+    /* 4 single frames and a fast packet of 7 */
+    check(fabs(l->load - 11 * 131 / 250000.0) < 1e-9, "wrong N2K load");
+    check(l->peak == l->load, "N2K peak");
+
+    l = &out.kind[OUTRATE_NMEA];
+    l->capacity = 4800;
+    outrate_count(&out, OUTRATE_NMEA, &line, 1, 1000.0);
+    outrate_count(&out, OUTRATE_NMEA, &line, 1, 1002.0);
+    check(fabs(l->load - 960 / 9600.0) < 1e-9, "wrong NMEA 0183 load");
+
+    reply[0] = '\0';
+    (void)outrate_json_dump(&out, reply, sizeof(reply));
+    check(strncmp(reply, "{\"n2k\":{\"frames\":5,", 19) == 0
+	  && strstr(reply, "\"nmea\":{\"frames\":2,") != NULL
+	  && reply[strlen(reply) - 1] == '}', "JSON dump");
+}
+
+int main(void)
+{
+    outrate_init(&rules);
+    keys();
+    rules_set();
+    paced();
+    instances();
+    devices();
+    split();
+    load();
+    if (failures == 0)
+	(void)printf("output rate controller test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,148 @@
+/*
+ * test_sched - check how gpsd_multipoll() classes devices
+ *
+ * Each case decodes what a kind of device sends, the way its driver
+ * would, and hands the change mask to sched_classify().  Heading
+ * sources, whether they send attitude, NMEA HDG, PGN 127250 or SeaTalk
+ * compass datagrams, and precision time must come out realtime; a
+ * device that mostly sends AIS must come out bulk, and anything else
+ * normal.  Once realtime, a device stays so.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpsd.h"
+
+extern gps_mask_t process_seatalk(uint8_t * cmdBuffer, uint8_t size,
+				  struct gps_device_t *session);
+
+/* the drivers log through the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+static struct gps_context_t context;
+static struct gps_device_t session;
+static int failures = 0;
+
+static void fresh(void)
+/* a device that has not been classed yet */
+{
+    gpsd_init(&session, &context, NULL);
+    gpsd_clear(&session);
+}
+
+static void classify(gps_mask_t changed)
+/* what gpsd_multipoll() does after handing a packet on */
+{
+    session.sched.packets++;
+    sched_classify(&session, changed);
+}
+
+static void expect(const char *what, enum sched_class_t want)
+{
+    if (session.sched.class != want) {
+	(void)fprintf(stderr, "%s: classed %s, wanted %s\n", what,
+		      sched_class_names[session.sched.class],
+		      sched_class_names[want]);
+	failures++;
+    }
+}
+
+static void nmea(const char *sentence)
+{
+    char buf[NMEA_MAX + 1];
+
+    (void)strlcpy(buf, sentence, sizeof(buf));
+    session.gpsdata.navigation.set = 0;
+    classify(nmea_parse(buf, &session));
+}
+
+int main(int argc UNUSED, char **argv UNUSED)
+{
+    /* 127250, 90 degrees true, no deviation or variation */
+    static const unsigned char hdg_127250[8] = {
+	0x00, 0x5c, 0x3d, 0xff, 0x7f, 0xff, 0x7f, 0xfc,
+    };
+    /* SeaTalk 89, ST40 compass, 180 degrees magnetic */
+    uint8_t hdg_89[] = {0x89, 0x12, 0x2d, 0x00, 0x20};
+    const struct n2k_pgn_t *pgn;
+    int i;
+
+    gps_context_init(&context);
+    gpsd_time_init(&context, time(NULL));
+    context.readonly = true;
+
+    fresh();
+    nmea("$HCHDG,98.3,0.0,E,12.6,W*57\r\n");
+    expect("NMEA HDG", SCHED_REALTIME);
+
+    fresh();
+    pgn = n2k_schema_find(127250);
+    if (pgn == NULL) {
+	(void)fprintf(stderr, "no schema for 127250\n");
+	failures++;
+    } else {
+	session.gpsdata.navigation.set = 0;
+	classify(n2k_decode(pgn, hdg_127250, (int)sizeof(hdg_127250),
+			    &session));
+	expect("PGN 127250", SCHED_REALTIME);
+    }
+
+    fresh();
+    classify(process_seatalk(hdg_89, (uint8_t)sizeof(hdg_89), &session));
+    expect("SeaTalk 89", SCHED_REALTIME);
+
+    fresh();
+    classify(ATTITUDE_SET);
+    expect("attitude", SCHED_REALTIME);
+
+    fresh();
+    classify(PPSTIME_IS);
+    expect("PPS", SCHED_REALTIME);
+
+    /* speed and course are navigation data too, but not a heading */
+    fresh();
+    nmea("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n");
+    expect("NMEA VTG", SCHED_NORMAL);
+
+    fresh();
+    for (i = 0; i < 4; i++)
+	classify(AIS_SET);
+    classify(NAVIGATION_SET);
+    expect("AIS receiver", SCHED_BULK);
+
+    fresh();
+    nmea("$HCHDG,98.3,0.0,E,12.6,W*57\r\n");
+    for (i = 0; i < 8; i++)
+	classify(AIS_SET);
+    expect("compass that also relays AIS", SCHED_REALTIME);
+
+    if (failures == 0)
+	(void)printf("Scheduling class test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,286 @@
+/*
+ * test_seatalk - check the SeaTalk datagram lexer and dispatch
+ *
+ * SeaTalk marks the command byte of a datagram with a ninth bit, which
+ * the tty reads as a parity bit and, with PARMRK, reports by putting
+ * 0xff 0x00 in front of the byte; a plain 0xff comes in doubled.  A
+ * stream of datagrams is framed that way here and read back through
+ * seatalk_packet_get() as from an st:// device: every datagram must come
+ * out whole and in order, and the known ones must decode to their
+ * values.  With -b it replays a long stream both ways, through the
+ * st:// lexer and as the datagrams a VYSPI device delivers ready framed
+ * (FRM_TYPE_ST), and tells the datagrams per second:
+ *
+ *	test_seatalk -b
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#ifndef S_SPLINT_S
+#include <unistd.h>
+#endif /* S_SPLINT_S */
+
+#include "gpsd.h"
+#include "driver_seatalk.h"
+
+#define BENCH_DATAGRAMS	200000	/* in the replayed stream */
+#define BENCH_REPEAT	20	/* passes over the ready framed ones */
+
+extern gps_mask_t process_seatalk(uint8_t * cmdBuffer, uint8_t size,
+				  struct gps_device_t *session);
+
+/* the driver is in the library, which wants these */
+ssize_t gpsd_write(struct gps_device_t *session UNUSED,
+		   const char *buf UNUSED,
+		   const size_t len)
+{
+    return (ssize_t)len;
+}
+
+void gpsd_throttled_report(const int subsys UNUSED, const int errlevel UNUSED,
+			   const char *buf UNUSED)
+{
+}
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+void gpsd_external_report(const int debuglevel UNUSED,
+			  const int errlevel UNUSED,
+			  const char *fmt UNUSED, ...)
+{
+}
+
+struct datagram_t {
+    uint8_t len;
+    uint8_t bu[18];
+};
+
+/* a boat's worth of instruments, with 0xff and 0x00 in the payloads */
+static const struct datagram_t mix[] = {
+    {5, {0x00, 0x02, 0x00, 0x64, 0x00}},	/* depth 10 ft */
+    {4, {0x10, 0x01, 0x00, 0x5a}},		/* AWA 45 deg */
+    {4, {0x11, 0x01, 0x0c, 0x05}},		/* AWS 12.5 kn */
+    {4, {0x20, 0x01, 0x32, 0x00}},		/* STW 5.0 kn */
+    {5, {0x89, 0x12, 0x2d, 0x00, 0x20}},	/* heading 180 deg */
+    {4, {0x52, 0x01, 0xff, 0x00}},		/* SOG 25.5 kn */
+    {3, {0x53, 0x10, 0x00}},			/* COG 90 deg */
+    {4, {0x27, 0x01, 0xff, 0x00}},		/* water temp 15.5 C */
+    {5, {0x50, 0x02, 0x36, 0xe8, 0x03}},	/* lat 54 deg 10 min N */
+    {5, {0x51, 0x02, 0x0a, 0x88, 0x93}},	/* lon 10 deg 50 min E */
+    {3, {0x30, 0x00, 0x00}},			/* lamp intensity, not known */
+};
+#define MIX	(int)(sizeof(mix) / sizeof(mix[0]))
+
+static struct gps_context_t context;
+static struct gps_device_t session;
+static int failures = 0;
+
+static void check(bool ok, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!ok) {
+	va_start(ap, fmt);
+	(void)vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	(void)fputc('\n', stderr);
+	failures++;
+    }
+}
+
+static void frame(FILE *fp, const struct datagram_t *d)
+/* write a datagram as the tty reads it, even parity and PARMRK */
+{
+    int i;
+
+    for (i = 0; i < d->len; i++) {
+	uint8_t c = d->bu[i];
+	int ninth = i == 0;
+
+	if (ninth != __builtin_parity(c)) {
+	    (void)fputc(0xff, fp);
+	    (void)fputc(0x00, fp);
+	} else if (c == 0xff)
+	    (void)fputc(0xff, fp);
+	(void)fputc(c, fp);
+    }
+}
+
+static FILE *capture(int count)
+/* a stream of count datagrams off the mix, ready to be read */
+{
+    FILE *fp = tmpfile();
+    int i;
+
+    if (fp == NULL) {
+	(void)perror("tmpfile");
+	exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < count; i++)
+	frame(fp, &mix[i % MIX]);
+    (void)fflush(fp);
+    rewind(fp);
+    return fp;
+}
+
+static void attach(FILE *fp)
+/* an st:// device reading the stream */
+{
+    session.context = &context;
+    session.gpsdata.gps_fd = fileno(fp);
+    (void)lseek(session.gpsdata.gps_fd, 0, SEEK_SET);
+    packet_init(&session.packet);
+}
+
+static void lexer(void)
+{
+    FILE *fp = capture(3 * MIX);
+    ssize_t len;
+    int n = 0, reads = 0;
+
+    attach(fp);
+    while ((len = seatalk_packet_get(&session)) != 0) {
+	const struct datagram_t *d = &mix[n % MIX];
+
+	if (len < 0 || session.packet.outbuflen == 0) {
+	    reads++;
+	    check(len >= 0 && reads < 100, "lexer stuck at datagram %d", n);
+	    if (len < 0 || reads >= 100)
+		break;
+	    continue;
+	}
+	check(session.packet.outbuflen == d->len
+	      && memcmp(session.packet.outbuffer, d->bu, d->len) == 0,
+	      "datagram %d (%02x) came out as %zu bytes starting %02x", n,
+	      d->bu[0], session.packet.outbuflen, session.packet.outbuffer[0]);
+	n++;
+    }
+    check(n == 3 * MIX, "%d of %d datagrams", n, 3 * MIX);
+    (void)fclose(fp);
+}
+
+static gps_mask_t decode(const struct datagram_t *d)
+{
+    uint8_t bu[sizeof(d->bu)];
+
+    memcpy(bu, d->bu, sizeof(bu));
+    return process_seatalk(bu, d->len, &session);
+}
+
+static void dispatch(void)
+{
+    const struct navigation_t *nav = &session.gpsdata.navigation;
+    const struct environment_t *env = &session.gpsdata.environment;
+    static const struct datagram_t shortened = {4, {0x00, 0x02, 0x00, 0x64}};
+    gps_mask_t mask;
+
+    session.context = &context;
+    mask = decode(&mix[0]);
+    check(mask == NAVIGATION_SET
+	  && fabs(nav->depth - 10.0 / METERS_TO_FEET) < 1e-9,
+	  "depth %f", nav->depth);
+    (void)decode(&mix[1]);
+    check(env->wind[wind_apparent].angle == 45.0, "AWA %f",
+	  env->wind[wind_apparent].angle);
+    (void)decode(&mix[2]);
+    check(fabs(env->wind[wind_apparent].speed - 12.5 * KNOTS_TO_MPS) < 1e-9,
+	  "AWS %f", env->wind[wind_apparent].speed);
+    (void)decode(&mix[3]);
+    check(nav->speed_thru_water == 5.0, "STW %f", nav->speed_thru_water);
+    (void)decode(&mix[4]);
+    check(nav->heading[compass_magnetic] == 180.0, "heading %f",
+	  nav->heading[compass_magnetic]);
+    (void)decode(&mix[5]);
+    check(nav->speed_over_ground == 25.5, "SOG %f", nav->speed_over_ground);
+    (void)decode(&mix[6]);
+    check(nav->course_over_ground[compass_true] == 90.0, "COG %f",
+	  nav->course_over_ground[compass_true]);
+    (void)decode(&mix[8]);
+    mask = decode(&mix[9]);
+    check((mask & LATLON_SET) != 0
+	  && fabs(session.newdata.latitude - (54.0 + 10.0 / 60)) < 1e-9
+	  && fabs(session.newdata.longitude - (10.0 + 50.0 / 60)) < 1e-9,
+	  "position %f %f", session.newdata.latitude,
+	  session.newdata.longitude);
+
+    check(decode(&mix[10]) == 0, "unknown command decoded");
+    check(decode(&shortened) == 0, "short datagram decoded");
+}
+
+static double since(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void benchmark(void)
+{
+    FILE *fp = capture(BENCH_DATAGRAMS);
+    struct timespec t0;
+    ssize_t len;
+    double t;
+    int n = 0, i, pass;
+
+    /* the st:// device: read(), unframe and decode */
+    attach(fp);
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    while ((len = seatalk_packet_get(&session)) > 0)
+	if (session.packet.outbuflen > 0) {
+	    (void)process_seatalk(session.packet.outbuffer,
+				  (uint8_t)session.packet.outbuflen, &session);
+	    n++;
+	}
+    t = since(&t0);
+    (void)printf("st://  %8d datagrams %10.0f datagrams/s  %6.1f ns each\n",
+		 n, n / t, t * 1e9 / n);
+    check(n == BENCH_DATAGRAMS, "%d of %d datagrams", n, BENCH_DATAGRAMS);
+    (void)fclose(fp);
+
+    /* VYSPI: the datagrams come framed, only the dispatch is left */
+    n = 0;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (pass = 0; pass < BENCH_REPEAT; pass++)
+	for (i = 0; i < BENCH_DATAGRAMS; i++, n++)
+	    (void)decode(&mix[i % MIX]);
+    t = since(&t0);
+    (void)printf("VYSPI  %8d datagrams %10.0f datagrams/s  %6.1f ns each\n",
+		 n, n / t, t * 1e9 / n);
+}
+
+int main(int argc, char **argv)
+{
+    bool bench = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "b")) != -1) {
+	switch (option) {
+	case 'b':
+	    bench = true;
+	    break;
+	default:
+	    (void)fprintf(stderr, "usage: test_seatalk [-b]\n");
+	    exit(EXIT_FAILURE);
+	}
+    }
+
+    if (bench)
+	benchmark();
+    else {
+	lexer();
+	dispatch();
+	if (failures == 0)
+	    (void)printf("SeaTalk lexer and dispatch test succeeded.\n");
+    }
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
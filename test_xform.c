@@ -0,0 +1,181 @@
+/*
+ * test_xform - check the NMEA 0183 sentence transformation rules
+ *
+ * Runs sentences through the built-in rotating-mast rules and through
+ * rules set up the way the configuration would, and checks what comes
+ * out: rewritten fields and tags, fresh checksums, talker and port
+ * matching, dropped sentences, and sentences no rule is about passing
+ * through untouched.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "gpsd.h"
+
+void gpsd_report(const int debuglevel UNUSED, const int errlevel UNUSED,
+		 const char *fmt UNUSED, ...)
+{
+}
+
+static struct nmea_xform_t xform;
+static struct gps_context_t context;
+static struct gps_device_t session;
+static int failures = 0;
+
+static void expect(const char *in, int port, enum xform_result_t want,
+		   const char *wantbody)
+/* wantbody is the rewritten sentence without '$' and checksum */
+{
+    char out[NMEA_MAX + 1], full[NMEA_MAX + 1];
+    unsigned int sum = 0;
+    const char *p;
+    enum xform_result_t got;
+
+    got = nmea_xform_apply(&xform, &session, port, in, strlen(in),
+			   out, sizeof(out));
+    if (got != want) {
+	(void)fprintf(stderr, "%s: result %d, wanted %d\n", in, got, want);
+	failures++;
+	return;
+    }
+    if (want != xform_rewrite)
+	return;
+    for (p = wantbody; *p != '\0'; p++)
+	sum ^= (unsigned char)*p;
+    (void)snprintf(full, sizeof(full), "$%s*%02X\r\n", wantbody, sum);
+    if (strcmp(out, full) != 0) {
+	(void)fprintf(stderr, "%s: rewritten as %s, wanted %s", in, out, full);
+	failures++;
+    }
+}
+
+static void rule(const char *name, const char *const *options)
+/* set up a rule from option/value pairs, as config.c would */
+{
+    struct xform_rule_t *r = nmea_xform_rule(&xform, name);
+
+    for (; options[0] != NULL; options += 2)
+	if (r == NULL || !nmea_xform_option(&xform, r, options[0], options[1])) {
+	    (void)fprintf(stderr, "rule %s: %s %s refused\n",
+			  name, options[0], options[1]);
+	    failures++;
+	}
+}
+
+static void refused(const char *option, const char *value)
+{
+    struct xform_rule_t *r = nmea_xform_rule(&xform, "refused");
+
+    if (r != NULL && nmea_xform_option(&xform, r, option, value)) {
+	(void)fprintf(stderr, "%s %s accepted\n", option, value);
+	failures++;
+    }
+}
+
+static void builtin(void)
+{
+    nmea_xform_init(&xform);
+
+    /* unmatched sentences and other talkers pass untouched */
+    expect("$GPRMC,,V,,,,,,,,,,N*53\r\n", 0, xform_pass, NULL);
+    expect("$WIMWV,45.0,R,10.0,N,A*00\r\n", 0, xform_pass, NULL);
+    expect("$HC", 0, xform_pass, NULL);
+
+    /* the mast compass goes out of the way, the wind gets turned */
+    expect("$HCHDM,30.2,M*00\r\n", 0, xform_rewrite, "CCHDX,30.2,M");
+    nmea_xform_note(&xform, XFORM_VAR_HEADING, 10.0);
+    expect("$IIMWV,45.0,R,10.0,N,A*00\r\n", 0, xform_rewrite,
+	   "CCMWV,65,R,10.0,N,A");
+    expect("$IIMWV,350,R,10.0,N,A\r\n", 0, xform_rewrite,
+	   "CCMWV,10,R,10.0,N,A");
+    nmea_xform_note(&xform, XFORM_VAR_HEADING, 50.0);
+    expect("$IIMWV,10,R,10.0,N,A", 0, xform_rewrite, "CCMWV,350,R,10.0,N,A");
+    /* no heading yet counts as zero; an empty angle is left alone */
+    nmea_xform_note(&xform, XFORM_VAR_HEADING, NAN);
+    expect("$IIMWV,10,R,10.0,N,A", 0, xform_rewrite, "CCMWV,40,R,10.0,N,A");
+    expect("$IIMWV,,R,10.0,N,A", 0, xform_rewrite, "CCMWV,,R,10.0,N,A");
+
+    /* a section of the same name turns a built-in rule off */
+    rule("mast_wind", (const char *[]){"enabled", "false", NULL});
+    nmea_xform_compile(&xform);
+    expect("$IIMWV,45.0,R,10.0,N,A*00\r\n", 0, xform_pass, NULL);
+    expect("$HCHDM,30.2,M*00\r\n", 0, xform_rewrite, "CCHDX,30.2,M");
+}
+
+static void configured(void)
+{
+    nmea_xform_init(&xform);
+    rule("depth", (const char *[]){
+	"match", "DBT", "derive", "$3=$3+0.4", NULL});
+    refused("derive", "$1=$3*3.28084");
+    rule("depth", (const char *[]){
+	"derive", "$1=$3+$3+$3+0.5", "set", "$2=f", NULL});
+    rule("gll", (const char *[]){
+	"match", "--GLL", "port", "port2", "drop", "true", NULL});
+    rule("garmin", (const char *[]){
+	"match", "$PGRME", "set", "$6=M", "rename", "PXYZE", NULL});
+    rule("vhw", (const char *[]){
+	"match", "VWVHW", "derive", "stw=$5", "drop", "yes", NULL});
+    rule("vhw2", (const char *[]){
+	"match", "VHW", "derive", "$5=$5-stw", "set", "$9=X", NULL});
+    nmea_xform_compile(&xform);
+
+    session.gpsdata.dev.port_count = 2;
+    (void)strlcpy(session.gpsdata.dev.portlist[0].name, "port1",
+		  sizeof(session.gpsdata.dev.portlist[0].name));
+    session.gpsdata.dev.portlist[0].no = 3;
+    (void)strlcpy(session.gpsdata.dev.portlist[1].name, "port2",
+		  sizeof(session.gpsdata.dev.portlist[1].name));
+    session.gpsdata.dev.portlist[1].no = 5;
+
+    /* any talker; steps in order, each seeing the last one's work */
+    expect("$SDDBT,7.5,f,2.30,M,1.2,F*00\r\n", 0, xform_rewrite,
+	   "SDDBT,8.6,f,2.70,M,1.2,F");
+    expect("$IIDBT,,f,,M,,F", 0, xform_rewrite, "IIDBT,,f,,M,,F");
+    /* port by name, and only that port */
+    expect("$GPGLL,1,N,2,E,,A,A", 5, xform_drop, NULL);
+    expect("$GPGLL,1,N,2,E,,A,A", 3, xform_pass, NULL);
+    expect("$GPGLL,1,N,2,E,,A,A", 9, xform_pass, NULL);
+    /* proprietary tags whole, with fields added as needed */
+    expect("$PGRME,1.0,M,2.0*00", 0, xform_rewrite, "PXYZE,1.0,M,2.0,,,M");
+    expect("$PGRMZ,1.0,M,2.0*00", 0, xform_pass, NULL);
+    /* a value taken from a dropped sentence, used by another talker's */
+    expect("$VWVHW,,T,,M,4.5,N,8.3,K", 0, xform_drop, NULL);
+    expect("$IIVHW,,T,,M,5.0,N,9.3,K", 0, xform_rewrite,
+	   "IIVHW,,T,,M,0.5,N,9.3,K,X");
+
+    /* options that make no sense */
+    refused("match", "GPRMCX");
+    refused("match", "GP");
+    refused("match", "gprmc");
+    refused("derive", "$1");
+    refused("derive", "$0=$1");
+    refused("derive", "$1=");
+    refused("derive", "$1=$1+");
+    refused("derive", "$1=1+2+3+4+5");
+    refused("derive", "$1=1x");
+    refused("set", "x=1");
+    refused("set", "$1=a,b");
+    refused("rename", "GP");
+    refused("modulo", "-1");
+    refused("decimals", "x");
+    refused("colour", "red");
+}
+
+int main(void)
+{
+    session.context = &context;
+
+    builtin();
+    configured();
+
+    if (failures == 0)
+	(void)printf("Sentence transformation test succeeded.\n");
+    exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+
+NAME
+   trace.c - binary event trace ring in shared memory
+
+DESCRIPTION
+   The daemon calls trace_acquire() when started with -T; after that the
+TRACE_EVENT() emit points in the I/O, packet, driver and reporting paths
+append records to the ring.  Nothing is formatted on the hot path; the
+gpstrace tool does that afterwards.
+
+PERMISSIONS
+   This file is Copyright (c) 2010 by the GPSD project
+   BSD terms apply: see the file COPYING in the distribution root for details.
+
+***************************************************************************/
+#include "gpsd_config.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "gpsd.h"
+
+volatile struct trace_ring_t *gpsd_trace = NULL;
+
+#ifdef TRACE_ENABLE
+bool trace_acquire(int debug)
+/* create (or reuse) the trace segment and reset the ring */
+{
+    int shmid;
+    void *seg;
+
+    shmid = shmget((key_t)TRACE_KEY, sizeof(struct trace_ring_t),
+		   (int)(IPC_CREAT|0644));
+    if (shmid == -1) {
+	gpsd_report(debug, LOG_ERROR,
+		    "trace shmget(%ld, %zd, 0644) failed: %s\n",
+		    (long int)TRACE_KEY,
+		    sizeof(struct trace_ring_t),
+		    strerror(errno));
+	return false;
+    }
+    seg = shmat(shmid, 0, 0);
+    if ((int)(long)seg == -1) {
+	gpsd_report(debug, LOG_ERROR, "trace shmat failed: %s\n",
+		    strerror(errno));
+	return false;
+    }
+    gpsd_trace = (volatile struct trace_ring_t *)seg;
+    memset(seg, 0, offsetof(struct trace_ring_t, rec));
+    gpsd_trace->recsize = (uint16_t)sizeof(struct trace_record_t);
+    gpsd_trace->records = TRACE_RECORDS;
+    gpsd_trace->version = TRACE_VERSION;
+    gpsd_trace->pid = (int32_t)getpid();
+    gpsd_trace->head = 0;
+    memory_barrier();
+    gpsd_trace->magic = TRACE_MAGIC;
+    gpsd_report(debug, LOG_PROG,
+		"trace ring of %d records attached, segment %d\n",
+		TRACE_RECORDS, shmid);
+    return true;
+}
+
+void trace_release(void)
+/* stop tracing and detach; the segment stays for gpstrace to read */
+{
+    if (gpsd_trace != NULL) {
+	volatile struct trace_ring_t *ring = gpsd_trace;
+	gpsd_trace = NULL;
+	(void)shmdt((const void *)ring);
+    }
+}
+#endif /* TRACE_ENABLE */
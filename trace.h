@@ -0,0 +1,93 @@
+/* trace.h -- binary event trace ring for hot-path profiling
+ *
+ * The daemon appends fixed-size records to a ring in a SysV shared
+ * memory segment; gpstrace(1) attaches to the same segment and turns
+ * the records into Chrome trace JSON or per-stage latency histograms.
+ * Writing a record costs one clock_gettime() and one atomic add, so the
+ * trace can stay on while measuring the latency it is describing.
+ *
+ * This file is Copyright (c) 2010 by the GPSD project
+ * BSD terms apply: see the file COPYING in the distribution root for details.
+ */
+#ifndef _GPSD_TRACE_H_
+#define _GPSD_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "gpsd_config.h"
+
+#define TRACE_KEY	0x47505354	/* "GPST" */
+#define TRACE_MAGIC	0x54524143	/* "TRAC" */
+#define TRACE_VERSION	1
+#define TRACE_RECORDS	65536		/* must be a power of two */
+
+/* event ids */
+#define TRACE_READ	1	/* device read(): arg0 = bytes */
+#define TRACE_FRAME	2	/* packet complete: arg0 = type, arg1 = length */
+#define TRACE_PGN	3	/* PGN decoded: arg0 = pgn, arg1 = source */
+#define TRACE_REPORT	4	/* report generated: arg0/arg1 = changed mask */
+#define TRACE_WRITE	5	/* subscriber write: arg0 = client, arg1 = bytes */
+#define TRACE_EVENTS	6
+
+#define TRACE_NODEV	0xffff	/* device field of events not tied to one */
+
+struct trace_record_t {
+    uint64_t ts;		/* CLOCK_MONOTONIC, nanoseconds */
+    uint32_t seq;		/* low bits of the slot number, written last */
+    uint16_t event;
+    uint16_t device;		/* device fd, or TRACE_NODEV */
+    uint32_t arg[4];
+};
+
+struct trace_ring_t {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recsize;
+    uint32_t records;
+    int32_t pid;
+    volatile uint64_t head;	/* slot of the next record to write */
+    struct trace_record_t rec[TRACE_RECORDS];
+};
+
+extern /*@null@*/volatile struct trace_ring_t *gpsd_trace;
+
+extern bool trace_acquire(int debug);
+extern void trace_release(void);
+
+static /*@unused@*/ inline void trace_emit(uint16_t event, uint16_t device,
+					   uint32_t a0, uint32_t a1,
+					   uint32_t a2, uint32_t a3)
+{
+    volatile struct trace_record_t *rec;
+    struct timespec ts;
+    uint64_t slot;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    slot = __atomic_fetch_add(&gpsd_trace->head, 1, __ATOMIC_RELAXED);
+    rec = &gpsd_trace->rec[slot & (TRACE_RECORDS - 1)];
+    rec->seq = (uint32_t)~slot;		/* mark torn while we fill it */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->ts = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    rec->event = event;
+    rec->device = device;
+    rec->arg[0] = a0;
+    rec->arg[1] = a1;
+    rec->arg[2] = a2;
+    rec->arg[3] = a3;
+    __atomic_store_n(&rec->seq, (uint32_t)slot, __ATOMIC_RELEASE);
+}
+
+#ifdef TRACE_ENABLE
+#define TRACE_EVENT4(ev, dev, a0, a1, a2, a3) do { \
+	if (gpsd_trace != NULL) \
+	    trace_emit((ev), (uint16_t)(dev), (uint32_t)(a0), (uint32_t)(a1), \
+		       (uint32_t)(a2), (uint32_t)(a3)); \
+    } while (0)
+#else
+#define TRACE_EVENT4(ev, dev, a0, a1, a2, a3) do { } while (0)
+#endif /* TRACE_ENABLE */
+#define TRACE_EVENT(ev, dev, a0, a1) TRACE_EVENT4(ev, dev, a0, a1, 0, 0)
+
+#endif /* _GPSD_TRACE_H_ */